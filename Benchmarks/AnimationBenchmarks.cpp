@@ -0,0 +1,73 @@
+#include "assets/ModelAsset.h"
+#include "assets/ModelData.h"
+#include "assets/SModelLoader.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // The sample's Knight (cooked next to SampleApp); STRATO_BENCH_MODEL overrides the path.
+    struct PoseModel
+    {
+        Engine::smodel::SModelFileView view;
+        Engine::ModelAsset model;
+        std::string error;
+        bool ok = false;
+
+        PoseModel()
+        {
+            const char *env = std::getenv("STRATO_BENCH_MODEL");
+            const std::string path = env ? env : "assets/Knight/Knight.smodel";
+            ok = Engine::smodel::LoadSModelFile(path, view, error) && Engine::BuildModelPose(view, model) &&
+                 !model.animClips.empty();
+            if (ok)
+                return;
+            if (error.empty())
+                error = "no animated nodes";
+            error = path + ": " + error;
+        }
+    };
+
+    const PoseModel &Knight()
+    {
+        static PoseModel model;
+        return model;
+    }
+} // namespace
+
+// One entity's pose per iteration, time stepping forward at 30 Hz as the render system samples it;
+// range(0) = 1 uses the reduced-detail path (optional leaf nodes left at rest).
+static void BM_ModelAsset_EvaluatePoseInto(benchmark::State &state)
+{
+    const PoseModel &knight = Knight();
+    if (!knight.ok)
+    {
+        state.SkipWithError(knight.error.c_str());
+        return;
+    }
+
+    const Engine::ModelAsset &model = knight.model;
+    const bool skipOptional = state.range(0) != 0;
+    const float duration = model.animClips[0].durationSec > 0.0f ? model.animClips[0].durationSec : 1.0f;
+
+    Engine::ModelAsset::PoseScratch scratch;
+    Engine::ModelAsset::KeyCursor cursor;
+    std::vector<glm::mat4> globals;
+    float t = 0.0f;
+    for (auto _ : state)
+    {
+        model.evaluatePoseInto(0, t, scratch, globals, &cursor, skipOptional);
+        benchmark::DoNotOptimize(globals.data());
+        t += 1.0f / 30.0f;
+        if (t >= duration)
+            t -= duration;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["nodes"] = static_cast<double>(model.nodes.size());
+    state.counters["animatedNodes"] = static_cast<double>(model.animatedNodes.size());
+}
+BENCHMARK(BM_ModelAsset_EvaluatePoseInto)->Arg(0)->Arg(1);
@@ -0,0 +1,77 @@
+#pragma once
+/*
+  BenchWorld.h
+  ------------
+  Purpose:
+    - Shared fixture for the microbenchmarks and Tests/: an ECSContext with a unit prefab shaped like the
+      sample's infantry (entities/LightInfantry.json without its model) and deterministic crowds.
+
+  Usage:
+    - BenchWorld world;
+    - world.spawnCrowd(10000, 1.0f); // square block, 1 m apart, walking +X
+*/
+
+#include "ECS/ECSContext.h"
+#include "ECS/PrefabSpawner.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace Bench
+{
+    inline Engine::ECS::Prefab MakeUnitPrefab(Engine::ECS::ComponentRegistry &registry, Engine::ECS::ArchetypeManager &archetypes)
+    {
+        using namespace Engine::ECS;
+        Prefab p;
+        p.name = "BenchUnit";
+        p.signature = buildSignatureFromNames({"Position", "Velocity", "Health", "MoveTarget", "MoveSpeed", "Radius",
+                                               "Separation", "AvoidanceParams"},
+                                              registry);
+        p.archetypeId = archetypes.getOrCreate(p.signature);
+        p.defaults[registry.ensureId("MoveSpeed")] = MoveSpeed{3.5f};
+        p.defaults[registry.ensureId("Radius")] = Radius{0.3f};
+        p.defaults[registry.ensureId("Separation")] = Separation{0.15f};
+        p.defaults[registry.ensureId("AvoidanceParams")] = AvoidanceParams{2.5f, 8.0f, 0.55f};
+        return p;
+    }
+
+    struct BenchWorld
+    {
+        Engine::ECS::ECSContext ecs;
+        Engine::ECS::Prefab unit;
+        std::vector<Engine::ECS::Entity> entities;
+
+        BenchWorld() { unit = MakeUnitPrefab(ecs.components, ecs.archetypes); }
+
+        // 'count' units on a square grid 'spacing' meters apart (plus a little jitter), all walking
+        // +X at their move speed so avoidance has preferred velocities to bend.
+        void spawnCrowd(uint32_t count, float spacing)
+        {
+            const Engine::ECS::BatchSpawnResult batch =
+                Engine::ECS::spawnFromPrefabBatch(unit, count, ecs.components, ecs.stores, ecs.entities, entities);
+            Engine::ECS::ArchetypeStore &store = *ecs.stores.get(batch.archetypeId);
+
+            const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+            const float half = 0.5f * spacing * static_cast<float>(side);
+            std::mt19937 rng(1234u);
+            std::uniform_real_distribution<float> jitter(-0.1f * spacing, 0.1f * spacing);
+
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            for (uint32_t i = 0; i < batch.count; ++i)
+            {
+                const uint32_t row = batch.firstRow + i;
+                auto &&p = positions[row];
+                p.x = static_cast<float>(i % side) * spacing - half + jitter(rng);
+                p.y = 0.0f;
+                p.z = static_cast<float>(i / side) * spacing - half + jitter(rng);
+                auto &&v = velocities[row];
+                v.x = 3.5f;
+                v.y = 0.0f;
+                v.z = 0.0f;
+            }
+        }
+    };
+} // namespace Bench
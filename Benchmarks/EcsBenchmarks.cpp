@@ -0,0 +1,150 @@
+#include "BenchWorld.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Engine::ECS;
+
+namespace
+{
+    // Random signatures over the registered components; the same every run.
+    std::vector<ComponentMask> RandomMasks(uint32_t count, uint32_t componentCount, uint32_t bitsPerMask, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<uint32_t> pick(0, componentCount - 1);
+        std::vector<ComponentMask> masks(count);
+        for (ComponentMask &m : masks)
+            for (uint32_t b = 0; b < bitsPerMask; ++b)
+                m.set(pick(rng));
+        return masks;
+    }
+} // namespace
+
+// Rows created then swap-removed from the front (every destroy moves the last row), per batch of range(0).
+static void BM_ArchetypeStore_CreateDestroyRow(benchmark::State &state)
+{
+    Bench::BenchWorld world;
+    ArchetypeStore store(world.unit.signature, world.ecs.components);
+    const uint32_t rows = static_cast<uint32_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < rows; ++i)
+            benchmark::DoNotOptimize(store.createRow(Entity{i, 0}));
+        for (uint32_t i = 0; i < rows; ++i)
+            benchmark::DoNotOptimize(store.destroyRow(0));
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_ArchetypeStore_CreateDestroyRow)->Arg(1024)->Arg(16384);
+
+// One entity at a time: record, store row, defaults applied per component.
+static void BM_SpawnFromPrefab(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto world = std::make_unique<Bench::BenchWorld>();
+        state.ResumeTiming();
+
+        for (uint32_t i = 0; i < count; ++i)
+            benchmark::DoNotOptimize(spawnFromPrefab(world->unit, world->ecs.components, world->ecs.archetypes,
+                                                     world->ecs.stores, world->ecs.entities));
+
+        state.PauseTiming();
+        world.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SpawnFromPrefab)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+// The same entities through the row template and column-wise stamping.
+static void BM_SpawnFromPrefabBatch(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto world = std::make_unique<Bench::BenchWorld>();
+        world->entities.reserve(count);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(spawnFromPrefabBatch(world->unit, count, world->ecs.components, world->ecs.stores,
+                                                      world->ecs.entities, world->entities));
+
+        state.PauseTiming();
+        world.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SpawnFromPrefabBatch)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+// Query filtering: store signatures against a required/excluded pair, as ArchetypeQuery does.
+static void BM_ComponentMask_Matches(benchmark::State &state)
+{
+    ComponentRegistry registry;
+    const uint32_t components = registry.count();
+    const std::vector<ComponentMask> signatures = RandomMasks(256, components, 8, 1u);
+    const std::vector<ComponentMask> required = RandomMasks(1, components, 2, 2u);
+    const std::vector<ComponentMask> excluded = RandomMasks(1, components, 2, 3u);
+
+    for (auto _ : state)
+    {
+        uint32_t hits = 0;
+        for (const ComponentMask &s : signatures)
+            hits += s.matches(required[0], excluded[0]) ? 1u : 0u;
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(signatures.size()));
+}
+BENCHMARK(BM_ComponentMask_Matches);
+
+// Signature lookups of existing archetypes (the common case: prefab instantiation, migrations).
+static void BM_ArchetypeManager_GetOrCreate_Hit(benchmark::State &state)
+{
+    ComponentRegistry registry;
+    ArchetypeManager archetypes;
+    const std::vector<ComponentMask> signatures =
+        RandomMasks(static_cast<uint32_t>(state.range(0)), registry.count(), 8, 4u);
+    for (const ComponentMask &s : signatures)
+        archetypes.getOrCreate(s);
+
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(archetypes.getOrCreate(signatures[next]));
+        next = next + 1 < signatures.size() ? next + 1 : 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ArchetypeManager_GetOrCreate_Hit)->Arg(16)->Arg(256);
+
+// New archetypes, range(0) per fresh manager.
+static void BM_ArchetypeManager_GetOrCreate_Miss(benchmark::State &state)
+{
+    ComponentRegistry registry;
+    const std::vector<ComponentMask> signatures =
+        RandomMasks(static_cast<uint32_t>(state.range(0)), registry.count(), 8, 5u);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto archetypes = std::make_unique<ArchetypeManager>();
+        state.ResumeTiming();
+
+        for (const ComponentMask &s : signatures)
+            benchmark::DoNotOptimize(archetypes->getOrCreate(s));
+
+        state.PauseTiming();
+        archetypes.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(signatures.size()));
+}
+BENCHMARK(BM_ArchetypeManager_GetOrCreate_Miss)->Arg(256);
@@ -0,0 +1,50 @@
+#include "BenchWorld.h"
+
+#include "systems/LocalAvoidanceSystem.h"
+#include "systems/SpatialIndexSystem.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+    // Cell size the sample's SystemRunner uses for infantry-sized units.
+    constexpr float kCellSize = 2.0f;
+    constexpr float kTickSeconds = 1.0f / 30.0f;
+} // namespace
+
+// Full grid rebuild (non-incremental mode) over range(0) units 1 m apart.
+static void BM_SpatialIndex_Rebuild(benchmark::State &state)
+{
+    Bench::BenchWorld world;
+    world.spawnCrowd(static_cast<uint32_t>(state.range(0)), 1.0f);
+
+    SpatialIndexSystem grid(kCellSize);
+    grid.buildMasks(world.ecs.components);
+
+    for (auto _ : state)
+        grid.update(world.ecs.stores, kTickSeconds);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpatialIndex_Rebuild)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// One avoidance tick over 10k units; range(0) is the spacing in centimetres, so density (and the
+// neighbours each unit visits) grows down the list.
+static void BM_LocalAvoidance(benchmark::State &state)
+{
+    const float spacing = static_cast<float>(state.range(0)) * 0.01f;
+    Bench::BenchWorld world;
+    world.spawnCrowd(10000, spacing);
+
+    SpatialIndexSystem grid(kCellSize);
+    grid.buildMasks(world.ecs.components);
+    grid.update(world.ecs.stores, kTickSeconds);
+
+    LocalAvoidanceSystem avoidance(&grid);
+    avoidance.buildMasks(world.ecs.components);
+
+    for (auto _ : state)
+        avoidance.update(world.ecs.stores, kTickSeconds);
+    state.SetItemsProcessed(state.iterations() * 10000);
+    state.counters["unitsPerM2"] = 1.0 / (static_cast<double>(spacing) * spacing);
+}
+BENCHMARK(BM_LocalAvoidance)->Arg(200)->Arg(100)->Arg(60)->Arg(40)->Unit(benchmark::kMicrosecond);
@@ -9,20 +9,34 @@
   Usage:
     - uint32_t id = manager.getOrCreate(signature);
     - const Archetype* info = manager.get(id);
+    - uint32_t dead = manager.withComponent(id, deadId);      // cached add/remove edges
+
+  Notes:
+    - Each archetype caches the archetype reached by adding/removing one component, so repeated
+      migrations (e.g. unit -> unit + Dead) neither rebuild signatures nor hash them.
 */
 
 #include <unordered_map>
 #include <vector>
 #include <cstdint>
-#include <string>
+#include <utility>
 #include "ECS/Components.h"
 
 namespace Engine::ECS
 {
     struct Archetype
     {
+        // One cached transition: adding/removing 'componentId' leads to archetype 'target'.
+        struct Edge
+        {
+            uint32_t componentId;
+            uint32_t target;
+        };
+
         uint32_t id = UINT32_MAX;
         ComponentMask signature;
+        std::vector<Edge> addEdges;
+        std::vector<Edge> removeEdges;
     };
 
     class ArchetypeManager
@@ -31,17 +45,31 @@ namespace Engine::ECS
         // Returns existing ID for signature or creates a new archetype and returns its ID.
         uint32_t getOrCreate(const ComponentMask &signature)
         {
-            const std::string key = signature.toKey();
-            auto it = m_keyToId.find(key);
-            if (it != m_keyToId.end())
+            auto it = m_signatureToId.find(signature);
+            if (it != m_signatureToId.end())
                 return it->second;
 
             const uint32_t id = static_cast<uint32_t>(m_archetypes.size());
-            m_keyToId.emplace(key, id);
-            m_archetypes.push_back(Archetype{id, signature});
+            m_signatureToId.emplace(signature, id);
+            Archetype archetype;
+            archetype.id = id;
+            archetype.signature = signature;
+            m_archetypes.push_back(std::move(archetype));
             return id;
         }
 
+        // Archetype with 'componentId' added (itself if already present). Cached per archetype.
+        uint32_t withComponent(uint32_t archetypeId, uint32_t componentId)
+        {
+            return transition(archetypeId, componentId, true);
+        }
+
+        // Archetype with 'componentId' removed (itself if absent). Cached per archetype.
+        uint32_t withoutComponent(uint32_t archetypeId, uint32_t componentId)
+        {
+            return transition(archetypeId, componentId, false);
+        }
+
         // Retrieve archetype info by ID.
         const Archetype *get(uint32_t id) const
         {
@@ -49,7 +77,34 @@ namespace Engine::ECS
         }
 
     private:
-        std::unordered_map<std::string, uint32_t> m_keyToId;
+        uint32_t transition(uint32_t archetypeId, uint32_t componentId, bool add)
+        {
+            if (archetypeId >= m_archetypes.size())
+                return UINT32_MAX;
+            if (m_archetypes[archetypeId].signature.has(componentId) == add)
+                return archetypeId;
+
+            const auto &edges = add ? m_archetypes[archetypeId].addEdges : m_archetypes[archetypeId].removeEdges;
+            for (const Archetype::Edge &edge : edges)
+                if (edge.componentId == componentId)
+                    return edge.target;
+
+            ComponentMask signature = m_archetypes[archetypeId].signature;
+            if (add)
+                signature.set(componentId);
+            else
+                signature.clear(componentId);
+            const uint32_t target = getOrCreate(signature); // may grow m_archetypes
+
+            auto &from = add ? m_archetypes[archetypeId].addEdges : m_archetypes[archetypeId].removeEdges;
+            from.push_back(Archetype::Edge{componentId, target});
+            auto &back = add ? m_archetypes[target].removeEdges : m_archetypes[target].addEdges;
+            back.push_back(Archetype::Edge{componentId, archetypeId});
+            return target;
+        }
+
+    private:
+        std::unordered_map<ComponentMask, uint32_t, ComponentMaskHash> m_signatureToId; // hashed directly from mask words
         std::vector<Archetype> m_archetypes;
     };
 
@@ -4,104 +4,137 @@
   ----------------
   Purpose:
     - Provide a generic Struct-of-Arrays store for a single archetype (signature).
-    - Conditionally hold arrays for components present in the signature (Position, Velocity, Health).
-    - Support creation of rows with defaults, destruction via swap-remove, and per-row masks.
+    - Hold one type-erased column per data component in the signature (registered with
+      ComponentRegistry::registerComponent<T>); tags in the signature get no column.
+    - Support creation of rows with defaults, destruction via swap-remove, and per-row tags.
 
   Usage:
-    - Construct with a signature.
-    - resolveKnownComponents(registry) to enable arrays for known components.
+    - Construct with a signature and the registry that describes its components.
     - createRow(entity) then applyDefaults(row, defaults, registry).
-    - destroyRow(row) with dense packing.
+    - store.column<Ammo>() / store.has<Ammo>() for any registered type; positions(), hasPosition()
+      and friends are shorthands for the built-in components.
+    - Bulk: createRows(owners, count, makeRowTemplate(defaults)).
+    - destroyRow(row) with dense packing; returns the entity moved into 'row' (fix its record).
+
+  Storage:
+    - Rows live in fixed-size chunks (see Chunk.h): one kChunkBytes block holds every column for
+      rowsPerChunk() consecutive rows. Growing a store allocates one more chunk; existing rows never move.
+    - Iterate a whole store with column[row], or per chunk with chunkCount()/chunkRowBegin()/chunkRowEnd()
+      and Column<T>::chunkData(c) for tight loops and parallel jobs.
+    - Each (chunk, column) keeps the tick of its last write (markChanged<T>/changedSince<T>), so
+      systems can skip chunks nothing touched since their previous run.
+    - Row tags (Selected, Disabled, ...) are per-store bit planes, one uint64_t per 64 rows per tag.
+      rowFilter(required, excluded) walks matching rows a word at a time.
 */
 
+#include <array>
 #include <vector>
 #include <unordered_map>
 #include <memory>
-#include <variant>
+#include <cstring>
+#include <type_traits>
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #include "ECS/Components.h"
 #include "ECS/Entity.h"
+#include "ECS/Chunk.h"
 
 namespace Engine::ECS
 {
+    class RowFilter;
+
     class ArchetypeStore
     {
     public:
-        explicit ArchetypeStore(const ComponentMask &signature)
-            : m_signature(signature) {}
+        ArchetypeStore(const ComponentMask &signature, const ComponentRegistry &registry)
+            : m_signature(signature)
+        {
+            buildColumns(registry);
+            computeLayout();
+        }
 
         // Create a new row for the given entity; returns row index.
         uint32_t createRow(Entity e)
         {
-            const uint32_t row = static_cast<uint32_t>(m_entities.size());
-            m_entities.emplace_back(e);
-            // Initialize row mask: start with the store signature (you can add tags per row later)
-            m_rowMasks.emplace_back(m_signature);
-
-            // Conditionally create per-component entries based on signature bits.
-            if (hasPosition())
-                m_positions.emplace_back(Position{});
-            if (hasVelocity())
-                m_velocities.emplace_back(Velocity{});
-            if (hasHealth())
-                m_healths.emplace_back(Health{100.f});
-            if (hasMoveTarget())
-                m_moveTargets.emplace_back(MoveTarget{});
-            if (hasMoveSpeed())
-                m_moveSpeeds.emplace_back(MoveSpeed{});
-            if (hasRadius())
-                m_radii.emplace_back(Radius{});
-            if (hasSeparation())
-                m_separations.emplace_back(Separation{});
-            if (hasAvoidanceParams())
-                m_avoidanceParams.emplace_back(AvoidanceParams{});
-            if (hasRenderModel())
-                m_renderModels.emplace_back(RenderModel{});
-            if (hasRenderAnimation())
-                m_renderAnimations.emplace_back(RenderAnimation{});
-            if (hasFacing())
-                m_facings.emplace_back(Facing{});
+            const uint32_t row = m_size;
+            if (row >= capacity())
+                addChunk();
+            ++m_size;
+            ++m_structureVersion;
+            markRowChanged(row);
+
+            // New rows carry no row tags; make sure every tag plane covers the row.
+            growTagPlanes();
+
+            // Default-construct every column from its prototype, then set the owner.
+            for (uint32_t c = 0; c < columnCount(); ++c)
+                writeElement(c, row, m_prototype.data() + m_columns[c].protoOffset);
+            std::memcpy(element(kEntityColumn, row), &e, sizeof(Entity));
 
             return row;
         }
 
-        // Swap-remove a row; maintains dense arrays and updates ownership.
-        void destroyRow(uint32_t row)
+        // Swap-remove a row; maintains dense arrays.
+        // Returns the entity that was moved into 'row' (invalid if none moved) so the caller can
+        // patch its EntitiesRecord entry.
+        Entity destroyRow(uint32_t row)
         {
-            const uint32_t last = static_cast<uint32_t>(m_entities.size() - 1);
-            if (row > last)
-                return;
+            if (m_size == 0 || row >= m_size)
+                return Entity{};
+            const uint32_t last = m_size - 1;
 
-            auto swapErase = [&](auto &vec)
+            Entity moved{};
+            if (row != last)
             {
-                if (row != last)
-                    vec[row] = std::move(vec[last]);
-                vec.pop_back();
-            };
+                std::memcpy(&moved, element(kEntityColumn, last), sizeof(Entity));
+                for (uint32_t c = 0; c < columnCount(); ++c)
+                    copyElement(*this, c, last, c, row);
+            }
+            for (auto &plane : m_tagPlanes)
+            {
+                const bool bit = testBit(plane.bits, last);
+                assignBit(plane.bits, row, bit);
+                assignBit(plane.bits, last, false);
+            }
+            markRowChanged(row);
+            markRowChanged(last);
+            --m_size;
+            ++m_structureVersion;
+
+            // Keep one spare chunk so a spawn right after a despawn does not reallocate.
+            const uint32_t needed = (m_size + m_rowsPerChunk - 1) / m_rowsPerChunk;
+            while (m_chunks.size() > needed + 1)
+            {
+                m_chunks.pop_back();
+                m_versions.resize(m_chunks.size() * columnCount());
+            }
+            return moved;
+        }
+
+        // Move 'row' into 'dst' (a store whose signature differs by some components): shared columns
+        // and row tags are copied, columns only in 'dst' keep their defaults, then the row is
+        // swap-removed here. Returns the new row in 'dst'; 'moved' receives the entity swapped into
+        // 'row' (invalid if none) so the caller can patch both records.
+        uint32_t moveRowTo(uint32_t row, ArchetypeStore &dst, Entity &moved)
+        {
+            Entity owner{};
+            std::memcpy(&owner, element(kEntityColumn, row), sizeof(Entity));
+            const uint32_t dstRow = dst.createRow(owner);
+
+            for (uint32_t c = kEntityColumn + 1; c < dst.columnCount(); ++c)
+            {
+                const uint32_t src = columnOfComponent(dst.m_columns[c].componentId);
+                if (src != kNoColumn)
+                    dst.copyElement(*this, src, row, c, dstRow);
+            }
+            for (const auto &plane : m_tagPlanes)
+                if (testBit(plane.bits, row))
+                    dst.setTag(dstRow, plane.tagId);
 
-            swapErase(m_entities);
-            swapErase(m_rowMasks);
-            if (hasPosition())
-                swapErase(m_positions);
-            if (hasVelocity())
-                swapErase(m_velocities);
-            if (hasHealth())
-                swapErase(m_healths);
-            if (hasMoveTarget())
-                swapErase(m_moveTargets);
-            if (hasMoveSpeed())
-                swapErase(m_moveSpeeds);
-            if (hasRadius())
-                swapErase(m_radii);
-            if (hasSeparation())
-                swapErase(m_separations);
-            if (hasAvoidanceParams())
-                swapErase(m_avoidanceParams);
-            if (hasRenderModel())
-                swapErase(m_renderModels);
-            if (hasRenderAnimation())
-                swapErase(m_renderAnimations);
-            if (hasFacing())
-                swapErase(m_facings);
+            moved = destroyRow(row);
+            return dstRow;
         }
 
         // Apply typed defaults for a newly created row.
@@ -110,171 +143,693 @@ namespace Engine::ECS
         {
             for (const auto &kv : defaults)
             {
-                const uint32_t cid = kv.first;
-                if (!m_signature.has(cid))
-                    continue;
+                const uint32_t c = columnOfComponent(kv.first);
+                if (c != kNoColumn && kv.second.size() == m_columns[c].size)
+                    writeElement(c, row, kv.second.data());
+            }
+        }
 
-                if (std::holds_alternative<Position>(kv.second) && hasPosition())
-                {
-                    m_positions[row] = std::get<Position>(kv.second);
-                }
-                else if (std::holds_alternative<Velocity>(kv.second) && hasVelocity())
-                {
-                    m_velocities[row] = std::get<Velocity>(kv.second);
-                }
-                else if (std::holds_alternative<Health>(kv.second) && hasHealth())
-                {
-                    m_healths[row] = std::get<Health>(kv.second);
-                }
-                else if (std::holds_alternative<MoveTarget>(kv.second) && hasMoveTarget())
-                {
-                    m_moveTargets[row] = std::get<MoveTarget>(kv.second);
-                }
-                else if (std::holds_alternative<MoveSpeed>(kv.second) && hasMoveSpeed())
-                {
-                    m_moveSpeeds[row] = std::get<MoveSpeed>(kv.second);
-                }
-                else if (std::holds_alternative<Radius>(kv.second) && hasRadius())
-                {
-                    m_radii[row] = std::get<Radius>(kv.second);
-                }
-                else if (std::holds_alternative<Separation>(kv.second) && hasSeparation())
-                {
-                    m_separations[row] = std::get<Separation>(kv.second);
-                }
-                else if (std::holds_alternative<AvoidanceParams>(kv.second) && hasAvoidanceParams())
-                {
-                    m_avoidanceParams[row] = std::get<AvoidanceParams>(kv.second);
-                }
-                else if (std::holds_alternative<RenderModel>(kv.second) && hasRenderModel())
-                {
-                    m_renderModels[row] = std::get<RenderModel>(kv.second);
-                }
-                else if (std::holds_alternative<RenderAnimation>(kv.second) && hasRenderAnimation())
-                {
-                    m_renderAnimations[row] = std::get<RenderAnimation>(kv.second);
-                }
-                else if (std::holds_alternative<Facing>(kv.second) && hasFacing())
-                {
-                    m_facings[row] = std::get<Facing>(kv.second);
-                }
+        // Build a row image (every present column, packed like the prototype) with defaults applied once.
+        // Pass it to createRows() to stamp many identical rows.
+        std::vector<std::byte> makeRowTemplate(const std::unordered_map<uint32_t, DefaultValue> &defaults) const
+        {
+            std::vector<std::byte> image = m_prototype;
+            for (const auto &kv : defaults)
+            {
+                const uint32_t c = columnOfComponent(kv.first);
+                if (c != kNoColumn && kv.second.size() == m_columns[c].size)
+                    std::memcpy(image.data() + m_columns[c].protoOffset, kv.second.data(), m_columns[c].size);
+            }
+            return image;
+        }
+
+        // Append 'count' rows owned by 'owners', each initialized from 'rowTemplate' (see makeRowTemplate).
+        // Allocates all needed chunks up front and fills column by column. Returns the first new row.
+        uint32_t createRows(const Entity *owners, uint32_t count, const std::vector<std::byte> &rowTemplate)
+        {
+            const uint32_t first = m_size;
+            if (count == 0 || rowTemplate.size() != m_prototype.size())
+                return first;
+
+            reserve(first + count);
+            m_size += count;
+            ++m_structureVersion;
+            growTagPlanes();
+            for (uint32_t chunk = first / m_rowsPerChunk; chunk < chunkCount(); ++chunk)
+                markChunkChanged(chunk);
+
+            for (uint32_t c = kEntityColumn + 1; c < columnCount(); ++c)
+            {
+                const ColumnLayout &col = m_columns[c];
+                const std::byte *src = rowTemplate.data() + col.protoOffset;
+                for (uint32_t row = first; row < m_size; ++row)
+                    writeElement(c, row, src);
+            }
+
+            // Owners are contiguous per chunk: one copy per chunk segment.
+            uint32_t row = first;
+            while (row < m_size)
+            {
+                const uint32_t segmentEnd = std::min(m_size, (row / m_rowsPerChunk + 1) * m_rowsPerChunk);
+                std::memcpy(element(kEntityColumn, row), owners + (row - first), (segmentEnd - row) * sizeof(Entity));
+                row = segmentEnd;
+            }
+            return first;
+        }
+
+        // Drop every row (chunks are kept for reuse). Entity records pointing here must be reset by the caller.
+        void clearRows()
+        {
+            m_size = 0;
+            ++m_structureVersion;
+            for (auto &plane : m_tagPlanes)
+                std::fill(plane.bits.begin(), plane.bits.end(), 0ull);
+            std::fill(m_versions.begin(), m_versions.end(), m_tick);
+        }
+
+        // Reorder rows so that new row i holds what was row order[i] ('order' is a permutation of
+        // [0, size())). Columns and row tags move together; entity records must be patched by the caller.
+        void permuteRows(const uint32_t *order)
+        {
+            std::vector<std::byte> scratch;
+            for (uint32_t c = 0; c < columnCount(); ++c)
+            {
+                const uint32_t size = m_columns[c].size;
+                scratch.resize(size_t(m_size) * size);
+                for (uint32_t row = 0; row < m_size; ++row)
+                    readElement(c, order[row], scratch.data() + size_t(row) * size);
+                for (uint32_t row = 0; row < m_size; ++row)
+                    writeElement(c, row, scratch.data() + size_t(row) * size);
+            }
+            for (auto &plane : m_tagPlanes)
+            {
+                std::vector<uint64_t> bits(plane.bits.size(), 0ull);
+                for (uint32_t row = 0; row < m_size; ++row)
+                    assignBit(bits, row, testBit(plane.bits, order[row]));
+                plane.bits.swap(bits);
             }
+            for (uint32_t chunk = 0; chunk < chunkCount(); ++chunk)
+                markChunkChanged(chunk);
+            ++m_structureVersion;
+        }
+
+        // Replace all rows with 'chunkCount' raw chunk images holding 'rowCount' rows. The images must
+        // come from a store with an identical layout (same rowsPerChunk and column descriptors).
+        void adoptChunks(const std::byte *chunks, uint32_t chunkCount, uint32_t rowCount)
+        {
+            clearRows();
+            reserve(chunkCount * m_rowsPerChunk);
+            for (uint32_t c = 0; c < chunkCount; ++c)
+                std::memcpy(m_chunks[c].get(), chunks + size_t(c) * kChunkBytes, kChunkBytes);
+            m_size = std::min(rowCount, chunkCount * m_rowsPerChunk);
+            growTagPlanes();
+        }
+
+        // Raw bytes of chunk 'chunk' (kChunkBytes), for snapshots.
+        const std::byte *chunkBytes(uint32_t chunk) const { return m_chunks[chunk].get(); }
+
+        // Pre-allocate chunks for at least 'rows' rows.
+        void reserve(uint32_t rows)
+        {
+            while (capacity() < rows)
+                addChunk();
+            growTagPlanes();
         }
 
         // Accessors
         const ComponentMask &signature() const { return m_signature; }
-        uint32_t size() const { return static_cast<uint32_t>(m_entities.size()); }
+        uint32_t size() const { return m_size; }
+        // Bumped whenever rows are added, removed or reordered; (storeId, row) references cached by a
+        // system stay valid while this is unchanged.
+        uint32_t structureVersion() const { return m_structureVersion; }
+        uint32_t capacity() const { return static_cast<uint32_t>(m_chunks.size()) * m_rowsPerChunk; }
+
+        // Chunk iteration.
+        uint32_t rowsPerChunk() const { return m_rowsPerChunk; }
+        uint32_t chunkCount() const { return (m_size + m_rowsPerChunk - 1) / m_rowsPerChunk; }
+        uint32_t chunkRowBegin(uint32_t chunk) const { return chunk * m_rowsPerChunk; }
+        uint32_t chunkRowEnd(uint32_t chunk) const { return std::min(m_size, (chunk + 1) * m_rowsPerChunk); }
+
+        // Change tracking: every (chunk, column) pair carries the tick of its last write.
+        // Writers call markChanged<T>(chunk) after mutating a chunk; readers compare against the
+        // tick of their previous run (inclusive, so a change is never missed — at worst seen twice).
+        void setTick(uint32_t tick) { m_tick = tick; }
+        uint32_t tick() const { return m_tick; }
+
+        template <typename T>
+        void markChanged(uint32_t chunk)
+        {
+            const uint32_t c = columnIndexOf<T>();
+            if (c != kNoColumn)
+                m_versions[chunk * columnCount() + c] = m_tick;
+        }
 
-        // Row-level masks (e.g., exclude tags applied per row).
-        std::vector<ComponentMask> &rowMasks() { return m_rowMasks; }
-        const std::vector<ComponentMask> &rowMasks() const { return m_rowMasks; }
+        template <typename T>
+        uint32_t chunkVersion(uint32_t chunk) const
+        {
+            const uint32_t c = columnIndexOf<T>();
+            return c != kNoColumn ? m_versions[chunk * columnCount() + c] : 0u;
+        }
 
-        // Component arrays (conditionally enabled).
-        std::vector<Position> &positions() { return m_positions; }
-        const std::vector<Position> &positions() const { return m_positions; }
+        template <typename T>
+        bool changedSince(uint32_t chunk, uint32_t sinceTick) const
+        {
+            return chunkVersion<T>(chunk) >= sinceTick;
+        }
 
-        std::vector<Velocity> &velocities() { return m_velocities; }
-        const std::vector<Velocity> &velocities() const { return m_velocities; }
+        // Row-level tags (e.g. Selected, Disabled) not part of the signature, stored as one bit per row.
+        // A tag that is in the signature counts as set on every row.
+        bool hasTag(uint32_t row, uint32_t tagId) const
+        {
+            if (m_signature.has(tagId))
+                return true;
+            const TagPlane *plane = findPlane(tagId);
+            return plane && testBit(plane->bits, row);
+        }
 
-        std::vector<Health> &healths() { return m_healths; }
-        const std::vector<Health> &healths() const { return m_healths; }
+        void setTag(uint32_t row, uint32_t tagId)
+        {
+            if (row >= m_size || m_signature.has(tagId))
+                return;
+            if (TagPlane *plane = getOrCreatePlane(tagId))
+                assignBit(plane->bits, row, true);
+        }
 
-        std::vector<MoveTarget> &moveTargets() { return m_moveTargets; }
-        const std::vector<MoveTarget> &moveTargets() const { return m_moveTargets; }
+        void clearTag(uint32_t row, uint32_t tagId)
+        {
+            if (row >= m_size)
+                return;
+            if (TagPlane *plane = findPlane(tagId))
+                assignBit(plane->bits, row, false);
+        }
 
-        std::vector<MoveSpeed> &moveSpeeds() { return m_moveSpeeds; }
-        const std::vector<MoveSpeed> &moveSpeeds() const { return m_moveSpeeds; }
+        // Clear a tag on every row (one memset).
+        void clearTagAll(uint32_t tagId)
+        {
+            if (TagPlane *plane = findPlane(tagId))
+                std::fill(plane->bits.begin(), plane->bits.end(), 0ull);
+        }
 
-        std::vector<Radius> &radii() { return m_radii; }
-        const std::vector<Radius> &radii() const { return m_radii; }
+        // Tag bit words (64 rows per word), or nullptr if no row ever carried the tag.
+        const uint64_t *tagWords(uint32_t tagId) const
+        {
+            const TagPlane *plane = findPlane(tagId);
+            return plane ? plane->bits.data() : nullptr;
+        }
 
-        std::vector<Separation> &separations() { return m_separations; }
-        const std::vector<Separation> &separations() const { return m_separations; }
+        // Writable tag bit words (at least (size() + 63) / 64), creating the plane if needed; nullptr if the tag
+        // is in the signature or no plane is free. Callers must keep bits past size() clear.
+        uint64_t *tagWordsForWrite(uint32_t tagId)
+        {
+            if (m_signature.has(tagId))
+                return nullptr;
+            TagPlane *plane = getOrCreatePlane(tagId);
+            return plane ? plane->bits.data() : nullptr;
+        }
 
-        std::vector<AvoidanceParams> &avoidanceParams() { return m_avoidanceParams; }
-        const std::vector<AvoidanceParams> &avoidanceParams() const { return m_avoidanceParams; }
+        // Tag planes by index, for snapshots; restoreTagWords() recreates a plane from saved words.
+        uint32_t tagPlaneCount() const { return static_cast<uint32_t>(m_tagPlanes.size()); }
+        uint32_t tagPlaneId(uint32_t plane) const { return m_tagPlanes[plane].tagId; }
+        const std::vector<uint64_t> &tagPlaneWords(uint32_t plane) const { return m_tagPlanes[plane].bits; }
 
-        std::vector<RenderModel> &renderModels() { return m_renderModels; }
-        const std::vector<RenderModel> &renderModels() const { return m_renderModels; }
+        void restoreTagWords(uint32_t tagId, const uint64_t *words, uint32_t wordCount)
+        {
+            if (m_signature.has(tagId))
+                return;
+            if (TagPlane *plane = getOrCreatePlane(tagId))
+            {
+                const uint32_t n = std::min<uint32_t>(wordCount, static_cast<uint32_t>(plane->bits.size()));
+                std::copy(words, words + n, plane->bits.begin());
+            }
+        }
+
+        // Set 'tagId' on every row whose bit is set in 'words' (64 rows per word), one OR per word.
+        // Bits past size() are ignored.
+        void addTagWords(uint32_t tagId, const uint64_t *words, uint32_t wordCount)
+        {
+            if (m_signature.has(tagId) || m_size == 0)
+                return;
+            if (TagPlane *plane = getOrCreatePlane(tagId))
+            {
+                const uint32_t n = std::min<uint32_t>(wordCount, (m_size + 63) / 64);
+                for (uint32_t w = 0; w < n; ++w)
+                    plane->bits[w] |= words[w];
+                if (n == (m_size + 63) / 64 && (m_size & 63u) != 0)
+                    plane->bits[n - 1] &= (1ull << (m_size & 63u)) - 1ull;
+            }
+        }
+
+        // Word-at-a-time row filter for required/excluded masks (see RowFilter below).
+        RowFilter rowFilter(const ComponentMask &required, const ComponentMask &excluded) const;
+
+        // Owning entity per row.
+        Column<const Entity> entities() const { return column<const Entity>(); }
+
+        // Component columns (invalid/empty views when the signature lacks the component).
+        ColumnView<Position> positions() { return column<Position>(); }
+        ColumnView<const Position> positions() const { return column<const Position>(); }
+
+        ColumnView<Velocity> velocities() { return column<Velocity>(); }
+        ColumnView<const Velocity> velocities() const { return column<const Velocity>(); }
+
+        ColumnView<Health> healths() { return column<Health>(); }
+        ColumnView<const Health> healths() const { return column<const Health>(); }
+
+        ColumnView<MoveTarget> moveTargets() { return column<MoveTarget>(); }
+        ColumnView<const MoveTarget> moveTargets() const { return column<const MoveTarget>(); }
+
+        ColumnView<MoveSpeed> moveSpeeds() { return column<MoveSpeed>(); }
+        ColumnView<const MoveSpeed> moveSpeeds() const { return column<const MoveSpeed>(); }
+
+        ColumnView<Radius> radii() { return column<Radius>(); }
+        ColumnView<const Radius> radii() const { return column<const Radius>(); }
+
+        ColumnView<Separation> separations() { return column<Separation>(); }
+        ColumnView<const Separation> separations() const { return column<const Separation>(); }
 
-        std::vector<RenderAnimation> &renderAnimations() { return m_renderAnimations; }
-        const std::vector<RenderAnimation> &renderAnimations() const { return m_renderAnimations; }
+        ColumnView<AvoidanceParams> avoidanceParams() { return column<AvoidanceParams>(); }
+        ColumnView<const AvoidanceParams> avoidanceParams() const { return column<const AvoidanceParams>(); }
 
-        std::vector<Facing> &facings() { return m_facings; }
-        const std::vector<Facing> &facings() const { return m_facings; }
+        ColumnView<RenderModel> renderModels() { return column<RenderModel>(); }
+        ColumnView<const RenderModel> renderModels() const { return column<const RenderModel>(); }
+
+        ColumnView<RenderAnimation> renderAnimations() { return column<RenderAnimation>(); }
+        ColumnView<const RenderAnimation> renderAnimations() const { return column<const RenderAnimation>(); }
+
+        ColumnView<Facing> facings() { return column<Facing>(); }
+        ColumnView<const Facing> facings() const { return column<const Facing>(); }
+
+        // Typed column access for any registered component (invalid view when absent).
+        // Split-scalar components (SplitFields<T>::enabled) come back as SplitColumn<T>.
+        template <typename T>
+        ColumnView<T> column() const
+        {
+            const uint32_t c = columnIndexOf<std::remove_const_t<T>>();
+            if (c == kNoColumn)
+                return ColumnView<T>{};
+            return ColumnView<T>(&m_chunks, m_columns[c].offset, m_rowShift, m_size);
+        }
+
+        template <typename T>
+        bool has() const { return columnIndexOf<T>() != kNoColumn; }
 
         // Helpers
-        bool hasPosition() const { return m_hasPosition; }
-        bool hasVelocity() const { return m_hasVelocity; }
-        bool hasHealth() const { return m_hasHealth; }
-        bool hasMoveTarget() const { return m_hasMoveTarget; }
-        bool hasMoveSpeed() const { return m_hasMoveSpeed; }
-        bool hasRadius() const { return m_hasRadius; }
-        bool hasSeparation() const { return m_hasSeparation; }
-        bool hasAvoidanceParams() const { return m_hasAvoidanceParams; }
-        bool hasRenderModel() const { return m_hasRenderModel; }
-        bool hasRenderAnimation() const { return m_hasRenderAnimation; }
-        bool hasFacing() const { return m_hasFacing; }
-
-        // Resolve which known components are present in signature; enables arrays accordingly.
-        void resolveKnownComponents(ComponentRegistry &registry)
-        {
-            const uint32_t posId = registry.ensureId("Position");
-            const uint32_t velId = registry.ensureId("Velocity");
-            const uint32_t heaId = registry.ensureId("Health");
-            const uint32_t tgtId = registry.ensureId("MoveTarget");
-            const uint32_t spdId = registry.ensureId("MoveSpeed");
-            const uint32_t radId = registry.ensureId("Radius");
-            const uint32_t sepId = registry.ensureId("Separation");
-            const uint32_t apId = registry.ensureId("AvoidanceParams");
-            const uint32_t rmId = registry.ensureId("RenderModel");
-            const uint32_t raId = registry.ensureId("RenderAnimation");
-            const uint32_t faceId = registry.ensureId("Facing");
-            m_hasPosition = m_signature.has(posId);
-            m_hasVelocity = m_signature.has(velId);
-            m_hasHealth = m_signature.has(heaId);
-            m_hasMoveTarget = m_signature.has(tgtId);
-            m_hasMoveSpeed = m_signature.has(spdId);
-            m_hasRadius = m_signature.has(radId);
-            m_hasSeparation = m_signature.has(sepId);
-            m_hasAvoidanceParams = m_signature.has(apId);
-            m_hasRenderModel = m_signature.has(rmId);
-            m_hasRenderAnimation = m_signature.has(raId);
-            m_hasFacing = m_signature.has(faceId);
+        bool hasPosition() const { return has<Position>(); }
+        bool hasVelocity() const { return has<Velocity>(); }
+        bool hasHealth() const { return has<Health>(); }
+        bool hasMoveTarget() const { return has<MoveTarget>(); }
+        bool hasMoveSpeed() const { return has<MoveSpeed>(); }
+        bool hasRadius() const { return has<Radius>(); }
+        bool hasSeparation() const { return has<Separation>(); }
+        bool hasAvoidanceParams() const { return has<AvoidanceParams>(); }
+        bool hasRenderModel() const { return has<RenderModel>(); }
+        bool hasRenderAnimation() const { return has<RenderAnimation>(); }
+        bool hasFacing() const { return has<Facing>(); }
+
+        // Untyped column access (by component ID) for generic code such as migration and snapshots.
+        static constexpr uint32_t kNoColumn = UINT32_MAX;
+        uint32_t columnCount() const { return static_cast<uint32_t>(m_columns.size()); }
+        uint32_t columnOfComponent(uint32_t componentId) const
+        {
+            return componentId < m_columnOfComponent.size() ? m_columnOfComponent[componentId] : kNoColumn;
+        }
+        uint32_t columnComponentId(uint32_t column) const { return m_columns[column].componentId; }
+        uint32_t columnElementSize(uint32_t column) const { return m_columns[column].size; }
+        uint32_t columnLanes(uint32_t column) const { return m_columns[column].lanes; }
+        uint32_t columnOffset(uint32_t column) const { return m_columns[column].offset; }
+
+        // Copy one element in/out in packed (struct) form, whichever way the column is stored.
+        void writeElement(uint32_t column, uint32_t row, const std::byte *src)
+        {
+            const ColumnLayout &col = m_columns[column];
+            if (col.lanes == 0)
+            {
+                std::memcpy(element(column, row), src, col.size);
+                return;
+            }
+            std::byte *lane0 = element(column, row);
+            for (uint32_t k = 0; k < col.lanes; ++k)
+                std::memcpy(lane0 + k * laneStride(), src + k * kLaneBytes, kLaneBytes);
+        }
+
+        void readElement(uint32_t column, uint32_t row, std::byte *dst) const
+        {
+            const ColumnLayout &col = m_columns[column];
+            if (col.lanes == 0)
+            {
+                std::memcpy(dst, element(column, row), col.size);
+                return;
+            }
+            const std::byte *lane0 = element(column, row);
+            for (uint32_t k = 0; k < col.lanes; ++k)
+                std::memcpy(dst + k * kLaneBytes, lane0 + k * laneStride(), kLaneBytes);
+        }
+
+    private:
+        static constexpr uint32_t kEntityColumn = 0; // owning entity, always present
+        static constexpr uint32_t kLaneBytes = 4;    // split-scalar lane width
+
+        struct ColumnLayout
+        {
+            uint32_t componentId = ComponentRegistry::InvalidID; // InvalidID for the entity column
+            uint32_t size = 0;                                   // bytes per element
+            uint32_t lanes = 0;                                  // > 0: split-scalar, 'lanes' 4-byte arrays
+            uint32_t offset = 0;                                 // byte offset of the column inside each chunk
+            uint32_t protoOffset = 0;                            // byte offset of the default value inside m_prototype
+        };
+
+        template <typename T>
+        uint32_t columnIndexOf() const
+        {
+            if constexpr (std::is_same_v<T, Entity>)
+                return kEntityColumn;
+            else
+            {
+                const uint32_t t = componentTypeIndex<T>();
+                return t < m_columnOfType.size() ? m_columnOfType[t] : kNoColumn;
+            }
+        }
+
+        void addColumn(uint32_t componentId, uint32_t size, uint32_t lanes, const void *defaultValue)
+        {
+            ColumnLayout col;
+            col.componentId = componentId;
+            col.size = size;
+            col.lanes = lanes;
+            col.protoOffset = static_cast<uint32_t>(m_prototype.size());
+            m_prototype.resize(m_prototype.size() + size);
+            std::memcpy(m_prototype.data() + col.protoOffset, defaultValue, size);
+            m_columns.push_back(col);
+        }
+
+        // One column per data component in the signature, in component-ID order after the entity column.
+        void buildColumns(const ComponentRegistry &registry)
+        {
+            m_columns.clear();
+            m_prototype.clear();
+            m_columnOfComponent.fill(kNoColumn);
+            m_columnOfType.clear();
+
+            const Entity none{};
+            addColumn(ComponentRegistry::InvalidID, sizeof(Entity), 0, &none);
+            for (uint32_t id = 0; id < registry.count(); ++id)
+            {
+                const ComponentTypeInfo &info = registry.info(id);
+                if (!m_signature.has(id) || !info.isData())
+                    continue;
+                m_columnOfComponent[id] = columnCount();
+                if (m_columnOfType.size() <= info.typeIndex)
+                    m_columnOfType.resize(info.typeIndex + 1, kNoColumn);
+                m_columnOfType[info.typeIndex] = columnCount();
+                addColumn(id, info.size, info.lanes, info.defaultValue.data());
+            }
+        }
+
+        // Pick the largest power-of-two row count whose aligned columns fit in one chunk,
+        // then assign column offsets.
+        void computeLayout()
+        {
+            auto alignUp = [](uint32_t v)
+            { return (v + kColumnAlign - 1) & ~(kColumnAlign - 1); };
+            auto bytesFor = [&](uint32_t rows)
+            {
+                uint32_t bytes = 0;
+                for (const auto &col : m_columns)
+                    bytes = alignUp(bytes) + col.size * rows;
+                return bytes;
+            };
+
+            uint32_t shift = 0;
+            while (shift < 31 && bytesFor(1u << (shift + 1)) <= kChunkBytes)
+                ++shift;
+            m_rowShift = shift;
+            m_rowsPerChunk = 1u << shift;
+
+            uint32_t offset = 0;
+            for (auto &col : m_columns)
+            {
+                offset = alignUp(offset);
+                col.offset = offset;
+                offset += col.size * m_rowsPerChunk;
+            }
+        }
+
+        struct TagPlane
+        {
+            uint32_t tagId = ComponentRegistry::InvalidID;
+            std::vector<uint64_t> bits; // covers capacity() rows
+        };
+
+        static bool testBit(const std::vector<uint64_t> &bits, uint32_t row)
+        {
+            return (bits[row >> 6] >> (row & 63)) & 1ull;
+        }
+
+        static void assignBit(std::vector<uint64_t> &bits, uint32_t row, bool value)
+        {
+            const uint64_t m = 1ull << (row & 63);
+            bits[row >> 6] = value ? (bits[row >> 6] | m) : (bits[row >> 6] & ~m);
+        }
+
+        const TagPlane *findPlane(uint32_t tagId) const
+        {
+            for (const auto &plane : m_tagPlanes)
+                if (plane.tagId == tagId)
+                    return &plane;
+            return nullptr;
+        }
+
+        TagPlane *findPlane(uint32_t tagId)
+        {
+            return const_cast<TagPlane *>(static_cast<const ArchetypeStore *>(this)->findPlane(tagId));
+        }
+
+        TagPlane *getOrCreatePlane(uint32_t tagId)
+        {
+            if (TagPlane *plane = findPlane(tagId))
+                return plane;
+            if (m_tagPlanes.size() >= kMaxTagPlanes)
+                return nullptr;
+            m_tagPlanes.push_back(TagPlane{tagId, std::vector<uint64_t>(tagWordCount(), 0ull)});
+            return &m_tagPlanes.back();
+        }
+
+        uint32_t tagWordCount() const { return (std::max(capacity(), m_size) + 63) / 64; }
+
+        void growTagPlanes()
+        {
+            const uint32_t words = tagWordCount();
+            for (auto &plane : m_tagPlanes)
+                if (plane.bits.size() < words)
+                    plane.bits.resize(words, 0ull);
+        }
+
+        void addChunk()
+        {
+            m_chunks.emplace_back(allocateChunk());
+            m_versions.resize(m_chunks.size() * columnCount(), m_tick);
+        }
+
+        void markChunkChanged(uint32_t chunk)
+        {
+            std::fill_n(m_versions.begin() + chunk * columnCount(), static_cast<size_t>(columnCount()), m_tick);
+        }
+
+        void markRowChanged(uint32_t row) { markChunkChanged(row >> m_rowShift); }
+
+        // Address of 'row' in a column: the element for packed columns, lane 0 for split columns.
+        std::byte *element(uint32_t column, uint32_t row) const
+        {
+            const ColumnLayout &col = m_columns[column];
+            std::byte *base = m_chunks[row >> m_rowShift].get();
+            return base + col.offset + (row & (m_rowsPerChunk - 1)) * (col.lanes ? kLaneBytes : col.size);
+        }
+
+        uint32_t laneStride() const { return m_rowsPerChunk * kLaneBytes; }
+
+        // Copy element (srcColumn, srcRow) of 'src' into (dstColumn, dstRow) here; both columns hold the
+        // same component, so they share size and layout.
+        void copyElement(const ArchetypeStore &src, uint32_t srcColumn, uint32_t srcRow, uint32_t dstColumn, uint32_t dstRow)
+        {
+            const ColumnLayout &col = m_columns[dstColumn];
+            if (col.lanes == 0)
+            {
+                std::memcpy(element(dstColumn, dstRow), src.element(srcColumn, srcRow), col.size);
+                return;
+            }
+            const std::byte *from = src.element(srcColumn, srcRow);
+            std::byte *to = element(dstColumn, dstRow);
+            for (uint32_t k = 0; k < col.lanes; ++k)
+                std::memcpy(to + k * laneStride(), from + k * src.laneStride(), kLaneBytes);
         }
 
     private:
         ComponentMask m_signature;
-        std::vector<Entity> m_entities;
-        std::vector<ComponentMask> m_rowMasks;
-
-        // Component arrays (only used if signature includes them).
-        std::vector<Position> m_positions;
-        std::vector<Velocity> m_velocities;
-        std::vector<Health> m_healths;
-        std::vector<MoveTarget> m_moveTargets;
-        std::vector<MoveSpeed> m_moveSpeeds;
-        std::vector<Radius> m_radii;
-        std::vector<Separation> m_separations;
-        std::vector<AvoidanceParams> m_avoidanceParams;
-        std::vector<RenderModel> m_renderModels;
-        std::vector<RenderAnimation> m_renderAnimations;
-        std::vector<Facing> m_facings;
-
-        // Flags indicating which arrays are active.
-        bool m_hasPosition = false;
-        bool m_hasVelocity = false;
-        bool m_hasHealth = false;
-        bool m_hasMoveTarget = false;
-        bool m_hasMoveSpeed = false;
-        bool m_hasRadius = false;
-        bool m_hasSeparation = false;
-        bool m_hasAvoidanceParams = false;
-        bool m_hasRenderModel = false;
-        bool m_hasRenderAnimation = false;
-        bool m_hasFacing = false;
+
+        // Row tags: at most kMaxTagPlanes distinct tags per store (RowFilter packs them in 64-bit sets).
+        static constexpr uint32_t kMaxTagPlanes = 64;
+        std::vector<TagPlane> m_tagPlanes;
+
+        friend class RowFilter;
+
+        // Chunked column storage.
+        std::vector<ChunkBlock> m_chunks;
+        std::vector<ColumnLayout> m_columns;                                  // [kEntityColumn] is the owner
+        std::array<uint32_t, ComponentMask::kBits> m_columnOfComponent{};    // component ID -> column
+        std::vector<uint32_t> m_columnOfType;                                // componentTypeIndex -> column
+        std::vector<std::byte> m_prototype;                                  // default value of every column
+        uint32_t m_rowsPerChunk = 1;
+        uint32_t m_rowShift = 0;
+        uint32_t m_size = 0;
+        uint32_t m_structureVersion = 0;
+
+        // Change ticks, [chunk * columnCount() + column]; m_tick is the manager's current tick.
+        std::vector<uint32_t> m_versions;
+        uint32_t m_tick = 1;
+
     };
 
+    // Iterates the rows of one store whose tags satisfy a required/excluded filter, one 64-row word at
+    // a time (AND of required planes, AND-NOT of excluded planes, ctz over the result).
+    // Loop shape: for (uint32_t i = f.first(begin, end); i < end; i = f.next(i, end)) { ... }
+    // Run shape:  for (uint32_t i = f.first(begin, end); i < end; i = f.first(stop, end)) { stop = f.runEnd(i, end); ... }
+    class RowFilter
+    {
+    public:
+        RowFilter() = default;
+
+        RowFilter(const ArchetypeStore &store, const ComponentMask &required, const ComponentMask &excluded)
+            : m_store(&store)
+        {
+            const ComponentMask &sig = store.signature();
+            if (sig.intersects(excluded))
+            {
+                m_none = true;
+                return;
+            }
+
+            // Required tags outside the signature must come from planes; a missing plane matches nothing.
+            for (uint32_t id = 0; id < ComponentMask::kBits; ++id)
+            {
+                if (!required.has(id) || sig.has(id))
+                    continue;
+                const ArchetypeStore::TagPlane *plane = store.findPlane(id);
+                if (!plane)
+                {
+                    m_none = true;
+                    return;
+                }
+                m_requiredPlanes |= 1ull << static_cast<uint32_t>(plane - store.m_tagPlanes.data());
+            }
+            for (uint32_t i = 0; i < store.m_tagPlanes.size(); ++i)
+            {
+                if (excluded.has(store.m_tagPlanes[i].tagId))
+                    m_excludedPlanes |= 1ull << i;
+            }
+            m_all = (m_requiredPlanes | m_excludedPlanes) == 0;
+        }
+
+        // True if every row passes (no tag planes involved): callers may take a dense fast path.
+        bool all() const { return m_all && !m_none; }
+
+        bool test(uint32_t row) const
+        {
+            if (m_none)
+                return false;
+            if (m_all)
+                return true;
+            return (word(row >> 6) >> (row & 63)) & 1ull;
+        }
+
+        // 64-row bit set of passing rows for word index w.
+        uint64_t word(uint32_t w) const
+        {
+            if (m_none)
+                return 0ull;
+            uint64_t bits = ~0ull;
+            if (m_all)
+                return bits;
+            const auto &planes = m_store->m_tagPlanes;
+            for (uint64_t m = m_requiredPlanes; m; m &= m - 1)
+                bits &= planes[ctz(m)].bits[w];
+            for (uint64_t m = m_excludedPlanes; m; m &= m - 1)
+                bits &= ~planes[ctz(m)].bits[w];
+            return bits;
+        }
+
+        // First passing row in [begin, end), or end.
+        uint32_t first(uint32_t begin, uint32_t end) const { return find(begin, end); }
+
+        // Next passing row after 'row', or end.
+        uint32_t next(uint32_t row, uint32_t end) const { return find(row + 1, end); }
+
+        // End of the run of consecutive passing rows starting at 'row' (first failing row, or end).
+        // Lets kernels process [row, runEnd) as one dense range.
+        uint32_t runEnd(uint32_t row, uint32_t end) const
+        {
+            if (m_none)
+                return row;
+            if (m_all)
+                return end;
+            while (row < end)
+            {
+                const uint32_t w = row >> 6;
+                const uint64_t failing = ~word(w) & (~0ull << (row & 63));
+                if (failing)
+                {
+                    const uint32_t stop = (w << 6) + ctz(failing);
+                    return stop < end ? stop : end;
+                }
+                row = (w + 1) << 6;
+            }
+            return end;
+        }
+
+    private:
+        static uint32_t ctz(uint64_t v)
+        {
+#if defined(_MSC_VER)
+            unsigned long idx;
+            _BitScanForward64(&idx, v);
+            return static_cast<uint32_t>(idx);
+#else
+            return static_cast<uint32_t>(__builtin_ctzll(v));
+#endif
+        }
+
+        uint32_t find(uint32_t from, uint32_t end) const
+        {
+            if (m_none)
+                return end;
+            if (m_all)
+                return from < end ? from : end;
+            while (from < end)
+            {
+                const uint32_t w = from >> 6;
+                const uint64_t bits = word(w) & (~0ull << (from & 63));
+                if (bits)
+                {
+                    const uint32_t row = (w << 6) + ctz(bits);
+                    return row < end ? row : end;
+                }
+                from = (w + 1) << 6; // skip the rest of an empty word
+            }
+            return end;
+        }
+
+    private:
+        const ArchetypeStore *m_store = nullptr;
+        uint64_t m_requiredPlanes = 0;
+        uint64_t m_excludedPlanes = 0;
+        bool m_all = true;
+        bool m_none = false;
+    };
+
+    inline RowFilter ArchetypeStore::rowFilter(const ComponentMask &required, const ComponentMask &excluded) const
+    {
+        return RowFilter(*this, required, excluded);
+    }
+
     class ArchetypeStoreManager
     {
     public:
@@ -285,8 +840,9 @@ namespace Engine::ECS
 
             if (!m_stores[archetypeId])
             {
-                m_stores[archetypeId] = std::make_unique<ArchetypeStore>(signature);
-                m_stores[archetypeId]->resolveKnownComponents(registry);
+                m_stores[archetypeId] = std::make_unique<ArchetypeStore>(signature, registry);
+                m_stores[archetypeId]->setTick(m_tick);
+                m_creationLog.push_back(archetypeId);
             }
             return m_stores[archetypeId].get();
         }
@@ -298,8 +854,24 @@ namespace Engine::ECS
 
         const std::vector<std::unique_ptr<ArchetypeStore>> &stores() const { return m_stores; }
 
+        // Advance the change tick (once per simulation tick) and propagate it to every store.
+        uint32_t beginTick()
+        {
+            ++m_tick;
+            for (auto &store : m_stores)
+                if (store)
+                    store->setTick(m_tick);
+            return m_tick;
+        }
+        uint32_t currentTick() const { return m_tick; }
+
+        // Store IDs in the order they were created; append-only, so queries can catch up incrementally.
+        const std::vector<uint32_t> &creationLog() const { return m_creationLog; }
+
     private:
         std::vector<std::unique_ptr<ArchetypeStore>> m_stores;
+        std::vector<uint32_t> m_creationLog;
+        uint32_t m_tick = 1;
     };
 
 } // namespace Engine::ECS
\ No newline at end of file
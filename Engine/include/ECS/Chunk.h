@@ -0,0 +1,167 @@
+#pragma once
+/*
+  Chunk.h
+  -------
+  Purpose:
+    - Fixed-size memory blocks used by ArchetypeStore to hold all columns of a run of rows together.
+    - Column<T>: a lightweight view that addresses one component column across a store's chunks.
+    - SplitColumn<T>: the same for components stored split-scalar (one 4-byte lane array per field).
+
+  Layout:
+    - Every chunk is kChunkBytes and holds rowsPerChunk rows (a power of two).
+    - Inside a chunk each column is a contiguous array at a fixed, kColumnAlign-aligned offset:
+        [Entity x N][Position x N][Velocity x N] ... (only columns in the store signature)
+    - Row r lives in chunk (r >> shift) at slot (r & (N - 1)); pointers stay stable until the row
+      is swap-removed, because chunks are never reallocated.
+    - Split-scalar components (SplitFields<T>::enabled) store lane k of every row contiguously:
+        [x x x ... x][y y y ... y][z z z ... z]   (lane k of slot s at offset + k*4*N + s*4)
+      so a SIMD loop loads 8 X coordinates in one instruction and Y-agnostic loops skip the Y lane.
+
+  Usage:
+    - auto pos = store.positions();            // Column<Position>
+    - pos[row].x += 1.0f;                        // random access by row
+    - for (c < store.chunkCount()) { Position *p = pos.chunkData(c); ... }   // chunk iteration
+    - Split columns: pos[row].x works the same (proxy of field references); pos.lane<float>(c, 0)
+      gives the X lane of chunk c.
+*/
+
+#include "utils/MemoryTracker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace Engine::ECS
+{
+    static constexpr uint32_t kChunkBytes = 16 * 1024;
+    static constexpr uint32_t kColumnAlign = 64; // cache line; also satisfies SIMD loads
+
+    // Chunks are counted in MemoryTracker (CpuMemoryCategory::EcsColumns).
+    struct ChunkDeleter
+    {
+        void operator()(std::byte *p) const
+        {
+            ::operator delete[](p, std::align_val_t{kColumnAlign});
+            MemoryTracker::sub(CpuMemoryCategory::EcsColumns, kChunkBytes);
+        }
+    };
+    using ChunkBlock = std::unique_ptr<std::byte[], ChunkDeleter>;
+
+    inline ChunkBlock allocateChunk()
+    {
+        ChunkBlock chunk(static_cast<std::byte *>(::operator new[](kChunkBytes, std::align_val_t{kColumnAlign})));
+        MemoryTracker::add(CpuMemoryCategory::EcsColumns, kChunkBytes);
+        return chunk;
+    }
+
+    // Opt-in split-scalar storage. Specialize with:
+    //   enabled = true, kLanes = sizeof(T) / 4, and
+    //   struct Ref { ...field references...; Ref &operator=(const T &); operator T() const; }
+    //   static Ref bind(std::byte *lane0, uint32_t laneStride);   // lane k at lane0 + k * laneStride
+    // T must be trivially copyable, 4-byte aligned and a whole number of 4-byte lanes.
+    template <typename T>
+    struct SplitFields
+    {
+        static constexpr bool enabled = false;
+        static constexpr uint32_t kLanes = 0;
+    };
+
+    // Field 'k' of a split element whose lane 0 is at 'lane0' (used by SplitFields<T>::bind).
+    template <typename F>
+    F &splitLane(std::byte *lane0, uint32_t k, uint32_t laneStride)
+    {
+        return *reinterpret_cast<F *>(lane0 + k * laneStride);
+    }
+
+    // View over one column of a chunked store. Cheap to copy; invalidated only when the store is destroyed.
+    template <typename T>
+    class Column
+    {
+    public:
+        Column() = default;
+        Column(const std::vector<ChunkBlock> *chunks, uint32_t offset, uint32_t shift, uint32_t size)
+            : m_chunks(chunks), m_offset(offset), m_shift(shift), m_mask((1u << shift) - 1u), m_size(size) {}
+
+        T &operator[](uint32_t row) const
+        {
+            return chunkData(row >> m_shift)[row & m_mask];
+        }
+
+        // First element of this column inside chunk 'chunk'.
+        T *chunkData(uint32_t chunk) const
+        {
+            return reinterpret_cast<T *>((*m_chunks)[chunk].get() + m_offset);
+        }
+
+        bool valid() const { return m_chunks != nullptr; }
+        uint32_t size() const { return m_size; }
+        uint32_t rowsPerChunk() const { return m_mask + 1u; }
+
+    private:
+        const std::vector<ChunkBlock> *m_chunks = nullptr;
+        uint32_t m_offset = 0;
+        uint32_t m_shift = 0;
+        uint32_t m_mask = 0;
+        uint32_t m_size = 0;
+    };
+
+    // View over one split-scalar column. operator[] returns SplitFields<T>::Ref (or a T copy for const
+    // views), so scalar code like col[row].x += 1 keeps compiling; lane<F>(c, k) is the SIMD path.
+    template <typename T>
+    class SplitColumn
+    {
+    public:
+        using Value = std::remove_const_t<T>;
+        using Fields = SplitFields<Value>;
+        static constexpr uint32_t kLaneBytes = 4;
+
+        SplitColumn() = default;
+        SplitColumn(const std::vector<ChunkBlock> *chunks, uint32_t offset, uint32_t shift, uint32_t size)
+            : m_chunks(chunks), m_offset(offset), m_shift(shift), m_mask((1u << shift) - 1u), m_size(size) {}
+
+        auto operator[](uint32_t row) const
+        {
+            std::byte *lane0 = chunkBase(row >> m_shift) + (row & m_mask) * kLaneBytes;
+            if constexpr (std::is_const_v<T>)
+            {
+                Value v;
+                for (uint32_t k = 0; k < Fields::kLanes; ++k)
+                    std::memcpy(reinterpret_cast<std::byte *>(&v) + k * kLaneBytes, lane0 + k * laneStride(), kLaneBytes);
+                return v;
+            }
+            else
+                return Fields::bind(lane0, laneStride());
+        }
+
+        // First element of lane 'k' inside chunk 'chunk' (rowsPerChunk() entries of type F).
+        template <typename F>
+        F *lane(uint32_t chunk, uint32_t k) const
+        {
+            static_assert(sizeof(F) == kLaneBytes, "Lanes are 4 bytes wide");
+            return reinterpret_cast<F *>(chunkBase(chunk) + k * laneStride());
+        }
+
+        bool valid() const { return m_chunks != nullptr; }
+        uint32_t size() const { return m_size; }
+        uint32_t rowsPerChunk() const { return m_mask + 1u; }
+
+    private:
+        std::byte *chunkBase(uint32_t chunk) const { return (*m_chunks)[chunk].get() + m_offset; }
+        uint32_t laneStride() const { return (m_mask + 1u) * kLaneBytes; }
+
+        const std::vector<ChunkBlock> *m_chunks = nullptr;
+        uint32_t m_offset = 0;
+        uint32_t m_shift = 0;
+        uint32_t m_mask = 0;
+        uint32_t m_size = 0;
+    };
+
+    // Column view type for T: SplitColumn when T opted into split storage, Column otherwise.
+    template <typename T>
+    using ColumnView = std::conditional_t<SplitFields<std::remove_const_t<T>>::enabled, SplitColumn<T>, Column<T>>;
+
+} // namespace Engine::ECS
@@ -0,0 +1,309 @@
+#pragma once
+/*
+  CommandBuffer.h
+  ---------------
+  Purpose:
+    - Record structural ECS changes (create / destroy / add or remove tag / add or remove component)
+      from any thread and apply them later in one batched pass at a sync point, so systems never
+      change stores while other systems iterate them.
+
+  Usage:
+    - commands.reserveThreads(jobs.threadCount());      // once, before recording from workers
+    - commands.destroy(entity);                         // from a system / job
+    - commands.addTag(entity, selectedId);
+    - commands.addTagRows(storeId, store.structureVersion(), selectedId, rowWords);  // bulk, one bit per row
+    - commands.create(prefab, Position{x, 0, z});
+    - commands.addComponent(entity, deadId);            // migrate to the archetype with Dead
+    - commands.playback(registry, archetypes, stores, entities);   // main thread, between systems
+
+  Notes:
+    - Each JobSystem thread records into its own lane (JobSystem::currentThreadIndex()), so recording
+      takes no lock; threads outside the reserved range fall back to a mutex-protected lane.
+    - Playback order: tag changes, then component add/remove (archetype migration), then destroys
+      (grouped per store, highest row first, so each swap-remove only pulls rows that survive),
+      then creates.
+    - Commands on entities that are already dead are ignored. Bulk row-tag commands are dropped if the
+      store's rows were added, removed or reordered after recording (its structureVersion changed).
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+#include "ECS/Migration.h"
+#include "ECS/PrefabSpawner.h"
+#include "utils/JobSystem.h"
+
+namespace Engine::ECS
+{
+    class CommandBuffer
+    {
+    public:
+        CommandBuffer() { m_lanes.resize(1); }
+
+        // Size the per-thread lanes (workers + the main thread). Not thread-safe; call before recording.
+        void reserveThreads(uint32_t threadCount) { m_lanes.resize(std::max(1u, threadCount)); }
+
+        void create(const Prefab *prefab)
+        {
+            Command c;
+            c.op = Op::Create;
+            c.prefab = prefab;
+            push(c);
+        }
+
+        void create(const Prefab *prefab, const Position &position)
+        {
+            Command c;
+            c.op = Op::Create;
+            c.prefab = prefab;
+            c.position = position;
+            c.hasPosition = true;
+            push(c);
+        }
+
+        void destroy(Entity e)
+        {
+            Command c;
+            c.op = Op::Destroy;
+            c.entity = e;
+            push(c);
+        }
+
+        void addTag(Entity e, uint32_t tagId)
+        {
+            Command c;
+            c.op = Op::AddTag;
+            c.entity = e;
+            c.tagId = tagId;
+            push(c);
+        }
+
+        void removeTag(Entity e, uint32_t tagId)
+        {
+            Command c;
+            c.op = Op::RemoveTag;
+            c.entity = e;
+            c.tagId = tagId;
+            push(c);
+        }
+
+        // Move the entity to the archetype with/without 'componentId' (new columns keep their defaults).
+        void addComponent(Entity e, uint32_t componentId)
+        {
+            Command c;
+            c.op = Op::AddComponent;
+            c.entity = e;
+            c.tagId = componentId;
+            push(c);
+        }
+
+        void removeComponent(Entity e, uint32_t componentId)
+        {
+            Command c;
+            c.op = Op::RemoveComponent;
+            c.entity = e;
+            c.tagId = componentId;
+            push(c);
+        }
+
+        // Set a tag on the rows of one store given as a bitmask (64 rows per word), e.g. a marquee
+        // selection. 'structureVersion' is the store's structureVersion() when the rows were chosen.
+        void addTagRows(uint32_t storeId, uint32_t structureVersion, uint32_t tagId, std::vector<uint64_t> rowWords)
+        {
+            Command c;
+            c.op = Op::AddTagRows;
+            c.tagId = tagId;
+            c.storeId = storeId;
+            c.structureVersion = structureVersion;
+            {
+                std::lock_guard<std::mutex> lock(*m_overflowMutex);
+                c.payload = static_cast<uint32_t>(m_rowMasks.size());
+                m_rowMasks.push_back(std::move(rowWords));
+            }
+            push(c);
+        }
+
+        // Clear a tag on every row of every store.
+        void clearTagAll(uint32_t tagId)
+        {
+            Command c;
+            c.op = Op::ClearTagAll;
+            c.tagId = tagId;
+            push(c);
+        }
+
+        bool empty() const
+        {
+            for (const auto &lane : m_lanes)
+                if (!lane.empty())
+                    return false;
+            return m_overflow.empty();
+        }
+
+        // Apply and clear all recorded commands. Call with no systems running.
+        void playback(ComponentRegistry &registry, ArchetypeManager &archetypes,
+                      ArchetypeStoreManager &stores, EntitiesRecord &entities)
+        {
+            gather();
+            if (m_pending.empty())
+                return;
+
+            // 1) Tags (row-local; recording order is preserved per thread).
+            for (const Command &c : m_pending)
+            {
+                if (c.op == Op::ClearTagAll)
+                {
+                    for (const auto &ptr : stores.stores())
+                        if (ptr)
+                            ptr->clearTagAll(c.tagId);
+                    continue;
+                }
+                if (c.op == Op::AddTagRows)
+                {
+                    ArchetypeStore *store = stores.get(c.storeId);
+                    const std::vector<uint64_t> &words = m_rowMasks[c.payload];
+                    if (store && store->structureVersion() == c.structureVersion)
+                        store->addTagWords(c.tagId, words.data(), static_cast<uint32_t>(words.size()));
+                    continue;
+                }
+                if (c.op != Op::AddTag && c.op != Op::RemoveTag)
+                    continue;
+                const EntityRecord *rec = entities.find(c.entity);
+                if (!rec)
+                    continue;
+                ArchetypeStore *store = stores.get(rec->archetypeId);
+                if (!store || rec->row >= store->size())
+                    continue;
+                if (c.op == Op::AddTag)
+                    store->setTag(rec->row, c.tagId);
+                else
+                    store->clearTag(rec->row, c.tagId);
+            }
+
+            // 2) Archetype migrations, in recording order.
+            for (const Command &c : m_pending)
+            {
+                if (c.op == Op::AddComponent)
+                    addComponentById(c.entity, c.tagId, registry, archetypes, stores, entities);
+                else if (c.op == Op::RemoveComponent)
+                    removeComponentById(c.entity, c.tagId, registry, archetypes, stores, entities);
+            }
+
+            // 3) Destroys, one descending pass per store.
+            m_doomed.clear();
+            for (const Command &c : m_pending)
+            {
+                if (c.op != Op::Destroy)
+                    continue;
+                const EntityRecord *rec = entities.find(c.entity);
+                if (rec)
+                    m_doomed.push_back(Doomed{rec->archetypeId, rec->row, c.entity});
+            }
+            std::sort(m_doomed.begin(), m_doomed.end(), [](const Doomed &a, const Doomed &b)
+                      { return a.archetypeId != b.archetypeId ? a.archetypeId < b.archetypeId : a.row > b.row; });
+            m_doomed.erase(std::unique(m_doomed.begin(), m_doomed.end(), [](const Doomed &a, const Doomed &b)
+                                       { return a.archetypeId == b.archetypeId && a.row == b.row; }),
+                           m_doomed.end());
+            for (const Doomed &d : m_doomed)
+            {
+                if (ArchetypeStore *store = stores.get(d.archetypeId))
+                {
+                    const Entity moved = store->destroyRow(d.row);
+                    if (moved.valid())
+                        entities.setRow(moved, d.row);
+                }
+                entities.destroy(d.entity);
+            }
+
+            // 4) Creates.
+            for (const Command &c : m_pending)
+            {
+                if (c.op != Op::Create || !c.prefab)
+                    continue;
+                const SpawnResult res = spawnFromPrefab(*c.prefab, registry, archetypes, stores, entities);
+                if (!c.hasPosition)
+                    continue;
+                ArchetypeStore *store = stores.get(res.archetypeId);
+                if (store && store->hasPosition())
+                    store->positions()[res.row] = c.position;
+            }
+
+            m_pending.clear();
+            m_rowMasks.clear();
+        }
+
+    private:
+        enum class Op : uint8_t
+        {
+            Create,
+            Destroy,
+            AddTag,
+            RemoveTag,
+            ClearTagAll,
+            AddTagRows,
+            AddComponent,
+            RemoveComponent
+        };
+
+        struct Command
+        {
+            Op op = Op::Destroy;
+            bool hasPosition = false;
+            uint32_t tagId = ComponentRegistry::InvalidID; // tag or component ID
+            uint32_t storeId = 0;                          // AddTagRows: target store, its version, mask index
+            uint32_t structureVersion = 0;
+            uint32_t payload = 0;
+            Entity entity{};
+            const Prefab *prefab = nullptr;
+            Position position{};
+        };
+
+        struct Doomed
+        {
+            uint32_t archetypeId;
+            uint32_t row;
+            Entity entity;
+        };
+
+        void push(const Command &c)
+        {
+            const uint32_t lane = JobSystem::currentThreadIndex();
+            if (lane < m_lanes.size())
+            {
+                m_lanes[lane].push_back(c);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(*m_overflowMutex);
+            m_overflow.push_back(c);
+        }
+
+        // Concatenate lanes in thread order into m_pending.
+        void gather()
+        {
+            for (auto &lane : m_lanes)
+            {
+                m_pending.insert(m_pending.end(), lane.begin(), lane.end());
+                lane.clear();
+            }
+            std::lock_guard<std::mutex> lock(*m_overflowMutex);
+            m_pending.insert(m_pending.end(), m_overflow.begin(), m_overflow.end());
+            m_overflow.clear();
+        }
+
+    private:
+        std::vector<std::vector<Command>> m_lanes;
+        std::vector<Command> m_overflow;
+        std::vector<std::vector<uint64_t>> m_rowMasks; // AddTagRows payloads (guarded by m_overflowMutex)
+        std::unique_ptr<std::mutex> m_overflowMutex = std::make_unique<std::mutex>(); // keeps the buffer movable
+
+        // Playback scratch (kept to avoid per-frame allocations).
+        std::vector<Command> m_pending;
+        std::vector<Doomed> m_doomed;
+    };
+
+} // namespace Engine::ECS
@@ -4,14 +4,19 @@
   ------------
   Purpose:
     - Define component data structures (Position, Velocity, Health).
-    - Provide ComponentRegistry for name <-> ID mapping (data-driven).
-    - Provide ComponentMask: dynamic bitset keyed by component IDs.
+    - Provide ComponentRegistry for name <-> ID mapping (data-driven) and per-ID type info.
+    - Provide ComponentMask: fixed-width inline bitset keyed by component IDs.
 
   Usage:
     - ComponentRegistry gives stable numeric IDs for component names defined in JSON.
+    - registry.registerComponent<Ammo>("Ammo") registers a data component: stores whose signature
+      contains it get a dense column of Ammo (size/alignment/default taken from the type).
+      Names registered without a type are tags (bits only, no column). Built-in engine components
+      are registered by the registry constructor.
     - ComponentMask builds signatures using those IDs to represent an entity/archetype's component set.
 */
 
+#include <cassert>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -19,8 +24,30 @@
 #include <iomanip>
 #include <algorithm>
 #include <unordered_map>
-#include <variant>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
 #include <assets/Handles.h>
+#include "ECS/Chunk.h"
+#include "utils/Log.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Maximum number of distinct component/tag IDs; override at build time if a game needs more.
+#ifndef ENGINE_ECS_MAX_COMPONENTS
+#define ENGINE_ECS_MAX_COMPONENTS 128
+#endif
+
+// Store Position/Velocity/MoveTarget split-scalar (x[], y[], z[] per chunk) instead of as structs.
+// Scalar code keeps compiling through SplitColumn proxies; SIMD systems read the lanes directly.
+#ifndef ENGINE_ECS_SPLIT_HOT_COMPONENTS
+#define ENGINE_ECS_SPLIT_HOT_COMPONENTS 0
+#endif
 
 namespace Engine::ECS
 {
@@ -114,8 +141,145 @@ namespace Engine::ECS
         float yaw = 0.0f;  // Rotation around Y axis in radians
     };
 
-    // Typed defaults per component ID (used by Prefabs/Stores).
-    using DefaultValue = std::variant<Position, Velocity, Health, MoveTarget, MoveSpeed, Radius, Separation, AvoidanceParams, RenderModel, RenderAnimation, Facing>;
+    // -----------------------
+    // Split-scalar layouts (opt-in, see Chunk.h)
+    // -----------------------
+    // Field proxy shared by the xyz float components.
+    template <typename T>
+    struct Vec3SplitFields
+    {
+        static constexpr bool enabled = ENGINE_ECS_SPLIT_HOT_COMPONENTS != 0;
+        static constexpr uint32_t kLanes = 3;
+
+        struct Ref
+        {
+            float &x, &y, &z;
+            Ref &operator=(const T &v)
+            {
+                x = v.x;
+                y = v.y;
+                z = v.z;
+                return *this;
+            }
+            Ref &operator=(const Ref &o) { return *this = static_cast<T>(o); }
+            operator T() const { return T{x, y, z}; }
+        };
+
+        static Ref bind(std::byte *lane0, uint32_t stride)
+        {
+            return Ref{splitLane<float>(lane0, 0, stride), splitLane<float>(lane0, 1, stride), splitLane<float>(lane0, 2, stride)};
+        }
+    };
+
+    template <>
+    struct SplitFields<Position> : Vec3SplitFields<Position>
+    {
+    };
+
+    template <>
+    struct SplitFields<Velocity> : Vec3SplitFields<Velocity>
+    {
+    };
+
+    // MoveTarget: x/y/z lanes plus a lane holding 'active' (and its padding).
+    template <>
+    struct SplitFields<MoveTarget>
+    {
+        static constexpr bool enabled = ENGINE_ECS_SPLIT_HOT_COMPONENTS != 0;
+        static constexpr uint32_t kLanes = 4;
+
+        struct Ref
+        {
+            float &x, &y, &z;
+            uint8_t &active;
+            Ref &operator=(const MoveTarget &v)
+            {
+                x = v.x;
+                y = v.y;
+                z = v.z;
+                active = v.active;
+                return *this;
+            }
+            Ref &operator=(const Ref &o) { return *this = static_cast<MoveTarget>(o); }
+            operator MoveTarget() const { return MoveTarget{x, y, z, active}; }
+        };
+
+        static Ref bind(std::byte *lane0, uint32_t stride)
+        {
+            return Ref{splitLane<float>(lane0, 0, stride), splitLane<float>(lane0, 1, stride),
+                       splitLane<float>(lane0, 2, stride), splitLane<uint8_t>(lane0, 3, stride)};
+        }
+    };
+
+    static_assert(sizeof(Position) == 12 && sizeof(Velocity) == 12 && sizeof(MoveTarget) == 16,
+                  "Split layouts assume 4-byte lanes");
+
+    // -----------------------
+    // Component type identity
+    // -----------------------
+    // Process-wide dense index per C++ type, assigned on first use. Not a component ID: the registry
+    // maps type index -> component ID.
+    inline uint32_t nextComponentTypeIndex()
+    {
+        static std::atomic<uint32_t> next{0};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    uint32_t componentTypeIndex()
+    {
+        static const uint32_t index = nextComponentTypeIndex();
+        return index;
+    }
+
+    // Layout of a data component; size == 0 marks a tag (no column).
+    struct ComponentTypeInfo
+    {
+        uint32_t size = 0;
+        uint32_t align = 0;
+        uint32_t lanes = 0; // > 0: stored split-scalar as 'lanes' 4-byte arrays (SplitFields<T>)
+        uint32_t typeIndex = UINT32_MAX;
+        std::vector<std::byte> defaultValue; // bytes of T{}
+
+        bool isData() const { return size != 0; }
+    };
+
+    // Typed default for one component (used by Prefabs/Stores). Type-erased: holds the raw bytes of a
+    // trivially copyable component so stores can stamp it with memcpy.
+    class DefaultValue
+    {
+    public:
+        DefaultValue() = default;
+
+        template <typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, DefaultValue>>>
+        DefaultValue(const T &value)
+            : m_typeIndex(componentTypeIndex<T>()), m_bytes(sizeof(T))
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Component defaults are copied with memcpy");
+            std::memcpy(m_bytes.data(), &value, sizeof(T));
+        }
+
+        template <typename T>
+        bool holds() const { return m_typeIndex == componentTypeIndex<T>(); }
+
+        // Copy out as T; returns T{} if the value holds another type.
+        template <typename T>
+        T get() const
+        {
+            T out{};
+            if (holds<T>())
+                std::memcpy(&out, m_bytes.data(), sizeof(T));
+            return out;
+        }
+
+        const std::byte *data() const { return m_bytes.data(); }
+        uint32_t size() const { return static_cast<uint32_t>(m_bytes.size()); }
+
+    private:
+        uint32_t m_typeIndex = UINT32_MAX;
+        std::vector<std::byte> m_bytes;
+    };
+
     // -----------------------
     // Component Registry
     // -----------------------
@@ -126,6 +290,56 @@ namespace Engine::ECS
     public:
         static constexpr uint32_t InvalidID = UINT32_MAX;
 
+        ComponentRegistry() { registerBuiltinComponents(); }
+
+        // Register a data component: name -> ID plus the type's layout and default value.
+        // Call before any store whose signature contains it is created. Returns the ID.
+        template <typename T>
+        uint32_t registerComponent(const std::string &name)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Component columns are moved with memcpy");
+            static_assert(alignof(T) <= kColumnAlign, "Component alignment exceeds chunk column alignment");
+            static_assert(std::is_default_constructible_v<T>, "Components need a default value");
+
+            const uint32_t id = ensureId(name);
+            if (id == InvalidID)
+                return id;
+
+            ComponentTypeInfo &info = m_info[id];
+            info.size = sizeof(T);
+            info.align = alignof(T);
+            info.typeIndex = componentTypeIndex<T>();
+            if constexpr (SplitFields<T>::enabled)
+            {
+                static_assert(sizeof(T) == 4 * SplitFields<T>::kLanes && alignof(T) == 4,
+                              "Split components must be whole 4-byte lanes");
+                info.lanes = SplitFields<T>::kLanes;
+            }
+            info.defaultValue.resize(sizeof(T));
+            const T def{};
+            std::memcpy(info.defaultValue.data(), &def, sizeof(T));
+
+            if (m_typeToId.size() <= info.typeIndex)
+                m_typeToId.resize(info.typeIndex + 1, InvalidID);
+            m_typeToId[info.typeIndex] = id;
+            return id;
+        }
+
+        // Component ID registered for type T, or InvalidID.
+        template <typename T>
+        uint32_t idOf() const
+        {
+            const uint32_t t = componentTypeIndex<T>();
+            return t < m_typeToId.size() ? m_typeToId[t] : InvalidID;
+        }
+
+        // Layout for a component ID (size 0 for tags and unknown IDs).
+        const ComponentTypeInfo &info(uint32_t id) const
+        {
+            static const ComponentTypeInfo tag{};
+            return id < m_info.size() ? m_info[id] : tag;
+        }
+
         // Register a component name and return its stable ID.
         // If already registered, returns the existing ID.
         uint32_t registerComponent(const std::string &name)
@@ -135,8 +349,18 @@ namespace Engine::ECS
                 return it->second;
 
             const uint32_t id = static_cast<uint32_t>(m_idToName.size());
+            if (id >= ENGINE_ECS_MAX_COMPONENTS)
+            {
+                // Masks would silently drop the ID and stores would get no column for it.
+                ENGINE_LOG_ERROR("[ComponentRegistry] Component '%s' does not fit: all %u component IDs are taken. "
+                                 "Raise ENGINE_ECS_MAX_COMPONENTS.",
+                                 name.c_str(), static_cast<unsigned>(ENGINE_ECS_MAX_COMPONENTS));
+                assert(false && "ENGINE_ECS_MAX_COMPONENTS exhausted");
+                return InvalidID;
+            }
             m_nameToId.emplace(name, id);
             m_idToName.emplace_back(name);
+            m_info.emplace_back();
             return id;
         }
 
@@ -166,88 +390,141 @@ namespace Engine::ECS
         // Total number of registered components.
         uint32_t count() const { return static_cast<uint32_t>(m_idToName.size()); }
 
+    private:
+        void registerBuiltinComponents()
+        {
+            registerComponent<Position>("Position");
+            registerComponent<Velocity>("Velocity");
+            registerComponent<Health>("Health");
+            registerComponent<MoveTarget>("MoveTarget");
+            registerComponent<MoveSpeed>("MoveSpeed");
+            registerComponent<Radius>("Radius");
+            registerComponent<Separation>("Separation");
+            registerComponent<AvoidanceParams>("AvoidanceParams");
+            registerComponent<RenderModel>("RenderModel");
+            registerComponent<RenderAnimation>("RenderAnimation");
+            registerComponent<Facing>("Facing");
+        }
+
     private:
         std::unordered_map<std::string, uint32_t> m_nameToId;
         std::vector<std::string> m_idToName;
+        std::vector<ComponentTypeInfo> m_info; // per ID
+        std::vector<uint32_t> m_typeToId;      // componentTypeIndex -> ID
     };
 
     // -----------------------
-    // Component Mask (dynamic)
+    // Component Mask (fixed width)
     // -----------------------
-    // Represents a set of components by their IDs. Backed by 64-bit words.
-    class ComponentMask
+    // Represents a set of components by their IDs. Stored inline as Bits/64 words, so masks never
+    // allocate and compare branch-free (SSE2/NEON when available). IDs >= Bits are ignored.
+    template <uint32_t Bits>
+    class BasicComponentMask
     {
+        static_assert(Bits > 0 && Bits % 128 == 0, "Mask width must be a multiple of 128 bits");
+
     public:
-        ComponentMask() = default;
+        static constexpr uint32_t kBits = Bits;
+        static constexpr uint32_t kWords = Bits / 64;
+
+        BasicComponentMask() = default;
 
         // Set a bit for component ID.
         void set(uint32_t compId)
         {
-            ensureBit(compId);
-            const auto [wordIdx, bit] = bitPos(compId);
-            m_words[wordIdx] |= (uint64_t(1) << bit);
+            if (compId >= Bits)
+                return;
+            m_words[compId / 64] |= (uint64_t(1) << (compId % 64));
         }
 
         // Clear a bit for component ID.
         void clear(uint32_t compId)
         {
-            if (!has(compId))
+            if (compId >= Bits)
                 return;
-            const auto [wordIdx, bit] = bitPos(compId);
-            m_words[wordIdx] &= ~(uint64_t(1) << bit);
+            m_words[compId / 64] &= ~(uint64_t(1) << (compId % 64));
         }
 
         // Check if a bit for component ID is set.
         bool has(uint32_t compId) const
         {
-            const auto [wordIdx, bit] = bitPos(compId);
-            if (wordIdx >= m_words.size())
+            if (compId >= Bits)
                 return false;
-            return (m_words[wordIdx] & (uint64_t(1) << bit)) != 0;
+            return (m_words[compId / 64] & (uint64_t(1) << (compId % 64))) != 0;
         }
 
         // Return true if this mask contains all bits in 'rhs'.
-        bool containsAll(const ComponentMask &rhs) const
+        bool containsAll(const BasicComponentMask &rhs) const
         {
-            const size_t n = std::max(m_words.size(), rhs.m_words.size());
-            for (size_t i = 0; i < n; ++i)
-            {
-                const uint64_t a = i < m_words.size() ? m_words[i] : 0;
-                const uint64_t b = i < rhs.m_words.size() ? rhs.m_words[i] : 0;
-                if ((a & b) != b)
-                    return false;
-            }
-            return true;
+            return matches(rhs, BasicComponentMask{});
         }
 
         // Return true if this mask contains none of the bits in 'rhs'.
-        bool containsNone(const ComponentMask &rhs) const
+        bool containsNone(const BasicComponentMask &rhs) const
+        {
+            return matches(BasicComponentMask{}, rhs);
+        }
+
+        // Convenience: required/excluded match.
+        // One pass: accumulate ((a & req) ^ req) | (a & exc) over all words and test for zero.
+        bool matches(const BasicComponentMask &required, const BasicComponentMask &excluded) const
         {
-            const size_t n = std::max(m_words.size(), rhs.m_words.size());
-            for (size_t i = 0; i < n; ++i)
+#if defined(__SSE2__) || defined(_M_X64)
+            __m128i acc = _mm_setzero_si128();
+            for (uint32_t i = 0; i < kWords; i += 2)
             {
-                const uint64_t a = i < m_words.size() ? m_words[i] : 0;
-                const uint64_t b = i < rhs.m_words.size() ? rhs.m_words[i] : 0;
-                if ((a & b) != 0)
-                    return false;
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&m_words[i]));
+                const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&required.m_words[i]));
+                const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&excluded.m_words[i]));
+                acc = _mm_or_si128(acc, _mm_xor_si128(_mm_and_si128(a, r), r));
+                acc = _mm_or_si128(acc, _mm_and_si128(a, e));
             }
-            return true;
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+            uint64x2_t acc = vdupq_n_u64(0);
+            for (uint32_t i = 0; i < kWords; i += 2)
+            {
+                const uint64x2_t a = vld1q_u64(&m_words[i]);
+                const uint64x2_t r = vld1q_u64(&required.m_words[i]);
+                const uint64x2_t e = vld1q_u64(&excluded.m_words[i]);
+                acc = vorrq_u64(acc, veorq_u64(vandq_u64(a, r), r));
+                acc = vorrq_u64(acc, vandq_u64(a, e));
+            }
+            return vmaxvq_u32(vreinterpretq_u32_u64(acc)) == 0;
+#else
+            uint64_t acc = 0;
+            for (uint32_t i = 0; i < kWords; ++i)
+                acc |= ((m_words[i] & required.m_words[i]) ^ required.m_words[i]) | (m_words[i] & excluded.m_words[i]);
+            return acc == 0;
+#endif
         }
 
-        // Convenience: required/excluded match.
-        bool matches(const ComponentMask &required, const ComponentMask &excluded) const
+        // True if any bit is shared with 'rhs'.
+        bool intersects(const BasicComponentMask &rhs) const { return !containsNone(rhs); }
+
+        bool empty() const { return containsNone(*this); }
+
+        bool operator==(const BasicComponentMask &rhs) const { return m_words == rhs.m_words; }
+        bool operator!=(const BasicComponentMask &rhs) const { return !(*this == rhs); }
+
+        // Hash of the mask words (used for archetype lookup).
+        size_t hash() const
         {
-            return containsAll(required) && containsNone(excluded);
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (uint32_t i = 0; i < kWords; ++i)
+            {
+                h ^= m_words[i] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+                h *= 0xBF58476D1CE4E5B9ull;
+            }
+            return static_cast<size_t>(h ^ (h >> 31));
         }
 
-        // Stable string key for dictionary indexing (hex of words, high word first).
+        // Stable string key (hex of words, high word first). Debug/logging only.
         std::string toKey() const
         {
-            if (m_words.empty())
-                return "0";
             std::ostringstream oss;
             oss << std::hex << std::setfill('0');
-            for (size_t i = m_words.size(); i-- > 0;)
+            for (uint32_t i = kWords; i-- > 0;)
             {
                 oss << std::setw(16) << m_words[i];
             }
@@ -255,32 +532,27 @@ namespace Engine::ECS
         }
 
         // Build a mask from a list of component IDs.
-        static ComponentMask fromIds(const std::vector<uint32_t> &ids)
+        static BasicComponentMask fromIds(const std::vector<uint32_t> &ids)
         {
-            ComponentMask m;
+            BasicComponentMask m;
             for (uint32_t id : ids)
                 m.set(id);
             return m;
         }
 
-        const std::vector<uint64_t> &words() const { return m_words; }
+        const std::array<uint64_t, kWords> &words() const { return m_words; }
 
     private:
-        std::vector<uint64_t> m_words; // 64 bits per word
+        alignas(16) std::array<uint64_t, kWords> m_words{}; // 64 bits per word
+    };
 
-        static std::pair<size_t, uint32_t> bitPos(uint32_t compId)
-        {
-            const size_t wordIdx = compId / 64;
-            const uint32_t bit = compId % 64;
-            return {wordIdx, bit};
-        }
+    using ComponentMask = BasicComponentMask<ENGINE_ECS_MAX_COMPONENTS>;
 
-        void ensureBit(uint32_t compId)
-        {
-            const size_t need = compId / 64 + 1;
-            if (m_words.size() < need)
-                m_words.resize(need, 0);
-        }
+    static_assert(std::is_trivially_copyable_v<ComponentMask>, "ComponentMask must stay allocation-free");
+
+    struct ComponentMaskHash
+    {
+        size_t operator()(const ComponentMask &m) const noexcept { return m.hash(); }
     };
 
 } // namespace Engine::ECS
\ No newline at end of file
@@ -12,6 +12,7 @@
 //   - ArchetypeStoreManager: lazily created SoA stores per archetype.
 //   - EntitiesRecord: control-plane mapping of entity handle -> (archetypeId, row).
 //   - PrefabManager: dictionary of prefabs keyed by name (SampleApp loads JSON and fills it).
+//   - CommandBuffer: deferred structural changes, applied by PlaybackCommands() at sync points.
 //
 // Notes:
 //   - Engine/Application owns lifetime of ECSContext.
@@ -23,6 +24,7 @@
 #include "ECS/ArchetypeStore.h"   // ArchetypeStoreManager
 #include "ECS/Entity.h"           // EntitiesRecord
 #include "ECS/Prefab.h"           // PrefabManager
+#include "ECS/CommandBuffer.h"    // CommandBuffer
 namespace Engine::ECS
 {
     struct ECSContext
@@ -33,6 +35,13 @@ namespace Engine::ECS
         ArchetypeStoreManager stores;
         EntitiesRecord entities;
         PrefabManager prefabs;
+        CommandBuffer commands;
+
+        // Apply deferred structural changes; call only while no system is running.
+        void PlaybackCommands()
+        {
+            commands.playback(components, archetypes, stores, entities);
+        }
 
         // Optional helper to reset state (typically not needed except in tests/tools).
         void Reset()
@@ -11,11 +11,15 @@
     - Use EntitiesRecord.create() to get a fresh Entity.
     - After creating a row in an archetype store, call EntitiesRecord.attach(entity, archetypeId, row).
     - Use EntitiesRecord.find(entity) to get quick O(1) location info for per-entity operations.
+
+  Notes:
+    - Records are a dense array indexed by Entity::index (no hashing). When a store moves a row
+      (ArchetypeStore::destroyRow returns the moved entity), patch it with setRow().
 */
 
 #include <cstdint>
 #include <vector>
-#include <unordered_map>
+#include <algorithm>
 
 namespace Engine::ECS
 {
@@ -53,17 +57,42 @@ namespace Engine::ECS
             {
                 idx = static_cast<uint32_t>(m_generations.size());
                 m_generations.emplace_back(0);
+                m_records.emplace_back();
             }
             ++m_generations[idx]; // new generation marks the handle as alive
             return Entity{idx, m_generations[idx]};
         }
 
+        // Create 'count' handles and append them to 'out'.
+        void createBatch(uint32_t count, std::vector<Entity> &out)
+        {
+            out.reserve(out.size() + count);
+            const uint32_t fromFree = std::min<uint32_t>(count, static_cast<uint32_t>(m_free.size()));
+            for (uint32_t i = 0; i < fromFree; ++i)
+                out.push_back(create());
+
+            // Remaining handles come from fresh indices: grow both arrays once.
+            const uint32_t fresh = count - fromFree;
+            const uint32_t base = static_cast<uint32_t>(m_generations.size());
+            m_generations.resize(base + fresh, 1u);
+            m_records.resize(base + fresh);
+            for (uint32_t i = 0; i < fresh; ++i)
+                out.push_back(Entity{base + i, 1u});
+        }
+
+        // Attach a contiguous run of rows [firstRow, firstRow + count) to the given entities.
+        void attachBatch(const Entity *es, uint32_t count, uint32_t archetypeId, uint32_t firstRow)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                attach(es[i], archetypeId, firstRow + i);
+        }
+
         // Destroy an entity: erase record and invalidate handle via generation bump.
         void destroy(Entity e)
         {
             if (!isAlive(e))
                 return;
-            m_records.erase(e.index);
+            m_records[e.index] = EntityRecord{};
             ++m_generations[e.index];
             m_free.push_back(e.index);
         }
@@ -87,7 +116,15 @@ namespace Engine::ECS
         {
             if (!isAlive(e))
                 return;
-            m_records.erase(e.index);
+            m_records[e.index] = EntityRecord{};
+        }
+
+        // Patch the row of an entity that a store moved (swap-remove / reordering).
+        void setRow(Entity e, uint32_t row)
+        {
+            if (!isAlive(e))
+                return;
+            m_records[e.index].row = row;
         }
 
         // Find record; returns nullptr if missing or dead.
@@ -95,22 +132,39 @@ namespace Engine::ECS
         {
             if (!isAlive(e))
                 return nullptr;
-            auto it = m_records.find(e.index);
-            return (it != m_records.end()) ? &it->second : nullptr;
+            const EntityRecord &rec = m_records[e.index];
+            return (rec.archetypeId != UINT32_MAX) ? &rec : nullptr;
         }
 
         EntityRecord *find(Entity e)
         {
             if (!isAlive(e))
                 return nullptr;
-            auto it = m_records.find(e.index);
-            return (it != m_records.end()) ? &it->second : nullptr;
+            EntityRecord &rec = m_records[e.index];
+            return (rec.archetypeId != UINT32_MAX) ? &rec : nullptr;
+        }
+
+        // Number of entity indices ever allocated (alive or free).
+        uint32_t capacity() const { return static_cast<uint32_t>(m_generations.size()); }
+
+        // Raw state for world snapshots (see WorldSnapshot.h).
+        const std::vector<uint32_t> &generations() const { return m_generations; }
+        const std::vector<uint32_t> &freeList() const { return m_free; }
+        const std::vector<EntityRecord> &records() const { return m_records; }
+
+        // Replace all state with a saved copy; previously issued handles become meaningless.
+        void restore(const uint32_t *generations, const EntityRecord *records, uint32_t count,
+                     const uint32_t *freeList, uint32_t freeCount)
+        {
+            m_generations.assign(generations, generations + count);
+            m_records.assign(records, records + count);
+            m_free.assign(freeList, freeList + freeCount);
         }
 
     private:
-        std::vector<uint32_t> m_generations;                  // generation per index
-        std::vector<uint32_t> m_free;                         // freelist of indices
-        std::unordered_map<uint32_t, EntityRecord> m_records; // index -> record
+        std::vector<uint32_t> m_generations; // generation per index
+        std::vector<uint32_t> m_free;        // freelist of indices
+        std::vector<EntityRecord> m_records; // index -> record (dense, parallel to m_generations)
     };
 
 } // namespace Engine::ECS
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+/*
+  Migration.h
+  -----------
+  Purpose:
+    - Add or remove a component on a live entity by moving its row to the matching archetype store.
+      The entity handle stays valid; only its (archetypeId, row) record changes.
+
+  Usage:
+    - addComponent(e, Health{50.0f}, registry, archetypes, stores, entities);
+    - removeComponent<Health>(e, registry, archetypes, stores, entities);
+    - addComponentById(e, deadId, ...);   // tags such as Dead/Disabled: whole store is then skipped by
+                                          // any system that excludes the tag
+  Notes:
+    - Transitions use ArchetypeManager's cached add/remove edges; the row copy is one memcpy per
+      shared column (ArchetypeStore::moveRowTo).
+    - Structural change: call only while no system iterates the stores (or record it through
+      CommandBuffer::addComponent/removeComponent).
+*/
+
+#include "ECS/ArchetypeManager.h"
+#include "ECS/ArchetypeStore.h"
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+
+namespace Engine::ECS
+{
+    // Move 'e' into 'targetArchetype'. Returns false if the entity is dead or the archetype unknown.
+    inline bool migrateEntity(Entity e, uint32_t targetArchetype,
+                              ComponentRegistry &registry,
+                              ArchetypeManager &archetypes,
+                              ArchetypeStoreManager &stores,
+                              EntitiesRecord &entities)
+    {
+        const EntityRecord *rec = entities.find(e);
+        if (!rec)
+            return false;
+        const uint32_t sourceArchetype = rec->archetypeId;
+        const uint32_t row = rec->row;
+        if (targetArchetype == sourceArchetype)
+            return true;
+
+        const Archetype *target = archetypes.get(targetArchetype);
+        ArchetypeStore *src = stores.get(sourceArchetype);
+        if (!target || !src || row >= src->size())
+            return false;
+        ArchetypeStore *dst = stores.getOrCreate(targetArchetype, target->signature, registry);
+
+        Entity moved{};
+        const uint32_t dstRow = src->moveRowTo(row, *dst, moved);
+        if (moved.valid())
+            entities.setRow(moved, row);
+        entities.attach(e, targetArchetype, dstRow);
+        return true;
+    }
+
+    inline bool addComponentById(Entity e, uint32_t componentId,
+                                 ComponentRegistry &registry,
+                                 ArchetypeManager &archetypes,
+                                 ArchetypeStoreManager &stores,
+                                 EntitiesRecord &entities)
+    {
+        const EntityRecord *rec = entities.find(e);
+        if (!rec || componentId == ComponentRegistry::InvalidID)
+            return false;
+        const uint32_t target = archetypes.withComponent(rec->archetypeId, componentId);
+        return migrateEntity(e, target, registry, archetypes, stores, entities);
+    }
+
+    inline bool removeComponentById(Entity e, uint32_t componentId,
+                                    ComponentRegistry &registry,
+                                    ArchetypeManager &archetypes,
+                                    ArchetypeStoreManager &stores,
+                                    EntitiesRecord &entities)
+    {
+        const EntityRecord *rec = entities.find(e);
+        if (!rec || componentId == ComponentRegistry::InvalidID)
+            return false;
+        const uint32_t target = archetypes.withoutComponent(rec->archetypeId, componentId);
+        return migrateEntity(e, target, registry, archetypes, stores, entities);
+    }
+
+    // Add a registered data component and set its value (overwrites it if already present).
+    template <typename T>
+    bool addComponent(Entity e, const T &value,
+                      ComponentRegistry &registry,
+                      ArchetypeManager &archetypes,
+                      ArchetypeStoreManager &stores,
+                      EntitiesRecord &entities)
+    {
+        if (!addComponentById(e, registry.idOf<T>(), registry, archetypes, stores, entities))
+            return false;
+        const EntityRecord *rec = entities.find(e);
+        ArchetypeStore *store = stores.get(rec->archetypeId);
+        auto column = store->column<T>();
+        if (!column.valid())
+            return false;
+        column[rec->row] = value;
+        return true;
+    }
+
+    template <typename T>
+    bool removeComponent(Entity e,
+                         ComponentRegistry &registry,
+                         ArchetypeManager &archetypes,
+                         ArchetypeStoreManager &stores,
+                         EntitiesRecord &entities)
+    {
+        return removeComponentById(e, registry.idOf<T>(), registry, archetypes, stores, entities);
+    }
+
+} // namespace Engine::ECS
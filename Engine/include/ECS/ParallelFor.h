@@ -0,0 +1,44 @@
+#pragma once
+/*
+  ParallelFor.h
+  -------------
+  Purpose:
+    - parallelForRows(jobs, count, chunkSize, fn): split [0, count) into ranges and run them on the
+      JobSystem. Used by SystemBase::forEachChunk and by engine passes that run at sync points
+      (e.g. SimulationLod).
+*/
+
+#include <algorithm>
+#include <cstdint>
+
+#include "utils/JobSystem.h"
+
+namespace Engine::ECS
+{
+    // Split [0, rowCount) into ranges of chunkSize rows and run fn(begin, end) for each.
+    // Blocks until every range is done. Without a job system (or for a single range) runs inline.
+    template <typename Fn>
+    void parallelForRows(JobSystem *jobs, uint32_t rowCount, uint32_t chunkSize, Fn &&fn)
+    {
+        if (rowCount == 0)
+            return;
+        if (chunkSize == 0)
+            chunkSize = rowCount;
+
+        if (!jobs || jobs->workerCount() == 0 || rowCount <= chunkSize)
+        {
+            fn(0u, rowCount);
+            return;
+        }
+
+        JobSystem::Counter counter;
+        for (uint32_t begin = 0; begin < rowCount; begin += chunkSize)
+        {
+            const uint32_t end = std::min(rowCount, begin + chunkSize);
+            jobs->submit(counter, [&fn, begin, end]()
+                         { fn(begin, end); });
+        }
+        jobs->wait(counter);
+    }
+
+} // namespace Engine::ECS
@@ -7,26 +7,31 @@
     - Define PrefabManager (dictionary keyed by name).
     - Provide JSON loader for Prefabs; constructs signature masks from ComponentRegistry,
       validates defaults, and resolves archetype via ArchetypeManager.
+    - Provide PrefabCache: parsed definitions kept in a binary file between runs.
 
   Usage:
     - std::string text = readFileText("Sample/Entity.json");
     - Prefab p = loadPrefabFromJson(text, registry, archetypes, assets);
     - PrefabManager.add(p);
+    - Or, cached: PrefabCache cache; PrefabDefinition def;
+      if (cache.load("entities/Knight.json", def)) manager.add(instantiatePrefab(def, registry, archetypes, assets));
+      cache.save();
+    - 'assets' is any IModelProvider: AssetManager on the client, HeadlessAssets on a server.
 */
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
-#include <variant>
 #include <cstdint>
-#include <fstream>
-#include <sstream>
-#include <regex>
+#include <mutex>
+#include <utility>
 #include <vector>
-#include <iostream>
 
 #include "ECS/Components.h"
 #include "ECS/ArchetypeManager.h"
-#include "assets/AssetManager.h"
+#include "assets/ModelProvider.h"
+#include "utils/Log.h"
+#include "utils/VirtualFileSystem.h"
 
 namespace Engine::ECS
 {
@@ -68,17 +73,25 @@ namespace Engine::ECS
             return m_prefabs.find(name) != m_prefabs.end();
         }
 
+        // Registered names, sorted
+        std::vector<std::string> names() const
+        {
+            std::vector<std::string> out;
+            out.reserve(m_prefabs.size());
+            for (const auto &entry : m_prefabs)
+                out.push_back(entry.first);
+            std::sort(out.begin(), out.end());
+            return out;
+        }
+
     private:
         std::unordered_map<std::string, Prefab> m_prefabs;
     };
 
-    // Utility: read a whole file into a string.
+    // Utility: read a whole file (packed or loose) into a string.
     inline std::string readFileText(const std::string &path)
     {
-        std::ifstream in(path);
-        std::stringstream ss;
-        ss << in.rdbuf();
-        return ss.str();
+        return VirtualFileSystem::readText(path);
     }
 
     // Helper: build a signature mask from component names via ComponentRegistry.
@@ -95,220 +108,79 @@ namespace Engine::ECS
         return sig;
     }
 
-    inline Prefab loadPrefabFromJson(const std::string &jsonText,
-                                     ComponentRegistry &registry,
-                                     ArchetypeManager &archetypes,
-                                     Engine::AssetManager &assets)
+    // Prefab definition as written in its JSON file, before component IDs are resolved or its model
+    // is loaded. This is what PrefabCache stores.
+    struct PrefabDefinition
     {
-        Prefab p;
-
-        // Extract name
-        {
-            std::regex re_name(R"re("name"\s*:\s*"([^"]+)")re");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_name))
-                p.name = m[1].str();
-        }
-
-        // Extract components array
-        {
-            std::regex re_components(R"re("components"\s*:\s*\[([^\]]+)\])re");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_components))
-            {
-                std::string inner = m[1].str();
-                std::regex re_item(R"re("([^"]+)")re");
-                auto it = std::sregex_iterator(inner.begin(), inner.end(), re_item);
-                auto end = std::sregex_iterator();
-                std::vector<std::string> names;
-                for (; it != end; ++it)
-                    names.push_back((*it)[1].str());
-                p.signature = buildSignatureFromNames(names, registry);
-            }
-        }
-
-        // Optional visuals: if a model is present, load it and apply a RenderModel default.
-        // JSON schema: "visual": { "model": "path" , ... }
-        {
-            std::regex re_model(R"re("visual"\s*:\s*\{[\s\S]*?"model"\s*:\s*"([^"]+)")re");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_model))
-            {
-                const std::string modelPath = m[1].str();
-                if (!modelPath.empty())
-                {
-                    Engine::ModelHandle h = assets.loadModel(modelPath);
-                    if (h.isValid())
-                    {
-                        const uint32_t rmId = registry.ensureId("RenderModel");
-                        p.signature.set(rmId);
-
-                        RenderModel rm{};
-                        rm.handle = h;
-                        p.defaults[rmId] = rm;
-
-                        // Also add per-entity animation state (defaults: Idle animation, playing, looping)
-                        const uint32_t raId = registry.ensureId("RenderAnimation");
-                        p.signature.set(raId);
-
-                        RenderAnimation ra{};
-                        ra.clipIndex = 65;    // Stand_Idle_0 animation
-                        ra.playing = true;    // Start playing immediately
-                        ra.loop = true;       // Loop the animation
-                        ra.speed = 1.0f;
-                        ra.timeSec = 0.0f;
-                        p.defaults[raId] = ra;
-                    }
-                    else
-                    {
-                        std::cerr << "[Prefab] Warning: Failed to load model mesh: " << modelPath << " for prefab " << p.name << "\n";
-                    }
-                }
-            }
-        }
-
-        // Resolve archetype (after any signature adjustments like RenderMesh)
-        p.archetypeId = archetypes.getOrCreate(p.signature);
+        std::string name;
+        std::vector<std::string> components;                         // signature, by name
+        std::vector<std::pair<std::string, DefaultValue>> defaults; // component name -> typed default
+        std::string modelPath;                                       // "visual": { "model": ... }, may be empty
+    };
 
-        // Parse defaults: Position
-        {
-            std::regex re_pos(R"("Position"\s*:\s*\{\s*"x"\s*:\s*([-+]?\d*\.?\d+),\s*"y"\s*:\s*([-+]?\d*\.?\d+),\s*"z"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_pos))
-            {
-                Position pos{};
-                pos.x = std::stof(m[1].str());
-                pos.y = std::stof(m[2].str());
-                pos.z = std::stof(m[3].str());
-                uint32_t cid = registry.ensureId("Position");
-                p.defaults.emplace(cid, pos);
-            }
-        }
+    // Parses prefab JSON. Unknown default components are skipped with a warning; returns false (and
+    // sets 'error') for malformed JSON.
+    bool parsePrefabJson(const std::string &jsonText, PrefabDefinition &out, std::string *error = nullptr);
 
-        // Parse defaults: Velocity
-        {
-            std::regex re_vel(R"("Velocity"\s*:\s*\{\s*"x"\s*:\s*([-+]?\d*\.?\d+),\s*"y"\s*:\s*([-+]?\d*\.?\d+),\s*"z"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_vel))
-            {
-                Velocity vel{};
-                vel.x = std::stof(m[1].str());
-                vel.y = std::stof(m[2].str());
-                vel.z = std::stof(m[3].str());
-                uint32_t cid = registry.ensureId("Velocity");
-                p.defaults.emplace(cid, vel);
-            }
-        }
+    // Resolves names through the registry, starts the model load and resolves the archetype.
+    Prefab instantiatePrefab(const PrefabDefinition &def,
+                             ComponentRegistry &registry,
+                             ArchetypeManager &archetypes,
+                             Engine::IModelProvider &assets);
 
-        // Parse defaults: Health
-        {
-            std::regex re_health(R"("Health"\s*:\s*\{\s*"value"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_health))
-            {
-                Health h{};
-                h.value = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Health");
-                p.defaults.emplace(cid, h);
-            }
-        }
-
-        // Parse defaults: MoveTarget
-        {
-            std::regex re_target(R"("MoveTarget"\s*:\s*\{\s*"x"\s*:\s*([-+]?\d*\.?\d+),\s*"y"\s*:\s*([-+]?\d*\.?\d+),\s*"z"\s*:\s*([-+]?\d*\.?\d+),\s*"active"\s*:\s*(\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_target))
-            {
-                MoveTarget t{};
-                t.x = std::stof(m[1].str());
-                t.y = std::stof(m[2].str());
-                t.z = std::stof(m[3].str());
-                t.active = static_cast<uint8_t>(std::stoi(m[4].str()));
-                uint32_t cid = registry.ensureId("MoveTarget");
-                p.defaults.emplace(cid, t);
-            }
-        }
+    inline Prefab loadPrefabFromJson(const std::string &jsonText,
+                                     ComponentRegistry &registry,
+                                     ArchetypeManager &archetypes,
+                                     Engine::IModelProvider &assets)
+    {
+        PrefabDefinition def;
+        parsePrefabJson(jsonText, def);
+        return instantiatePrefab(def, registry, archetypes, assets);
+    }
 
-        // Parse defaults: MoveSpeed
+    // PrefabCache: parsed prefab definitions in one binary file, so startup skips JSON parsing for
+    // prefabs whose source is unchanged. An entry is reused while the FNV-1a hash of its source bytes
+    // matches; the file is rewritten by save() when anything was (re)parsed or dropped.
+    // load() may run on several threads at once (parallel startup); save() runs after they finish.
+    class PrefabCache
+    {
+    public:
+        struct Stats
         {
-            std::regex re_speed(R"("MoveSpeed"\s*:\s*\{\s*"value"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_speed))
-            {
-                MoveSpeed s{};
-                s.value = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("MoveSpeed");
-                p.defaults.emplace(cid, s);
-            }
-        }
+            uint32_t hits = 0;
+            uint32_t misses = 0; // parsed from JSON
+        };
 
-        // Parse defaults: Radius
-        {
-            std::regex re_radius(R"("Radius"\s*:\s*\{\s*"r"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_radius))
-            {
-                Radius r{};
-                r.r = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Radius");
-                p.defaults.emplace(cid, r);
-            }
-        }
+        static constexpr const char *kDefaultPath = "prefab_cache.bin";
 
-        // Parse defaults: Separation
-        {
-            std::regex re_sep(R"("Separation"\s*:\s*\{\s*"value"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_sep))
-            {
-                Separation s{};
-                s.value = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Separation");
-                p.defaults.emplace(cid, s);
-            }
-        }
+        // Loads 'path' if present and valid (a damaged or outdated file is ignored).
+        explicit PrefabCache(std::string path = kDefaultPath);
 
-        // Parse defaults: AvoidanceParams
-        {
-            std::regex re_ap(R"("AvoidanceParams"\s*:\s*\{\s*"strength"\s*:\s*([-+]?\d*\.?\d+),\s*"maxAccel"\s*:\s*([-+]?\d*\.?\d+),\s*"blend"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_ap))
-            {
-                AvoidanceParams ap{};
-                ap.strength = std::stof(m[1].str());
-                ap.maxAccel = std::stof(m[2].str());
-                ap.blend = std::stof(m[3].str());
-                uint32_t cid = registry.ensureId("AvoidanceParams");
-                p.defaults.emplace(cid, ap);
-            }
-        }
+        // Definition of the prefab JSON at 'sourcePath' (read through the VirtualFileSystem).
+        bool load(const std::string &sourcePath, PrefabDefinition &out);
 
-        // Parse defaults: Facing
-        {
-            std::regex re_face(R"("Facing"\s*:\s*\{\s*"yaw"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_face))
-            {
-                Facing f{};
-                f.yaw = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Facing");
-                p.defaults.emplace(cid, f);
-            }
-        }
+        // Writes the entries used since construction (through a temporary file), if any changed.
+        bool save();
 
-        // Validate defaults align with signature; drop mismatches to keep consistency.
-        if (!p.validateDefaults())
+        Stats getStats() const
         {
-            for (auto it = p.defaults.begin(); it != p.defaults.end();)
-            {
-                if (!p.signature.has(it->first))
-                    it = p.defaults.erase(it);
-                else
-                    ++it;
-            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stats;
         }
 
-        return p;
-    }
+    private:
+        struct Entry
+        {
+            uint64_t sourceHash = 0;
+            PrefabDefinition def;
+            bool used = false;
+        };
+
+        std::string m_path;
+        std::unordered_map<std::string, Entry> m_entries; // by source path
+        bool m_dirty = false;
+        Stats m_stats;
+        mutable std::mutex m_mutex; // guards the entries and stats; parsing runs outside it
+    };
 
 } // namespace Engine::ECS
\ No newline at end of file
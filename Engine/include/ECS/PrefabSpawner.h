@@ -11,6 +11,8 @@
 
   Usage:
     - SpawnResult res = spawnFromPrefab(prefab, registry, archetypes, storeMgr, entities);
+    - BatchSpawnResult b = spawnFromPrefabBatch(prefab, count, registry, storeMgr, entities, outEntities);
+    - destroyEntity(entity, storeMgr, entities);   // swap-remove + record fix-up
 */
 
 #include "ECS/Prefab.h"
@@ -54,4 +56,58 @@ namespace Engine::ECS
         return res;
     }
 
+    // Result of a batch spawn: rows [firstRow, firstRow + count) of the archetype's store.
+    struct BatchSpawnResult
+    {
+        uint32_t archetypeId = UINT32_MAX;
+        uint32_t firstRow = UINT32_MAX;
+        uint32_t count = 0;
+    };
+
+    // Spawn 'count' entities from one prefab. Defaults are resolved into a row template once, the
+    // store reserves every chunk up front and rows are stamped column by column; entity handles are
+    // appended to outEntities in row order.
+    inline BatchSpawnResult spawnFromPrefabBatch(const Prefab &prefab,
+                                                 uint32_t count,
+                                                 ComponentRegistry &registry,
+                                                 ArchetypeStoreManager &stores,
+                                                 EntitiesRecord &entities,
+                                                 std::vector<Entity> &outEntities)
+    {
+        BatchSpawnResult res{};
+        res.archetypeId = prefab.archetypeId;
+        if (count == 0)
+            return res;
+
+        ArchetypeStore *store = stores.getOrCreate(prefab.archetypeId, prefab.signature, registry);
+
+        const size_t firstHandle = outEntities.size();
+        entities.createBatch(count, outEntities);
+
+        const std::vector<std::byte> rowTemplate = store->makeRowTemplate(prefab.defaults);
+        res.firstRow = store->createRows(outEntities.data() + firstHandle, count, rowTemplate);
+        res.count = count;
+
+        entities.attachBatch(outEntities.data() + firstHandle, count, res.archetypeId, res.firstRow);
+        return res;
+    }
+
+    // Destroy an entity and its row, keeping the record of the entity swapped into its place valid.
+    inline bool destroyEntity(Entity e, ArchetypeStoreManager &stores, EntitiesRecord &entities)
+    {
+        const EntityRecord *rec = entities.find(e);
+        if (!rec)
+            return false;
+
+        const uint32_t row = rec->row;
+        if (ArchetypeStore *store = stores.get(rec->archetypeId))
+        {
+            const Entity moved = store->destroyRow(row);
+            if (moved.valid())
+                entities.setRow(moved, row);
+        }
+        entities.destroy(e);
+        return true;
+    }
+
 } // namespace Engine::ECS
\ No newline at end of file
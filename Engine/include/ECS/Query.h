@@ -0,0 +1,66 @@
+#pragma once
+/*
+  Query.h
+  -------
+  Purpose:
+    - Cache which ArchetypeStores match a required/excluded signature filter, so systems do not
+      re-test every store's signature each frame.
+
+  Usage:
+    - ArchetypeQuery q; q.setFilter(required, excluded);
+    - for (uint32_t id : q.matching(storeMgr)) { ArchetypeStore *store = storeMgr.get(id); ... }
+
+  Notes:
+    - matching() only inspects stores created since its last call (via ArchetypeStoreManager::creationLog()),
+      so the steady-state cost is one size comparison.
+    - Row-level tags (row masks) are not covered; systems still filter rows that carry per-row tags.
+*/
+
+#include <cstdint>
+#include <vector>
+#include "ECS/Components.h"
+#include "ECS/ArchetypeStore.h"
+
+namespace Engine::ECS
+{
+    class ArchetypeQuery
+    {
+    public:
+        void setFilter(const ComponentMask &required, const ComponentMask &excluded)
+        {
+            m_required = required;
+            m_excluded = excluded;
+            m_matching.clear();
+            m_seen = 0;
+        }
+
+        // Matching store IDs, in creation order. Catches up with newly created stores first.
+        const std::vector<uint32_t> &matching(const ArchetypeStoreManager &mgr)
+        {
+            const auto &log = mgr.creationLog();
+            if (log.size() < m_seen)
+            {
+                // The manager was reset (e.g. ECSContext::Reset); start over.
+                m_matching.clear();
+                m_seen = 0;
+            }
+            for (; m_seen < log.size(); ++m_seen)
+            {
+                const uint32_t id = log[m_seen];
+                const auto &stores = mgr.stores();
+                if (id >= stores.size() || !stores[id])
+                    continue;
+                if (stores[id]->signature().matches(m_required, m_excluded))
+                    m_matching.push_back(id);
+            }
+            return m_matching;
+        }
+
+    private:
+        ComponentMask m_required;
+        ComponentMask m_excluded;
+        std::vector<uint32_t> m_matching;
+        size_t m_seen = 0;
+    };
+
+} // namespace Engine::ECS
@@ -0,0 +1,138 @@
+#pragma once
+/*
+  RowReorder.h
+  ------------
+  Purpose:
+    - Periodic maintenance pass that sorts each store's rows by the Morton (Z-order) code of their
+      ground-plane grid cell, so units that are close in the world are also close in memory.
+      Neighbor scans (avoidance, targeting) then mostly hit warm cache lines.
+
+  Usage:
+    - MortonRowReorder reorder;  reorder.setCellSize(2.0f);  reorder.setInterval(120);
+    - Each frame at a sync point (no system iterating): reorder.tick(ecs.stores, ecs.entities);
+    - After a pass, reorder.remaps() lists {storeId, oldToNew} for every store that changed, so code
+      holding (storeId, row) pairs can fix them up: newRow = remap.oldToNew[oldRow].
+
+  Notes:
+    - Structural change: rows move, EntitiesRecord is patched, and the store's structureVersion() is
+      bumped (caches keyed on it, e.g. the incremental spatial grid, rebuild on their own).
+    - Stores without Position are left alone; already-sorted stores are skipped without copying.
+    - Cells are 16 bits per axis around the origin (±32768 cells), which covers the ±10 km battlefield
+      at cell sizes down to ~0.3 m.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "ECS/ArchetypeStore.h"
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+
+namespace Engine::ECS
+{
+    // Interleave the low 16 bits of x (even bits) and z (odd bits).
+    inline uint32_t mortonCode(uint32_t x, uint32_t z)
+    {
+        auto spread = [](uint32_t v)
+        {
+            v &= 0xFFFFu;
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        };
+        return spread(x) | (spread(z) << 1);
+    }
+
+    struct RowRemap
+    {
+        uint32_t storeId = 0;
+        std::vector<uint32_t> oldToNew; // old row -> new row
+    };
+
+    class MortonRowReorder
+    {
+    public:
+        void setCellSize(float cellSize) { m_cellSize = (cellSize > 1e-6f) ? cellSize : 1e-6f; }
+        float cellSize() const { return m_cellSize; }
+
+        // Run a pass every 'frames' calls to tick() (0 disables the pass).
+        void setInterval(uint32_t frames) { m_interval = frames; }
+        uint32_t interval() const { return m_interval; }
+
+        // Count one frame; sorts all stores when the interval elapses. Returns true if a pass ran.
+        bool tick(ArchetypeStoreManager &stores, EntitiesRecord &entities)
+        {
+            if (m_interval == 0 || ++m_frame < m_interval)
+                return false;
+            m_frame = 0;
+            run(stores, entities);
+            return true;
+        }
+
+        // Sort every store with Position now.
+        void run(ArchetypeStoreManager &stores, EntitiesRecord &entities)
+        {
+            m_remaps.clear();
+            const auto &all = stores.stores();
+            for (uint32_t sid = 0; sid < all.size(); ++sid)
+            {
+                ArchetypeStore *store = all[sid].get();
+                if (store && store->hasPosition() && store->size() > 1)
+                    sortStore(*store, sid, entities);
+            }
+        }
+
+        // Stores reordered by the last pass.
+        const std::vector<RowRemap> &remaps() const { return m_remaps; }
+
+    private:
+        void sortStore(ArchetypeStore &store, uint32_t storeId, EntitiesRecord &entities)
+        {
+            const uint32_t n = store.size();
+            const auto positions = store.positions();
+
+            // (code, row) keys; the row in the low half keeps the sort stable.
+            m_keys.resize(n);
+            bool sorted = true;
+            for (uint32_t row = 0; row < n; ++row)
+            {
+                const Position p = positions[row];
+                const uint32_t gx = static_cast<uint32_t>(static_cast<int32_t>(std::floor(p.x / m_cellSize)) + 32768);
+                const uint32_t gz = static_cast<uint32_t>(static_cast<int32_t>(std::floor(p.z / m_cellSize)) + 32768);
+                m_keys[row] = (uint64_t(mortonCode(gx, gz)) << 32) | row;
+                sorted = sorted && (row == 0 || m_keys[row - 1] < m_keys[row]);
+            }
+            if (sorted)
+                return;
+            std::sort(m_keys.begin(), m_keys.end());
+
+            m_order.resize(n);
+            RowRemap remap;
+            remap.storeId = storeId;
+            remap.oldToNew.resize(n);
+            for (uint32_t row = 0; row < n; ++row)
+            {
+                m_order[row] = static_cast<uint32_t>(m_keys[row]);
+                remap.oldToNew[m_order[row]] = row;
+            }
+            store.permuteRows(m_order.data());
+
+            const auto owners = store.entities();
+            for (uint32_t row = 0; row < n; ++row)
+                entities.setRow(owners[row], row);
+            m_remaps.push_back(std::move(remap));
+        }
+
+        float m_cellSize = 2.0f;
+        uint32_t m_interval = 0;
+        uint32_t m_frame = 0;
+        std::vector<uint64_t> m_keys;   // scratch
+        std::vector<uint32_t> m_order;  // scratch: new row -> old row
+        std::vector<RowRemap> m_remaps;
+    };
+
+} // namespace Engine::ECS
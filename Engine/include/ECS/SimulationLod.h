@@ -0,0 +1,179 @@
+#pragma once
+/*
+  SimulationLod.h
+  ---------------
+  Purpose:
+    - Distance / visibility LOD for the simulation. Every row with Position gets a tier from its
+      ground distance to a focus point (usually the camera focus) and whether it lies inside the view
+      footprint. Tier t is updated every 2^t ticks, and rows of one tier are spread round-robin over
+      those ticks, so each tick touches ~1/2^t of the far units.
+    - Each tick writes a "SimDue" row tag: the rows opted-in systems process this tick.
+
+  Usage:
+    - lod.buildIds(registry);  lod.setFocus(x, z);  lod.setViewFootprint(xz, 4);  // footprint optional
+    - At the sync point before the scheduler runs: lod.update(stores, tick, &jobs);
+    - Opt a system in with system.setSimulationLod(&lod). It then iterates
+      store.rowFilter(lodRequired(mask), excluded()) and multiplies dt by lodScale(storeId, row)
+      (see SystemBase in SystemFormat.h).
+
+  Notes:
+    - scale(storeId, row) is the row's tier period: the ticks since its previous due tick. Exact while
+      the tier is stable; a tier change is absorbed within one period.
+    - The phase comes from the entity index, so row moves (reorder, migration) do not reshuffle who
+      is due when.
+    - Stores without Position are always due. Rows inside the view footprint are tier 0; rows outside
+      it are at least tier 1. With setEnabled(false) every row is due every tick.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "ECS/ArchetypeStore.h"
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+#include "ECS/ParallelFor.h"
+#include "utils/JobSystem.h"
+
+namespace Engine::ECS
+{
+    class SimulationLod
+    {
+    public:
+        static constexpr uint32_t kMaxTier = 3;        // period 8
+        static constexpr uint32_t kMaxFootprint = 8;   // polygon vertices
+        static constexpr uint32_t kWordsPerJob = 64;   // 4096 rows
+
+        void buildIds(ComponentRegistry &registry) { m_dueId = registry.ensureId("SimDue"); }
+        uint32_t dueTagId() const { return m_dueId; }
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool enabled() const { return m_enabled; }
+
+        void setFocus(float x, float z)
+        {
+            m_focusX = x;
+            m_focusZ = z;
+        }
+
+        // Ground distances (meters) where tiers 1, 2 and 3 start.
+        void setTierDistances(float tier1, float tier2, float tier3)
+        {
+            m_tierDist2[0] = tier1 * tier1;
+            m_tierDist2[1] = tier2 * tier2;
+            m_tierDist2[2] = tier3 * tier3;
+        }
+
+        // Convex ground polygon (x, z pairs, either winding) of what the camera sees. count 0 clears it.
+        void setViewFootprint(const float *xz, uint32_t count)
+        {
+            m_footprintCount = std::min(count, kMaxFootprint);
+            std::copy(xz, xz + 2 * m_footprintCount, m_footprint);
+        }
+
+        // Recompute tiers and the due tag for this tick. Call at a sync point (no system running).
+        void update(ArchetypeStoreManager &stores, uint32_t tick, JobSystem *jobs = nullptr)
+        {
+            if (m_dueId == ComponentRegistry::InvalidID)
+                return;
+            const auto &all = stores.stores();
+            m_tiers.resize(all.size());
+            for (uint32_t sid = 0; sid < all.size(); ++sid)
+            {
+                ArchetypeStore *store = all[sid].get();
+                if (!store)
+                    continue;
+                const uint32_t n = store->size();
+                std::vector<uint8_t> &tiers = m_tiers[sid];
+                tiers.resize(n);
+                uint64_t *due = store->tagWordsForWrite(m_dueId);
+                if (n == 0 || !due)
+                    continue;
+
+                const uint32_t words = (n + 63) / 64;
+                if (!m_enabled || !store->hasPosition())
+                {
+                    std::fill(tiers.begin(), tiers.end(), uint8_t(0));
+                    std::fill(due, due + words, ~0ull);
+                    if (n & 63u)
+                        due[words - 1] = (1ull << (n & 63u)) - 1ull;
+                    continue;
+                }
+
+                const auto positions = store->positions();
+                const auto owners = store->entities();
+                parallelForRows(jobs, words, kWordsPerJob, [&](uint32_t w0, uint32_t w1)
+                                {
+                    for (uint32_t w = w0; w < w1; ++w)
+                    {
+                        uint64_t bits = 0;
+                        const uint32_t end = std::min(n, (w + 1) * 64);
+                        for (uint32_t row = w * 64; row < end; ++row)
+                        {
+                            const Position p = positions[row];
+                            const uint32_t tier = tierAt(p.x, p.z);
+                            tiers[row] = static_cast<uint8_t>(tier);
+                            const uint32_t mask = (1u << tier) - 1u;
+                            if (((tick + owners[row].index) & mask) == 0)
+                                bits |= 1ull << (row & 63);
+                        }
+                        due[w] = bits;
+                    } });
+            }
+        }
+
+        // dt multiplier for a due row (its tier period).
+        float scale(uint32_t storeId, uint32_t row) const
+        {
+            if (storeId >= m_tiers.size() || row >= m_tiers[storeId].size())
+                return 1.0f;
+            return static_cast<float>(1u << m_tiers[storeId][row]);
+        }
+
+        uint32_t tier(uint32_t storeId, uint32_t row) const
+        {
+            if (storeId >= m_tiers.size() || row >= m_tiers[storeId].size())
+                return 0;
+            return m_tiers[storeId][row];
+        }
+
+    private:
+        uint32_t tierAt(float x, float z) const
+        {
+            if (m_footprintCount >= 3 && insideFootprint(x, z))
+                return 0;
+            const float dx = x - m_focusX, dz = z - m_focusZ;
+            const float d2 = dx * dx + dz * dz;
+            uint32_t t = 0;
+            while (t < kMaxTier && d2 > m_tierDist2[t])
+                ++t;
+            if (m_footprintCount >= 3)
+                t = std::max(t, 1u);
+            return t;
+        }
+
+        bool insideFootprint(float x, float z) const
+        {
+            bool anyPos = false, anyNeg = false;
+            for (uint32_t i = 0; i < m_footprintCount; ++i)
+            {
+                const uint32_t j = (i + 1) % m_footprintCount;
+                const float ax = m_footprint[2 * i], az = m_footprint[2 * i + 1];
+                const float bx = m_footprint[2 * j], bz = m_footprint[2 * j + 1];
+                const float cross = (bx - ax) * (z - az) - (bz - az) * (x - ax);
+                anyPos |= cross > 0.0f;
+                anyNeg |= cross < 0.0f;
+            }
+            return !(anyPos && anyNeg);
+        }
+
+        uint32_t m_dueId = ComponentRegistry::InvalidID;
+        bool m_enabled = true;
+        float m_focusX = 0.0f, m_focusZ = 0.0f;
+        float m_tierDist2[kMaxTier] = {80.0f * 80.0f, 160.0f * 160.0f, 320.0f * 320.0f};
+        float m_footprint[2 * kMaxFootprint] = {};
+        uint32_t m_footprintCount = 0;
+        std::vector<std::vector<uint8_t>> m_tiers; // [storeId][row]
+    };
+
+} // namespace Engine::ECS
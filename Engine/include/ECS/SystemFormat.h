@@ -6,17 +6,48 @@
     - Define a minimal, type-agnostic "system format" so gameplay systems in SampleApp
       can be written consistently and operate over the engine ECS managers.
     - Keep it simple: systems declare required/excluded component masks, then implement update().
+    - matchingStores(mgr) returns the cached list of stores passing the signature filter.
+    - Systems may also declare which components they read and write; SystemScheduler uses these
+      sets to run non-conflicting systems concurrently.
 
   Notes:
     - The Engine owns the ECS managers (ComponentRegistry, ArchetypeStoreManager, etc.).
     - Application should expose these managers to SampleApp (e.g., via getters or an ECSContext).
     - SampleApp constructs systems that follow this format and calls update() each frame.
 
-  You can evolve this into a scheduler later.
+  Access declarations:
+    - setReadNames/setWriteNames accept component names as well as "resource" names that are not
+      stored in archetypes (e.g. "SpatialGrid"); they only need to be consistent between systems.
+    - A system that declares neither reads nor writes is treated as touching everything and acts as
+      a barrier in the schedule.
+
+  Parallel rows:
+    - forEachChunk(store, chunkSize, fn) splits [0, store.size()) into chunk-aligned ranges and calls
+      fn(begin, end) for each range on the JobSystem set via setJobSystem() (inline without one).
+    - fn must only write rows inside its range; use WorkerLocal<T> for per-thread scratch data.
+
+  Simulation LOD (opt-in):
+    - With setSimulationLod(&lod), a system iterates store.rowFilter(lodRequired(mask), excluded()) so
+      it only sees rows due this tick, and multiplies dt by lodScale(storeId, row) for each of them.
+
+  Frame scratch (opt-in):
+    - With setFrameArena(&arena), scratchArena() returns the calling thread's arena for containers
+      that die before update() returns (Engine::ArenaVector<T>, ArenaAllocator); see FrameArena.h.
+      The owner resets it between runs; without one it is null and ArenaAllocator uses the heap.
+
+  Change tracking:
+    - Writers call store.markChanged<T>(chunk) for chunks they modified; readers test
+      chunkChanged<T>(store, chunk) to skip chunks untouched since their previous run.
 */
 
 #include "ECS/Components.h"     // ComponentRegistry, ComponentMask
 #include "ECS/ArchetypeStore.h" // ArchetypeStoreManager
+#include "ECS/Query.h"          // ArchetypeQuery
+#include "ECS/CommandBuffer.h"  // CommandBuffer
+#include "ECS/ParallelFor.h"    // parallelForRows
+#include "ECS/SimulationLod.h"  // SimulationLod
+#include "utils/FrameArena.h"    // FrameArena, ArenaAllocator
+#include "utils/JobSystem.h"     // JobSystem, WorkerLocal
 
 namespace Engine::ECS
 {
@@ -46,6 +77,8 @@ namespace Engine::ECS
     public:
         void setRequiredNames(const std::vector<std::string> &names) { m_requiredNames = names; }
         void setExcludedNames(const std::vector<std::string> &names) { m_excludedNames = names; }
+        void setReadNames(const std::vector<std::string> &names) { m_readNames = names; }
+        void setWriteNames(const std::vector<std::string> &names) { m_writeNames = names; }
 
         void buildMasks(ComponentRegistry &registry) override
         {
@@ -63,6 +96,51 @@ namespace Engine::ECS
                 uint32_t id = registry.ensureId(n);
                 m_excluded.set(id);
             }
+            // Access sets used by the scheduler
+            m_reads = ComponentMask{};
+            for (const auto &n : m_readNames)
+                m_reads.set(registry.ensureId(n));
+            m_writes = ComponentMask{};
+            for (const auto &n : m_writeNames)
+                m_writes.set(registry.ensureId(n));
+
+            m_query.setFilter(m_required, m_excluded);
+        }
+
+        // Job system used by forEachChunk (set by SystemRunner; may be null).
+        void setJobSystem(JobSystem *jobs) { m_jobs = jobs; }
+        JobSystem *jobSystem() const { return m_jobs; }
+
+        // Deferred structural changes (set by SystemRunner; may be null). Systems must record
+        // spawns/destroys/tag changes here instead of touching stores directly.
+        void setCommandBuffer(CommandBuffer *commands) { m_commands = commands; }
+
+        // Change tick of this system's previous run (0 before the first; stamped by SystemScheduler::run)
+        uint32_t lastRunTick() const { return m_lastRunTick; }
+        void setLastRunTick(uint32_t tick) { m_lastRunTick = tick; }
+
+        // Optional simulation LOD (set by SystemRunner; may be null). See SimulationLod.h.
+        void setSimulationLod(const SimulationLod *lod) { m_lod = lod; }
+        const SimulationLod *simulationLod() const { return m_lod; }
+        CommandBuffer *commandBuffer() const { return m_commands; }
+
+        // Per-tick scratch memory (set by SystemRunner; may be null). See FrameArena.h.
+        void setFrameArena(FrameArena *arena) { m_arena = arena; }
+
+        // Declared access (resolved by buildMasks).
+        const ComponentMask &reads() const { return m_reads; }
+        const ComponentMask &writes() const { return m_writes; }
+        bool declaresAccess() const { return !m_readNames.empty() || !m_writeNames.empty(); }
+
+        // True if this system and 'other' may not run at the same time.
+        // Write/write and read/write overlaps conflict; undeclared systems conflict with everything.
+        bool conflictsWith(const SystemBase &other) const
+        {
+            if (!declaresAccess() || !other.declaresAccess())
+                return true;
+            return overlaps(m_writes, other.m_writes) ||
+                   overlaps(m_writes, other.m_reads) ||
+                   overlaps(m_reads, other.m_writes);
         }
 
     protected:
@@ -70,11 +148,72 @@ namespace Engine::ECS
         const ComponentMask &required() const { return m_required; }
         const ComponentMask &excluded() const { return m_excluded; }
 
+        // Row mask plus the LOD due tag when a SimulationLod is attached.
+        ComponentMask lodRequired(ComponentMask rowMask) const
+        {
+            if (m_lod)
+                rowMask.set(m_lod->dueTagId());
+            return rowMask;
+        }
+
+        // dt multiplier for a due row (1 without LOD).
+        float lodScale(uint32_t storeId, uint32_t row) const { return m_lod ? m_lod->scale(storeId, row) : 1.0f; }
+
+        // True if column T of 'chunk' was written since this system last ran.
+        template <typename T>
+        bool chunkChanged(const ArchetypeStore &store, uint32_t chunk) const
+        {
+            return store.changedSince<T>(chunk, m_lastRunTick);
+        }
+
+        // Stamp column T as changed for every chunk overlapping rows [begin, end).
+        template <typename T>
+        static void markChunks(ArchetypeStore &store, uint32_t begin, uint32_t end)
+        {
+            if (begin >= end)
+                return;
+            const uint32_t rpc = store.rowsPerChunk();
+            for (uint32_t c = begin / rpc; c <= (end - 1) / rpc; ++c)
+                store.markChanged<T>(c);
+        }
+
+        // Calling thread's frame arena, or null (ArenaAllocator then falls back to the heap).
+        LinearArena *scratchArena() const { return m_arena ? &m_arena->local() : nullptr; }
+
+        // IDs of stores whose signature matches required/excluded (cached; see Query.h).
+        const std::vector<uint32_t> &matchingStores(const ArchetypeStoreManager &mgr) { return m_query.matching(mgr); }
+
+        // Run fn(begin, end) over the rows of one store, split across the job system.
+        // chunkSize is rounded up to whole storage chunks so no two jobs share a chunk.
+        template <typename Fn>
+        void forEachChunk(const ArchetypeStore &store, uint32_t chunkSize, Fn &&fn) const
+        {
+            const uint32_t perChunk = store.rowsPerChunk();
+            const uint32_t rows = std::max(perChunk, (chunkSize + perChunk - 1) / perChunk * perChunk);
+            parallelForRows(m_jobs, store.size(), rows, std::forward<Fn>(fn));
+        }
+
+    private:
+        static bool overlaps(const ComponentMask &a, const ComponentMask &b)
+        {
+            return a.intersects(b);
+        }
+
     private:
         std::vector<std::string> m_requiredNames;
         std::vector<std::string> m_excludedNames;
+        std::vector<std::string> m_readNames;
+        std::vector<std::string> m_writeNames;
         ComponentMask m_required;
         ComponentMask m_excluded;
+        ComponentMask m_reads;
+        ComponentMask m_writes;
+        ArchetypeQuery m_query;
+        JobSystem *m_jobs = nullptr;
+        CommandBuffer *m_commands = nullptr;
+        const SimulationLod *m_lod = nullptr;
+        FrameArena *m_arena = nullptr;
+        uint32_t m_lastRunTick = 0;
     };
 
 } // namespace Engine::ECS
\ No newline at end of file
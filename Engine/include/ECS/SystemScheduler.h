@@ -0,0 +1,159 @@
+#pragma once
+/*
+  SystemScheduler.h
+  -----------------
+  Purpose:
+    - Run a list of SystemBase instances as a dependency DAG built from their declared
+      read/write sets (see SystemFormat.h).
+    - Systems that do not conflict run at the same time on a JobSystem; conflicting systems keep
+      the relative order in which they were added.
+
+  Usage:
+    - scheduler.add(&systemA); scheduler.add(&systemB); ...   // in the desired serial order
+    - scheduler.build();                                        // after every system's buildMasks()
+    - scheduler.run(stores, dt, &jobs);                         // each frame; blocks until all finish
+
+  Notes:
+    - Edges: for every pair (earlier A, later B) that conflicts, B waits for A. Redundant edges are
+      kept; they are cheap and keep the rule easy to reason about.
+    - Without a JobSystem (or with zero workers) run() executes the systems inline in added order.
+    - run() advances the stores' change tick and records it as each system's lastRunTick().
+    - Each update() runs inside an Engine::Profiler scope named after the system.
+*/
+
+#include "ECS/SystemFormat.h"
+#include "utils/JobSystem.h"
+#include "utils/Profiler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Engine::ECS
+{
+    class SystemScheduler
+    {
+    public:
+        void add(SystemBase *system)
+        {
+            if (!system)
+                return;
+            m_nodes.push_back(Node{system, {}, 0});
+            m_built = false;
+        }
+
+        void clear()
+        {
+            m_nodes.clear();
+            m_built = false;
+        }
+
+        // Compute dependency edges from the systems' access sets.
+        void build()
+        {
+            const uint32_t n = static_cast<uint32_t>(m_nodes.size());
+            for (auto &node : m_nodes)
+            {
+                node.dependents.clear();
+                node.dependencyCount = 0;
+            }
+
+            for (uint32_t b = 0; b < n; ++b)
+            {
+                for (uint32_t a = 0; a < b; ++a)
+                {
+                    if (!m_nodes[a].system->conflictsWith(*m_nodes[b].system))
+                        continue;
+                    m_nodes[a].dependents.push_back(b);
+                    ++m_nodes[b].dependencyCount;
+                }
+            }
+
+            m_remaining = std::make_unique<std::atomic<uint32_t>[]>(n);
+            m_built = true;
+        }
+
+        // Execute all systems for this frame.
+        void run(ArchetypeStoreManager &stores, float dt, JobSystem *jobs)
+        {
+            if (!m_built)
+                build();
+
+            // New change tick for this pass; each system remembers the tick it last ran in.
+            const uint32_t tick = stores.beginTick();
+
+            if (!jobs || jobs->workerCount() == 0)
+            {
+                for (auto &node : m_nodes)
+                {
+                    ENGINE_PROFILE_SCOPE(node.system->name());
+                    node.system->update(stores, dt);
+                    node.system->setLastRunTick(tick);
+                }
+                return;
+            }
+
+            const uint32_t n = static_cast<uint32_t>(m_nodes.size());
+            for (uint32_t i = 0; i < n; ++i)
+                m_remaining[i].store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+
+            JobSystem::Counter counter;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                if (m_nodes[i].dependencyCount == 0)
+                    submitNode(i, stores, dt, tick, *jobs, counter);
+            }
+            jobs->wait(counter);
+        }
+
+        // Visit every registered system in added order.
+        template <typename Fn>
+        void forEachSystem(Fn &&fn)
+        {
+            for (auto &node : m_nodes)
+                fn(*node.system);
+        }
+
+        // Number of systems that can start immediately (diagnostics).
+        uint32_t rootCount() const
+        {
+            uint32_t roots = 0;
+            for (const auto &node : m_nodes)
+                roots += (node.dependencyCount == 0) ? 1u : 0u;
+            return roots;
+        }
+
+    private:
+        struct Node
+        {
+            SystemBase *system = nullptr;
+            std::vector<uint32_t> dependents;
+            uint32_t dependencyCount = 0;
+        };
+
+        void submitNode(uint32_t index, ArchetypeStoreManager &stores, float dt, uint32_t tick, JobSystem &jobs, JobSystem::Counter &counter)
+        {
+            jobs.submit(counter, [this, index, &stores, dt, tick, &jobs, &counter]()
+                        {
+                {
+                    ENGINE_PROFILE_SCOPE(m_nodes[index].system->name());
+                    m_nodes[index].system->update(stores, dt);
+                }
+                m_nodes[index].system->setLastRunTick(tick);
+
+                // Release dependents whose last prerequisite just finished.
+                for (uint32_t d : m_nodes[index].dependents)
+                {
+                    if (m_remaining[d].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        submitNode(d, stores, dt, tick, jobs, counter);
+                } });
+        }
+
+    private:
+        std::vector<Node> m_nodes;
+        std::unique_ptr<std::atomic<uint32_t>[]> m_remaining;
+        bool m_built = false;
+    };
+
+} // namespace Engine::ECS
@@ -0,0 +1,401 @@
+#pragma once
+/*
+  WorldSnapshot.h
+  ---------------
+  Purpose:
+    - Save and restore the whole ECS world (entities, stores, row tags) as one binary file, for
+      replays, quick save and crash recovery. No per-entity parsing: columns are written and read
+      back as raw chunk images.
+
+  Usage:
+    - saveWorldSnapshot("world.snap", ecs.components, ecs.stores, ecs.entities);
+    - loadWorldSnapshot("world.snap", ecs.components, ecs.archetypes, ecs.stores, ecs.entities);
+
+  File layout (native endianness; every block starts on a 64-byte boundary):
+    - SnapshotHeader
+    - component name table: {nameLength, size, lanes} + name bytes, per component ID
+    - entities: generations[], records[], free list[]
+    - per store: SnapshotStoreHeader, signature IDs[], column descriptors[], tag plane IDs[],
+      tag words[], then chunkCount raw chunks of kChunkBytes
+
+  Notes:
+    - Loading maps the file (MappedFile) and bounds-checks every section before clearing the existing
+      stores; on false the world is untouched. Component names are remapped through the current
+      registry, so IDs may differ between builds.
+    - When a store's layout matches the saved one (same components and rows per chunk), its chunks are
+      copied in bulk. Otherwise each row is rebuilt column by column, and columns whose size changed keep
+      their defaults.
+    - Asset handles (RenderModel) are saved as raw values. They stay valid only if assets are loaded
+      in the same order as when the snapshot was taken.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ECS/ArchetypeManager.h"
+#include "ECS/ArchetypeStore.h"
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+#include "utils/MappedFile.h"
+
+namespace Engine::ECS
+{
+    namespace snapshot_detail
+    {
+        static constexpr char kMagic[8] = {'S', 'T', 'R', 'A', 'S', 'N', 'A', 'P'};
+        static constexpr uint32_t kVersion = 1;
+        static constexpr uint32_t kBlockAlign = 64;
+
+        struct SnapshotHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t chunkBytes;
+            uint32_t componentCount;
+            uint32_t storeCount;
+            uint32_t entityCount; // entity index slots (alive and free)
+            uint32_t freeCount;
+        };
+
+        struct SnapshotStoreHeader
+        {
+            uint32_t archetypeId;
+            uint32_t rowCount;
+            uint32_t rowsPerChunk;
+            uint32_t chunkCount;
+            uint32_t signatureCount;
+            uint32_t columnCount;
+            uint32_t tagPlaneCount;
+            uint32_t tagWordCount;
+        };
+
+        struct SnapshotColumn
+        {
+            uint32_t componentId; // InvalidID for the entity column
+            uint32_t size;
+            uint32_t lanes;
+            uint32_t offset;
+        };
+
+        class Writer
+        {
+        public:
+            template <typename T>
+            void put(const T &value) { bytes(&value, sizeof(T)); }
+
+            void bytes(const void *data, size_t n)
+            {
+                const auto *p = static_cast<const std::byte *>(data);
+                m_buffer.insert(m_buffer.end(), p, p + n);
+            }
+
+            void align() { m_buffer.resize((m_buffer.size() + kBlockAlign - 1) & ~size_t(kBlockAlign - 1)); }
+
+            bool writeTo(const std::string &path) const
+            {
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char *>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+                return out.good();
+            }
+
+        private:
+            std::vector<std::byte> m_buffer;
+        };
+
+        class Reader
+        {
+        public:
+            Reader(const std::byte *data, size_t size) : m_data(data), m_size(size) {}
+
+            template <typename T>
+            bool get(T &out)
+            {
+                const std::byte *p = take(sizeof(T));
+                if (p)
+                    std::memcpy(&out, p, sizeof(T));
+                return p != nullptr;
+            }
+
+            // Pointer to the next n bytes (nullptr, and the reader fails, if the file is too short).
+            const std::byte *take(size_t n)
+            {
+                if (m_failed || n > m_size - m_pos)
+                {
+                    m_failed = true;
+                    return nullptr;
+                }
+                const std::byte *p = m_data + m_pos;
+                m_pos += n;
+                return p;
+            }
+
+            void align() { m_pos = std::min(m_size, (m_pos + kBlockAlign - 1) & ~size_t(kBlockAlign - 1)); }
+            bool failed() const { return m_failed; }
+
+        private:
+            const std::byte *m_data;
+            size_t m_size;
+            size_t m_pos = 0;
+            bool m_failed = false;
+        };
+    } // namespace snapshot_detail
+
+    inline bool saveWorldSnapshot(const std::string &path,
+                                  const ComponentRegistry &registry,
+                                  const ArchetypeStoreManager &stores,
+                                  const EntitiesRecord &entities)
+    {
+        using namespace snapshot_detail;
+        Writer w;
+
+        uint32_t storeCount = 0;
+        for (const auto &store : stores.stores())
+            storeCount += (store && store->size() > 0) ? 1u : 0u;
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.chunkBytes = kChunkBytes;
+        header.componentCount = registry.count();
+        header.storeCount = storeCount;
+        header.entityCount = entities.capacity();
+        header.freeCount = static_cast<uint32_t>(entities.freeList().size());
+        w.put(header);
+
+        for (uint32_t id = 0; id < registry.count(); ++id)
+        {
+            const std::string &name = registry.getName(id);
+            const ComponentTypeInfo &info = registry.info(id);
+            w.put(static_cast<uint32_t>(name.size()));
+            w.put(info.size);
+            w.put(info.lanes);
+            w.bytes(name.data(), name.size());
+        }
+        w.align();
+
+        w.bytes(entities.generations().data(), entities.generations().size() * sizeof(uint32_t));
+        w.bytes(entities.records().data(), entities.records().size() * sizeof(EntityRecord));
+        w.bytes(entities.freeList().data(), entities.freeList().size() * sizeof(uint32_t));
+        w.align();
+
+        for (uint32_t archetypeId = 0; archetypeId < stores.stores().size(); ++archetypeId)
+        {
+            const ArchetypeStore *store = stores.stores()[archetypeId].get();
+            if (!store || store->size() == 0)
+                continue;
+
+            std::vector<uint32_t> signature;
+            for (uint32_t id = 0; id < ComponentMask::kBits; ++id)
+                if (store->signature().has(id))
+                    signature.push_back(id);
+
+            SnapshotStoreHeader sh{};
+            sh.archetypeId = archetypeId;
+            sh.rowCount = store->size();
+            sh.rowsPerChunk = store->rowsPerChunk();
+            sh.chunkCount = store->chunkCount();
+            sh.signatureCount = static_cast<uint32_t>(signature.size());
+            sh.columnCount = store->columnCount();
+            sh.tagPlaneCount = store->tagPlaneCount();
+            sh.tagWordCount = (store->size() + 63) / 64;
+            w.put(sh);
+            w.bytes(signature.data(), signature.size() * sizeof(uint32_t));
+            for (uint32_t c = 0; c < store->columnCount(); ++c)
+                w.put(SnapshotColumn{store->columnComponentId(c), store->columnElementSize(c),
+                                     store->columnLanes(c), store->columnOffset(c)});
+            for (uint32_t p = 0; p < sh.tagPlaneCount; ++p)
+                w.put(store->tagPlaneId(p));
+            for (uint32_t p = 0; p < sh.tagPlaneCount; ++p)
+                w.bytes(store->tagPlaneWords(p).data(), sh.tagWordCount * sizeof(uint64_t));
+            w.align();
+            for (uint32_t c = 0; c < sh.chunkCount; ++c)
+                w.bytes(store->chunkBytes(c), kChunkBytes);
+        }
+
+        return w.writeTo(path);
+    }
+
+    inline bool loadWorldSnapshot(const std::string &path,
+                                  ComponentRegistry &registry,
+                                  ArchetypeManager &archetypes,
+                                  ArchetypeStoreManager &stores,
+                                  EntitiesRecord &entities)
+    {
+        using namespace snapshot_detail;
+        MappedFile file;
+        if (!file.open(path))
+            return false;
+        Reader r(file.data(), file.size());
+
+        SnapshotHeader header{};
+        if (!r.get(header) || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.version != kVersion || header.chunkBytes != kChunkBytes)
+            return false;
+
+        // Pass 1: read and bounds-check every section. Nothing in the world changes until all of
+        // them are valid, so a false return leaves the current world as it was.
+        std::vector<std::string> names(header.componentCount);
+        std::vector<uint32_t> savedSize(header.componentCount, 0); // to detect changed types
+        for (uint32_t id = 0; id < header.componentCount; ++id)
+        {
+            uint32_t nameLength = 0, size = 0, lanes = 0;
+            if (!r.get(nameLength) || !r.get(size) || !r.get(lanes))
+                return false;
+            const std::byte *name = r.take(nameLength);
+            if (!name)
+                return false;
+            names[id].assign(reinterpret_cast<const char *>(name), nameLength);
+            savedSize[id] = size;
+        }
+        r.align();
+
+        const auto *generations = reinterpret_cast<const uint32_t *>(r.take(size_t(header.entityCount) * sizeof(uint32_t)));
+        const std::byte *recordBytes = r.take(size_t(header.entityCount) * sizeof(EntityRecord));
+        const auto *freeList = reinterpret_cast<const uint32_t *>(r.take(size_t(header.freeCount) * sizeof(uint32_t)));
+        r.align();
+        if (r.failed())
+            return false;
+        std::vector<EntityRecord> records(header.entityCount);
+        std::memcpy(records.data(), recordBytes, records.size() * sizeof(EntityRecord));
+
+        struct StoreSection
+        {
+            SnapshotStoreHeader sh;
+            const uint32_t *signatureIds;
+            std::vector<SnapshotColumn> columns;
+            const uint32_t *tagIds;
+            const std::byte *tagWords;
+            const std::byte *chunks;
+        };
+        std::vector<StoreSection> sections(header.storeCount);
+        for (StoreSection &sec : sections)
+        {
+            SnapshotStoreHeader &sh = sec.sh;
+            if (!r.get(sh))
+                return false;
+            sec.signatureIds = reinterpret_cast<const uint32_t *>(r.take(size_t(sh.signatureCount) * sizeof(uint32_t)));
+            const auto *columnBytes = r.take(size_t(sh.columnCount) * sizeof(SnapshotColumn));
+            sec.tagIds = reinterpret_cast<const uint32_t *>(r.take(size_t(sh.tagPlaneCount) * sizeof(uint32_t)));
+            sec.tagWords = r.take(size_t(sh.tagPlaneCount) * sh.tagWordCount * sizeof(uint64_t));
+            r.align();
+            sec.chunks = r.take(size_t(sh.chunkCount) * kChunkBytes);
+            if (r.failed() || sh.rowsPerChunk == 0 || sh.columnCount == 0 ||
+                sh.rowCount > uint64_t(sh.chunkCount) * sh.rowsPerChunk)
+                return false;
+
+            sec.columns.resize(sh.columnCount);
+            std::memcpy(sec.columns.data(), columnBytes, sec.columns.size() * sizeof(SnapshotColumn));
+            // Every column must lie inside its chunk image; column 0 holds the owning Entity.
+            for (const SnapshotColumn &col : sec.columns)
+            {
+                const uint64_t bytes = col.lanes == 0 ? uint64_t(col.size) * sh.rowsPerChunk
+                                                      : uint64_t(col.lanes) * sh.rowsPerChunk * 4u;
+                if ((col.lanes != 0 && col.size != col.lanes * 4u) || uint64_t(col.offset) + bytes > kChunkBytes)
+                    return false;
+            }
+            if (sec.columns[0].size != sizeof(Entity) || sec.columns[0].lanes != 0)
+                return false;
+        }
+
+        // Pass 2: replace the current world.
+        std::vector<uint32_t> remap(header.componentCount, ComponentRegistry::InvalidID); // saved ID -> current ID
+        for (uint32_t id = 0; id < header.componentCount; ++id)
+            remap[id] = registry.ensureId(names[id]);
+        auto current = [&](uint32_t savedId)
+        { return savedId < remap.size() ? remap[savedId] : ComponentRegistry::InvalidID; };
+
+        for (const auto &store : stores.stores())
+            if (store)
+                store->clearRows();
+
+        std::vector<uint32_t> archetypeRemap; // saved archetype ID -> current ID
+        std::vector<std::byte> element;
+        for (const StoreSection &sec : sections)
+        {
+            const SnapshotStoreHeader &sh = sec.sh;
+            const std::vector<SnapshotColumn> &columns = sec.columns;
+
+            ComponentMask signature;
+            for (uint32_t i = 0; i < sh.signatureCount; ++i)
+                signature.set(current(sec.signatureIds[i]));
+            const uint32_t archetypeId = archetypes.getOrCreate(signature);
+            ArchetypeStore *store = stores.getOrCreate(archetypeId, signature, registry);
+            if (archetypeRemap.size() <= sh.archetypeId)
+                archetypeRemap.resize(size_t(sh.archetypeId) + 1, UINT32_MAX);
+            archetypeRemap[sh.archetypeId] = archetypeId;
+
+            bool sameLayout = store->rowsPerChunk() == sh.rowsPerChunk && store->columnCount() == sh.columnCount;
+            for (uint32_t c = 0; sameLayout && c < sh.columnCount; ++c)
+            {
+                const SnapshotColumn &col = columns[c];
+                const uint32_t id = (c == 0) ? ComponentRegistry::InvalidID : current(col.componentId);
+                sameLayout = store->columnComponentId(c) == id && store->columnElementSize(c) == col.size &&
+                             store->columnLanes(c) == col.lanes && store->columnOffset(c) == col.offset;
+            }
+
+            if (sameLayout)
+            {
+                store->adoptChunks(sec.chunks, sh.chunkCount, sh.rowCount);
+            }
+            else
+            {
+                // Rebuild row by row from the saved chunk images.
+                const uint32_t laneStride = sh.rowsPerChunk * 4u;
+                auto savedElement = [&](const SnapshotColumn &col, uint32_t row, std::byte *out)
+                {
+                    const std::byte *base = sec.chunks + size_t(row / sh.rowsPerChunk) * kChunkBytes + col.offset;
+                    const uint32_t slot = row % sh.rowsPerChunk;
+                    if (col.lanes == 0)
+                        std::memcpy(out, base + size_t(slot) * col.size, col.size);
+                    else
+                        for (uint32_t k = 0; k < col.lanes; ++k)
+                            std::memcpy(out + k * 4u, base + k * laneStride + slot * 4u, 4u);
+                };
+
+                for (uint32_t row = 0; row < sh.rowCount; ++row)
+                {
+                    Entity owner{};
+                    element.resize(sizeof(Entity));
+                    savedElement(columns[0], row, element.data());
+                    std::memcpy(&owner, element.data(), sizeof(Entity));
+                    const uint32_t dstRow = store->createRow(owner);
+
+                    for (uint32_t c = 1; c < sh.columnCount; ++c)
+                    {
+                        const SnapshotColumn &col = columns[c];
+                        const uint32_t dstColumn = store->columnOfComponent(current(col.componentId));
+                        if (dstColumn == ArchetypeStore::kNoColumn || store->columnElementSize(dstColumn) != col.size ||
+                            col.componentId >= savedSize.size() || savedSize[col.componentId] != col.size)
+                            continue;
+                        element.resize(col.size);
+                        savedElement(col, row, element.data());
+                        store->writeElement(dstColumn, dstRow, element.data());
+                    }
+                }
+            }
+
+            for (uint32_t p = 0; p < sh.tagPlaneCount; ++p)
+            {
+                std::vector<uint64_t> words(sh.tagWordCount);
+                std::memcpy(words.data(), sec.tagWords + size_t(p) * sh.tagWordCount * sizeof(uint64_t), words.size() * sizeof(uint64_t));
+                store->restoreTagWords(current(sec.tagIds[p]), words.data(), sh.tagWordCount);
+            }
+        }
+
+        // Records point at saved archetype IDs; rows are unchanged (both load paths keep row order).
+        for (EntityRecord &rec : records)
+        {
+            if (rec.archetypeId == UINT32_MAX)
+                continue;
+            rec.archetypeId = rec.archetypeId < archetypeRemap.size() ? archetypeRemap[rec.archetypeId] : UINT32_MAX;
+            if (rec.archetypeId == UINT32_MAX)
+                rec.row = UINT32_MAX;
+        }
+        entities.restore(generations, records.data(), header.entityCount, freeList, header.freeCount);
+        return true;
+    }
+
+} // namespace Engine::ECS
@@ -1,19 +1,18 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <functional>
 #include <string>
 
+#include "Engine/TimeStep.h"
+
 namespace Engine
 {
     class Window;
     class VulkanContext;
     class Renderer;
     class ImGuiLayer;
-
-    struct TimeStep
-    {
-        float DeltaSeconds = 0.0f;
-    };
+    struct HitchDetectorConfig;
 
     namespace ECS
     {
@@ -48,6 +47,20 @@ namespace Engine
 
         // Request application quit
         virtual void Close();
+        // Close() at the start of the next frame; safe from OnUpdate/OnRender, where the current
+        // frame still needs ImGui and the renderer.
+        void RequestClose();
+
+        // Fixed TimeStep::DeltaSeconds for every frame (benchmarks, replays); 0 = measured wall time.
+        void SetFixedTimeStep(float seconds);
+
+        // Record the next 'frames' frames (CPU scopes, GPU passes, asset events) into a Chrome trace
+        // JSON file; open it in ui.perfetto.dev or chrome://tracing. False while a capture runs.
+        bool StartTraceCapture(const std::string &path, uint32_t frames);
+
+        // Write the last frames (CPU scopes, GPU passes, asset events, memory) to a file in
+        // config.directory whenever a frame takes config.threshold times the median (see HitchDetector.h).
+        void EnableHitchDetector(const HitchDetectorConfig &config);
 
         // Event callback dispatching (simple)
         using EventCallbackFn = std::function<void(const std::string &eventName)>;
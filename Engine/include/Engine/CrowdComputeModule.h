@@ -0,0 +1,235 @@
+#pragma once
+/*
+  CrowdComputeModule.h
+  --------------------
+  Purpose:
+    - Optional GPU path for crowd movement: keeps unit state (position, velocity, radius,
+      avoidance params) in device-local storage buffers and runs, per simulation step, a hash
+      grid build (GPU counting sort), local avoidance and integration (shaders/crowd.comp).
+      Mirrors SpatialIndexSystem + LocalAvoidanceSystem + MovementSystem from the Sample.
+    - Writes one instance matrix per drawn unit straight into a vertex/storage buffer that
+      SModelRenderPassModule batches can draw from (Batch::instanceSource), so positions never round-trip
+      through the CPU for rendering.
+    - Copies back only the units the caller asks for (e.g. the ones gameplay is steering).
+
+  Usage:
+    - Register with the Renderer like any RenderPassModule; check available() after onCreate
+      (false when the device or crowd.comp.spv is missing; callers then stay on the CPU path).
+    - From the simulation (any thread):
+        setUnits(units, n, instanceCount, layout);  // after spawns/removals/row moves
+        patchUnits(patches, k);                     // per tick: steering velocities and flags
+        requestReadback(ids, m);                    // units to copy back after the next step
+        step(dt);
+    - takeReadback(...) hands over the last completed readback (one or two frames behind).
+    - On the render thread, before handing instanceBuffer() to draw passes: prepareFrame() (grows the
+      instance buffer for the latest setUnits), then setInterpolation(alpha) to blend instance
+      matrices between the last two steps.
+
+  Notes:
+    - Work is recorded by recordCompute(), which the Renderer calls outside the main render pass;
+      it assumes the graphics queue also supports compute (true for all desktop drivers). The
+      Renderer's render graph orders instanceBuffer() against the passes that read it.
+    - Growing the device buffers waits for the device to go idle (spawns only).
+    - Units are simulated every step (the CPU SimulationLod does not apply here).
+*/
+
+#include "Engine/Renderer.h"
+#include "utils/MemoryAllocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Engine
+{
+    // One unit as stored on the GPU (std430, matches crowd.comp).
+    struct CrowdUnitGpu
+    {
+        float posX = 0.0f, posY = 0.0f, posZ = 0.0f;
+        float radius = -1.0f; // < 0: not seen by neighbors' avoidance
+        float velX = 0.0f, velY = 0.0f, velZ = 0.0f;
+        float separation = 0.0f;
+        float strength = 1.0f, maxAccel = 0.9f, blend = 0.55f;
+        float yaw = 0.0f;
+        uint32_t flags = 0;
+        uint32_t instance = UINT32_MAX; // slot in the instance buffer, UINT32_MAX = not drawn
+        uint32_t _pad0 = 0, _pad1 = 0;
+    };
+    static_assert(sizeof(CrowdUnitGpu) == 64, "CrowdUnitGpu must match crowd.comp Unit");
+
+    // Per-tick update of one unit: preferred velocity (x/z) and flags.
+    struct CrowdPatchGpu
+    {
+        uint32_t unit = 0;
+        uint32_t flags = 0;
+        float velX = 0.0f;
+        float velZ = 0.0f;
+    };
+    static_assert(sizeof(CrowdPatchGpu) == 16, "CrowdPatchGpu must match crowd.comp Patch");
+
+    class CrowdComputeModule : public RenderPassModule
+    {
+    public:
+        // CrowdUnitGpu::flags
+        static constexpr uint32_t kFlagAvoid = 1u;  // apply local avoidance
+        static constexpr uint32_t kFlagMove = 2u;   // integrate position
+        static constexpr uint32_t kFlagFacing = 4u; // yaw follows velocity, instance is rotated
+
+        static constexpr uint32_t kGroupSize = 256;        // crowd.comp local_size_x
+        static constexpr uint32_t kScanBlock = 512;        // buckets per scan workgroup
+        static constexpr uint32_t kMinBuckets = kScanBlock;
+        static constexpr uint32_t kMaxBuckets = kScanBlock * kScanBlock; // single-level block-sum scan
+        static constexpr uint32_t kMaxStepsPerFrame = 4;   // further queued steps are merged into the last
+
+        CrowdComputeModule() = default;
+        ~CrowdComputeModule() override = default;
+
+        bool available() const { return m_available; }
+
+        // Grid cell size (meters); matches SpatialIndexSystem's neighbor radius.
+        void setCellSize(float cellSize);
+
+        // Replace every unit. 'instanceCount' sizes the instance buffer (max instance slot + 1);
+        // 'layout' is an opaque caller serial reported back by layoutSerial() / takeReadback().
+        void setUnits(const CrowdUnitGpu *units, uint32_t count, uint32_t instanceCount, uint64_t layout);
+
+        // Velocity/flag updates applied before the next step. Indices refer to the last setUnits().
+        void patchUnits(const CrowdPatchGpu *patches, uint32_t count);
+
+        // Queue one simulation step.
+        void step(float dt);
+
+        // Units to copy back right after the next recorded step (replaces any pending request).
+        void requestReadback(const uint32_t *units, uint32_t count);
+
+        // Newest completed readback, if one arrived since the last call. 'layout' is the setUnits()
+        // serial the indices refer to.
+        bool takeReadback(std::vector<uint32_t> &units, std::vector<CrowdUnitGpu> &states, uint64_t &layout);
+
+        // Render thread, before instanceBuffer() is used for this frame's draws.
+        void prepareFrame();
+
+        // Blend factor for the instance matrices written this frame (0 = before the last step).
+        void setInterpolation(float alpha);
+
+        // Serial passed to the latest setUnits() (what the next recorded frame will draw).
+        uint64_t layoutSerial() const;
+
+        // Instance matrices (glm::mat4 per slot), usable as a per-instance vertex buffer.
+        VkBuffer instanceBuffer() const { return m_instances.buffer; }
+
+        const char *name() const override { return "CrowdComputeModule"; }
+        void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
+        void recordCompute(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        // Writes instanceBuffer(); draw passes declare their reads of it.
+        void declareCompute(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx) override;
+        void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
+        void onDestroy(VulkanContext &ctx) override;
+
+    private:
+        enum Pass : uint32_t
+        {
+            PassPatch = 0,
+            PassCount,
+            PassScanBlocks,
+            PassScanSums,
+            PassScanAdd,
+            PassScatter,
+            PassSimulate,
+            PassInstances,
+            PassCountTotal
+        };
+
+        struct PushConstants
+        {
+            uint32_t unitCount = 0;
+            uint32_t patchCount = 0;
+            uint32_t bucketCount = 0;
+            uint32_t blockCount = 0;
+            float cellSize = 2.0f;
+            float dt = 0.0f;
+            float alpha = 1.0f;
+            uint32_t instanceCapacity = 0;
+        };
+        static_assert(sizeof(PushConstants) == 32, "PushConstants must match crowd.comp Params");
+
+        struct Buffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            MemoryAllocation memory;
+            void *mapped = nullptr; // host-visible buffers only (memory.mapped)
+            VkDeviceSize size = 0;
+        };
+
+        // Host-visible per-frame-slot buffers. A slot is reused only after the Renderer waited on
+        // its fence, so the previous contents are no longer in use.
+        struct FrameSlot
+        {
+            Buffer staging;  // uploads (units, prev, patches)
+            Buffer readback; // copied-back units
+            std::vector<uint32_t> readbackUnits;
+            uint64_t readbackLayout = 0;
+            bool readbackPending = false;
+        };
+
+        // CPU-side state handed from the simulation to the next recordCompute().
+        struct Pending
+        {
+            bool hasUnits = false;
+            std::vector<CrowdUnitGpu> units;
+            uint32_t instanceCount = 0;
+            std::vector<CrowdPatchGpu> patches;
+            std::vector<float> steps;
+            bool hasReadback = false;
+            std::vector<uint32_t> readbackUnits;
+        };
+
+        bool createPipelines(VulkanContext &ctx);
+        bool createBuffer(Buffer &out, VkDeviceSize size, VkBufferUsageFlags usage, bool hostVisible);
+        void destroyBuffer(Buffer &b);
+        bool ensureDeviceBuffers(uint32_t units, uint32_t buckets, uint32_t patches);
+        bool ensureHostBuffer(Buffer &b, VkDeviceSize size, VkBufferUsageFlags usage);
+        void updateDescriptorSet();
+        void dispatch(VkCommandBuffer cmd, Pass pass, uint32_t invocations);
+        void computeBarrier(VkCommandBuffer cmd, VkPipelineStageFlags src, VkAccessFlags srcAccess,
+                            VkPipelineStageFlags dst, VkAccessFlags dstAccess);
+        void recordStep(VkCommandBuffer cmd, float dt);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+        bool m_available = false;
+
+        VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        VkDescriptorSet m_set = VK_NULL_HANDLE;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_pipelines[PassCountTotal] = {};
+
+        // Device-local state (bindings 0..8 of crowd.comp)
+        Buffer m_units, m_prev, m_bucketCount, m_bucketStart, m_blockSums, m_unitBucket, m_entries, m_patches;
+        Buffer m_instances;
+        uint32_t m_unitCapacity = 0, m_bucketCapacity = 0, m_patchCapacity = 0, m_instanceCapacity = 0;
+
+        std::vector<FrameSlot> m_slots;
+
+        // Recording-side view of what is on the GPU
+        PushConstants m_pc{};
+        uint32_t m_unitCount = 0;
+
+        mutable std::mutex m_mutex; // guards everything below
+        Pending m_pending;
+        float m_cellSize = 2.0f;
+        float m_alpha = 1.0f;
+        uint64_t m_pendingLayout = 0; // serial of the latest setUnits()
+        uint32_t m_layoutInstances = 0; // instance count of the latest setUnits()
+        uint64_t m_gpuLayout = 0;     // serial of the units currently on the GPU
+        bool m_readyReadback = false;
+        std::vector<uint32_t> m_readyUnits;
+        std::vector<CrowdUnitGpu> m_readyStates;
+        uint64_t m_readyLayout = 0;
+    };
+
+} // namespace Engine
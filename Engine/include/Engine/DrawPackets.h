@@ -0,0 +1,121 @@
+#pragma once
+/*
+  DrawPackets.h
+  -------------
+  Purpose:
+    - Draw ordering and redundant state elimination for render pass modules that record many draws
+      (SModelRenderPassModule): each draw becomes a packet with a 64-bit sort key, the packets are
+      radix-sorted once per frame, and commands go out through a state cache that drops binds and
+      push constants matching what is already bound.
+
+  Usage:
+    - packets.push_back({DrawPackets::makeKey(pass, pipeline, material, mesh, sub), drawIndex});
+      (or DrawPackets::makeOrderedKey(pass, sequence) where submission order matters, e.g. blending)
+    - DrawPackets::sort(packets, scratch);
+    - DrawStateCache state(cmd); state.bindPipeline(...); state.bindVertexBuffer(...); state.pushConstants(...);
+
+  Notes:
+    - Key layout, most significant first: pass (2 bits), pipeline (6), material (24), mesh (24), sub (8).
+      Fields are masked to their width; callers pass dense ids (AssetManager indices, per-frame mesh ids).
+    - The sort is stable, so equal keys keep submission order.
+    - A DrawStateCache only knows what was bound through it: use one per command sequence, and
+      reset() it after recording anything that binds state around it.
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    struct DrawPacket
+    {
+        uint64_t key = 0;
+        uint32_t index = 0; // the caller's draw
+    };
+
+    namespace DrawPackets
+    {
+        constexpr uint32_t kPassBits = 2;
+        constexpr uint32_t kPipelineBits = 6;
+        constexpr uint32_t kMaterialBits = 24;
+        constexpr uint32_t kMeshBits = 24;
+        constexpr uint32_t kSubBits = 8;
+
+        inline uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t sub)
+        {
+            auto field = [](uint32_t v, uint32_t bits)
+            { return static_cast<uint64_t>(v) & ((uint64_t(1) << bits) - 1u); };
+            return (field(pass, kPassBits) << 62) | (field(pipeline, kPipelineBits) << 56) |
+                   (field(material, kMaterialBits) << 32) | (field(mesh, kMeshBits) << 8) | field(sub, kSubBits);
+        }
+
+        // Pass first, then submission order only.
+        inline uint64_t makeOrderedKey(uint32_t pass, uint64_t sequence)
+        {
+            return (static_cast<uint64_t>(pass & 3u) << 62) | (sequence & ((uint64_t(1) << 62) - 1u));
+        }
+
+        // Stable LSD radix sort by key, 8 bits per digit; digits every key shares are skipped.
+        // 'scratch' is resized to packets.size() and keeps its capacity across frames.
+        void sort(std::vector<DrawPacket> &packets, std::vector<DrawPacket> &scratch);
+    }
+
+    // Binds through the cache skip the command when it matches the bound state.
+    class DrawStateCache
+    {
+    public:
+        explicit DrawStateCache(VkCommandBuffer cmd) : m_cmd(cmd) {}
+
+        void reset();
+
+        void bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+        // Up to kMaxDynamicOffsets dynamic offsets are compared; a set bound with more always rebinds.
+        void bindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex, VkDescriptorSet set,
+                               uint32_t dynamicOffsetCount = 0, const uint32_t *dynamicOffsets = nullptr);
+        void bindVertexBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset);
+        void bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type);
+        // Up to kMaxPushConstantBytes from offset 0 of one layout and stage set.
+        void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t size, const void *data);
+
+        // Commands issued and skipped since construction (or reset()), for stats.
+        uint32_t issued() const { return m_issued; }
+        uint32_t skipped() const { return m_skipped; }
+        // Issued binds by kind (vertex and index buffers together), for RenderStats.
+        uint32_t pipelineBinds() const { return m_pipelineBinds; }
+        uint32_t descriptorBinds() const { return m_descriptorBinds; }
+        uint32_t bufferBinds() const { return m_bufferBinds; }
+
+        static constexpr uint32_t kMaxSets = 4;
+        static constexpr uint32_t kMaxDynamicOffsets = 4;
+        static constexpr uint32_t kMaxVertexBindings = 4;
+        static constexpr uint32_t kMaxPushConstantBytes = 128; // the guaranteed minimum maxPushConstantsSize
+
+    private:
+        struct BufferBinding
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+        };
+
+        VkCommandBuffer m_cmd = VK_NULL_HANDLE;
+        VkPipeline m_pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout m_setLayout = VK_NULL_HANDLE; // sets stay valid across compatible layouts only
+        VkDescriptorSet m_sets[kMaxSets] = {};
+        uint32_t m_dynamicOffsetCounts[kMaxSets] = {};
+        uint32_t m_dynamicOffsets[kMaxSets][kMaxDynamicOffsets] = {};
+        BufferBinding m_vertex[kMaxVertexBindings];
+        BufferBinding m_index;
+        VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+        VkPipelineLayout m_pushLayout = VK_NULL_HANDLE;
+        VkShaderStageFlags m_pushStages = 0;
+        uint32_t m_pushSize = 0;
+        uint8_t m_push[kMaxPushConstantBytes] = {};
+        uint32_t m_issued = 0;
+        uint32_t m_skipped = 0;
+        uint32_t m_pipelineBinds = 0;
+        uint32_t m_descriptorBinds = 0;
+        uint32_t m_bufferBinds = 0;
+    };
+
+} // namespace Engine
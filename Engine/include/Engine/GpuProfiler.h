@@ -0,0 +1,131 @@
+#pragma once
+/*
+  GpuProfiler.h
+  -------------
+  Purpose:
+    - GPU time of every RenderPassModule stage (compute, depth pre-pass, draws) and of the whole
+      frame from timestamp query pairs, and optionally how many vertex, fragment and compute shader
+      invocations each one ran (pipeline statistics queries).
+    - One query pool per frame slot. A slot's results are read when the slot comes round again,
+      after Renderer waited for its fence, so reading never stalls.
+
+  Usage:
+    - Renderer owns it: beginFrame(slot, cmd) right after beginning the slot's primary command buffer,
+      beginScope()/endScope() around each module's recording, endFrame(cmd) before ending it.
+    - getPassTimings() / getFrameMs(): the last frame whose results have been read (frames in flight
+      frames old).
+
+  Notes:
+    - Scopes may be recorded from several threads (parallel recording) into secondary command
+      buffers; each scope must begin and end in the same command buffer. Scopes with the same name
+      and stage (the slices of one pass) are merged: first start to last end, statistics summed.
+    - Timestamps are written at the top and bottom of the pipe, so a scope's time includes work of
+      earlier scopes still in flight when it starts; treat per-pass times as approximate.
+    - At most kMaxScopes scopes per frame; later ones are not measured.
+    - Pass and frame spans are also given on the Profiler::now() clock (trace captures). With
+      calibrated timestamps (VK_EXT_calibrated_timestamps) the mapping is exact; without, the GPU
+      frame is assumed to start when its recording ended on the CPU, so spans sit a little early.
+*/
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Engine
+{
+    class GpuProfiler
+    {
+    public:
+        struct PassTiming
+        {
+            const char *name = nullptr;  // RenderPassModule::name()
+            const char *stage = nullptr; // "compute", "depth", "draw"
+            float ms = 0.0f;
+            uint64_t startNs = 0; // Profiler::now() clock
+            uint64_t endNs = 0;
+            // Pipeline statistics mode only
+            uint64_t vertexInvocations = 0;
+            uint64_t fragmentInvocations = 0;
+            uint64_t computeInvocations = 0;
+        };
+
+        static constexpr uint32_t kMaxScopes = 64;
+        static constexpr uint32_t kNoScope = UINT32_MAX;
+
+        GpuProfiler() = default;
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler &) = delete;
+        GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+        // False (and stays invalid) when the device or 'queueFamily' has no timestamps.
+        // 'pipelineStatistics': the device enabled VkPhysicalDeviceFeatures::pipelineStatisticsQuery.
+        // 'calibratedTimestamps': VulkanContext::SupportsCalibratedTimestamps().
+        bool init(VkDevice device, VkPhysicalDevice phys, uint32_t queueFamily, uint32_t slotCount, bool pipelineStatistics,
+                  bool calibratedTimestamps);
+        void destroy();
+
+        bool isValid() const { return m_slotCount != 0; }
+
+        // Optional statistics queries (off by default); takes effect from the next beginFrame().
+        void setPipelineStatistics(bool enabled) { m_statisticsEnabled = enabled && m_statisticsSupported; }
+        bool pipelineStatisticsEnabled() const { return m_statisticsEnabled; }
+        bool pipelineStatisticsSupported() const { return m_statisticsSupported; }
+
+        // 'slot' must be done on the GPU. Reads its previous results, then resets its queries and
+        // writes the frame's start timestamp, outside any render pass.
+        void beginFrame(uint32_t slot, VkCommandBuffer cmd);
+        // The frame's end timestamp, outside any render pass.
+        void endFrame(VkCommandBuffer cmd);
+
+        // Thread safe. Returns kNoScope when invalid or out of scopes; endScope() ignores it.
+        uint32_t beginScope(VkCommandBuffer cmd, const char *name, const char *stage);
+        void endScope(VkCommandBuffer cmd, uint32_t scope);
+
+        float getFrameMs() const { return m_frameMs; }
+        // The same frame on the Profiler::now() clock; 0 before the first results.
+        uint64_t getFrameStartNs() const { return m_frameStartNs; }
+        uint64_t getFrameEndNs() const { return m_frameEndNs; }
+        bool timestampsCalibrated() const { return m_calibrate != nullptr; }
+        // In GPU start order.
+        const std::vector<PassTiming> &getPassTimings() const { return m_passTimings; }
+
+    private:
+        struct Slot
+        {
+            VkQueryPool timestamps = VK_NULL_HANDLE; // frame start, frame end, then a pair per scope
+            VkQueryPool statistics = VK_NULL_HANDLE; // one per scope
+            const char *names[kMaxScopes] = {};
+            const char *stages[kMaxScopes] = {};
+            std::atomic<uint32_t> used{0};
+            bool recorded = false;       // holds a submitted frame
+            bool withStatistics = false; // that frame ran the statistics queries
+            uint64_t recordedNs = 0;     // Profiler::now() at endFrame(), the uncalibrated anchor
+        };
+
+        void collect_Internal(Slot &slot);
+        // Device tick and Profiler::now() time of the same instant
+        bool calibrate_Internal(uint64_t &deviceTick, uint64_t &hostNs) const;
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        std::unique_ptr<Slot[]> m_slots;
+        uint32_t m_slotCount = 0;
+        Slot *m_current = nullptr;
+        float m_timestampPeriod = 1.0f; // nanoseconds per tick
+        uint64_t m_timestampMask = ~0ull;
+        bool m_statisticsSupported = false;
+        bool m_statisticsEnabled = false;
+        PFN_vkGetCalibratedTimestampsEXT m_calibrate = nullptr;
+        double m_hostTicksToNs = 1.0; // host time domain units
+
+        float m_frameMs = 0.0f;
+        uint64_t m_frameStartNs = 0;
+        uint64_t m_frameEndNs = 0;
+        std::vector<PassTiming> m_passTimings;
+        std::vector<uint64_t> m_timestampResults;
+        std::vector<uint64_t> m_statisticsResults;
+    };
+
+} // namespace Engine
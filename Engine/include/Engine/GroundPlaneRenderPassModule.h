@@ -5,10 +5,10 @@
 #include "assets/AssetManager.h"
 #include "assets/Handles.h"
 
-#include "Engine/Camera.h"
 #include "Engine/Pipeline.h"
 
 #include "utils/BufferUtils.h"
+#include "utils/MemoryAllocator.h"
 
 #include <glm/glm.hpp>
 
@@ -29,30 +29,27 @@ namespace Engine
 
         void setEnabled(bool enabled) { m_enabled = enabled; }
         void setAssets(AssetManager *assets) { m_assets = assets; }
-        void setCamera(Camera *camera) { m_camera = camera; }
         void setBaseColorTexture(TextureHandle tex) { m_baseColorTexture = tex; }
 
-        // Half-size (meters) of the quad around the camera.
+        // Half-size (meters) of the quad around the camera (GlobalUniforms::cameraPos).
         void setHalfSize(float halfSize) { m_halfSize = halfSize; }
 
         // World-space meters per one texture repeat.
         void setTileWorldSize(float metersPerRepeat) { m_tileWorldSize = metersPerRepeat; }
 
+        void setGlobalSetLayout(VkDescriptorSetLayout layout) override { m_globalSetLayout = layout; }
+        const char *name() const override { return "GroundPlaneRenderPassModule"; }
         void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
         void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
         void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
         void onDestroy(VulkanContext &ctx) override;
 
     private:
-        struct CameraUBO
-        {
-            glm::mat4 view{1.0f};
-            glm::mat4 proj{1.0f};
-        };
-
         struct PushConstants
         {
-            glm::mat4 model{1.0f};
+            // Matches smodel.vert model rows 0-2 and positionDequant (unused: full-float vertices)
+            glm::vec4 modelRows[3] = {glm::vec4(1.0f, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f), glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)};
+            glm::vec4 positionDequant{0.0f, 0.0f, 0.0f, 1.0f};
             glm::vec4 baseColorFactor{1.0f};
             glm::vec4 materialParams{0.0f}; // x=alphaCutoff, y=alphaMode
 
@@ -66,27 +63,10 @@ namespace Engine
         static_assert(sizeof(PushConstants) == 128, "GroundPlane PushConstants must match smodel.vert");
         static_assert(offsetof(PushConstants, nodeInfo) == 96, "GroundPlane PushConstants::nodeInfo offset must match smodel.vert");
 
-        struct CameraFrame
-        {
-            VkDescriptorSet set = VK_NULL_HANDLE;
-            VkBuffer buffer = VK_NULL_HANDLE;
-            VkDeviceMemory memory = VK_NULL_HANDLE;
-
-            VkBuffer paletteBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory paletteMemory = VK_NULL_HANDLE;
-            void *paletteMapped = nullptr;
-            uint32_t paletteCapacityMatrices = 0;
-
-            VkBuffer jointPaletteBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory jointPaletteMemory = VK_NULL_HANDLE;
-            void *jointPaletteMapped = nullptr;
-            uint32_t jointPaletteCapacityMatrices = 0;
-        };
-
         struct InstanceFrame
         {
             VkBuffer buffer = VK_NULL_HANDLE;
-            VkDeviceMemory memory = VK_NULL_HANDLE;
+            MemoryAllocation memory;
             void *mapped = nullptr;
         };
 
@@ -102,8 +82,8 @@ namespace Engine
         };
 
     private:
-        bool createCameraResources(VulkanContext &ctx, size_t frameCount);
-        void destroyCameraResources();
+        bool createPaletteResources(VulkanContext &ctx);
+        void destroyPaletteResources();
 
         bool createInstanceResources(VulkanContext &ctx, size_t frameCount);
         void destroyInstanceResources();
@@ -114,12 +94,11 @@ namespace Engine
         bool createGeometryResources(VulkanContext &ctx, size_t frameCount);
         void destroyGeometryResources();
 
-        void updatePlaneForFrame(uint32_t frameIndex);
+        void updatePlaneForFrame(uint32_t frameIndex, const GlobalUniforms *globals);
 
     private:
         bool m_enabled = true;
         AssetManager *m_assets = nullptr; // not owned
-        Camera *m_camera = nullptr;       // not owned
 
         TextureHandle m_baseColorTexture{};
 
@@ -130,12 +109,17 @@ namespace Engine
         VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
         VkExtent2D m_extent{};
 
-        // Camera descriptor set (set=0)
-        VkDescriptorSetLayout m_cameraSetLayout = VK_NULL_HANDLE;
-        VkDescriptorPool m_cameraPool = VK_NULL_HANDLE;
-        std::vector<CameraFrame> m_cameraFrames;
+        // Global descriptor set (set=0), Renderer-owned
+        VkDescriptorSetLayout m_globalSetLayout = VK_NULL_HANDLE;
+
+        // Palette descriptor set (set=1): static identity palettes
+        VkDescriptorSetLayout m_paletteSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_palettePool = VK_NULL_HANDLE;
+        VkDescriptorSet m_paletteSet = VK_NULL_HANDLE;
+        VkBuffer m_paletteBuffer = VK_NULL_HANDLE;
+        MemoryAllocation m_paletteMemory;
 
-        // Material descriptor set (set=1)
+        // Material descriptor set (set=2)
         VkDescriptorSetLayout m_materialSetLayout = VK_NULL_HANDLE;
         VkDescriptorPool m_materialPool = VK_NULL_HANDLE;
         std::vector<VkDescriptorSet> m_materialSets;
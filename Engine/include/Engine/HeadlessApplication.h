@@ -0,0 +1,98 @@
+#pragma once
+/*
+  HeadlessApplication.h
+  ---------------------
+  Purpose:
+    - Application for a dedicated server: one simulated world (ECS, job pool, frame arena, CPU
+      model data) driven by a fixed tick loop, with no window, Vulkan device or ImGui. Lives in
+      EngineCore, so a server links no graphics libraries (see ENGINE_HEADLESS_ONLY).
+
+  Usage:
+    - class Match : public Engine::HeadlessApplication { void OnStart() override; void OnTick(TimeStep) override; };
+    - Match m(config); m.Run();                  // on this thread, until Close() or config.maxTicks
+    - Match a(config), b(config); a.Start(); b.Start(); ... a.Close(); b.Close(); a.Join(); b.Join();
+
+  Notes:
+    - Every instance owns its world: many matches run side by side in one process, one thread each
+      (Start()), sharing only read-only model data (HeadlessAssets) and the log.
+    - OnStart, OnTick and OnStop run on the loop's thread; Close() and the counters are safe from
+      any thread. TimeStep::DeltaSeconds is always 1 / tickHz (simulation time, not wall time).
+    - If the loop falls several ticks behind it drops them instead of catching up in a burst
+      (lateTicks() counts ticks that started late); tickHz 0 ticks back to back at dt 1/30 s
+      (soak tests, bots).
+*/
+
+#include "Engine/TimeStep.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace Engine
+{
+    class FrameArena;
+    class HeadlessAssets;
+    class JobSystem;
+
+    namespace ECS
+    {
+        struct ECSContext;
+    }
+
+    struct HeadlessConfig
+    {
+        std::string name = "match";  // log prefix
+        float tickHz = 30.0f;        // fixed simulation rate; 0 = as fast as possible
+        uint32_t workerThreads = 0;  // job workers for this world (0 = jobs run inline on the tick thread)
+        uint64_t maxTicks = 0;       // stop after this many ticks; 0 = until Close()
+    };
+
+    class HeadlessApplication
+    {
+    public:
+        explicit HeadlessApplication(const HeadlessConfig &config = {});
+        virtual ~HeadlessApplication();
+
+        HeadlessApplication(const HeadlessApplication &) = delete;
+        HeadlessApplication &operator=(const HeadlessApplication &) = delete;
+
+        // Run the tick loop on the calling thread (blocks): OnStart, ticks, OnStop
+        void Run();
+
+        // Run() on a thread of its own; Join() waits for it. Close() and Join() a started instance
+        // before it is destroyed: the loop calls the derived class's overrides.
+        void Start();
+        void Join();
+
+        // Stop after the current tick; any thread
+        void Close();
+        bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+
+        virtual void OnStart() {}
+        virtual void OnTick(TimeStep) {}
+        virtual void OnStop() {}
+
+        const HeadlessConfig &GetConfig() const { return m_config; }
+        ECS::ECSContext &GetECS();
+        JobSystem &GetJobs();
+        FrameArena &GetFrameArena(); // reset before every OnTick
+        HeadlessAssets &GetAssets();
+
+        // Ticks completed, and ticks that started more than a tick late; any thread
+        uint64_t GetTick() const { return m_tick.load(std::memory_order_relaxed); }
+        uint64_t lateTicks() const { return m_lateTicks.load(std::memory_order_relaxed); }
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> m_Impl;
+        HeadlessConfig m_config;
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        std::atomic<bool> m_closeRequested{false};
+        std::atomic<uint64_t> m_tick{0};
+        std::atomic<uint64_t> m_lateTicks{0};
+    };
+
+} // namespace Engine
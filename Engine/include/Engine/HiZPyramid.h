@@ -0,0 +1,97 @@
+#pragma once
+/*
+  HiZPyramid.h
+  ------------
+  Purpose:
+    - Hierarchical-Z pyramid of the depth pre-pass (Renderer::setDepthPrepass()) for occlusion
+      culling: an R32_SFLOAT image whose level 0 is half the depth resolution and whose every texel
+      holds the farthest depth of the 2x2 texels under it (3 wide along an odd edge), down to 1x1
+      (shaders/hiz_build.comp).
+    - A sphere whose nearest projected depth is behind the farthest depth of the pyramid texels
+      covering its screen rectangle is hidden (SModelRenderPassModule, shaders/smodel_cull.comp).
+
+  Usage:
+    - Renderer owns the pyramid and build()s it after the depth pre-pass; passes get it through
+      FrameContext::hiZ. When recordCompute() reads it, it still holds the previous frame's depth, so
+      a pass tests against the view-projection it drew its previous pre-pass with.
+    - Pixel p of the depth image is covered by texel min(p >> (level + 1), level size - 1).
+
+  Notes:
+    - The image is used in VK_IMAGE_LAYOUT_GENERAL. build() only orders its levels against each
+      other: Renderer declares the build in its render graph (depth read sampled, pyramid written) and
+      passes declare their reads of getImage(), so the graph places the layout transition and the
+      barriers around it.
+    - getBuildCount() tells passes whether the pyramid holds the pre-pass they drew last: it counts
+      builds since init().
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include "utils/MemoryAllocator.h"
+
+namespace Engine
+{
+    class HiZPyramid
+    {
+    public:
+        HiZPyramid() = default;
+        ~HiZPyramid();
+
+        HiZPyramid(const HiZPyramid &) = delete;
+        HiZPyramid &operator=(const HiZPyramid &) = delete;
+
+        // depthViews: a depth-aspect view of every swapchain depth image, in 'depthLayout' when build()
+        // reads it. Returns false (and stays invalid) without shaders/hiz_build.comp.spv.
+        bool init(VkDevice device, VkPhysicalDevice phys, VkExtent2D depthExtent,
+                  const std::vector<VkImageView> &depthViews, VkImageLayout depthLayout);
+        void destroy();
+
+        bool isValid() const { return m_pipeline != VK_NULL_HANDLE; }
+
+        // Records the reduction of depth image 'imageIndex', outside any render pass (see Notes).
+        void build(VkCommandBuffer cmd, uint32_t imageIndex);
+
+        // Every level, for texelFetch(); sampled in VK_IMAGE_LAYOUT_GENERAL.
+        VkImage getImage() const { return m_image; }
+        VkImageView getView() const { return m_view; }
+        VkSampler getSampler() const { return m_sampler; }
+        VkImageLayout getLayout() const { return VK_IMAGE_LAYOUT_GENERAL; }
+
+        VkExtent2D getDepthExtent() const { return m_depthExtent; }
+        uint32_t getMipCount() const { return m_mipCount; }
+        uint64_t getBuildCount() const { return m_buildCount; }
+
+    private:
+        // hiz_build.comp Params.
+        struct PushConstants
+        {
+            int32_t srcSize[2];
+            int32_t dstSize[2];
+        };
+
+        static constexpr uint32_t kGroupSize = 8; // hiz_build.comp local_size_x/y
+
+        VkExtent2D levelExtent(uint32_t level) const;
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkExtent2D m_depthExtent{};
+        uint32_t m_mipCount = 0;
+        uint32_t m_depthViewCount = 0;
+        uint64_t m_buildCount = 0;
+
+        VkImage m_image = VK_NULL_HANDLE;
+        MemoryAllocation m_memory;
+        VkImageView m_view = VK_NULL_HANDLE;
+        std::vector<VkImageView> m_levelViews;
+        VkSampler m_sampler = VK_NULL_HANDLE;
+
+        VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        // [depth image] reduce into level 0, then [depthViewCount + level - 1] reduce level - 1 into level
+        std::vector<VkDescriptorSet> m_sets;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_pipeline = VK_NULL_HANDLE;
+    };
+
+} // namespace Engine
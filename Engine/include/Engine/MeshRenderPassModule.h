@@ -25,6 +25,7 @@ namespace Engine
 
         void setMesh(const MeshBinding &binding);
 
+        const char *name() const override { return "MeshRenderPassModule"; }
         void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
         void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
         void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
@@ -4,18 +4,26 @@
 #include <deque>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#include "utils/TraceCapture.h"
 
 namespace Engine
 {
     class Window;
     class Renderer;
     class VulkanContext;
+    struct HitchDetectorConfig;
 
     /**
      * @brief Performance monitoring system that tracks and displays real-time metrics.
      * 
-     * Collects FPS, frame times, draw calls, and system information.
-     * Renders an ImGui-based overlay when enabled.
+     * Collects FPS, frame times, render statistics (RenderStats, per pass and model), memory (GPU
+     * by category and heap budget, CPU by MemoryTracker category, each with its peak) and system
+     * information.
+     * Renders an ImGui-based overlay when enabled, with a timeline of the last frame's
+     * Profiler scopes; the profiler only records while the overlay is visible, a trace capture
+     * runs or the hitch detector is enabled.
      */
     class PerformanceMonitor
     {
@@ -51,30 +59,32 @@ namespace Engine
         void endFrame();
 
         /**
-         * @brief Record a draw call. Call each time vkCmdDraw* is invoked.
-         * @param primitiveCount Number of primitives in this draw call
+         * @brief Toggle the overlay visibility.
          */
-        void recordDrawCall(uint32_t primitiveCount = 0);
+        void toggle();
 
         /**
-         * @brief Reset draw call counter. Called at frame start.
+         * @brief Check if overlay is visible.
          */
-        void resetDrawCalls();
+        bool isVisible() const { return m_visible; }
 
         /**
-         * @brief Toggle the overlay visibility.
+         * @brief Set overlay visibility. Also switches Profiler scopes on or off.
          */
-        void toggle();
+        void setVisible(bool visible);
 
         /**
-         * @brief Check if overlay is visible.
+         * @brief Record the next 'frames' frames into a Chrome trace JSON file (see TraceCapture).
+         * Profiler scopes stay on until the file is written. False when a capture is already running.
          */
-        bool isVisible() const { return m_visible; }
+        bool startTraceCapture(const std::string &path, uint32_t frames);
 
         /**
-         * @brief Set overlay visibility.
+         * @brief Dump the last frames to disk whenever one exceeds a multiple of the median (see
+         * HitchDetector). Keeps Profiler scopes on until disabled.
          */
-        void setVisible(bool visible) { m_visible = visible; }
+        void enableHitchDetector(const HitchDetectorConfig &config);
+        void disableHitchDetector();
 
         /**
          * @brief Render the ImGui overlay. Call during UI rendering phase.
@@ -87,13 +97,18 @@ namespace Engine
         float get01PercentLowFPS() const { return m_01percentLowFPS; }
         float getFrameTimeMs() const { return m_frameTimeMs; }
         float getCPUTimeMs() const { return m_cpuTimeMs; }
-        uint32_t getDrawCallCount() const { return m_drawCallCount; }
+        uint32_t getDrawCallCount() const; // last frame, RenderStats::lastFrame() for the rest
         uint32_t getResolutionWidth() const;
         uint32_t getResolutionHeight() const;
 
     private:
         void updateMetrics();
         void calculatePercentileFPS();
+        void renderProfilerWindow();
+        void collectGpuSpans();
+        void recordTraceFrame();
+        void recordHitchFrame(float frameTimeMs);
+        void updateProfilerEnabled();
 
     private:
         // References to engine systems
@@ -104,6 +119,10 @@ namespace Engine
         // Visibility toggle
         bool m_visible = false;
         bool m_initialized = false;
+        bool m_profilerEnabledBeforeTrace = false; // restored when a trace capture ends
+
+        // Latest GPU frame for TraceCapture and HitchDetector, rebuilt by collectGpuSpans()
+        std::vector<TraceCapture::GpuSpan> m_gpuSpans;
 
         // Timing
         using Clock = std::chrono::high_resolution_clock;
@@ -122,8 +141,8 @@ namespace Engine
         float m_01percentLowFPS = 0.0f;
         float m_frameTimeMs = 0.0f;
         float m_cpuTimeMs = 0.0f;
-        float m_gpuTimeMs = 0.0f;  // Placeholder - requires GPU timestamp queries
-        float m_gpuUsagePercent = 0.0f; // Placeholder - requires vendor-specific queries
+        float m_gpuTimeMs = 0.0f;  // Renderer::getGpuTimeMs(), frames in flight frames old
+        float m_gpuUsagePercent = 0.0f; // GPU time over frame time
 
         // Smoothed display values (EMA filtered for readability)
         float m_smoothedFrameTimeMs = 0.0f;
@@ -133,26 +152,9 @@ namespace Engine
         // EMA smoothing factor: 0.1 = very smooth (slow response), 0.3 = moderate, 0.5 = responsive
         static constexpr float EMA_SMOOTHING_FACTOR = 0.15f;
 
-        // Draw call tracking
-        uint32_t m_drawCallCount = 0;
-        uint32_t m_lastFrameDrawCalls = 0;
-        uint32_t m_primitiveCount = 0;
-
         // Metrics update interval
         float m_updateTimer = 0.0f;
         static constexpr float UPDATE_INTERVAL = 0.1f; // Update every 100ms
     };
 
-    /**
-     * @brief Global draw call counter - increment from render modules.
-     * Thread-safe atomic counter reset each frame.
-     */
-    class DrawCallCounter
-    {
-    public:
-        static void increment(uint32_t count = 1);
-        static void reset();
-        static uint32_t get();
-    };
-
 } // namespace Engine
@@ -53,10 +53,32 @@ namespace Engine
     std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
     std::vector<VkPushConstantRange> pushConstantRanges;
 
-    // Optional pipeline cache to accelerate creation (VK_NULL_HANDLE ok)
+    // Optional pipeline cache to accelerate creation (VK_NULL_HANDLE: the device's PipelineCache)
     VkPipelineCache pipelineCache = VK_NULL_HANDLE;
   };
 
+  // Specialization constants of one shader stage, by constant_id: the values that select a shader
+  // variant. Values are 32-bit (bool constants VkBool32). The constants are part of a pipeline's
+  // PipelineCache key, so each variant is compiled once per device and shared.
+  //
+  //   SpecializationConstants spec;
+  //   spec.setBool(0, compact).setBool(1, skinned);
+  //   stage.pSpecializationInfo = spec.info(); // valid while 'spec' lives and is not changed
+  class SpecializationConstants
+  {
+  public:
+    SpecializationConstants &set(uint32_t constantId, uint32_t value);
+    SpecializationConstants &setBool(uint32_t constantId, bool value) { return set(constantId, value ? VK_TRUE : VK_FALSE); }
+
+    // nullptr without constants.
+    const VkSpecializationInfo *info() const;
+
+  private:
+    std::vector<VkSpecializationMapEntry> m_entries;
+    std::vector<uint32_t> m_data;
+    mutable VkSpecializationInfo m_info{};
+  };
+
   class Pipeline
   {
   public:
@@ -68,7 +90,8 @@ namespace Engine
     Pipeline &operator=(const Pipeline &) = delete;
 
     // Create graphics pipeline according to the provided createInfo.
-    // Returns VK_SUCCESS on success and sets m_pipeline / m_layout.
+    // Returns VK_SUCCESS on success and sets m_pipeline / m_layout. A live pipeline built from an
+    // identical description is shared instead (PipelineCache); destroy() releases it.
     VkResult create(const PipelineCreateInfo &info);
 
     // Destroy pipeline and optionally destroy the layout if it was created by this wrapper.
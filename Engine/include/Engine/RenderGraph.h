@@ -0,0 +1,291 @@
+#pragma once
+/*
+  RenderGraph.h
+  -------------
+  Purpose:
+    - Per-frame pass graph: passes declare the images and buffers they read and write, the graph
+      orders them by declaration, culls passes whose results nobody reads, places the pipeline
+      barriers (and image layout transitions) between them, and backs transient images with
+      memory shared by images whose lifetimes do not overlap.
+    - Compute passes that only touch buffers and do not depend on this frame's graphics passes can
+      be recorded into a second command buffer for an async compute queue.
+
+  Usage:
+    - Renderer owns one graph and rebuilds it every frame in drawFrame():
+        graph.beginFrame();
+        RenderGraph::Handle depth = graph.importImage("depth", image, view, aspect, 1, layout);
+        graph.addPass("main", RenderGraph::Queue::Graphics,
+                      [&](RenderGraph::PassBuilder &b) { b.write(depth, RenderGraph::Access::DepthAttachment); },
+                      [&](VkCommandBuffer cmd) { ... });
+        graph.compile();
+        graph.execute(cmd);
+    - Modules take part through RenderPassModule::declareCompute()/declareDraws()/setupGraph().
+    - Importing the same VkImage/VkBuffer twice in a frame returns the same handle, so passes of
+      different modules meet on a buffer without passing handles around.
+
+  Notes:
+    - Buffer hazards are resolved with one global VkMemoryBarrier per pass (cheaper than per-buffer
+      barriers on every driver we run on); images get VkImageMemoryBarriers over all their mips.
+    - Imported resources keep their last access across frames, so the first pass of a frame waits
+      for the previous frame's last use (same queue). reset() forgets that state; call it after
+      vkDeviceWaitIdle() when imported resources are recreated (swapchain rebuilds).
+    - Transient images live for one frame: their contents are undefined at their first access.
+      Memory is reallocated only when the frame's transient set changes, after vkDeviceWaitIdle().
+    - Async passes run async only after setAsyncCompute(true); otherwise (the default) every pass
+      runs on the graphics queue. When hasAsyncWork(), execute() needs the async command buffer, which
+      must be submitted before the graphics one; the graphics submission waits on it at
+      getAsyncWaitStages() and the async submission waits for the previous frame's graphics one.
+      Buffers shared across queue families must be VK_SHARING_MODE_CONCURRENT.
+    - Not thread safe: build, compile and execute from the render thread. Pass callbacks may record
+      into secondary command buffers of their own.
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "utils/MemoryAllocator.h"
+
+namespace Engine
+{
+    class RenderGraph
+    {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle kInvalid = 0xFFFFFFFFu;
+
+        enum class Queue : uint8_t
+        {
+            Graphics = 0,
+            AsyncCompute = 1 // falls back to Graphics when the pass cannot run async
+        };
+
+        // How a pass uses a resource; each maps to pipeline stages, access flags and (for images) a layout.
+        enum class Access : uint8_t
+        {
+            IndirectRead = 0,   // vkCmdDraw*Indirect arguments
+            VertexRead,         // vertex / instance attributes
+            IndexRead,
+            UniformRead,        // uniform blocks, any shader stage
+            VertexShaderRead,   // storage buffers read by vertex shaders (palettes)
+            MeshShaderRead,     // storage buffers read by task/mesh shaders (VK_EXT_mesh_shader)
+            FragmentSampled,    // sampled in fragment shaders
+            ComputeRead,        // storage buffer / storage image / texelFetch reads (GENERAL for images)
+            ComputeWrite,
+            ComputeReadWrite,
+            ComputeSampled,     // sampled in compute shaders (read-only layout)
+            TransferRead,
+            TransferWrite,
+            ColorAttachment,
+            DepthAttachment,    // depth test and write
+            DepthRead           // depth test without writes, read-only layout
+        };
+
+        struct ImageDesc
+        {
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent{};
+            uint32_t mipLevels = 1;
+            VkImageUsageFlags usage = 0;
+            VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        };
+
+        struct Stats
+        {
+            uint32_t passes = 0;        // declared this frame
+            uint32_t culledPasses = 0;
+            uint32_t asyncPasses = 0;
+            uint32_t barrierBatches = 0; // vkCmdPipelineBarrier calls
+            uint32_t imageBarriers = 0;
+            uint32_t memoryBarriers = 0;
+            uint32_t transientImages = 0;
+            uint32_t transientSlots = 0; // memory blocks behind them
+            VkDeviceSize transientBytes = 0;
+            VkDeviceSize aliasedBytes = 0; // saved by aliasing
+        };
+
+        class PassBuilder
+        {
+        public:
+            void read(Handle resource, Access access);
+            // discard: the previous contents are not needed (image layout goes from UNDEFINED).
+            void write(Handle resource, Access access, bool discard = false);
+            // Keep the pass even if nothing it writes is read (presents, readbacks, legacy passes).
+            void sideEffect();
+
+        private:
+            friend class RenderGraph;
+            PassBuilder(RenderGraph &graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+            RenderGraph &m_graph;
+            uint32_t m_pass;
+        };
+
+        using SetupFn = std::function<void(PassBuilder &)>;
+        using ExecuteFn = std::function<void(VkCommandBuffer)>;
+
+        RenderGraph() = default;
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph &) = delete;
+        RenderGraph &operator=(const RenderGraph &) = delete;
+
+        void init(VkDevice device);
+        void destroy();
+        // Forgets imported resource state (and the transient memory); GPU must be idle.
+        void reset();
+
+        void setAsyncCompute(bool enabled) { m_asyncEnabled = enabled; }
+
+        void beginFrame();
+
+        // 'layout': the image's layout before the first pass that touches it, the first time it is imported.
+        Handle importImage(const char *name, VkImage image, VkImageView view, VkImageAspectFlags aspect,
+                           uint32_t mipLevels, VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+        Handle importBuffer(const char *name, VkBuffer buffer);
+        Handle createImage(const char *name, const ImageDesc &desc);
+
+        // 'setup' runs immediately; 'execute' runs from execute() if the pass survives culling.
+        void addPass(const char *name, Queue queue, const SetupFn &setup, ExecuteFn execute);
+
+        // Culls, assigns queues, plans barriers and realizes transient images.
+        void compile();
+        // Records every surviving pass in declaration order. asyncCmd: see Notes.
+        void execute(VkCommandBuffer cmd, VkCommandBuffer asyncCmd = VK_NULL_HANDLE);
+
+        bool hasAsyncWork() const { return m_stats.asyncPasses > 0; }
+        VkPipelineStageFlags getAsyncWaitStages() const { return m_asyncWaitStages; }
+
+        // Valid after compile() (transients) or import.
+        VkImage getImage(Handle image) const;
+        VkImageView getImageView(Handle image) const;
+
+        // Passes that survived compile(), in execution order (graphics and async interleaved).
+        uint32_t getPassCount() const { return static_cast<uint32_t>(m_order.size()); }
+        const char *getPassName(uint32_t index) const { return m_passes[m_order[index]].name; }
+
+        const Stats &getStats() const { return m_stats; }
+
+    private:
+        enum class Kind : uint8_t
+        {
+            ImportedImage,
+            ImportedBuffer,
+            TransientImage
+        };
+
+        // Last access of a resource, as the barrier planner sees it.
+        struct State
+        {
+            VkPipelineStageFlags writeStages = 0; // stages of the last write not yet waited for by everyone
+            VkAccessFlags writeAccess = 0;
+            VkPipelineStageFlags readStages = 0;  // reads since the last write
+            VkAccessFlags visibleAccess = 0;      // accesses the last write was made visible to
+            VkPipelineStageFlags visibleStages = 0;
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            Queue queue = Queue::Graphics;
+        };
+
+        struct Resource
+        {
+            const char *name = nullptr;
+            Kind kind = Kind::ImportedBuffer;
+            uint64_t key = 0; // imported: the Vulkan handle
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkImageAspectFlags aspect = 0;
+            uint32_t mipLevels = 1;
+            ImageDesc desc;        // transients
+            uint32_t transient = 0; // index into m_transients
+            uint32_t firstUse = 0, lastUse = 0; // positions in m_order
+            bool used = false;
+            State state;
+        };
+
+        struct Use
+        {
+            Handle resource;
+            Access access;
+            bool write;
+            bool discard;
+        };
+
+        struct Barriers
+        {
+            VkPipelineStageFlags srcStages = 0;
+            VkPipelineStageFlags dstStages = 0;
+            VkMemoryBarrier memory{};
+            std::vector<VkImageMemoryBarrier> images;
+        };
+
+        struct Pass
+        {
+            const char *name = nullptr;
+            Queue queue = Queue::Graphics;
+            ExecuteFn execute;
+            std::vector<Use> uses;
+            bool sideEffect = false;
+            bool alive = false;
+            Barriers barriers;
+        };
+
+        struct Transient
+        {
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+            uint32_t slot = 0;
+        };
+
+        struct TransientSlot
+        {
+            MemoryAllocation memory;
+            // Last access of the slot's last occupant, which the next occupant's first access waits for.
+            VkPipelineStageFlags lastStages = 0;
+            VkAccessFlags lastWriteAccess = 0;
+        };
+
+        struct ImportState
+        {
+            State state;
+            uint64_t frame = 0; // last frame the resource was imported in
+        };
+
+        struct AccessInfo
+        {
+            VkPipelineStageFlags stages;
+            VkAccessFlags access;
+            bool write;
+        };
+
+        static AccessInfo Info(Access access);
+        static VkImageLayout LayoutFor(Access access, VkImageAspectFlags aspect);
+
+        void addUse(uint32_t pass, Handle resource, Access access, bool write, bool discard);
+        void cull();
+        void assignQueues();
+        void realizeTransients();
+        void destroyTransients();
+        void retireTransients(); // destroyTransients() through the DeletionQueue
+        void planBarriers();
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        bool m_asyncEnabled = false;
+        uint64_t m_frame = 0;
+
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+        std::vector<uint32_t> m_order; // alive passes
+        std::unordered_map<uint64_t, Handle> m_importIndex; // this frame's imports by Vulkan handle
+        std::unordered_map<uint64_t, ImportState> m_importState; // across frames
+
+        std::vector<Transient> m_transients;
+        std::vector<TransientSlot> m_slots;
+        std::vector<uint64_t> m_transientSignature; // of the set m_transients was realized for
+        std::vector<uint64_t> m_signature;
+
+        VkPipelineStageFlags m_asyncWaitStages = 0;
+        Stats m_stats;
+    };
+
+} // namespace Engine
@@ -0,0 +1,79 @@
+#pragma once
+/*
+  RenderStats.h
+  -------------
+  Purpose:
+    - Per-frame render statistics by RenderPassModule and by model: draw calls, instances,
+      triangles submitted and left after culling, pipeline, descriptor set and vertex/index buffer
+      binds, and bytes written for the GPU into instance and palette buffers.
+
+  Usage:
+    - RenderCounters c; ... ++c.drawCalls; c.triangles += ...;   // locally, while recording
+    - RenderStats::addPass(name(), c);                          // any thread, once per command sequence
+    - RenderStats::addModel(key, path, c);                       // the share of one model
+    - PerformanceMonitor calls beginFrame()/endFrame(); read lastFrame() on the main thread after.
+
+  Notes:
+    - Adds take a lock: accumulate per command sequence (or slice) and add once.
+    - Pass names are kept by pointer (RenderPassModule::name() literals); model names are copied.
+    - Binds count draw state (graphics bind point) as recorded, after DrawStateCache dropped the
+      redundant ones; compute passes only report their uploads.
+    - Draws culled on the GPU report visibleTriangles when the CPU reads their counts back, frames
+      in flight frames later, so those land in a later frame than the rest of their counters.
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    struct RenderCounters
+    {
+        uint32_t drawCalls = 0;
+        uint64_t instances = 0;
+        uint64_t triangles = 0;        // submitted: triangles per instance times instances drawn
+        uint64_t visibleTriangles = 0; // after culling (CPU culled draws: as submitted)
+        uint32_t pipelineBinds = 0;
+        uint32_t descriptorBinds = 0;
+        uint32_t bufferBinds = 0;      // vertex and index buffers
+        uint64_t uploadBytes = 0;      // instance and palette data written from the CPU
+
+        RenderCounters &operator+=(const RenderCounters &o);
+        bool empty() const;
+    };
+
+    class RenderStats
+    {
+    public:
+        struct PassStats
+        {
+            const char *name = nullptr;
+            RenderCounters counters;
+        };
+
+        struct ModelStats
+        {
+            uint64_t key = 0;  // (generation << 32) | id of the ModelHandle
+            std::string name;  // source path
+            RenderCounters counters;
+        };
+
+        struct Frame
+        {
+            std::vector<PassStats> passes; // in order of first add
+            std::vector<ModelStats> models; // by triangles submitted, most first
+            RenderCounters total;           // of the passes
+        };
+
+        static void beginFrame();
+        // Publishes the frame since beginFrame() as lastFrame().
+        static void endFrame();
+
+        static void addPass(const char *pass, const RenderCounters &counters);
+        static void addModel(uint64_t key, const std::string &name, const RenderCounters &counters);
+
+        static const Frame &lastFrame();
+    };
+
+} // namespace Engine
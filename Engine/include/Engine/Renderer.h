@@ -4,16 +4,48 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <chrono>
+#include <cstdint>
 #include "Structs/FrameContextStruct.h"
+#include "utils/MemoryAllocator.h"
+#include "Engine/GpuProfiler.h"
+#include "Engine/UploadRing.h"
+#include "Engine/HiZPyramid.h"
+#include "Engine/RenderGraph.h"
 
 namespace Engine
 {
     class VulkanContext;
     class SwapChain;
     class RenderPassModule;
+    class JobSystem;
+    class Camera;
+
+    // Binding 0 of the global descriptor set (set 0 of every pass, Renderer::getGlobalSetLayout()),
+    // a std140 uniform block written once per frame. Shaders declare it as "Matches Engine::GlobalUniforms".
+    struct GlobalUniforms
+    {
+        float view[16]; // column-major, like glm
+        float proj[16]; // Vulkan clip space (Y down)
+        float viewProj[16];
+        float cameraPos[4]; // xyz: world position
+        float time[4];      // x: seconds since init(), y: seconds since the previous frame
+        uint32_t frame[4];  // x: frames drawn, y: frame slot, z/w: extent
+    };
+    static_assert(sizeof(GlobalUniforms) == 240, "GlobalUniforms must match the shaders' Globals block");
+
     // Renderer: owns the main on-screen VkRenderPass, per-swapchain VkFramebuffer objects,
     // and per-frame command pools/buffers and synchronization objects. It calls registered
-    // RenderPassModule::record() while the main render pass is active.
+    // RenderPassModule::record() while the main render pass is active. RenderPassModule::recordCompute()
+    // runs first, outside the render pass, for compute work the draws depend on. With the depth
+    // pre-pass (setDepthPrepass()), RenderPassModule::recordDepthPrepass() then fills the depth buffer
+    // before the main render pass, which keeps it, and the depth is reduced into a Hi-Z pyramid.
+    // Camera and frame constants live in one Renderer-owned descriptor set (set 0 of every pass,
+    // FrameContext::globalSet), written once per frame.
+    // Every frame these passes go through a RenderGraph (getRenderGraph()), which places the barriers
+    // between them from what the modules declare (RenderPassModule::declareCompute()/declareDraws()).
+    // With a JobSystem (setJobSystem()) the passes record in parallel into secondary command buffers,
+    // executed in registration order.
 
     class Renderer
     {
@@ -50,7 +82,89 @@ namespace Engine
         void setImGuiRenderCallback(ImGuiRenderCallback callback) { m_imguiRenderCallback = callback; }
 
         // Get the last measured GPU frame time in milliseconds
-        float getGpuTimeMs() const { return m_gpuTimeMs; }
+        float getGpuTimeMs() const { return m_gpuProfiler.getFrameMs(); }
+
+        // GPU time of every module's compute, depth pre-pass and draw recording (named by
+        // RenderPassModule::name()) in the last measured frame, read without stalling frames in flight
+        // frames later. Empty without timestamp support.
+        const std::vector<GpuProfiler::PassTiming> &getGpuPassTimings() const { return m_gpuProfiler.getPassTimings(); }
+        // That frame on the Profiler::now() clock, for traces
+        uint64_t getGpuFrameStartNs() const { return m_gpuProfiler.getFrameStartNs(); }
+        uint64_t getGpuFrameEndNs() const { return m_gpuProfiler.getFrameEndNs(); }
+
+        // Vertex, fragment and compute shader invocations per pass in getGpuPassTimings() (off by
+        // default). Needs VulkanContext::SupportsPipelineStatistics().
+        void setPipelineStatistics(bool enabled);
+        bool pipelineStatisticsEnabled() const { return m_gpuProfiler.pipelineStatisticsEnabled(); }
+        bool pipelineStatisticsSupported() const { return m_gpuProfiler.pipelineStatisticsSupported(); }
+
+        // Frame pacing. Frames in flight is how many submitted frames the CPU may run ahead of the GPU,
+        // 1 to the constructor's maxFramesInFlight (the slots are allocated once; this only limits how
+        // many are in use, so it can change at any time): fewer frames means less input latency, more
+        // means more CPU/GPU overlap. Defaults to all slots.
+        void setFramesInFlight(uint32_t frames);
+        uint32_t getFramesInFlight() const { return m_framesInFlight; }
+        uint32_t getMaxFramesInFlight() const { return m_maxFrames; }
+
+        // Low-latency mode (off by default). waitForFrame() then also waits until all but
+        // getFramesInFlight() - 1 presented frames are on screen (VK_KHR_present_wait, when
+        // VulkanContext::SupportsPresentWait()) and sleeps so that the next frame's CPU and GPU work end
+        // just before the next display interval instead of queueing behind it. Pair it with FIFO
+        // (SwapChain::SetPreferredPresentMode()) and 1 frame in flight for the shortest latency.
+        void setLowLatency(bool enabled) { m_lowLatency = enabled; }
+        bool lowLatencyEnabled() const { return m_lowLatency; }
+        bool presentWaitSupported() const { return m_presentWaitSupported; }
+
+        // The pacing point of a frame, called before sampling input and simulating the frame the next
+        // drawFrame() draws (Application::Run() does). Waits for a frame slot under the frames-in-flight
+        // limit, plus the low-latency wait and sleep; when it returns is the frame's input time.
+        void waitForFrame();
+
+        // Input-to-photon estimate (milliseconds, smoothed) from waitForFrame() to the frame on screen.
+        // Measured with present waits when the low-latency mode has them (inputLatencyFromPresent()),
+        // else input to the GPU finishing the frame, as seen by the next waitForFrame() calls, plus one
+        // display interval for the present queue and scanout. 0 until a frame has been measured.
+        float getInputLatencyMs() const { return m_inputLatencyMs; }
+        bool inputLatencyFromPresent() const { return m_latencyFromPresent; }
+        // The low-latency sleep of the last waitForFrame() and the display interval it paces to.
+        float getPacingSleepMs() const { return m_pacingSleepMs; }
+        float getDisplayIntervalMs() const { return m_displayIntervalMs; }
+
+        // Record the main render pass on 'jobs' (nullptr, the default: inline into the primary command
+        // buffer). Every pass, or every slice of a pass that splits its draws (RenderPassModule::
+        // prepareRecord()), and the ImGui callback record a secondary command buffer from a pool of the
+        // recording thread. drawFrame() waits for the jobs, so the thread calling it must be the one
+        // that waits on 'jobs' (JobSystem thread 0). Change it between frames only.
+        void setJobSystem(JobSystem *jobs) { m_jobs = jobs; }
+        JobSystem *getJobSystem() const { return m_jobs; }
+
+        // Depth-only pre-pass before the main render pass (off by default): modules draw their opaque
+        // geometry into it (RenderPassModule::recordDepthPrepass()), the main render pass loads that
+        // depth instead of clearing it, and when the depth format can be sampled the depth is reduced
+        // into a HiZPyramid that passes read through FrameContext::hiZ for occlusion culling.
+        // Rebuilds the swapchain-dependent resources (and the passes' pipelines) when changed after
+        // init().
+        void setDepthPrepass(bool enabled);
+        bool depthPrepassEnabled() const { return m_depthPrepass; }
+        VkRenderPass getDepthPrepassRenderPass() const { return m_depthPrepassRenderPass; }
+        const HiZPyramid &getHiZPyramid() const { return m_hiZ; }
+
+        // Per-frame upload memory, one slot per frame in flight; passes get it through
+        // FrameContext::uploadRing while the frame records.
+        UploadRing &getUploadRing() { return m_uploadRing; }
+        const UploadRing &getUploadRing() const { return m_uploadRing; }
+
+        // The graph of the last frame (pass names and order, barrier and transient statistics).
+        const RenderGraph &getRenderGraph() const { return m_graph; }
+
+        // Camera of the global set; drawFrame() sets its aspect to the swapchain's. nullptr (the
+        // default): a fixed view of the origin.
+        void setCamera(Camera *camera) { m_camera = camera; }
+        Camera *getCamera() const { return m_camera; }
+
+        // Set 0 of every pass's pipeline layout (RenderPassModule::setGlobalSetLayout()): binding 0,
+        // the GlobalUniforms uniform block, vertex, fragment and compute stages. Created by init().
+        VkDescriptorSetLayout getGlobalSetLayout() const { return m_globalSetLayout; }
 
     private:
         VulkanContext *m_ctx = nullptr;
@@ -71,11 +185,38 @@ namespace Engine
         // Depth attachment resources (one per swapchain image)
         VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
         std::vector<VkImage> m_depthImages;
-        std::vector<VkDeviceMemory> m_depthMemories;
+        std::vector<MemoryAllocation> m_depthMemories;
         std::vector<VkImageView> m_depthImageViews;
 
+        // Depth pre-pass (setDepthPrepass()): a depth-only render pass and framebuffers over the same
+        // depth images, depth-aspect views of them for the Hi-Z build, and the pyramid.
+        bool m_depthPrepass = false;
+        bool m_depthSampled = false; // the depth format supports sampling: the pyramid is built
+        VkRenderPass m_depthPrepassRenderPass = VK_NULL_HANDLE;
+        std::vector<VkFramebuffer> m_depthPrepassFramebuffers;
+        std::vector<VkImageView> m_depthSampledViews;
+        HiZPyramid m_hiZ;
+
         std::vector<FrameContext> m_frames;
         uint32_t m_currentFrame = 0;
+        UploadRing m_uploadRing;
+        RenderGraph m_graph;
+
+        // Global set: one host-visible uniform buffer and descriptor set per frame slot.
+        struct GlobalFrame
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            MemoryAllocation memory;
+            VkDescriptorSet set = VK_NULL_HANDLE;
+        };
+        Camera *m_camera = nullptr; // not owned
+        VkDescriptorSetLayout m_globalSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_globalPool = VK_NULL_HANDLE;
+        std::vector<GlobalFrame> m_globalFrames;
+        GlobalUniforms m_globals{};
+        uint64_t m_framesDrawn = 0;
+        std::chrono::steady_clock::time_point m_startTime{};
+        std::chrono::steady_clock::time_point m_lastFrameTime{};
 
         // Registered render-pass modules that will record into the main render pass.
         std::vector<std::shared_ptr<RenderPassModule>> m_passes;
@@ -83,11 +224,56 @@ namespace Engine
         // Optional ImGui render callback
         ImGuiRenderCallback m_imguiRenderCallback;
 
-        // GPU timestamp query support
-        VkQueryPool m_timestampQueryPool = VK_NULL_HANDLE;
-        float m_timestampPeriod = 1.0f;  // Nanoseconds per timestamp tick
-        float m_gpuTimeMs = 0.0f;        // Last measured GPU time in milliseconds
-        bool m_timestampsSupported = false;
+        // Parallel recording (setJobSystem()): secondary command buffers of one recording thread in one
+        // frame slot. The pool is reset when the slot comes round again; its buffers are reused.
+        struct SecondaryPool
+        {
+            VkCommandPool pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> buffers;
+            uint32_t used = 0;
+        };
+        struct RecordTask
+        {
+            RenderPassModule *pass = nullptr; // nullptr: the ImGui callback
+            uint32_t slice = 0;
+            uint32_t sliceCount = 1;
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+        };
+        JobSystem *m_jobs = nullptr;
+        std::vector<std::vector<SecondaryPool>> m_secondaryPools; // [frame slot][JobSystem thread]
+        std::vector<RecordTask> m_recordTasks;
+        std::vector<VkCommandBuffer> m_secondaryCmds;
+
+        // GPU timestamp and pipeline statistics queries, one pool per frame slot
+        GpuProfiler m_gpuProfiler;
+        bool m_pipelineStatistics = false; // setPipelineStatistics(), kept across init()
+
+        // Frame pacing (setFramesInFlight(), setLowLatency(), waitForFrame()), one entry per frame slot
+        using PacingClock = std::chrono::steady_clock;
+        struct FramePacing
+        {
+            PacingClock::time_point inputTime{}; // waitForFrame() of the frame last submitted in the slot
+            uint64_t presentId = 0;              // its VK_KHR_present_id id, 0: none
+            bool pending = false;                // input-to-photon not measured yet
+        };
+        std::vector<FramePacing> m_pacing;
+        uint32_t m_framesInFlight = 2;
+        bool m_lowLatency = false;
+        bool m_inputSampled = false; // waitForFrame() ran since the last submit
+        PacingClock::time_point m_inputTime{};
+        PacingClock::time_point m_lastPacingWake{};
+        float m_cpuFrameMs = 0.0f; // waitForFrame() return to submit, smoothed
+        float m_displayIntervalMs = 0.0f;
+        float m_pacingSleepMs = 0.0f;
+        float m_inputLatencyMs = 0.0f;
+        bool m_latencyFromPresent = false;
+        bool m_presentWaitSupported = false;
+        uint64_t m_presentId = 0;             // last id given to a present
+        uint64_t m_swapchainFirstPresentId = 1; // first id presented to the current swapchain
+        VkSwapchainKHR m_presentSwapchain = VK_NULL_HANDLE;
+#if defined(VK_KHR_present_wait)
+        PFN_vkWaitForPresentKHR m_waitForPresent = nullptr;
+#endif
 
     private:
         // Create semaphores and fences for each frame slot (called during init).
@@ -100,13 +286,41 @@ namespace Engine
         void destroySyncObjects();
         void destroyCommandPoolsAndBuffers();
 
+        // Parallel recording helpers: record the main render pass contents through secondary command
+        // buffers, and begin one for the calling JobSystem thread.
+        void recordPassesParallel(FrameContext &frame, VkFramebuffer framebuffer);
+        VkCommandBuffer beginSecondary(uint32_t frameSlot, VkFramebuffer framebuffer);
+        void destroySecondaryPools();
+
         // Depth helpers
         void createDepthResources();
         void destroyDepthResources();
 
+        // Depth pre-pass helpers: render pass, framebuffers and the Hi-Z pyramid.
+        void createDepthPrepass();
+        void destroyDepthPrepass();
+
+        // The frame's render graph: module compute passes, depth pre-pass, Hi-Z build, main render pass.
+        void buildFrameGraph(FrameContext &frame, uint32_t imageIndex);
+        void recordDepthPrepass(FrameContext &frame, uint32_t imageIndex, VkCommandBuffer cmd);
+        void recordMainPass(FrameContext &frame, uint32_t imageIndex, VkCommandBuffer cmd);
+
+        // Global set helpers: created once by init(); updateGlobals() writes the frame's slot.
+        void createGlobalResources();
+        void destroyGlobalResources();
+        void updateGlobals(FrameContext &frame);
+
+        // onCreate() of a pass, after telling it about the global set and the depth pre-pass.
+        void createPass(RenderPassModule &pass);
+
         // Swapchain-dependent recreate helper
         void recreateSwapchainDependent();
 
+        // Frame pacing helpers: record a frame's input-to-photon latency, and wait in low-latency mode
+        // until the present queue is at most getFramesInFlight() - 1 frames deep.
+        void recordInputLatency(FramePacing &pacing, PacingClock::time_point onScreen, bool fromPresent);
+        void waitForPresentQueue();
+
         // GPU timestamp helpers
         void createTimestampQueryPool();
         void destroyTimestampQueryPool();
@@ -117,12 +331,84 @@ namespace Engine
     public:
         virtual ~RenderPassModule() = default;
 
+        // Label of the module's Engine::Profiler scopes; a string literal.
+        virtual const char *name() const { return "RenderPassModule"; }
+
         // Called after the main render pass and framebuffers are created
         virtual void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) = 0;
 
+        // Called before every onCreate() with the layout of set 0 (Renderer::getGlobalSetLayout()). Passes
+        // put it first in their pipeline layouts and bind FrameContext::globalSet at set 0 once per
+        // command buffer instead of uploading a camera of their own.
+        virtual void setGlobalSetLayout(VkDescriptorSetLayout layout) { (void)layout; }
+
+        // Depth pre-pass (Renderer::setDepthPrepass()): called before every onCreate() with the pre-pass
+        // render pass (depth attachment only), VK_NULL_HANDLE without one. A pass that records into it
+        // draws the same geometry in the main render pass with VK_COMPARE_OP_LESS_OR_EQUAL.
+        virtual void setDepthPrepass(VkRenderPass depthPass) { (void)depthPass; }
+
+        // Record depth-only draws inside the pre-pass, after recordCompute() and before the main render
+        // pass. Always on the render thread, into the primary command buffer. Default: nothing.
+        virtual void recordDepthPrepass(FrameContext &frameCtx, VkCommandBuffer cmd)
+        {
+            (void)frameCtx;
+            (void)cmd;
+        }
+
+        // Record compute/transfer work (outside any render pass) before the main render pass begins.
+        // Barriers between its own dispatches are the module's; those against other passes come from
+        // the render graph through declareCompute()/declareDraws(). Default: nothing.
+        virtual void recordCompute(FrameContext &frameCtx, VkCommandBuffer cmd)
+        {
+            (void)frameCtx;
+            (void)cmd;
+        }
+
+        // Render graph (Renderer::getRenderGraph()), rebuilt every frame before anything records.
+        // declareCompute() declares what recordCompute() reads and writes, declareDraws() what the
+        // draws of recordDepthPrepass() and record() read (called for each of the two passes).
+        // setupGraph() adds passes of the module's own, after every module's compute pass and before
+        // the depth pre-pass. Defaults: nothing declared.
+        virtual void declareCompute(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx)
+        {
+            (void)graph;
+            (void)pass;
+            (void)frameCtx;
+        }
+        virtual void declareDraws(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx)
+        {
+            (void)graph;
+            (void)pass;
+            (void)frameCtx;
+        }
+        virtual void setupGraph(RenderGraph &graph, FrameContext &frameCtx)
+        {
+            (void)graph;
+            (void)frameCtx;
+        }
+
         // Record drawing commands for this pass into the provided command buffer
         virtual void record(FrameContext &frameCtx, VkCommandBuffer cmd) = 0;
 
+        // Parallel recording (Renderer::setJobSystem()). prepareRecord() runs on the render thread
+        // first and returns how many slices (at most maxSlices, 0 to skip) the pass records;
+        // recordSlice() then runs for every slice, possibly on other threads at the same time, each
+        // into its own secondary command buffer inside the main render pass. Slices execute in order.
+        // Default: one slice that calls record(), which then must not write anything another pass reads
+        // while recording.
+        virtual uint32_t prepareRecord(FrameContext &frameCtx, uint32_t maxSlices)
+        {
+            (void)frameCtx;
+            (void)maxSlices;
+            return 1;
+        }
+        virtual void recordSlice(FrameContext &frameCtx, VkCommandBuffer cmd, uint32_t slice, uint32_t sliceCount)
+        {
+            (void)slice;
+            (void)sliceCount;
+            record(frameCtx, cmd);
+        }
+
         // Called when swapchain/extent changes
         virtual void onResize(VulkanContext &ctx, VkExtent2D newExtent) = 0;
 
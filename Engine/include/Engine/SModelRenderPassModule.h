@@ -1,9 +1,11 @@
 #pragma once
 #include "Engine/Renderer.h"
 #include "Engine/Pipeline.h"
+#include "Engine/DrawPackets.h"
 #include "assets/AssetManager.h"
 #include "assets/TextureAsset.h"
-#include "Engine/Camera.h"
+#include "utils/FrameArena.h"
+#include "utils/MemoryAllocator.h"
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <unordered_map>
@@ -11,11 +13,74 @@
 namespace Engine
 {
 
-    // RenderPassModule to render a cooked .smodel (ModelAsset) without node graph.
-    // Draws all primitives at identity transform (or a caller-provided model matrix).
+    // RenderPassModule that draws cooked .smodel assets (ModelAsset) without node graph evaluation:
+    // the model batch renderer. Every model drawn in a frame is one Batch of this single pass; all of
+    // them share the pipelines, material sets and culling buffers, their instances and palettes go
+    // into the frame's UploadRing, and their draws are recorded in one sequence sorted by material
+    // and mesh. The camera comes from the Renderer's global set (Renderer::setCamera()).
     class SModelRenderPassModule : public RenderPassModule
     {
     public:
+        // Palette entries drawn by one instance: entry pose0 blended towards pose1 by 'blend'.
+        struct InstancePose
+        {
+            uint32_t pose0 = 0;
+            uint32_t pose1 = 0;
+            float blend = 0.0f;
+        };
+        static_assert(sizeof(InstancePose) == 12, "InstancePose must match smodel.vert pose attributes");
+
+        // One model's instances. addBatch() keeps the pointers: every frame the batch is drawn, the pass
+        // reads what they point to straight into the frame's upload ring, so it must stay valid and
+        // unchanged until clearBatches(). lodCounts is copied.
+        struct Batch
+        {
+            ModelHandle model{};
+
+            // World matrices: 'worlds' (instanceCount entries), or 'instanceCount' matrices already in
+            // a GPU buffer (e.g. CrowdComputeModule::instanceBuffer()) starting 'instanceSourceOffset'
+            // bytes in. Neither: one instance at identity.
+            uint32_t instanceCount = 0;
+            const glm::mat4 *worlds = nullptr;
+            VkBuffer instanceSource = VK_NULL_HANDLE;
+            VkDeviceSize instanceSourceOffset = 0;
+
+            // Pose (palette entry) drawn by each instance, instanceCount entries, so instances sharing
+            // a pose share one palette entry; 'poseIndices' draw pose0 = pose1 without blending.
+            // Neither: instance i draws pose i.
+            const InstancePose *poses = nullptr;
+            const uint32_t *poseIndices = nullptr;
+
+            // Per-pose globals of the model's rendered nodes (ModelAsset::renderedNodes), flattened as
+            // [pose][rendered node], and joint matrices, flattened as [pose][joint]. Joint indices in
+            // the vertex stream are local to a skin; push constants offset them into this palette.
+            // poseCount is needed with per-entity animation, also with nodeCount == 0 (every
+            // primitive skinned), since it sizes the joint palette.
+            uint32_t poseCount = 0;
+            const PaletteMatrix *nodePalette = nullptr;
+            uint32_t nodeCount = 0;
+            const PaletteMatrix *jointPalette = nullptr;
+            uint32_t jointCount = 0;
+
+            // Draw from the model's baked clip frames (ModelAsset::bakeAnimations) instead of the
+            // palettes above: poses index baked frames, and the tables are uploaded once per frame
+            // slot. Ignored for models without a bake.
+            bool baked = false;
+
+            // Mesh LODs (ModelAsset::meshLodCount > 1): instances are sorted by LOD and the first
+            // lodCounts[0] draw the full meshes, the next lodCounts[1] LOD 1, and so on. Ignored
+            // unless the counts add up to instanceCount; nullptr draws every instance at full
+            // resolution.
+            const uint32_t *lodCounts = nullptr;
+            uint32_t lodCount = 0;
+
+            // Impostors (setImpostors()): the last impostorCount instances, after the mesh LOD
+            // ranges, draw as camera-facing quads from the model's impostor atlas, and their pose0 is
+            // an impostor frame (impostorFrame()) instead of a palette entry. Needs 'worlds'; lodCounts
+            // then add up to the other instances. Without an atlas they draw at the coarsest mesh LOD.
+            uint32_t impostorCount = 0;
+        };
+
         SModelRenderPassModule() = default;
         ~SModelRenderPassModule() override;
 
@@ -24,113 +89,451 @@ namespace Engine
         void setAssets(AssetManager *assets)
         {
             m_assets = assets;
-            refreshModelMatrix();
+            m_modelInfos.clear();
+            for (auto &cf : m_paletteFrames)
+                cf.bakedModels.clear();
+            for (auto &bf : m_bindlessFrames)
+                bf.textureVersion = UINT64_MAX;
         }
-        void setModel(ModelHandle h)
-        {
-            m_model = h;
-            refreshModelMatrix();
-        }
-
-        void setCamera(Camera *cam) { m_camera = cam; }
-
-        // Per-instance world transforms for instanced drawing.
-        // If not called (or count==0), the module defaults to drawing 1 instance at identity.
-        void setInstances(const glm::mat4 *instanceWorlds, uint32_t count);
-
-        // Per-instance node global matrices, flattened as [instance][node].
-        // Must be called when using per-entity animation (palette indexed by gl_InstanceIndex).
-        void setNodePalette(const glm::mat4 *nodeGlobals, uint32_t instanceCount, uint32_t nodeCount);
-
-        // Per-instance joint matrices, flattened as [instance][joint].
-        // Joint indices in the vertex stream are local to a skin; the shader uses push constants
-        // to offset into this global joint palette.
-        void setJointPalette(const glm::mat4 *jointMatrices, uint32_t instanceCount, uint32_t jointCount);
-
-        // Column-major 4x4 matrix (16 floats). Defaults to identity.
-        void setModelMatrix(const float *m16);
 
+        // The models drawn from the next frame on: clearBatches(), then one addBatch() per model.
+        // Batches stay until the next clearBatches().
+        void clearBatches();
+        void addBatch(const Batch &batch);
+        uint32_t batchCount() const { return static_cast<uint32_t>(m_batches.size()); }
+
+        // GPU-driven culling (shaders/smodel_cull.comp): recordCompute() tests every instance of every
+        // batch against the camera frustum in one dispatch, compacts the visible instances and writes
+        // one VkDrawIndexedIndirectCommand per draw that record() draws with vkCmdDrawIndexedIndirect.
+        // On by default; without the shader, or with instance sources it cannot read (more than one
+        // external buffer, offsets not on a matrix), the frame is drawn directly.
+        void setGpuCulling(bool enabled) { m_gpuCulling = enabled; }
+
+        // Occlusion culling against the Hi-Z pyramid (FrameContext::hiZ, Renderer::setDepthPrepass()):
+        // with GPU culling, instances hidden behind last frame's pre-pass depth are dropped too. The
+        // test uses the view-projection of that pre-pass, so an occluder moving away reveals what it
+        // hid one frame late. On by default.
+        void setOcclusionCulling(bool enabled) { m_occlusionCulling = enabled; }
+
+        // Meshlet culling (V7 .smodel meshlets, ModelPrimitive::meshletCount): with GPU culling, the
+        // full-resolution opaque and masked draws of static unskinned models are culled per meshlet
+        // (frustum, normal cone, Hi-Z in the compute path) for every visible instance. With mesh
+        // shaders (setMeshShaders()) smodel.task culls and smodel.mesh draws the survivors; otherwise
+        // the MESHLETS pass of smodel_cull.comp writes one indexed command per survivor, drawn with
+        // vkCmdDrawIndexedIndirectCount (VulkanContext::SupportsDrawIndirectCount()). One meshlet
+        // block (and, with mesh shaders, one vertex block) per frame: draws in others, and those past
+        // kMaxMeshletWork, keep their per-primitive command. On by default.
+        void setMeshletCulling(bool enabled) { m_meshletCulling = enabled; }
+        // The mesh shader path (VK_EXT_mesh_shader, shaders/smodel.task, smodel.mesh), used when the
+        // device and the shaders support it unless disabled before onCreate().
+        void setMeshShaders(bool enabled) { m_meshShadersRequested = enabled; }
+        bool meshShaders() const { return m_meshShaders; }
+        static constexpr uint32_t kMaxMeshletWork = 1u << 19; // (instance, meshlet) pairs per frame, compute path
+
+        // Bindless materials (Vulkan 1.2 descriptor indexing, shaders/smodel_bindless.frag): every
+        // AssetManager texture sits in one combined image sampler array and every material's
+        // parameters in a storage buffer, both indexed by AssetManager index and bound once per frame;
+        // draws pass their material index in push constants. Used when the device supports it and the
+        // shader exists, unless disabled before onCreate(); otherwise one descriptor set per material.
+        void setBindlessMaterials(bool enabled) { m_bindlessRequested = enabled; }
+        bool bindlessMaterials() const { return m_bindless; }
+
+        // Impostors for distant instances (Batch::impostorCount, shaders/impostor.vert, impostor.frag):
+        // a model's atlas holds kImpostorViews yaw views of each of its impostor frames, rendered once
+        // with smodel.vert/smodel.frag (on first use, or ahead of it with bakeImpostor()), and each
+        // batch's impostors are one instanced quad draw after the mesh draws. The bake turns the model
+        // in front of a fixed camera, so the light moves with the view. Used when the shaders exist,
+        // unless disabled before onCreate().
+        void setImpostors(bool enabled) { m_impostorsRequested = enabled; }
+        bool impostors() const { return m_impostors; }
+        // Bakes a model's atlas now, e.g. at load time, instead of in the first frame that needs it.
+        bool bakeImpostor(ModelHandle model);
+
+        // Atlas layout: one kImpostorCellSize cell per (yaw view, frame). Frames are up to
+        // kImpostorMaxClips clips of kImpostorFramesPerClip evenly spaced times each, or one rest
+        // frame for models without clips.
+        static constexpr uint32_t kImpostorViews = 8;
+        static constexpr uint32_t kImpostorMaxClips = 4;
+        static constexpr uint32_t kImpostorFramesPerClip = 8;
+        static constexpr uint32_t kImpostorCellSize = 64; // texels
+        static uint32_t impostorFrameCount(const ModelAsset &model);
+        // The frame showing 'clip' nearest to 'timeSec'; clips past kImpostorMaxClips show frame 0.
+        static uint32_t impostorFrame(const ModelAsset &model, uint32_t clip, float timeSec);
+
+        const char *name() const override { return "SModelRenderPassModule"; }
         void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
+        void setGlobalSetLayout(VkDescriptorSetLayout layout) override { m_globalSetLayout = layout; }
+        void setDepthPrepass(VkRenderPass depthPass) override { m_depthPrepassPass = depthPass; }
+        void recordCompute(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        // External instance sources and the Hi-Z pyramid in, the frame slot's culling output out.
+        void declareCompute(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx) override;
+        void declareDraws(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx) override;
+        // Opaque draws only; the main pass then shades them with depth writes off.
+        void recordDepthPrepass(FrameContext &frameCtx, VkCommandBuffer cmd) override;
         void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        // Parallel recording: the sorted draw list splits into contiguous slices of about
+        // kDrawsPerSlice draws.
+        uint32_t prepareRecord(FrameContext &frameCtx, uint32_t maxSlices) override;
+        void recordSlice(FrameContext &frameCtx, VkCommandBuffer cmd, uint32_t slice, uint32_t sliceCount) override;
+        static constexpr uint32_t kDrawsPerSlice = 256;
         void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
         void onDestroy(VulkanContext &ctx) override;
 
     private:
-        struct InstanceFrame
-        {
-            VkBuffer buffer = VK_NULL_HANDLE;
-            VkDeviceMemory memory = VK_NULL_HANDLE;
-            void *mapped = nullptr;
-            uint32_t capacity = 0;
-        };
-
         struct PushConstantsModel
         {
-            float model[16];
+            float model[12];          // rows 0-2 of the batch model matrix (PaletteMatrix layout)
+            float positionDequant[4]; // compact meshes: MeshAsset::getPositionDequant()
             float baseColorFactor[4];
             float materialParams[4]; // x=alphaCutoff, y=alphaMode, z/w unused
 
-            // Which node is being drawn; vertex shader fetches from palette[gl_InstanceIndex][nodeIndex]
+            // Which rendered node is being drawn (ModelAsset::renderedSlot) and the node palette
+            // stride; vertex shader fetches from palette[nodeBase + pose * nodeCount + nodeIndex]
             uint32_t nodeIndex = 0;
             uint32_t nodeCount = 0;
+            uint32_t nodeBase = 0; // the batch's first node palette entry
 
-            // Pad to match GLSL uvec4 nodeInfo
-            uint32_t _pad0 = 0;
-            uint32_t _pad1 = 0;
+            // Bindless materials: the draw's material table entry (AssetManager::getMaterialIndex)
+            uint32_t materialIndex = 0;
 
             // Skinning info:
             // - skinBaseJoint: base offset into joint palette for this primitive's skin
             // - skinJointCount: number of joints in this skin (0 => unskinned)
             // - jointPaletteStride: total joint count for this model (used to stride per instance)
-            // - flags: reserved
+            // - jointBase: the batch's first joint palette entry
             uint32_t skinBaseJoint = 0;
             uint32_t skinJointCount = 0;
             uint32_t jointPaletteStride = 0;
-            uint32_t flags = 0;
+            uint32_t jointBase = 0;
         };
 
         static_assert(sizeof(PushConstantsModel) == 128, "PushConstantsModel must match smodel.vert push constant block size");
         static_assert(offsetof(PushConstantsModel, nodeIndex) == 96, "PushConstantsModel::nodeIndex offset must match GLSL");
 
-        struct CameraUBO
+        // smodel_cull.comp Params.
+        struct PushConstantsCull
         {
-            glm::mat4 view;
-            glm::mat4 proj;
+            float planes[6][4]; // clip planes, unit normals pointing inside
+            uint32_t instanceCount = 0; // all batches
+            uint32_t batchCount = 0;
+            uint32_t drawCount = 0;
+            uint32_t poseWordBase = 0; // InstancePose words start here in the pose buffer (binding 1)
         };
+        static_assert(sizeof(PushConstantsCull) == 112, "PushConstantsCull must match smodel_cull.comp Params");
 
-        struct CameraFrame
+        // impostor.vert PushConstants.
+        struct PushConstantsImpostor
         {
-            VkBuffer buffer = VK_NULL_HANDLE;
-            VkDeviceMemory memory = VK_NULL_HANDLE;
+            float sphere[4];      // ModelInfo::sphere, the quad's center and half size
+            uint32_t grid[4] = {}; // x yaw views, y frames in the atlas
+        };
+        static_assert(sizeof(PushConstantsImpostor) == 32, "PushConstantsImpostor must match impostor.vert push constant block size");
+
+        // smodel_cull.comp Batch (binding 5), one per batch.
+        struct CullBatchGpu
+        {
+            float sphere[4];            // bounds center (after the model matrix) and radius, < 0: not culled
+            uint32_t instanceFirst = 0; // instance range in the pose and visible buffers
+            uint32_t instanceCount = 0;
+            uint32_t worldSource = 0; // 0 = instance buffer, 1 = external buffer (binding 6)
+            uint32_t worldFirst = 0;  // first world matrix read from that source
+            uint32_t lodEnd[ModelAsset::kMaxMeshLods]; // input range end of every mesh LOD
+        };
+        static_assert(sizeof(CullBatchGpu) == 48, "CullBatchGpu must match smodel_cull.comp Batch");
+
+        // smodel_cull.comp Occlusion (binding 8), in the upload ring.
+        struct OcclusionGpu
+        {
+            float viewProj[16];   // of the pre-pass the pyramid holds
+            uint32_t enabled = 0;
+            uint32_t mipCount = 0;
+            uint32_t depthWidth = 0;
+            uint32_t depthHeight = 0;
+        };
+        static_assert(sizeof(OcclusionGpu) == 80, "OcclusionGpu must match smodel_cull.comp Occlusion");
+
+        // smodel_cull.comp / smodel.task / smodel.mesh MeshletDraws (binding 10): this header, then one
+        // MeshletDrawGpu per meshlet draw.
+        struct MeshletFrameGpu
+        {
+            float viewProj[16];
+            float planes[6][4];
+            float cameraPos[4];
+            uint32_t drawCount = 0;
+            uint32_t workCount = 0;      // compute path: (visible instance, meshlet) invocations
+            uint32_t countWordFirst = 0; // compute path: each draw's command count, in the indirect buffer
+            uint32_t _pad0 = 0;
+        };
+        static_assert(sizeof(MeshletFrameGpu) == 192, "MeshletFrameGpu must match the MeshletDraws header");
+
+        struct MeshletDrawGpu
+        {
+            float rows[3][4];          // batch model matrix * rest node matrix, rows 0-2 (for culling)
+            uint32_t firstMeshlet = 0; // MeshletGpu records in the meshlet block
+            uint32_t meshletCount = 0;
+            uint32_t instanceFirst = 0; // the LOD 0 bucket's first visible instance
+            uint32_t bucket = 0;        // its visible count in the indirect buffer
+            uint32_t workFirst = 0;     // compute path: first invocation
+            uint32_t commandFirst = 0;  // compute path: first command in the meshlet command buffer
+            uint32_t firstIndex = 0;    // the primitive's
+            int32_t vertexOffset = 0;
+            uint32_t coneCulling = 0; // single-sided material
+            uint32_t _pad0[3] = {};
+        };
+        static_assert(sizeof(MeshletDrawGpu) == 96, "MeshletDrawGpu must match smodel_cull.comp MeshletDraw");
+
+        // smodel_cull.comp bindings 2..5 for one frame slot: compacted worlds and poses (device local,
+        // read as vertex buffers, each mesh LOD bucket's visible instances at the start of its input
+        // range), the indirect buffer (host visible): the visible count of every (batch, mesh LOD)
+        // bucket, one command per draw, then the bucket of every draw; and the batch table.
+        struct CullFrame
+        {
+            VkBuffer visibleBuffer = VK_NULL_HANDLE;
+            MemoryAllocation visibleMemory;
+            VkBuffer visiblePoseBuffer = VK_NULL_HANDLE;
+            MemoryAllocation visiblePoseMemory;
+            uint32_t capacity = 0; // instances
+
+            VkBuffer indirectBuffer = VK_NULL_HANDLE;
+            MemoryAllocation indirectMemory;
+            void *indirectMapped = nullptr;
+            VkDeviceSize indirectCapacity = 0; // bytes
+
+            VkBuffer batchBuffer = VK_NULL_HANDLE;
+            MemoryAllocation batchMemory;
+            void *batchMapped = nullptr;
+            uint32_t batchCapacity = 0;
+
+            // Meshlet draws (binding 10, host visible) and the MESHLETS pass's commands (binding 11,
+            // device local); the command counts follow the draw buckets in the indirect buffer.
+            VkBuffer meshletDrawBuffer = VK_NULL_HANDLE;
+            MemoryAllocation meshletDrawMemory;
+            void *meshletDrawMapped = nullptr;
+            uint32_t meshletDrawCapacity = 0;
+            VkBuffer meshletCommandBuffer = VK_NULL_HANDLE;
+            MemoryAllocation meshletCommandMemory;
+            uint32_t meshletCommandCapacity = 0;
+
             VkDescriptorSet set = VK_NULL_HANDLE;
 
+            // Render statistics of the draws last culled with this slot, per draw: read back with
+            // the visible counts of their buckets when the slot comes round again (readCullStats()).
+            struct StatsDraw
+            {
+                uint32_t batch = 0;     // index into statsModels
+                uint32_t bucket = 0;    // (batch, mesh LOD) visible count word
+                uint32_t triangles = 0; // per instance
+                uint32_t recorded = 0;  // times drawn (depth pre-pass and main pass)
+            };
+            std::vector<StatsDraw> statsDraws;
+            std::vector<ModelHandle> statsModels;
+        };
+        static constexpr uint32_t kCullGroupSize = 256; // smodel_cull.comp local_size_x
+        static constexpr uint32_t kTaskMeshlets = 32;    // smodel.task local_size_x
+        static constexpr uint32_t kMaxTaskGroups = 1u << 22; // per draw, the guaranteed maxTaskWorkGroupTotalCount
+        static constexpr uint32_t kMaterialSetCapacity = 256; // material sets across all models
+
+        // smodel_bindless.frag Material (binding 1), one per AssetManager material index.
+        struct MaterialGpu
+        {
+            float baseColorFactor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+            float alphaCutoff = 0.5f;
+            uint32_t alphaMode = 0;
+            uint32_t baseColorTexture = 0; // texture array element, 0 = fallback white
+            uint32_t _pad0 = 0;
+        };
+        static_assert(sizeof(MaterialGpu) == 32, "MaterialGpu must match smodel_bindless.frag Material");
+
+        // Bindless set (set 1) of one frame slot: texture array element 0 is the fallback white,
+        // element i + 1 AssetManager texture index i; the material table is refilled every frame.
+        struct BindlessFrame
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            VkBuffer materialBuffer = VK_NULL_HANDLE;
+            MemoryAllocation materialMemory;
+            void *materialMapped = nullptr;
+            uint32_t materialCapacity = 0;
+            uint64_t textureVersion = UINT64_MAX; // AssetManager::getBindlessVersion() the array was written at
+        };
+        static constexpr uint32_t kMaxBindlessTextures = 4096; // further capped by the device limits
+
+        // A model's baked impostor views (RGBA8, mip chain down to 4 texel cells when the format can
+        // be blitted), bound through a material-layout set.
+        struct ImpostorAtlas
+        {
+            VkImage image = VK_NULL_HANDLE;
+            MemoryAllocation memory;
+            VkImageView view = VK_NULL_HANDLE;
+            VkDescriptorSet set = VK_NULL_HANDLE; // from m_impostorPool
+            uint32_t frameCount = 0;
+            bool failed = false; // not baked again
+        };
+        static constexpr uint32_t kImpostorMipLevels = 5;
+        static constexpr uint32_t kImpostorAtlasCapacity = 64; // models
+
+        // One drawable primitive of a model, resolved once per model (buildModelDraws()): a (node,
+        // base primitive, mesh LOD) with its mesh, material and the push constants that do not change
+        // per frame.
+        struct ModelDraw
+        {
+            const ModelPrimitive *prim = nullptr;
+            MeshAsset *mesh = nullptr;
+            MaterialAsset *mat = nullptr;
+            uint32_t nodeSlot = 0; // rendered node index into the node palette
+            uint32_t lod = 0;      // mesh LOD; prim is that LOD's primitive
+            uint32_t pass = 0;     // alpha mode: 0 = OPAQUE, 1 = MASK, 2 = BLEND
+            uint32_t variant = 0;  // shaderVariant(): vertex format and skinning
+            uint32_t materialIndex = 0; // AssetManager::getMaterialIndex()
+            uint64_t geometryKey = 0;   // MeshAsset::getGeometryKey()
+            PushConstantsModel pc{};    // all but the batch's palette bases and strides
+        };
+
+        // One primitive draw of the current frame, in draw (and indirect command) order.
+        struct DrawItem
+        {
+            const ModelDraw *src = nullptr; // in the batch's ModelInfo::draws
+            uint32_t batch = 0;             // index into m_frameBatches
+            uint32_t meshletDraw = UINT32_MAX; // MeshletDrawGpu index when culled per meshlet (recordCompute())
+        };
+
+        // Set 1 of one frame slot: node (binding 0) and joint (binding 1) palettes. 'set' reads them from
+        // the upload ring, 'bakedSet' from the baked frame buffers below, which keep their contents
+        // across frames.
+        struct PaletteFrame
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            VkDescriptorSet bakedSet = VK_NULL_HANDLE;
+            VkBuffer ringBuffer = VK_NULL_HANDLE; // upload ring buffer the sets were written with
+
             VkBuffer paletteBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory paletteMemory = VK_NULL_HANDLE;
+            MemoryAllocation paletteMemory;
             void *paletteMapped = nullptr;
-            uint32_t paletteCapacityMatrices = 0;
+            uint32_t paletteCapacityMatrices = 0; // PaletteMatrix entries
 
             VkBuffer jointPaletteBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory jointPaletteMemory = VK_NULL_HANDLE;
+            MemoryAllocation jointPaletteMemory;
             void *jointPaletteMapped = nullptr;
-            uint32_t jointPaletteCapacityMatrices = 0;
+            uint32_t jointPaletteCapacityMatrices = 0; // PaletteMatrix entries
+
+            // Models (handle keys) whose baked frames the palette buffers hold, in order.
+            std::vector<uint64_t> bakedModels;
+        };
+
+        // Model matrix and drawn bounds of a model, cached per handle.
+        struct ModelInfo
+        {
+            float model[16]; // column-major; centers the bounds in XZ and sits their base on y=0
+            float sphere[4] = {0.0f, 0.0f, 0.0f, 0.0f}; // drawn bounding sphere (after 'model')
+            bool hasSphere = false;
+            std::vector<ModelDraw> draws[3]; // by alpha mode (ModelDraw::pass), in node order
+        };
+
+        // A batch as added: the caller's arrays, validated.
+        struct BatchEntry
+        {
+            ModelHandle model{};
+            uint32_t instanceCount = 0;
+            const glm::mat4 *worlds = nullptr; // instanceCount entries; nullptr: external or identity
+            VkBuffer instanceSource = VK_NULL_HANDLE;
+            VkDeviceSize instanceSourceOffset = 0;
+            const InstancePose *poses = nullptr; // instanceCount entries, or poseIndices
+            const uint32_t *poseIndices = nullptr;
+            bool hasPoses = false;
+            uint32_t poseCount = 0;
+            const PaletteMatrix *nodePalette = nullptr; // poseCount * nodeCount entries
+            uint32_t nodeCount = 0;
+            const PaletteMatrix *jointPalette = nullptr; // poseCount * jointCount entries
+            uint32_t jointCount = 0;
+            bool baked = false;
+            uint32_t lodCounts[ModelAsset::kMaxMeshLods] = {};
+            bool hasLodCounts = false;
+            uint32_t impostorCount = 0; // own worlds only
+        };
+
+        // A batch as drawn this frame, set by prepareFrame().
+        struct FrameBatch
+        {
+            const BatchEntry *entry = nullptr;
+            ModelAsset *model = nullptr;
+            const ModelInfo *info = nullptr;
+            uint32_t instanceFirst = 0;  // range in the frame's poses (and culling output)
+            uint32_t worldFirst = 0;     // first own world in the frame's worlds, unless external
+            VkBuffer worldBuffer = VK_NULL_HANDLE; // binding 1 source for direct draws
+            VkDeviceSize worldOffset = 0;          // bytes, instance 0 of the batch
+            bool baked = false;     // draws the model's baked frames (PaletteFrame::bakedSet)
+            uint32_t poseCount = 1; // palette entries
+            uint32_t nodeBase = 0;  // in the ring (or baked) palette buffer
+            uint32_t nodeCount = 1;    // node palette stride
+            uint32_t nodeMatrices = 1; // node palette entries
+            uint32_t jointBase = 0;
+            uint32_t jointStride = 1; // joint palette stride
+            uint32_t lodFirst[ModelAsset::kMaxMeshLods] = {}; // instance range of each mesh LOD, in the batch
+            uint32_t lodCount[ModelAsset::kMaxMeshLods] = {};
+            uint32_t impostorCount = 0; // the batch's last instances, drawn from 'impostor'
+            const ImpostorAtlas *impostor = nullptr;
+            float blendDistance = 0.0f; // from the camera, orders blended draws (with any)
+            uint64_t uploadBytes = 0;   // worlds, poses and palettes written this frame (RenderStats)
         };
 
         void destroyResources();
         void createPipelines(VulkanContext &ctx, VkRenderPass pass);
-        bool refreshModelMatrix();
-        bool createCameraResources(VulkanContext &ctx, size_t frameCount);
-        void destroyCameraResources();
-        bool ensurePaletteCapacity(CameraFrame &frame, uint32_t neededMatrices);
-        bool ensureJointPaletteCapacity(CameraFrame &frame, uint32_t neededMatrices);
-
-        bool createInstanceResources(VulkanContext &ctx, size_t frameCount);
-        void destroyInstanceResources();
-        bool ensureInstanceCapacity(InstanceFrame &frame, uint32_t needed);
+        void computeModelInfo(const ModelAsset &model, ModelInfo &out) const;
+        const ModelInfo &modelInfo(ModelHandle h, const ModelAsset &model);
+        void buildModelDraws(const ModelAsset &model, ModelInfo &info) const;
+        bool createPaletteResources(VulkanContext &ctx, size_t frameCount);
+        void destroyPaletteResources();
+        bool ensurePaletteCapacity(PaletteFrame &frame, uint32_t neededMatrices);
+        bool ensureJointPaletteCapacity(PaletteFrame &frame, uint32_t neededMatrices);
+        void writeRingSets(PaletteFrame &frame, VkBuffer ringBuffer);
+
+        // Everything record() needs besides the draws: camera UBO, instances and palettes in the upload
+        // ring, and the sorted draw list of every batch. Run by recordCompute() when culling on the GPU,
+        // else by record().
+        bool prepareFrame(FrameContext &frameCtx);
+        // AssetManager::requestTextureDetail() for the materials of the frame's batches
+        void requestTextureDetail(const FrameContext &frameCtx);
+        // Whether recordCompute() may cull this frame, decided before prepareFrame(): the culling
+        // buffers are declared to the render graph on it.
+        bool cullingPossible() const;
+
+        // Draws [drawBegin, drawEnd) of the prepared frame; depthOnly: the opaque ones with the depth
+        // pre-pass pipeline.
+        struct PreparedFrame;
+        void recordDraws(const PreparedFrame &frame, VkCommandBuffer cmd, uint32_t drawBegin, uint32_t drawEnd, bool depthOnly);
+
+        bool createBuffer(VkBuffer &buffer, MemoryAllocation &memory, VkDeviceSize size, VkBufferUsageFlags usage,
+                          VkMemoryPropertyFlags props, void **mapped);
+        void destroyBuffer(VkBuffer &buffer, MemoryAllocation &memory, void **mapped);
+        bool createCullResources(VulkanContext &ctx, size_t frameCount);
+        void destroyCullResources();
+        bool ensureCullCapacity(CullFrame &frame, uint32_t instances, uint32_t draws, uint32_t batches,
+                                uint32_t meshletDraws, uint32_t meshletCommands);
+        // Picks this frame's meshlet draws (DrawItem::meshletDraw, m_meshletDraws). outWork: MESHLETS
+        // invocations (compute path); outVertexBlock: the vertex buffer smodel.mesh reads (mesh
+        // shader path). Returns the meshlet block they read, UINT32_MAX: none.
+        uint32_t prepareMeshletDraws(uint32_t &outWork, VkBuffer &outVertexBlock);
+        // Visible triangles of the draws 'frame' culled last time (RenderStats); the GPU is done with it.
+        void readCullStats(CullFrame &frame);
 
         bool createMaterialResources(VulkanContext &ctx);
         void destroyMaterialResources();
         VkDescriptorSet getOrCreateMaterialSet(MaterialHandle h, const MaterialAsset *mat);
 
+        bool createBindlessResources(VulkanContext &ctx, size_t frameCount);
+        void destroyBindlessResources();
+        bool updateBindlessFrame(BindlessFrame &frame);
+
+        // Bake pass and layout, atlas pool and sampler, and the impostor pipeline for 'pass'; the bake
+        // pipelines are made with the others by createPipelines().
+        bool createImpostorResources(VulkanContext &ctx, VkRenderPass pass);
+        void destroyImpostorResources();
+        void destroyImpostorAtlas(ImpostorAtlas &atlas);
+        // The model's atlas, baked on first use; nullptr when it cannot be.
+        const ImpostorAtlas *impostorAtlas(ModelHandle h, const ModelAsset &model);
+        bool bakeImpostorAtlas(const ModelAsset &model, const ModelInfo &info, ImpostorAtlas &out);
+        // One instanced quad draw per batch with impostors.
+        void recordImpostors(const PreparedFrame &frame, VkCommandBuffer cmd);
+
         VkPipelineColorBlendStateCreateInfo makeBlendState(bool enableBlend, VkPipelineColorBlendAttachmentState &outAttachment) const;
 
     private:
@@ -139,37 +542,128 @@ namespace Engine
         VkExtent2D m_extent{};
 
         AssetManager *m_assets = nullptr;
-        ModelHandle m_model{};
-        Camera *m_camera = nullptr;
 
         bool m_enabled = true;
 
         VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-        Pipeline m_pipelineOpaque;
-        Pipeline m_pipelineMask;
-        Pipeline m_pipelineBlend;
-
-        VkDescriptorSetLayout m_cameraSetLayout = VK_NULL_HANDLE;
-        VkDescriptorPool m_cameraPool = VK_NULL_HANDLE;
-        std::vector<CameraFrame> m_cameraFrames;
+        // Shader variants: smodel.vert is specialized per vertex format (bit 0: 0 = VertexPNTTJW,
+        // 1 = compact, MeshAsset::isCompact()) and skinning (bit 1), so no draw pays for the paths
+        // it does not take; the MASK pipelines specialize smodel.frag for the alpha test.
+        static constexpr uint32_t kVertexFormatCount = 2;
+        static constexpr uint32_t kShaderVariantCount = 4;
+        static uint32_t shaderVariant(bool compact, bool skinned) { return (compact ? 1u : 0u) | (skinned ? 2u : 0u); }
+        // One pipeline per shader variant (ModelDraw::variant).
+        Pipeline m_pipelineOpaque[kShaderVariantCount];
+        Pipeline m_pipelineMask[kShaderVariantCount];
+        Pipeline m_pipelineBlend[kShaderVariantCount];
+        Pipeline m_pipelineDepth[kShaderVariantCount]; // depth pre-pass, vertex stage only
+        // Mesh shader path (task + mesh stages), per vertex format: meshlet draws are unskinned. The
+        // layout then has set 3 (the culling set) and m_pushStages includes the task and mesh stages.
+        Pipeline m_meshPipelineOpaque[kVertexFormatCount];
+        Pipeline m_meshPipelineMask[kVertexFormatCount];
+        Pipeline m_meshPipelineDepth[kVertexFormatCount];
+        VkShaderStageFlags m_pushStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        VkRenderPass m_depthPrepassPass = VK_NULL_HANDLE;
+        bool m_occlusionCulling = true;
+        // Pyramid build (HiZPyramid::getBuildCount()) that holds this pass's last pre-pass, drawn
+        // with m_hiZViewProj; 0: none yet.
+        uint64_t m_hiZBuild = 0;
+        glm::mat4 m_hiZViewProj{1.0f};
+
+        VkDescriptorSetLayout m_globalSetLayout = VK_NULL_HANDLE; // Renderer-owned, set 0
+        VkDescriptorSetLayout m_paletteSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_palettePool = VK_NULL_HANDLE;
+        std::vector<PaletteFrame> m_paletteFrames;
 
         VkDescriptorSetLayout m_materialSetLayout = VK_NULL_HANDLE;
         VkDescriptorPool m_materialPool = VK_NULL_HANDLE;
-        std::unordered_map<uint64_t, VkDescriptorSet> m_materialSetCache;
+        // Per material: its set and the base color view written into it
+        struct MaterialSet
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+        };
+        std::unordered_map<uint64_t, MaterialSet> m_materialSetCache;
+
+        bool m_bindlessRequested = true;
+        bool m_bindless = false;
+        uint32_t m_bindlessTextureCapacity = 0; // array elements, fallback included
+        VkDescriptorSetLayout m_bindlessSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_bindlessPool = VK_NULL_HANDLE;
+        std::vector<BindlessFrame> m_bindlessFrames;
+        std::vector<VkDescriptorImageInfo> m_bindlessImageInfos; // updateBindlessFrame() scratch
 
-        std::vector<InstanceFrame> m_instanceFrames;
-        std::vector<glm::mat4> m_instanceWorlds;
+        // Batches added since clearBatches().
+        std::vector<BatchEntry> m_batches;
 
-        // Flattened node globals uploaded to a per-frame SSBO
-        std::vector<glm::mat4> m_nodePalette;
-        std::vector<glm::mat4> m_jointPalette;
-        uint32_t m_jointPaletteJointCount = 0;
-        uint32_t m_paletteInstanceCount = 0;
-        uint32_t m_paletteNodeCount = 0;
+        std::unordered_map<uint64_t, ModelInfo> m_modelInfos; // by model handle key
 
         TextureAsset m_fallbackWhiteTexture;
 
-        PushConstantsModel m_pc{};
+        bool m_gpuCulling = true;
+        bool m_cullAvailable = false;
+        VkDescriptorSetLayout m_cullSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_cullPool = VK_NULL_HANDLE;
+        VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_cullPipelines[3] = {}; // kPass 0 = cull, 1 = commands, 2 = meshlets
+        std::vector<CullFrame> m_cullFrames;
+        LinearArena m_statsScratch{16 * 1024}; // readCullStats() per-batch totals, reset per call
+
+        bool m_meshletCulling = true;
+        bool m_drawIndirectCount = false; // VulkanContext::SupportsDrawIndirectCount()
+        bool m_meshShadersRequested = true;
+        bool m_meshShaders = false;
+        std::vector<MeshletDrawGpu> m_meshletDraws; // prepareMeshletDraws() scratch
+
+        bool m_impostorsRequested = true;
+        bool m_impostors = false;
+        VkQueue m_graphicsQueue = VK_NULL_HANDLE; // atlas bakes
+        uint32_t m_graphicsQueueFamily = 0;
+        VkRenderPass m_impostorBakePass = VK_NULL_HANDLE; // atlas mip 0 + depth, left for the mip blits
+        VkPipelineLayout m_impostorBakeLayout = VK_NULL_HANDLE; // global, palette, material sets
+        Pipeline m_impostorBakePipelines[2 * kShaderVariantCount]; // [alpha mask * kShaderVariantCount + variant]
+        VkPipelineLayout m_impostorLayout = VK_NULL_HANDLE;     // global, atlas sets
+        Pipeline m_impostorPipeline;
+        VkDescriptorPool m_impostorPool = VK_NULL_HANDLE;
+        VkSampler m_impostorSampler = VK_NULL_HANDLE;
+        std::unordered_map<uint64_t, ImpostorAtlas> m_impostorAtlases; // by model handle key
+        PFN_vkCmdDrawIndexedIndirectCount m_cmdDrawIndexedIndirectCount = nullptr;
+#if defined(VK_EXT_mesh_shader)
+        PFN_vkCmdDrawMeshTasksIndirectEXT m_cmdDrawMeshTasksIndirect = nullptr;
+#endif
+
+        // Set by prepareFrame() for the frame being recorded.
+        struct PreparedFrame
+        {
+            bool valid = false;
+            uint32_t frameIndex = 0;
+            PaletteFrame *paletteFrame = nullptr;
+            VkDescriptorSet globalSet = VK_NULL_HANDLE; // FrameContext::globalSet
+            // Upload ring allocation of the frame: palettes, own worlds and poses.
+            VkBuffer ringBuffer = VK_NULL_HANDLE;
+            VkDeviceSize worldsOffset = 0;
+            VkDeviceSize worldsBytes = 0;
+            VkDeviceSize posesOffset = 0;
+            VkDeviceSize posesBytes = 0;
+            BindlessFrame *bindlessFrame = nullptr; // with bindless materials
+            CullFrame *cullFrame = nullptr; // non-null once recordCompute() culled this frame
+            VkDeviceSize meshletCountOffset = 0; // compute meshlet draws: their counts in the indirect buffer
+            uint32_t instanceCount = 0;     // all batches
+            uint32_t impostorCount = 0;     // all batches, drawn by recordImpostors()
+            glm::mat4 viewProj{1.0f};
+        };
+        PreparedFrame m_prepared;
+        PreparedFrame m_recording; // taken by prepareRecord(), read by the recordSlice() calls
+        std::vector<FrameBatch> m_frameBatches;
+        std::vector<DrawItem> m_draws;
+        std::vector<VkDescriptorSet> m_drawMaterialSets; // per draw, without bindless materials
+        std::vector<DrawPacket> m_packets;      // prepareFrame() scratch: sort keys of m_draws
+        std::vector<DrawPacket> m_packetScratch;
+        std::vector<DrawItem> m_sortedDraws;
+        std::unordered_map<uint64_t, uint32_t> m_meshKeys; // dense ids of MeshAsset::getGeometryKey() for the keys
+        std::vector<uint64_t> m_frameBakedModels; // prepareFrame() scratch: baked models in palette order
+        std::vector<uint32_t> m_bakedOrder;       // and the baked batches, by model
     };
 
 } // namespace Engine
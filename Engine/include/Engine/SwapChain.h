@@ -32,6 +32,12 @@ namespace Engine
         VkFormat GetImageFormat() const { return m_ImageFormat; }
         VkExtent2D GetExtent() const { return m_Extent; }
 
+        // Present mode preference applied by Init()/Recreate(): used when the surface supports it, else
+        // MAILBOX, else FIFO (always supported). FIFO with Renderer::setLowLatency() trades MAILBOX's
+        // throughput for a short, paced present queue without tearing.
+        void SetPreferredPresentMode(VkPresentModeKHR mode) { m_PreferredPresentMode = mode; }
+        VkPresentModeKHR GetPresentMode() const { return m_PresentMode; }
+
     private:
         // internal helpers (similar to previous free functions)
         VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &available) const;
@@ -50,6 +56,8 @@ namespace Engine
         std::vector<VkImageView> m_ImageViews;
         VkFormat m_ImageFormat = VK_FORMAT_UNDEFINED;
         VkExtent2D m_Extent{};
+        VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+        VkPresentModeKHR m_PreferredPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR; // none
 
         // Initial extent (window size) provided by VulkanContext when constructing
         VkExtent2D m_InitialExtent{};
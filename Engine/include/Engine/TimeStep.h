@@ -0,0 +1,9 @@
+#pragma once
+
+namespace Engine
+{
+    struct TimeStep
+    {
+        float DeltaSeconds = 0.0f;
+    };
+}
@@ -50,6 +50,7 @@ namespace Engine
         }
 
         // RenderPassModule interface
+        const char *name() const override { return "TrianglesRenderPassModule"; }
         void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
         void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
         void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
@@ -0,0 +1,106 @@
+#pragma once
+/*
+  UploadRing.h
+  ------------
+  Purpose:
+    - Per-frame linear upload memory for dynamic data that is rewritten every frame (instance
+      matrices, palettes, uniform blocks). Renderer owns one ring with a slot per frame in flight;
+      each slot is one persistently mapped host-visible buffer that passes bind with offsets
+      (dynamic uniform offsets, vertex buffer offsets, storage descriptor offsets).
+    - Allocation is a pointer bump; nothing is freed individually. A slot rewinds when its frame
+      comes round again, after Renderer waited for the GPU to finish with it.
+
+  Usage:
+    - Renderer::drawFrame() calls beginFrame(slot) after the slot's fence wait and hands the ring to
+      the passes through FrameContext::uploadRing.
+    - UploadRing::Allocation a = ring.allocateStorage(bytes);
+      std::memcpy(a.mapped, data, bytes); ... bind a.buffer at a.offset.
+
+  Notes:
+    - Allocations are valid until the end of the frame they were made in.
+    - A slot that runs out in the middle of a frame continues in a new, larger buffer (the full one
+      stays alive until the slot comes back) and is resized to the frame's peak use on its next
+      beginFrame(), so growth never stalls the GPU or invalidates what was handed out.
+    - Not thread safe: allocate from the render thread.
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include "utils/MemoryAllocator.h"
+
+namespace Engine
+{
+    class UploadRing
+    {
+    public:
+        struct Allocation
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            void *mapped = nullptr; // at 'offset'
+            bool isValid() const { return buffer != VK_NULL_HANDLE; }
+        };
+
+        static constexpr VkDeviceSize kDefaultSlotBytes = VkDeviceSize(4) << 20;
+
+        UploadRing() = default;
+        ~UploadRing();
+
+        UploadRing(const UploadRing &) = delete;
+        UploadRing &operator=(const UploadRing &) = delete;
+
+        bool init(VkDevice device, VkPhysicalDevice phys, uint32_t slotCount, VkDeviceSize slotBytes = kDefaultSlotBytes);
+        void destroy();
+
+        // Rewinds 'slot' for a new frame; the GPU must be done with its previous frame.
+        void beginFrame(uint32_t slot);
+
+        // 'alignment' need not be a power of two. Invalid when the ring is not initialized or the
+        // request exceeds the device's storage buffer range.
+        Allocation allocate(VkDeviceSize size, VkDeviceSize alignment);
+        Allocation allocateUniform(VkDeviceSize size) { return allocate(size, m_uniformAlignment); }
+        Allocation allocateStorage(VkDeviceSize size) { return allocate(size, m_storageAlignment); }
+
+        // Device offset alignments for descriptors bound into the ring.
+        VkDeviceSize uniformAlignment() const { return m_uniformAlignment; }
+        VkDeviceSize storageAlignment() const { return m_storageAlignment; }
+
+        // Bumped by every beginFrame().
+        uint64_t frameSerial() const { return m_frameSerial; }
+
+        // Stats
+        VkDeviceSize getCapacityBytes() const; // all slots
+        VkDeviceSize getUsedBytes() const;     // current slot, this frame
+
+    private:
+        struct Buffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            MemoryAllocation memory;
+            VkDeviceSize size = 0;
+        };
+
+        struct Slot
+        {
+            Buffer current;
+            std::vector<Buffer> retired; // filled up this frame, freed on the slot's next beginFrame()
+            VkDeviceSize head = 0;       // into 'current'
+            VkDeviceSize used = 0;       // this frame, every buffer
+        };
+
+        bool createBuffer(VkDeviceSize size, Buffer &out);
+        void destroyBuffer(Buffer &buffer);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkDeviceSize m_uniformAlignment = 256;
+        VkDeviceSize m_storageAlignment = 256;
+        VkDeviceSize m_maxBufferBytes = 0; // maxStorageBufferRange, so a whole-buffer descriptor stays valid
+
+        std::vector<Slot> m_slots;
+        uint32_t m_slot = 0;
+        uint64_t m_frameSerial = 0;
+    };
+
+} // namespace Engine
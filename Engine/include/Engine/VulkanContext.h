@@ -9,6 +9,9 @@ namespace Engine
 {
     class Window;
     class SwapChain; // Forward declaration of SwapChain
+    class MemoryAllocator;
+    class PipelineCache;
+    class DeletionQueue;
     class VulkanContext
     {
     public:
@@ -25,7 +28,40 @@ namespace Engine
         VkQueue GetPresentQueue() const { return m_PresentQueue; }
         VkInstance GetInstance() const { return m_Instance; }
         uint32_t GetGraphicsQueueFamilyIndex() const { return m_SelectedDeviceInfo.queueFamilyIndices.graphicsFamily.value(); }
+        // Dedicated transfer queue: a family with transfer but neither graphics nor compute (the copy
+        // engine), else the graphics queue. Uploads on it hand what they write to the graphics family
+        // with queue family ownership transfers (BeginUploadContext()).
+        VkQueue GetTransferQueue() const { return m_TransferQueue; }
+        uint32_t GetTransferQueueFamilyIndex() const { return m_SelectedDeviceInfo.queueFamilyIndices.transferFamily.value_or(GetGraphicsQueueFamilyIndex()); }
+        bool HasDedicatedTransferQueue() const { return m_SelectedDeviceInfo.queueFamilyIndices.transferFamily.has_value(); }
+        // Async compute queue: a compute family without graphics, else the graphics queue.
+        VkQueue GetComputeQueue() const { return m_ComputeQueue; }
+        uint32_t GetComputeQueueFamilyIndex() const { return m_SelectedDeviceInfo.queueFamilyIndices.computeFamily.value_or(GetGraphicsQueueFamilyIndex()); }
+        bool HasAsyncComputeQueue() const { return m_SelectedDeviceInfo.queueFamilyIndices.computeFamily.has_value(); }
         SwapChain *GetSwapChain() const { return m_SwapChain.get(); }
+        // Device memory for all engine buffers and images (BufferUtils/ImageUtils find it through the device).
+        MemoryAllocator *GetMemoryAllocator() const { return m_MemoryAllocator.get(); }
+        // Pipeline cache shared by every pipeline, persisted to PipelineCache::kDefaultPath on Shutdown().
+        PipelineCache *GetPipelineCache() const { return m_PipelineCache.get(); }
+        // Frame-fenced destruction of resources frames in flight may use (the Renderer advances it).
+        DeletionQueue *GetDeletionQueue() const { return m_DeletionQueue.get(); }
+
+        // Vulkan 1.2 descriptor indexing (runtime arrays, partially bound bindings) is enabled.
+        bool SupportsDescriptorIndexing() const { return m_DescriptorIndexing; }
+        // vkCmdDrawIndexedIndirectCount plus non-zero firstInstance in indirect draws (Vulkan 1.2)
+        bool SupportsDrawIndirectCount() const { return m_DrawIndirectCount; }
+        // VK_EXT_mesh_shader task and mesh stages
+        bool SupportsMeshShaders() const { return m_MeshShaders; }
+        // VK_KHR_present_id + VK_KHR_present_wait: presents carry ids and vkWaitForPresentKHR waits for
+        // one to reach the display (Renderer::setLowLatency())
+        bool SupportsPresentWait() const { return m_PresentWait; }
+        // Pipeline statistics queries (Renderer::setPipelineStatistics())
+        bool SupportsPipelineStatistics() const { return m_PipelineStatistics; }
+        // VK_EXT_memory_budget: per-heap budget and usage from the driver (MemoryAllocator::getHeapBudgets())
+        bool SupportsMemoryBudget() const { return m_MemoryBudget; }
+        // VK_EXT_calibrated_timestamps with the device domain and the host clock of Profiler::now():
+        // GPU timestamps can be placed on the CPU timeline (GpuProfiler)
+        bool SupportsCalibratedTimestamps() const { return m_CalibratedTimestamps; }
 
     private:
         void createInstance();
@@ -60,8 +96,22 @@ namespace Engine
         VkDevice m_Device = VK_NULL_HANDLE;       // logical device
         VkQueue m_GraphicsQueue = VK_NULL_HANDLE; // graphics queue handle
         VkQueue m_PresentQueue = VK_NULL_HANDLE;
+        VkQueue m_TransferQueue = VK_NULL_HANDLE; // the graphics queue without a dedicated one
+        VkQueue m_ComputeQueue = VK_NULL_HANDLE;  // the graphics queue without an async one
 
         std::unique_ptr<SwapChain> m_SwapChain;
+        std::unique_ptr<MemoryAllocator> m_MemoryAllocator;
+        std::unique_ptr<PipelineCache> m_PipelineCache;
+        std::unique_ptr<DeletionQueue> m_DeletionQueue;
+
+        uint32_t m_InstanceApiVersion = VK_API_VERSION_1_0;
+        bool m_DescriptorIndexing = false;
+        bool m_DrawIndirectCount = false;
+        bool m_MeshShaders = false;
+        bool m_PresentWait = false;
+        bool m_PipelineStatistics = false;
+        bool m_MemoryBudget = false;
+        bool m_CalibratedTimestamps = false;
     };
 
 } // namespace Engine
\ No newline at end of file
@@ -1,5 +1,14 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace Engine
+{
+    class UploadRing;
+    class HiZPyramid;
+    struct GlobalUniforms;
+}
+
 // Per-frame resources (one slot per in-flight frame)
 struct FrameContext
 {
@@ -9,4 +18,9 @@ struct FrameContext
     VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
     VkFence inFlightFence = VK_NULL_HANDLE;
     uint32_t frameIndex = 0;
+    uint64_t deletionSerial = 0; // DeletionQueue serial of the slot's last submit (0: none yet)
+    Engine::UploadRing *uploadRing = nullptr; // this frame's upload memory (Renderer-owned)
+    const Engine::HiZPyramid *hiZ = nullptr;  // depth pre-pass pyramid (Renderer-owned), or nullptr
+    VkDescriptorSet globalSet = VK_NULL_HANDLE;    // set 0 of every pass (Renderer::getGlobalSetLayout())
+    const Engine::GlobalUniforms *globals = nullptr; // what globalSet holds this frame
 };
\ No newline at end of file
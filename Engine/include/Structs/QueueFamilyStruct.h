@@ -8,6 +8,9 @@ namespace Engine
     {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        // Optional, without graphics: the copy engine (transfer only) and an async compute family.
+        std::optional<uint32_t> transferFamily;
+        std::optional<uint32_t> computeFamily;
 
         bool isComplete() const
         {
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <memory>
 #include <vector>
+#include <utility>
 
 #include "assets/Handles.h"
 
@@ -17,13 +18,18 @@
 #include "assets/TextureAsset.h"
 #include "assets/MaterialAsset.h"
 #include "assets/ModelAsset.h"
+#include "assets/ModelProvider.h"
+
+#include "utils/SlotMap.h"
 
 namespace Engine
 {
+    class JobSystem;
+
     // ---------------------------
     // AssetManager
     // ---------------------------
-    class AssetManager
+    class AssetManager final : public IModelProvider
     {
     public:
         AssetManager(VkDevice device,
@@ -32,19 +38,124 @@ namespace Engine
                      uint32_t graphicsQueueFamilyIndex);
         ~AssetManager();
 
+        // Dedicated transfer queue (VulkanContext::GetTransferQueue()) for texture uploads: their
+        // staging copies run there and the images move to the graphics family with ownership
+        // transfers. Ignored when the family is the graphics one.
+        void setTransferQueue(VkQueue queue, uint32_t queueFamilyIndex)
+        {
+            m_transferQueue = queue;
+            m_transferQueueFamilyIndex = queueFamilyIndex;
+        }
+
         // Existing mesh API
         MeshHandle loadMesh(const std::string &cookedMeshPath);
-        MeshAsset *getMesh(MeshHandle h);
+
+        // Handle lookups (per entity and per primitive): a bounds and generation check on the slot
+        // maps below. Null for stale handles.
+        MeshAsset *getMesh(MeshHandle h)
+        {
+            MeshEntry *e = m_meshes.find(h.id, h.generation);
+            return e ? e->asset.get() : nullptr;
+        }
 
         void addRef(MeshHandle h);
         void release(MeshHandle h);
 
         // New smodel/model API
         ModelHandle loadModel(const std::string &cookedModelPath);
-        ModelAsset *getModel(ModelHandle h);
+        ModelAsset *getModel(ModelHandle h)
+        {
+            ModelEntry *e = m_models.find(h.id, h.generation);
+            return e ? e->asset.get() : nullptr;
+        }
+        const ModelAsset *modelData(ModelHandle h) const override
+        {
+            const ModelEntry *e = m_models.find(h.id, h.generation);
+            return e ? e->asset.get() : nullptr;
+        }
+
+        // Asynchronous model load: returns a handle at once (the cached one if the path is loaded or
+        // loading). It stays Pending while the streaming workers read the file and decode its images
+        // and while the uploads update() submits are in flight (images through the transfer queue
+        // when set, one fence per model); getModel() returns nullptr until it is Ready. A Failed
+        // handle never becomes ready and is collected like any other once released. loadModel() of a
+        // pending path finishes the load on the spot.
+        ModelHandle loadModelAsync(const std::string &cookedModelPath) override;
+
+        enum class LoadState : uint8_t
+        {
+            Ready,
+            Pending,
+            Failed,
+            Invalid // unknown or stale handle
+        };
+        LoadState getModelState(ModelHandle h) const;
+        bool isModelReady(ModelHandle h) const { return getModelState(h) == LoadState::Ready; }
+        // The path the model was loaded from; empty for an unknown or stale handle.
+        const std::string &getModelPath(ModelHandle h) const;
+        uint32_t getPendingModelCount() const { return static_cast<uint32_t>(m_pendingModels.size()); }
+
+        // Advances the asynchronous loads; call once per frame on the thread that uses the
+        // AssetManager. Records and submits the uploads of at most kMaxModelUploadsPerUpdate decoded
+        // models and makes the models whose upload fence has signalled ready. Never waits. Also
+        // re-measures the CPU asset and animation data for MemoryTracker.
+        void update();
+        static constexpr uint32_t kMaxModelUploadsPerUpdate = 1;
+        static constexpr uint32_t kStreamingThreads = 2;
+
+        // Texture mip streaming. Block-compressed (.smodel V8) textures load with only the mips up to
+        // kStreamedBaseSize texels resident. Renderers report the on-screen size of what each material
+        // covers with requestTextureDetail(); update() then streams finer mips in from the source
+        // file, at most kMaxTextureStreamsPerUpdate textures per upload and one upload in flight, and
+        // drops them again from textures not requested for kTextureIdleUpdates calls, or from the
+        // least recently used and smallest on screen while the requested mips exceed the budget.
+        // A restreamed texture gets a new image and view (getBindlessVersion() changes); the old
+        // ones are destroyed once the frames submitted before the swap have finished.
+        void requestTextureDetail(MaterialHandle h, float screenPixels);
+        void setTextureBudget(uint64_t bytes) { m_textureBudget = bytes; }
+        uint64_t getTextureBudget() const { return m_textureBudget; }
+        static constexpr uint32_t kStreamedBaseSize = 128;
+        static constexpr uint32_t kMaxTextureStreamsPerUpdate = 4;
+        static constexpr uint32_t kTextureIdleUpdates = 300;
+        static constexpr uint64_t kDefaultTextureBudget = 256ull << 20;
 
-        MaterialAsset *getMaterial(MaterialHandle h);
-        TextureAsset *getTexture(TextureHandle h);
+        struct TextureStreamingStats
+        {
+            uint32_t streamedTextures = 0; // textures under the budget
+            uint32_t fullyResident = 0;    // of those, with mip 0 resident
+            uint32_t streamingTextures = 0; // in the upload in flight
+            uint64_t residentBytes = 0;
+            uint64_t requestedBytes = 0; // at the mips last requested, before the budget
+            uint64_t budgetBytes = 0;
+            uint64_t mipsStreamedIn = 0; // totals since creation
+            uint64_t mipsEvicted = 0;
+        };
+        TextureStreamingStats getTextureStreamingStats() const;
+
+        // Content deduplication. Model textures and meshes are keyed by a hash of their bytes and
+        // settings; a model whose texture or mesh matches a resident one (same base asset in another
+        // model, e.g. faction color variants) shares its handle instead of uploading a copy. Only
+        // resources whose upload has finished are shared. Materials stay per model.
+        struct DedupStats
+        {
+            uint32_t sharedTextures = 0; // resident textures / meshes that can be shared
+            uint32_t sharedMeshes = 0;
+            uint64_t textureHits = 0; // totals since creation
+            uint64_t meshHits = 0;
+            uint64_t bytesSkipped = 0; // source bytes not uploaded again
+        };
+        DedupStats getDedupStats() const;
+
+        MaterialAsset *getMaterial(MaterialHandle h)
+        {
+            MaterialEntry *e = m_materials.find(h.id, h.generation);
+            return e ? e->asset.get() : nullptr;
+        }
+        TextureAsset *getTexture(TextureHandle h)
+        {
+            TextureEntry *e = m_textures.find(h.id, h.generation);
+            return e ? e->asset.get() : nullptr;
+        }
         TextureHandle loadTextureFromFile(const std::string &filePath);
 
         void addRef(ModelHandle h);
@@ -56,26 +167,139 @@ namespace Engine
         void addRef(TextureHandle h);
         void release(TextureHandle h);
 
+        // Dense indices of the resident textures and materials, for renderers that keep one texture
+        // array and one material table (SModelRenderPassModule bindless materials). An index is
+        // stable while its asset lives and is reused after garbageCollect(); getBindlessVersion()
+        // changes whenever one is assigned or freed, or a texture is restreamed.
+        static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+        uint32_t getTextureIndex(TextureHandle h) const;
+        uint32_t getMaterialIndex(MaterialHandle h) const;
+        uint32_t getTextureIndexCount() const { return static_cast<uint32_t>(m_textureByIndex.size()); }
+        uint32_t getMaterialIndexCount() const { return static_cast<uint32_t>(m_materialByIndex.size()); }
+        TextureAsset *getTextureAtIndex(uint32_t index);
+        MaterialAsset *getMaterialAtIndex(uint32_t index);
+        uint64_t getBindlessVersion() const { return m_bindlessVersion; }
+
+        // Shared vertex/index storage of all meshes (see MeshAsset::getFirstIndex/getVertexOffset),
+        // and the models' meshlet tables (ModelAsset::meshletBlock)
+        const GeometryArena &getGeometryArena() const { return m_geometry; }
+
         // Collect all zero-ref assets (and clear caches)
         void garbageCollect();
 
     private:
+        // Image of a model texture decoded by a streaming worker
+        struct DecodedImage
+        {
+            std::vector<uint8_t> rgba;
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        // Content hashes of a parsed .smodel's textures and meshes, in record order (dedup keys)
+        struct ContentHashes
+        {
+            std::vector<uint64_t> textures;
+            std::vector<uint64_t> meshes;
+        };
+
+        // Textures and meshes a build uploaded, shareable once the upload has run
+        struct SharedResources
+        {
+            std::vector<std::pair<uint64_t, TextureHandle>> textures; // content hash, handle
+            std::vector<std::pair<uint64_t, MeshHandle>> meshes;
+        };
+
+        // A model as the loads build it before it is registered: the asset, its dependencies (already
+        // addRef'd), its meshlet tables and what it uploaded.
+        struct ModelBuild
+        {
+            std::unique_ptr<ModelAsset> asset;
+            std::vector<MeshHandle> meshDeps;
+            std::vector<MaterialHandle> materialDeps;
+            GeometryArena::Range meshletRange;
+            SharedResources uploaded;
+        };
+
+        // loadModelAsync() state (AssetManager.cpp)
+        struct PendingModel;
+
+        // Where a streamed texture's mip chain lives and what is resident
+        struct TextureStream
+        {
+            std::string path;        // source .smodel
+            uint64_t fileOffset = 0; // of the chain's bytes in it
+            uint32_t encoding = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            bool srgb = false;
+            VkSamplerAddressMode wrapU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            VkSamplerAddressMode wrapV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            VkFilter minFilter = VK_FILTER_LINEAR;
+            VkFilter magFilter = VK_FILTER_LINEAR;
+            VkSamplerMipmapMode mipMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+            float maxAnisotropy = 1.0f;
+
+            uint32_t baseMip = 0;     // coarsest first mip, always resident
+            uint32_t residentMip = 0; // first mip of the image
+            uint32_t wantedMip = 0;   // as of the last update(), budget applied
+            uint32_t requestedMip = UINT32_MAX; // finest requested since the last update()
+            float requestedPixels = 0.0f;
+            float pixels = 0.0f;      // on-screen size at the last request (eviction order)
+            uint64_t lastRequest = 0; // update() it was last requested in
+        };
+
+        // Restreamed textures being uploaded (AssetManager.cpp)
+        struct TextureStreamUpload;
+
+        // Creates the textures, materials and meshes of a parsed .smodel and builds its ModelAsset,
+        // reusing the shared textures and meshes whose content hash matches. GPU copies are recorded
+        // into 'upload' (NO submit); texture pixels and hashes come from 'images' and 'hashes' when
+        // computed already, else are computed here.
+        bool buildModel_Internal(const std::string &path, const smodel::SModelFileView &view,
+                                 const std::vector<DecodedImage> *images, const ContentHashes *hashes,
+                                 UploadContext &upload, ModelBuild &out);
+        static void computeContentHashes_Internal(const smodel::SModelFileView &view, ContentHashes &out);
+        // Makes uploaded textures and meshes findable by content (the first of equal ones wins)
+        void shareResources_Internal(const SharedResources &resources);
+        // Moves a pending load on: uploads once decoded, ready once uploaded. 'block' finishes it now.
+        // Returns true when it is done, ready or failed.
+        bool advancePendingModel_Internal(PendingModel &pending, bool block);
+        void failPendingModel_Internal(uint64_t id);
+        // A finished pending load into a running TraceCapture (request to done, decode and upload) and
+        // the HitchDetector (request to done)
+        void traceModelLoad_Internal(const PendingModel &pending) const;
+        // update()'s texture streaming: retires, swaps in a landed upload, applies the budget and
+        // starts the next upload
+        void updateTextureStreaming_Internal();
+        // update(): model CPU data and decoded images waiting for upload into MemoryTracker
+        void publishCpuMemory_Internal();
+        void finishTextureStream_Internal();
+        bool startTextureStream_Internal(const std::vector<TextureHandle> &textures);
+        void retireTextures_Internal(std::vector<std::unique_ptr<TextureAsset>> textures);
+
         MeshHandle createMeshFromData_Internal(const MeshData &data, const std::string &path, uint32_t initialRef);
+        MeshHandle createMesh_Internal(std::unique_ptr<MeshAsset> mesh, const std::string &path, uint32_t initialRef);
         TextureHandle createTexture_Internal(std::unique_ptr<TextureAsset> tex, uint32_t initialRef);
         MaterialHandle createMaterial_Internal(std::unique_ptr<MaterialAsset> mat, uint32_t initialRef);
         ModelHandle createModel_Internal(std::unique_ptr<ModelAsset> model, const std::string &path, uint32_t initialRef);
+        GeometryArena::Range uploadMeshlets_Internal(const smodel::SModelFileView &view, ModelAsset &model, UploadContext &upload);
+        // Begins 'ctx' with transient pools: outPools[0] for the graphics queue, outPools[1] for the
+        // transfer queue (null without a dedicated one).
+        bool beginUpload_Internal(UploadContext &ctx, VkCommandPool (&outPools)[2]);
+        void destroyUploadPools_Internal(VkCommandPool (&pools)[2]);
 
     private:
         VkDevice m_device = VK_NULL_HANDLE;
         VkPhysicalDevice m_phys = VK_NULL_HANDLE;
         VkQueue m_graphicsQueue = VK_NULL_HANDLE;
         uint32_t m_graphicsQueueFamilyIndex = 0;
+        VkQueue m_transferQueue = VK_NULL_HANDLE;
+        uint32_t m_transferQueueFamilyIndex = 0;
+
+        GeometryArena m_geometry;
 
-        // Separate ID spaces
-        uint64_t m_nextMeshID = 1;
-        uint64_t m_nextTextureID = 1;
-        uint64_t m_nextMaterialID = 1;
-        uint64_t m_nextModelID = 1;
+        static uint32_t allocateIndex(std::vector<uint64_t> &byIndex, std::vector<uint32_t> &freeIndices, uint64_t id);
 
         // ---------------------------
         // Mesh entries
@@ -83,9 +307,9 @@ namespace Engine
         struct MeshEntry
         {
             std::unique_ptr<MeshAsset> asset;
-            uint32_t generation = 1;
             uint32_t refCount = 0;
             std::string path;
+            uint64_t contentHash = 0; // key in m_meshByContent once shared, 0 = never shared
         };
 
         // ---------------------------
@@ -94,11 +318,16 @@ namespace Engine
         struct TextureEntry
         {
             std::unique_ptr<TextureAsset> asset;
-            uint32_t generation = 1;
             uint32_t refCount = 0;
+            uint32_t index = kInvalidIndex; // see getTextureIndex()
+            std::unique_ptr<TextureStream> stream; // null: every mip resident for good
+            uint64_t contentHash = 0; // key in m_textureByContent once shared, 0 = never shared
         };
 
-        std::unordered_map<uint64_t, TextureEntry> m_textures;
+        // Entries live in generational slot maps: handle.id is the slot, handle.generation guards reuse
+        SlotMap<TextureEntry> m_textures;
+        std::vector<uint64_t> m_textureByIndex; // texture id per index, 0 = free
+        std::vector<uint32_t> m_freeTextureIndices;
 
         // ---------------------------
         // Material entries
@@ -106,14 +335,18 @@ namespace Engine
         struct MaterialEntry
         {
             std::unique_ptr<MaterialAsset> asset;
-            uint32_t generation = 1;
             uint32_t refCount = 0;
 
             // Dependencies: textures referenced by this material
             std::vector<TextureHandle> textureDeps;
+
+            uint32_t index = kInvalidIndex; // see getMaterialIndex()
         };
 
-        std::unordered_map<uint64_t, MaterialEntry> m_materials;
+        SlotMap<MaterialEntry> m_materials;
+        std::vector<uint64_t> m_materialByIndex; // material id per index, 0 = free
+        std::vector<uint32_t> m_freeMaterialIndices;
+        uint64_t m_bindlessVersion = 0;
 
         // ---------------------------
         // Model entries
@@ -121,20 +354,45 @@ namespace Engine
         struct ModelEntry
         {
             std::unique_ptr<ModelAsset> asset;
-            uint32_t generation = 1;
             uint32_t refCount = 0;
             std::string path;
 
             // Dependencies: meshes + materials used by this model
             std::vector<MeshHandle> meshDeps;
             std::vector<MaterialHandle> materialDeps;
+
+            // Meshlet tables in the geometry arena (V7); freed with the model.
+            GeometryArena::Range meshletRange;
+
+            // loadModelAsync(): asset is null until Ready
+            LoadState state = LoadState::Ready;
         };
 
-        std::unordered_map<uint64_t, MeshEntry> m_meshes;
+        SlotMap<MeshEntry> m_meshes;
         std::unordered_map<std::string, MeshHandle> m_meshPathCache;
 
-        std::unordered_map<uint64_t, ModelEntry> m_models;
+        SlotMap<ModelEntry> m_models;
         std::unordered_map<std::string, ModelHandle> m_modelPathCache;
+
+        // Content dedup: shared model textures and meshes by content hash
+        std::unordered_map<uint64_t, TextureHandle> m_textureByContent;
+        std::unordered_map<uint64_t, MeshHandle> m_meshByContent;
+        uint64_t m_dedupTextureHits = 0;
+        uint64_t m_dedupMeshHits = 0;
+        uint64_t m_dedupBytesSkipped = 0;
+
+        // Asynchronous loads: streaming workers (created by the first loadModelAsync()) and the loads
+        // not finished yet, in request order
+        std::unique_ptr<JobSystem> m_streamJobs;
+        std::vector<std::unique_ptr<PendingModel>> m_pendingModels;
+
+        // Texture streaming
+        uint64_t m_textureBudget = kDefaultTextureBudget;
+        uint64_t m_textureUpdate = 0; // update() calls
+        uint64_t m_requestedTextureBytes = 0;
+        uint64_t m_mipsStreamedIn = 0;
+        uint64_t m_mipsEvicted = 0;
+        std::unique_ptr<TextureStreamUpload> m_textureStream;
     };
 
 } // namespace Engine
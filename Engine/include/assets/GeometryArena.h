@@ -0,0 +1,85 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include "utils/MemoryAllocator.h"
+
+namespace Engine
+{
+
+    // Shared device-local vertex and index storage for every MeshAsset (owned by AssetManager),
+    // plus the per-model meshlet tables the GPU culling shaders read.
+    // Each kind is a list of large blocks; a mesh gets one range per kind, first-fit from the
+    // block free lists, so most meshes share one vertex and one index buffer and draws address
+    // them through firstIndex/vertexOffset. A mesh larger than a block gets a block of its own.
+    // Blocks are never resized, so buffers and offsets stay valid while a range is allocated.
+    class GeometryArena
+    {
+    public:
+        enum Kind : uint32_t
+        {
+            Vertex = 0,
+            Index = 1,
+            Meshlet = 2, // storage buffer: meshlet records and their vertex/triangle tables
+            KindCount = 3
+        };
+
+        struct Range
+        {
+            uint32_t block = UINT32_MAX;
+            VkDeviceSize offset = 0; // bytes into the block buffer
+            VkDeviceSize size = 0;
+            bool isValid() const { return block != UINT32_MAX; }
+        };
+
+        static constexpr VkDeviceSize kVertexBlockBytes = VkDeviceSize(64) << 20;
+        static constexpr VkDeviceSize kIndexBlockBytes = VkDeviceSize(32) << 20;
+        static constexpr VkDeviceSize kMeshletBlockBytes = VkDeviceSize(16) << 20;
+
+        GeometryArena() = default;
+        ~GeometryArena() = default;
+
+        void init(VkDevice device, VkPhysicalDevice phys);
+        void destroy();
+
+        // 'alignment' need not be a power of two (vertex ranges align to the vertex stride so
+        // offset / stride is the draw's vertexOffset). Returns an invalid range on failure.
+        Range allocate(Kind kind, VkDeviceSize size, VkDeviceSize alignment);
+        void free(Kind kind, Range &range);
+
+        // Frees the memory of blocks with nothing allocated, keeping the first block of each kind.
+        void releaseEmptyBlocks();
+
+        VkBuffer getBuffer(Kind kind, uint32_t block) const;
+
+        // Stats
+        uint32_t getBlockCount(Kind kind) const;
+        VkDeviceSize getCapacityBytes(Kind kind) const;
+        VkDeviceSize getUsedBytes(Kind kind) const { return m_used[kind]; }
+
+    private:
+        struct Span
+        {
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+        };
+
+        struct Block
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            MemoryAllocation memory;
+            VkDeviceSize size = 0;
+            std::vector<Span> free; // sorted by offset, neighbours merged
+        };
+
+        bool createBlock(Kind kind, VkDeviceSize size, Block &out);
+        static bool allocateFromBlock(Block &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &outOffset);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_phys = VK_NULL_HANDLE;
+
+        std::vector<Block> m_blocks[KindCount]; // released blocks stay as empty slots (buffer == null)
+        VkDeviceSize m_used[KindCount] = {};
+    };
+
+} // namespace Engine
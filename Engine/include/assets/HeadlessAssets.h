@@ -0,0 +1,67 @@
+#pragma once
+/*
+  HeadlessAssets.h
+  ----------------
+  Purpose:
+    - The model library of a headless (server) world: CPU model data only (nodes, clips, bounds;
+      see ModelData.h), no device, no streaming workers, no GPU upload.
+
+  Usage:
+    - Engine::HeadlessAssets assets;
+    - instantiatePrefab(def, ecs.components, ecs.archetypes, assets);  // IModelProvider
+    - animation.setModelProvider(&assets);
+    - if (const ModelAsset *m = assets.modelData(handle)) { m->animClips ... }
+
+  Notes:
+    - Loads are synchronous: loadModelAsync() returns a handle that is already ready (or invalid
+      when the file does not load).
+    - Model data is shared by every HeadlessAssets in the process (by path, read-only), so many
+      matches of one server cost one copy of each model; it is freed with its last user.
+    - One instance per world: an instance is not thread-safe, but instances on different threads
+      are independent.
+*/
+
+#include "assets/ModelProvider.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    class HeadlessAssets final : public IModelProvider
+    {
+    public:
+        HeadlessAssets() = default;
+        HeadlessAssets(const HeadlessAssets &) = delete;
+        HeadlessAssets &operator=(const HeadlessAssets &) = delete;
+
+        // The cached handle if the path is loaded; an invalid handle if the file fails to load
+        ModelHandle loadModel(const std::string &cookedModelPath);
+        ModelHandle loadModelAsync(const std::string &cookedModelPath) override { return loadModel(cookedModelPath); }
+
+        const ModelAsset *modelData(ModelHandle h) const override;
+
+        // The path the model was loaded from; empty for an unknown handle.
+        const std::string &getModelPath(ModelHandle h) const;
+        uint32_t modelCount() const { return static_cast<uint32_t>(m_models.size()); }
+
+        // Distinct models alive across all instances in the process
+        static uint32_t sharedModelCount();
+
+    private:
+        struct Entry
+        {
+            std::string path;
+            std::shared_ptr<const ModelAsset> model;
+        };
+
+        const Entry *find(ModelHandle h) const;
+
+        std::vector<Entry> m_models;                          // handle id - 1
+        std::unordered_map<std::string, ModelHandle> m_byPath; // failed paths map to an invalid handle
+    };
+
+} // namespace Engine
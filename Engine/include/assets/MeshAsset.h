@@ -2,44 +2,86 @@
 #include <vulkan/vulkan.h>
 #include <cstdint>
 #include "assets/MeshFormats.h"
+#include "assets/GeometryArena.h"
 #include "utils/BufferUtils.h"
 
 namespace Engine
 {
+    struct UploadContext; // forward decl from ImageUtils
 
-    // GPU-backed mesh asset: owns device-local vertex/index buffers and metadata
+    // GPU-backed mesh asset: a vertex range and an index range of the AssetManager's
+    // GeometryArena, plus metadata. Draws bind the arena buffers at offset 0 and address the
+    // mesh through getFirstIndex()/getVertexOffset().
     class MeshAsset
     {
     public:
         MeshAsset() = default;
         ~MeshAsset() = default;
 
-        // Upload MeshData into device-local buffers using staging.
+        // Upload MeshData into arena ranges using staging.
         // Requires a command pool and queue for the copy operations.
         bool upload(VkDevice device,
                     VkPhysicalDevice phys,
                     VkCommandPool commandPool,
                     VkQueue queue,
+                    GeometryArena &arena,
                     const MeshData &data);
 
-        // Destroy GPU resources
-        void destroy(VkDevice device);
+        // Same, with the copies recorded into 'ctx' (staging kept in ctx.pendingStaging, NO submit):
+        // the ranges hold the data once the upload context has been submitted and has completed.
+        bool upload_Deferred(UploadContext &ctx, GeometryArena &arena, const MeshData &data);
+        // Same, with the bytes read from caller memory (e.g. a mapped .smodel blob) instead of
+        // data.vertexBytes / data.indices*: 'data' only supplies the counts, formats and bounds.
+        // The bytes are copied once, straight into the staging memory.
+        bool upload_Deferred(UploadContext &ctx, GeometryArena &arena, const MeshData &data,
+                             const void *vertexBytes, const void *indexBytes);
+        // Same, with either stream stored by the mesh codec (MeshCodec.h) when its encoded size is
+        // not 0: such a stream is decoded straight into the staging memory.
+        bool upload_Deferred(UploadContext &ctx, GeometryArena &arena, const MeshData &data,
+                             const void *vertexBytes, size_t vertexEncodedSize,
+                             const void *indexBytes, size_t indexEncodedSize);
+
+        // Return the ranges to the arena
+        void destroy();
 
         // Accessors for rendering
-        VkBuffer getVertexBuffer() const { return m_vb.buffer; }
-        VkBuffer getIndexBuffer() const { return m_ib.buffer; }
+        VkBuffer getVertexBuffer() const { return m_vb; }
+        VkBuffer getIndexBuffer() const { return m_ib; }
         uint32_t getIndexCount() const { return m_indexCount; }
         VkIndexType getIndexType() const { return m_indexType; }
+        uint32_t getFirstIndex() const { return m_firstIndex; }    // of the mesh's first index in getIndexBuffer()
+        int32_t getVertexOffset() const { return m_vertexOffset; } // of the mesh's first vertex in getVertexBuffer()
+        // Same value for meshes that bind the same buffers and index type.
+        uint64_t getGeometryKey() const
+        {
+            return (static_cast<uint64_t>(m_vertexRange.block) << 33) | (static_cast<uint64_t>(m_indexRange.block) << 1) |
+                   (m_indexType == VK_INDEX_TYPE_UINT32 ? 1u : 0u);
+        }
         const float *getAABBMin() const { return m_aabbMin; }
         const float *getAABBMax() const { return m_aabbMax; }
 
+        // Quantized vertices (smodel VTX_COMPACT): position = xyz + unorm16 position * w.
+        bool isCompact() const { return m_compact; }
+        const float *getPositionDequant() const { return m_positionDequant; }
+
     private:
-        VertexBufferHandle m_vb{};
-        IndexBufferHandle m_ib{};
+        // Takes the uploaded ranges and the mesh metadata
+        void assignRanges(GeometryArena &arena, const GeometryArena::Range &vertexRange, const GeometryArena::Range &indexRange,
+                          VkIndexType indexType, const MeshData &data);
+
+        GeometryArena *m_arena = nullptr;
+        GeometryArena::Range m_vertexRange{};
+        GeometryArena::Range m_indexRange{};
+        VkBuffer m_vb = VK_NULL_HANDLE;
+        VkBuffer m_ib = VK_NULL_HANDLE;
         uint32_t m_indexCount = 0;
+        uint32_t m_firstIndex = 0;
+        int32_t m_vertexOffset = 0;
         VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
         float m_aabbMin[3]{};
         float m_aabbMax[3]{};
+        bool m_compact = false;
+        float m_positionDequant[4] = {0.0f, 0.0f, 0.0f, 1.0f};
     };
 
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine::meshcodec
+{
+    // ============================================================
+    // Vertex / index stream codec (.smesh v1, .smodel V9)
+    // ============================================================
+    // Lossless, byte-oriented codecs in the style of meshoptimizer's: the cook tools encode
+    // (tools/common/MeshCompress.h), the runtime decodes straight into staging memory. Both are
+    // meant to run after vertex cache / fetch optimization, which is what makes neighbouring
+    // vertices and indices close.
+    //
+    // Vertex stream: kVertexCodecHeader, then blocks of VertexBlockSize(stride) vertices (the last
+    // one shorter). A block holds, for each byte k of the stride in turn, the byte deltas of
+    // vertex byte k against the previous vertex (zigzagged, the first vertex against zero) in
+    // groups of kVertexGroupSize:
+    //   - ceil(groups / 4) header bytes, 2 bits per group: 0 all zero (no data), 1 2-bit values
+    //     (4 bytes), 2 4-bit values (8 bytes), 3 raw bytes (16 bytes)
+    //   - the groups' data; value i of a packed group sits at bit (i * bits) % 8 of byte
+    //     i * bits / 8. The last group of a block is zero padded.
+    //
+    // Index stream: kIndexCodecHeader, then one LEB128 varint per index: (zigzag(delta) << 1) | b,
+    // delta against baseline b of two (each starts at 0, and takes the index it decoded), which
+    // keeps triangle strips through a vertex-cache-ordered list small.
+
+    static constexpr uint8_t kVertexCodecHeader = 0xA0; // low nibble: codec version (0)
+    static constexpr uint8_t kIndexCodecHeader = 0xD0;
+
+    static constexpr uint32_t kVertexGroupSize = 16;
+    static constexpr uint32_t kVertexBlockMaxVertices = 256;
+    static constexpr uint32_t kVertexBlockMaxBytes = 8192; // block working set
+    static constexpr uint32_t kMaxVertexStride = 256;
+
+    // Vertices per block for 'stride': a multiple of kVertexGroupSize.
+    inline uint32_t VertexBlockSize(uint32_t stride)
+    {
+        uint32_t count = (kVertexBlockMaxBytes / (stride ? stride : 1u)) & ~(kVertexGroupSize - 1u);
+        if (count < kVertexGroupSize)
+            count = kVertexGroupSize;
+        return count < kVertexBlockMaxVertices ? count : kVertexBlockMaxVertices;
+    }
+
+    // Decodes 'vertexCount' vertices of 'stride' bytes (at most kMaxVertexStride) into 'dst'.
+    // False when 'src' is not a complete vertex stream of that shape.
+    bool DecodeVertexBuffer(void *dst, size_t vertexCount, size_t stride, const uint8_t *src, size_t srcSize);
+
+    // Decodes 'indexCount' indices of 'indexSize' bytes (2 or 4) into 'dst'.
+    bool DecodeIndexBuffer(void *dst, size_t indexCount, size_t indexSize, const uint8_t *src, size_t srcSize);
+
+} // namespace Engine::meshcodec
@@ -6,7 +6,7 @@
 namespace Engine
 {
 
-    // Minimal header for .smesh (no magic/version)
+    // Minimal header for .smesh (no magic/version); still loaded, no longer written
     struct SMeshHeaderV0
     {
         uint32_t vertexCount;
@@ -19,6 +19,46 @@ namespace Engine
         uint32_t indexDataOffset;
     };
 
+    // ============================================================
+    // .smesh v1
+    // ============================================================
+    // SMeshHeaderV1, then the vertex and index sections, each starting on a 16-byte boundary so a
+    // mapped file can be read in place. Either section may be stored by the mesh codec
+    // (MeshCodec.h, flags below); its size is then the encoded size. A v0 file has no magic: its
+    // first word is the vertex count, which never reaches SMESH_MAGIC.
+
+    // 'SMSH' little-endian magic
+    static constexpr uint32_t SMESH_MAGIC = 0x48534D53;
+    static constexpr uint16_t SMESH_VERSION_MAJOR = 1;
+    static constexpr uint16_t SMESH_VERSION_MINOR = 0;
+    static constexpr uint32_t SMESH_SECTION_ALIGNMENT = 16;
+
+    enum SMeshFlags : uint32_t
+    {
+        SMESH_VERTEX_CODEC = (1u << 0), // vertex section is a meshcodec vertex stream
+        SMESH_INDEX_CODEC = (1u << 1),  // index section is a meshcodec index stream
+    };
+
+    struct SMeshHeaderV1
+    {
+        uint32_t magic;        // SMESH_MAGIC
+        uint16_t versionMajor; // 1
+        uint16_t versionMinor; // 0
+        uint32_t headerSize;   // sizeof(SMeshHeaderV1); sections follow at 16-byte aligned offsets
+        uint32_t flags;        // SMeshFlags
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t vertexStride; // 32 (pos3, norm3, uv2)
+        uint32_t indexFormat;  // 0=uint16, 1=uint32
+        float aabbMin[3];
+        float aabbMax[3];
+        uint64_t vertexDataOffset; // from file start
+        uint64_t vertexDataSize;   // stored bytes
+        uint64_t indexDataOffset;
+        uint64_t indexDataSize;
+    };
+    static_assert(sizeof(SMeshHeaderV1) == 88, "SMeshHeaderV1 size mismatch");
+
     struct MeshData
     {
         std::vector<uint8_t> vertexBytes; // size = vertexCount * vertexStride
@@ -28,11 +68,12 @@ namespace Engine
         uint32_t indexCount = 0;
         uint32_t vertexStride = 0;
         uint32_t indexFormat = 1;
+        bool compactVertices = false; // smodel VTX_COMPACT layout; positions relative to the AABB
         float aabbMin[3]{};
         float aabbMax[3]{};
     };
 
-    // Returns true on success, fills MeshData
-    bool LoadSMeshV0FromFile(const std::string &path, MeshData &out);
+    // Loads a .smesh (v1, or v0 without a magic); returns true on success, fills MeshData
+    bool LoadSMeshFromFile(const std::string &path, MeshData &out);
 
 } // namespace Engine
\ No newline at end of file
@@ -3,12 +3,13 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
-#include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "assets/Handles.h" // MeshHandle, MaterialHandle
 #include "assets/model/SModelAnimationRecords.h"
+#include "assets/model/SModelAnimationCodec.h"
+#include "utils/SimdKernels.h"
 
 namespace Engine
 {
@@ -22,13 +23,65 @@ namespace Engine
         MeshHandle mesh{};
         MaterialHandle material{};
 
+        // Absolute in the geometry arena buffers the mesh lives in (AssetManager rebases them at load).
         uint32_t firstIndex = 0;
         uint32_t indexCount = 0;
         int32_t vertexOffset = 0;
 
         // Skinning (V4): -1 means unskinned.
         int32_t skinIndex = -1;
+
+        // Mesh LODs: next coarser version of this primitive (index into ModelAsset::primitives,
+        // 0 = none). LOD primitives themselves are only reached through this chain.
+        uint32_t lodNext = 0;
+        bool isLod = false;
+
+        // Meshlets (V7): records [firstMeshlet, firstMeshlet + meshletCount) of the model's meshlet
+        // range (MeshletGpu, absolute in the arena's meshlet block). LOD primitives have none.
+        uint32_t firstMeshlet = 0;
+        uint32_t meshletCount = 0;
+    };
+
+    // GPU meshlet record, as the culling and mesh shaders read it (smodel_cull.comp, smodel.task,
+    // smodel.mesh). A model's meshlet range holds [MeshletGpu x N][vertex words][triangle words]:
+    // vertex words are mesh-relative vertex indices, triangle words pack three local indices as
+    // a | b << 8 | c << 16. vertexFirst/triangleFirst are absolute word indices into the block.
+    struct MeshletGpu
+    {
+        float center[3];
+        float radius;
+        float coneAxis[3];
+        float coneCutoff;
+        float coneApex[3];
+        uint32_t firstIndex; // relative to the primitive's firstIndex
+        uint32_t vertexFirst;
+        uint32_t triangleFirst;
+        uint32_t vertexCount;
+        uint32_t triangleCount;
     };
+    static_assert(sizeof(MeshletGpu) == 64, "MeshletGpu must match the meshlet shaders");
+
+    // Palette entry for node globals and joint matrices: the top three rows of an affine mat4
+    // (the fourth row is always 0 0 0 1). 48 bytes; matches smodel.vert's Affine.
+    struct PaletteMatrix
+    {
+        float rows[3][4];
+
+        static inline PaletteMatrix fromMat4(const glm::mat4 &m)
+        {
+            PaletteMatrix out;
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 4; ++c)
+                    out.rows[r][c] = m[c][r];
+            return out;
+        }
+
+        static inline PaletteMatrix identity()
+        {
+            return PaletteMatrix{{{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}}};
+        }
+    };
+    static_assert(sizeof(PaletteMatrix) == 48, "PaletteMatrix must match smodel.vert Affine");
 
     struct ModelAsset
     {
@@ -48,8 +101,43 @@ namespace Engine
             glm::vec3 s{1.0f, 1.0f, 1.0f};
         };
 
+        // Last key interval per sampler (indexed like animSamplers). Sampling that moves forward in
+        // time steps on from it instead of binary searching; reset when used with another model.
+        struct KeyCursor
+        {
+            const ModelAsset *asset = nullptr;
+            std::vector<uint32_t> keys;
+        };
+
+        // Scratch for evaluatePoseInto(), indexed by animated slot (position in animatedNodes):
+        // TRS lanes for Simd::composeTRS, rotation keys for Simd::nlerpQuat, and local matrices.
+        static constexpr uint32_t kTrsLanes = 10;   // t.xyz, r.xyzw, s.xyz
+        static constexpr uint32_t kRotKeyLanes = 9; // q0.xyzw, q1.xyzw, blend
+        struct PoseScratch
+        {
+            std::vector<float> trs;         // kTrsLanes x animatedNodes.size()
+            std::vector<float> rotKeys;     // kRotKeyLanes x clip channel count
+            std::vector<uint32_t> rotSlots; // animated slot of each sampled rotation
+            std::vector<glm::mat4> locals;
+        };
+
         std::vector<ModelPrimitive> primitives;
 
+        // Arena block (GeometryArena::Meshlet) holding the primitives' meshlets; UINT32_MAX = none.
+        uint32_t meshletBlock = UINT32_MAX;
+
+        // Longest mesh LOD chain (1 = full resolution only), capped at kMaxMeshLods.
+        static constexpr uint32_t kMaxMeshLods = 4;
+        uint32_t meshLodCount = 1;
+
+        // Primitive drawn for 'primIndex' at mesh LOD 'lod' (the coarsest one when the chain is shorter).
+        uint32_t lodPrimitive(uint32_t primIndex, uint32_t lod) const
+        {
+            for (; lod > 0 && primitives[primIndex].lodNext != 0; --lod)
+                primIndex = primitives[primIndex].lodNext;
+            return primIndex;
+        }
+
         // Node graph
         struct ModelNode
         {
@@ -71,6 +159,11 @@ namespace Engine
         std::vector<uint32_t> nodeChildIndices;
         uint32_t rootNodeIndex{0};
 
+        // Evaluation order built by buildNodeOrder(): every node after its parent, so globals are
+        // one forward loop. nodeOrderParent[k] is the parent of nodeOrder[k] (~0u for roots).
+        std::vector<uint32_t> nodeOrder;
+        std::vector<uint32_t> nodeOrderParent;
+
         // ------------------------------------------------------------
         // Skinning (V4)
         // ------------------------------------------------------------
@@ -92,15 +185,49 @@ namespace Engine
         // Animations (node TRS only, no skinning yet)
         // ------------------------------------------------------------
         AnimationState animState;
+        KeyCursor animCursor;               // updateAnimation()
+        PoseScratch animScratch;            // updateAnimation()
+        std::vector<glm::mat4> animGlobals; // updateAnimation()
 
         std::vector<NodeTRS> restTRS;     // bind pose derived from localMatrix at load
         std::vector<NodeTRS> animatedTRS; // evaluated each frame
 
+        // Built by buildPoseCache(): ComposeTRS(restTRS) per node, and which nodes any clip channel
+        // targets. Only those are re-sampled and re-composed by evaluatePoseInto().
+        // animatedSlot[node] is the node's index in animatedNodes (~0u when not animated).
+        // animatedOptional[slot] marks leaf nodes without primitives (finger tips, helper bones):
+        // reduced-detail evaluation leaves them at rest.
+        std::vector<glm::mat4> restLocal;
+        std::vector<uint32_t> animatedSlot;
+        std::vector<uint32_t> animatedNodes;
+        std::vector<uint8_t> animatedOptional;
+
+        // Also built by buildPoseCache(): nodes drawn with at least one unskinned primitive, the only
+        // node globals the renderer uploads. Node palettes are flattened as [pose][renderedNodes.size()];
+        // renderedSlot[node] is the node's entry (~0u when only skinned primitives, or none, hang off it).
+        std::vector<uint32_t> renderedNodes;
+        std::vector<uint32_t> renderedSlot;
+
+        // Baked animation (bakeAnimations): every clip sampled at bakedFps into rendered node globals
+        // and joint matrices, flattened as [frame][rendered node] and [frame][totalJointCount]. Clip c owns frames
+        // bakedClips[c].firstFrame .. firstFrame + frameCount - 1.
+        struct BakedClip
+        {
+            uint32_t firstFrame = 0;
+            uint32_t frameCount = 0;
+        };
+
+        float bakedFps = 0.0f;
+        uint32_t bakedFrameCount = 0;
+        std::vector<BakedClip> bakedClips;
+        std::vector<PaletteMatrix> bakedNodeGlobals;
+        std::vector<PaletteMatrix> bakedJoints;
+
         std::vector<smodel::SModelAnimationClipRecord> animClips;
         std::vector<smodel::SModelAnimationChannelRecord> animChannels;
         std::vector<smodel::SModelAnimationSamplerRecord> animSamplers;
         std::vector<float> animTimes;
-        std::vector<float> animValues;
+        std::vector<float> animValues; // 32-bit words; packed samplers stay packed (SModelAnimationCodec.h)
 
         // Optional debug name (string table later)
         const char *debugName = "";
@@ -114,6 +241,34 @@ namespace Engine
         float center[3]{0.0f, 0.0f, 0.0f};
         float fitScale = 1.0f;
 
+        // CPU bytes held by the model (vector capacities), for MemoryTracker: the primitive and node
+        // data, and separately everything animation owns (clips, baked palettes, pose cache, scratch).
+        inline uint64_t cpuBytes() const
+        {
+            uint64_t bytes = VectorBytes(primitives) + VectorBytes(nodes) + VectorBytes(nodePrimitiveIndices) +
+                             VectorBytes(nodeChildIndices) + VectorBytes(nodeOrder) + VectorBytes(nodeOrderParent) +
+                             VectorBytes(renderedNodes) + VectorBytes(renderedSlot) + VectorBytes(skins);
+            for (const ModelSkin &skin : skins)
+                bytes += VectorBytes(skin.jointNodeIndices) + VectorBytes(skin.inverseBind);
+            return bytes;
+        }
+
+        inline uint64_t animationBytes() const
+        {
+            return VectorBytes(animClips) + VectorBytes(animChannels) + VectorBytes(animSamplers) + VectorBytes(animTimes) +
+                   VectorBytes(animValues) + VectorBytes(bakedClips) + VectorBytes(bakedNodeGlobals) + VectorBytes(bakedJoints) +
+                   VectorBytes(restTRS) + VectorBytes(animatedTRS) + VectorBytes(restLocal) + VectorBytes(animatedSlot) +
+                   VectorBytes(animatedNodes) + VectorBytes(animatedOptional) + VectorBytes(animCursor.keys) +
+                   VectorBytes(animScratch.trs) + VectorBytes(animScratch.rotKeys) + VectorBytes(animScratch.rotSlots) +
+                   VectorBytes(animScratch.locals) + VectorBytes(animGlobals);
+        }
+
+        template <typename T>
+        static uint64_t VectorBytes(const std::vector<T> &v)
+        {
+            return static_cast<uint64_t>(v.capacity()) * sizeof(T);
+        }
+
         static inline glm::mat4 ComposeTRS(const NodeTRS &x)
         {
             glm::mat4 T = glm::translate(glm::mat4(1.0f), x.t);
@@ -143,6 +298,31 @@ namespace Engine
             return lo;
         }
 
+        // FindKeyInterval starting from a previous result: a few forward steps when t did not go
+        // back (the common case between frames), binary search on loops, seeks or large jumps.
+        static inline uint32_t FindKeyIntervalFrom(const float *times, uint32_t count, float t, uint32_t &cursor)
+        {
+            constexpr uint32_t kMaxForwardSteps = 4;
+            if (count <= 1)
+                return 0;
+            if (t <= times[0])
+                return cursor = 0;
+            if (t >= times[count - 2])
+                return cursor = count - 2;
+
+            uint32_t i = cursor;
+            if (i < count - 2 && times[i] <= t)
+            {
+                for (uint32_t step = 0; step < kMaxForwardSteps; ++step)
+                {
+                    if (times[i + 1] > t)
+                        return cursor = i;
+                    ++i; // i + 1 <= count - 2 since t < times[count - 2]
+                }
+            }
+            return cursor = FindKeyInterval(times, count, t);
+        }
+
         static inline float ComputeAlpha(float t0, float t1, float t)
         {
             float dt = t1 - t0;
@@ -156,93 +336,269 @@ namespace Engine
             return a;
         }
 
-        static inline glm::vec3 SampleVec3(const float *times, const float *values, uint32_t keyCount, float t)
+        // 'valueType' is the sampler's SModelAnimValueType (raw Vec3 or packed Vec3Range).
+        static inline glm::vec3 SampleVec3(const float *times, const float *values, uint8_t valueType, uint32_t keyCount,
+                                           float t, uint32_t *cursor = nullptr)
         {
+            float v0[3], v1[3];
             if (keyCount == 0)
                 return glm::vec3(0.0f);
             if (keyCount == 1)
-                return glm::vec3(values[0], values[1], values[2]);
+            {
+                smodel::decodeVec3Key(valueType, values, 0, v0);
+                return glm::vec3(v0[0], v0[1], v0[2]);
+            }
 
-            uint32_t i = FindKeyInterval(times, keyCount, t);
+            uint32_t i = cursor ? FindKeyIntervalFrom(times, keyCount, t, *cursor) : FindKeyInterval(times, keyCount, t);
             float t0 = times[i];
             float t1 = times[i + 1];
             float a = ComputeAlpha(t0, t1, t);
 
-            const float *v0 = values + i * 3;
-            const float *v1 = values + (i + 1) * 3;
+            smodel::decodeVec3Key(valueType, values, i, v0);
+            smodel::decodeVec3Key(valueType, values, i + 1, v1);
             glm::vec3 p0(v0[0], v0[1], v0[2]);
             glm::vec3 p1(v1[0], v1[1], v1[2]);
             return glm::mix(p0, p1, a);
         }
 
-        static inline glm::quat SampleQuat(const float *times, const float *values, uint32_t keyCount, float t)
+        // Parents-before-children order from the child lists (supports any node ordering).
+        inline void buildNodeOrder()
         {
-            if (keyCount == 0)
-                return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-            if (keyCount == 1)
+            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+            const uint32_t U32_MAX = ~0u;
+
+            nodeOrder.clear();
+            nodeOrderParent.clear();
+            nodeOrder.reserve(nodeCount);
+            nodeOrderParent.reserve(nodeCount);
+
+            std::vector<uint8_t> visited(nodeCount, 0);
+            std::vector<std::pair<uint32_t, uint32_t>> stack; // (node, parent)
+
+            for (uint32_t root = 0; root < nodeCount; ++root)
             {
-                const float *v = values;
-                glm::quat q(v[3], v[0], v[1], v[2]); // stored XYZW
-                return glm::normalize(q);
+                if (nodes[root].parentIndex != U32_MAX)
+                    continue;
+
+                stack.emplace_back(root, U32_MAX);
+                while (!stack.empty())
+                {
+                    const auto [nodeIdx, parentIdx] = stack.back();
+                    stack.pop_back();
+                    if (nodeIdx >= nodeCount || visited[nodeIdx])
+                        continue;
+                    visited[nodeIdx] = 1;
+
+                    nodeOrder.push_back(nodeIdx);
+                    nodeOrderParent.push_back(parentIdx);
+
+                    const ModelNode &n = nodes[nodeIdx];
+                    if (n.childCount == 0 || n.firstChildIndex == U32_MAX)
+                        continue;
+
+                    // Reverse push keeps the depth-first child order of the file.
+                    for (uint32_t ci = n.childCount; ci-- > 0;)
+                    {
+                        const uint32_t slot = n.firstChildIndex + ci;
+                        if (slot < nodeChildIndices.size())
+                            stack.emplace_back(nodeChildIndices[slot], nodeIdx);
+                    }
+                }
             }
+        }
 
-            uint32_t i = FindKeyInterval(times, keyCount, t);
-            float t0 = times[i];
-            float t1 = times[i + 1];
-            float a = ComputeAlpha(t0, t1, t);
+        // Raw rotation keys to unit length, as the nlerp in evaluatePoseInto() expects (packed keys
+        // decode to unit length). Call once after load.
+        inline void normalizeRotationKeys()
+        {
+            for (const auto &ch : animChannels)
+            {
+                if (ch.path != (uint16_t)smodel::SModelAnimPath::Rotation || ch.samplerIndex >= animSamplers.size())
+                    continue;
+                const auto &s = animSamplers[ch.samplerIndex];
+                if (s.valueType != uint8_t(smodel::SModelAnimValueType::Quat) || s.firstValue + s.valueCount > animValues.size())
+                    continue;
 
-            const float *v0 = values + i * 4;
-            const float *v1 = values + (i + 1) * 4;
+                float *v = animValues.data() + s.firstValue;
+                for (uint32_t k = 0; k + 4 <= s.valueCount; k += 4)
+                {
+                    const float len2 = v[k] * v[k] + v[k + 1] * v[k + 1] + v[k + 2] * v[k + 2] + v[k + 3] * v[k + 3];
+                    if (len2 <= 0.0f)
+                        continue;
+                    const float inv = 1.0f / std::sqrt(len2);
+                    for (uint32_t c = 0; c < 4; ++c)
+                        v[k + c] *= inv;
+                }
+            }
+        }
 
-            glm::quat q0(v0[3], v0[0], v0[1], v0[2]);
-            glm::quat q1(v1[3], v1[0], v1[1], v1[2]);
+        // Rest local matrices and the set of animated nodes. Call after restTRS and animChannels are set.
+        inline void buildPoseCache()
+        {
+            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
 
-            q0 = glm::normalize(q0);
-            q1 = glm::normalize(q1);
+            restLocal.resize(nodeCount);
+            for (uint32_t i = 0; i < nodeCount; ++i)
+                restLocal[i] = (restTRS.size() == nodes.size()) ? ComposeTRS(restTRS[i]) : glm::mat4(1.0f);
 
-            if (glm::dot(q0, q1) < 0.0f)
-                q1 = -q1;
+            animatedSlot.assign(nodeCount, ~0u);
+            animatedNodes.clear();
+            animatedOptional.clear();
+            for (const auto &ch : animChannels)
+            {
+                if (ch.targetNode >= nodeCount || animatedSlot[ch.targetNode] != ~0u)
+                    continue;
+                animatedSlot[ch.targetNode] = static_cast<uint32_t>(animatedNodes.size());
+                animatedNodes.push_back(ch.targetNode);
+
+                const ModelNode &n = nodes[ch.targetNode];
+                animatedOptional.push_back((n.childCount == 0 && n.primitiveCount == 0) ? 1 : 0);
+            }
 
-            return glm::normalize(glm::slerp(q0, q1, a));
+            renderedSlot.assign(nodeCount, ~0u);
+            renderedNodes.clear();
+            for (uint32_t i = 0; i < nodeCount; ++i)
+            {
+                const ModelNode &n = nodes[i];
+                for (uint32_t k = 0; k < n.primitiveCount; ++k)
+                {
+                    const size_t ix = static_cast<size_t>(n.firstPrimitiveIndex) + k;
+                    if (ix >= nodePrimitiveIndices.size() || nodePrimitiveIndices[ix] >= primitives.size())
+                        continue;
+                    if (primitives[nodePrimitiveIndices[ix]].skinIndex >= 0)
+                        continue;
+                    renderedSlot[i] = static_cast<uint32_t>(renderedNodes.size());
+                    renderedNodes.push_back(i);
+                    break;
+                }
+            }
         }
 
-        inline void recomputeGlobals()
+        // Rendered node globals (renderedNodes order) out of a full set of 'globals'.
+        inline void gatherRenderedNodes(const glm::mat4 *globals, uint32_t globalCount, PaletteMatrix *out) const
+        {
+            for (size_t k = 0; k < renderedNodes.size(); ++k)
+            {
+                const uint32_t node = renderedNodes[k];
+                out[k] = (node < globalCount) ? PaletteMatrix::fromMat4(globals[node]) : PaletteMatrix::identity();
+            }
+        }
+
+        // Joint matrices (globals[joint node] * inverseBind) for every skin, indexed jointBase + j.
+        // 'out' must hold totalJointCount entries; joints with bad indices are left untouched.
+        inline void computeJointMatrices(const glm::mat4 *globals, uint32_t globalCount, PaletteMatrix *out) const
+        {
+            for (const auto &skin : skins)
+            {
+                for (uint32_t j = 0; j < skin.jointCount; ++j)
+                {
+                    if (j >= skin.jointNodeIndices.size() || j >= skin.inverseBind.size())
+                        continue;
+
+                    const uint32_t nodeIx = skin.jointNodeIndices[j];
+                    if (nodeIx >= globalCount)
+                        continue;
+
+                    const uint32_t outIx = skin.jointBase + j;
+                    if (outIx >= totalJointCount)
+                        continue;
+
+                    out[outIx] = PaletteMatrix::fromMat4(globals[nodeIx] * skin.inverseBind[j]);
+                }
+            }
+        }
+
+        inline bool hasBakedAnimation() const { return bakedFrameCount > 0; }
+
+        // Sample every clip at 'fps' (times 0, 1/fps, ..., duration). Skipped (bake cleared) when the
+        // tables would exceed 'maxMatrices' palette entries in total. Needs buildPoseCache().
+        inline void bakeAnimations(float fps, size_t maxMatrices)
         {
+            bakedFps = 0.0f;
+            bakedFrameCount = 0;
+            bakedClips.clear();
+            bakedNodeGlobals.clear();
+            bakedJoints.clear();
+
             const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
-            if (nodeCount == 0)
+            if (fps <= 0.0f || nodeCount == 0 || animClips.empty() || animChannels.empty())
                 return;
 
-            const uint32_t U32_MAX = ~0u;
-            std::vector<uint8_t> visited(nodeCount, 0);
+            size_t frames = 0;
+            bakedClips.resize(animClips.size());
+            for (size_t c = 0; c < animClips.size(); ++c)
+            {
+                const float duration = std::max(animClips[c].durationSec, 0.0f);
+                bakedClips[c].firstFrame = static_cast<uint32_t>(frames);
+                bakedClips[c].frameCount = static_cast<uint32_t>(std::ceil(duration * fps)) + 1u;
+                frames += bakedClips[c].frameCount;
+            }
 
-            std::function<void(uint32_t, const glm::mat4 &)> compute = [&](uint32_t nodeIdx, const glm::mat4 &parentGlobal)
+            const size_t renderedCount = renderedNodes.size();
+            if (frames * (renderedCount + totalJointCount) > maxMatrices)
             {
-                if (nodeIdx >= nodeCount)
-                    return;
-                if (visited[nodeIdx])
-                    return;
-                visited[nodeIdx] = 1;
-
-                ModelNode &n = nodes[nodeIdx];
-                n.globalMatrix = parentGlobal * n.localMatrix;
-
-                if (n.childCount == 0)
-                    return;
-                if (n.firstChildIndex == U32_MAX)
-                    return;
-
-                const uint32_t start = n.firstChildIndex;
-                for (uint32_t ci = 0; ci < n.childCount; ++ci)
+                bakedClips.clear();
+                return;
+            }
+
+            bakedNodeGlobals.resize(frames * renderedCount);
+            bakedJoints.assign(frames * totalJointCount, PaletteMatrix::identity());
+
+            PoseScratch scratch;
+            std::vector<glm::mat4> globals;
+            KeyCursor cursor;
+            for (size_t c = 0; c < animClips.size(); ++c)
+            {
+                const BakedClip &bc = bakedClips[c];
+                for (uint32_t f = 0; f < bc.frameCount; ++f)
                 {
-                    const uint32_t child = nodeChildIndices[start + ci];
-                    compute(child, n.globalMatrix);
+                    const float t = std::min(static_cast<float>(f) / fps, animClips[c].durationSec);
+                    evaluatePoseInto(static_cast<uint32_t>(c), t, scratch, globals, &cursor);
+
+                    const size_t frame = static_cast<size_t>(bc.firstFrame) + f;
+                    gatherRenderedNodes(globals.data(), nodeCount, bakedNodeGlobals.data() + frame * renderedCount);
+                    if (totalJointCount > 0)
+                        computeJointMatrices(globals.data(), nodeCount, bakedJoints.data() + frame * totalJointCount);
                 }
-            };
+            }
 
-            for (uint32_t i = 0; i < nodeCount; ++i)
+            bakedFps = fps;
+            bakedFrameCount = static_cast<uint32_t>(frames);
+        }
+
+        // Baked frames bracketing clip time 'timeSec' and the blend between them.
+        inline void bakedFramesAt(uint32_t clipIndex, float timeSec, uint32_t &frame0, uint32_t &frame1, float &blend) const
+        {
+            frame0 = frame1 = 0;
+            blend = 0.0f;
+            if (bakedClips.empty())
+                return;
+
+            const BakedClip &bc = bakedClips[std::min(clipIndex, static_cast<uint32_t>(bakedClips.size() - 1))];
+            if (bc.frameCount == 0)
+                return;
+
+            const float f = std::max(timeSec, 0.0f) * bakedFps;
+            const uint32_t last = bc.frameCount - 1u;
+            uint32_t i0 = static_cast<uint32_t>(std::min(std::floor(f), static_cast<float>(last)));
+            frame0 = bc.firstFrame + i0;
+            frame1 = bc.firstFrame + std::min(i0 + 1u, last);
+            blend = (i0 < last) ? (f - static_cast<float>(i0)) : 0.0f;
+        }
+
+        inline void recomputeGlobals()
+        {
+            if (nodes.empty())
+                return;
+            if (nodeOrder.empty())
+                buildNodeOrder();
+
+            const uint32_t U32_MAX = ~0u;
+            for (size_t k = 0; k < nodeOrder.size(); ++k)
             {
-                if (nodes[i].parentIndex == U32_MAX)
-                    compute(i, glm::mat4(1.0f));
+                ModelNode &n = nodes[nodeOrder[k]];
+                const uint32_t parent = nodeOrderParent[k];
+                n.globalMatrix = (parent == U32_MAX) ? n.localMatrix : nodes[parent].globalMatrix * n.localMatrix;
             }
         }
 
@@ -277,18 +633,112 @@ namespace Engine
                     animState.timeSec = duration;
             }
 
-            const float t = animState.timeSec;
+            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+            if (restLocal.size() != nodeCount || animatedSlot.size() != nodeCount)
+                return;
+
+            evaluatePoseInto(clipIndex, animState.timeSec, animScratch, animGlobals, &animCursor);
 
-            if (restTRS.size() == nodes.size())
+            const bool hasRest = (restTRS.size() == nodes.size());
+            animatedTRS.resize(nodeCount);
+            const uint32_t slotCount = static_cast<uint32_t>(animatedNodes.size());
+            const float *trs = animScratch.trs.data();
+            for (uint32_t i = 0; i < nodeCount; ++i)
             {
-                animatedTRS = restTRS;
+                const uint32_t slot = animatedSlot[i];
+                ModelNode &n = nodes[i];
+                n.globalMatrix = animGlobals[i];
+                if (slot == ~0u)
+                {
+                    n.localMatrix = restLocal[i];
+                    animatedTRS[i] = hasRest ? restTRS[i] : NodeTRS{};
+                    continue;
+                }
+
+                n.localMatrix = animScratch.locals[slot];
+                NodeTRS &x = animatedTRS[i];
+                x.t = glm::vec3(trs[0 * slotCount + slot], trs[1 * slotCount + slot], trs[2 * slotCount + slot]);
+                x.r = glm::quat(trs[6 * slotCount + slot], trs[3 * slotCount + slot], trs[4 * slotCount + slot],
+                                trs[5 * slotCount + slot]);
+                x.s = glm::vec3(trs[7 * slotCount + slot], trs[8 * slotCount + slot], trs[9 * slotCount + slot]);
+            }
+        }
+
+        // Evaluate clip at an explicit time into globalsOut (nodeCount matrices).
+        // This does not mutate nodes/local/global matrices, so it can be used per entity.
+        // Needs buildNodeOrder() and buildPoseCache(); unanimated nodes use their cached rest matrix.
+        // 'cursor' (optional) carries key positions between calls; cheapest when time moves forward.
+        // Rotations are blended with nlerp (shorter arc) and all animated nodes are composed in one
+        // batch by the Simd kernels. 'skipOptional' (animation LOD) leaves animatedOptional nodes at rest.
+        inline void evaluatePoseInto(uint32_t clipIndex, float timeSec, PoseScratch &scratch,
+                                     std::vector<glm::mat4> &globalsOut, KeyCursor *cursor = nullptr,
+                                     bool skipOptional = false) const
+        {
+            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+            globalsOut.assign(nodeCount, glm::mat4(1.0f));
+            if (nodeCount == 0 || restLocal.size() != nodes.size() || animatedSlot.size() != nodes.size())
+                return;
+
+            const uint32_t slotCount = static_cast<uint32_t>(animatedNodes.size());
+            scratch.locals.resize(slotCount);
+
+            if (slotCount > 0 && !animClips.empty() && !animSamplers.empty())
+            {
+                sampleAnimatedTRS(clipIndex, timeSec, scratch, cursor, skipOptional);
+                Simd::composeTRS(scratch.trs.data(), slotCount, slotCount, &scratch.locals[0][0].x);
             }
             else
             {
-                // Fallback: if restTRS not initialized, keep identity TRS.
-                animatedTRS.assign(nodes.size(), NodeTRS{});
+                for (uint32_t slot = 0; slot < slotCount; ++slot)
+                    scratch.locals[slot] = restLocal[animatedNodes[slot]];
+            }
+
+            const uint32_t U32_MAX = ~0u;
+            for (size_t k = 0; k < nodeOrder.size(); ++k)
+            {
+                const uint32_t node = nodeOrder[k];
+                const uint32_t parent = nodeOrderParent[k];
+                const uint32_t slot = animatedSlot[node];
+                const glm::mat4 &local = (slot != U32_MAX) ? scratch.locals[slot] : restLocal[node];
+                globalsOut[node] = (parent == U32_MAX) ? local : globalsOut[parent] * local;
+            }
+        }
+
+        // Fills scratch.trs (kTrsLanes lanes of animatedNodes.size()) with the rest pose overridden by
+        // the clip's channels at 'timeSec'. Rotation keys are gathered and blended in one nlerpQuat call.
+        inline void sampleAnimatedTRS(uint32_t clipIndex, float timeSec, PoseScratch &scratch, KeyCursor *cursor,
+                                      bool skipOptional) const
+        {
+            const uint32_t slotCount = static_cast<uint32_t>(animatedNodes.size());
+            scratch.trs.resize(static_cast<size_t>(kTrsLanes) * slotCount);
+            float *trs = scratch.trs.data();
+
+            // Start animated nodes from the rest pose.
+            const bool hasRest = (restTRS.size() == nodes.size());
+            for (uint32_t slot = 0; slot < slotCount; ++slot)
+            {
+                const NodeTRS &x = hasRest ? restTRS[animatedNodes[slot]] : NodeTRS{};
+                const float lanes[kTrsLanes] = {x.t.x, x.t.y, x.t.z, x.r.x, x.r.y, x.r.z, x.r.w, x.s.x, x.s.y, x.s.z};
+                for (uint32_t k = 0; k < kTrsLanes; ++k)
+                    trs[k * slotCount + slot] = lanes[k];
+            }
+
+            const uint32_t safeClip = std::min(clipIndex, static_cast<uint32_t>(animClips.size() - 1));
+            const auto &clip = animClips[safeClip];
+
+            if (cursor && (cursor->asset != this || cursor->keys.size() != animSamplers.size()))
+            {
+                cursor->asset = this;
+                cursor->keys.assign(animSamplers.size(), 0);
             }
 
+            const uint32_t keyStride = clip.channelCount;
+            scratch.rotKeys.resize(static_cast<size_t>(kRotKeyLanes) * keyStride);
+            scratch.rotSlots.resize(keyStride);
+            float *keys = scratch.rotKeys.data();
+            uint32_t rotCount = 0;
+
+            const float t = timeSec;
             const uint32_t clipFirst = clip.firstChannel;
             const uint32_t clipCount = clip.channelCount;
             for (uint32_t ci = 0; ci < clipCount; ci++)
@@ -301,8 +751,12 @@ namespace Engine
                 if (ch.samplerIndex >= animSamplers.size())
                     continue;
                 const auto &s = animSamplers[ch.samplerIndex];
+                uint32_t *key = cursor ? &cursor->keys[ch.samplerIndex] : nullptr;
 
-                if (ch.targetNode >= animatedTRS.size())
+                if (ch.targetNode >= animatedSlot.size())
+                    continue;
+                const uint32_t slot = animatedSlot[ch.targetNode];
+                if (slot == ~0u || (skipOptional && animatedOptional[slot]))
                     continue;
 
                 if (s.timeCount == 0)
@@ -317,138 +771,54 @@ namespace Engine
                 else
                     continue;
 
-                if (ch.path == (uint16_t)smodel::SModelAnimPath::Translation)
-                {
-                    animatedTRS[ch.targetNode].t = SampleVec3(times, values, s.timeCount, t);
-                }
-                else if (ch.path == (uint16_t)smodel::SModelAnimPath::Scale)
+                // Packed keys are decoded here, on the sampled interval only.
+                const bool quatValues = smodel::isQuatValueType(s.valueType);
+                if (quatValues != (ch.path == (uint16_t)smodel::SModelAnimPath::Rotation))
+                    continue;
+
+                if (ch.path == (uint16_t)smodel::SModelAnimPath::Translation ||
+                    ch.path == (uint16_t)smodel::SModelAnimPath::Scale)
                 {
-                    animatedTRS[ch.targetNode].s = SampleVec3(times, values, s.timeCount, t);
+                    const uint32_t lane = (ch.path == (uint16_t)smodel::SModelAnimPath::Translation) ? 0u : 7u;
+                    const glm::vec3 v = SampleVec3(times, values, s.valueType, s.timeCount, t, key);
+                    trs[(lane + 0) * slotCount + slot] = v.x;
+                    trs[(lane + 1) * slotCount + slot] = v.y;
+                    trs[(lane + 2) * slotCount + slot] = v.z;
                 }
                 else if (ch.path == (uint16_t)smodel::SModelAnimPath::Rotation)
                 {
-                    animatedTRS[ch.targetNode].r = SampleQuat(times, values, s.timeCount, t);
-                }
-            }
-
-            for (size_t i = 0; i < nodes.size(); i++)
-            {
-                nodes[i].localMatrix = ComposeTRS(animatedTRS[i]);
-            }
-
-            recomputeGlobals();
-        }
-
-        // Evaluate clip at an explicit time into globalsOut (nodeCount matrices).
-        // This does not mutate nodes/local/global matrices, so it can be used per entity.
-        inline void evaluatePoseInto(uint32_t clipIndex, float timeSec,
-                                     std::vector<NodeTRS> &trsScratch,
-                                     std::vector<glm::mat4> &localsScratch,
-                                     std::vector<glm::mat4> &globalsOut,
-                                     std::vector<uint8_t> &visitedScratch) const
-        {
-            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
-            globalsOut.assign(nodeCount, glm::mat4(1.0f));
-            if (nodeCount == 0)
-                return;
-
-            trsScratch.resize(nodeCount);
-            localsScratch.resize(nodeCount);
-            visitedScratch.assign(nodeCount, 0);
-
-            // Start from rest pose if available.
-            if (restTRS.size() == nodes.size())
-            {
-                trsScratch = restTRS;
-            }
-            else
-            {
-                for (uint32_t i = 0; i < nodeCount; ++i)
-                    trsScratch[i] = NodeTRS{};
-            }
-
-            if (!animClips.empty() && !animChannels.empty() && !animSamplers.empty())
-            {
-                const uint32_t safeClip = std::min(clipIndex, static_cast<uint32_t>(animClips.size() - 1));
-                const auto &clip = animClips[safeClip];
-
-                const float t = timeSec;
-                const uint32_t clipFirst = clip.firstChannel;
-                const uint32_t clipCount = clip.channelCount;
-                for (uint32_t ci = 0; ci < clipCount; ci++)
-                {
-                    const uint32_t chIdx = clipFirst + ci;
-                    if (chIdx >= animChannels.size())
-                        break;
-
-                    const auto &ch = animChannels[chIdx];
-                    if (ch.samplerIndex >= animSamplers.size())
-                        continue;
-                    const auto &s = animSamplers[ch.samplerIndex];
-
-                    if (ch.targetNode >= trsScratch.size())
-                        continue;
-
-                    if (s.timeCount == 0)
-                        continue;
-                    if (s.firstTime + s.timeCount > animTimes.size())
-                        continue;
-
-                    const float *times = animTimes.data() + s.firstTime;
-                    const float *values = nullptr;
-                    if (s.firstValue + s.valueCount <= animValues.size())
-                        values = animValues.data() + s.firstValue;
-                    else
-                        continue;
-
-                    if (ch.path == (uint16_t)smodel::SModelAnimPath::Translation)
-                    {
-                        trsScratch[ch.targetNode].t = SampleVec3(times, values, s.timeCount, t);
-                    }
-                    else if (ch.path == (uint16_t)smodel::SModelAnimPath::Scale)
+                    uint32_t i0 = 0, i1 = 0;
+                    float a = 0.0f;
+                    if (s.timeCount > 1)
                     {
-                        trsScratch[ch.targetNode].s = SampleVec3(times, values, s.timeCount, t);
+                        i0 = key ? FindKeyIntervalFrom(times, s.timeCount, t, *key) : FindKeyInterval(times, s.timeCount, t);
+                        i1 = i0 + 1;
+                        a = ComputeAlpha(times[i0], times[i1], t);
                     }
-                    else if (ch.path == (uint16_t)smodel::SModelAnimPath::Rotation)
+
+                    // XYZW, like the kernel lanes.
+                    float v0[4], v1[4];
+                    smodel::decodeQuatKey(s.valueType, values, i0, v0);
+                    smodel::decodeQuatKey(s.valueType, values, i1, v1);
+                    for (uint32_t k = 0; k < 4; ++k)
                     {
-                        trsScratch[ch.targetNode].r = SampleQuat(times, values, s.timeCount, t);
+                        keys[k * keyStride + rotCount] = v0[k];
+                        keys[(4 + k) * keyStride + rotCount] = v1[k];
                     }
+                    keys[8 * keyStride + rotCount] = a;
+                    scratch.rotSlots[rotCount++] = slot;
                 }
             }
 
-            for (uint32_t i = 0; i < nodeCount; ++i)
-                localsScratch[i] = ComposeTRS(trsScratch[i]);
-
-            const uint32_t U32_MAX = ~0u;
-
-            std::function<void(uint32_t, const glm::mat4 &)> compute = [&](uint32_t nodeIdx, const glm::mat4 &parentGlobal)
-            {
-                if (nodeIdx >= nodeCount)
-                    return;
-                if (visitedScratch[nodeIdx])
-                    return;
-                visitedScratch[nodeIdx] = 1;
-
-                globalsOut[nodeIdx] = parentGlobal * localsScratch[nodeIdx];
-
-                const ModelNode &n = nodes[nodeIdx];
-                if (n.childCount == 0)
-                    return;
-                if (n.firstChildIndex == U32_MAX)
-                    return;
-
-                const uint32_t start = n.firstChildIndex;
-                for (uint32_t ci = 0; ci < n.childCount; ++ci)
-                {
-                    const uint32_t child = nodeChildIndices[start + ci];
-                    compute(child, globalsOut[nodeIdx]);
-                }
-            };
+            if (rotCount == 0)
+                return;
 
-            for (uint32_t i = 0; i < nodeCount; ++i)
+            Simd::nlerpQuat(keys, keyStride, rotCount);
+            for (uint32_t r = 0; r < rotCount; ++r)
             {
-                if (nodes[i].parentIndex == U32_MAX)
-                    compute(i, glm::mat4(1.0f));
+                const uint32_t slot = scratch.rotSlots[r];
+                for (uint32_t k = 0; k < 4; ++k)
+                    trs[(3 + k) * slotCount + slot] = keys[k * keyStride + r];
             }
         }
     };
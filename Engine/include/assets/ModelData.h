@@ -0,0 +1,52 @@
+#pragma once
+/*
+  ModelData.h
+  -----------
+  Purpose:
+    - The CPU side of a cooked model (node graph, animation clips, pose caches, bounds) built from
+      an SModelFileView without a GPU. AssetManager builds the CPU half of its loads with these;
+      HeadlessAssets, tools and benchmarks use them alone.
+
+  Usage:
+    - smodel::SModelFileView view; smodel::LoadSModelFile(path, view, error);
+    - ModelAsset model; BuildModelData(view, model);  // nodes, clips, bounds and fit
+    - BuildModelPose(view, model);                     // nodes and clips only (evaluatePoseInto)
+
+  Notes:
+    - No primitives, meshes, materials or baked palettes: drawing still needs AssetManager.
+    - Node debug names point into 'view', which must outlive the model.
+*/
+
+#include "assets/ModelAsset.h"
+#include "assets/SModelLoader.h"
+
+#include <vector>
+
+namespace Engine
+{
+    // Mesh-space box of one primitive (its mesh record's AABB); invalid without a mesh
+    struct PrimitiveBounds
+    {
+        float min[3]{0.0f, 0.0f, 0.0f};
+        float max[3]{0.0f, 0.0f, 0.0f};
+        bool valid = false;
+    };
+
+    // V2 node graph: records, child/primitive index tables, traversal order and globals.
+    void CopyModelNodes(const smodel::SModelFileView &view, ModelAsset &model);
+
+    // V3 clips (node TRS only) and the rest pose they override; needs the nodes.
+    void CopyModelAnimations(const smodel::SModelFileView &view, ModelAsset &model);
+
+    // Bounds, center and fitScale from per-primitive boxes (indexed like the file's primitives):
+    // their union, then the node-global corners of the primitives nodes draw when there are nodes.
+    void ComputeModelBounds(ModelAsset &model, const std::vector<PrimitiveBounds> &primitives);
+
+    // Nodes and clips; false when the file has no nodes.
+    bool BuildModelPose(const smodel::SModelFileView &view, ModelAsset &out);
+
+    // Nodes, clips and bounds (mesh records' AABBs); false for a file with neither nodes nor
+    // primitives.
+    bool BuildModelData(const smodel::SModelFileView &view, ModelAsset &out);
+
+} // namespace Engine
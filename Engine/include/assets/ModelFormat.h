@@ -20,16 +20,21 @@
 #include "assets/model/SModelNodeRecord.h"
 
 #include "assets/model/SModelSkinRecord.h"
+#include "assets/model/SModelMeshletRecord.h"
 
 #include "assets/model/SModelAnimationRecords.h"
+#include "assets/model/SModelAnimationCodec.h"
 namespace Engine::smodel
 {
     // 'SMOD' little-endian magic
     static constexpr uint32_t SMODEL_MAGIC = 0x444F4D53;
 
-    // Current (and only supported) runtime version.
-    static constexpr uint16_t SMODEL_VERSION_MAJOR = 4;
+    // Current runtime version. V5 only adds packed animation samplers, V6 compact vertices
+    // (VTX_COMPACT meshes), V7 optional meshlet sections, V8 block-compressed textures and V9
+    // codec-compressed mesh streams (MeshStreamFlags), so V4 files still load.
+    static constexpr uint16_t SMODEL_VERSION_MAJOR = 9;
     static constexpr uint16_t SMODEL_VERSION_MINOR = 0;
+    static constexpr uint16_t SMODEL_MIN_VERSION_MAJOR = 4;
 
     // Small helper for loader validation.
     // If this returns false, loader should reject the file.
@@ -39,11 +44,11 @@ namespace Engine::smodel
             return false;
 
         // Only accept v3+. (Project policy: all assets are recooked to latest.)
-        if (h.versionMajor != SMODEL_VERSION_MAJOR)
+        if (h.versionMajor < SMODEL_MIN_VERSION_MAJOR || h.versionMajor > SMODEL_VERSION_MAJOR)
             return false;
 
         // Minor can be forward-compatible.
-        if (h.versionMinor < SMODEL_VERSION_MINOR)
+        if (h.versionMajor == SMODEL_VERSION_MAJOR && h.versionMinor < SMODEL_VERSION_MINOR)
             return false;
 
         return true;
@@ -0,0 +1,36 @@
+#pragma once
+/*
+  ModelProvider.h
+  ---------------
+  Purpose:
+    - What simulation code needs from a model library: a handle for a cooked model path, and the
+      model's CPU data (nodes, clips, bounds) once it is loaded. Lets prefabs and animation run
+      against AssetManager (client) or HeadlessAssets (dedicated server) alike.
+
+  Usage:
+    - ModelHandle h = provider.loadModelAsync("assets/knight.smodel");
+    - if (const ModelAsset *model = provider.modelData(h)) { ... model->animClips ... }
+
+  Notes:
+    - modelData() is null until the model is loaded (AssetManager loads asynchronously), and for
+      stale handles. HeadlessAssets models have no primitives or palettes.
+*/
+
+#include "assets/Handles.h"
+
+#include <string>
+
+namespace Engine
+{
+    struct ModelAsset;
+
+    class IModelProvider
+    {
+    public:
+        virtual ~IModelProvider() = default;
+
+        virtual ModelHandle loadModelAsync(const std::string &cookedModelPath) = 0;
+        virtual const ModelAsset *modelData(ModelHandle h) const = 0;
+    };
+
+} // namespace Engine
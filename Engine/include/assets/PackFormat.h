@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// ------------------------------------------------------------
+// .spak asset archive
+// ------------------------------------------------------------
+// Written by PackAssetsTool (Engine/tools/PackAssets), read by VirtualFileSystem::mountPack().
+// Layout:
+//   PackHeader
+//   PackEntry[entryCount]  at tocOffset, sorted by pathHash (binary search)
+//   path strings           at stringTableOffset, NUL-terminated, PackEntry::pathOffset into it
+//   entry data             each at a kPackDataAlignment boundary
+// Paths are relative to the packed root, with '/' separators (the paths the game opens).
+namespace Engine::pack
+{
+#pragma pack(push, 1)
+
+    struct PackHeader
+    {
+        char magic[4]; // "SPAK"
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t flags; // reserved, 0
+
+        uint64_t tocOffset;
+        uint64_t stringTableOffset;
+        uint64_t stringTableSize;
+        uint64_t fileSizeBytes;
+    };
+
+    struct PackEntry
+    {
+        uint64_t pathHash;   // HashPath()
+        uint64_t offset;     // of the stored bytes, from the start of the file
+        uint64_t size;       // uncompressed
+        uint64_t storedSize; // in the file (== size when uncompressed)
+        uint32_t compression; // PackCompression
+        uint32_t pathOffset;  // into the string table
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(PackHeader) == 48, "PackHeader size mismatch");
+    static_assert(sizeof(PackEntry) == 40, "PackEntry size mismatch");
+
+    static constexpr uint32_t kPackVersion = 1;
+    static constexpr uint64_t kPackDataAlignment = 64;
+
+    enum class PackCompression : uint32_t
+    {
+        None = 0,
+        LZ4 = 1 // LZ4 block format (no frame)
+    };
+
+    // FNV-1a 64 of the path as given (callers normalize separators first)
+    inline uint64_t HashPath(std::string_view path)
+    {
+        uint64_t h = 14695981039346656037ull;
+        for (char c : path)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+} // namespace Engine::pack
@@ -5,22 +5,27 @@
 #include <vector>
 
 #include "assets/ModelFormat.h" // umbrella include for SModel structs
+#include "utils/VirtualFileSystem.h"
 
 namespace Engine::smodel
 {
     // ------------------------------------------------------------
     // SModelFileView
     // ------------------------------------------------------------
-    // Owns file bytes and provides typed views (pointers) into it.
-    // AssetManager will use this to build GPU resources later.
+    // Owns the file (read through the VirtualFileSystem: in place from a pack or a mapping where
+    // possible) and provides typed views (pointers) into it. AssetManager will use this to build GPU resources later.
+    // Move-only; the pointers stay valid while the view lives.
     struct SModelFileView
     {
-        std::vector<uint8_t> fileBytes; // owns the whole file memory
+        FileData file; // the whole file
 
-        // Header pointer inside fileBytes
+        const uint8_t *data() const { return file.data(); }
+        uint64_t size() const { return static_cast<uint64_t>(file.size()); }
+
+        // Header pointer inside file
         const SModelHeader *header = nullptr;
 
-        // Record table pointers inside fileBytes
+        // Record table pointers inside file
         const SModelMeshRecord *meshes = nullptr;
         const SModelPrimitiveRecord *primitives = nullptr;
         const SModelMaterialRecord *materials = nullptr;
@@ -43,6 +48,11 @@ namespace Engine::smodel
         const uint32_t *skinJointNodeIndices = nullptr;
         const float *skinInverseBindMatrices = nullptr;
 
+        // Meshlets (V7)
+        const SModelMeshletRecord *meshlets = nullptr;
+        const uint32_t *meshletVertices = nullptr;
+        const uint8_t *meshletTriangles = nullptr;
+
         // String table start pointer (C-string table)
         const char *stringTable = nullptr;
 
@@ -108,6 +118,25 @@ namespace Engine::smodel
             return header->skinInverseBindMatricesCount;
         }
 
+        uint32_t meshletCount() const
+        {
+            if (!header || header->versionMajor < 7)
+                return 0;
+            return header->meshletCount;
+        }
+        uint32_t meshletVertexCount() const
+        {
+            if (!header || header->versionMajor < 7)
+                return 0;
+            return header->meshletVertexCount;
+        }
+        uint32_t meshletTriangleBytes() const
+        {
+            if (!header || header->versionMajor < 7)
+                return 0;
+            return header->meshletTriangleBytes;
+        }
+
         // Returns pointer to a null-terminated string in the string table.
         // Returns empty string if offset is 0 or invalid.
         const char *getStringOrEmpty(uint32_t strOffset) const;
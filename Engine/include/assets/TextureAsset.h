@@ -1,6 +1,8 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <cstdint>
+#include <vector>
+#include "utils/MemoryAllocator.h"
 
 namespace Engine
 {
@@ -47,6 +49,45 @@ namespace Engine
             VkSamplerMipmapMode mipMode,
             float maxAnisotropy);
 
+        // Block-compressed bytes (smodel ImageEncoding BC1/BC3/BC5) holding the full mip chain
+        // (smodel::BlockMipChainBytes()): uploaded as stored, no decode and no mip generation. On
+        // devices without the format, mip 0 is decoded on the CPU and goes the uploadRGBA8_Deferred() way.
+        // 'firstMip' leaves the finer mips out (texture streaming, AssetManager::requestTextureDetail()):
+        // the image holds the chain from that mip on, and is the size of that mip. The CPU decode
+        // ignores it.
+        bool uploadBlockCompressed_Deferred(
+            UploadContext &ctx,
+            const uint8_t *blockBytes,
+            size_t byteSize,
+            uint32_t encoding,
+            uint32_t width,
+            uint32_t height,
+            bool srgbFormat,
+            VkSamplerAddressMode wrapU,
+            VkSamplerAddressMode wrapV,
+            VkFilter minFilter,
+            VkFilter magFilter,
+            VkSamplerMipmapMode mipMode,
+            float maxAnisotropy,
+            uint32_t firstMip = 0);
+
+        // Decode PNG/JPG bytes to RGBA8 without touching the GPU, so it can run on any thread
+        // (AssetManager::loadModelAsync() decodes on its streaming workers, then uploads with
+        // uploadRGBA8_Deferred()).
+        static bool decodeImage(
+            const uint8_t *encodedBytes,
+            size_t encodedSize,
+            std::vector<uint8_t> &outRgba,
+            uint32_t &outWidth,
+            uint32_t &outHeight);
+
+        // Reads only the dimensions of PNG/JPG bytes (sizing staging memory before the decode).
+        static bool probeImage(
+            const uint8_t *encodedBytes,
+            size_t encodedSize,
+            uint32_t &outWidth,
+            uint32_t &outHeight);
+
         // Destroy GPU resources (used by AssetManager when freeing)
         void destroy(VkDevice device);
 
@@ -58,18 +99,21 @@ namespace Engine
         uint32_t getHeight() const { return m_height; }
         uint32_t getMipLevels() const { return m_mipLevels; }
         VkFormat getFormat() const { return m_format; }
+        // Mip of the source chain the image starts at (uploadBlockCompressed_Deferred() 'firstMip')
+        uint32_t getFirstMip() const { return m_firstMip; }
 
         bool isValid() const { return m_image != VK_NULL_HANDLE; }
 
     private:
         VkImage m_image = VK_NULL_HANDLE;
-        VkDeviceMemory m_memory = VK_NULL_HANDLE;
+        MemoryAllocation m_memory;
         VkImageView m_view = VK_NULL_HANDLE;
         VkSampler m_sampler = VK_NULL_HANDLE;
 
         uint32_t m_width = 0;
         uint32_t m_height = 0;
         uint32_t m_mipLevels = 1;
+        uint32_t m_firstMip = 0;
         VkFormat m_format = VK_FORMAT_R8G8B8A8_UNORM;
     };
 
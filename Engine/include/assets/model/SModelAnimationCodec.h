@@ -0,0 +1,183 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "assets/model/SModelAnimationRecords.h"
+
+namespace Engine::smodel
+{
+    // ============================================================
+    // Packed animation values (V5)
+    // ============================================================
+    // Shared by the cook tool (encode) and the runtime sampling path (decode). animValues is a
+    // run of 32-bit words; packed samplers store 16-bit lanes in them, two per word, keys back to
+    // back, little-endian like the rest of the file.
+    //
+    // Vec3Range:     6 floats (min.xyz, extent.xyz), then 3 lanes per key:
+    //                v = min + extent * lane / 65535
+    // QuatSmallest3: 3 lanes per key holding 48 bits:
+    //                [0..44]  the three components other than the largest, 15 bits each, in
+    //                         [-1/sqrt(2), 1/sqrt(2)]
+    //                [45..46] index of the largest component (rebuilt as sqrt(1 - sum), >= 0)
+    // Quaternions are XYZW, like the raw Quat layout.
+
+    static constexpr uint32_t kVec3RangeHeaderWords = 6;
+    static constexpr float kSmallest3Range = 0.70710678f; // 1/sqrt(2)
+    static constexpr uint32_t kSmallest3Max = 32767;      // 15 bits
+
+    inline bool isQuatValueType(uint8_t valueType)
+    {
+        return valueType == uint8_t(SModelAnimValueType::Quat) || valueType == uint8_t(SModelAnimValueType::QuatSmallest3);
+    }
+
+    // Words a sampler of 'keyCount' keys occupies in animValues.
+    inline uint64_t packedValueWords(uint8_t valueType, uint32_t keyCount)
+    {
+        const uint64_t lanes = uint64_t(keyCount) * 3ull;
+        switch (SModelAnimValueType(valueType))
+        {
+        case SModelAnimValueType::Vec3:
+            return uint64_t(keyCount) * 3ull;
+        case SModelAnimValueType::Quat:
+            return uint64_t(keyCount) * 4ull;
+        case SModelAnimValueType::Vec3Range:
+            return kVec3RangeHeaderWords + (lanes + 1) / 2;
+        case SModelAnimValueType::QuatSmallest3:
+            return (lanes + 1) / 2;
+        }
+        return 0;
+    }
+
+    inline uint16_t readLane(const float *words, uint32_t lane)
+    {
+        uint16_t v;
+        std::memcpy(&v, reinterpret_cast<const uint8_t *>(words) + size_t(lane) * 2, sizeof(v));
+        return v;
+    }
+
+    // Key 'key' of a Vec3 / Vec3Range sampler whose values start at 'values'.
+    inline void decodeVec3Key(uint8_t valueType, const float *values, uint32_t key, float out[3])
+    {
+        if (valueType == uint8_t(SModelAnimValueType::Vec3Range))
+        {
+            const float *lanes = values + kVec3RangeHeaderWords;
+            for (uint32_t c = 0; c < 3; ++c)
+                out[c] = values[c] + values[3 + c] * (float(readLane(lanes, key * 3 + c)) * (1.0f / 65535.0f));
+            return;
+        }
+        const float *v = values + size_t(key) * 3;
+        out[0] = v[0];
+        out[1] = v[1];
+        out[2] = v[2];
+    }
+
+    // Key 'key' of a Quat / QuatSmallest3 sampler, XYZW.
+    inline void decodeQuatKey(uint8_t valueType, const float *values, uint32_t key, float out[4])
+    {
+        if (valueType == uint8_t(SModelAnimValueType::QuatSmallest3))
+        {
+            const uint64_t bits = uint64_t(readLane(values, key * 3)) | (uint64_t(readLane(values, key * 3 + 1)) << 16) |
+                                  (uint64_t(readLane(values, key * 3 + 2)) << 32);
+            const uint32_t largest = uint32_t(bits >> 45) & 3u;
+            float sum = 0.0f;
+            for (uint32_t c = 0, k = 0; c < 4; ++c)
+            {
+                if (c == largest)
+                    continue;
+                const float u = float(uint32_t(bits >> (15 * k++)) & kSmallest3Max);
+                out[c] = u * (2.0f * kSmallest3Range / float(kSmallest3Max)) - kSmallest3Range;
+                sum += out[c] * out[c];
+            }
+            out[largest] = std::sqrt(std::fmax(0.0f, 1.0f - sum));
+            return;
+        }
+        const float *v = values + size_t(key) * 4;
+        out[0] = v[0];
+        out[1] = v[1];
+        out[2] = v[2];
+        out[3] = v[3];
+    }
+
+    // ------------------------------------------------------------
+    // Encoding (cook time). Values are appended to 'words'.
+    // ------------------------------------------------------------
+
+    inline void appendLanes(std::vector<float> &words, const std::vector<uint16_t> &lanes)
+    {
+        const size_t first = words.size();
+        words.resize(first + (lanes.size() + 1) / 2, 0.0f);
+        if (!lanes.empty())
+            std::memcpy(words.data() + first, lanes.data(), lanes.size() * sizeof(uint16_t));
+    }
+
+    // 'xyz' holds keyCount * 3 floats.
+    inline void encodeVec3Range(const float *xyz, uint32_t keyCount, std::vector<float> &words)
+    {
+        float lo[3] = {0.0f, 0.0f, 0.0f}, hi[3] = {0.0f, 0.0f, 0.0f};
+        for (uint32_t c = 0; c < 3 && keyCount > 0; ++c)
+        {
+            lo[c] = hi[c] = xyz[c];
+            for (uint32_t k = 1; k < keyCount; ++k)
+            {
+                lo[c] = std::fmin(lo[c], xyz[k * 3 + c]);
+                hi[c] = std::fmax(hi[c], xyz[k * 3 + c]);
+            }
+        }
+
+        for (uint32_t c = 0; c < 3; ++c)
+            words.push_back(lo[c]);
+        for (uint32_t c = 0; c < 3; ++c)
+            words.push_back(hi[c] - lo[c]);
+
+        std::vector<uint16_t> lanes(size_t(keyCount) * 3);
+        for (uint32_t k = 0; k < keyCount; ++k)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                const float extent = hi[c] - lo[c];
+                const float n = (extent > 0.0f) ? (xyz[k * 3 + c] - lo[c]) / extent : 0.0f;
+                lanes[k * 3 + c] = uint16_t(std::lround(std::fmin(std::fmax(n, 0.0f), 1.0f) * 65535.0f));
+            }
+        }
+        appendLanes(words, lanes);
+    }
+
+    // 'xyzw' holds keyCount * 4 floats (need not be normalized).
+    inline void encodeQuatSmallest3(const float *xyzw, uint32_t keyCount, std::vector<float> &words)
+    {
+        std::vector<uint16_t> lanes(size_t(keyCount) * 3);
+        for (uint32_t k = 0; k < keyCount; ++k)
+        {
+            float q[4] = {xyzw[k * 4], xyzw[k * 4 + 1], xyzw[k * 4 + 2], xyzw[k * 4 + 3]};
+            const float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+            const float inv = (len > 0.0f) ? 1.0f / len : 0.0f;
+            for (uint32_t c = 0; c < 4; ++c)
+                q[c] = (len > 0.0f) ? q[c] * inv : (c == 3 ? 1.0f : 0.0f);
+
+            uint32_t largest = 3;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                if (std::fabs(q[c]) > std::fabs(q[largest]))
+                    largest = c;
+            }
+            const float sign = (q[largest] < 0.0f) ? -1.0f : 1.0f; // q and -q are the same rotation
+
+            uint64_t bits = uint64_t(largest) << 45;
+            for (uint32_t c = 0, j = 0; c < 4; ++c)
+            {
+                if (c == largest)
+                    continue;
+                const float n = (q[c] * sign + kSmallest3Range) / (2.0f * kSmallest3Range);
+                const uint64_t u = uint64_t(std::lround(std::fmin(std::fmax(n, 0.0f), 1.0f) * float(kSmallest3Max)));
+                bits |= u << (15 * j++);
+            }
+            lanes[k * 3 + 0] = uint16_t(bits);
+            lanes[k * 3 + 1] = uint16_t(bits >> 16);
+            lanes[k * 3 + 2] = uint16_t(bits >> 32);
+        }
+        appendLanes(words, lanes);
+    }
+
+} // namespace Engine::smodel
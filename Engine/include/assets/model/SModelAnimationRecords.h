@@ -19,10 +19,13 @@ namespace Engine::smodel
         CubicSpline = 2,
     };
 
+    // Vec3/Quat are raw floats. The packed types (V5) are decoded by SModelAnimationCodec.h.
     enum class SModelAnimValueType : uint8_t
     {
         Vec3 = 0,
         Quat = 1,
+        Vec3Range = 2,     // per-sampler min/extent + 3 x 16-bit per key
+        QuatSmallest3 = 3, // 48 bits per key (smallest three components)
     };
 
     struct SModelAnimationClipRecord
@@ -45,8 +48,8 @@ namespace Engine::smodel
         uint32_t firstTime; // index into animTimes (float)
         uint32_t timeCount;
 
-        uint32_t firstValue; // index into animValues (float)
-        uint32_t valueCount; // floats count (timeCount*3 or timeCount*4)
+        uint32_t firstValue; // index into animValues (32-bit words)
+        uint32_t valueCount; // word count: timeCount*3 / timeCount*4, or smodel::packedValueWords()
 
         uint8_t interpolation; // SModelAnimInterpolation
         uint8_t valueType;     // SModelAnimValueType
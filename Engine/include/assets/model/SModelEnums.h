@@ -28,8 +28,29 @@ namespace Engine::smodel
         // Skinning (V4)
         VTX_JOINTS = (1u << 4),  // JOINTS0 (u16x4)
         VTX_WEIGHTS = (1u << 5), // WEIGHTS0 (f32x4)
+
+        // Quantized layout (V6), see kCompactVertexStride. Without it: VertexPNTTJW (72 bytes).
+        VTX_COMPACT = (1u << 6),
     };
 
+    // How a mesh's streams are stored (V9), in the upper half of SModelMeshRecord::layoutFlags.
+    // A coded stream is a meshcodec stream (assets/MeshCodec.h): vertexDataSize / indexDataSize
+    // are then its encoded size, and the runtime decodes it into staging memory.
+    enum MeshStreamFlags : uint32_t
+    {
+        MESH_VERTEX_CODEC = (1u << 16),
+        MESH_INDEX_CODEC = (1u << 17),
+    };
+
+    // VTX_COMPACT vertex, 28 bytes:
+    //   0: unorm16x4 position, (p - aabbMin) / span with span = the longest AABB axis;
+    //      w = tangent handedness (65535: +1, 0: -1)
+    //   8: snorm16x4 octahedral normal (xy) and tangent (zw)
+    //  16: half2 uv0
+    //  20: u8x4 joints (skins of at most 256 joints)
+    //  24: unorm8x4 weights
+    static constexpr uint32_t kCompactVertexStride = 28;
+
     // ============================================================
     // Texture / Image Enums
     // ============================================================
@@ -45,11 +66,16 @@ namespace Engine::smodel
 
     // Image encoding describes how the texture bytes are stored in the blob.
     // Phase 1: embed PNG/JPG bytes (compressed) and decode at runtime.
+    // V8: GPU block-compressed textures (GltfToSmodel --compress-textures), uploaded as stored: the
+    // full mip chain, mip 0 first, each mip's 4x4 blocks in row order (SModelTextureRecord.h).
     enum class ImageEncoding : uint32_t
     {
         PNG = 0,
         JPG = 1,
-        RAW = 2 // optional future (raw RGBA8 stored directly)
+        RAW = 2, // optional future (raw RGBA8 stored directly)
+        BC1 = 3, // RGB, 8 bytes per block (opaque color and data textures)
+        BC3 = 4, // RGBA, 16 bytes per block (color with alpha)
+        BC5 = 5  // RG, 16 bytes per block (tangent-space normals, z reconstructed)
     };
 
     // ============================================================
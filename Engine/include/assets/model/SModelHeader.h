@@ -6,8 +6,16 @@ namespace Engine::smodel
 #pragma pack(push, 1)
 
     // ============================================================
-    // .smodel Header (V4.x)
+    // .smodel Header (V7.x)
     // ============================================================
+    // V5 keeps the V4 layout; animation samplers may use the packed value types
+    // (SModelAnimationCodec.h), so animValues holds 32-bit words rather than plain floats.
+    // V6 keeps it too; meshes may use the compact vertex layout (VTX_COMPACT).
+    // V7 appends the meshlet sections (SModelMeshletRecord.h); older files end the header at
+    // kSModelHeaderV6Size bytes, so those fields are only read from V7 on.
+    // V9 keeps the layout; mesh streams may be codec-compressed (MeshStreamFlags), and the cook
+    // tool starts every mesh stream on a 16-byte boundary of the blob.
+    //
     // The header contains:
     // - counts of record arrays
     // - absolute offsets to each section
@@ -21,7 +29,7 @@ namespace Engine::smodel
     struct SModelHeader
     {
         uint32_t magic;        // must equal 'SMOD'
-        uint16_t versionMajor; // 4
+        uint16_t versionMajor; // 9 (4 to 8 still accepted)
         uint16_t versionMinor; // 0
 
         uint32_t fileSizeBytes; // entire file size (validation)
@@ -72,8 +80,8 @@ namespace Engine::smodel
         uint32_t animTimesOffset; // float seconds
         uint32_t animTimesCount;  // number of floats
 
-        uint32_t animValuesOffset; // float packed values
-        uint32_t animValuesCount;  // number of floats
+        uint32_t animValuesOffset; // 32-bit words: floats, or packed lanes (V5)
+        uint32_t animValuesCount;  // number of words
 
         // NEW in v4.0: skinning (optional; counts can be 0)
         uint32_t skinsOffset;
@@ -84,11 +92,24 @@ namespace Engine::smodel
 
         uint32_t skinInverseBindMatricesOffset; // float array (mat4 = 16 floats)
         uint32_t skinInverseBindMatricesCount;  // number of floats
+
+        // NEW in v7.0: meshlets (optional; counts can be 0)
+        uint32_t meshletsOffset;
+        uint32_t meshletCount;
+
+        uint32_t meshletVerticesOffset; // uint32 mesh vertex indices
+        uint32_t meshletVertexCount;    // number of uint32s
+
+        uint32_t meshletTrianglesOffset; // uint8 meshlet-local vertex indices, 3 per triangle
+        uint32_t meshletTriangleBytes;   // number of bytes
     };
 
 #pragma pack(pop)
 
     // Size must remain stable across tool/runtime.
-    static_assert(sizeof(SModelHeader) == 192, "SModelHeader size mismatch");
+    static_assert(sizeof(SModelHeader) == 216, "SModelHeader size mismatch");
+
+    // Header size of V4-V6 files (everything up to the skinning fields).
+    static constexpr uint32_t kSModelHeaderV6Size = 192;
 
 } // namespace Engine::smodel
\ No newline at end of file
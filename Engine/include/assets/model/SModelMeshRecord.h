@@ -20,17 +20,17 @@ namespace Engine::smodel
         uint32_t vertexCount; // number of vertices in VB
         uint32_t indexCount;  // number of indices in IB
 
-        uint32_t layoutFlags; // VertexLayoutFlags bitmask
+        uint32_t layoutFlags; // VertexLayoutFlags bitmask (VTX_COMPACT: quantized layout) | MeshStreamFlags (V9)
         uint32_t indexType;   // IndexType (U16/U32)
 
         // Blob offsets are relative to header.blobOffset
         uint64_t vertexDataOffset; // start of vertex bytes
-        uint64_t vertexDataSize;   // size of vertex bytes in blob
+        uint64_t vertexDataSize;   // size of vertex bytes in blob (encoded size with MESH_VERTEX_CODEC)
 
         uint64_t indexDataOffset; // start of index bytes
-        uint64_t indexDataSize;   // size of index bytes in blob
+        uint64_t indexDataSize;   // size of index bytes in blob (encoded size with MESH_INDEX_CODEC)
 
-        // Simple bounds (for culling / camera fitting later)
+        // Simple bounds (for culling / camera fitting later); compact positions are relative to them
         float aabbMin[3];
         float aabbMax[3];
     };
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+namespace Engine::smodel
+{
+    // Meshlet limits (the cook tool never exceeds them; the runtime's mesh shader is sized by them).
+    static constexpr uint32_t kMeshletMaxVertices = 64;
+    static constexpr uint32_t kMeshletMaxTriangles = 124;
+
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Meshlet Record (V7)
+    // ============================================================
+    // A small cluster of one base primitive's triangles, for per-cluster culling. The cook tool
+    // reorders the primitive's index range so every meshlet's triangles are contiguous in it:
+    // [firstIndex, firstIndex + triangleCount * 3) relative to SModelPrimitiveRecord::firstIndex.
+    // The same triangles are also stored in the meshlet tables, for mesh shaders:
+    // - meshletVertices (uint32): mesh vertex indices, like the index buffer's
+    // - meshletTriangles (uint8 triples): indices into the meshlet's vertices
+    //
+    // Records are grouped by primitive in ascending primitive order; LOD primitives have none.
+    //
+    // Bounds are in mesh space. The normal cone culls back-facing clusters: the meshlet is
+    // invisible when dot(normalize(coneApex - eye), coneAxis) >= coneCutoff (coneCutoff = 1: never).
+    struct SModelMeshletRecord
+    {
+        uint32_t primitiveIndex; // owning (base) primitive
+        uint32_t firstIndex;     // first of its triangles' indices, relative to the primitive's range
+
+        uint32_t firstVertex;   // into meshletVertices
+        uint32_t firstTriangle; // into meshletTriangles, in triangles (3 bytes each)
+        uint16_t vertexCount;   // <= kMeshletMaxVertices
+        uint16_t triangleCount; // <= kMeshletMaxTriangles
+
+        float center[3]; // bounding sphere
+        float radius;
+
+        float coneApex[3];
+        float coneAxis[3];
+        float coneCutoff; // sin of the cone's half angle
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelMeshletRecord) == 64, "SModelMeshletRecord size mismatch");
+
+} // namespace Engine::smodel
@@ -13,6 +13,11 @@ namespace Engine::smodel
     //
     // For now, most primitives will simply draw the entire mesh.
     // But firstIndex/indexCount allow future submesh slicing without format change.
+    //
+    // Mesh LODs: a simplified version of a primitive is another record with the same mesh,
+    // material and skin and its own index range (the cook tool appends the simplified indices to
+    // the mesh's index buffer). lodNext chains a primitive to its next coarser LOD. LOD records
+    // follow every primitive the node graph references, so 0 can mean "no coarser LOD".
     struct SModelPrimitiveRecord
     {
         uint32_t meshIndex;     // index into mesh records
@@ -24,7 +29,7 @@ namespace Engine::smodel
         int32_t vertexOffset; // usually 0 (useful if merged meshes later)
         int32_t skinIndex;    // -1 = no skin
 
-        uint32_t reserved;
+        uint32_t lodNext; // next coarser LOD primitive, 0 = none (was reserved, always 0)
     };
 
 #pragma pack(pop)
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include "assets/model/SModelEnums.h"
 
 namespace Engine::smodel
 {
@@ -11,9 +12,10 @@ namespace Engine::smodel
     // Stores:
     // - sampler parameters (wrap/filter)
     // - color space (sRGB/Linear)
-    // - embedded compressed image bytes (PNG/JPG) in the blob section
+    // - embedded compressed image bytes (PNG/JPG) in the blob section, or (V8) GPU-ready
+    //   block-compressed bytes with all mips
     //
-    // Runtime will decode bytes to RGBA8 and upload to VkImage.
+    // Runtime will decode PNG/JPG bytes to RGBA8 and upload to VkImage; BCn bytes go up as stored.
     struct SModelTextureRecord
     {
         // Offset into string table (0 = none)
@@ -33,15 +35,59 @@ namespace Engine::smodel
         float maxAnisotropy; // 1.0 = disabled, >1.0 enable anisotropy
 
         // Embedded bytes stored in the blob section (relative offsets)
-        uint64_t imageDataOffset; // start of PNG/JPG bytes
-        uint64_t imageDataSize;   // compressed image byte size
+        uint64_t imageDataOffset; // start of PNG/JPG bytes (BCn: mip 0's blocks)
+        uint64_t imageDataSize;   // compressed image byte size (BCn: BlockMipChainBytes())
 
-        uint32_t reserved0;
-        uint32_t reserved1;
+        // V8: mip 0 size of block-compressed encodings (0 for PNG/JPG, which carry their own)
+        uint32_t width;
+        uint32_t height;
     };
 
 #pragma pack(pop)
 
     static_assert(sizeof(SModelTextureRecord) == 64, "SModelTextureRecord size mismatch");
 
+    // ------------------------------------------------------------
+    // Block-compressed layout (ImageEncoding::BC*)
+    // ------------------------------------------------------------
+    // Bytes per 4x4 block, 0 for encodings that are not block-compressed.
+    inline uint32_t BlockBytes(uint32_t encoding)
+    {
+        switch (static_cast<ImageEncoding>(encoding))
+        {
+        case ImageEncoding::BC1:
+            return 8;
+        case ImageEncoding::BC3:
+        case ImageEncoding::BC5:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    // Full chain down to 1x1
+    inline uint32_t FullMipCount(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = width > height ? width : height; size > 1; size >>= 1)
+            ++levels;
+        return levels;
+    }
+
+    // Bytes of one mip level, and of the whole chain (levels tightly packed, mip 0 first)
+    inline uint64_t BlockMipBytes(uint32_t encoding, uint32_t width, uint32_t height, uint32_t mip)
+    {
+        const uint64_t w = (width >> mip) > 0 ? (width >> mip) : 1;
+        const uint64_t h = (height >> mip) > 0 ? (height >> mip) : 1;
+        return ((w + 3) / 4) * ((h + 3) / 4) * BlockBytes(encoding);
+    }
+    inline uint64_t BlockMipChainBytes(uint32_t encoding, uint32_t width, uint32_t height)
+    {
+        uint64_t bytes = 0;
+        const uint32_t levels = FullMipCount(width, height);
+        for (uint32_t mip = 0; mip < levels; ++mip)
+            bytes += BlockMipBytes(encoding, width, height, mip);
+        return bytes;
+    }
+
 } // namespace Engine::smodel
\ No newline at end of file
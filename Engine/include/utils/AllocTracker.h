@@ -0,0 +1,122 @@
+#pragma once
+/*
+  AllocTracker.h
+  --------------
+  Purpose:
+    - Counts heap allocations (global operator new) per frame and per Profiler scope, to find the
+      containers rebuilt and std::functions created in hot loops, and checks that code designated
+      allocation-free in steady state stays that way.
+
+  Usage:
+    - Configure with -DENGINE_ALLOC_TRACKING=ON: the engine then replaces global operator new/delete.
+    - AllocTracker::beginFrame() / endFrame(); lastFrame()      // PerformanceMonitor does this
+    - Profiler::Event::allocations, ScopeStats::allocations      // per scope, nested scopes included
+    - { ENGINE_NO_ALLOC_SCOPE("MovementSystem integrate"); ... } // any thread
+    - AllocTracker::setChecksArmed(true);                        // after warm-up (capacity grows first)
+    - AllocTracker::setStrict(true);                             // abort on a violation instead of logging it
+
+  Notes:
+    - Off (the default) nothing is replaced, enabled() is false, the counters stay 0 and
+      ENGINE_NO_ALLOC_SCOPE compiles to nothing.
+    - An allocation costs a thread_local increment and relaxed atomic adds on top of malloc. Frees
+      are counted; unsized deletes give no size, so there are no live bytes (see MemoryTracker).
+    - Direct malloc/free calls and allocations by drivers and C libraries are not seen.
+    - A scope counts the allocations of its own thread only: work it hands to JobSystem workers is
+      attributed to the scopes open on those workers.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ENGINE_ALLOC_TRACKING
+#define ENGINE_ALLOC_TRACKING 0
+#endif
+
+namespace Engine
+{
+    struct AllocCounts
+    {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t frees = 0;
+    };
+
+    class AllocTracker
+    {
+    public:
+        static constexpr bool enabled() { return ENGINE_ALLOC_TRACKING != 0; }
+
+        // Main thread, around each frame
+        static void beginFrame();
+        static void endFrame();
+        static const AllocCounts &lastFrame();
+        // Since startup, every thread
+        static AllocCounts total();
+
+        // Allocations and bytes of the calling thread so far; differences give a scope's share
+        static uint64_t threadAllocations() { return t_allocations; }
+        static uint64_t threadBytes() { return t_bytes; }
+
+        // ENGINE_NO_ALLOC_SCOPE checks only report while armed
+        static void setChecksArmed(bool armed) { s_checksArmed.store(armed, std::memory_order_relaxed); }
+        static bool checksArmed() { return s_checksArmed.load(std::memory_order_relaxed); }
+        static void setStrict(bool strict) { s_strict.store(strict, std::memory_order_relaxed); }
+        // Scopes that allocated while armed, since startup
+        static uint32_t violations() { return s_violations.load(std::memory_order_relaxed); }
+        static void reportViolation(const char *scope, uint64_t allocations, uint64_t bytes);
+
+        // Called by the operator new/delete replacements
+        static void onAllocate(size_t bytes)
+        {
+            ++t_allocations;
+            t_bytes += bytes;
+            s_allocations.fetch_add(1, std::memory_order_relaxed);
+            s_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+        static void onFree() { s_frees.fetch_add(1, std::memory_order_relaxed); }
+
+    private:
+        static inline thread_local uint64_t t_allocations = 0;
+        static inline thread_local uint64_t t_bytes = 0;
+        static inline std::atomic<uint64_t> s_allocations{0};
+        static inline std::atomic<uint64_t> s_bytes{0};
+        static inline std::atomic<uint64_t> s_frees{0};
+        static inline std::atomic<bool> s_checksArmed{false};
+        static inline std::atomic<bool> s_strict{false};
+        static inline std::atomic<uint32_t> s_violations{0};
+    };
+
+    // Reports allocations made by this thread between construction and destruction (when armed)
+    class NoAllocScope
+    {
+    public:
+        explicit NoAllocScope(const char *name)
+            : m_name(name), m_allocations(AllocTracker::threadAllocations()), m_bytes(AllocTracker::threadBytes())
+        {
+        }
+        ~NoAllocScope()
+        {
+            const uint64_t allocations = AllocTracker::threadAllocations() - m_allocations;
+            if (allocations != 0 && AllocTracker::checksArmed())
+                AllocTracker::reportViolation(m_name, allocations, AllocTracker::threadBytes() - m_bytes);
+        }
+
+        NoAllocScope(const NoAllocScope &) = delete;
+        NoAllocScope &operator=(const NoAllocScope &) = delete;
+
+    private:
+        const char *m_name;
+        uint64_t m_allocations;
+        uint64_t m_bytes;
+    };
+
+} // namespace Engine
+
+#define ENGINE_ALLOC_CONCAT_INTERNAL(a, b) a##b
+#define ENGINE_ALLOC_CONCAT(a, b) ENGINE_ALLOC_CONCAT_INTERNAL(a, b)
+#if ENGINE_ALLOC_TRACKING
+#define ENGINE_NO_ALLOC_SCOPE(name) ::Engine::NoAllocScope ENGINE_ALLOC_CONCAT(engineNoAllocScope_, __LINE__)(name)
+#else
+#define ENGINE_NO_ALLOC_SCOPE(name) ((void)0)
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <cstdint>
+#include "utils/MemoryAllocator.h"
 
 namespace Engine
 {
@@ -8,16 +9,16 @@ namespace Engine
     struct VertexBufferHandle
     {
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        MemoryAllocation memory;
     };
 
     struct IndexBufferHandle
     {
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        MemoryAllocation memory;
     };
 
-    // Host-visible vertex buffer (used as a staging source).
+    // Host-visible vertex buffer (used as a staging source; linear MemoryAllocator pool).
     // Implementation should create with usage:
     //   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
     VkResult CreateOrUpdateVertexBuffer(
@@ -30,7 +31,7 @@ namespace Engine
     // Destroy buffer and memory held by VertexBufferHandle
     void DestroyVertexBuffer(VkDevice device, VertexBufferHandle &handle);
 
-    // Host-visible index buffer (used as a staging source).
+    // Host-visible index buffer (used as a staging source; linear MemoryAllocator pool).
     // Implementation should create with usage:
     //   VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
     VkResult CreateOrUpdateIndexBuffer(
@@ -52,9 +53,10 @@ namespace Engine
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkBuffer &outBuffer,
-        VkDeviceMemory &outMemory);
+        MemoryAllocation &outMemory,
+        MemoryCategory category = MemoryCategory::Other);
 
-    // Copy bytes from src to dst using a one-time command buffer.
+    // Copy bytes from src to dst (at dstOffset) using a one-time command buffer.
     // Requirements:
     //  - src must have VK_BUFFER_USAGE_TRANSFER_SRC_BIT
     //  - dst must have VK_BUFFER_USAGE_TRANSFER_DST_BIT
@@ -64,6 +66,7 @@ namespace Engine
         VkQueue queue,
         VkBuffer src,
         VkBuffer dst,
-        VkDeviceSize size);
+        VkDeviceSize size,
+        VkDeviceSize dstOffset = 0);
 
 } // namespace Engine
\ No newline at end of file
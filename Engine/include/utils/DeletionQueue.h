@@ -0,0 +1,79 @@
+#pragma once
+/*
+  DeletionQueue.h
+  ---------------
+  Purpose:
+    - Frame-fenced destruction of GPU resources. Buffers, images, descriptor sets and memory that
+      frames in flight may still use are queued instead of destroyed, and freed once the frame
+      being recorded when they were queued has finished on the GPU. Nothing waits for the device
+      to go idle: runtime unloads and buffer growth cost no stall.
+
+  Usage:
+    - VulkanContext owns the queue for its device; code finds it through the VkDevice:
+    - DeletionQueue::Defer(device, [device, buffer, mem]() mutable
+                           { vkDestroyBuffer(device, buffer, nullptr); FreeMemory(mem); });
+    - The Renderer tags frames: endFrame() after each submit, collect() once a frame's in-flight
+      fence has signalled.
+
+  Notes:
+    - Items queued while frame N is recorded run after frame N completes, so they may still be
+      referenced by commands recorded earlier in frame N.
+    - Without a queue for the device (tools, no renderer) Defer() destroys at once.
+    - flush() waits for the device and runs everything: owners of state the items touch (the
+      AssetManager's geometry arena) flush before destroying it.
+    - Thread safe.
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace Engine
+{
+    class DeletionQueue
+    {
+    public:
+        // Registers itself for its device (see ForDevice()).
+        explicit DeletionQueue(VkDevice device);
+        // Runs what is left: the device must be idle.
+        ~DeletionQueue();
+
+        DeletionQueue(const DeletionQueue &) = delete;
+        DeletionQueue &operator=(const DeletionQueue &) = delete;
+
+        // Runs 'destroy' once the frame being recorded now has finished.
+        void push(std::function<void()> destroy);
+
+        // The frame being recorded was submitted; returns its serial for collect().
+        uint64_t endFrame();
+        // Frames up to 'serial' have finished: runs their items.
+        void collect(uint64_t serial);
+        // Waits for the device to go idle and runs every item.
+        void flush();
+
+        size_t getPendingCount() const;
+
+        // The queue registered for 'device', or nullptr.
+        static DeletionQueue *ForDevice(VkDevice device);
+        // Queues 'destroy' on the device's queue, or runs it now when there is none.
+        static void Defer(VkDevice device, std::function<void()> destroy);
+
+    private:
+        struct Item
+        {
+            uint64_t frame = 0;
+            std::function<void()> destroy;
+        };
+
+        void runUntil_Internal(uint64_t serial);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        mutable std::mutex m_mutex;
+        std::deque<Item> m_items; // in frame order
+        uint64_t m_frame = 1;     // serial of the frame being recorded
+    };
+
+} // namespace Engine
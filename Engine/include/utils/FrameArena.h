@@ -0,0 +1,172 @@
+#pragma once
+/*
+  FrameArena.h
+  ------------
+  Purpose:
+    - Scratch memory for containers that live for one frame (or one simulation tick): a bump
+      allocator per thread, reset wholesale at frame start instead of freeing block by block, so
+      transient maps and vectors stop hitting the general heap every frame.
+
+  Usage:
+    - Engine::FrameArena arena; arena.resize(jobs.threadCount());   // owner, before use
+    - arena.beginFrame();                                            // owner, at its sync point
+    - Engine::ArenaVector<uint32_t> rows(Engine::ArenaAllocator<uint32_t>(&arena.local()));
+    - SystemBase::setFrameArena(&arena); ... scratchArena()          // systems (see SystemFormat.h)
+
+  Notes:
+    - local() is indexed by JobSystem::currentThreadIndex(), like WorkerLocal: one FrameArena per
+      job pool. The simulation thread and the render thread are both index 0, so each owns its own.
+    - An ArenaAllocator keeps the arena it was made with: fill a container on the thread that
+      created it (parallel jobs take their own from local()).
+    - Containers must be destroyed before the beginFrame() that recycles their slot (deallocation is
+      a no-op; destructors still walk the memory). With framesInFlight > 1 a slot is recycled that
+      many frames later, for data consumed by the renderer after the frame that built it.
+    - A frame that outgrows its arena chains another block; the next reset of that arena merges
+      them into one block of the combined size, so steady state allocates nothing.
+    - ArenaAllocator with a null arena falls back to operator new/delete: code written for a
+      FrameArena still runs where none is attached (tools, benchmarks).
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    // Bump allocator over a chain of blocks; single-threaded.
+    class LinearArena
+    {
+    public:
+        static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+        explicit LinearArena(size_t blockSize = kDefaultBlockSize) : m_blockSize(blockSize) {}
+        LinearArena(LinearArena &&) = default;
+        LinearArena &operator=(LinearArena &&) = default;
+
+        void *allocate(size_t bytes, size_t alignment)
+        {
+            const uintptr_t aligned = (m_cursor + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+            if (m_cursor != 0 && aligned + bytes <= m_end)
+            {
+                m_cursor = aligned + bytes;
+                m_used += bytes;
+                return reinterpret_cast<void *>(aligned);
+            }
+            return allocateSlow(bytes, alignment);
+        }
+
+        // Forget every allocation; blocks are kept (merged into one when there are several)
+        void reset();
+
+        size_t used() const { return m_used; }         // bytes handed out since the last reset
+        size_t capacity() const { return m_capacity; } // bytes held in blocks
+        size_t peak() const { return m_peak; }         // largest used() seen at a reset
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> memory;
+            size_t size = 0;
+        };
+
+        void *allocateSlow(size_t bytes, size_t alignment);
+        void startBlock(size_t index);
+
+        std::vector<Block> m_blocks;
+        size_t m_current = 0; // block m_cursor points into
+        uintptr_t m_cursor = 0;
+        uintptr_t m_end = 0;
+        size_t m_blockSize;
+        size_t m_used = 0;
+        size_t m_capacity = 0;
+        size_t m_peak = 0;
+    };
+
+    // One LinearArena per job thread per frame in flight.
+    class FrameArena
+    {
+    public:
+        explicit FrameArena(uint32_t framesInFlight = 1, size_t blockSize = LinearArena::kDefaultBlockSize);
+
+        // Arenas per slot; call with JobSystem::threadCount() before the first frame (keeps contents
+        // of existing threads' arenas)
+        void resize(uint32_t threadCount);
+        uint32_t threadCount() const { return m_threads; }
+
+        // Next slot, reset on every thread. No allocation may be in progress.
+        void beginFrame();
+
+        // Calling thread's arena in the current slot
+        LinearArena &local();
+
+        // Over every arena: bytes handed out in the current slot, and held
+        size_t used() const;
+        size_t capacity() const;
+
+    private:
+        uint32_t m_frames;
+        uint32_t m_threads = 0;
+        uint32_t m_slot = 0;
+        size_t m_blockSize;
+        std::vector<LinearArena> m_arenas; // [slot][thread]
+    };
+
+    // STL allocator over a LinearArena (heap when null). Copies share the arena; memory is given
+    // back by LinearArena::reset(), never by deallocate().
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        ArenaAllocator() noexcept = default;
+        explicit ArenaAllocator(LinearArena *arena) noexcept : m_arena(arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : m_arena(other.arena())
+        {
+        }
+
+        T *allocate(size_t n)
+        {
+            if (!m_arena)
+                return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+            return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *p, size_t) noexcept
+        {
+            if (!m_arena)
+                ::operator delete(p, std::align_val_t(alignof(T)));
+        }
+
+        LinearArena *arena() const noexcept { return m_arena; }
+
+    private:
+        LinearArena *m_arena = nullptr;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept
+    {
+        return a.arena() == b.arena();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) noexcept
+    {
+        return a.arena() != b.arena();
+    }
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    template <typename K, typename V, typename Hash = std::hash<K>>
+    using ArenaHashMap = std::unordered_map<K, V, Hash, std::equal_to<K>, ArenaAllocator<std::pair<const K, V>>>;
+
+} // namespace Engine
@@ -0,0 +1,75 @@
+#pragma once
+/*
+  HitchDetector.h
+  ---------------
+  Purpose:
+    - Catches rare frame spikes that cannot be reproduced on demand. Keeps the last few frames
+      (CPU scopes, GPU passes, asset events, memory and allocation counts, render statistics) in a
+      ring; when a frame takes longer than a multiple of the rolling median frame time, the ring
+      is frozen and written to disk as a Chrome trace JSON file with a per-frame breakdown.
+
+  Usage:
+    - HitchDetectorConfig config; config.threshold = 3.0f;
+    - Application::EnableHitchDetector(config);                 // PerformanceMonitor drives it
+    - HitchDetector::assetEvent("asset", "Load Knight", t0, t1); // any thread, while enabled()
+    - HitchDetector::addFrame(info, Profiler::lastFrame(), gpuSpans); // per frame, after Profiler::endFrame()
+
+  Notes:
+    - Keeps Profiler scopes on while enabled (a relaxed check per scope plus the per-thread
+      buffers); a hitch inside an unscoped call shows as a gap in its parent scope.
+    - The dump holds historyFrames frames before the hitch and framesAfter frames after it: GPU
+      timings arrive frames in flight frames late, so the hitch frame's GPU passes land in those.
+    - Frames are compared with the median of the last medianFrames, so a slow but steady frame
+      rate (big battle, low-end GPU) is not a hitch; the frame that writes a dump is not measured.
+    - The file opens in ui.perfetto.dev; "hitch" and "frames" hold the summary (heaviest scopes of
+      the hitch frame, and per frame: times, memory, allocations, draws, asset events).
+*/
+
+#include "utils/Profiler.h"
+#include "utils/TraceCapture.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    struct HitchDetectorConfig
+    {
+        float threshold = 2.5f;         // hitch: frame time above this multiple of the rolling median
+        float minHitchMs = 25.0f;       // ... and at least this long (spikes at high frame rates are harmless)
+        uint32_t medianFrames = 120;    // rolling median window
+        uint32_t historyFrames = 16;    // frames before the hitch kept in a dump
+        uint32_t framesAfter = 4;       // frames after it (GPU timings of the hitch frame)
+        uint32_t cooldownFrames = 300;  // no new dump sooner after the last one
+        uint32_t maxDumps = 20;         // per run; detection stops after the last
+        std::string directory = "hitches";
+    };
+
+    class HitchDetector
+    {
+    public:
+        // What PerformanceMonitor measured for a frame
+        struct FrameInfo
+        {
+            float frameMs = 0.0f;
+            float cpuMs = 0.0f;
+            float gpuMs = 0.0f;             // frames in flight frames old
+            uint32_t gpuAllocations = 0;    // live, MemoryAllocator::Stats::allocationCount
+            uint64_t gpuUsedBytes = 0;
+        };
+
+        static void enable(const HitchDetectorConfig &config);
+        static void disable();
+        static bool enabled();
+        static uint32_t dumpsWritten();
+
+        // Interval not bound to a thread (loads, streaming); kept with the frame it ends in
+        static void assetEvent(const char *category, const std::string &name, uint64_t startNs, uint64_t endNs);
+
+        // Main thread, once per frame. 'gpu' as for TraceCapture::addFrame(). True when this frame
+        // wrote a dump.
+        static bool addFrame(const FrameInfo &info, const Profiler::Frame &cpu, const std::vector<TraceCapture::GpuSpan> &gpu);
+    };
+
+} // namespace Engine
@@ -2,6 +2,7 @@
 #include <vulkan/vulkan.h>
 #include <cstdint>
 #include <vector>
+#include "utils/MemoryAllocator.h"
 
 namespace Engine
 {
@@ -9,11 +10,11 @@ namespace Engine
     // Staging buffer handle
     // ============================================================
     // Used to upload pixel bytes to GPU images.
-    // This is CPU-visible memory.
+    // This is CPU-visible memory (linear MemoryAllocator pool).
     struct StagingBufferHandle
     {
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        MemoryAllocation memory;
         VkDeviceSize size = 0;
     };
 
@@ -25,9 +26,25 @@ namespace Engine
         VkDeviceSize dataSize,
         StagingBufferHandle &out);
 
+    // Same, left unfilled: the caller writes out.memory.mapped (persistently mapped).
+    VkResult CreateStagingBuffer(
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        VkDeviceSize dataSize,
+        StagingBufferHandle &out);
+
     // Destroy staging buffer resources.
     void DestroyStagingBuffer(VkDevice device, StagingBufferHandle &h);
 
+    // A slice of an upload's staging memory (AllocateStaging()): copy from 'buffer' at 'offset';
+    // 'mapped' points at the slice's bytes.
+    struct StagingSlice
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        uint8_t *mapped = nullptr;
+    };
+
     // ============================================================
     // UploadContext (optimized path)
     // ============================================================
@@ -39,6 +56,12 @@ namespace Engine
     //   ... record transitions + buffer copies for multiple textures ...
     //   EndSubmitAndWait(ctx);
     //
+    // With a dedicated transfer queue (VulkanContext::GetTransferQueue()), the staging copies go to
+    // a second command buffer on that queue: CmdTransitionImageLayout() from UNDEFINED to
+    // TRANSFER_DST and CmdCopyBufferToImage() record there, CmdAcquireUploadedImage() hands the
+    // image to the graphics family (release there, acquire in cmd), and EndSubmitAndWait() submits
+    // both, the graphics one waiting on the copies with a semaphore.
+    //
     struct UploadContext
     {
         VkDevice device = VK_NULL_HANDLE;
@@ -48,11 +71,28 @@ namespace Engine
 
         VkCommandBuffer cmd = VK_NULL_HANDLE;
 
+        // Dedicated transfer queue, when used (transferCmd not null).
+        VkCommandPool transferPool = VK_NULL_HANDLE;
+        VkQueue transferQueue = VK_NULL_HANDLE;
+        VkCommandBuffer transferCmd = VK_NULL_HANDLE;
+        uint32_t transferFamily = VK_QUEUE_FAMILY_IGNORED;
+        uint32_t graphicsFamily = VK_QUEUE_FAMILY_IGNORED;
+
         // Staging buffers must stay alive until GPU copy finishes.
         // We'll collect them here and destroy at the end.
         std::vector<StagingBufferHandle> pendingStaging;
 
+        // AllocateStaging(): the block slices come from (index into pendingStaging) and its used bytes
+        size_t stagingBlock = SIZE_MAX;
+        VkDeviceSize stagingUsed = 0;
+
+        // Set by EndSubmit() until FinishUpload(): signalled when all of it has run, and the
+        // semaphore between the transfer and graphics submits.
+        VkFence fence = VK_NULL_HANDLE;
+        VkSemaphore copiedSemaphore = VK_NULL_HANDLE;
+
         bool begun = false;
+        bool submitted = false;
     };
 
     bool BeginUploadContext(
@@ -62,14 +102,47 @@ namespace Engine
         VkCommandPool commandPool,
         VkQueue queue);
 
+    // Same, with the copies on a dedicated transfer queue when transferQueue is set and
+    // transferFamily differs from graphicsFamily (transferPool is of that family); otherwise like
+    // the overload above.
+    bool BeginUploadContext(
+        UploadContext &ctx,
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        VkCommandPool commandPool,
+        VkQueue queue,
+        uint32_t graphicsFamily,
+        VkCommandPool transferPool,
+        VkQueue transferQueue,
+        uint32_t transferFamily);
+
+    // Staging suballocation: the uploads of a batch (AssetManager::loadModel() records a whole model)
+    // share one staging buffer instead of one each. AllocateStaging() hands out 16-byte aligned
+    // slices (valid for buffer and image copies) of the current block and starts a new block of
+    // max(size, kUploadStagingBlockSize) when it is full. ReserveStaging() sizes the first block for
+    // what the batch is expected to stage, so it needs only the one buffer; call it before the first
+    // AllocateStaging(). StageBytes() is AllocateStaging() plus a memcpy of 'data'.
+    inline constexpr VkDeviceSize kUploadStagingBlockSize = 16ull << 20;
+    bool ReserveStaging(UploadContext &ctx, VkDeviceSize bytes);
+    bool AllocateStaging(UploadContext &ctx, VkDeviceSize size, StagingSlice &out);
+    bool StageBytes(UploadContext &ctx, const void *data, VkDeviceSize size, StagingSlice &out);
+
     // Submits command buffer, waits for completion, destroys staging buffers, frees cmd buffer.
     bool EndSubmitAndWait(UploadContext &ctx);
 
+    // The same in two steps, for uploads that must not stall the caller (AssetManager::
+    // loadModelAsync()): EndSubmit() submits and returns, IsUploadComplete() polls ctx.fence, and
+    // FinishUpload() (waiting if the upload is still running) frees what EndSubmitAndWait() frees.
+    // The pools stay the caller's and must outlive FinishUpload().
+    bool EndSubmit(UploadContext &ctx);
+    bool IsUploadComplete(const UploadContext &ctx);
+    bool FinishUpload(UploadContext &ctx);
+
     // ============================================================
     // Image creation helpers
     // ============================================================
 
-    // Create a 2D GPU image (device local).
+    // Create a 2D GPU image (device local), accounted to 'category' in the allocator's stats.
     // Phase 1: mipLevels = 1 (mipmaps later).
     VkResult CreateImage2D(
         VkDevice device,
@@ -79,7 +152,8 @@ namespace Engine
         VkFormat format,
         VkImageUsageFlags usage,
         VkImage &outImage,
-        VkDeviceMemory &outMemory);
+        MemoryAllocation &outMemory,
+        MemoryCategory category = MemoryCategory::Other);
 
     // Create a 2D GPU image with explicit mip levels.
     VkResult CreateImage2D(
@@ -91,7 +165,8 @@ namespace Engine
         VkImageUsageFlags usage,
         uint32_t mipLevels,
         VkImage &outImage,
-        VkDeviceMemory &outMemory);
+        MemoryAllocation &outMemory,
+        MemoryCategory category = MemoryCategory::Other);
 
     // Create an image view for sampling.
     VkResult CreateImageView2D(
@@ -123,6 +198,15 @@ namespace Engine
         VkImageLayout newLayout,
         VkImageAspectFlags aspectFlags);
 
+    // Same, for mips [0, mipLevels).
+    void CmdTransitionImageLayout(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageLayout oldLayout,
+        VkImageLayout newLayout,
+        VkImageAspectFlags aspectFlags,
+        uint32_t mipLevels);
+
     void CmdCopyBufferToImage(
         UploadContext &ctx,
         VkBuffer buffer,
@@ -130,6 +214,49 @@ namespace Engine
         uint32_t width,
         uint32_t height);
 
+    // Same, reading the pixels from a staging slice.
+    void CmdCopyBufferToImage(
+        UploadContext &ctx,
+        const StagingSlice &src,
+        VkImage image,
+        uint32_t width,
+        uint32_t height);
+
+    // Copies 'size' bytes of a staging slice to 'dst' at 'dstOffset'. Recorded into cmd (the graphics
+    // family owns the destination buffers), not the transfer queue's command buffer.
+    void CmdCopyBuffer(
+        UploadContext &ctx,
+        const StagingSlice &src,
+        VkBuffer dst,
+        VkDeviceSize size,
+        VkDeviceSize dstOffset);
+
+    // After CmdCopyBufferToImage(): moves mip 0 (TRANSFER_DST_OPTIMAL) from the transfer to the
+    // graphics queue family, so cmd can generate mips or transition it. No-op without a dedicated
+    // transfer queue.
+    void CmdAcquireUploadedImage(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageAspectFlags aspectFlags);
+
+    // Same, for mips [0, mipLevels) (prebuilt chains copied with CmdCopyMipChainToImage()).
+    void CmdAcquireUploadedImage(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageAspectFlags aspectFlags,
+        uint32_t mipLevels);
+
+    // Copies a prebuilt block-compressed mip chain (mips tightly packed from src.offset, mip 0 first,
+    // 'blockBytes' per 4x4 block) into mips [0, mipLevels), all in TRANSFER_DST_OPTIMAL.
+    void CmdCopyMipChainToImage(
+        UploadContext &ctx,
+        const StagingSlice &src,
+        VkImage image,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevels,
+        uint32_t blockBytes);
+
     // Record mipmap generation via blits for a 2D color image.
     // Expects mip 0 to be in TRANSFER_DST_OPTIMAL.
     // On success, transitions all mips to SHADER_READ_ONLY_OPTIMAL.
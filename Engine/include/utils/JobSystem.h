@@ -0,0 +1,113 @@
+#pragma once
+/*
+  JobSystem.h
+  -----------
+  Purpose:
+    - Small work-stealing thread pool used by the ECS scheduler and parallel queries.
+    - Each worker owns a deque: it pushes/pops at the back (LIFO, cache friendly) and
+      idle workers steal from the front of other deques.
+
+  Usage:
+    - Engine::JobSystem jobs;                  // hardware_concurrency - 1 workers
+    - Engine::JobSystem::Counter c;
+    - jobs.submit(c, []{ ... });               // any number of jobs
+    - jobs.wait(c);                            // caller helps execute jobs until c reaches zero
+
+  Notes:
+    - Thread index 0 is reserved for the thread that calls wait() (normally the main thread);
+      workers are 1..workerCount(). Use currentThreadIndex() to pick per-thread scratch data.
+    - A JobSystem with zero workers runs everything inline inside wait().
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+    class JobSystem
+    {
+    public:
+        // Completion counter shared by a group of jobs.
+        struct Counter
+        {
+            std::atomic<uint32_t> pending{0};
+
+            bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+        };
+
+        // workerCount == UINT32_MAX picks hardware_concurrency() - 1.
+        explicit JobSystem(uint32_t workerCount = UINT32_MAX);
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        // Number of background worker threads.
+        uint32_t workerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+        // Number of threads that may execute jobs (workers + the waiting thread).
+        uint32_t threadCount() const { return workerCount() + 1; }
+
+        // Queue a job; the counter is incremented now and decremented when the job finishes.
+        void submit(Counter &counter, std::function<void()> job);
+
+        // Block until the counter reaches zero, executing queued jobs in the meantime.
+        void wait(Counter &counter);
+
+        // 0 for non-worker threads, 1..workerCount() for pool workers.
+        static uint32_t currentThreadIndex();
+
+    private:
+        struct Job
+        {
+            std::function<void()> fn;
+            Counter *counter = nullptr;
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void workerLoop(uint32_t workerIndex);
+        bool popOrSteal(uint32_t queueIndex, Job &out);
+        void execute(Job &job);
+
+    private:
+        // Queue 0 receives jobs from non-worker threads; queue i (i >= 1) belongs to worker i.
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCv;
+        std::atomic<uint32_t> m_queuedJobs{0};
+        std::atomic<bool> m_stop{false};
+    };
+
+    // Per-thread scratch storage indexed by JobSystem::currentThreadIndex().
+    // Size it with jobs.threadCount() before running parallel work.
+    template <typename T>
+    class WorkerLocal
+    {
+    public:
+        void resize(uint32_t threadCount) { m_slots.resize(threadCount); }
+
+        T &local() { return m_slots[JobSystem::currentThreadIndex()]; }
+
+        uint32_t size() const { return static_cast<uint32_t>(m_slots.size()); }
+        T &operator[](uint32_t i) { return m_slots[i]; }
+        const T &operator[](uint32_t i) const { return m_slots[i]; }
+
+    private:
+        std::vector<T> m_slots;
+    };
+
+} // namespace Engine
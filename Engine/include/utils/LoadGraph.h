@@ -0,0 +1,77 @@
+#pragma once
+/*
+  LoadGraph.h
+  -----------
+  Purpose:
+    - Dependency graph of load tasks for startup: file reads and parsing run on a JobSystem, work
+      that touches main-thread state (ECS registries, the AssetManager) runs on the thread that
+      calls run(), each task as soon as everything it depends on has finished.
+
+  Usage:
+    - Engine::LoadGraph graph;
+    - auto parse = graph.add("parse a.json", LoadGraph::Affinity::Worker, [&] { return parse(a); });
+    - graph.add("register a", LoadGraph::Affinity::Main, [&] { return registerA(); }, {parse});
+    - graph.run(jobs); // returns once every task has run or been skipped
+
+  Notes:
+    - A task returning false fails; tasks depending on it (directly or not) are skipped.
+    - Dependencies must be added before their dependents, so the graph is acyclic by construction.
+    - Worker tasks run on the calling thread too when the JobSystem has no workers.
+    - run() logs the wall time and the slowest task under "[LoadGraph]".
+*/
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    class JobSystem;
+
+    class LoadGraph
+    {
+    public:
+        using TaskId = uint32_t;
+
+        enum class Affinity : uint8_t
+        {
+            Worker, // any JobSystem thread
+            Main    // the thread calling run()
+        };
+
+        struct Stats
+        {
+            uint32_t tasks = 0;
+            uint32_t failed = 0;
+            uint32_t skipped = 0; // a dependency failed
+            double wallMs = 0.0;
+            double taskMs = 0.0; // summed over tasks: taskMs / wallMs is the achieved parallelism
+        };
+
+        TaskId add(std::string name, Affinity affinity, std::function<bool()> fn, std::initializer_list<TaskId> dependencies = {});
+        // 'dependency' must have been added before 'task'.
+        void addDependency(TaskId task, TaskId dependency);
+
+        // Runs every task; true when none failed or was skipped. The graph is spent afterwards.
+        bool run(JobSystem &jobs);
+
+        const Stats &getStats() const { return m_stats; }
+
+    private:
+        struct Task
+        {
+            std::string name;
+            Affinity affinity = Affinity::Worker;
+            std::function<bool()> fn;
+            std::vector<TaskId> dependents;
+            uint32_t dependencyCount = 0;
+            double ms = 0.0;
+        };
+
+        std::vector<Task> m_tasks;
+        Stats m_stats;
+    };
+
+} // namespace Engine
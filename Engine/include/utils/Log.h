@@ -0,0 +1,107 @@
+#pragma once
+/*
+  Log.h
+  -----
+  Purpose:
+    - Asynchronous engine logging. Callers format into a per-thread lock-free ring buffer and return;
+      a background flusher thread drains every ring and writes to stdout/stderr in batches, so logging
+      from a system loop never blocks on console I/O.
+    - Compile-time level filtering: ENGINE_LOG_<LEVEL>() below ENGINE_LOG_LEVEL compiles to nothing
+      (arguments are not evaluated). Log::setLevel() filters further at runtime.
+
+  Usage:
+    - ENGINE_LOG_INFO("[Scenario] Loading: %s", name.c_str());   // printf-style, newline appended
+    - ENGINE_LOG_DEBUG("[Steering] Unit %u arrived", row);        // gone when ENGINE_LOG_LEVEL > 1
+    - Engine::Log::flush();                                        // drain now (e.g. before a crash dump)
+
+  Notes:
+    - ENGINE_LOG_LEVEL: 0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 off. Defaults to debug, or info
+      with NDEBUG. Set it from CMake with -DENGINE_LOG_LEVEL=<n>.
+    - Warn and Error go to stderr, the rest to stdout. Order is preserved per thread, not across threads.
+    - Messages longer than Log::kMessageBytes are truncated. A full ring drops the message and counts
+      it; the flusher reports the count instead of stalling the producer.
+    - Rings outlive their threads and are reused by the next thread that logs. The flusher is joined
+      (after a final drain) at static destruction; later writes go straight to the console.
+*/
+
+#include <cstdint>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ENGINE_LOG_PRINTF_FORMAT(fmtIndex, argIndex) __attribute__((format(printf, fmtIndex, argIndex)))
+#else
+#define ENGINE_LOG_PRINTF_FORMAT(fmtIndex, argIndex)
+#endif
+
+#ifndef ENGINE_LOG_LEVEL
+#ifdef NDEBUG
+#define ENGINE_LOG_LEVEL 2
+#else
+#define ENGINE_LOG_LEVEL 1
+#endif
+#endif
+
+namespace Engine::Log
+{
+    enum class Level : uint8_t
+    {
+        Trace = 0,
+        Debug = 1,
+        Info = 2,
+        Warn = 3,
+        Error = 4,
+        Off = 5
+    };
+
+    static constexpr uint32_t kMessageBytes = 240; // per message, including the terminator
+    static constexpr uint32_t kRingSlots = 1024;   // per thread, power of two
+
+    // Format and enqueue one line. Never blocks on I/O.
+    void write(Level level, const char *fmt, ...) ENGINE_LOG_PRINTF_FORMAT(2, 3);
+
+    // Runtime filter on top of ENGINE_LOG_LEVEL (default: everything compiled in).
+    void setLevel(Level level);
+    Level level();
+
+    // Drain all rings and flush the console streams on the calling thread.
+    void flush();
+
+    // Final drain and join of the flusher thread. Called automatically at exit.
+    void shutdown();
+
+    // Messages dropped because a ring was full (since start).
+    uint64_t droppedCount();
+
+} // namespace Engine::Log
+
+#define ENGINE_LOG_AT(lvl, ...) ::Engine::Log::write(::Engine::Log::Level::lvl, __VA_ARGS__)
+#define ENGINE_LOG_DISCARD(...) do { if (false) ::Engine::Log::write(::Engine::Log::Level::Off, __VA_ARGS__); } while (0)
+
+#if ENGINE_LOG_LEVEL <= 0
+#define ENGINE_LOG_TRACE(...) ENGINE_LOG_AT(Trace, __VA_ARGS__)
+#else
+#define ENGINE_LOG_TRACE(...) ENGINE_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if ENGINE_LOG_LEVEL <= 1
+#define ENGINE_LOG_DEBUG(...) ENGINE_LOG_AT(Debug, __VA_ARGS__)
+#else
+#define ENGINE_LOG_DEBUG(...) ENGINE_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if ENGINE_LOG_LEVEL <= 2
+#define ENGINE_LOG_INFO(...) ENGINE_LOG_AT(Info, __VA_ARGS__)
+#else
+#define ENGINE_LOG_INFO(...) ENGINE_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if ENGINE_LOG_LEVEL <= 3
+#define ENGINE_LOG_WARN(...) ENGINE_LOG_AT(Warn, __VA_ARGS__)
+#else
+#define ENGINE_LOG_WARN(...) ENGINE_LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if ENGINE_LOG_LEVEL <= 4
+#define ENGINE_LOG_ERROR(...) ENGINE_LOG_AT(Error, __VA_ARGS__)
+#else
+#define ENGINE_LOG_ERROR(...) ENGINE_LOG_DISCARD(__VA_ARGS__)
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+/*
+  MappedFile.h
+  ------------
+  Purpose:
+    - Read-only memory mapping of a whole file (mmap on POSIX, file mapping objects on Windows),
+      so large binary blobs (world snapshots, cooked assets) can be read without a copy into a
+      temporary buffer.
+
+  Usage:
+    - Engine::MappedFile file;
+    - if (file.open("world.snap")) { const std::byte *p = file.data(); size_t n = file.size(); ... }
+
+  Notes:
+    - The mapping stays valid until close() or destruction; the class is move-only.
+    - Empty files open successfully with data() == nullptr and size() == 0.
+*/
+
+#include <cstddef>
+#include <string>
+
+namespace Engine
+{
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        bool open(const std::string &path);
+        void close();
+
+        bool isOpen() const { return m_open; }
+        const std::byte *data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const std::byte *m_data = nullptr;
+        size_t m_size = 0;
+        bool m_open = false;
+#if defined(_WIN32)
+        void *m_file = nullptr;    // HANDLE
+        void *m_mapping = nullptr; // HANDLE
+#endif
+    };
+
+} // namespace Engine
@@ -0,0 +1,191 @@
+#pragma once
+/*
+  MemoryAllocator.h
+  -----------------
+  Purpose:
+    - Device memory suballocation for every engine buffer and image, so resources share a few
+      large VkDeviceMemory blocks instead of one vkAllocateMemory each (maxMemoryAllocationCount
+      can be as low as 4096, and every allocation is a kernel call).
+    - Blocks are pooled per (memory type, buffer/image, strategy). General pools suballocate with
+      a TLSF allocator (two-level segregated fit, O(1) allocate and free with neighbour merging);
+      linear pools bump-allocate and rewind once every allocation of a block is freed, for
+      short-lived staging memory. Large requests and large images get a dedicated allocation.
+
+  Usage:
+    - VulkanContext owns the allocator for its device; helpers find it through the VkDevice:
+    - MemoryAllocation mem;
+    - AllocateBufferMemory(device, buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | ..., mem);
+      (allocates, binds, and for host-visible memory sets mem.mapped)
+    - ... vkDestroyBuffer(device, buffer, nullptr); FreeMemory(mem);
+    - Pass a MemoryCategory where the memory is allocated; getStats() reports live and peak bytes
+      per category, getHeapBudgets() what the driver reports per heap (VK_EXT_memory_budget).
+
+  Notes:
+    - Host-visible blocks are mapped once for their lifetime: use MemoryAllocation::mapped
+      (already offset to the allocation) and never vkMapMemory/vkUnmapMemory an allocation's
+      memory, which other allocations share.
+    - Buffers and images never share a block, so bufferImageGranularity needs no padding.
+    - Thread safe; free every allocation before the allocator is destroyed (leaks are logged).
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Engine
+{
+    class MemoryAllocator;
+
+    enum class MemoryStrategy : uint32_t
+    {
+        General = 0, // TLSF; any lifetime
+        Linear = 1   // bump allocation for transient memory (staging); a block rewinds when it empties
+    };
+
+    // What an allocation holds, for accounting only (pools do not depend on it).
+    enum class MemoryCategory : uint8_t
+    {
+        Geometry = 0,  // vertex, index and meshlet data
+        Textures,      // sampled asset images
+        RenderTargets, // attachments, depth, Hi-Z, render graph transients
+        Dynamic,       // per-frame buffers rewritten by the CPU (globals, palettes, instances)
+        Staging,       // upload sources
+        Other,
+        Count
+    };
+
+    const char *MemoryCategoryName(MemoryCategory category);
+
+    struct MemoryAllocation
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0; // bind offset inside 'memory'
+        VkDeviceSize size = 0;
+        void *mapped = nullptr; // host-visible memory only, already at 'offset'
+
+        // Owner bookkeeping
+        MemoryAllocator *allocator = nullptr;
+        uint32_t pool = UINT32_MAX; // UINT32_MAX: dedicated allocation
+        uint32_t block = 0;
+        uint32_t node = 0;
+        MemoryCategory category = MemoryCategory::Other;
+
+        bool isValid() const { return memory != VK_NULL_HANDLE; }
+    };
+
+    class MemoryAllocator
+    {
+    public:
+        struct Stats
+        {
+            uint32_t deviceAllocations = 0; // live vkAllocateMemory objects (blocks + dedicated)
+            uint32_t maxDeviceAllocations = 0;
+            uint32_t blockCount = 0;
+            uint32_t dedicatedCount = 0;
+            uint32_t allocationCount = 0; // live MemoryAllocations
+            VkDeviceSize blockBytes = 0;
+            VkDeviceSize dedicatedBytes = 0;
+            VkDeviceSize usedBytes = 0; // in blocks and dedicated allocations
+            VkDeviceSize deviceLocalBytes = 0; // of blockBytes + dedicatedBytes
+            VkDeviceSize hostVisibleBytes = 0;
+
+            // Live allocation bytes per MemoryCategory, and the most there ever were at once
+            VkDeviceSize categoryBytes[static_cast<size_t>(MemoryCategory::Count)] = {};
+            VkDeviceSize categoryPeakBytes[static_cast<size_t>(MemoryCategory::Count)] = {};
+        };
+
+        // One memory heap. With VK_EXT_memory_budget, budget and usage are the driver's (every
+        // process, refreshed by the driver); without it budget is the heap size and usage is this
+        // allocator's blocks and dedicated allocations in the heap.
+        struct HeapBudget
+        {
+            VkDeviceSize size = 0;
+            VkDeviceSize budget = 0;
+            VkDeviceSize usage = 0;
+            bool deviceLocal = false;
+        };
+
+        static constexpr VkDeviceSize kDeviceLocalBlockBytes = VkDeviceSize(64) << 20;
+        static constexpr VkDeviceSize kHostVisibleBlockBytes = VkDeviceSize(16) << 20;
+        static constexpr VkDeviceSize kDedicatedImageBytes = VkDeviceSize(16) << 20; // render targets, large textures
+
+        // Registers itself for its device (see ForDevice()).
+        MemoryAllocator(VkDevice device, VkPhysicalDevice phys);
+        ~MemoryAllocator();
+
+        MemoryAllocator(const MemoryAllocator &) = delete;
+        MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+        // 'isImage' selects image pools (optimal tiling) and the dedicated-image threshold.
+        VkResult allocate(const VkMemoryRequirements &requirements,
+                          VkMemoryPropertyFlags properties,
+                          bool isImage,
+                          MemoryStrategy strategy,
+                          MemoryAllocation &out,
+                          MemoryCategory category = MemoryCategory::Other);
+        void free(MemoryAllocation &allocation);
+
+        // Frees blocks with nothing allocated, keeping one empty block per pool.
+        void trim();
+
+        Stats getStats() const;
+
+        // Enabled by VulkanContext when the device has VK_EXT_memory_budget.
+        void setMemoryBudgetEnabled(bool enabled) { m_memoryBudget = enabled; }
+        bool memoryBudgetEnabled() const { return m_memoryBudget; }
+        // One entry per memory heap.
+        std::vector<HeapBudget> getHeapBudgets() const;
+
+        VkDevice getDevice() const { return m_device; }
+
+        // The allocator registered for 'device', or nullptr.
+        static MemoryAllocator *ForDevice(VkDevice device);
+
+    private:
+        struct Block;
+        struct Pool;
+
+        bool findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t &outType) const;
+        VkResult allocateDedicated(VkDeviceSize size, uint32_t memoryType, MemoryAllocation &out);
+        VkResult createBlock(Pool &pool, VkDeviceSize minSize, uint32_t &outBlock);
+        void destroyBlock(Block &block);
+        uint32_t poolFor(uint32_t memoryType, bool isImage, MemoryStrategy strategy); // index into m_pools
+        bool isHostVisible(uint32_t memoryType) const;
+        void trackAllocation(MemoryCategory category, VkDeviceSize size); // m_mutex held
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_phys = VK_NULL_HANDLE;
+        VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+        uint32_t m_maxAllocations = 0;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Pool>> m_pools;
+        uint32_t m_dedicatedCount = 0;
+        VkDeviceSize m_dedicatedBytes = 0;
+        VkDeviceSize m_dedicatedDeviceLocalBytes = 0;
+        VkDeviceSize m_dedicatedHeapBytes[VK_MAX_MEMORY_HEAPS] = {};
+        VkDeviceSize m_categoryBytes[static_cast<size_t>(MemoryCategory::Count)] = {};
+        VkDeviceSize m_categoryPeakBytes[static_cast<size_t>(MemoryCategory::Count)] = {};
+        bool m_memoryBudget = false;
+    };
+
+    // Allocate through the device's MemoryAllocator and bind; on failure 'out' stays invalid.
+    VkResult AllocateBufferMemory(VkDevice device,
+                                  VkBuffer buffer,
+                                  VkMemoryPropertyFlags properties,
+                                  MemoryAllocation &out,
+                                  MemoryStrategy strategy = MemoryStrategy::General,
+                                  MemoryCategory category = MemoryCategory::Other);
+
+    VkResult AllocateImageMemory(VkDevice device,
+                                 VkImage image,
+                                 VkMemoryPropertyFlags properties,
+                                 MemoryAllocation &out,
+                                 MemoryCategory category = MemoryCategory::Other);
+
+    // Returns the allocation to its allocator and resets it; invalid allocations are ignored.
+    void FreeMemory(MemoryAllocation &allocation);
+
+} // namespace Engine
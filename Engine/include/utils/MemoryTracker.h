@@ -0,0 +1,91 @@
+#pragma once
+/*
+  MemoryTracker.h
+  ---------------
+  Purpose:
+    - CPU memory accounting by category, next to MemoryAllocator's GPU categories: live bytes and
+      the high-water mark of each, for the performance overlay and benchmark output.
+
+  Usage:
+    - MemoryTracker::add(CpuMemoryCategory::EcsColumns, kChunkBytes);  // on allocation
+    - MemoryTracker::sub(CpuMemoryCategory::EcsColumns, kChunkBytes);  // on free
+    - MemoryTracker::set(CpuMemoryCategory::AssetData, bytes);         // owners that re-measure
+    - MemoryTracker::current(c) / MemoryTracker::peak(c)
+
+  Notes:
+    - Counts what the owners report, not every heap allocation: ECS chunks (ArchetypeStore
+      columns), asset CPU data and animation data (AssetManager::update() re-measures both).
+    - Relaxed atomics; any thread. A peak is exact for add() and as of the last set() otherwise.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine
+{
+    enum class CpuMemoryCategory : uint8_t
+    {
+        EcsColumns = 0, // archetype chunks
+        AssetData,      // model, mesh and texture data kept on the CPU, decoded images of pending loads
+        Animation,      // clips, baked palettes and pose caches of loaded models
+        Count
+    };
+
+    class MemoryTracker
+    {
+    public:
+        static constexpr size_t kCategoryCount = static_cast<size_t>(CpuMemoryCategory::Count);
+
+        static void add(CpuMemoryCategory c, uint64_t bytes)
+        {
+            const uint64_t now = s_current[index(c)].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            raisePeak(c, now);
+        }
+
+        static void sub(CpuMemoryCategory c, uint64_t bytes)
+        {
+            s_current[index(c)].fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        static void set(CpuMemoryCategory c, uint64_t bytes)
+        {
+            s_current[index(c)].store(bytes, std::memory_order_relaxed);
+            raisePeak(c, bytes);
+        }
+
+        static uint64_t current(CpuMemoryCategory c) { return s_current[index(c)].load(std::memory_order_relaxed); }
+        static uint64_t peak(CpuMemoryCategory c) { return s_peak[index(c)].load(std::memory_order_relaxed); }
+
+        static const char *name(CpuMemoryCategory c)
+        {
+            switch (c)
+            {
+            case CpuMemoryCategory::EcsColumns:
+                return "ECS columns";
+            case CpuMemoryCategory::AssetData:
+                return "Asset data";
+            case CpuMemoryCategory::Animation:
+                return "Animation";
+            default:
+                return "?";
+            }
+        }
+
+    private:
+        static size_t index(CpuMemoryCategory c) { return static_cast<size_t>(c); }
+
+        static void raisePeak(CpuMemoryCategory c, uint64_t bytes)
+        {
+            std::atomic<uint64_t> &peak = s_peak[index(c)];
+            uint64_t seen = peak.load(std::memory_order_relaxed);
+            while (bytes > seen && !peak.compare_exchange_weak(seen, bytes, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        static inline std::atomic<uint64_t> s_current[kCategoryCount] = {};
+        static inline std::atomic<uint64_t> s_peak[kCategoryCount] = {};
+    };
+
+} // namespace Engine
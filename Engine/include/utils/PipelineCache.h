@@ -0,0 +1,115 @@
+#pragma once
+/*
+  PipelineCache.h
+  ---------------
+  Purpose:
+    - One VkPipelineCache for every pipeline the engine creates (Pipeline::create(), the compute
+      passes, ImGui), loaded from disk at startup and written back at shutdown, so drivers skip
+      shader compilation for pipelines built in an earlier run.
+    - In-memory sharing of identical graphics pipelines: Pipeline::create() describes the final
+      create info as a byte key, and a second Pipeline with the same key gets the first one's
+      VkPipeline (reference counted) instead of building its own.
+
+  Usage:
+    - VulkanContext owns the cache for its device; code finds it through the VkDevice:
+    - vkCreateComputePipelines(device, PipelineCache::HandleFor(device), ...);
+    - Pipeline::create()/destroy() and Pipeline::createShaderModuleFromFile() use it on their own.
+
+  Notes:
+    - The file starts with a header naming the device (vendor, device, driver version, pipeline
+      cache UUID); a file written for another device or driver is ignored, as is a damaged one.
+    - Shader modules created through Pipeline::createShaderModuleFromFile() are keyed by their
+      SPIR-V, so modules loaded from the same file twice still share pipelines; other modules by
+      handle.
+    - Thread safe.
+*/
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Engine
+{
+    class PipelineCache
+    {
+    public:
+        struct Stats
+        {
+            size_t loadedBytes = 0;       // initial data taken from disk (0: started empty)
+            uint32_t sharedPipelines = 0; // live deduplicated pipelines
+            uint32_t hits = 0;            // Pipeline::create() calls served by a live pipeline
+            uint32_t misses = 0;
+        };
+
+        static constexpr const char *kDefaultPath = "pipeline_cache.bin";
+
+        // Loads 'path' if it matches the device and registers itself for 'device' (see ForDevice()).
+        PipelineCache(VkDevice device, VkPhysicalDevice phys, std::string path = kDefaultPath);
+        ~PipelineCache();
+
+        PipelineCache(const PipelineCache &) = delete;
+        PipelineCache &operator=(const PipelineCache &) = delete;
+
+        // Writes the cache data to the path given at construction (through a temporary file).
+        bool save() const;
+
+        VkPipelineCache getHandle() const { return m_cache; }
+
+        // Deduplication. acquire() returns the live pipeline for 'key' with one more reference, or
+        // VK_NULL_HANDLE. insert() adds a new pipeline with one reference; when another thread inserted
+        // the same key first, 'pipeline' is destroyed and the existing one returned instead.
+        // release() drops one reference (destroying the pipeline with the last) and returns false for
+        // pipelines the cache does not know, which the caller destroys itself.
+        VkPipeline acquire(const std::string &key);
+        VkPipeline insert(const std::string &key, VkPipeline pipeline);
+        bool release(VkPipeline pipeline);
+
+        void registerShaderModule(VkShaderModule module, uint64_t codeHash);
+        // Tag byte + SPIR-V hash or handle, for pipeline keys.
+        std::string shaderModuleKey(VkShaderModule module) const;
+
+        Stats getStats() const;
+
+        // The cache registered for 'device', or nullptr / VK_NULL_HANDLE.
+        static PipelineCache *ForDevice(VkDevice device);
+        static VkPipelineCache HandleFor(VkDevice device);
+
+        // FNV-1a, for SPIR-V code.
+        static uint64_t HashBytes(const void *data, size_t size);
+
+    private:
+        struct FileHeader
+        {
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            uint32_t vendorID = 0;
+            uint32_t deviceID = 0;
+            uint32_t driverVersion = 0;
+            uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
+            uint64_t dataSize = 0;
+            uint64_t dataHash = 0;
+        };
+
+        struct Shared
+        {
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            uint32_t refs = 0;
+        };
+
+        FileHeader makeHeader() const;
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDeviceProperties m_props{};
+        std::string m_path;
+        VkPipelineCache m_cache = VK_NULL_HANDLE;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Shared> m_shared;
+        std::unordered_map<VkPipeline, std::string> m_keyOf;
+        std::unordered_map<VkShaderModule, uint64_t> m_shaderHashes;
+        Stats m_stats;
+    };
+
+} // namespace Engine
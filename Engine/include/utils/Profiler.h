@@ -0,0 +1,119 @@
+#pragma once
+/*
+  Profiler.h
+  ----------
+  Purpose:
+    - Hierarchical CPU scope timers for finding which system or render stage a frame goes to.
+      Scopes nest per thread; every thread that opens one gets its own row in the timeline.
+
+  Usage:
+    - Engine::Profiler::setEnabled(true);      // PerformanceMonitor does this while visible
+    - Engine::Profiler::beginFrame();          // once per frame, on the main thread
+    - { ENGINE_PROFILE_SCOPE("Physics"); ... } // any thread, any depth
+    - Engine::Profiler::endFrame();            // publishes lastFrame() and updates stats()
+
+  Notes:
+    - Scope names are kept by pointer: pass string literals or strings that outlive the profiler.
+      Scopes with equal names (in different places) share one entry in stats().
+    - Disabled, a scope is one relaxed atomic load. A scope open when profiling is switched off
+      still closes normally.
+    - lastFrame() and stats() belong to the thread calling endFrame(); read them from there.
+    - Built with ENGINE_ALLOC_TRACKING, scopes also count the heap allocations made inside them
+      (see AllocTracker.h).
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    class Profiler
+    {
+    public:
+        struct Event
+        {
+            const char *name = nullptr;
+            uint64_t startNs = 0; // Profiler::now()
+            uint64_t endNs = 0;
+            uint16_t depth = 0;   // 0: outermost scope of its thread
+            uint16_t thread = 0;  // index into Frame::threads
+            uint32_t allocations = 0; // heap allocations inside, nested scopes included (AllocTracker)
+            uint64_t allocBytes = 0;
+        };
+
+        // Scopes closed between beginFrame() and endFrame(), grouped by thread and sorted by start.
+        struct Frame
+        {
+            uint64_t startNs = 0;
+            uint64_t endNs = 0;
+            std::vector<Event> events;
+            std::vector<std::string> threads; // "Main", "Worker 3", ...
+            uint32_t dropped = 0;             // events past the per-thread cap
+        };
+
+        // Per scope name, over the frames since it was first seen; per-frame times are summed over calls.
+        struct ScopeStats
+        {
+            const char *name = nullptr;
+            float lastMs = 0.0f;
+            float avgMs = 0.0f; // exponential moving average
+            float maxMs = 0.0f; // over the last kStatsWindow frames
+            uint32_t calls = 0; // last frame
+            uint32_t allocations = 0; // last frame, summed over calls (0 without ENGINE_ALLOC_TRACKING)
+            uint64_t allocBytes = 0;
+        };
+
+        static constexpr uint32_t kStatsWindow = 240;
+        static constexpr uint32_t kMaxDepth = 32;
+        static constexpr uint32_t kMaxEventsPerThread = 16384; // per frame
+
+        static void setEnabled(bool enabled);
+        static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        static void beginFrame();
+        static void endFrame();
+
+        // Prefer ENGINE_PROFILE_SCOPE; begin()/end() must pair on the same thread.
+        static void begin(const char *name);
+        static void end();
+
+        static const Frame &lastFrame();
+        // Sorted by avgMs, largest first.
+        static const std::vector<ScopeStats> &stats();
+
+        // Nanoseconds on a steady clock.
+        static uint64_t now();
+
+    private:
+        static std::atomic<bool> s_enabled;
+    };
+
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char *name)
+            : m_active(Profiler::enabled())
+        {
+            if (m_active)
+                Profiler::begin(name);
+        }
+        ~ProfileScope()
+        {
+            if (m_active)
+                Profiler::end();
+        }
+
+        ProfileScope(const ProfileScope &) = delete;
+        ProfileScope &operator=(const ProfileScope &) = delete;
+
+    private:
+        bool m_active;
+    };
+
+} // namespace Engine
+
+#define ENGINE_PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_INTERNAL(a, b)
+#define ENGINE_PROFILE_SCOPE(name) ::Engine::ProfileScope ENGINE_PROFILE_CONCAT(engineProfileScope_, __LINE__)(name)
@@ -0,0 +1,60 @@
+#pragma once
+/*
+  SimdKernels.h
+  -------------
+  Purpose:
+    - Vectorized float kernels for the per-unit hot loops (movement integration, steering) and
+      batched animation math (quaternion nlerp, TRS -> matrix composition).
+    - The instruction set is picked once at runtime: AVX2 -> SSE2 -> scalar on x86, NEON on AArch64.
+
+  Usage:
+    - Engine::Simd::axpy(&positions[i].x, &velocities[i].x, 3 * count, dt);    // x += v * dt
+    - Engine::Simd::steer(dx, dz, maxSpeed, n, arrivalRadius, dt, dist, vx, vz);
+    - Engine::Simd::nlerpQuat(keys, stride, n); Engine::Simd::composeTRS(trs, stride, n, &locals[0][0].x);
+    - Engine::Simd::activeLevel() / levelName() for logging and benchmarks.
+
+  Notes:
+    - Inputs are plain float arrays (a run of AoS Position/Velocity rows is one flat array of 3*n floats).
+    - The animation kernels take structure-of-arrays blocks: lane k of element i is soa[k * stride + i].
+    - Set ENGINE_SIMD=scalar|sse2|avx2 in the environment to cap the level (benchmarking / A-B tests).
+    - Every level produces the same results as the scalar path: kernels use separate multiply/add
+      (no FMA contraction) and IEEE sqrt/divide.
+*/
+
+#include <cstdint>
+
+namespace Engine::Simd
+{
+    enum class Level : uint8_t
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    Level activeLevel();
+    const char *levelName(Level level);
+
+    // dst[i] += src[i] * scale for i < n. Returns true if any src[i] is non-zero.
+    bool axpy(float *dst, const float *src, uint32_t n, float scale);
+
+    // Steering toward a target on the ground plane, for i < n:
+    //   dist   = sqrt(dx^2 + dz^2)
+    //   speed  = maxSpeed, clamped to (dist - arrivalRadius) / dt when dt > 0 so the last step lands on the radius
+    //   v      = (dx, dz) / dist * speed   (zero when dist is ~0)
+    // Arrival (dist <= arrivalRadius) is left to the caller, which reads outDist.
+    void steer(const float *dx, const float *dz, const float *maxSpeed, uint32_t n,
+               float arrivalRadius, float dt, float *outDist, float *outVx, float *outVz);
+
+    // Normalized lerp between quaternions (x, y, z, w) along the shorter arc, for i < n. Lanes:
+    // 0..3 key a, 4..7 key b, 8 blend t. Writes normalize(a + (+-b - a) * t) over lanes 0..3
+    // (identity when that is zero). Keys are expected to be unit length.
+    void nlerpQuat(float *soa, uint32_t stride, uint32_t n);
+
+    // Local matrices T * R * S for i < n. Lanes: 0..2 translation, 3..6 rotation (x, y, z, w;
+    // normalized here, identity when zero), 7..9 scale. Writes 16 floats per element to outMat4,
+    // column-major like glm::mat4, so &mats[0][0].x can be passed directly.
+    void composeTRS(const float *soa, uint32_t stride, uint32_t n, float *outMat4);
+
+} // namespace Engine::Simd
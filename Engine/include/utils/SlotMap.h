@@ -0,0 +1,144 @@
+#pragma once
+/*
+  SlotMap.h
+  ---------
+  Purpose:
+    - Generational slot map: values in one dense array, addressed by (id, generation) handles.
+      A lookup is a bounds check, a generation compare and a load, no hashing.
+
+  Usage:
+    - Engine::SlotMap<Entry> entries;
+    - uint32_t generation = 0;
+    - uint64_t id = entries.insert(std::move(entry), generation);  // id is never 0
+    - if (Entry *e = entries.find(id, generation)) { ... }         // null once erased
+    - entries.forEach([&](uint64_t id, Entry &e) { if (dead(e)) entries.erase(id); });
+
+  Notes:
+    - ids are slot index + 1 and are reused after erase(); the slot's generation is bumped then,
+      so handles to the erased value stop resolving.
+    - Pointers to values are invalidated by insert() (the array may grow), never by erase().
+    - erase() from inside forEach() is allowed; values inserted meanwhile may or may not be visited.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+    template <typename T>
+    class SlotMap
+    {
+    public:
+        uint64_t insert(T value, uint32_t &outGeneration)
+        {
+            uint32_t index;
+            if (!m_free.empty())
+            {
+                index = m_free.back();
+                m_free.pop_back();
+            }
+            else
+            {
+                index = static_cast<uint32_t>(m_slots.size());
+                m_slots.emplace_back();
+            }
+            Slot &slot = m_slots[index];
+            slot.value = std::move(value);
+            slot.live = true;
+            ++m_size;
+            outGeneration = slot.generation;
+            return uint64_t(index) + 1u;
+        }
+
+        T *find(uint64_t id, uint32_t generation)
+        {
+            Slot *slot = slotOf(id);
+            return (slot && slot->generation == generation) ? &slot->value : nullptr;
+        }
+        const T *find(uint64_t id, uint32_t generation) const
+        {
+            return const_cast<SlotMap *>(this)->find(id, generation);
+        }
+
+        // The live value at 'id' whatever its generation (ids kept by the owner itself)
+        T *get(uint64_t id)
+        {
+            Slot *slot = slotOf(id);
+            return slot ? &slot->value : nullptr;
+        }
+        const T *get(uint64_t id) const { return const_cast<SlotMap *>(this)->get(id); }
+
+        // Generation of the live value at 'id', 0 when there is none
+        uint32_t generation(uint64_t id) const
+        {
+            const Slot *slot = const_cast<SlotMap *>(this)->slotOf(id);
+            return slot ? slot->generation : 0u;
+        }
+
+        void erase(uint64_t id)
+        {
+            Slot *slot = slotOf(id);
+            if (!slot)
+                return;
+            slot->value = T{};
+            slot->live = false;
+            if (++slot->generation == 0)
+                slot->generation = 1;
+            m_free.push_back(static_cast<uint32_t>(id - 1u));
+            --m_size;
+        }
+
+        template <typename Fn>
+        void forEach(Fn &&fn)
+        {
+            for (size_t i = 0; i < m_slots.size(); ++i)
+            {
+                if (m_slots[i].live)
+                    fn(uint64_t(i) + 1u, m_slots[i].value);
+            }
+        }
+        template <typename Fn>
+        void forEach(Fn &&fn) const
+        {
+            for (size_t i = 0; i < m_slots.size(); ++i)
+            {
+                if (m_slots[i].live)
+                    fn(uint64_t(i) + 1u, m_slots[i].value);
+            }
+        }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        void clear()
+        {
+            m_slots.clear();
+            m_free.clear();
+            m_size = 0;
+        }
+
+    private:
+        struct Slot
+        {
+            T value{};
+            uint32_t generation = 1;
+            bool live = false;
+        };
+
+        Slot *slotOf(uint64_t id)
+        {
+            // id 0 wraps around and fails the bounds check
+            const uint64_t index = id - 1u;
+            if (index >= m_slots.size() || !m_slots[index].live)
+                return nullptr;
+            return &m_slots[index];
+        }
+
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_free;
+        size_t m_size = 0;
+    };
+
+} // namespace Engine
@@ -0,0 +1,61 @@
+#pragma once
+/*
+  TraceCapture.h
+  --------------
+  Purpose:
+    - Records a fixed number of frames into a Chrome trace JSON file (chrome://tracing,
+      ui.perfetto.dev): CPU scopes of every thread, GPU passes on the CPU clock, and asset and
+      streaming events as async spans.
+
+  Usage:
+    - TraceCapture::begin("trace.json", 120);                  // needs Profiler enabled meanwhile
+    - TraceCapture::asyncSpan("asset", "Load Knight", id, t0, t1); // any thread
+    - TraceCapture::addFrame(Profiler::lastFrame(), gpuSpans); // per frame, after Profiler::endFrame()
+    - addFrame() returns true on the frame that wrote the file; active() is false from then on.
+
+  Notes:
+    - Times are Profiler::now() nanoseconds; the file stores microseconds from the capture start.
+    - Everything is buffered in memory and written once, so writing never lands inside a captured frame.
+    - Names are copied; unlike Profiler scopes they need not outlive the call.
+    - PerformanceMonitor drives addFrame(); call begin() through it (Application::StartTraceCapture).
+*/
+
+#include "utils/Profiler.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    class TraceCapture
+    {
+    public:
+        // One GPU interval; spans with the same track share a row
+        struct GpuSpan
+        {
+            std::string name;
+            std::string track; // "Frame", "compute", "draw", ...
+            uint64_t startNs = 0;
+            uint64_t endNs = 0;
+        };
+
+        // Starts a capture of the next 'frames' frames. False when one is already running.
+        static bool begin(const std::string &path, uint32_t frames);
+        static bool active();
+        // Frames still to record
+        static uint32_t remaining();
+
+        // Point event at Profiler::now()
+        static void instant(const char *category, const std::string &name);
+        // Interval not bound to a thread (loads, streaming); spans sharing 'id' and category nest
+        static void asyncSpan(const char *category, const std::string &name, uint64_t id, uint64_t startNs,
+                              uint64_t endNs);
+
+        // Main thread, once per frame. 'gpu' is the latest GPU frame: its "Frame" span first, then
+        // its passes; a frame already recorded is skipped. True when this was the last frame and the
+        // file was written (or failed to; see the log).
+        static bool addFrame(const Profiler::Frame &frame, const std::vector<GpuSpan> &gpu);
+    };
+
+} // namespace Engine
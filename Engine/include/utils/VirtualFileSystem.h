@@ -0,0 +1,85 @@
+#pragma once
+/*
+  VirtualFileSystem.h
+  -------------------
+  Purpose:
+    - One read path for game data: files come from mounted .spak archives (assets/PackFormat.h,
+      built by PackAssetsTool) when they hold the path, else from disk. A pack is mapped once,
+      so a packed startup opens one file instead of one per prefab, scenario and model.
+
+  Usage:
+    - Engine::VirtualFileSystem::mountPack("game.spak");   // optional, at startup
+    - Engine::FileData file;
+    - if (Engine::VirtualFileSystem::read("assets/Knight/Knight.smodel", file)) { file.data(); file.size(); }
+    - for (const std::string &p : Engine::VirtualFileSystem::list("entities", ".json")) { ... }
+
+  Notes:
+    - Paths are relative to the working directory / the packed root, '/' or '\' separated; a
+      leading "./" is ignored.
+    - Packs mounted later take precedence. Stored (uncompressed) entries are read in place from
+      the mapping, LZ4 entries are decompressed into the FileData, loose files are mapped.
+    - Mount before loading starts; reads may then run on any thread. Packs stay mapped until
+      unmountAll(), which must not run while FileData from them is alive.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/MappedFile.h"
+
+namespace Engine
+{
+    // Bytes of one file read through the VirtualFileSystem. Move-only.
+    class FileData
+    {
+    public:
+        FileData() = default;
+        FileData(const FileData &) = delete;
+        FileData &operator=(const FileData &) = delete;
+        FileData(FileData &&) noexcept = default;
+        FileData &operator=(FileData &&) noexcept = default;
+
+        const uint8_t *data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        void reset()
+        {
+            m_data = nullptr;
+            m_size = 0;
+            m_owned.clear();
+            m_owned.shrink_to_fit();
+            m_file.close();
+        }
+
+    private:
+        friend class VirtualFileSystem;
+
+        const uint8_t *m_data = nullptr; // into a pack mapping, m_owned or m_file
+        size_t m_size = 0;
+        std::vector<uint8_t> m_owned;
+        MappedFile m_file;
+    };
+
+    class VirtualFileSystem
+    {
+    public:
+        static bool mountPack(const std::string &packPath);
+        static void unmountAll();
+        static uint32_t getMountedPackCount();
+
+        static bool exists(const std::string &path);
+        static bool read(const std::string &path, FileData &out);
+        static std::string readText(const std::string &path);
+
+        // Files directly in 'directory' ending in 'extension' (packed and on disk, no duplicates,
+        // sorted), as paths usable with read().
+        static std::vector<std::string> list(const std::string &directory, const std::string &extension);
+
+        // '/' separators, no leading "./"
+        static std::string normalizePath(const std::string &path);
+    };
+
+} // namespace Engine
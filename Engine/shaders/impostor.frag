@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 vUV;
+
+// The model's impostor atlas (SModelRenderPassModule::ImpostorAtlas).
+layout(set = 1, binding = 0) uniform sampler2D uAtlas;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // Cells are cleared to transparent black, so filtered texels are premultiplied at the edges.
+    vec4 c = texture(uAtlas, vUV);
+    if (c.a < 0.5)
+        discard;
+    outColor = vec4(c.rgb / c.a, 1.0);
+}
@@ -0,0 +1,60 @@
+#version 450
+
+// Impostors of SModelRenderPassModule: one camera-facing quad per instance (4 vertices, triangle
+// strip) over the model's drawn bounding sphere, textured with the atlas cell of the baked yaw view
+// nearest to the camera direction and of the instance's impostor frame.
+// Per instance: locations 0-3 world matrix, 4 InstancePose (pose0: impostor frame)
+layout(location = 0) in vec4 inInstanceCol0;
+layout(location = 1) in vec4 inInstanceCol1;
+layout(location = 2) in vec4 inInstanceCol2;
+layout(location = 3) in vec4 inInstanceCol3;
+layout(location = 4) in uvec2 inPose;
+
+// Renderer-owned global set, shared by every pass. Matches Engine::GlobalUniforms.
+layout(set = 0, binding = 0) uniform Globals
+{
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 time;   // x: seconds since init, y: frame delta
+    uvec4 frame; // x: frames drawn, y: frame slot, zw: extent
+} globals;
+
+layout(push_constant) uniform PushConstants
+{
+    vec4 sphere; // drawn bounds in the instance's space: center, radius
+    uvec4 grid;  // x yaw views (atlas columns), y frames (rows)
+} pc;
+
+layout(location = 0) out vec2 vUV;
+
+const float PI = 3.14159265;
+
+void main()
+{
+    mat4 world = mat4(inInstanceCol0, inInstanceCol1, inInstanceCol2, inInstanceCol3);
+    vec2 corner = vec2((gl_VertexIndex & 1) != 0 ? 1.0 : -1.0, (gl_VertexIndex & 2) != 0 ? 1.0 : -1.0);
+
+    vec3 center = (world * vec4(pc.sphere.xyz, 1.0)).xyz;
+    float scale = max(length(world[0].xyz), max(length(world[1].xyz), length(world[2].xyz)));
+    float radius = pc.sphere.w * scale;
+
+    // View column: the camera's azimuth around the instance's up axis, view v baked from azimuth
+    // v * 2pi / views (SModelRenderPassModule::bakeImpostorAtlas()).
+    uint views = max(pc.grid.x, 1u);
+    uint frames = max(pc.grid.y, 1u);
+    vec3 toCamera = inverse(mat3(world)) * (globals.cameraPos.xyz - center);
+    float azimuth = atan(toCamera.x, toCamera.z);
+    int step = int(round(azimuth * float(views) / (2.0 * PI)));
+    uint column = uint(step + int(views)) % views;
+    uint row = min(inPose.x, frames - 1u);
+
+    // The bake's orthographic view spans the sphere: up is the top of the cell.
+    vec2 cell = vec2(0.5 + 0.5 * corner.x, 0.5 - 0.5 * corner.y);
+    vUV = (vec2(float(column), float(row)) + cell) / vec2(float(views), float(frames));
+
+    vec3 right = vec3(globals.view[0][0], globals.view[1][0], globals.view[2][0]);
+    vec3 up = vec3(globals.view[0][1], globals.view[1][1], globals.view[2][1]);
+    gl_Position = globals.viewProj * vec4(center + (right * corner.x + up * corner.y) * radius, 1.0);
+}
@@ -3,17 +3,20 @@
 layout(location = 0) in vec3 vNormal;
 layout(location = 1) in vec2 vUV0;
 
-layout(set = 1, binding = 0) uniform sampler2D uBaseColor;
+layout(set = 2, binding = 0) uniform sampler2D uBaseColor;
 
 layout(push_constant) uniform PushConstants
 {
-    mat4 model;
+    vec4 vertexOnly[4]; // model rows and position dequantization (smodel.vert)
     vec4 baseColorFactor;
-    vec4 materialParams; // x=alphaCutoff, y=alphaMode
+    vec4 materialParams; // x=alphaCutoff, y=alphaMode (pipelines specialize on it: kAlphaMask)
 } pc;
 
 layout(location = 0) out vec4 outColor;
 
+// Set by the MASK pipelines (alphaMode 1); OPAQUE and BLEND never discard.
+layout(constant_id = 0) const bool kAlphaMask = false;
+
 void main()
 {
     vec3 n = normalize(vNormal);
@@ -21,14 +24,8 @@ void main()
     vec4 tex = texture(uBaseColor, vUV0);
     vec4 base = tex * pc.baseColorFactor;
 
-    // alphaMode: 0=Opaque, 1=Mask, 2=Blend
-    float alphaMode = pc.materialParams.y;
-    float alphaCutoff = pc.materialParams.x;
-    if (alphaMode > 0.5 && alphaMode < 1.5)
-    {
-        if (base.a < alphaCutoff)
-            discard;
-    }
+    if (kAlphaMask && base.a < pc.materialParams.x)
+        discard;
 
     vec3 lightDir = normalize(vec3(0.3, 0.7, 0.2));
     float ndotl = clamp(dot(n, lightDir), 0.0, 1.0);
@@ -7,8 +7,12 @@
 // location 3: vec4 tangent
 // location 8: uvec4 joints (u16x4)
 // location 9: vec4 weights
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+// Compact layout (smodel VTX_COMPACT, kCompactVertices): location 0 unorm16x4 position in the
+// mesh bounds (pc.positionDequant), 1 and 3 snorm16x4 octahedral normal (xy) and tangent (zw),
+// 2 half2 uv0, 8 u8x4 joints, 9 unorm8x4 weights.
+// Per instance: locations 4-7 world matrix, 10-11 palette entries and blend (InstancePose)
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inNormal;
 layout(location = 2) in vec2 inUV0;
 layout(location = 3) in vec4 inTangent;
 
@@ -21,83 +25,160 @@ layout(location = 5) in vec4 inInstanceCol1;
 layout(location = 6) in vec4 inInstanceCol2;
 layout(location = 7) in vec4 inInstanceCol3;
 
-layout(set = 0, binding = 0) uniform CameraUBO {
+// Per-instance palette entries (shared poses or baked clip frames), blended by inPoseBlend.
+layout(location = 10) in uvec2 inPose;
+layout(location = 11) in float inPoseBlend;
+
+// The depth pre-pass and the main pass draw the same positions (LESS_OR_EQUAL against the pre-pass).
+invariant gl_Position;
+
+// Shader variant (SModelRenderPassModule::shaderVariant): compact vertex layout, and skinned
+// primitives (joint palette) versus unskinned ones (node palette).
+layout(constant_id = 0) const bool kCompactVertices = false;
+layout(constant_id = 1) const bool kSkinned = false;
+
+// Renderer-owned global set, shared by every pass. Matches Engine::GlobalUniforms.
+layout(set = 0, binding = 0) uniform Globals
+{
     mat4 view;
     mat4 proj;
-} cam;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 time;   // x: seconds since init, y: frame delta
+    uvec4 frame; // x: frames drawn, y: frame slot, zw: extent
+} globals;
+
+// Palette entry (Engine::PaletteMatrix): rows 0-2 of an affine matrix, row 3 is implicitly 0 0 0 1.
+struct Affine
+{
+    vec4 r0;
+    vec4 r1;
+    vec4 r2;
+};
 
-// Flattened node globals: [instance][node]
-layout(set = 0, binding = 1, std430) readonly buffer NodePalette
+// Flattened rendered node globals of every batch: [batch base + pose * node count + rendered node]
+layout(set = 1, binding = 0, std430) readonly buffer NodePalette
 {
-    mat4 nodeGlobals[];
+    Affine nodeGlobals[];
 } palette;
 
-// Flattened joint matrices: [instance][joint]
-layout(set = 0, binding = 2, std430) readonly buffer JointPalette
+// Flattened joint matrices of every batch: [batch base + pose * stride + joint]
+layout(set = 1, binding = 1, std430) readonly buffer JointPalette
 {
-    mat4 jointMats[];
+    Affine jointMats[];
 } joints;
 
 layout(push_constant) uniform PushConstants
 {
-    mat4 model;
+    Affine model;
+    vec4 positionDequant; // compact vertices: xyz + position * w
     vec4 baseColorFactor;
     vec4 materialParams;
-    uvec4 nodeInfo; // x=nodeIndex, y=nodeCount
-    uvec4 skinInfo; // x=skinBaseJoint, y=skinJointCount, z=jointPaletteStride
+    uvec4 nodeInfo; // x=rendered node index, y=rendered node count (palette stride), z=batch palette base
+    uvec4 skinInfo; // x=skinBaseJoint, y=skinJointCount, z=jointPaletteStride, w=batch joint palette base
 } pc;
 
 layout(location = 0) out vec3 vNormal;
 layout(location = 1) out vec2 vUV0;
 
+Affine scaled(Affine a, float w)
+{
+    return Affine(a.r0 * w, a.r1 * w, a.r2 * w);
+}
+
+Affine added(Affine a, Affine b)
+{
+    return Affine(a.r0 + b.r0, a.r1 + b.r1, a.r2 + b.r2);
+}
+
+mat4 toMat4(Affine a)
+{
+    return mat4(a.r0.x, a.r1.x, a.r2.x, 0.0,
+                a.r0.y, a.r1.y, a.r2.y, 0.0,
+                a.r0.z, a.r1.z, a.r2.z, 0.0,
+                a.r0.w, a.r1.w, a.r2.w, 1.0);
+}
+
+// Octahedral unit vector, [-1, 1]^2.
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+// Weighted sum of up to 4 joints of one pose.
+Affine skinAt(uint base, uvec4 j, vec4 w)
+{
+    Affine m = scaled(joints.jointMats[base + j.x], w.x);
+    m = added(m, scaled(joints.jointMats[base + j.y], w.y));
+    m = added(m, scaled(joints.jointMats[base + j.z], w.z));
+    m = added(m, scaled(joints.jointMats[base + j.w], w.w));
+    return m;
+}
+
 void main()
 {
     mat4 instanceWorld = mat4(inInstanceCol0, inInstanceCol1, inInstanceCol2, inInstanceCol3);
-    uint instanceIndex = uint(gl_InstanceIndex);
+    uint pose0 = inPose.x;
+    uint pose1 = inPose.y;
+    float poseBlend = clamp(inPoseBlend, 0.0, 1.0);
     uint nodeIndex = pc.nodeInfo.x;
     uint nodeCount = max(pc.nodeInfo.y, 1u);
+    uint nodeBase = pc.nodeInfo.z;
 
     uint skinBase = pc.skinInfo.x;
     uint skinJointCount = pc.skinInfo.y;
     uint jointStride = max(pc.skinInfo.z, 1u);
+    uint jointBase = pc.skinInfo.w;
+
+    vec3 position = kCompactVertices ? pc.positionDequant.xyz + inPosition.xyz * pc.positionDequant.w : inPosition.xyz;
+    vec3 normal = kCompactVertices ? octDecode(inNormal.xy) : inNormal.xyz;
+    mat4 model = toMat4(pc.model);
 
     mat4 M;
     vec4 modelPos;
     vec3 modelNormal;
 
-    if (skinJointCount > 0u)
+    if (kSkinned)
     {
         // Skinning: joint matrices already bring vertices into model space.
         // Build a weighted skin matrix from up to 4 joints.
-        mat4 skinM = mat4(0.0);
         vec4 w = inWeights;
 
         // Clamp joint indices to skinJointCount to avoid OOB.
         uvec4 j = min(inJoints, uvec4(max(skinJointCount - 1u, 0u)));
 
-        uint base = instanceIndex * jointStride + skinBase;
-        skinM += w.x * joints.jointMats[base + j.x];
-        skinM += w.y * joints.jointMats[base + j.y];
-        skinM += w.z * joints.jointMats[base + j.z];
-        skinM += w.w * joints.jointMats[base + j.w];
+        Affine skinA = skinAt(jointBase + pose0 * jointStride + skinBase, j, w);
+        if (poseBlend > 0.0)
+        {
+            // Lerp towards the next baked frame.
+            Affine skinA1 = skinAt(jointBase + pose1 * jointStride + skinBase, j, w);
+            skinA = added(scaled(skinA, 1.0 - poseBlend), scaled(skinA1, poseBlend));
+        }
+        mat4 skinM = toMat4(skinA);
 
-        modelPos = skinM * vec4(inPosition, 1.0);
-        modelNormal = normalize(mat3(skinM) * inNormal);
+        modelPos = skinM * vec4(position, 1.0);
+        modelNormal = normalize(mat3(skinM) * normal);
 
-        M = instanceWorld * pc.model;
+        M = instanceWorld * model;
     }
     else
     {
         // Unskinned: use node transform palette.
-        mat4 nodeM = palette.nodeGlobals[instanceIndex * nodeCount + nodeIndex];
-        M = instanceWorld * pc.model * nodeM;
-        modelPos = vec4(inPosition, 1.0);
-        modelNormal = inNormal;
+        Affine nodeA = palette.nodeGlobals[nodeBase + pose0 * nodeCount + nodeIndex];
+        if (poseBlend > 0.0)
+            nodeA = added(scaled(nodeA, 1.0 - poseBlend), scaled(palette.nodeGlobals[nodeBase + pose1 * nodeCount + nodeIndex], poseBlend));
+        mat4 nodeM = toMat4(nodeA);
+        M = instanceWorld * model * nodeM;
+        modelPos = vec4(position, 1.0);
+        modelNormal = normal;
     }
 
     vec4 worldPos = M * modelPos;
     mat3 normalMat = mat3(transpose(inverse(M)));
     vNormal = normalize(normalMat * modelNormal);
     vUV0 = inUV0;
-    gl_Position = cam.proj * cam.view * worldPos;
+    gl_Position = globals.viewProj * worldPos;
 }
@@ -0,0 +1,53 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// smodel.frag with bindless materials (SModelRenderPassModule::setBindlessMaterials): the material
+// comes from one table indexed by push constant, its base color from one texture array.
+
+layout(location = 0) in vec3 vNormal;
+layout(location = 1) in vec2 vUV0;
+
+// Matches SModelRenderPassModule::MaterialGpu (32 bytes).
+struct Material
+{
+    vec4 baseColorFactor;
+    float alphaCutoff;
+    uint alphaMode;        // 0=Opaque, 1=Mask, 2=Blend (selects the pipeline: kAlphaMask)
+    uint baseColorTexture; // element of uTextures, 0 = fallback white
+    uint pad;
+};
+
+layout(set = 2, binding = 0) uniform sampler2D uTextures[];
+layout(std430, set = 2, binding = 1) readonly buffer Materials { Material materials[]; };
+
+layout(push_constant) uniform PushConstants
+{
+    vec4 vertexOnly[4]; // model rows and position dequantization (smodel.vert)
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 nodeInfo; // w=material index
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+// Set by the MASK pipelines (alphaMode 1); OPAQUE and BLEND never discard.
+layout(constant_id = 0) const bool kAlphaMask = false;
+
+void main()
+{
+    vec3 n = normalize(vNormal);
+
+    Material m = materials[pc.nodeInfo.w];
+    vec4 tex = texture(uTextures[m.baseColorTexture], vUV0);
+    vec4 base = tex * m.baseColorFactor;
+
+    if (kAlphaMask && base.a < m.alphaCutoff)
+        discard;
+
+    vec3 lightDir = normalize(vec3(0.3, 0.7, 0.2));
+    float ndotl = clamp(dot(n, lightDir), 0.0, 1.0);
+    vec3 ambient = vec3(0.2);
+    vec3 lit = ambient + ndotl * vec3(0.8);
+
+    outColor = vec4(base.rgb * lit, base.a);
+}
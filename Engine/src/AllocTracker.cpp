@@ -0,0 +1,194 @@
+#include "utils/AllocTracker.h"
+#include "utils/Log.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_set>
+
+namespace Engine
+{
+    namespace
+    {
+        struct FrameState
+        {
+            AllocCounts start;
+            AllocCounts last;
+        };
+
+        FrameState &GetFrameState()
+        {
+            static FrameState state;
+            return state;
+        }
+
+        // Scope names already logged; each is reported once, the count keeps going
+        struct ViolationLog
+        {
+            std::mutex mutex;
+            std::unordered_set<std::string> logged;
+        };
+
+        ViolationLog &GetViolationLog()
+        {
+            static ViolationLog log;
+            return log;
+        }
+    } // namespace
+
+    void AllocTracker::beginFrame()
+    {
+        GetFrameState().start = total();
+    }
+
+    void AllocTracker::endFrame()
+    {
+        FrameState &s = GetFrameState();
+        const AllocCounts now = total();
+        s.last.allocations = now.allocations - s.start.allocations;
+        s.last.bytes = now.bytes - s.start.bytes;
+        s.last.frees = now.frees - s.start.frees;
+    }
+
+    const AllocCounts &AllocTracker::lastFrame()
+    {
+        return GetFrameState().last;
+    }
+
+    AllocCounts AllocTracker::total()
+    {
+        AllocCounts c;
+        c.allocations = s_allocations.load(std::memory_order_relaxed);
+        c.bytes = s_bytes.load(std::memory_order_relaxed);
+        c.frees = s_frees.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    void AllocTracker::reportViolation(const char *scope, uint64_t allocations, uint64_t bytes)
+    {
+        s_violations.fetch_add(1, std::memory_order_relaxed);
+        const bool strict = s_strict.load(std::memory_order_relaxed);
+        bool first = false;
+        {
+            ViolationLog &log = GetViolationLog();
+            std::lock_guard<std::mutex> lock(log.mutex);
+            first = log.logged.insert(scope ? scope : "?").second;
+        }
+        if (first || strict)
+            ENGINE_LOG_ERROR("[AllocTracker] %s made %llu heap allocations (%llu bytes) in a no-alloc scope%s",
+                             scope ? scope : "?", static_cast<unsigned long long>(allocations),
+                             static_cast<unsigned long long>(bytes), first && !strict ? "; later ones are only counted" : "");
+        if (strict)
+        {
+            Log::flush();
+            std::abort();
+        }
+    }
+
+} // namespace Engine
+
+#if ENGINE_ALLOC_TRACKING
+
+// Replacements of the global allocation functions. They live in this file with the functions
+// PerformanceMonitor calls, so linking the static Engine library always pulls them in.
+namespace
+{
+    void *Allocate_Internal(std::size_t size, std::size_t alignment, bool nothrow)
+    {
+        if (size == 0)
+            size = 1;
+        for (;;)
+        {
+            void *p = nullptr;
+            if (alignment <= alignof(std::max_align_t))
+                p = std::malloc(size);
+            else
+            {
+#if defined(_MSC_VER)
+                p = _aligned_malloc(size, alignment);
+#else
+                // aligned_alloc wants a multiple of the alignment
+                p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+            }
+            if (p)
+            {
+                Engine::AllocTracker::onAllocate(size);
+                return p;
+            }
+
+            std::new_handler handler = std::get_new_handler();
+            if (!handler)
+            {
+                if (nothrow)
+                    return nullptr;
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+
+    void Free_Internal(void *p, std::size_t alignment)
+    {
+        if (!p)
+            return;
+        Engine::AllocTracker::onFree();
+#if defined(_MSC_VER)
+        if (alignment > alignof(std::max_align_t))
+        {
+            _aligned_free(p);
+            return;
+        }
+#else
+        (void)alignment;
+#endif
+        std::free(p);
+    }
+
+    constexpr std::size_t kDefaultAlignment = alignof(std::max_align_t);
+} // namespace
+
+void *operator new(std::size_t size) { return Allocate_Internal(size, kDefaultAlignment, false); }
+void *operator new[](std::size_t size) { return Allocate_Internal(size, kDefaultAlignment, false); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return Allocate_Internal(size, kDefaultAlignment, true);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void *operator new(std::size_t size, std::align_val_t al) { return Allocate_Internal(size, static_cast<std::size_t>(al), false); }
+void *operator new[](std::size_t size, std::align_val_t al) { return Allocate_Internal(size, static_cast<std::size_t>(al), false); }
+void *operator new(std::size_t size, std::align_val_t al, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return Allocate_Internal(size, static_cast<std::size_t>(al), true);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t &tag) noexcept { return operator new(size, al, tag); }
+
+void operator delete(void *p) noexcept { Free_Internal(p, kDefaultAlignment); }
+void operator delete[](void *p) noexcept { Free_Internal(p, kDefaultAlignment); }
+void operator delete(void *p, std::size_t) noexcept { Free_Internal(p, kDefaultAlignment); }
+void operator delete[](void *p, std::size_t) noexcept { Free_Internal(p, kDefaultAlignment); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { Free_Internal(p, kDefaultAlignment); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { Free_Internal(p, kDefaultAlignment); }
+void operator delete(void *p, std::align_val_t al) noexcept { Free_Internal(p, static_cast<std::size_t>(al)); }
+void operator delete[](void *p, std::align_val_t al) noexcept { Free_Internal(p, static_cast<std::size_t>(al)); }
+void operator delete(void *p, std::size_t, std::align_val_t al) noexcept { Free_Internal(p, static_cast<std::size_t>(al)); }
+void operator delete[](void *p, std::size_t, std::align_val_t al) noexcept { Free_Internal(p, static_cast<std::size_t>(al)); }
+void operator delete(void *p, std::align_val_t al, const std::nothrow_t &) noexcept { Free_Internal(p, static_cast<std::size_t>(al)); }
+void operator delete[](void *p, std::align_val_t al, const std::nothrow_t &) noexcept { Free_Internal(p, static_cast<std::size_t>(al)); }
+
+#endif // ENGINE_ALLOC_TRACKING
@@ -6,6 +6,8 @@
 #include "Engine/ImGuiLayer.h"
 #include "Engine/PerformanceMonitor.h"
 #include "ECS/ECSContext.h"
+#include "utils/HitchDetector.h"
+#include "utils/Profiler.h"
 #include "Engine/ImGuiLayer.h"
 #include <iostream>
 #include <chrono>
@@ -21,6 +23,8 @@ namespace Engine
         std::unique_ptr<ImGuiLayer> imguiLayer;
         std::unique_ptr<PerformanceMonitor> perfMonitor;
         bool running = true;
+        bool closeRequested = false;
+        float fixedTimeStep = 0.0f;
         EventCallbackFn eventCallback;
         std::unique_ptr<ECS::ECSContext> ecs;
     };
@@ -36,7 +40,7 @@ namespace Engine
 
         // Create Vulkan context (owns instance, surface creation using the window handle)
         m_Impl->vkContext = std::make_unique<VulkanContext>(*m_Impl->window);
-        m_Impl->renderer = std::make_unique<Renderer>(m_Impl->vkContext.get(), m_Impl->vkContext->GetSwapChain(), 4);
+        m_Impl->renderer = std::make_unique<Renderer>(m_Impl->vkContext.get(), m_Impl->vkContext->GetSwapChain(), 3);
 
         // Initialize renderer now that swapchain exists
         m_Impl->renderer->init();
@@ -75,6 +79,10 @@ namespace Engine
         auto lastFrameTime = std::chrono::steady_clock::now();
         while (m_Impl->running)
         {
+            // Frame pacing: wait for a frame slot (and in low-latency mode for the display) before
+            // sampling input, so the frame simulates and draws the freshest input it can
+            m_Impl->renderer->waitForFrame();
+
             const auto now = std::chrono::steady_clock::now();
             const float deltaSeconds = std::chrono::duration<float>(now - lastFrameTime).count();
             lastFrameTime = now;
@@ -87,6 +95,8 @@ namespace Engine
 
             // Poll window events
             m_Impl->window->OnUpdate();
+            if (m_Impl->closeRequested && m_Impl->running)
+                Close();
 
             // If a window event requested shutdown (Escape/WindowClose), stop cleanly
             // before running any further update/render work for this frame.
@@ -101,9 +111,15 @@ namespace Engine
 
             // User update/render hooks
             TimeStep ts{};
-            ts.DeltaSeconds = deltaSeconds;
-            OnUpdate(ts);
-            OnRender();
+            ts.DeltaSeconds = m_Impl->fixedTimeStep > 0.0f ? m_Impl->fixedTimeStep : deltaSeconds;
+            {
+                ENGINE_PROFILE_SCOPE("Application::OnUpdate");
+                OnUpdate(ts);
+            }
+            {
+                ENGINE_PROFILE_SCOPE("Application::OnRender");
+                OnRender();
+            }
 
             // End ImGui frame (this also calls the render callback)
             if (m_Impl->imguiLayer && m_Impl->imguiLayer->isInitialized())
@@ -112,7 +128,10 @@ namespace Engine
             }
 
             // Draw one frame (includes ImGui rendering)
-            m_Impl->renderer->drawFrame();
+            {
+                ENGINE_PROFILE_SCOPE("Renderer::drawFrame");
+                m_Impl->renderer->drawFrame();
+            }
 
             // End performance monitoring
             if (m_Impl->perfMonitor)
@@ -138,6 +157,23 @@ namespace Engine
                 m_Impl->perfMonitor->toggle();
             }
         }
+        if (name == "F2Pressed" && m_Impl->renderer)
+        {
+            // Toggle the low-latency frame pacing mode
+            m_Impl->renderer->setLowLatency(!m_Impl->renderer->lowLatencyEnabled());
+        }
+        if (name == "F3Pressed" && m_Impl->renderer)
+        {
+            // Cycle frames in flight: 1, 2, ... up to the renderer's frame slots
+            Renderer &r = *m_Impl->renderer;
+            r.setFramesInFlight(r.getFramesInFlight() % r.getMaxFramesInFlight() + 1);
+        }
+        if (name == "F4Pressed" && m_Impl->renderer)
+        {
+            // Toggle per-pass pipeline statistics (shader invocation counts)
+            Renderer &r = *m_Impl->renderer;
+            r.setPipelineStatistics(!r.pipelineStatisticsEnabled());
+        }
         if (name == "WindowResize")
         {
             // Notify renderer that swapchain-dependent resources must be recreated
@@ -212,6 +248,27 @@ namespace Engine
         }
     }
 
+    void Application::RequestClose()
+    {
+        m_Impl->closeRequested = true;
+    }
+
+    void Application::SetFixedTimeStep(float seconds)
+    {
+        m_Impl->fixedTimeStep = seconds > 0.0f ? seconds : 0.0f;
+    }
+
+    bool Application::StartTraceCapture(const std::string &path, uint32_t frames)
+    {
+        return m_Impl->perfMonitor && m_Impl->perfMonitor->startTraceCapture(path, frames);
+    }
+
+    void Application::EnableHitchDetector(const HitchDetectorConfig &config)
+    {
+        if (m_Impl->perfMonitor)
+            m_Impl->perfMonitor->enableHitchDetector(config);
+    }
+
     void Application::SetEventCallback(const EventCallbackFn &callback)
     {
         m_Impl->eventCallback = callback;
@@ -1,34 +1,32 @@
 #include "assets/AssetManager.h"
+#include "assets/ModelData.h"
+#include "utils/DeletionQueue.h"
+#include "utils/HitchDetector.h"
 #include "utils/ImageUtils.h" // UploadContext
+#include "utils/Log.h"
+#include "utils/MemoryAllocator.h"
+#include "utils/MemoryTracker.h"
+#include "utils/JobSystem.h"
+#include "utils/Profiler.h"
+#include "utils/TraceCapture.h"
+#include "utils/VirtualFileSystem.h"
 
-// Needed for glm/gtx/* headers (matrix_decompose)
-#define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <glm/gtx/matrix_decompose.hpp>
 
 #include <utility>
 #include <cstring>
 #include <algorithm>
 #include <unordered_set>
 #include <functional>
-#include <iostream>
 
-#include <fstream>
 #include <iterator>
 
-const float TARGET = 10.0f; // Target size of models after scaling
 namespace Engine
 {
-    static ModelAsset::NodeTRS DecomposeTRS(const glm::mat4 &m)
-    {
-        ModelAsset::NodeTRS out{};
-        glm::vec3 skew;
-        glm::vec4 perspective;
-        glm::decompose(m, out.s, out.r, out.t, skew, perspective);
-        out.r = glm::normalize(out.r);
-        return out;
-    }
+    // Clip bake for GPU-side animation lookup (ModelAsset::bakeAnimations); 12 MB of palette entries max.
+    static constexpr float kBakedAnimationFps = 30.0f;
+    static constexpr size_t kBakedAnimationMaxMatrices = size_t(1) << 18;
 
     // ------------------------------------------------------------
     // Helpers: map smodel enum ints -> Vulkan settings
@@ -79,6 +77,85 @@ namespace Engine
     // ------------------------------------------------------------
     // AssetManager
     // ------------------------------------------------------------
+    struct AssetManager::PendingModel
+    {
+        uint64_t id = 0; // model entry, Pending until this finishes
+        std::string path;
+
+        // Streaming worker: file read and image decode, read here once 'decoded' is done
+        JobSystem::Counter decoded;
+        bool ok = false;
+        std::string error;
+        smodel::SModelFileView view;
+        std::vector<DecodedImage> images;
+        ContentHashes hashes;
+
+        // update(): the submitted uploads, and the asset the entry gets once they have run
+        UploadContext upload{};
+        VkCommandPool pools[2] = {};
+        std::unique_ptr<ModelAsset> asset;
+        SharedResources uploaded;
+
+        // Profiler::now() times for TraceCapture; the upload ends when update() sees it complete
+        uint64_t requestNs = 0;
+        uint64_t decodeStartNs = 0; // worker
+        uint64_t decodeEndNs = 0;   // worker, read once 'decoded' is done
+        uint64_t uploadStartNs = 0;
+    };
+
+    struct AssetManager::TextureStreamUpload
+    {
+        UploadContext upload{};
+        VkCommandPool pools[2] = {};
+        std::vector<TextureHandle> handles;                  // texture entries, invalid where recording failed
+        std::vector<std::unique_ptr<TextureAsset>> textures; // their replacements
+        uint64_t startNs = 0;                                // Profiler::now(), for TraceCapture
+    };
+
+    // First mip whose longer side fits kStreamedBaseSize: what a streamed texture keeps resident
+    static uint32_t StreamedBaseMip(uint32_t width, uint32_t height)
+    {
+        uint32_t mip = 0;
+        while ((std::max(width, height) >> mip) > AssetManager::kStreamedBaseSize)
+            ++mip;
+        return mip;
+    }
+
+    // Bytes of a block-compressed chain from 'firstMip' on
+    static uint64_t StreamedChainBytes(uint32_t encoding, uint32_t width, uint32_t height, uint32_t firstMip)
+    {
+        return smodel::BlockMipChainBytes(encoding, std::max(width >> firstMip, 1u), std::max(height >> firstMip, 1u));
+    }
+
+    // 64-bit content hash for dedup: eight bytes per step, multiply-xorshift mixed (cheap enough to
+    // run over every texture and vertex byte of a model)
+    static uint64_t HashContent(uint64_t h, const void *data, size_t size)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        auto mix = [&h](uint64_t v)
+        {
+            h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 29;
+        };
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t v;
+            std::memcpy(&v, p + i, sizeof(v));
+            mix(v);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, p + i, size - i);
+        mix(tail ^ (uint64_t(size) << 56));
+        return h;
+    }
+
+    template <typename T>
+    static uint64_t HashValue(uint64_t h, const T &value)
+    {
+        return HashContent(h, &value, sizeof(value));
+    }
+
     AssetManager::AssetManager(VkDevice device,
                                VkPhysicalDevice phys,
                                VkQueue graphicsQueue,
@@ -88,34 +165,105 @@ namespace Engine
           m_graphicsQueue(graphicsQueue),
           m_graphicsQueueFamilyIndex(graphicsQueueFamilyIndex)
     {
+        m_geometry.init(device, phys);
     }
 
     AssetManager::~AssetManager()
     {
-        // Destroy meshes
-        for (auto &kv : m_meshes)
+        // Asynchronous loads: stop the workers, then let submitted uploads finish before what they
+        // write is destroyed
+        m_streamJobs.reset();
+        for (auto &pending : m_pendingModels)
         {
-            if (kv.second.asset)
-                kv.second.asset->destroy(m_device);
+            if (pending->upload.submitted)
+                Engine::FinishUpload(pending->upload);
+            destroyUploadPools_Internal(pending->pools);
         }
+        m_pendingModels.clear();
 
-        // Destroy textures
-        for (auto &kv : m_textures)
+        // Texture streaming: the upload in flight
+        if (m_textureStream)
         {
-            if (kv.second.asset)
-                kv.second.asset->destroy(m_device);
+            if (m_textureStream->upload.submitted)
+                Engine::FinishUpload(m_textureStream->upload);
+            destroyUploadPools_Internal(m_textureStream->pools);
+            for (auto &tex : m_textureStream->textures)
+            {
+                if (tex)
+                    tex->destroy(m_device);
+            }
+            m_textureStream.reset();
         }
 
+        // Destructions still queued for frames in flight touch the geometry arena and the textures
+        if (DeletionQueue *queue = DeletionQueue::ForDevice(m_device))
+            queue->flush();
+
+        // Destroy meshes, then the arena holding their geometry
+        m_meshes.forEach([](uint64_t, MeshEntry &e)
+                         {
+            if (e.asset)
+                e.asset->destroy(); });
+        m_geometry.destroy();
+
+        // Destroy textures
+        m_textures.forEach([this](uint64_t, TextureEntry &e)
+                           {
+            if (e.asset)
+                e.asset->destroy(m_device); });
+
         // Materials + Models are CPU only (no gpu destroy needed)
         m_meshes.clear();
         m_textures.clear();
         m_materials.clear();
         m_models.clear();
+        m_textureByIndex.clear();
+        m_freeTextureIndices.clear();
+        m_materialByIndex.clear();
+        m_freeMaterialIndices.clear();
 
         m_meshPathCache.clear();
         m_modelPathCache.clear();
     }
 
+    bool AssetManager::beginUpload_Internal(UploadContext &ctx, VkCommandPool (&outPools)[2])
+    {
+        // Transient pools: the graphics family's, and the transfer family's for the copies
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        outPools[0] = outPools[1] = VK_NULL_HANDLE;
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &outPools[0]) != VK_SUCCESS)
+            return false;
+
+        const bool dedicated = m_transferQueue != VK_NULL_HANDLE && m_transferQueueFamilyIndex != m_graphicsQueueFamilyIndex;
+        if (dedicated)
+        {
+            poolInfo.queueFamilyIndex = m_transferQueueFamilyIndex;
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &outPools[1]) != VK_SUCCESS)
+                outPools[1] = VK_NULL_HANDLE; // copies stay on the graphics queue
+        }
+
+        if (!Engine::BeginUploadContext(ctx, m_device, m_phys, outPools[0], m_graphicsQueue, m_graphicsQueueFamilyIndex,
+                                        outPools[1], m_transferQueue, m_transferQueueFamilyIndex))
+        {
+            destroyUploadPools_Internal(outPools);
+            return false;
+        }
+        return true;
+    }
+
+    void AssetManager::destroyUploadPools_Internal(VkCommandPool (&pools)[2])
+    {
+        for (VkCommandPool &pool : pools)
+        {
+            if (pool != VK_NULL_HANDLE)
+                vkDestroyCommandPool(m_device, pool, nullptr);
+            pool = VK_NULL_HANDLE;
+        }
+    }
+
     // ------------------------------------------------------------
     // Mesh existing API
     // ------------------------------------------------------------
@@ -129,7 +277,7 @@ namespace Engine
         }
 
         MeshData data;
-        if (!LoadSMeshV0FromFile(cookedMeshPath, data))
+        if (!LoadSMeshFromFile(cookedMeshPath, data))
             return MeshHandle{};
 
         MeshHandle h = createMeshFromData_Internal(data, cookedMeshPath, 1);
@@ -139,66 +287,49 @@ namespace Engine
         return h;
     }
 
-    MeshAsset *AssetManager::getMesh(MeshHandle h)
-    {
-        auto it = m_meshes.find(h.id);
-        if (it == m_meshes.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
-            return nullptr;
-        return it->second.asset.get();
-    }
-
     void AssetManager::addRef(MeshHandle h)
     {
-        auto it = m_meshes.find(h.id);
-        if (it != m_meshes.end() && it->second.generation == h.generation)
-            it->second.refCount++;
+        if (MeshEntry *e = m_meshes.find(h.id, h.generation))
+            e->refCount++;
     }
 
     void AssetManager::release(MeshHandle h)
     {
-        auto it = m_meshes.find(h.id);
-        if (it != m_meshes.end() && it->second.generation == h.generation)
-        {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
-        }
+        MeshEntry *e = m_meshes.find(h.id, h.generation);
+        if (e && e->refCount > 0)
+            e->refCount--;
     }
 
     MeshHandle AssetManager::createMeshFromData_Internal(const MeshData &data, const std::string &path, uint32_t initialRef)
     {
-        // Transient pool per mesh upload
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-
-        VkCommandPool uploadPool = VK_NULL_HANDLE;
-        VkResult pr = vkCreateCommandPool(m_device, &poolInfo, nullptr, &uploadPool);
-        if (pr != VK_SUCCESS)
+        // Both copies in one command buffer from one staging buffer, one fence wait
+        VkCommandPool uploadPools[2] = {};
+        Engine::UploadContext upload{};
+        if (!beginUpload_Internal(upload, uploadPools))
             return MeshHandle{};
 
         auto asset = std::make_unique<MeshAsset>();
-        const bool ok = asset->upload(m_device, m_phys, uploadPool, m_graphicsQueue, data);
-
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
+        bool ok = asset->upload_Deferred(upload, m_geometry, data);
+        ok = Engine::EndSubmitAndWait(upload) && ok;
+        destroyUploadPools_Internal(uploadPools);
 
         if (!ok)
+        {
+            asset->destroy();
             return MeshHandle{};
+        }
+        return createMesh_Internal(std::move(asset), path, initialRef);
+    }
 
-        const uint64_t id = m_nextMeshID++;
+    MeshHandle AssetManager::createMesh_Internal(std::unique_ptr<MeshAsset> mesh, const std::string &path, uint32_t initialRef)
+    {
         MeshEntry entry;
-        entry.asset = std::move(asset);
-        entry.generation = 1;
+        entry.asset = std::move(mesh);
         entry.refCount = initialRef;
         entry.path = path;
 
-        m_meshes.emplace(id, std::move(entry));
-
         MeshHandle h;
-        h.id = id;
-        h.generation = 1;
+        h.id = m_meshes.insert(std::move(entry), h.generation);
         return h;
     }
 
@@ -207,64 +338,43 @@ namespace Engine
     // ------------------------------------------------------------
     TextureHandle AssetManager::createTexture_Internal(std::unique_ptr<TextureAsset> tex, uint32_t initialRef)
     {
-        const uint64_t id = m_nextTextureID++;
         TextureEntry e;
         e.asset = std::move(tex);
-        e.generation = 1;
         e.refCount = initialRef;
 
-        m_textures.emplace(id, std::move(e));
-
         TextureHandle h;
-        h.id = id;
-        h.generation = 1;
+        h.id = m_textures.insert(std::move(e), h.generation);
+        m_textures.get(h.id)->index = allocateIndex(m_textureByIndex, m_freeTextureIndices, h.id);
+        ++m_bindlessVersion;
         return h;
     }
 
-    TextureAsset *AssetManager::getTexture(TextureHandle h)
+    uint32_t AssetManager::getTextureIndex(TextureHandle h) const
     {
-        auto it = m_textures.find(h.id);
-        if (it == m_textures.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
+        const TextureEntry *e = m_textures.find(h.id, h.generation);
+        return e ? e->index : kInvalidIndex;
+    }
+
+    TextureAsset *AssetManager::getTextureAtIndex(uint32_t index)
+    {
+        if (index >= m_textureByIndex.size())
             return nullptr;
-        return it->second.asset.get();
+        TextureEntry *e = m_textures.get(m_textureByIndex[index]);
+        return e ? e->asset.get() : nullptr;
     }
 
     Engine::TextureHandle AssetManager::loadTextureFromFile(const std::string &filePath)
 {
-    // Read file contents into a vector<uint8_t>
-    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
-    if (!file)
-        return TextureHandle{};
-
-    const std::streamsize size = file.tellg();
-    if (size <= 0)
-        return TextureHandle{};
-
-    file.seekg(0, std::ios::beg);
-    std::vector<uint8_t> bytes;
-    bytes.resize(static_cast<size_t>(size));
-    if (!file.read(reinterpret_cast<char*>(bytes.data()), size))
-        return TextureHandle{};
-
-    // Create upload pool for single texture (similar to loadModel)
-    VkCommandPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-
-    VkCommandPool uploadPool = VK_NULL_HANDLE;
-    VkResult pr = vkCreateCommandPool(m_device, &poolInfo, nullptr, &uploadPool);
-    if (pr != VK_SUCCESS)
+    // Read the encoded image (packed or loose)
+    Engine::FileData file;
+    if (!Engine::VirtualFileSystem::read(filePath, file) || file.empty())
         return TextureHandle{};
 
+    // Upload pools for single texture (similar to loadModel)
+    VkCommandPool uploadPools[2] = {};
     Engine::UploadContext upload{};
-    if (!Engine::BeginUploadContext(upload, m_device, m_phys, uploadPool, m_graphicsQueue))
-    {
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
+    if (!beginUpload_Internal(upload, uploadPools))
         return TextureHandle{};
-    }
 
     auto tex = std::make_unique<TextureAsset>();
 
@@ -279,8 +389,8 @@ namespace Engine
 
     if (!tex->uploadEncodedImage_Deferred(
             upload,
-            bytes.data(),
-            bytes.size(),
+            file.data(),
+            file.size(),
             isSRGB,
             wrapU,
             wrapV,
@@ -290,18 +400,18 @@ namespace Engine
             maxAnisotropy))
     {
         Engine::EndSubmitAndWait(upload);
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
+        destroyUploadPools_Internal(uploadPools);
         return TextureHandle{};
     }
 
     // Submit and wait (similar to loadModel)
     if (!Engine::EndSubmitAndWait(upload))
     {
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
+        destroyUploadPools_Internal(uploadPools);
         return TextureHandle{};
     }
 
-    vkDestroyCommandPool(m_device, uploadPool, nullptr);
+    destroyUploadPools_Internal(uploadPools);
 
     // Create a texture entry with refCount = 1 (caller gets an owned handle)
     TextureHandle th = createTexture_Internal(std::move(tex), 1);
@@ -310,19 +420,15 @@ namespace Engine
 
     void AssetManager::addRef(TextureHandle h)
     {
-        auto it = m_textures.find(h.id);
-        if (it != m_textures.end() && it->second.generation == h.generation)
-            it->second.refCount++;
+        if (TextureEntry *e = m_textures.find(h.id, h.generation))
+            e->refCount++;
     }
 
     void AssetManager::release(TextureHandle h)
     {
-        auto it = m_textures.find(h.id);
-        if (it != m_textures.end() && it->second.generation == h.generation)
-        {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
-        }
+        TextureEntry *e = m_textures.find(h.id, h.generation);
+        if (e && e->refCount > 0)
+            e->refCount--;
     }
 
     // ------------------------------------------------------------
@@ -330,10 +436,8 @@ namespace Engine
     // ------------------------------------------------------------
     MaterialHandle AssetManager::createMaterial_Internal(std::unique_ptr<MaterialAsset> mat, uint32_t initialRef)
     {
-        const uint64_t id = m_nextMaterialID++;
         MaterialEntry e;
         e.asset = std::move(mat);
-        e.generation = 1;
         e.refCount = initialRef;
 
         // Gather dependency handles (textures)
@@ -351,39 +455,54 @@ namespace Engine
                 e.textureDeps.push_back(e.asset->emissiveTexture);
         }
 
-        m_materials.emplace(id, std::move(e));
-
         MaterialHandle h;
-        h.id = id;
-        h.generation = 1;
+        h.id = m_materials.insert(std::move(e), h.generation);
+        m_materials.get(h.id)->index = allocateIndex(m_materialByIndex, m_freeMaterialIndices, h.id);
+        ++m_bindlessVersion;
         return h;
     }
 
-    MaterialAsset *AssetManager::getMaterial(MaterialHandle h)
+    uint32_t AssetManager::getMaterialIndex(MaterialHandle h) const
     {
-        auto it = m_materials.find(h.id);
-        if (it == m_materials.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
+        const MaterialEntry *e = m_materials.find(h.id, h.generation);
+        return e ? e->index : kInvalidIndex;
+    }
+
+    MaterialAsset *AssetManager::getMaterialAtIndex(uint32_t index)
+    {
+        if (index >= m_materialByIndex.size())
             return nullptr;
-        return it->second.asset.get();
+        MaterialEntry *e = m_materials.get(m_materialByIndex[index]);
+        return e ? e->asset.get() : nullptr;
+    }
+
+    uint32_t AssetManager::allocateIndex(std::vector<uint64_t> &byIndex, std::vector<uint32_t> &freeIndices, uint64_t id)
+    {
+        if (!freeIndices.empty())
+        {
+            // Lowest free index first keeps the arrays compact.
+            auto lowest = std::min_element(freeIndices.begin(), freeIndices.end());
+            const uint32_t index = *lowest;
+            *lowest = freeIndices.back();
+            freeIndices.pop_back();
+            byIndex[index] = id;
+            return index;
+        }
+        byIndex.push_back(id);
+        return static_cast<uint32_t>(byIndex.size() - 1);
     }
 
     void AssetManager::addRef(MaterialHandle h)
     {
-        auto it = m_materials.find(h.id);
-        if (it != m_materials.end() && it->second.generation == h.generation)
-            it->second.refCount++;
+        if (MaterialEntry *e = m_materials.find(h.id, h.generation))
+            e->refCount++;
     }
 
     void AssetManager::release(MaterialHandle h)
     {
-        auto it = m_materials.find(h.id);
-        if (it != m_materials.end() && it->second.generation == h.generation)
-        {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
-        }
+        MaterialEntry *e = m_materials.find(h.id, h.generation);
+        if (e && e->refCount > 0)
+            e->refCount--;
     }
 
     // ------------------------------------------------------------
@@ -391,29 +510,99 @@ namespace Engine
     // ------------------------------------------------------------
     ModelHandle AssetManager::createModel_Internal(std::unique_ptr<ModelAsset> model, const std::string &path, uint32_t initialRef)
     {
-        const uint64_t id = m_nextModelID++;
         ModelEntry e;
         e.asset = std::move(model);
-        e.generation = 1;
         e.refCount = initialRef;
         e.path = path;
 
         // Dependencies (fill later in loadModel)
-        m_models.emplace(id, std::move(e));
-
         ModelHandle h;
-        h.id = id;
-        h.generation = 1;
+        h.id = m_models.insert(std::move(e), h.generation);
         return h;
     }
 
+    GeometryArena::Range AssetManager::uploadMeshlets_Internal(const smodel::SModelFileView &view, ModelAsset &model, UploadContext &upload)
+    {
+        const uint32_t meshletCount = view.meshletCount();
+        if (meshletCount == 0)
+            return GeometryArena::Range{};
+
+        // [MeshletGpu x N][vertex words][triangle words]; 64-byte alignment makes record indices whole.
+        const uint32_t vertexWords = view.meshletVertexCount();
+        const uint32_t triangleWords = view.meshletTriangleBytes() / 3u;
+        const size_t recordWords = size_t(meshletCount) * (sizeof(MeshletGpu) / sizeof(uint32_t));
+        const VkDeviceSize bytes = (recordWords + vertexWords + triangleWords) * sizeof(uint32_t);
+
+        // Built in place in the model's staging memory; copied with its other uploads (MeshAsset::upload_Deferred)
+        StagingSlice staging{};
+        if (!AllocateStaging(upload, bytes, staging))
+            return GeometryArena::Range{};
+        uint32_t *payload = reinterpret_cast<uint32_t *>(staging.mapped);
+
+        GeometryArena::Range range = m_geometry.allocate(GeometryArena::Meshlet, bytes, sizeof(MeshletGpu));
+        if (!range.isValid())
+            return range;
+
+        const uint32_t baseRecord = static_cast<uint32_t>(range.offset / sizeof(MeshletGpu));
+        const uint32_t vertexBase = static_cast<uint32_t>(range.offset / sizeof(uint32_t) + recordWords);
+        const uint32_t triangleBase = vertexBase + vertexWords;
+
+        MeshletGpu *records = reinterpret_cast<MeshletGpu *>(payload);
+        for (uint32_t i = 0; i < meshletCount; ++i)
+        {
+            const smodel::SModelMeshletRecord &src = view.meshlets[i];
+            MeshletGpu &dst = records[i];
+            std::memcpy(dst.center, src.center, sizeof(dst.center));
+            dst.radius = src.radius;
+            std::memcpy(dst.coneAxis, src.coneAxis, sizeof(dst.coneAxis));
+            dst.coneCutoff = src.coneCutoff;
+            std::memcpy(dst.coneApex, src.coneApex, sizeof(dst.coneApex));
+            dst.firstIndex = src.firstIndex;
+            dst.vertexFirst = vertexBase + src.firstVertex;
+            dst.triangleFirst = triangleBase + src.firstTriangle;
+            dst.vertexCount = src.vertexCount;
+            dst.triangleCount = src.triangleCount;
+
+            // Grouped by primitive (validated by the loader)
+            ModelPrimitive &prim = model.primitives[src.primitiveIndex];
+            if (prim.meshletCount == 0)
+                prim.firstMeshlet = baseRecord + i;
+            ++prim.meshletCount;
+        }
+        if (vertexWords > 0)
+            std::memcpy(payload + recordWords, view.meshletVertices, sizeof(uint32_t) * vertexWords);
+        for (uint32_t t = 0; t < triangleWords; ++t)
+        {
+            const uint8_t *tri = view.meshletTriangles + size_t(t) * 3u;
+            payload[recordWords + vertexWords + t] = uint32_t(tri[0]) | (uint32_t(tri[1]) << 8) | (uint32_t(tri[2]) << 16);
+        }
+
+        CmdCopyBuffer(upload, staging, m_geometry.getBuffer(GeometryArena::Meshlet, range.block), bytes, range.offset);
+
+        model.meshletBlock = range.block;
+        return range;
+    }
+
     ModelHandle AssetManager::loadModel(const std::string &cookedModelPath)
     {
         auto it = m_modelPathCache.find(cookedModelPath);
         if (it != m_modelPathCache.end())
         {
-            addRef(it->second);
-            return it->second;
+            // Still loading (loadModelAsync): finish it now
+            const ModelHandle cached = it->second;
+            for (auto pending = m_pendingModels.begin(); pending != m_pendingModels.end(); ++pending)
+            {
+                if ((*pending)->id != cached.id)
+                    continue;
+                advancePendingModel_Internal(**pending, true);
+                traceModelLoad_Internal(**pending);
+                m_pendingModels.erase(pending);
+                break;
+            }
+            if (getModelState(cached) != LoadState::Ready)
+                return ModelHandle{};
+            addRef(cached);
+            return cached;
         }
 
         // --------------------------
@@ -423,39 +612,183 @@ namespace Engine
         std::string err;
         if (!Engine::smodel::LoadSModelFile(cookedModelPath, view, err))
         {
-            std::cerr << "[AssetManager] loadModel: Failed to load .smodel: " << err << "\n";
+            ENGINE_LOG_ERROR("[AssetManager] loadModel: Failed to load .smodel: %s", err.c_str());
             return ModelHandle{};
         }
 
         // --------------------------
-        // Create upload pool for all textures (single submit)
+        // Create upload pools for the whole model (single submit)
         // --------------------------
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        VkCommandPool uploadPools[2] = {};
+        Engine::UploadContext upload{};
+        if (!beginUpload_Internal(upload, uploadPools))
+            return ModelHandle{};
 
-        VkCommandPool uploadPool = VK_NULL_HANDLE;
-        VkResult pr = vkCreateCommandPool(m_device, &poolInfo, nullptr, &uploadPool);
-        if (pr != VK_SUCCESS)
+        ModelBuild build;
+        if (!buildModel_Internal(cookedModelPath, view, nullptr, nullptr, upload, build))
+        {
+            // Cleanup on failure
+            Engine::EndSubmitAndWait(upload);
+            destroyUploadPools_Internal(uploadPools);
             return ModelHandle{};
+        }
 
-        Engine::UploadContext upload{};
-        if (!Engine::BeginUploadContext(upload, m_device, m_phys, uploadPool, m_graphicsQueue))
+        // ONE SUBMIT for all textures, meshes and meshlet tables
+        const bool uploaded = Engine::EndSubmitAndWait(upload);
+        destroyUploadPools_Internal(uploadPools);
+        if (!uploaded)
         {
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
+            for (MeshHandle &mh : build.meshDeps)
+                release(mh);
+            for (MaterialHandle &mat : build.materialDeps)
+                release(mat);
+            if (build.meshletRange.isValid())
+                m_geometry.free(GeometryArena::Meshlet, build.meshletRange);
             return ModelHandle{};
         }
 
+        shareResources_Internal(build.uploaded);
+
+        // Register model and cache it
+        ModelHandle modelHandle = createModel_Internal(std::move(build.asset), cookedModelPath, 1);
+
+        // Fill dependency lists inside the ModelEntry
+        if (ModelEntry *entry = m_models.find(modelHandle.id, modelHandle.generation))
+        {
+            entry->meshDeps = std::move(build.meshDeps);
+            entry->materialDeps = std::move(build.materialDeps);
+            entry->meshletRange = build.meshletRange;
+        }
+
+        m_modelPathCache.emplace(cookedModelPath, modelHandle);
+        return modelHandle;
+    }
+
+    void AssetManager::computeContentHashes_Internal(const smodel::SModelFileView &view, ContentHashes &out)
+    {
+        // Everything the created resource depends on: sampler and format settings, then the bytes
+        out.textures.resize(view.textureCount());
+        for (uint32_t i = 0; i < view.textureCount(); i++)
+        {
+            const auto &t = view.textures[i];
+            const uint32_t settings[] = {t.colorSpace, t.encoding, t.wrapU, t.wrapV, t.minFilter, t.magFilter,
+                                         t.mipFilter, t.width, t.height};
+            uint64_t h = HashValue(14695981039346656037ull, settings);
+            h = HashValue(h, t.maxAnisotropy);
+            out.textures[i] = HashContent(h, view.blob + t.imageDataOffset, static_cast<size_t>(t.imageDataSize));
+        }
+
+        out.meshes.resize(view.meshCount());
+        for (uint32_t i = 0; i < view.meshCount(); i++)
+        {
+            const auto &mr = view.meshes[i];
+            const uint32_t layout[] = {mr.vertexStride, mr.vertexCount, mr.indexCount, mr.layoutFlags, mr.indexType};
+            uint64_t h = HashValue(14695981039346656037ull, layout);
+            h = HashContent(h, view.blob + mr.vertexDataOffset, static_cast<size_t>(mr.vertexDataSize));
+            // Coded streams hash as stored: the encoder is deterministic, so equal meshes still match
+            const size_t indexBytes = (mr.layoutFlags & smodel::MESH_INDEX_CODEC) ? static_cast<size_t>(mr.indexDataSize)
+                                                                                   : size_t(mr.indexCount) * (mr.indexType == 0 ? 2u : 4u);
+            out.meshes[i] = HashContent(h, view.blob + mr.indexDataOffset, indexBytes);
+        }
+    }
+
+    void AssetManager::shareResources_Internal(const SharedResources &resources)
+    {
+        for (const auto &[hash, th] : resources.textures)
+        {
+            TextureEntry *e = m_textures.find(th.id, th.generation);
+            if (e && m_textureByContent.emplace(hash, th).second)
+                e->contentHash = hash;
+        }
+        for (const auto &[hash, mh] : resources.meshes)
+        {
+            MeshEntry *e = m_meshes.find(mh.id, mh.generation);
+            if (e && m_meshByContent.emplace(hash, mh).second)
+                e->contentHash = hash;
+        }
+    }
+
+    bool AssetManager::buildModel_Internal(const std::string &path, const smodel::SModelFileView &view,
+                                           const std::vector<DecodedImage> *images, const ContentHashes *hashes,
+                                           UploadContext &upload, ModelBuild &out)
+    {
+        ContentHashes computed;
+        if (!hashes)
+        {
+            computeContentHashes_Internal(view, computed);
+            hashes = &computed;
+        }
+
+        // Shared textures and meshes with the same content are reused as they are: no staging, no
+        // copies. Repeats within this model resolve to its first copy below.
+        std::vector<TextureHandle> textureHandles(view.textureCount());
+        for (uint32_t i = 0; i < view.textureCount(); i++)
+        {
+            auto shared = m_textureByContent.find(hashes->textures[i]);
+            if (shared != m_textureByContent.end())
+            {
+                textureHandles[i] = shared->second;
+                ++m_dedupTextureHits;
+                m_dedupBytesSkipped += view.textures[i].imageDataSize;
+            }
+        }
+        std::vector<MeshHandle> meshHandles(view.meshCount());
+        for (uint32_t i = 0; i < view.meshCount(); i++)
+        {
+            auto shared = m_meshByContent.find(hashes->meshes[i]);
+            if (shared != m_meshByContent.end())
+            {
+                const auto &mr = view.meshes[i];
+                meshHandles[i] = shared->second;
+                ++m_dedupMeshHits;
+                m_dedupBytesSkipped += uint64_t(mr.vertexCount) * mr.vertexStride + uint64_t(mr.indexCount) * (mr.indexType == 0 ? 2u : 4u);
+            }
+        }
+
+        // One staging buffer for the whole model: sized for every texture, mesh and meshlet table
+        // (16 bytes of alignment slack per slice); the slices below are carved out of it.
+        VkDeviceSize stagingBytes = 0;
+        for (uint32_t i = 0; i < view.textureCount(); i++)
+        {
+            const auto &t = view.textures[i];
+            uint32_t w = 0, h = 0;
+            if (textureHandles[i].isValid())
+                continue;
+            if (smodel::BlockBytes(t.encoding) != 0)
+                stagingBytes += t.imageDataSize + 16u;
+            else if (images && i < images->size() && !(*images)[i].rgba.empty())
+                stagingBytes += (*images)[i].rgba.size() + 16u;
+            else if (TextureAsset::probeImage(view.blob + t.imageDataOffset, static_cast<size_t>(t.imageDataSize), w, h))
+                stagingBytes += VkDeviceSize(w) * h * 4u + 16u;
+        }
+        for (uint32_t i = 0; i < view.meshCount(); i++)
+        {
+            const auto &mr = view.meshes[i];
+            if (meshHandles[i].isValid())
+                continue;
+            stagingBytes += VkDeviceSize(mr.vertexCount) * mr.vertexStride + VkDeviceSize(mr.indexCount) * (mr.indexType == 0 ? 2u : 4u) + 32u;
+        }
+        if (view.meshletCount() > 0)
+            stagingBytes += VkDeviceSize(view.meshletCount()) * sizeof(MeshletGpu) +
+                            VkDeviceSize(view.meshletVertexCount()) * 4u + VkDeviceSize(view.meshletTriangleBytes() / 3u) * 4u + 16u;
+        if (stagingBytes > 0 && !Engine::ReserveStaging(upload, stagingBytes))
+            return false;
+
         // --------------------------
-        // Upload textures (deferred)
+        // Upload textures (deferred, submitted by the caller)
         // --------------------------
-        std::vector<TextureHandle> textureHandles;
-        textureHandles.resize(view.textureCount());
-
+        std::unordered_map<uint64_t, uint32_t> firstTexture; // content hash -> first texture index
         for (uint32_t i = 0; i < view.textureCount(); i++)
         {
             const auto &t = view.textures[i];
+            if (textureHandles[i].isValid())
+                continue;
+            auto first = firstTexture.emplace(hashes->textures[i], i);
+            if (!first.second)
+            {
+                textureHandles[i] = textureHandles[first.first->second];
+                continue;
+            }
 
             // These fields come from your .smodel texture record format
             const bool isSRGB = (t.colorSpace == 1); // 1 = SRGB
@@ -473,36 +806,52 @@ namespace Engine
             // IMPORTANT:
             // We create textures with refCount=0 (materials will addRef them)
             // This avoids leaking textures when model is destroyed.
-            if (!tex->uploadEncodedImage_Deferred(
-                    upload,
-                    bytes,
-                    sizeBytes,
-                    isSRGB,
-                    wrapU,
-                    wrapV,
-                    minF,
-                    magF,
-                    mipM,
-                    t.maxAnisotropy))
-            {
-                // Cleanup on failure
-                Engine::EndSubmitAndWait(upload);
-                vkDestroyCommandPool(m_device, uploadPool, nullptr);
-                return ModelHandle{};
-            }
+            // Pixels decoded by a streaming worker (loadModelAsync) skip the decode here.
+            // Block-compressed (V8) textures carry their mips and upload as stored, only the coarse
+            // ones for now (texture streaming).
+            const DecodedImage *decoded = (images && i < images->size() && !(*images)[i].rgba.empty()) ? &(*images)[i] : nullptr;
+            const bool blockCompressed = smodel::BlockBytes(t.encoding) != 0;
+            bool uploaded = false;
+            if (blockCompressed)
+                uploaded = tex->uploadBlockCompressed_Deferred(upload, bytes, sizeBytes, t.encoding, t.width, t.height,
+                                                               isSRGB, wrapU, wrapV, minF, magF, mipM, t.maxAnisotropy,
+                                                               StreamedBaseMip(t.width, t.height));
+            else if (decoded)
+                uploaded = tex->uploadRGBA8_Deferred(upload, decoded->rgba.data(), decoded->width, decoded->height,
+                                                     isSRGB, wrapU, wrapV, minF, magF, mipM, t.maxAnisotropy);
+            else
+                uploaded = tex->uploadEncodedImage_Deferred(upload, bytes, sizeBytes,
+                                                            isSRGB, wrapU, wrapV, minF, magF, mipM, t.maxAnisotropy);
+            if (!uploaded)
+                return false; // the caller submits what was recorded and drops it
 
+            const uint32_t firstMip = tex->getFirstMip();
             textureHandles[i] = createTexture_Internal(std::move(tex), 0);
-        }
+            out.uploaded.textures.emplace_back(hashes->textures[i], textureHandles[i]);
 
-        // ONE SUBMIT for all textures
-        if (!Engine::EndSubmitAndWait(upload))
-        {
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
-            return ModelHandle{};
+            // Finer mips stream from the file later (not on the CPU-decode path, which has them all)
+            if (blockCompressed && firstMip > 0)
+            {
+                auto stream = std::make_unique<TextureStream>();
+                stream->path = path;
+                stream->fileOffset = static_cast<uint64_t>(bytes - view.data());
+                stream->encoding = t.encoding;
+                stream->width = t.width;
+                stream->height = t.height;
+                stream->srgb = isSRGB;
+                stream->wrapU = wrapU;
+                stream->wrapV = wrapV;
+                stream->minFilter = minF;
+                stream->magFilter = magF;
+                stream->mipMode = mipM;
+                stream->maxAnisotropy = t.maxAnisotropy;
+                stream->baseMip = firstMip;
+                stream->residentMip = firstMip;
+                stream->wantedMip = firstMip;
+                m_textures.get(textureHandles[i].id)->stream = std::move(stream);
+            }
         }
 
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
-
         // --------------------------
         // Create materials (CPU only)
         // Materials addRef() to textures they use
@@ -572,45 +921,46 @@ namespace Engine
         }
 
         // --------------------------
-        // Create meshes (GPU upload)
+        // Create meshes (GPU upload, deferred)
         // Model will addRef() meshes it uses
         // --------------------------
-        std::vector<MeshHandle> meshHandles;
-        meshHandles.resize(view.meshCount());
-
+        std::unordered_map<uint64_t, uint32_t> firstMesh; // content hash -> first mesh index
         for (uint32_t i = 0; i < view.meshCount(); i++)
         {
             const auto &mr = view.meshes[i];
+            if (meshHandles[i].isValid())
+                continue;
+            auto first = firstMesh.emplace(hashes->meshes[i], i);
+            if (!first.second)
+            {
+                meshHandles[i] = meshHandles[first.first->second];
+                continue;
+            }
 
             MeshData md;
             md.vertexCount = mr.vertexCount;
             md.indexCount = mr.indexCount;
             md.vertexStride = mr.vertexStride;
             md.indexFormat = (mr.indexType == 0) ? 0 : 1;
+            md.compactVertices = (mr.layoutFlags & smodel::VTX_COMPACT) != 0;
 
             std::memcpy(md.aabbMin, mr.aabbMin, sizeof(md.aabbMin));
             std::memcpy(md.aabbMax, mr.aabbMax, sizeof(md.aabbMax));
 
-            // Copy vertex bytes from blob
+            // Vertex/index bytes go from the blob (the mapped file) straight to staging memory,
+            // coded streams (V9) decoded on the way
             const uint8_t *vb = view.blob + mr.vertexDataOffset;
-            md.vertexBytes.assign(vb, vb + mr.vertexDataSize);
-
-            // Copy index bytes
             const uint8_t *ib = view.blob + mr.indexDataOffset;
+            const size_t vbEncoded = (mr.layoutFlags & smodel::MESH_VERTEX_CODEC) ? static_cast<size_t>(mr.vertexDataSize) : 0;
+            const size_t ibEncoded = (mr.layoutFlags & smodel::MESH_INDEX_CODEC) ? static_cast<size_t>(mr.indexDataSize) : 0;
 
-            if (md.indexFormat == 0)
-            {
-                md.indices16.resize(md.indexCount);
-                std::memcpy(md.indices16.data(), ib, md.indexCount * sizeof(uint16_t));
-            }
-            else
+            // Create mesh with refCount=0 (model will addRef as needed); copies recorded into 'upload'
+            auto mesh = std::make_unique<MeshAsset>();
+            if (mesh->upload_Deferred(upload, m_geometry, md, vb, vbEncoded, ib, ibEncoded))
             {
-                md.indices32.resize(md.indexCount);
-                std::memcpy(md.indices32.data(), ib, md.indexCount * sizeof(uint32_t));
+                meshHandles[i] = createMesh_Internal(std::move(mesh), path + "#mesh" + std::to_string(i), 0);
+                out.uploaded.meshes.emplace_back(hashes->meshes[i], meshHandles[i]);
             }
-
-            // Create mesh with refCount=0 (model will addRef as needed)
-            meshHandles[i] = createMeshFromData_Internal(md, cookedModelPath + "#mesh" + std::to_string(i), 0);
         }
 
         // --------------------------
@@ -621,14 +971,8 @@ namespace Engine
 
         model->debugName = ""; // optional: you can store filename later
 
-        // Initialize bounds as invalid until we see a mesh
-        model->hasBounds = false;
-        model->fitScale = 1.0f;
-        model->center[0] = model->center[1] = model->center[2] = 0.0f;
-        model->boundsMin[0] = model->boundsMin[1] = model->boundsMin[2] = 0.0f;
-        model->boundsMax[0] = model->boundsMax[1] = model->boundsMax[2] = 0.0f;
-
         model->primitives.resize(view.primitiveCount());
+        std::vector<PrimitiveBounds> primBounds(view.primitiveCount()); // ComputeModelBounds()
 
         std::vector<MeshHandle> meshDeps;
         std::vector<MaterialHandle> matDeps;
@@ -637,6 +981,13 @@ namespace Engine
         std::unordered_set<uint64_t> matDepIds;
         meshDepIds.reserve(static_cast<size_t>(view.primitiveCount()));
         matDepIds.reserve(static_cast<size_t>(view.primitiveCount()));
+        auto releaseDeps = [&]()
+        {
+            for (MeshHandle &mh : meshDeps)
+                release(mh);
+            for (MaterialHandle &mat : matDeps)
+                release(mat);
+        };
 
         for (uint32_t i = 0; i < view.primitiveCount(); i++)
         {
@@ -648,7 +999,14 @@ namespace Engine
             prim.firstIndex = p.firstIndex;
             prim.indexCount = p.indexCount;
             prim.vertexOffset = p.vertexOffset;
+            // Rebase the mesh-relative range onto the geometry arena
+            if (const MeshAsset *primMesh = getMesh(prim.mesh))
+            {
+                prim.firstIndex += primMesh->getFirstIndex();
+                prim.vertexOffset += primMesh->getVertexOffset();
+            }
             prim.skinIndex = p.skinIndex;
+            prim.lodNext = p.lodNext; // validated by the loader
 
             model->primitives[i] = prim;
 
@@ -662,29 +1020,12 @@ namespace Engine
                     meshDeps.push_back(prim.mesh);
                 }
 
-                // Expand model bounds from mesh bounds
-                MeshAsset *mesh = getMesh(prim.mesh);
-                if (mesh)
+                // Mesh box for the model bounds
+                if (const MeshAsset *mesh = getMesh(prim.mesh))
                 {
-                    const float *mn = mesh->getAABBMin();
-                    const float *mx = mesh->getAABBMax();
-
-                    if (!model->hasBounds)
-                    {
-                        std::memcpy(model->boundsMin, mn, sizeof(model->boundsMin));
-                        std::memcpy(model->boundsMax, mx, sizeof(model->boundsMax));
-                        model->hasBounds = true;
-                    }
-                    else
-                    {
-                        model->boundsMin[0] = std::min(model->boundsMin[0], mn[0]);
-                        model->boundsMin[1] = std::min(model->boundsMin[1], mn[1]);
-                        model->boundsMin[2] = std::min(model->boundsMin[2], mn[2]);
-
-                        model->boundsMax[0] = std::max(model->boundsMax[0], mx[0]);
-                        model->boundsMax[1] = std::max(model->boundsMax[1], mx[1]);
-                        model->boundsMax[2] = std::max(model->boundsMax[2], mx[2]);
-                    }
+                    std::memcpy(primBounds[i].min, mesh->getAABBMin(), sizeof(primBounds[i].min));
+                    std::memcpy(primBounds[i].max, mesh->getAABBMax(), sizeof(primBounds[i].max));
+                    primBounds[i].valid = true;
                 }
             }
             if (prim.material.isValid())
@@ -698,6 +1039,21 @@ namespace Engine
             }
         }
 
+        // Mesh LOD chains: mark LOD primitives and find the longest chain.
+        model->meshLodCount = 1;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(model->primitives.size()); ++i)
+        {
+            if (model->primitives[i].isLod)
+                continue;
+            uint32_t levels = 1;
+            for (uint32_t next = model->primitives[i].lodNext; next != 0; next = model->primitives[next].lodNext)
+            {
+                model->primitives[next].isLod = true;
+                ++levels;
+            }
+            model->meshLodCount = std::min(std::max(model->meshLodCount, levels), ModelAsset::kMaxMeshLods);
+        }
+
         // --------------------------
         // V4: Populate skin tables (optional)
         // --------------------------
@@ -719,8 +1075,9 @@ namespace Engine
                 {
                     if (sr.firstJointNodeIndex + sr.jointCount > view.skinJointNodeIndicesCount())
                     {
-                        std::cout << "[AssetManager] loadModel: Skin jointNodeIndices out of range (skinIndex=" << si << ")\n";
-                        return ModelHandle{};
+                        ENGINE_LOG_ERROR("[AssetManager] loadModel: Skin jointNodeIndices out of range (skinIndex=%u)", static_cast<unsigned>(si));
+                        releaseDeps();
+                        return false;
                     }
 
                     const uint32_t *srcJ = view.skinJointNodeIndices + sr.firstJointNodeIndex;
@@ -730,8 +1087,9 @@ namespace Engine
                     const uint64_t neededFloats = uint64_t(sr.jointCount) * 16ull;
                     if (uint64_t(sr.firstInverseBindMatrix) + neededFloats > view.skinInverseBindMatricesCount())
                     {
-                        std::cout << "[AssetManager] loadModel: Skin inverseBindMatrices out of range (skinIndex=" << si << ")\n";
-                        return ModelHandle{};
+                        ENGINE_LOG_ERROR("[AssetManager] loadModel: Skin inverseBindMatrices out of range (skinIndex=%u)", static_cast<unsigned>(si));
+                        releaseDeps();
+                        return false;
                     }
 
                     skin.inverseBind.resize(sr.jointCount);
@@ -752,279 +1110,556 @@ namespace Engine
             model->totalJointCount = 0;
         }
 
-        // Precompute center and fit scale to 20 units if bounds are valid
-        if (model->hasBounds)
-        {
-            model->center[0] = 0.5f * (model->boundsMin[0] + model->boundsMax[0]);
-            model->center[1] = 0.5f * (model->boundsMin[1] + model->boundsMax[1]);
-            model->center[2] = 0.5f * (model->boundsMin[2] + model->boundsMax[2]);
-
-            const float sizeX = model->boundsMax[0] - model->boundsMin[0];
-            const float sizeY = model->boundsMax[1] - model->boundsMin[1];
-            const float sizeZ = model->boundsMax[2] - model->boundsMin[2];
-            const float maxExtent = std::max(sizeX, std::max(sizeY, sizeZ));
-
-            const float target = TARGET;
-            const float epsilon = 1e-4f;
-            if (maxExtent > epsilon)
-                model->fitScale = target / maxExtent;
-            else
-                model->fitScale = 4.0f;
-        }
-
         // --------------------------
         // V2: Populate nodes and primitive index mapping
         // --------------------------
-        if (view.nodeCount() > 0)
+        // (bounds: the meshes' union, then in node-global space when there are nodes)
+        CopyModelNodes(view, *model);
+        ComputeModelBounds(*model, primBounds);
+
+        // --------------------------
+        // V3: Copy animations into ModelAsset (node TRS only)
+        // --------------------------
+        CopyModelAnimations(view, *model);
+        model->bakeAnimations(kBakedAnimationFps, kBakedAnimationMaxMatrices);
+
+        model->animState.clipIndex = 0;
+        model->animState.timeSec = 0.0f;
+        model->animState.loop = true;
+        model->animState.playing = true;
+
+        // V7: meshlet tables for GPU cluster culling (optional; the model still draws without them)
+        GeometryArena::Range meshletRange = uploadMeshlets_Internal(view, *model, upload);
+        if (view.meshletCount() > 0 && !meshletRange.isValid())
+            ENGINE_LOG_WARN("[AssetManager] loadModel: meshlet upload failed, drawing without meshlet culling: %s", path.c_str());
+
+        out.asset = std::move(model);
+        out.meshDeps = std::move(meshDeps);
+        out.materialDeps = std::move(matDeps);
+        out.meshletRange = meshletRange;
+        return true;
+    }
+
+    ModelHandle AssetManager::loadModelAsync(const std::string &cookedModelPath)
+    {
+        auto it = m_modelPathCache.find(cookedModelPath);
+        if (it != m_modelPathCache.end())
+        {
+            addRef(it->second);
+            return it->second;
+        }
+
+        if (!m_streamJobs)
+            m_streamJobs = std::make_unique<JobSystem>(kStreamingThreads);
+
+        // The handle exists from now on; its asset arrives through update()
+        ModelHandle modelHandle = createModel_Internal(nullptr, cookedModelPath, 1);
+        m_models.get(modelHandle.id)->state = LoadState::Pending;
+        m_modelPathCache.emplace(cookedModelPath, modelHandle);
+
+        m_pendingModels.push_back(std::make_unique<PendingModel>());
+        PendingModel *pending = m_pendingModels.back().get();
+        pending->id = modelHandle.id;
+        pending->path = cookedModelPath;
+        pending->requestNs = Profiler::now();
+
+        // Streaming worker: the file read and the image decodes, nothing that touches Vulkan or
+        // the AssetManager's tables
+        m_streamJobs->submit(pending->decoded, [pending]()
+                             {
+            ENGINE_PROFILE_SCOPE("Decode model");
+            pending->decodeStartNs = Profiler::now();
+            struct DecodeEnd
+            {
+                PendingModel *pending;
+                ~DecodeEnd() { pending->decodeEndNs = Profiler::now(); }
+            } decodeEnd{pending};
+
+            pending->ok = Engine::smodel::LoadSModelFile(pending->path, pending->view, pending->error);
+            if (!pending->ok)
+                return;
+            const smodel::SModelFileView &view = pending->view;
+            computeContentHashes_Internal(view, pending->hashes);
+            pending->images.resize(view.textureCount());
+            for (uint32_t i = 0; i < view.textureCount(); ++i)
+            {
+                const auto &t = view.textures[i];
+                if (smodel::BlockBytes(t.encoding) != 0)
+                    continue; // uploaded as stored
+                DecodedImage &image = pending->images[i];
+                if (!TextureAsset::decodeImage(view.blob + t.imageDataOffset, static_cast<size_t>(t.imageDataSize),
+                                               image.rgba, image.width, image.height))
+                {
+                    pending->ok = false;
+                    pending->error = "failed to decode texture " + std::to_string(i);
+                    return;
+                }
+            } });
+        return modelHandle;
+    }
+
+    AssetManager::LoadState AssetManager::getModelState(ModelHandle h) const
+    {
+        const ModelEntry *e = m_models.find(h.id, h.generation);
+        return e ? e->state : LoadState::Invalid;
+    }
+
+    const std::string &AssetManager::getModelPath(ModelHandle h) const
+    {
+        static const std::string kNone;
+        const ModelEntry *e = m_models.find(h.id, h.generation);
+        return e ? e->path : kNone;
+    }
+
+    void AssetManager::update()
+    {
+        ENGINE_PROFILE_SCOPE("AssetManager::update");
+        uint32_t uploads = 0;
+        for (size_t i = 0; i < m_pendingModels.size();)
         {
-            model->nodes.resize(view.nodeCount());
-            model->nodePrimitiveIndices.resize(view.nodePrimitiveIndexCount());
-            model->nodeChildIndices.resize(view.nodeChildIndexCount());
+            PendingModel &pending = *m_pendingModels[i];
 
-            // Copy primitive indices array
-            if (view.nodePrimitiveIndexCount() > 0 && view.nodePrimitiveIndices)
+            // Decoded but not uploaded yet: at most kMaxModelUploadsPerUpdate start per call, since
+            // recording copies every byte of the model into staging memory
+            const bool startsUpload = !pending.upload.submitted && pending.decoded.done();
+            if (startsUpload && uploads >= kMaxModelUploadsPerUpdate)
             {
-                std::memcpy(model->nodePrimitiveIndices.data(), view.nodePrimitiveIndices, sizeof(uint32_t) * view.nodePrimitiveIndexCount());
+                ++i;
+                continue;
             }
+            uploads += startsUpload ? 1u : 0u;
 
-            // Copy child indices array
-            if (view.nodeChildIndexCount() > 0 && view.nodeChildIndices)
+            if (advancePendingModel_Internal(pending, false))
             {
-                std::memcpy(model->nodeChildIndices.data(), view.nodeChildIndices, sizeof(uint32_t) * view.nodeChildIndexCount());
+                traceModelLoad_Internal(pending);
+                m_pendingModels.erase(m_pendingModels.begin() + static_cast<std::ptrdiff_t>(i));
             }
+            else
+                ++i;
+        }
 
-            // Track first root (parentIndex == UINT32_MAX)
-            uint32_t rootIdx = 0;
-            const uint32_t U32_MAX = ~0u;
+        updateTextureStreaming_Internal();
+        publishCpuMemory_Internal();
+    }
 
-            for (uint32_t i = 0; i < view.nodeCount(); ++i)
+    void AssetManager::publishCpuMemory_Internal()
+    {
+        uint64_t assetBytes = 0;
+        uint64_t animationBytes = 0;
+        auto addModel = [&](const ModelAsset &model)
+        {
+            assetBytes += model.cpuBytes();
+            animationBytes += model.animationBytes();
+        };
+        m_models.forEach([&](uint64_t, const ModelEntry &e)
+                         {
+            if (e.asset)
+                addModel(*e.asset); });
+        for (const auto &pending : m_pendingModels)
+        {
+            // The worker owns the images until the decode is done
+            if (pending->decoded.done())
             {
-                const Engine::smodel::SModelNodeRecord &nr = view.nodes[i];
-                ModelAsset::ModelNode &dst = model->nodes[i];
-
-                dst.parentIndex = nr.parentIndex;
-                dst.firstChildIndex = nr.childCount ? nr.firstChildIndex : U32_MAX;
-                dst.childCount = nr.childCount;
-                dst.firstPrimitiveIndex = nr.firstPrimitiveIndex;
-                dst.primitiveCount = nr.primitiveCount;
-                dst.debugName = view.getStringOrEmpty(nr.nameStrOffset);
+                for (const DecodedImage &image : pending->images)
+                    assetBytes += ModelAsset::VectorBytes(image.rgba);
+            }
+            if (pending->asset)
+                addModel(*pending->asset);
+        }
+        MemoryTracker::set(CpuMemoryCategory::AssetData, assetBytes);
+        MemoryTracker::set(CpuMemoryCategory::Animation, animationBytes);
+    }
 
-                // Copy local matrix (column-major)
-                std::memcpy(glm::value_ptr(dst.localMatrix), nr.localMatrix, sizeof(nr.localMatrix));
+    // ------------------------------------------------------------
+    // Texture streaming
+    // ------------------------------------------------------------
+    void AssetManager::requestTextureDetail(MaterialHandle h, float screenPixels)
+    {
+        const MaterialEntry *mat = m_materials.find(h.id, h.generation);
+        if (!mat)
+            return;
 
-                // Defer global computation; ordering is not guaranteed.
-                dst.globalMatrix = glm::mat4(1.0f);
+        for (const TextureHandle &th : mat->textureDeps)
+        {
+            TextureEntry *t = m_textures.find(th.id, th.generation);
+            if (!t || !t->stream)
+                continue;
+
+            // About one texel per pixel: the coarsest mip still as large as the on-screen size
+            TextureStream &s = *t->stream;
+            const uint32_t size = std::max(s.width, s.height);
+            uint32_t mip = 0;
+            while (mip < s.baseMip && static_cast<float>(size >> (mip + 1)) >= screenPixels)
+                ++mip;
+            s.requestedMip = std::min(s.requestedMip, mip);
+            s.requestedPixels = std::max(s.requestedPixels, screenPixels);
+        }
+    }
 
-                if (nr.parentIndex == U32_MAX)
-                    rootIdx = i;
-            }
+    AssetManager::DedupStats AssetManager::getDedupStats() const
+    {
+        DedupStats stats;
+        stats.sharedTextures = static_cast<uint32_t>(m_textureByContent.size());
+        stats.sharedMeshes = static_cast<uint32_t>(m_meshByContent.size());
+        stats.textureHits = m_dedupTextureHits;
+        stats.meshHits = m_dedupMeshHits;
+        stats.bytesSkipped = m_dedupBytesSkipped;
+        return stats;
+    }
 
-            model->rootNodeIndex = rootIdx;
+    AssetManager::TextureStreamingStats AssetManager::getTextureStreamingStats() const
+    {
+        TextureStreamingStats stats;
+        m_textures.forEach([&stats](uint64_t, const TextureEntry &e)
+                           {
+            const TextureStream *s = e.stream.get();
+            if (!s)
+                return;
+            ++stats.streamedTextures;
+            stats.fullyResident += (s->residentMip == 0) ? 1u : 0u;
+            stats.residentBytes += StreamedChainBytes(s->encoding, s->width, s->height, s->residentMip); });
+        stats.streamingTextures = m_textureStream ? static_cast<uint32_t>(m_textureStream->handles.size()) : 0u;
+        stats.requestedBytes = m_requestedTextureBytes;
+        stats.budgetBytes = m_textureBudget;
+        stats.mipsStreamedIn = m_mipsStreamedIn;
+        stats.mipsEvicted = m_mipsEvicted;
+        return stats;
+    }
 
-            // Compute globals using explicit child lists (supports any node ordering).
-            {
-                const uint32_t nodeCount = static_cast<uint32_t>(model->nodes.size());
-                std::vector<uint8_t> visited(nodeCount, 0);
+    void AssetManager::updateTextureStreaming_Internal()
+    {
+        ++m_textureUpdate;
 
-                std::function<void(uint32_t, const glm::mat4 &)> compute = [&](uint32_t nodeIdx, const glm::mat4 &parentGlobal)
-                {
-                    if (nodeIdx >= nodeCount)
-                        return;
-                    if (visited[nodeIdx])
-                        return;
-                    visited[nodeIdx] = 1;
-
-                    ModelAsset::ModelNode &n = model->nodes[nodeIdx];
-                    n.globalMatrix = parentGlobal * n.localMatrix;
-
-                    if (n.childCount == 0)
-                        return;
-                    if (n.firstChildIndex == U32_MAX)
-                        return;
-
-                    const uint32_t start = n.firstChildIndex;
-                    for (uint32_t ci = 0; ci < n.childCount; ++ci)
-                    {
-                        const uint32_t child = model->nodeChildIndices[start + ci];
-                        compute(child, n.globalMatrix);
-                    }
-                };
+        // One upload at a time: swap it in once it has landed
+        if (m_textureStream)
+        {
+            if (!Engine::IsUploadComplete(m_textureStream->upload))
+                return;
+            finishTextureStream_Internal();
+        }
 
-                for (uint32_t i = 0; i < nodeCount; ++i)
-                {
-                    if (model->nodes[i].parentIndex == U32_MAX)
-                        compute(i, glm::mat4(1.0f));
-                }
+        // Wanted mips: the last request, the base once idle
+        struct Candidate
+        {
+            TextureHandle handle;
+            TextureStream *stream;
+        };
+        std::vector<Candidate> candidates;
+        uint64_t wantedBytes = 0;
+        m_textures.forEach([&](uint64_t id, TextureEntry &e)
+                           {
+            TextureStream *s = e.stream.get();
+            if (!s)
+                return;
+            if (s->requestedMip != UINT32_MAX)
+            {
+                s->wantedMip = s->requestedMip;
+                s->pixels = s->requestedPixels;
+                s->lastRequest = m_textureUpdate;
+                s->requestedMip = UINT32_MAX;
+                s->requestedPixels = 0.0f;
             }
-
-            // Recompute bounds in node-global space (node transforms applied)
-            bool firstCorner = true;
-            glm::vec3 bmin(0.0f);
-            glm::vec3 bmax(0.0f);
-
-            for (const auto &node : model->nodes)
+            else if (m_textureUpdate - s->lastRequest > kTextureIdleUpdates)
+            {
+                s->wantedMip = s->baseMip;
+            }
+            wantedBytes += StreamedChainBytes(s->encoding, s->width, s->height, s->wantedMip);
+            TextureHandle handle;
+            handle.id = id;
+            handle.generation = m_textures.generation(id);
+            candidates.push_back({handle, s}); });
+        m_requestedTextureBytes = wantedBytes;
+        if (candidates.empty())
+            return;
+
+        // Over budget: coarsen the least recently requested, then the smallest on screen, a mip at a
+        // time until it fits (base mips always stay)
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b)
+                  {
+                      if (a.stream->lastRequest != b.stream->lastRequest)
+                          return a.stream->lastRequest < b.stream->lastRequest;
+                      return a.stream->pixels < b.stream->pixels; });
+        bool coarsened = true;
+        while (wantedBytes > m_textureBudget && coarsened)
+        {
+            coarsened = false;
+            for (const Candidate &c : candidates)
             {
-                if (node.primitiveCount == 0)
+                if (wantedBytes <= m_textureBudget)
+                    break;
+                TextureStream &s = *c.stream;
+                if (s.wantedMip >= s.baseMip)
                     continue;
-
-                for (uint32_t k = 0; k < node.primitiveCount; ++k)
-                {
-                    const uint32_t primIndex = model->nodePrimitiveIndices[node.firstPrimitiveIndex + k];
-                    if (primIndex >= model->primitives.size())
-                        continue;
-
-                    const ModelPrimitive &prim = model->primitives[primIndex];
-                    MeshAsset *mesh = getMesh(prim.mesh);
-                    if (!mesh)
-                        continue;
-
-                    const float *mn = mesh->getAABBMin();
-                    const float *mx = mesh->getAABBMax();
-
-                    const glm::vec3 c0(mn[0], mn[1], mn[2]);
-                    const glm::vec3 c1(mx[0], mn[1], mn[2]);
-                    const glm::vec3 c2(mn[0], mx[1], mn[2]);
-                    const glm::vec3 c3(mx[0], mx[1], mn[2]);
-                    const glm::vec3 c4(mn[0], mn[1], mx[2]);
-                    const glm::vec3 c5(mx[0], mn[1], mx[2]);
-                    const glm::vec3 c6(mn[0], mx[1], mx[2]);
-                    const glm::vec3 c7(mx[0], mx[1], mx[2]);
-
-                    const glm::vec3 corners[8] = {c0, c1, c2, c3, c4, c5, c6, c7};
-                    for (const glm::vec3 &corner : corners)
-                    {
-                        const glm::vec4 w = node.globalMatrix * glm::vec4(corner, 1.0f);
-                        const glm::vec3 p(w.x, w.y, w.z);
-                        if (firstCorner)
-                        {
-                            bmin = p;
-                            bmax = p;
-                            firstCorner = false;
-                        }
-                        else
-                        {
-                            bmin.x = std::min(bmin.x, p.x);
-                            bmin.y = std::min(bmin.y, p.y);
-                            bmin.z = std::min(bmin.z, p.z);
-                            bmax.x = std::max(bmax.x, p.x);
-                            bmax.y = std::max(bmax.y, p.y);
-                            bmax.z = std::max(bmax.z, p.z);
-                        }
-                    }
-                }
+                wantedBytes -= StreamedChainBytes(s.encoding, s.width, s.height, s.wantedMip) -
+                               StreamedChainBytes(s.encoding, s.width, s.height, s.wantedMip + 1u);
+                ++s.wantedMip;
+                coarsened = true;
             }
+        }
+
+        // Restreams: evictions first (they make room), then loads, most wanted first
+        std::vector<TextureHandle> restreams;
+        for (const Candidate &c : candidates)
+        {
+            if (restreams.size() < kMaxTextureStreamsPerUpdate && c.stream->wantedMip > c.stream->residentMip)
+                restreams.push_back(c.handle);
+        }
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+        {
+            if (restreams.size() < kMaxTextureStreamsPerUpdate && it->stream->wantedMip < it->stream->residentMip)
+                restreams.push_back(it->handle);
+        }
+        if (!restreams.empty())
+            startTextureStream_Internal(restreams);
+    }
 
-            if (!firstCorner)
+    bool AssetManager::startTextureStream_Internal(const std::vector<TextureHandle> &textures)
+    {
+        // Each chain is read back from its source file, opened once per upload
+        std::unordered_map<std::string, FileData> files;
+        VkDeviceSize stagingBytes = 0;
+        std::vector<TextureHandle> valid;
+        for (const TextureHandle &th : textures)
+        {
+            TextureEntry &entry = *m_textures.find(th.id, th.generation);
+            TextureStream &s = *entry.stream;
+            auto it = files.find(s.path);
+            if (it == files.end())
             {
-                model->boundsMin[0] = bmin.x;
-                model->boundsMin[1] = bmin.y;
-                model->boundsMin[2] = bmin.z;
-                model->boundsMax[0] = bmax.x;
-                model->boundsMax[1] = bmax.y;
-                model->boundsMax[2] = bmax.z;
-                model->hasBounds = true;
-
-                model->center[0] = 0.5f * (model->boundsMin[0] + model->boundsMax[0]);
-                model->center[1] = 0.5f * (model->boundsMin[1] + model->boundsMax[1]);
-                model->center[2] = 0.5f * (model->boundsMin[2] + model->boundsMax[2]);
-
-                const float sizeX = model->boundsMax[0] - model->boundsMin[0];
-                const float sizeY = model->boundsMax[1] - model->boundsMin[1];
-                const float sizeZ = model->boundsMax[2] - model->boundsMin[2];
-                const float maxExtent = std::max(sizeX, std::max(sizeY, sizeZ));
-
-                const float target = TARGET;
-                const float epsilon = 1e-4f;
-                model->fitScale = (maxExtent > epsilon) ? (target / maxExtent) : 1.0f;
+                FileData file;
+                if (VirtualFileSystem::read(s.path, file))
+                    it = files.emplace(s.path, std::move(file)).first;
             }
+            if (it == files.end())
+            {
+                ENGINE_LOG_WARN("[AssetManager] Texture streaming: cannot read %s, keeping its resident mips", s.path.c_str());
+                entry.stream.reset();
+                continue;
+            }
+            const uint64_t chainBytes = smodel::BlockMipChainBytes(s.encoding, s.width, s.height);
+            if (s.fileOffset + chainBytes > it->second.size())
+            {
+                ENGINE_LOG_WARN("[AssetManager] Texture streaming: %s changed on disk, keeping its resident mips", s.path.c_str());
+                entry.stream.reset();
+                continue;
+            }
+            stagingBytes += StreamedChainBytes(s.encoding, s.width, s.height, s.wantedMip) + 16u;
+            valid.push_back(th);
         }
-
-        // --------------------------
-        // V3: Copy animations into ModelAsset (node TRS only)
-        // --------------------------
-        if (view.animClipCount() > 0)
+        if (valid.empty())
+            return false;
+
+        auto stream = std::make_unique<TextureStreamUpload>();
+        stream->startNs = Profiler::now();
+        if (!beginUpload_Internal(stream->upload, stream->pools))
+            return false;
+        if (!Engine::ReserveStaging(stream->upload, stagingBytes))
         {
-            model->animClips.resize(view.animClipCount());
-            std::memcpy(model->animClips.data(), view.animClips, sizeof(smodel::SModelAnimationClipRecord) * view.animClipCount());
+            Engine::EndSubmitAndWait(stream->upload);
+            destroyUploadPools_Internal(stream->pools);
+            return false;
         }
-        if (view.animChannelCount() > 0)
+
+        for (TextureHandle th : valid)
         {
-            model->animChannels.resize(view.animChannelCount());
-            std::memcpy(model->animChannels.data(), view.animChannels, sizeof(smodel::SModelAnimationChannelRecord) * view.animChannelCount());
+            const TextureStream &s = *m_textures.find(th.id, th.generation)->stream;
+            const FileData &file = files.at(s.path);
+            const uint8_t *bytes = file.data() + s.fileOffset;
+
+            auto tex = std::make_unique<TextureAsset>();
+            if (!tex->uploadBlockCompressed_Deferred(stream->upload, bytes,
+                                                     static_cast<size_t>(smodel::BlockMipChainBytes(s.encoding, s.width, s.height)),
+                                                     s.encoding, s.width, s.height, s.srgb, s.wrapU, s.wrapV,
+                                                     s.minFilter, s.magFilter, s.mipMode, s.maxAnisotropy, s.wantedMip))
+            {
+                // What it recorded runs with the rest; an invalid handle has it destroyed once that has
+                ENGINE_LOG_WARN("[AssetManager] Texture streaming: failed to record mip %u of %s", s.wantedMip, s.path.c_str());
+                th = TextureHandle{};
+            }
+            stream->handles.push_back(th);
+            stream->textures.push_back(std::move(tex));
         }
-        if (view.animSamplerCount() > 0)
+
+        if (!Engine::EndSubmit(stream->upload))
         {
-            model->animSamplers.resize(view.animSamplerCount());
-            std::memcpy(model->animSamplers.data(), view.animSamplers, sizeof(smodel::SModelAnimationSamplerRecord) * view.animSamplerCount());
+            destroyUploadPools_Internal(stream->pools);
+            for (auto &tex : stream->textures)
+                tex->destroy(m_device);
+            return false;
         }
-        if (view.animTimesCount() > 0)
+        m_textureStream = std::move(stream);
+        return true;
+    }
+
+    void AssetManager::finishTextureStream_Internal()
+    {
+        TextureStreamUpload &stream = *m_textureStream;
+        const bool uploaded = Engine::FinishUpload(stream.upload);
+        destroyUploadPools_Internal(stream.pools);
+
+        // The replaced images go to the retire list; replacements of collected textures, or of a
+        // failed upload, are not in use and go now
+        std::vector<std::unique_ptr<TextureAsset>> retired;
+        for (size_t i = 0; i < stream.handles.size(); ++i)
         {
-            model->animTimes.resize(view.animTimesCount());
-            std::memcpy(model->animTimes.data(), view.animTimes, sizeof(float) * view.animTimesCount());
+            std::unique_ptr<TextureAsset> &tex = stream.textures[i];
+            TextureEntry *entry = m_textures.find(stream.handles[i].id, stream.handles[i].generation);
+            if (!uploaded || !tex->isValid() || !entry || !entry->stream || !entry->asset)
+            {
+                tex->destroy(m_device);
+                continue;
+            }
+
+            TextureStream &s = *entry->stream;
+            const uint32_t mip = tex->getFirstMip();
+            if (mip < s.residentMip)
+                m_mipsStreamedIn += s.residentMip - mip;
+            else
+                m_mipsEvicted += mip - s.residentMip;
+            s.residentMip = mip;
+
+            // Same TextureAsset, so pointers to it stay valid; 'tex' now holds the old GPU objects
+            std::swap(*entry->asset, *tex);
+            retired.push_back(std::move(tex));
         }
-        if (view.animValuesCount() > 0)
+        if (TraceCapture::active() || HitchDetector::enabled())
         {
-            model->animValues.resize(view.animValuesCount());
-            std::memcpy(model->animValues.data(), view.animValues, sizeof(float) * view.animValuesCount());
+            static uint64_t s_streamTraceId = 0;
+            const std::string name = "Texture mips (" + std::to_string(stream.handles.size()) + ")";
+            const uint64_t now = Profiler::now();
+            TraceCapture::asyncSpan("streaming", name, ++s_streamTraceId, stream.startNs, now);
+            HitchDetector::assetEvent("streaming", name, stream.startNs, now);
         }
+        m_textureStream.reset();
 
-        // --------------------------
-        // Initialize runtime animation TRS buffers from node local matrices
-        // --------------------------
-        model->restTRS.resize(model->nodes.size());
-        model->animatedTRS.resize(model->nodes.size());
-        for (size_t i = 0; i < model->nodes.size(); i++)
+        if (!retired.empty())
         {
-            const glm::mat4 local = model->nodes[i].localMatrix;
-            model->restTRS[i] = DecomposeTRS(local);
-            model->animatedTRS[i] = model->restTRS[i];
+            ++m_bindlessVersion;
+            retireTextures_Internal(std::move(retired));
         }
+    }
 
-        model->animState.clipIndex = 0;
-        model->animState.timeSec = 0.0f;
-        model->animState.loop = true;
-        model->animState.playing = true;
+    void AssetManager::retireTextures_Internal(std::vector<std::unique_ptr<TextureAsset>> textures)
+    {
+        // Frames in flight may still sample these images: destroyed once they have finished
+        std::vector<std::shared_ptr<TextureAsset>> retired(std::make_move_iterator(textures.begin()),
+                                                           std::make_move_iterator(textures.end()));
+        DeletionQueue::Defer(m_device, [device = m_device, retired]()
+                             {
+            for (const auto &tex : retired)
+                tex->destroy(device); });
+    }
 
-        // Register model and cache it
-        ModelHandle modelHandle = createModel_Internal(std::move(model), cookedModelPath, 1);
+    bool AssetManager::advancePendingModel_Internal(PendingModel &pending, bool block)
+    {
+        // Pending entries are not collected, so the entry is there
+        ModelEntry &entry = *m_models.get(pending.id);
 
-        // Fill dependency lists inside the ModelEntry
-        auto modelIt = m_models.find(modelHandle.id);
-        if (modelIt != m_models.end())
+        if (!pending.upload.submitted)
+        {
+            if (!pending.decoded.done())
+            {
+                if (!block)
+                    return false;
+                m_streamJobs->wait(pending.decoded);
+            }
+            if (!pending.ok)
+            {
+                ENGINE_LOG_ERROR("[AssetManager] loadModelAsync: Failed to load %s: %s", pending.path.c_str(), pending.error.c_str());
+                failPendingModel_Internal(pending.id);
+                return true;
+            }
+
+            pending.uploadStartNs = Profiler::now();
+            if (!beginUpload_Internal(pending.upload, pending.pools))
+            {
+                failPendingModel_Internal(pending.id);
+                return true;
+            }
+            ModelBuild build;
+            if (!buildModel_Internal(pending.path, pending.view, &pending.images, &pending.hashes, pending.upload, build))
+            {
+                Engine::EndSubmitAndWait(pending.upload);
+                destroyUploadPools_Internal(pending.pools);
+                failPendingModel_Internal(pending.id);
+                return true;
+            }
+
+            // Dependencies now, so garbageCollect() releases them whatever happens to the upload
+            entry.meshDeps = std::move(build.meshDeps);
+            entry.materialDeps = std::move(build.materialDeps);
+            entry.meshletRange = build.meshletRange;
+            pending.asset = std::move(build.asset);
+            pending.uploaded = std::move(build.uploaded);
+
+            if (!Engine::EndSubmit(pending.upload))
+            {
+                destroyUploadPools_Internal(pending.pools);
+                failPendingModel_Internal(pending.id);
+                return true;
+            }
+
+            // The file and the pixels live in the staging buffers now
+            pending.view = smodel::SModelFileView{};
+            std::vector<DecodedImage>().swap(pending.images);
+            pending.hashes = ContentHashes{};
+            if (!block)
+                return false;
+        }
+
+        if (!block && !Engine::IsUploadComplete(pending.upload))
+            return false;
+        const bool uploaded = Engine::FinishUpload(pending.upload);
+        destroyUploadPools_Internal(pending.pools);
+        if (!uploaded)
         {
-            modelIt->second.meshDeps = std::move(meshDeps);
-            modelIt->second.materialDeps = std::move(matDeps);
+            failPendingModel_Internal(pending.id);
+            return true;
         }
 
-        m_modelPathCache.emplace(cookedModelPath, modelHandle);
-        return modelHandle;
+        shareResources_Internal(pending.uploaded);
+        entry.asset = std::move(pending.asset);
+        entry.state = LoadState::Ready;
+        return true;
     }
 
-    ModelAsset *AssetManager::getModel(ModelHandle h)
+    void AssetManager::traceModelLoad_Internal(const PendingModel &pending) const
     {
-        auto it = m_models.find(h.id);
-        if (it == m_models.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
-            return nullptr;
-        return it->second.asset.get();
+        if (!TraceCapture::active() && !HitchDetector::enabled())
+            return;
+        const uint64_t now = Profiler::now();
+        const ModelEntry *entry = m_models.get(pending.id);
+        const bool ready = entry && entry->state == LoadState::Ready;
+        const std::string name = (ready ? "Load " : "Load failed ") + pending.path;
+        HitchDetector::assetEvent("asset", name, pending.requestNs, now);
+        TraceCapture::asyncSpan("asset", name, pending.id, pending.requestNs, now);
+        if (pending.decodeEndNs > pending.decodeStartNs)
+            TraceCapture::asyncSpan("asset", "Decode", pending.id, pending.decodeStartNs, pending.decodeEndNs);
+        if (pending.uploadStartNs != 0)
+            TraceCapture::asyncSpan("asset", "Upload", pending.id, pending.uploadStartNs, now);
+    }
+
+    void AssetManager::failPendingModel_Internal(uint64_t id)
+    {
+        // Failed for good; later loads of the path start over
+        ModelEntry &entry = *m_models.get(id);
+        entry.state = LoadState::Failed;
+        auto cached = m_modelPathCache.find(entry.path);
+        if (cached != m_modelPathCache.end() && cached->second.id == id)
+            m_modelPathCache.erase(cached);
     }
 
     void AssetManager::addRef(ModelHandle h)
     {
-        auto it = m_models.find(h.id);
-        if (it != m_models.end() && it->second.generation == h.generation)
-            it->second.refCount++;
+        if (ModelEntry *e = m_models.find(h.id, h.generation))
+            e->refCount++;
     }
 
     void AssetManager::release(ModelHandle h)
     {
-        auto it = m_models.find(h.id);
-        if (it != m_models.end() && it->second.generation == h.generation)
-        {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
-        }
+        ModelEntry *e = m_models.find(h.id, h.generation);
+        if (e && e->refCount > 0)
+            e->refCount--;
     }
 
     // ------------------------------------------------------------
@@ -1032,73 +1667,104 @@ namespace Engine
     // ------------------------------------------------------------
     void AssetManager::garbageCollect()
     {
+        // GPU objects and arena ranges go through the device's DeletionQueue: frames in flight may
+        // still draw them, and nothing here waits for the GPU.
+        std::vector<GeometryArena::Range> meshletRanges;
+
         // 1) Destroy models with refCount == 0
-        for (auto it = m_models.begin(); it != m_models.end();)
+        m_models.forEach([&](uint64_t id, ModelEntry &e)
+                         {
+            // Still streaming: update() owns the entry until the load finishes or fails
+            if (e.refCount != 0 || e.state == LoadState::Pending)
+                return;
+
+            // Release model deps
+            for (auto &mh : e.meshDeps)
+                release(mh);
+            for (auto &mat : e.materialDeps)
+                release(mat);
+            if (e.meshletRange.isValid())
+                meshletRanges.push_back(e.meshletRange);
+
+            auto cached = m_modelPathCache.find(e.path);
+            if (cached != m_modelPathCache.end() && cached->second.id == id)
+                m_modelPathCache.erase(cached);
+            m_models.erase(id); });
+        if (!meshletRanges.empty())
         {
-            if (it->second.refCount == 0)
-            {
-                // Release model deps
-                for (auto &mh : it->second.meshDeps)
-                    release(mh);
-                for (auto &mat : it->second.materialDeps)
-                    release(mat);
-
-                m_modelPathCache.erase(it->second.path);
-                it = m_models.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
+            DeletionQueue::Defer(m_device, [this, meshletRanges]()
+                                 {
+                for (const GeometryArena::Range &range : meshletRanges)
+                    m_geometry.free(GeometryArena::Meshlet, range); });
         }
 
         // 2) Destroy materials with refCount == 0
-        for (auto it = m_materials.begin(); it != m_materials.end();)
+        m_materials.forEach([this](uint64_t id, MaterialEntry &e)
+                            {
+            if (e.refCount != 0)
+                return;
+
+            // Release textures referenced by this material
+            for (auto &th : e.textureDeps)
+                release(th);
+            m_materialByIndex[e.index] = 0;
+            m_freeMaterialIndices.push_back(e.index);
+            ++m_bindlessVersion;
+            m_materials.erase(id); });
+
+        // Copies of a submitted streaming upload may still target arena ranges and images of unreferenced
+        // meshes/textures; free those once it has finished
+        for (const auto &pending : m_pendingModels)
         {
-            if (it->second.refCount == 0)
-            {
-                // Release textures referenced by this material
-                for (auto &th : it->second.textureDeps)
-                    release(th);
-                it = m_materials.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
+            if (pending->upload.submitted)
+                return;
         }
 
         // 3) Destroy meshes with refCount == 0
-        for (auto it = m_meshes.begin(); it != m_meshes.end();)
+        std::vector<std::shared_ptr<MeshAsset>> meshes;
+        m_meshes.forEach([&](uint64_t id, MeshEntry &e)
+                         {
+            if (e.refCount != 0)
+                return;
+            if (e.asset)
+                meshes.push_back(std::move(e.asset));
+
+            m_meshPathCache.erase(e.path);
+            if (e.contentHash != 0)
+                m_meshByContent.erase(e.contentHash);
+            m_meshes.erase(id); });
+        if (!meshes.empty())
         {
-            if (it->second.refCount == 0)
-            {
-                if (it->second.asset)
-                    it->second.asset->destroy(m_device);
-
-                m_meshPathCache.erase(it->second.path);
-                it = m_meshes.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
+            // Freed ranges go back to the arena free lists for later uploads; blocks left empty give their memory back
+            DeletionQueue::Defer(m_device, [this, meshes]()
+                                 {
+                for (const auto &mesh : meshes)
+                    mesh->destroy();
+                m_geometry.releaseEmptyBlocks(); });
         }
 
         // 4) Destroy textures with refCount == 0
-        for (auto it = m_textures.begin(); it != m_textures.end();)
-        {
-            if (it->second.refCount == 0)
-            {
-                if (it->second.asset)
-                    it->second.asset->destroy(m_device);
-                it = m_textures.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
-        }
+        std::vector<std::shared_ptr<TextureAsset>> textures;
+        m_textures.forEach([&](uint64_t id, TextureEntry &e)
+                           {
+            if (e.refCount != 0)
+                return;
+            if (e.asset)
+                textures.push_back(std::move(e.asset));
+            m_textureByIndex[e.index] = 0;
+            m_freeTextureIndices.push_back(e.index);
+            ++m_bindlessVersion;
+            if (e.contentHash != 0)
+                m_textureByContent.erase(e.contentHash);
+            m_textures.erase(id); });
+
+        // Allocator blocks emptied by the frees go back to the driver
+        DeletionQueue::Defer(m_device, [device = m_device, textures]()
+                             {
+            for (const auto &tex : textures)
+                tex->destroy(device);
+            if (MemoryAllocator *allocator = MemoryAllocator::ForDevice(device))
+                allocator->trim(); });
     }
 
 } // namespace Engine
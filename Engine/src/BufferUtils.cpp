@@ -1,26 +1,11 @@
 #include "utils/BufferUtils.h"
 #include <cstring>
-#include <stdexcept>
 
 namespace Engine
 {
-    static uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-    {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(phys, &memProps);
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-        {
-            if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-            {
-                return i;
-            }
-        }
-        throw std::runtime_error("Failed to find suitable memory type");
-    }
-
     VkResult CreateOrUpdateVertexBuffer(
         VkDevice device,
-        VkPhysicalDevice physicalDevice,
+        VkPhysicalDevice /*physicalDevice*/,
         const void *vertexData,
         VkDeviceSize dataSize,
         VertexBufferHandle &handle)
@@ -39,8 +24,7 @@ namespace Engine
             {
                 vkDestroyBuffer(device, handle.buffer, nullptr);
                 handle.buffer = VK_NULL_HANDLE;
-                vkFreeMemory(device, handle.memory, nullptr);
-                handle.memory = VK_NULL_HANDLE;
+                FreeMemory(handle.memory);
                 needCreate = true;
             }
         }
@@ -59,27 +43,13 @@ namespace Engine
             if (r != VK_SUCCESS)
                 return r;
 
-            vkGetBufferMemoryRequirements(device, buffer, &req);
-
-            VkMemoryAllocateInfo ai{};
-            ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            ai.allocationSize = req.size;
-            ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits,
-                                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-            VkDeviceMemory mem = VK_NULL_HANDLE;
-            r = vkAllocateMemory(device, &ai, nullptr, &mem);
-            if (r != VK_SUCCESS)
-            {
-                vkDestroyBuffer(device, buffer, nullptr);
-                return r;
-            }
-
-            r = vkBindBufferMemory(device, buffer, mem, 0);
+            // Staging lifetime: linear pool, rewound once every staging buffer of a block is gone.
+            MemoryAllocation mem;
+            r = AllocateBufferMemory(device, buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                     mem, MemoryStrategy::Linear, MemoryCategory::Staging);
             if (r != VK_SUCCESS)
             {
                 vkDestroyBuffer(device, buffer, nullptr);
-                vkFreeMemory(device, mem, nullptr);
                 return r;
             }
 
@@ -87,12 +57,7 @@ namespace Engine
             handle.memory = mem;
         }
 
-        void *mapped = nullptr;
-        VkResult r = vkMapMemory(device, handle.memory, 0, dataSize, 0, &mapped);
-        if (r != VK_SUCCESS)
-            return r;
-        std::memcpy(mapped, vertexData, static_cast<size_t>(dataSize));
-        vkUnmapMemory(device, handle.memory);
+        std::memcpy(handle.memory.mapped, vertexData, static_cast<size_t>(dataSize));
 
         return VK_SUCCESS;
     }
@@ -104,17 +69,13 @@ namespace Engine
             vkDestroyBuffer(device, handle.buffer, nullptr);
             handle.buffer = VK_NULL_HANDLE;
         }
-        if (handle.memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, handle.memory, nullptr);
-            handle.memory = VK_NULL_HANDLE;
-        }
+        FreeMemory(handle.memory);
     }
 
     // Index buffer (host-visible, also a staging source)
     VkResult CreateOrUpdateIndexBuffer(
         VkDevice device,
-        VkPhysicalDevice physicalDevice,
+        VkPhysicalDevice /*physicalDevice*/,
         const void *indexData,
         VkDeviceSize dataSize,
         IndexBufferHandle &handle)
@@ -133,8 +94,7 @@ namespace Engine
             {
                 vkDestroyBuffer(device, handle.buffer, nullptr);
                 handle.buffer = VK_NULL_HANDLE;
-                vkFreeMemory(device, handle.memory, nullptr);
-                handle.memory = VK_NULL_HANDLE;
+                FreeMemory(handle.memory);
                 needCreate = true;
             }
         }
@@ -153,40 +113,21 @@ namespace Engine
             if (r != VK_SUCCESS)
                 return r;
 
-            vkGetBufferMemoryRequirements(device, buffer, &req);
-
-            VkMemoryAllocateInfo ai{};
-            ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            ai.allocationSize = req.size;
-            ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits,
-                                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-            VkDeviceMemory mem = VK_NULL_HANDLE;
-            r = vkAllocateMemory(device, &ai, nullptr, &mem);
+            // Staging lifetime: linear pool, rewound once every staging buffer of a block is gone.
+            MemoryAllocation mem;
+            r = AllocateBufferMemory(device, buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                     mem, MemoryStrategy::Linear, MemoryCategory::Staging);
             if (r != VK_SUCCESS)
             {
                 vkDestroyBuffer(device, buffer, nullptr);
                 return r;
             }
 
-            r = vkBindBufferMemory(device, buffer, mem, 0);
-            if (r != VK_SUCCESS)
-            {
-                vkDestroyBuffer(device, buffer, nullptr);
-                vkFreeMemory(device, mem, nullptr);
-                return r;
-            }
-
             handle.buffer = buffer;
             handle.memory = mem;
         }
 
-        void *mapped = nullptr;
-        VkResult r = vkMapMemory(device, handle.memory, 0, dataSize, 0, &mapped);
-        if (r != VK_SUCCESS)
-            return r;
-        std::memcpy(mapped, indexData, static_cast<size_t>(dataSize));
-        vkUnmapMemory(device, handle.memory);
+        std::memcpy(handle.memory.mapped, indexData, static_cast<size_t>(dataSize));
 
         return VK_SUCCESS;
     }
@@ -198,21 +139,18 @@ namespace Engine
             vkDestroyBuffer(device, handle.buffer, nullptr);
             handle.buffer = VK_NULL_HANDLE;
         }
-        if (handle.memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, handle.memory, nullptr);
-            handle.memory = VK_NULL_HANDLE;
-        }
+        FreeMemory(handle.memory);
     }
 
     // Device-local buffer creation (not mappable)
     VkResult CreateDeviceLocalBuffer(
         VkDevice device,
-        VkPhysicalDevice physicalDevice,
+        VkPhysicalDevice /*physicalDevice*/,
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkBuffer &outBuffer,
-        VkDeviceMemory &outMemory)
+        MemoryAllocation &outMemory,
+        MemoryCategory category)
     {
         VkBufferCreateInfo bi{};
         bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -225,44 +163,28 @@ namespace Engine
         if (r != VK_SUCCESS)
             return r;
 
-        VkMemoryRequirements req{};
-        vkGetBufferMemoryRequirements(device, buffer, &req);
-
-        VkMemoryAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        ai.allocationSize = req.size;
-        ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits,
-                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        VkDeviceMemory mem = VK_NULL_HANDLE;
-        r = vkAllocateMemory(device, &ai, nullptr, &mem);
+        MemoryAllocation mem;
+        r = AllocateBufferMemory(device, buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mem, MemoryStrategy::General, category);
         if (r != VK_SUCCESS)
         {
             vkDestroyBuffer(device, buffer, nullptr);
             return r;
         }
 
-        r = vkBindBufferMemory(device, buffer, mem, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyBuffer(device, buffer, nullptr);
-            vkFreeMemory(device, mem, nullptr);
-            return r;
-        }
-
         outBuffer = buffer;
         outMemory = mem;
         return VK_SUCCESS;
     }
 
-    // One-shot buffer copy (submit and wait idle)
+    // One-shot buffer copy (submit and wait for its fence)
     VkResult CopyBuffer(
         VkDevice device,
         VkCommandPool commandPool,
         VkQueue queue,
         VkBuffer src,
         VkBuffer dst,
-        VkDeviceSize size)
+        VkDeviceSize size,
+        VkDeviceSize dstOffset)
     {
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -287,7 +209,7 @@ namespace Engine
 
         VkBufferCopy copyRegion{};
         copyRegion.srcOffset = 0;
-        copyRegion.dstOffset = 0;
+        copyRegion.dstOffset = dstOffset;
         copyRegion.size = size;
         vkCmdCopyBuffer(cmd, src, dst, 1, &copyRegion);
 
@@ -298,15 +220,27 @@ namespace Engine
             return r;
         }
 
+        // Wait for this copy only: idling the queue would also wait for the frames in flight.
+        VkFence fence = VK_NULL_HANDLE;
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        r = vkCreateFence(device, &fenceInfo, nullptr, &fence);
+        if (r != VK_SUCCESS)
+        {
+            vkFreeCommandBuffers(device, commandPool, 1, &cmd);
+            return r;
+        }
+
         VkSubmitInfo submit{};
         submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submit.commandBufferCount = 1;
         submit.pCommandBuffers = &cmd;
-        r = vkQueueSubmit(queue, 1, &submit, VK_NULL_HANDLE);
+        r = vkQueueSubmit(queue, 1, &submit, fence);
         if (r == VK_SUCCESS)
         {
-            vkQueueWaitIdle(queue);
+            r = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
         }
+        vkDestroyFence(device, fence, nullptr);
 
         vkFreeCommandBuffers(device, commandPool, 1, &cmd);
         return r;
@@ -0,0 +1,607 @@
+#include "Engine/CrowdComputeModule.h"
+#include "Engine/Pipeline.h"
+#include "Engine/RenderStats.h"
+#include "Engine/VulkanContext.h"
+#include "utils/Log.h"
+#include "utils/PipelineCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace Engine
+{
+    static uint32_t nextPow2(uint32_t v)
+    {
+        uint32_t p = 1;
+        while (p < v)
+            p <<= 1;
+        return p;
+    }
+
+    // Bindings of crowd.comp, in order.
+    static constexpr uint32_t kBindingCount = 9;
+
+    // ---------------------------------------------------------------------------------------------
+    // Simulation-side API (any thread)
+    // ---------------------------------------------------------------------------------------------
+
+    void CrowdComputeModule::setCellSize(float cellSize)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cellSize = (cellSize > 1e-6f) ? cellSize : 1e-6f;
+    }
+
+    void CrowdComputeModule::setUnits(const CrowdUnitGpu *units, uint32_t count, uint32_t instanceCount, uint64_t layout)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.hasUnits = true;
+        m_pending.units.assign(units, units + count);
+        m_pending.instanceCount = instanceCount;
+        // Queued patches and readback requests index the previous layout.
+        m_pending.patches.clear();
+        m_pending.hasReadback = false;
+        m_pending.readbackUnits.clear();
+        m_pendingLayout = layout;
+        m_layoutInstances = instanceCount;
+    }
+
+    void CrowdComputeModule::patchUnits(const CrowdPatchGpu *patches, uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.patches.insert(m_pending.patches.end(), patches, patches + count);
+    }
+
+    void CrowdComputeModule::step(float dt)
+    {
+        if (dt <= 0.0f)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.steps.push_back(dt);
+    }
+
+    void CrowdComputeModule::requestReadback(const uint32_t *units, uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.hasReadback = true;
+        m_pending.readbackUnits.assign(units, units + count);
+    }
+
+    bool CrowdComputeModule::takeReadback(std::vector<uint32_t> &units, std::vector<CrowdUnitGpu> &states, uint64_t &layout)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_readyReadback)
+            return false;
+        units.swap(m_readyUnits);
+        states.swap(m_readyStates);
+        layout = m_readyLayout;
+        m_readyReadback = false;
+        return true;
+    }
+
+    void CrowdComputeModule::setInterpolation(float alpha)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_alpha = std::clamp(alpha, 0.0f, 1.0f);
+    }
+
+    uint64_t CrowdComputeModule::layoutSerial() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pendingLayout;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // Render-thread side
+    // ---------------------------------------------------------------------------------------------
+
+    void CrowdComputeModule::onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs)
+    {
+        (void)pass;
+        (void)fbs;
+        m_device = ctx.GetDevice();
+        m_physicalDevice = ctx.GetPhysicalDevice();
+
+        try
+        {
+            m_available = createPipelines(ctx) && ensureDeviceBuffers(1024, kMinBuckets, 256);
+        }
+        catch (const std::exception &e)
+        {
+            ENGINE_LOG_WARN("[CrowdCompute] Disabled: %s", e.what());
+            m_available = false;
+        }
+        if (!m_available)
+            return;
+
+        // Something valid to bind before the first setUnits().
+        if (!createBuffer(m_instances, 1024 * 64, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, false))
+        {
+            m_available = false;
+            return;
+        }
+        m_instanceCapacity = 1024;
+        updateDescriptorSet();
+    }
+
+    bool CrowdComputeModule::createPipelines(VulkanContext &ctx)
+    {
+        (void)ctx;
+
+        VkDescriptorSetLayoutBinding bindings[kBindingCount]{};
+        for (uint32_t b = 0; b < kBindingCount; ++b)
+        {
+            bindings[b].binding = b;
+            bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[b].descriptorCount = 1;
+            bindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = kBindingCount;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_setLayout) != VK_SUCCESS)
+            return false;
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = kBindingCount;
+
+        VkDescriptorPoolCreateInfo pci{};
+        pci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pci.maxSets = 1;
+        pci.poolSizeCount = 1;
+        pci.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(m_device, &pci, nullptr, &m_pool) != VK_SUCCESS)
+            return false;
+
+        VkDescriptorSetAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = m_pool;
+        alloc.descriptorSetCount = 1;
+        alloc.pSetLayouts = &m_setLayout;
+        if (vkAllocateDescriptorSets(m_device, &alloc, &m_set) != VK_SUCCESS)
+            return false;
+
+        VkPushConstantRange range{};
+        range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        range.offset = 0;
+        range.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo plci{};
+        plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plci.setLayoutCount = 1;
+        plci.pSetLayouts = &m_setLayout;
+        plci.pushConstantRangeCount = 1;
+        plci.pPushConstantRanges = &range;
+        if (vkCreatePipelineLayout(m_device, &plci, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+            return false;
+
+        // One pipeline per pass: same module, kPass specialization constant.
+        VkShaderModule module = Pipeline::createShaderModuleFromFile(m_device, "shaders/crowd.comp.spv");
+
+        uint32_t passIds[PassCountTotal];
+        VkSpecializationMapEntry entry{0, 0, sizeof(uint32_t)};
+        VkSpecializationInfo specs[PassCountTotal]{};
+        VkComputePipelineCreateInfo infos[PassCountTotal]{};
+        for (uint32_t p = 0; p < PassCountTotal; ++p)
+        {
+            passIds[p] = p;
+            specs[p].mapEntryCount = 1;
+            specs[p].pMapEntries = &entry;
+            specs[p].dataSize = sizeof(uint32_t);
+            specs[p].pData = &passIds[p];
+
+            infos[p].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            infos[p].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            infos[p].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            infos[p].stage.module = module;
+            infos[p].stage.pName = "main";
+            infos[p].stage.pSpecializationInfo = &specs[p];
+            infos[p].layout = m_pipelineLayout;
+        }
+
+        const VkResult res = vkCreateComputePipelines(m_device, PipelineCache::HandleFor(m_device), PassCountTotal, infos, nullptr, m_pipelines);
+        vkDestroyShaderModule(m_device, module, nullptr);
+        return res == VK_SUCCESS;
+    }
+
+    bool CrowdComputeModule::createBuffer(Buffer &out, VkDeviceSize size, VkBufferUsageFlags usage, bool hostVisible)
+    {
+        destroyBuffer(out);
+
+        VkBufferCreateInfo binfo{};
+        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        binfo.size = size;
+        binfo.usage = usage;
+        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(m_device, &binfo, nullptr, &out.buffer) != VK_SUCCESS)
+            return false;
+
+        const VkMemoryPropertyFlags props = hostVisible
+                                                ? (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+                                                : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        const MemoryCategory category = hostVisible ? MemoryCategory::Dynamic : MemoryCategory::Other;
+        if (AllocateBufferMemory(m_device, out.buffer, props, out.memory, MemoryStrategy::General, category) != VK_SUCCESS)
+            return false;
+        out.mapped = out.memory.mapped;
+
+        out.size = size;
+        return true;
+    }
+
+    void CrowdComputeModule::destroyBuffer(Buffer &b)
+    {
+        if (b.buffer != VK_NULL_HANDLE)
+            vkDestroyBuffer(m_device, b.buffer, nullptr);
+        FreeMemory(b.memory);
+        b = Buffer{};
+    }
+
+    bool CrowdComputeModule::ensureDeviceBuffers(uint32_t units, uint32_t buckets, uint32_t patches)
+    {
+        const bool growUnits = units > m_unitCapacity;
+        const bool growBuckets = buckets > m_bucketCapacity;
+        const bool growPatches = patches > m_patchCapacity;
+        if (!growUnits && !growBuckets && !growPatches)
+            return true;
+
+        // The other in-flight frame may still read the old buffers.
+        vkDeviceWaitIdle(m_device);
+
+        constexpr VkBufferUsageFlags kStorage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        if (growUnits)
+        {
+            const uint32_t cap = nextPow2(units);
+            if (!createBuffer(m_units, VkDeviceSize(cap) * sizeof(CrowdUnitGpu), kStorage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, false) ||
+                !createBuffer(m_prev, VkDeviceSize(cap) * 16, kStorage, false) ||
+                !createBuffer(m_unitBucket, VkDeviceSize(cap) * 8, kStorage, false) ||
+                !createBuffer(m_entries, VkDeviceSize(cap) * 32, kStorage, false))
+                return false;
+            m_unitCapacity = cap;
+        }
+        if (growBuckets)
+        {
+            if (!createBuffer(m_bucketCount, VkDeviceSize(buckets) * 4, kStorage, false) ||
+                !createBuffer(m_bucketStart, VkDeviceSize(buckets) * 4, kStorage, false) ||
+                (m_blockSums.buffer == VK_NULL_HANDLE && !createBuffer(m_blockSums, VkDeviceSize(kScanBlock) * 4, kStorage, false)))
+                return false;
+            m_bucketCapacity = buckets;
+        }
+        if (growPatches)
+        {
+            const uint32_t cap = nextPow2(patches);
+            if (!createBuffer(m_patches, VkDeviceSize(cap) * sizeof(CrowdPatchGpu), kStorage, false))
+                return false;
+            m_patchCapacity = cap;
+        }
+        if (m_instances.buffer != VK_NULL_HANDLE)
+            updateDescriptorSet();
+        return true;
+    }
+
+    bool CrowdComputeModule::ensureHostBuffer(Buffer &b, VkDeviceSize size, VkBufferUsageFlags usage)
+    {
+        if (size <= b.size && b.buffer != VK_NULL_HANDLE)
+            return true;
+        VkDeviceSize cap = std::max<VkDeviceSize>(b.size, 4096);
+        while (cap < size)
+            cap *= 2;
+        return createBuffer(b, cap, usage, true);
+    }
+
+    void CrowdComputeModule::updateDescriptorSet()
+    {
+        const Buffer *buffers[kBindingCount] = {&m_units, &m_prev, &m_bucketCount, &m_bucketStart, &m_blockSums,
+                                                &m_unitBucket, &m_entries, &m_patches, &m_instances};
+        VkDescriptorBufferInfo infos[kBindingCount]{};
+        VkWriteDescriptorSet writes[kBindingCount]{};
+        for (uint32_t b = 0; b < kBindingCount; ++b)
+        {
+            infos[b].buffer = buffers[b]->buffer;
+            infos[b].offset = 0;
+            infos[b].range = VK_WHOLE_SIZE;
+
+            writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[b].dstSet = m_set;
+            writes[b].dstBinding = b;
+            writes[b].descriptorCount = 1;
+            writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[b].pBufferInfo = &infos[b];
+        }
+        vkUpdateDescriptorSets(m_device, kBindingCount, writes, 0, nullptr);
+    }
+
+    void CrowdComputeModule::prepareFrame()
+    {
+        if (!m_available)
+            return;
+        uint32_t needed = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            needed = m_layoutInstances;
+        }
+        if (needed <= m_instanceCapacity)
+            return;
+
+        vkDeviceWaitIdle(m_device);
+        const uint32_t cap = nextPow2(needed);
+        if (!createBuffer(m_instances, VkDeviceSize(cap) * 64, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, false))
+        {
+            ENGINE_LOG_ERROR("[CrowdCompute] Failed to allocate %u instance matrices", cap);
+            m_available = false;
+            return;
+        }
+        m_instanceCapacity = cap;
+        updateDescriptorSet();
+    }
+
+    void CrowdComputeModule::computeBarrier(VkCommandBuffer cmd, VkPipelineStageFlags src, VkAccessFlags srcAccess,
+                                            VkPipelineStageFlags dst, VkAccessFlags dstAccess)
+    {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(cmd, src, dst, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void CrowdComputeModule::dispatch(VkCommandBuffer cmd, Pass pass, uint32_t invocations)
+    {
+        if (invocations == 0)
+            return;
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[pass]);
+        vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_pc);
+        vkCmdDispatch(cmd, (invocations + kGroupSize - 1) / kGroupSize, 1, 1);
+
+        constexpr VkAccessFlags kRW = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, kRW);
+    }
+
+    void CrowdComputeModule::recordStep(VkCommandBuffer cmd, float dt)
+    {
+        m_pc.dt = dt;
+
+        // Counting sort into buckets: count, prefix-sum (per block, block sums, add), scatter.
+        computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdFillBuffer(cmd, m_bucketCount.buffer, 0, VkDeviceSize(m_pc.bucketCount) * 4, 0);
+        computeBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        dispatch(cmd, PassCount, m_pc.unitCount);
+        dispatch(cmd, PassScanBlocks, m_pc.blockCount * kGroupSize);
+        dispatch(cmd, PassScanSums, kGroupSize);
+        dispatch(cmd, PassScanAdd, m_pc.bucketCount);
+        dispatch(cmd, PassScatter, m_pc.unitCount);
+
+        // Avoidance + integration; neighbors come from the packed entries, so units only write themselves.
+        dispatch(cmd, PassSimulate, m_pc.unitCount);
+    }
+
+    void CrowdComputeModule::recordCompute(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (!m_available)
+            return;
+
+        // One slot per frame in flight, indexed like the Renderer's FrameContexts.
+        if (frameCtx.frameIndex >= m_slots.size())
+            m_slots.resize(frameCtx.frameIndex + 1);
+        FrameSlot &slot = m_slots[frameCtx.frameIndex];
+
+        // The Renderer waited on this slot's fence: its last readback has landed.
+        if (slot.readbackPending)
+        {
+            const auto *src = static_cast<const CrowdUnitGpu *>(slot.readback.mapped);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_readyUnits = slot.readbackUnits;
+            m_readyStates.assign(src, src + slot.readbackUnits.size());
+            m_readyLayout = slot.readbackLayout;
+            m_readyReadback = true;
+            slot.readbackPending = false;
+        }
+
+        Pending work;
+        float cellSize = 2.0f;
+        float alpha = 1.0f;
+        uint64_t layout = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(work, m_pending);
+            cellSize = m_cellSize;
+            alpha = m_alpha;
+            layout = m_pendingLayout;
+        }
+
+        if (work.hasUnits)
+        {
+            m_unitCount = static_cast<uint32_t>(work.units.size());
+            m_gpuLayout = layout;
+        }
+        if (m_unitCount == 0)
+            return;
+
+        const uint32_t buckets = std::clamp(nextPow2(2 * m_unitCount), kMinBuckets, kMaxBuckets);
+        const uint32_t patchCount = static_cast<uint32_t>(work.patches.size());
+        if (!ensureDeviceBuffers(m_unitCount, buckets, patchCount))
+        {
+            ENGINE_LOG_ERROR("[CrowdCompute] Failed to allocate buffers for %u units", m_unitCount);
+            m_available = false;
+            return;
+        }
+
+        // Stage uploads: [units | prev (pos, yaw) | patches].
+        const VkDeviceSize unitBytes = work.hasUnits ? VkDeviceSize(m_unitCount) * sizeof(CrowdUnitGpu) : 0;
+        const VkDeviceSize prevBytes = work.hasUnits ? VkDeviceSize(m_unitCount) * 16 : 0;
+        const VkDeviceSize patchBytes = VkDeviceSize(patchCount) * sizeof(CrowdPatchGpu);
+        const VkDeviceSize stagingBytes = unitBytes + prevBytes + patchBytes;
+        if (stagingBytes > 0 && !ensureHostBuffer(slot.staging, stagingBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT))
+            return;
+
+        // Previous frame's compute vs. this frame's uploads; the instance buffer's readers are ordered
+        // by the render graph (declareCompute()).
+        computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+        if (stagingBytes > 0)
+        {
+            auto *dst = static_cast<uint8_t *>(slot.staging.mapped);
+            VkBufferCopy region{};
+            if (work.hasUnits)
+            {
+                std::memcpy(dst, work.units.data(), unitBytes);
+                float *prev = reinterpret_cast<float *>(dst + unitBytes);
+                for (const CrowdUnitGpu &u : work.units)
+                {
+                    *prev++ = u.posX;
+                    *prev++ = u.posY;
+                    *prev++ = u.posZ;
+                    *prev++ = u.yaw;
+                }
+                region = VkBufferCopy{0, 0, unitBytes};
+                vkCmdCopyBuffer(cmd, slot.staging.buffer, m_units.buffer, 1, &region);
+                region = VkBufferCopy{unitBytes, 0, prevBytes};
+                vkCmdCopyBuffer(cmd, slot.staging.buffer, m_prev.buffer, 1, &region);
+            }
+            if (patchBytes > 0)
+            {
+                std::memcpy(dst + unitBytes + prevBytes, work.patches.data(), patchBytes);
+                region = VkBufferCopy{unitBytes + prevBytes, 0, patchBytes};
+                vkCmdCopyBuffer(cmd, slot.staging.buffer, m_patches.buffer, 1, &region);
+            }
+            computeBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+            RenderCounters stats;
+            stats.uploadBytes = stagingBytes;
+            RenderStats::addPass(name(), stats);
+        }
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_set, 0, nullptr);
+
+        m_pc.unitCount = m_unitCount;
+        m_pc.patchCount = patchCount;
+        m_pc.bucketCount = buckets;
+        m_pc.blockCount = buckets / kScanBlock;
+        m_pc.cellSize = cellSize;
+        m_pc.alpha = alpha;
+        m_pc.instanceCapacity = m_instanceCapacity;
+
+        dispatch(cmd, PassPatch, patchCount);
+
+        // A slow frame can collect several ticks; run a few, fold the rest into the last one.
+        if (work.steps.size() > kMaxStepsPerFrame)
+        {
+            float folded = 0.0f;
+            for (size_t s = kMaxStepsPerFrame - 1; s < work.steps.size(); ++s)
+                folded += work.steps[s];
+            work.steps.resize(kMaxStepsPerFrame);
+            work.steps.back() = folded;
+        }
+        for (float dt : work.steps)
+            recordStep(cmd, dt);
+
+        // Readback of the requested units, right after the step they asked for.
+        if (work.hasReadback)
+        {
+            if (work.steps.empty())
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_pending.hasReadback && !m_pending.hasUnits)
+                {
+                    m_pending.hasReadback = true;
+                    m_pending.readbackUnits.swap(work.readbackUnits);
+                }
+            }
+            else
+            {
+                slot.readbackUnits.clear();
+                for (uint32_t u : work.readbackUnits)
+                    if (u < m_unitCount)
+                        slot.readbackUnits.push_back(u);
+
+                const VkDeviceSize bytes = VkDeviceSize(slot.readbackUnits.size()) * sizeof(CrowdUnitGpu);
+                if (bytes > 0 && ensureHostBuffer(slot.readback, bytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+                {
+                    std::vector<VkBufferCopy> regions(slot.readbackUnits.size());
+                    for (size_t k = 0; k < regions.size(); ++k)
+                        regions[k] = VkBufferCopy{VkDeviceSize(slot.readbackUnits[k]) * sizeof(CrowdUnitGpu),
+                                                  VkDeviceSize(k) * sizeof(CrowdUnitGpu), sizeof(CrowdUnitGpu)};
+
+                    computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+                    vkCmdCopyBuffer(cmd, m_units.buffer, slot.readback.buffer, static_cast<uint32_t>(regions.size()), regions.data());
+                    computeBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+                    slot.readbackLayout = m_gpuLayout;
+                    slot.readbackPending = true;
+                }
+            }
+        }
+
+        // Instance matrices for this frame's draws.
+        dispatch(cmd, PassInstances, m_unitCount);
+    }
+
+    void CrowdComputeModule::declareCompute(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx)
+    {
+        (void)frameCtx;
+        if (m_available && m_instances.buffer != VK_NULL_HANDLE)
+            pass.write(graph.importBuffer("crowd instances", m_instances.buffer), RenderGraph::Access::ComputeWrite);
+    }
+
+    void CrowdComputeModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        // Nothing to draw: SModelRenderPassModule reads instanceBuffer().
+        (void)frameCtx;
+        (void)cmd;
+    }
+
+    void CrowdComputeModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
+    {
+        (void)ctx;
+        (void)newExtent;
+    }
+
+    void CrowdComputeModule::onDestroy(VulkanContext &ctx)
+    {
+        (void)ctx;
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        for (FrameSlot &slot : m_slots)
+        {
+            destroyBuffer(slot.staging);
+            destroyBuffer(slot.readback);
+        }
+        m_slots.clear();
+
+        for (Buffer *b : {&m_units, &m_prev, &m_bucketCount, &m_bucketStart, &m_blockSums, &m_unitBucket, &m_entries, &m_patches, &m_instances})
+            destroyBuffer(*b);
+        m_unitCapacity = m_bucketCapacity = m_patchCapacity = m_instanceCapacity = 0;
+
+        for (VkPipeline &p : m_pipelines)
+        {
+            if (p != VK_NULL_HANDLE)
+                vkDestroyPipeline(m_device, p, nullptr);
+            p = VK_NULL_HANDLE;
+        }
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        if (m_pool != VK_NULL_HANDLE)
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        if (m_setLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+        m_pool = VK_NULL_HANDLE;
+        m_setLayout = VK_NULL_HANDLE;
+        m_set = VK_NULL_HANDLE;
+        m_available = false;
+        m_device = VK_NULL_HANDLE;
+    }
+
+} // namespace Engine
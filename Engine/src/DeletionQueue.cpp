@@ -0,0 +1,114 @@
+#include "utils/DeletionQueue.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::pair<VkDevice, DeletionQueue *>> entries;
+        };
+
+        Registry &registry()
+        {
+            static Registry r;
+            return r;
+        }
+    } // namespace
+
+    DeletionQueue::DeletionQueue(VkDevice device)
+        : m_device(device)
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.entries.emplace_back(device, this);
+    }
+
+    DeletionQueue::~DeletionQueue()
+    {
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.entries.erase(std::remove_if(r.entries.begin(), r.entries.end(),
+                                           [this](const std::pair<VkDevice, DeletionQueue *> &e)
+                                           { return e.second == this; }),
+                            r.entries.end());
+        }
+        while (getPendingCount() > 0)
+            runUntil_Internal(UINT64_MAX);
+    }
+
+    void DeletionQueue::push(std::function<void()> destroy)
+    {
+        if (!destroy)
+            return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.push_back({m_frame, std::move(destroy)});
+    }
+
+    uint64_t DeletionQueue::endFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frame++;
+    }
+
+    void DeletionQueue::collect(uint64_t serial)
+    {
+        runUntil_Internal(serial);
+    }
+
+    void DeletionQueue::flush()
+    {
+        vkDeviceWaitIdle(m_device);
+        while (getPendingCount() > 0)
+            runUntil_Internal(UINT64_MAX);
+    }
+
+    size_t DeletionQueue::getPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    void DeletionQueue::runUntil_Internal(uint64_t serial)
+    {
+        // Items run outside the lock, so they may queue more
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (!m_items.empty() && m_items.front().frame <= serial)
+            {
+                ready.push_back(std::move(m_items.front().destroy));
+                m_items.pop_front();
+            }
+        }
+        for (auto &destroy : ready)
+            destroy();
+    }
+
+    DeletionQueue *DeletionQueue::ForDevice(VkDevice device)
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto &e : r.entries)
+        {
+            if (e.first == device)
+                return e.second;
+        }
+        return nullptr;
+    }
+
+    void DeletionQueue::Defer(VkDevice device, std::function<void()> destroy)
+    {
+        if (DeletionQueue *queue = ForDevice(device))
+            queue->push(std::move(destroy));
+        else if (destroy)
+            destroy();
+    }
+
+} // namespace Engine
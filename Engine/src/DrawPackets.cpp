@@ -0,0 +1,156 @@
+#include "Engine/DrawPackets.h"
+
+#include <cstring>
+#include <utility>
+
+namespace Engine
+{
+    void DrawPackets::sort(std::vector<DrawPacket> &packets, std::vector<DrawPacket> &scratch)
+    {
+        const size_t n = packets.size();
+        if (n < 2)
+            return;
+
+        // All eight digit histograms in one pass over the keys.
+        uint32_t counts[8][256] = {};
+        for (const DrawPacket &p : packets)
+        {
+            for (uint32_t d = 0; d < 8; ++d)
+                ++counts[d][(p.key >> (d * 8)) & 0xffu];
+        }
+
+        scratch.resize(n);
+        DrawPacket *src = packets.data();
+        DrawPacket *dst = scratch.data();
+        for (uint32_t d = 0; d < 8; ++d)
+        {
+            uint32_t *count = counts[d];
+            // Every key has the same digit: this pass would not move anything.
+            if (count[(src[0].key >> (d * 8)) & 0xffu] == n)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t b = 0; b < 256; ++b)
+            {
+                const uint32_t c = count[b];
+                count[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i)
+                dst[count[(src[i].key >> (d * 8)) & 0xffu]++] = src[i];
+            std::swap(src, dst);
+        }
+
+        if (src != packets.data())
+            std::memcpy(packets.data(), src, n * sizeof(DrawPacket));
+    }
+
+    void DrawStateCache::reset()
+    {
+        m_pipeline = VK_NULL_HANDLE;
+        m_setLayout = VK_NULL_HANDLE;
+        for (VkDescriptorSet &s : m_sets)
+            s = VK_NULL_HANDLE;
+        for (BufferBinding &b : m_vertex)
+            b = BufferBinding{};
+        m_index = BufferBinding{};
+        m_pushLayout = VK_NULL_HANDLE;
+        m_pushSize = 0;
+    }
+
+    void DrawStateCache::bindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+    {
+        if (pipeline == m_pipeline)
+        {
+            ++m_skipped;
+            return;
+        }
+        vkCmdBindPipeline(m_cmd, bindPoint, pipeline);
+        m_pipeline = pipeline;
+        ++m_pipelineBinds;
+        ++m_issued;
+    }
+
+    void DrawStateCache::bindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex, VkDescriptorSet set,
+                                           uint32_t dynamicOffsetCount, const uint32_t *dynamicOffsets)
+    {
+        if (layout != m_setLayout)
+        {
+            for (VkDescriptorSet &s : m_sets)
+                s = VK_NULL_HANDLE;
+            m_setLayout = layout;
+        }
+        const bool cacheable = setIndex < kMaxSets && dynamicOffsetCount <= kMaxDynamicOffsets;
+        if (cacheable && m_sets[setIndex] == set && m_dynamicOffsetCounts[setIndex] == dynamicOffsetCount &&
+            (dynamicOffsetCount == 0 || std::memcmp(m_dynamicOffsets[setIndex], dynamicOffsets, dynamicOffsetCount * sizeof(uint32_t)) == 0))
+        {
+            ++m_skipped;
+            return;
+        }
+        vkCmdBindDescriptorSets(m_cmd, bindPoint, layout, setIndex, 1, &set, dynamicOffsetCount, dynamicOffsets);
+        if (cacheable)
+        {
+            m_sets[setIndex] = set;
+            m_dynamicOffsetCounts[setIndex] = dynamicOffsetCount;
+            if (dynamicOffsetCount > 0)
+                std::memcpy(m_dynamicOffsets[setIndex], dynamicOffsets, dynamicOffsetCount * sizeof(uint32_t));
+        }
+        else if (setIndex < kMaxSets)
+        {
+            m_sets[setIndex] = VK_NULL_HANDLE;
+        }
+        ++m_descriptorBinds;
+        ++m_issued;
+    }
+
+    void DrawStateCache::bindVertexBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset)
+    {
+        if (binding < kMaxVertexBindings && m_vertex[binding].buffer == buffer && m_vertex[binding].offset == offset)
+        {
+            ++m_skipped;
+            return;
+        }
+        vkCmdBindVertexBuffers(m_cmd, binding, 1, &buffer, &offset);
+        if (binding < kMaxVertexBindings)
+            m_vertex[binding] = BufferBinding{buffer, offset};
+        ++m_bufferBinds;
+        ++m_issued;
+    }
+
+    void DrawStateCache::bindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type)
+    {
+        if (m_index.buffer == buffer && m_index.offset == offset && m_indexType == type)
+        {
+            ++m_skipped;
+            return;
+        }
+        vkCmdBindIndexBuffer(m_cmd, buffer, offset, type);
+        m_index = BufferBinding{buffer, offset};
+        m_indexType = type;
+        ++m_bufferBinds;
+        ++m_issued;
+    }
+
+    void DrawStateCache::pushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t size, const void *data)
+    {
+        if (layout == m_pushLayout && stages == m_pushStages && size == m_pushSize && std::memcmp(m_push, data, size) == 0)
+        {
+            ++m_skipped;
+            return;
+        }
+        vkCmdPushConstants(m_cmd, layout, stages, 0, size, data);
+        if (size <= kMaxPushConstantBytes)
+        {
+            std::memcpy(m_push, data, size);
+            m_pushLayout = layout;
+            m_pushStages = stages;
+            m_pushSize = size;
+        }
+        else
+        {
+            m_pushLayout = VK_NULL_HANDLE;
+        }
+        ++m_issued;
+    }
+
+} // namespace Engine
@@ -0,0 +1,119 @@
+#include "utils/FrameArena.h"
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    void LinearArena::reset()
+    {
+        m_peak = std::max(m_peak, m_used);
+        m_used = 0;
+        if (m_blocks.size() > 1)
+        {
+            // The frame needed several blocks: next time it fits in one.
+            Block merged;
+            merged.size = m_capacity;
+            merged.memory.reset(new std::byte[merged.size]);
+            m_blocks.clear();
+            m_blocks.push_back(std::move(merged));
+        }
+        if (m_blocks.empty())
+        {
+            m_cursor = 0;
+            m_end = 0;
+            return;
+        }
+        startBlock(0);
+    }
+
+    void *LinearArena::allocateSlow(size_t bytes, size_t alignment)
+    {
+        // Later blocks kept from before the last reset, then a new one
+        for (size_t next = (m_cursor != 0) ? m_current + 1 : 0; next < m_blocks.size(); ++next)
+        {
+            startBlock(next);
+            const uintptr_t aligned = (m_cursor + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+            if (aligned + bytes <= m_end)
+            {
+                m_cursor = aligned + bytes;
+                m_used += bytes;
+                return reinterpret_cast<void *>(aligned);
+            }
+        }
+
+        Block block;
+        block.size = std::max(m_blockSize, bytes + alignment);
+        block.memory.reset(new std::byte[block.size]);
+        m_capacity += block.size;
+        m_blocks.push_back(std::move(block));
+        startBlock(m_blocks.size() - 1);
+
+        const uintptr_t aligned = (m_cursor + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+        m_cursor = aligned + bytes;
+        m_used += bytes;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    void LinearArena::startBlock(size_t index)
+    {
+        m_current = index;
+        m_cursor = reinterpret_cast<uintptr_t>(m_blocks[index].memory.get());
+        m_end = m_cursor + m_blocks[index].size;
+    }
+
+    FrameArena::FrameArena(uint32_t framesInFlight, size_t blockSize)
+        : m_frames(std::max(1u, framesInFlight)), m_blockSize(blockSize)
+    {
+        resize(1);
+    }
+
+    void FrameArena::resize(uint32_t threadCount)
+    {
+        threadCount = std::max(1u, threadCount);
+        if (threadCount == m_threads)
+            return;
+
+        std::vector<LinearArena> arenas;
+        arenas.reserve(static_cast<size_t>(m_frames) * threadCount);
+        for (uint32_t s = 0; s < m_frames; ++s)
+            for (uint32_t t = 0; t < threadCount; ++t)
+            {
+                if (t < m_threads)
+                    arenas.push_back(std::move(m_arenas[static_cast<size_t>(s) * m_threads + t]));
+                else
+                    arenas.emplace_back(m_blockSize);
+            }
+        m_arenas.swap(arenas);
+        m_threads = threadCount;
+    }
+
+    void FrameArena::beginFrame()
+    {
+        m_slot = (m_slot + 1) % m_frames;
+        for (uint32_t t = 0; t < m_threads; ++t)
+            m_arenas[static_cast<size_t>(m_slot) * m_threads + t].reset();
+    }
+
+    LinearArena &FrameArena::local()
+    {
+        return m_arenas[static_cast<size_t>(m_slot) * m_threads + JobSystem::currentThreadIndex()];
+    }
+
+    size_t FrameArena::used() const
+    {
+        size_t total = 0;
+        for (uint32_t t = 0; t < m_threads; ++t)
+            total += m_arenas[static_cast<size_t>(m_slot) * m_threads + t].used();
+        return total;
+    }
+
+    size_t FrameArena::capacity() const
+    {
+        size_t total = 0;
+        for (const LinearArena &a : m_arenas)
+            total += a.capacity();
+        return total;
+    }
+
+} // namespace Engine
@@ -1,6 +1,6 @@
 #include "Engine/Window.h"
+#include "utils/Log.h"
 #include <GLFW/glfw3.h>
-#include <iostream>
 #include <sstream>
 #include <stdexcept>
 
@@ -21,7 +21,7 @@ namespace Engine
         GLFWWindow(const WindowProps &props)
         {
             glfwSetErrorCallback([](int code, const char *desc)
-                                 { fprintf(stderr, "[GLFW ERROR %d] %s\n", code, desc); });
+                                 { ENGINE_LOG_ERROR("[GLFW ERROR %d] %s", code, desc); });
             if (!glfwInit())
                 throw std::runtime_error("GLFW init failed");
             glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API); // Vulkan
@@ -64,6 +64,10 @@ namespace Engine
                     if (key == GLFW_KEY_DOWN)  d->EventCallback("DownPressed");
                     if (key == GLFW_KEY_ESCAPE) d->EventCallback("EscapePressed");
                     if (key == GLFW_KEY_F1) d->EventCallback("F1Pressed");
+                    if (key == GLFW_KEY_F2) d->EventCallback("F2Pressed");
+                    if (key == GLFW_KEY_F3) d->EventCallback("F3Pressed");
+                    if (key == GLFW_KEY_F4) d->EventCallback("F4Pressed");
+                    if (key == GLFW_KEY_F5) d->EventCallback("F5Pressed");
                 } });
 
             glfwSetCursorPosCallback(data->Window, [](GLFWwindow *wnd, double x, double y)
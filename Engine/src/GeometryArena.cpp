@@ -0,0 +1,211 @@
+#include "assets/GeometryArena.h"
+#include "utils/BufferUtils.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+    {
+        return alignment > 1 ? ((v + alignment - 1) / alignment) * alignment : v;
+    }
+
+    void GeometryArena::init(VkDevice device, VkPhysicalDevice phys)
+    {
+        m_device = device;
+        m_phys = phys;
+    }
+
+    void GeometryArena::destroy()
+    {
+        for (uint32_t k = 0; k < KindCount; ++k)
+        {
+            for (Block &b : m_blocks[k])
+            {
+                if (b.buffer != VK_NULL_HANDLE)
+                    vkDestroyBuffer(m_device, b.buffer, nullptr);
+                FreeMemory(b.memory);
+            }
+            m_blocks[k].clear();
+            m_used[k] = 0;
+        }
+    }
+
+    bool GeometryArena::createBlock(Kind kind, VkDeviceSize size, Block &out)
+    {
+        // Vertex blocks are also storage buffers: the meshlet mesh shader pulls vertices from them.
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        if (kind == Vertex)
+            usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        else if (kind == Index)
+            usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        else
+            usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        MemoryAllocation memory;
+        if (CreateDeviceLocalBuffer(m_device, m_phys, size, usage, buffer, memory, MemoryCategory::Geometry) != VK_SUCCESS)
+            return false;
+
+        out.buffer = buffer;
+        out.memory = memory;
+        out.size = size;
+        out.free.assign(1, Span{0, size});
+        return true;
+    }
+
+    bool GeometryArena::allocateFromBlock(Block &block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &outOffset)
+    {
+        for (size_t i = 0; i < block.free.size(); ++i)
+        {
+            Span &s = block.free[i];
+            const VkDeviceSize start = alignUp(s.offset, alignment);
+            const VkDeviceSize end = s.offset + s.size;
+            if (start + size > end)
+                continue;
+
+            // Split: the alignment gap stays in front, the tail stays behind.
+            const Span head{s.offset, start - s.offset};
+            const Span tail{start + size, end - (start + size)};
+            if (head.size > 0 && tail.size > 0)
+            {
+                s = head;
+                block.free.insert(block.free.begin() + static_cast<std::ptrdiff_t>(i) + 1, tail);
+            }
+            else if (head.size > 0)
+                s = head;
+            else if (tail.size > 0)
+                s = tail;
+            else
+                block.free.erase(block.free.begin() + static_cast<std::ptrdiff_t>(i));
+
+            outOffset = start;
+            return true;
+        }
+        return false;
+    }
+
+    GeometryArena::Range GeometryArena::allocate(Kind kind, VkDeviceSize size, VkDeviceSize alignment)
+    {
+        Range r{};
+        if (size == 0 || m_device == VK_NULL_HANDLE)
+            return r;
+
+        std::vector<Block> &blocks = m_blocks[kind];
+        for (uint32_t b = 0; b < static_cast<uint32_t>(blocks.size()); ++b)
+        {
+            if (blocks[b].buffer != VK_NULL_HANDLE && allocateFromBlock(blocks[b], size, alignment, r.offset))
+            {
+                r.block = b;
+                r.size = size;
+                m_used[kind] += size;
+                return r;
+            }
+        }
+
+        // Nothing fits: new block (a released slot if there is one), oversized meshes get their own.
+        const VkDeviceSize blockBytes = std::max(kind == Vertex ? kVertexBlockBytes : (kind == Index ? kIndexBlockBytes : kMeshletBlockBytes), size);
+        Block block;
+        if (!createBlock(kind, blockBytes, block))
+        {
+            ENGINE_LOG_ERROR("[GeometryArena] Failed to create a %llu byte %s block",
+                             static_cast<unsigned long long>(blockBytes), kind == Vertex ? "vertex" : (kind == Index ? "index" : "meshlet"));
+            return r;
+        }
+
+        uint32_t slot = 0;
+        while (slot < blocks.size() && blocks[slot].buffer != VK_NULL_HANDLE)
+            ++slot;
+        if (slot == blocks.size())
+            blocks.push_back(std::move(block));
+        else
+            blocks[slot] = std::move(block);
+
+        allocateFromBlock(blocks[slot], size, alignment, r.offset); // offset 0 of a fresh block
+        r.block = slot;
+        r.size = size;
+        m_used[kind] += size;
+        return r;
+    }
+
+    void GeometryArena::free(Kind kind, Range &range)
+    {
+        if (!range.isValid())
+            return;
+        std::vector<Block> &blocks = m_blocks[kind];
+        if (range.block >= blocks.size() || blocks[range.block].buffer == VK_NULL_HANDLE)
+        {
+            range = Range{};
+            return;
+        }
+
+        std::vector<Span> &spans = blocks[range.block].free;
+        auto it = std::lower_bound(spans.begin(), spans.end(), range.offset,
+                                   [](const Span &s, VkDeviceSize offset)
+                                   { return s.offset < offset; });
+        it = spans.insert(it, Span{range.offset, range.size});
+
+        // Merge with the following span, then with the preceding one.
+        auto next = it + 1;
+        if (next != spans.end() && it->offset + it->size == next->offset)
+        {
+            it->size += next->size;
+            it = spans.erase(next) - 1;
+        }
+        if (it != spans.begin())
+        {
+            auto prev = it - 1;
+            if (prev->offset + prev->size == it->offset)
+            {
+                prev->size += it->size;
+                spans.erase(it);
+            }
+        }
+
+        m_used[kind] -= std::min(m_used[kind], range.size);
+        range = Range{};
+    }
+
+    void GeometryArena::releaseEmptyBlocks()
+    {
+        for (uint32_t k = 0; k < KindCount; ++k)
+        {
+            std::vector<Block> &blocks = m_blocks[k];
+            for (size_t b = 1; b < blocks.size(); ++b)
+            {
+                Block &block = blocks[b];
+                if (block.buffer == VK_NULL_HANDLE)
+                    continue;
+                if (block.free.size() != 1 || block.free[0].size != block.size)
+                    continue;
+                vkDestroyBuffer(m_device, block.buffer, nullptr);
+                FreeMemory(block.memory);
+                block = Block{};
+            }
+            while (blocks.size() > 1 && blocks.back().buffer == VK_NULL_HANDLE)
+                blocks.pop_back();
+        }
+    }
+
+    VkBuffer GeometryArena::getBuffer(Kind kind, uint32_t block) const
+    {
+        return block < m_blocks[kind].size() ? m_blocks[kind][block].buffer : VK_NULL_HANDLE;
+    }
+
+    uint32_t GeometryArena::getBlockCount(Kind kind) const
+    {
+        uint32_t count = 0;
+        for (const Block &b : m_blocks[kind])
+            count += b.buffer != VK_NULL_HANDLE ? 1u : 0u;
+        return count;
+    }
+
+    VkDeviceSize GeometryArena::getCapacityBytes(Kind kind) const
+    {
+        VkDeviceSize bytes = 0;
+        for (const Block &b : m_blocks[kind])
+            bytes += b.size;
+        return bytes;
+    }
+
+} // namespace Engine
@@ -0,0 +1,294 @@
+#include "Engine/GpuProfiler.h"
+#include "utils/Log.h"
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t kTimestampCount = 2 + 2 * GpuProfiler::kMaxScopes;
+
+        // Results are written in bit order: vertex, fragment, compute
+        constexpr VkQueryPipelineStatisticFlags kStatisticFlags =
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+        constexpr uint32_t kStatisticCount = 3;
+
+        bool SameScope(const GpuProfiler::PassTiming &t, const char *name, const char *stage)
+        {
+            return std::strcmp(t.name, name) == 0 && std::strcmp(t.stage, stage) == 0;
+        }
+
+        // The host clock Profiler::now() reads (steady_clock): QueryPerformanceCounter on Windows,
+        // CLOCK_MONOTONIC elsewhere
+#if defined(_WIN32)
+        constexpr VkTimeDomainEXT kHostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+        constexpr VkTimeDomainEXT kHostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+    } // namespace
+
+    GpuProfiler::~GpuProfiler()
+    {
+        destroy();
+    }
+
+    bool GpuProfiler::init(VkDevice device, VkPhysicalDevice phys, uint32_t queueFamily, uint32_t slotCount, bool pipelineStatistics,
+                           bool calibratedTimestamps)
+    {
+        destroy();
+        m_device = device;
+
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(phys, &props);
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(phys, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(phys, &familyCount, families.data());
+        const uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0u;
+        if (validBits == 0 || slotCount == 0)
+        {
+            ENGINE_LOG_WARN("[GpuProfiler] No timestamps on queue family %u; GPU times unavailable", queueFamily);
+            return false;
+        }
+        m_timestampPeriod = props.limits.timestampPeriod;
+        m_timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1ull);
+        m_statisticsSupported = pipelineStatistics;
+
+        m_calibrate = calibratedTimestamps ? reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(
+                                                 vkGetDeviceProcAddr(m_device, "vkGetCalibratedTimestampsEXT"))
+                                           : nullptr;
+        m_hostTicksToNs = 1.0;
+#if defined(_WIN32)
+        LARGE_INTEGER frequency{};
+        QueryPerformanceFrequency(&frequency);
+        m_hostTicksToNs = frequency.QuadPart > 0 ? 1e9 / static_cast<double>(frequency.QuadPart) : 1.0;
+#endif
+
+        m_slots = std::make_unique<Slot[]>(slotCount);
+        for (uint32_t i = 0; i < slotCount; ++i)
+        {
+            VkQueryPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount = kTimestampCount;
+            if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_slots[i].timestamps) != VK_SUCCESS)
+            {
+                ENGINE_LOG_ERROR("[GpuProfiler] Failed to create a timestamp query pool");
+                m_slotCount = slotCount;
+                destroy();
+                return false;
+            }
+
+            if (m_statisticsSupported)
+            {
+                poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+                poolInfo.queryCount = kMaxScopes;
+                poolInfo.pipelineStatistics = kStatisticFlags;
+                if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_slots[i].statistics) != VK_SUCCESS)
+                {
+                    ENGINE_LOG_WARN("[GpuProfiler] Failed to create a pipeline statistics query pool; statistics off");
+                    m_statisticsSupported = false;
+                    m_statisticsEnabled = false;
+                }
+            }
+        }
+        m_slotCount = slotCount;
+        return true;
+    }
+
+    void GpuProfiler::destroy()
+    {
+        for (uint32_t i = 0; i < m_slotCount; ++i)
+        {
+            Slot &slot = m_slots[i];
+            if (slot.timestamps != VK_NULL_HANDLE)
+                vkDestroyQueryPool(m_device, slot.timestamps, nullptr);
+            if (slot.statistics != VK_NULL_HANDLE)
+                vkDestroyQueryPool(m_device, slot.statistics, nullptr);
+        }
+        m_slots.reset();
+        m_slotCount = 0;
+        m_current = nullptr;
+        m_calibrate = nullptr;
+        m_frameMs = 0.0f;
+        m_frameStartNs = 0;
+        m_frameEndNs = 0;
+        m_passTimings.clear();
+    }
+
+    void GpuProfiler::beginFrame(uint32_t slot, VkCommandBuffer cmd)
+    {
+        m_current = nullptr;
+        if (slot >= m_slotCount)
+            return;
+
+        Slot &s = m_slots[slot];
+        if (s.recorded)
+            collect_Internal(s);
+
+        s.used.store(0, std::memory_order_relaxed);
+        s.recorded = true;
+        s.withStatistics = m_statisticsEnabled && s.statistics != VK_NULL_HANDLE;
+        vkCmdResetQueryPool(cmd, s.timestamps, 0, kTimestampCount);
+        if (s.withStatistics)
+            vkCmdResetQueryPool(cmd, s.statistics, 0, kMaxScopes);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, s.timestamps, 0);
+        m_current = &s;
+    }
+
+    void GpuProfiler::endFrame(VkCommandBuffer cmd)
+    {
+        if (!m_current)
+            return;
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_current->timestamps, 1);
+        m_current->recordedNs = Profiler::now();
+    }
+
+    bool GpuProfiler::calibrate_Internal(uint64_t &deviceTick, uint64_t &hostNs) const
+    {
+        if (!m_calibrate)
+            return false;
+        VkCalibratedTimestampInfoEXT infos[2]{};
+        infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+        infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[1].timeDomain = kHostTimeDomain;
+        uint64_t values[2] = {};
+        uint64_t maxDeviation = 0;
+        if (m_calibrate(m_device, 2, infos, values, &maxDeviation) != VK_SUCCESS)
+            return false;
+        deviceTick = values[0] & m_timestampMask;
+        hostNs = static_cast<uint64_t>(static_cast<double>(values[1]) * m_hostTicksToNs);
+        return true;
+    }
+
+    uint32_t GpuProfiler::beginScope(VkCommandBuffer cmd, const char *name, const char *stage)
+    {
+        Slot *s = m_current;
+        if (!s)
+            return kNoScope;
+        const uint32_t scope = s->used.fetch_add(1, std::memory_order_relaxed);
+        if (scope >= kMaxScopes)
+            return kNoScope;
+
+        s->names[scope] = name;
+        s->stages[scope] = stage;
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, s->timestamps, 2 + 2 * scope);
+        if (s->withStatistics)
+            vkCmdBeginQuery(cmd, s->statistics, scope, 0);
+        return scope;
+    }
+
+    void GpuProfiler::endScope(VkCommandBuffer cmd, uint32_t scope)
+    {
+        Slot *s = m_current;
+        if (!s || scope == kNoScope)
+            return;
+        if (s->withStatistics)
+            vkCmdEndQuery(cmd, s->statistics, scope);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, s->timestamps, 3 + 2 * scope);
+    }
+
+    void GpuProfiler::collect_Internal(Slot &slot)
+    {
+        // The slot's fence has been waited on: everything is available, no wait flag needed
+        const uint32_t scopes = std::min(slot.used.load(std::memory_order_relaxed), kMaxScopes);
+        const uint32_t count = 2 + 2 * scopes;
+        m_timestampResults.resize(count);
+        if (vkGetQueryPoolResults(m_device, slot.timestamps, 0, count, count * sizeof(uint64_t), m_timestampResults.data(),
+                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+            return;
+        for (uint64_t &t : m_timestampResults)
+            t &= m_timestampMask;
+
+        bool statistics = slot.withStatistics && scopes > 0;
+        if (statistics)
+        {
+            m_statisticsResults.resize(size_t(scopes) * kStatisticCount);
+            statistics = vkGetQueryPoolResults(m_device, slot.statistics, 0, scopes,
+                                               m_statisticsResults.size() * sizeof(uint64_t), m_statisticsResults.data(),
+                                               kStatisticCount * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+        }
+
+        auto toMs = [this](uint64_t start, uint64_t end)
+        {
+            return end > start ? static_cast<float>(static_cast<double>(end - start) * m_timestampPeriod * 1e-6) : 0.0f;
+        };
+        m_frameMs = toMs(m_timestampResults[0], m_timestampResults[1]);
+
+        // Ticks onto the CPU clock: through a calibrated pair, else anchored at the end of recording
+        uint64_t anchorTick = m_timestampResults[0];
+        uint64_t anchorNs = slot.recordedNs;
+        calibrate_Internal(anchorTick, anchorNs);
+        auto toHostNs = [&](uint64_t tick)
+        {
+            const double deltaNs = static_cast<double>(static_cast<int64_t>(tick - anchorTick)) * m_timestampPeriod;
+            return static_cast<uint64_t>(static_cast<double>(anchorNs) + deltaNs);
+        };
+        m_frameStartNs = toHostNs(m_timestampResults[0]);
+        m_frameEndNs = std::max(toHostNs(m_timestampResults[1]), m_frameStartNs);
+
+        // Merge the slices of a pass; start/end ticks ride along for the ordering
+        struct Span
+        {
+            uint64_t start;
+            uint64_t end;
+        };
+        std::vector<Span> spans;
+        m_passTimings.clear();
+        for (uint32_t i = 0; i < scopes; ++i)
+        {
+            const uint64_t start = m_timestampResults[2 + 2 * i];
+            const uint64_t end = m_timestampResults[3 + 2 * i];
+            size_t index = 0;
+            while (index < m_passTimings.size() && !SameScope(m_passTimings[index], slot.names[i], slot.stages[i]))
+                ++index;
+            if (index == m_passTimings.size())
+            {
+                PassTiming timing;
+                timing.name = slot.names[i];
+                timing.stage = slot.stages[i];
+                m_passTimings.push_back(timing);
+                spans.push_back(Span{start, end});
+            }
+            spans[index].start = std::min(spans[index].start, start);
+            spans[index].end = std::max(spans[index].end, end);
+            if (statistics)
+            {
+                const uint64_t *values = m_statisticsResults.data() + size_t(i) * kStatisticCount;
+                m_passTimings[index].vertexInvocations += values[0];
+                m_passTimings[index].fragmentInvocations += values[1];
+                m_passTimings[index].computeInvocations += values[2];
+            }
+        }
+
+        std::vector<uint32_t> order(m_passTimings.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+            m_passTimings[i].ms = toMs(spans[i].start, spans[i].end);
+            m_passTimings[i].startNs = toHostNs(spans[i].start);
+            m_passTimings[i].endNs = std::max(toHostNs(spans[i].end), m_passTimings[i].startNs);
+        }
+        std::sort(order.begin(), order.end(), [&spans](uint32_t a, uint32_t b)
+                  { return spans[a].start < spans[b].start; });
+        std::vector<PassTiming> sorted;
+        sorted.reserve(order.size());
+        for (uint32_t i : order)
+            sorted.push_back(m_passTimings[i]);
+        m_passTimings.swap(sorted);
+    }
+
+} // namespace Engine
@@ -2,7 +2,7 @@
 
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
-#include "Engine/PerformanceMonitor.h"
+#include "Engine/RenderStats.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -12,21 +12,6 @@
 
 namespace Engine
 {
-    static bool findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex)
-    {
-        VkPhysicalDeviceMemoryProperties memProps{};
-        vkGetPhysicalDeviceMemoryProperties(phys, &memProps);
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-        {
-            if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-            {
-                typeIndex = i;
-                return true;
-            }
-        }
-        return false;
-    }
-
     void GroundPlaneRenderPassModule::onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs)
     {
         (void)pass;
@@ -37,8 +22,8 @@ namespace Engine
 
         const size_t frameCount = (fbs.empty() ? 1u : fbs.size());
 
-        if (!createCameraResources(ctx, frameCount))
-            throw std::runtime_error("GroundPlaneRenderPassModule: failed to create camera resources");
+        if (!createPaletteResources(ctx))
+            throw std::runtime_error("GroundPlaneRenderPassModule: failed to create palette resources");
 
         if (!createInstanceResources(ctx, frameCount))
             throw std::runtime_error("GroundPlaneRenderPassModule: failed to create instance resources");
@@ -49,7 +34,7 @@ namespace Engine
         if (!createGeometryResources(ctx, frameCount))
             throw std::runtime_error("GroundPlaneRenderPassModule: failed to create geometry resources");
 
-        // Pipeline: reuse smodel shaders (camera set + material set + push constants)
+        // Pipeline: reuse smodel shaders (global set + palette set + material set + push constants)
         PipelineCreateInfo pci{};
         pci.device = ctx.GetDevice();
         pci.renderPass = pass;
@@ -142,7 +127,7 @@ namespace Engine
         pcRange.offset = 0;
         pcRange.size = sizeof(PushConstants);
 
-        pci.descriptorSetLayouts = {m_cameraSetLayout, m_materialSetLayout};
+        pci.descriptorSetLayouts = {m_globalSetLayout, m_paletteSetLayout, m_materialSetLayout};
         pci.pushConstantRanges = {pcRange};
 
         VkResult r = m_pipeline.create(pci);
@@ -172,287 +157,116 @@ namespace Engine
         destroyGeometryResources();
         destroyMaterialResources();
         destroyInstanceResources();
-        destroyCameraResources();
+        destroyPaletteResources();
 
         m_device = VK_NULL_HANDLE;
         m_physicalDevice = VK_NULL_HANDLE;
         m_extent = {};
     }
 
-    bool GroundPlaneRenderPassModule::createCameraResources(VulkanContext &ctx, size_t frameCount)
+    bool GroundPlaneRenderPassModule::createPaletteResources(VulkanContext &ctx)
     {
-        destroyCameraResources();
-        if (frameCount == 0)
-            frameCount = 1;
-
-        VkDescriptorSetLayoutBinding camBinding{};
-        camBinding.binding = 0;
-        camBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        camBinding.descriptorCount = 1;
-        camBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        destroyPaletteResources();
 
-        VkDescriptorSetLayoutBinding paletteBinding{};
-        paletteBinding.binding = 1;
-        paletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        paletteBinding.descriptorCount = 1;
-        paletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-        VkDescriptorSetLayoutBinding jointPaletteBinding{};
-        jointPaletteBinding.binding = 2;
-        jointPaletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        jointPaletteBinding.descriptorCount = 1;
-        jointPaletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        // smodel.vert set 1: node palette (binding 0) and joint palette (binding 1). The plane draws
+        // node 0 unskinned, so both read one identity entry that never changes.
+        VkDescriptorSetLayoutBinding bindings[2]{};
+        for (uint32_t b = 0; b < 2; ++b)
+        {
+            bindings[b].binding = b;
+            bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[b].descriptorCount = 1;
+            bindings[b].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        }
 
         VkDescriptorSetLayoutCreateInfo dsl{};
         dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        VkDescriptorSetLayoutBinding bindings[3] = {camBinding, paletteBinding, jointPaletteBinding};
-        dsl.bindingCount = 3;
+        dsl.bindingCount = 2;
         dsl.pBindings = bindings;
 
-        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_cameraSetLayout) != VK_SUCCESS)
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_paletteSetLayout) != VK_SUCCESS)
             return false;
 
-        VkDescriptorPoolSize poolSizes[2]{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(frameCount);
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount) * 2u; // node palette + joint palette
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = 2u; // node palette + joint palette
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.maxSets = static_cast<uint32_t>(frameCount);
-        poolInfo.poolSizeCount = 2;
-        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
 
-        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_cameraPool) != VK_SUCCESS)
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_palettePool) != VK_SUCCESS)
             return false;
 
-        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_cameraSetLayout);
         VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = m_cameraPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(frameCount);
-        allocInfo.pSetLayouts = layouts.data();
+        allocInfo.descriptorPool = m_palettePool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_paletteSetLayout;
 
-        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
-        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, &m_paletteSet) != VK_SUCCESS)
             return false;
 
-        m_cameraFrames.resize(frameCount);
-
-        const VkDeviceSize bufSize = sizeof(CameraUBO);
-        for (size_t i = 0; i < frameCount; ++i)
-        {
-            CameraFrame &cf = m_cameraFrames[i];
-            cf.set = sets[i];
-
-            VkBufferCreateInfo binfo{};
-            binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            binfo.size = bufSize;
-            binfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-            binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &binfo, nullptr, &cf.buffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements memReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.buffer, &memReq);
-
-            VkMemoryAllocateInfo mai{};
-            mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            mai.allocationSize = memReq.size;
-            uint32_t memType = 0;
-            if (!findMemoryType(ctx.GetPhysicalDevice(), memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-                return false;
-            mai.memoryTypeIndex = memType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &mai, nullptr, &cf.memory) != VK_SUCCESS)
-                return false;
-
-            vkBindBufferMemory(ctx.GetDevice(), cf.buffer, cf.memory, 0);
-
-            // Palette SSBO: allocate a tiny buffer (identity matrix) to satisfy smodel.vert.
-            cf.paletteCapacityMatrices = 4;
-
-            VkBufferCreateInfo pbinfo{};
-            pbinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            pbinfo.size = static_cast<VkDeviceSize>(cf.paletteCapacityMatrices) * sizeof(glm::mat4);
-            pbinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            pbinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &pbinfo, nullptr, &cf.paletteBuffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements pmemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.paletteBuffer, &pmemReq);
-
-            VkMemoryAllocateInfo pmai{};
-            pmai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            pmai.allocationSize = pmemReq.size;
-            uint32_t pmemType = 0;
-            if (!findMemoryType(ctx.GetPhysicalDevice(), pmemReq.memoryTypeBits,
-                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pmemType))
-                return false;
-            pmai.memoryTypeIndex = pmemType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &pmai, nullptr, &cf.paletteMemory) != VK_SUCCESS)
-                return false;
-
-            vkBindBufferMemory(ctx.GetDevice(), cf.paletteBuffer, cf.paletteMemory, 0);
-
-            cf.paletteMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.paletteMemory, 0, VK_WHOLE_SIZE, 0, &cf.paletteMapped) != VK_SUCCESS)
-                return false;
-
-            if (cf.paletteMapped)
-            {
-                const glm::mat4 I(1.0f);
-                std::memcpy(cf.paletteMapped, &I, sizeof(glm::mat4));
-            }
-
-            // Joint palette SSBO: allocate a tiny buffer (identity matrix) to satisfy smodel.vert.
-            cf.jointPaletteCapacityMatrices = 4;
-
-            VkBufferCreateInfo jbinfo{};
-            jbinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            jbinfo.size = static_cast<VkDeviceSize>(cf.jointPaletteCapacityMatrices) * sizeof(glm::mat4);
-            jbinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            jbinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &jbinfo, nullptr, &cf.jointPaletteBuffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements jmemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.jointPaletteBuffer, &jmemReq);
-
-            VkMemoryAllocateInfo jmai{};
-            jmai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            jmai.allocationSize = jmemReq.size;
-            uint32_t jmemType = 0;
-            if (!findMemoryType(ctx.GetPhysicalDevice(), jmemReq.memoryTypeBits,
-                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, jmemType))
-                return false;
-            jmai.memoryTypeIndex = jmemType;
+        VkBufferCreateInfo binfo{};
+        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        binfo.size = sizeof(glm::mat4);
+        binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-            if (vkAllocateMemory(ctx.GetDevice(), &jmai, nullptr, &cf.jointPaletteMemory) != VK_SUCCESS)
-                return false;
+        if (vkCreateBuffer(ctx.GetDevice(), &binfo, nullptr, &m_paletteBuffer) != VK_SUCCESS)
+            return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), cf.jointPaletteBuffer, cf.jointPaletteMemory, 0);
+        if (AllocateBufferMemory(ctx.GetDevice(), m_paletteBuffer,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_paletteMemory,
+                                 MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS)
+            return false;
+        if (!m_paletteMemory.mapped)
+            return false;
 
-            cf.jointPaletteMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.jointPaletteMemory, 0, VK_WHOLE_SIZE, 0, &cf.jointPaletteMapped) != VK_SUCCESS)
-                return false;
+        const glm::mat4 I(1.0f);
+        std::memcpy(m_paletteMemory.mapped, &I, sizeof(glm::mat4));
 
-            if (cf.jointPaletteMapped)
-            {
-                const glm::mat4 I(1.0f);
-                std::memcpy(cf.jointPaletteMapped, &I, sizeof(glm::mat4));
-            }
+        VkDescriptorBufferInfo pbi{};
+        pbi.buffer = m_paletteBuffer;
+        pbi.offset = 0;
+        pbi.range = sizeof(glm::mat4);
 
-            VkDescriptorBufferInfo dbi{};
-            dbi.buffer = cf.buffer;
-            dbi.offset = 0;
-            dbi.range = bufSize;
-
-            VkDescriptorBufferInfo pbi{};
-            pbi.buffer = cf.paletteBuffer;
-            pbi.offset = 0;
-            pbi.range = static_cast<VkDeviceSize>(cf.paletteCapacityMatrices) * sizeof(glm::mat4);
-
-            VkDescriptorBufferInfo jbi{};
-            jbi.buffer = cf.jointPaletteBuffer;
-            jbi.offset = 0;
-            jbi.range = static_cast<VkDeviceSize>(cf.jointPaletteCapacityMatrices) * sizeof(glm::mat4);
-
-            VkWriteDescriptorSet writes[3]{};
-            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[0].dstSet = cf.set;
-            writes[0].dstBinding = 0;
-            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            writes[0].descriptorCount = 1;
-            writes[0].pBufferInfo = &dbi;
-
-            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[1].dstSet = cf.set;
-            writes[1].dstBinding = 1;
-            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            writes[1].descriptorCount = 1;
-            writes[1].pBufferInfo = &pbi;
-
-            writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[2].dstSet = cf.set;
-            writes[2].dstBinding = 2;
-            writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            writes[2].descriptorCount = 1;
-            writes[2].pBufferInfo = &jbi;
-
-            vkUpdateDescriptorSets(ctx.GetDevice(), 3, writes, 0, nullptr);
+        VkWriteDescriptorSet writes[2]{};
+        for (uint32_t w = 0; w < 2; ++w)
+        {
+            writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[w].dstSet = m_paletteSet;
+            writes[w].dstBinding = w;
+            writes[w].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[w].descriptorCount = 1;
+            writes[w].pBufferInfo = &pbi;
         }
+        vkUpdateDescriptorSets(ctx.GetDevice(), 2, writes, 0, nullptr);
 
         return true;
     }
 
-    void GroundPlaneRenderPassModule::destroyCameraResources()
+    void GroundPlaneRenderPassModule::destroyPaletteResources()
     {
-        for (auto &cf : m_cameraFrames)
+        if (m_paletteBuffer != VK_NULL_HANDLE)
         {
-            if (cf.jointPaletteMapped && cf.jointPaletteMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.jointPaletteMemory);
-                cf.jointPaletteMapped = nullptr;
-            }
-            if (cf.jointPaletteBuffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.jointPaletteBuffer, nullptr);
-                cf.jointPaletteBuffer = VK_NULL_HANDLE;
-            }
-            if (cf.jointPaletteMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.jointPaletteMemory, nullptr);
-                cf.jointPaletteMemory = VK_NULL_HANDLE;
-            }
-            cf.jointPaletteCapacityMatrices = 0;
-
-            if (cf.paletteMapped && cf.paletteMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.paletteMemory);
-                cf.paletteMapped = nullptr;
-            }
-            if (cf.paletteBuffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.paletteBuffer, nullptr);
-                cf.paletteBuffer = VK_NULL_HANDLE;
-            }
-            if (cf.paletteMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.paletteMemory, nullptr);
-                cf.paletteMemory = VK_NULL_HANDLE;
-            }
-            cf.paletteCapacityMatrices = 0;
-
-            if (cf.buffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.buffer, nullptr);
-                cf.buffer = VK_NULL_HANDLE;
-            }
-            if (cf.memory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.memory, nullptr);
-                cf.memory = VK_NULL_HANDLE;
-            }
-            cf.set = VK_NULL_HANDLE;
+            vkDestroyBuffer(m_device, m_paletteBuffer, nullptr);
+            m_paletteBuffer = VK_NULL_HANDLE;
         }
-        m_cameraFrames.clear();
+        FreeMemory(m_paletteMemory);
+        m_paletteSet = VK_NULL_HANDLE;
 
-        if (m_cameraPool != VK_NULL_HANDLE)
+        if (m_palettePool != VK_NULL_HANDLE)
         {
-            vkDestroyDescriptorPool(m_device, m_cameraPool, nullptr);
-            m_cameraPool = VK_NULL_HANDLE;
+            vkDestroyDescriptorPool(m_device, m_palettePool, nullptr);
+            m_palettePool = VK_NULL_HANDLE;
         }
-        if (m_cameraSetLayout != VK_NULL_HANDLE)
+        if (m_paletteSetLayout != VK_NULL_HANDLE)
         {
-            vkDestroyDescriptorSetLayout(m_device, m_cameraSetLayout, nullptr);
-            m_cameraSetLayout = VK_NULL_HANDLE;
+            vkDestroyDescriptorSetLayout(m_device, m_paletteSetLayout, nullptr);
+            m_paletteSetLayout = VK_NULL_HANDLE;
         }
     }
 
@@ -478,25 +292,12 @@ namespace Engine
             if (vkCreateBuffer(ctx.GetDevice(), &binfo, nullptr, &fr.buffer) != VK_SUCCESS)
                 return false;
 
-            VkMemoryRequirements memReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), fr.buffer, &memReq);
-
-            VkMemoryAllocateInfo mai{};
-            mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            mai.allocationSize = memReq.size;
-            uint32_t memType = 0;
-            if (!findMemoryType(ctx.GetPhysicalDevice(), memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-                return false;
-            mai.memoryTypeIndex = memType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &mai, nullptr, &fr.memory) != VK_SUCCESS)
+            if (AllocateBufferMemory(ctx.GetDevice(), fr.buffer,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, fr.memory,
+                                     MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS)
                 return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), fr.buffer, fr.memory, 0);
-
-            fr.mapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), fr.memory, 0, VK_WHOLE_SIZE, 0, &fr.mapped) != VK_SUCCESS)
-                return false;
+            fr.mapped = fr.memory.mapped;
         }
 
         return true;
@@ -509,21 +310,13 @@ namespace Engine
 
         for (auto &fr : m_instanceFrames)
         {
-            if (fr.mapped && fr.memory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, fr.memory);
-                fr.mapped = nullptr;
-            }
+            fr.mapped = nullptr;
             if (fr.buffer != VK_NULL_HANDLE)
             {
                 vkDestroyBuffer(m_device, fr.buffer, nullptr);
                 fr.buffer = VK_NULL_HANDLE;
             }
-            if (fr.memory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, fr.memory, nullptr);
-                fr.memory = VK_NULL_HANDLE;
-            }
+            FreeMemory(fr.memory);
         }
         m_instanceFrames.clear();
     }
@@ -651,7 +444,7 @@ namespace Engine
         DestroyIndexBuffer(m_device, m_planeIB);
     }
 
-    void GroundPlaneRenderPassModule::updatePlaneForFrame(uint32_t frameIndex)
+    void GroundPlaneRenderPassModule::updatePlaneForFrame(uint32_t frameIndex, const GlobalUniforms *globals)
     {
         if (m_planeVB.empty())
             return;
@@ -663,11 +456,10 @@ namespace Engine
 
         float cx = 0.0f;
         float cz = 0.0f;
-        if (m_camera)
+        if (globals)
         {
-            const glm::vec3 p = m_camera->GetPosition();
-            cx = p.x;
-            cz = p.z;
+            cx = globals->cameraPos[0];
+            cz = globals->cameraPos[2];
         }
 
         const float x0 = cx - half;
@@ -702,7 +494,7 @@ namespace Engine
             return;
         if (!m_assets || !m_baseColorTexture.isValid())
             return;
-        if (m_materialSets.empty())
+        if (m_materialSets.empty() || frameCtx.globalSet == VK_NULL_HANDLE)
             return;
 
         VkViewport vp{0.0f, 0.0f, static_cast<float>(m_extent.width), static_cast<float>(m_extent.height), 0.0f, 1.0f};
@@ -710,36 +502,6 @@ namespace Engine
         vkCmdSetViewport(cmd, 0, 1, &vp);
         vkCmdSetScissor(cmd, 0, 1, &sc);
 
-        // Update camera UBO
-        const uint32_t camIndex = (!m_cameraFrames.empty()) ? (frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())) : 0;
-        CameraFrame *camFrame = (!m_cameraFrames.empty()) ? &m_cameraFrames[camIndex] : nullptr;
-        if (camFrame && camFrame->memory != VK_NULL_HANDLE)
-        {
-            CameraUBO ubo{};
-            const float aspect = (m_extent.height > 0) ? (static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height)) : 1.0f;
-            if (m_camera)
-            {
-                m_camera->SetAspect(aspect);
-                ubo.view = m_camera->GetViewMatrix();
-                ubo.proj = m_camera->GetProjectionMatrix();
-            }
-            else
-            {
-                glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
-                glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
-                proj[1][1] *= -1.0f;
-                ubo.view = view;
-                ubo.proj = proj;
-            }
-
-            void *mapped = nullptr;
-            if (vkMapMemory(m_device, camFrame->memory, 0, sizeof(CameraUBO), 0, &mapped) == VK_SUCCESS && mapped)
-            {
-                std::memcpy(mapped, &ubo, sizeof(CameraUBO));
-                vkUnmapMemory(m_device, camFrame->memory);
-            }
-        }
-
         // Update per-frame instance transform (identity)
         const uint32_t instIndex = (!m_instanceFrames.empty()) ? (frameCtx.frameIndex % static_cast<uint32_t>(m_instanceFrames.size())) : 0;
         InstanceFrame *instFrame = (!m_instanceFrames.empty()) ? &m_instanceFrames[instIndex] : nullptr;
@@ -749,20 +511,18 @@ namespace Engine
         std::memcpy(instFrame->mapped, &I, sizeof(glm::mat4));
 
         // Update plane vertices (centered around camera; UVs in world-space)
-        updatePlaneForFrame(frameCtx.frameIndex);
+        updatePlaneForFrame(frameCtx.frameIndex, frameCtx.globals);
 
         // Push constants: opaque material
-        m_pc.model = glm::mat4(1.0f);
         m_pc.baseColorFactor = glm::vec4(1.0f);
         m_pc.materialParams = glm::vec4(0.5f, 0.0f, 0.0f, 0.0f); // alphaCutoff=0.5, alphaMode=Opaque
         m_pc.nodeInfo = glm::uvec4(0u, 1u, 0u, 0u);
 
         m_pipeline.bind(cmd);
 
-        VkDescriptorSet camSet = (!m_cameraFrames.empty()) ? m_cameraFrames[camIndex].set : VK_NULL_HANDLE;
         VkDescriptorSet matSet = m_materialSets[frameCtx.frameIndex % static_cast<uint32_t>(m_materialSets.size())];
-        VkDescriptorSet sets[2] = {camSet, matSet};
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.getLayout(), 0, 2, sets, 0, nullptr);
+        VkDescriptorSet sets[3] = {frameCtx.globalSet, m_paletteSet, matSet};
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.getLayout(), 0, 3, sets, 0, nullptr);
         vkCmdPushConstants(cmd, m_pipeline.getLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstants), &m_pc);
 
         const uint32_t vbIndex = frameCtx.frameIndex % static_cast<uint32_t>(m_planeVB.size());
@@ -771,6 +531,16 @@ namespace Engine
         vkCmdBindVertexBuffers(cmd, 0, 2, vbs, offs);
         vkCmdBindIndexBuffer(cmd, m_planeIB.buffer, 0, VK_INDEX_TYPE_UINT16);
         vkCmdDrawIndexed(cmd, 6, 1, 0, 0, 0);
-        DrawCallCounter::increment();
+
+        // The instance transform and the four plane vertices are rewritten every frame.
+        RenderCounters stats;
+        stats.drawCalls = 1;
+        stats.instances = 1;
+        stats.triangles = stats.visibleTriangles = 2;
+        stats.pipelineBinds = 1;
+        stats.descriptorBinds = 3;
+        stats.bufferBinds = 3;
+        stats.uploadBytes = sizeof(glm::mat4) + sizeof(PlaneVertex) * 4;
+        RenderStats::addPass(name(), stats);
     }
 }
@@ -0,0 +1,102 @@
+#include "Engine/HeadlessApplication.h"
+#include "ECS/ECSContext.h"
+#include "assets/HeadlessAssets.h"
+#include "utils/FrameArena.h"
+#include "utils/JobSystem.h"
+#include "utils/Log.h"
+
+#include <chrono>
+
+namespace Engine
+{
+    struct HeadlessApplication::Impl
+    {
+        explicit Impl(uint32_t workers) : jobs(workers) {}
+
+        // Declared before the world, so they outlive it (arena memory, model handles).
+        JobSystem jobs;
+        FrameArena frameArena;
+        HeadlessAssets assets;
+        std::unique_ptr<ECS::ECSContext> ecs = std::make_unique<ECS::ECSContext>();
+    };
+
+    HeadlessApplication::HeadlessApplication(const HeadlessConfig &config)
+        : m_Impl(std::make_unique<Impl>(config.workerThreads)), m_config(config)
+    {
+        m_Impl->frameArena.resize(m_Impl->jobs.threadCount());
+    }
+
+    HeadlessApplication::~HeadlessApplication()
+    {
+        Close();
+        Join();
+    }
+
+    void HeadlessApplication::Run()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const bool paced = m_config.tickHz > 0.0f;
+        const float hz = paced ? m_config.tickHz : 30.0f;
+        const TimeStep ts{1.0f / hz};
+        const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+
+        m_running.store(true, std::memory_order_release);
+        ENGINE_LOG_INFO("[Headless] %s: starting (%.1f Hz, %u job workers)", m_config.name.c_str(),
+                        static_cast<double>(m_config.tickHz), m_Impl->jobs.workerCount());
+        OnStart();
+
+        auto next = Clock::now();
+        while (!m_closeRequested.load(std::memory_order_acquire))
+        {
+            if (m_config.maxTicks != 0 && m_tick.load(std::memory_order_relaxed) >= m_config.maxTicks)
+                break;
+
+            m_Impl->frameArena.beginFrame();
+            OnTick(ts);
+            m_tick.fetch_add(1, std::memory_order_relaxed);
+
+            if (!paced)
+                continue;
+
+            // Fixed schedule; if we fall several ticks behind (load spike, debugger), drop them
+            // instead of trying to catch up in a burst.
+            next += step;
+            const auto now = Clock::now();
+            if (now > next)
+                m_lateTicks.fetch_add(1, std::memory_order_relaxed);
+            if (now - next > 4 * step)
+                next = now;
+            std::this_thread::sleep_until(next);
+        }
+
+        OnStop();
+        ENGINE_LOG_INFO("[Headless] %s: stopped after %llu ticks (%llu late)", m_config.name.c_str(),
+                        static_cast<unsigned long long>(GetTick()), static_cast<unsigned long long>(lateTicks()));
+        m_running.store(false, std::memory_order_release);
+    }
+
+    void HeadlessApplication::Start()
+    {
+        if (m_thread.joinable())
+            return;
+        m_thread = std::thread(&HeadlessApplication::Run, this);
+    }
+
+    void HeadlessApplication::Join()
+    {
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    void HeadlessApplication::Close()
+    {
+        m_closeRequested.store(true, std::memory_order_release);
+    }
+
+    ECS::ECSContext &HeadlessApplication::GetECS() { return *m_Impl->ecs; }
+    JobSystem &HeadlessApplication::GetJobs() { return m_Impl->jobs; }
+    FrameArena &HeadlessApplication::GetFrameArena() { return m_Impl->frameArena; }
+    HeadlessAssets &HeadlessApplication::GetAssets() { return m_Impl->assets; }
+
+} // namespace Engine
@@ -0,0 +1,99 @@
+#include "assets/HeadlessAssets.h"
+#include "assets/ModelData.h"
+#include "utils/Log.h"
+
+#include <iterator>
+#include <mutex>
+
+namespace Engine
+{
+    namespace
+    {
+        // The file stays mapped with the model: node debug names point into it.
+        struct SharedModel_Internal
+        {
+            smodel::SModelFileView view;
+            ModelAsset model;
+        };
+
+        std::mutex g_sharedMutex;
+        std::unordered_map<std::string, std::weak_ptr<const SharedModel_Internal>> g_shared;
+
+        std::shared_ptr<const ModelAsset> AcquireShared_Internal(const std::string &path)
+        {
+            // Loads run under the lock: matches starting together parse each model once.
+            std::lock_guard<std::mutex> lock(g_sharedMutex);
+            if (std::shared_ptr<const SharedModel_Internal> existing = g_shared[path].lock())
+                return std::shared_ptr<const ModelAsset>(existing, &existing->model);
+
+            auto shared = std::make_shared<SharedModel_Internal>();
+            std::string error;
+            if (!smodel::LoadSModelFile(path, shared->view, error))
+            {
+                ENGINE_LOG_ERROR("[HeadlessAssets] Failed to load .smodel '%s': %s", path.c_str(), error.c_str());
+                g_shared.erase(path);
+                return nullptr;
+            }
+            if (!BuildModelData(shared->view, shared->model))
+            {
+                ENGINE_LOG_ERROR("[HeadlessAssets] '%s' has neither nodes nor primitives", path.c_str());
+                g_shared.erase(path);
+                return nullptr;
+            }
+            // Drop entries of models freed since (paths are few; this keeps the map bounded)
+            for (auto it = g_shared.begin(); it != g_shared.end();)
+                it = it->second.expired() ? g_shared.erase(it) : std::next(it);
+
+            std::shared_ptr<const SharedModel_Internal> result = std::move(shared);
+            g_shared[path] = result;
+            return std::shared_ptr<const ModelAsset>(result, &result->model);
+        }
+    } // namespace
+
+    ModelHandle HeadlessAssets::loadModel(const std::string &cookedModelPath)
+    {
+        const auto cached = m_byPath.find(cookedModelPath);
+        if (cached != m_byPath.end())
+            return cached->second;
+
+        ModelHandle h{};
+        if (std::shared_ptr<const ModelAsset> model = AcquireShared_Internal(cookedModelPath))
+        {
+            m_models.push_back({cookedModelPath, std::move(model)});
+            h.id = m_models.size();
+            h.generation = 1;
+        }
+        m_byPath.emplace(cookedModelPath, h);
+        return h;
+    }
+
+    const HeadlessAssets::Entry *HeadlessAssets::find(ModelHandle h) const
+    {
+        if (h.id == 0 || h.id > m_models.size() || h.generation != 1)
+            return nullptr;
+        return &m_models[static_cast<size_t>(h.id - 1)];
+    }
+
+    const ModelAsset *HeadlessAssets::modelData(ModelHandle h) const
+    {
+        const Entry *e = find(h);
+        return e ? e->model.get() : nullptr;
+    }
+
+    const std::string &HeadlessAssets::getModelPath(ModelHandle h) const
+    {
+        static const std::string kEmpty;
+        const Entry *e = find(h);
+        return e ? e->path : kEmpty;
+    }
+
+    uint32_t HeadlessAssets::sharedModelCount()
+    {
+        std::lock_guard<std::mutex> lock(g_sharedMutex);
+        uint32_t count = 0;
+        for (const auto &entry : g_shared)
+            count += entry.second.expired() ? 0u : 1u;
+        return count;
+    }
+
+} // namespace Engine
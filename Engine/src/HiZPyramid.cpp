@@ -0,0 +1,276 @@
+#include "Engine/HiZPyramid.h"
+#include "Engine/Pipeline.h"
+#include "utils/ImageUtils.h"
+#include "utils/PipelineCache.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace Engine
+{
+    HiZPyramid::~HiZPyramid()
+    {
+        destroy();
+    }
+
+    VkExtent2D HiZPyramid::levelExtent(uint32_t level) const
+    {
+        // Level 0 is half the depth image and every level halves the one before, rounded down as image
+        // mips are; the last texel of a level folds in the odd row or column of the one it reduces.
+        return VkExtent2D{std::max(1u, m_depthExtent.width >> (level + 1)), std::max(1u, m_depthExtent.height >> (level + 1))};
+    }
+
+    bool HiZPyramid::init(VkDevice device, VkPhysicalDevice phys, VkExtent2D depthExtent,
+                          const std::vector<VkImageView> &depthViews, VkImageLayout depthLayout)
+    {
+        destroy();
+        if (depthExtent.width == 0 || depthExtent.height == 0 || depthViews.empty())
+            return false;
+
+        m_device = device;
+        m_depthExtent = depthExtent;
+        m_depthViewCount = static_cast<uint32_t>(depthViews.size());
+        m_buildCount = 0;
+
+        const VkExtent2D base = levelExtent(0);
+        m_mipCount = 1;
+        while ((std::max(base.width, base.height) >> m_mipCount) > 0)
+            ++m_mipCount;
+
+        VkShaderModule module = VK_NULL_HANDLE;
+        try
+        {
+            module = Pipeline::createShaderModuleFromFile(m_device, "shaders/hiz_build.comp.spv");
+        }
+        catch (const std::exception &e)
+        {
+            ENGINE_LOG_WARN("[HiZ] Occlusion pyramid disabled: %s", e.what());
+            destroy();
+            return false;
+        }
+
+        bool ok = CreateImage2D(m_device, phys, base.width, base.height, VK_FORMAT_R32_SFLOAT,
+                                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, m_mipCount, m_image, m_memory,
+                                MemoryCategory::RenderTargets) == VK_SUCCESS &&
+                  CreateImageView2D(m_device, m_image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, m_mipCount, m_view) == VK_SUCCESS &&
+                  CreateTextureSampler(m_device, phys, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                       VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, 1.0f,
+                                       static_cast<float>(m_mipCount), m_sampler) == VK_SUCCESS;
+
+        // One view per level: written as a storage image, then read to reduce the next level.
+        m_levelViews.assign(m_mipCount, VK_NULL_HANDLE);
+        for (uint32_t level = 0; ok && level < m_mipCount; ++level)
+        {
+            VkImageViewCreateInfo vi{};
+            vi.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            vi.image = m_image;
+            vi.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            vi.format = VK_FORMAT_R32_SFLOAT;
+            vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            vi.subresourceRange.baseMipLevel = level;
+            vi.subresourceRange.levelCount = 1;
+            vi.subresourceRange.baseArrayLayer = 0;
+            vi.subresourceRange.layerCount = 1;
+            ok = vkCreateImageView(m_device, &vi, nullptr, &m_levelViews[level]) == VK_SUCCESS;
+        }
+
+        // Binding 0: the level (or depth image) reduced, binding 1: the level written.
+        VkDescriptorSetLayoutBinding bindings[2]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 2;
+        dsl.pBindings = bindings;
+        ok = ok && vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_setLayout) == VK_SUCCESS;
+
+        const uint32_t setCount = m_depthViewCount + m_mipCount - 1;
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = setCount;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[1].descriptorCount = setCount;
+
+        VkDescriptorPoolCreateInfo pci{};
+        pci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pci.maxSets = setCount;
+        pci.poolSizeCount = 2;
+        pci.pPoolSizes = poolSizes;
+        ok = ok && vkCreateDescriptorPool(m_device, &pci, nullptr, &m_pool) == VK_SUCCESS;
+
+        if (ok)
+        {
+            std::vector<VkDescriptorSetLayout> layouts(setCount, m_setLayout);
+            m_sets.assign(setCount, VK_NULL_HANDLE);
+            VkDescriptorSetAllocateInfo alloc{};
+            alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            alloc.descriptorPool = m_pool;
+            alloc.descriptorSetCount = setCount;
+            alloc.pSetLayouts = layouts.data();
+            ok = vkAllocateDescriptorSets(m_device, &alloc, m_sets.data()) == VK_SUCCESS;
+        }
+
+        if (ok)
+        {
+            std::vector<VkDescriptorImageInfo> images(setCount * 2);
+            std::vector<VkWriteDescriptorSet> writes(setCount * 2);
+            for (uint32_t s = 0; s < setCount; ++s)
+            {
+                const bool fromDepth = s < m_depthViewCount;
+                const uint32_t dstLevel = fromDepth ? 0 : s - m_depthViewCount + 1;
+
+                VkDescriptorImageInfo &src = images[s * 2];
+                src.sampler = m_sampler;
+                src.imageView = fromDepth ? depthViews[s] : m_levelViews[dstLevel - 1];
+                src.imageLayout = fromDepth ? depthLayout : VK_IMAGE_LAYOUT_GENERAL;
+
+                VkDescriptorImageInfo &dst = images[s * 2 + 1];
+                dst.imageView = m_levelViews[dstLevel];
+                dst.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+                for (uint32_t b = 0; b < 2; ++b)
+                {
+                    VkWriteDescriptorSet &w = writes[s * 2 + b];
+                    w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    w.dstSet = m_sets[s];
+                    w.dstBinding = b;
+                    w.descriptorCount = 1;
+                    w.descriptorType = bindings[b].descriptorType;
+                    w.pImageInfo = &images[s * 2 + b];
+                }
+            }
+            vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+
+        VkPushConstantRange range{};
+        range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        range.offset = 0;
+        range.size = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo plci{};
+        plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plci.setLayoutCount = 1;
+        plci.pSetLayouts = &m_setLayout;
+        plci.pushConstantRangeCount = 1;
+        plci.pPushConstantRanges = &range;
+        ok = ok && vkCreatePipelineLayout(m_device, &plci, nullptr, &m_pipelineLayout) == VK_SUCCESS;
+
+        if (ok)
+        {
+            VkComputePipelineCreateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            info.stage.module = module;
+            info.stage.pName = "main";
+            info.layout = m_pipelineLayout;
+            ok = vkCreateComputePipelines(m_device, PipelineCache::HandleFor(m_device), 1, &info, nullptr, &m_pipeline) == VK_SUCCESS;
+            if (!ok)
+                m_pipeline = VK_NULL_HANDLE;
+        }
+        vkDestroyShaderModule(m_device, module, nullptr);
+
+        if (!ok)
+        {
+            ENGINE_LOG_WARN("[HiZ] Failed to create the %ux%u occlusion pyramid", base.width, base.height);
+            destroy();
+        }
+        return ok;
+    }
+
+    void HiZPyramid::destroy()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        if (m_pipeline != VK_NULL_HANDLE)
+            vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        if (m_pool != VK_NULL_HANDLE)
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr); // frees the sets
+        if (m_setLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+        if (m_sampler != VK_NULL_HANDLE)
+            vkDestroySampler(m_device, m_sampler, nullptr);
+        for (VkImageView v : m_levelViews)
+        {
+            if (v != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, v, nullptr);
+        }
+        if (m_view != VK_NULL_HANDLE)
+            vkDestroyImageView(m_device, m_view, nullptr);
+        if (m_image != VK_NULL_HANDLE)
+            vkDestroyImage(m_device, m_image, nullptr);
+        FreeMemory(m_memory);
+
+        m_pipeline = VK_NULL_HANDLE;
+        m_pipelineLayout = VK_NULL_HANDLE;
+        m_pool = VK_NULL_HANDLE;
+        m_sets.clear();
+        m_setLayout = VK_NULL_HANDLE;
+        m_sampler = VK_NULL_HANDLE;
+        m_levelViews.clear();
+        m_view = VK_NULL_HANDLE;
+        m_image = VK_NULL_HANDLE;
+        m_mipCount = 0;
+        m_depthViewCount = 0;
+        m_buildCount = 0;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    void HiZPyramid::build(VkCommandBuffer cmd, uint32_t imageIndex)
+    {
+        if (!isValid() || imageIndex >= m_depthViewCount)
+            return;
+
+        // Ordering against culling's reads, the layout and the depth image come from the render graph
+        // (Renderer::drawFrame()); only the level-to-level dependencies are recorded here.
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+        for (uint32_t level = 0; level < m_mipCount; ++level)
+        {
+            const VkExtent2D src = (level == 0) ? m_depthExtent : levelExtent(level - 1);
+            const VkExtent2D dst = levelExtent(level);
+            PushConstants pc{};
+            pc.srcSize[0] = static_cast<int32_t>(src.width);
+            pc.srcSize[1] = static_cast<int32_t>(src.height);
+            pc.dstSize[0] = static_cast<int32_t>(dst.width);
+            pc.dstSize[1] = static_cast<int32_t>(dst.height);
+
+            const VkDescriptorSet set = m_sets[(level == 0) ? imageIndex : m_depthViewCount + level - 1];
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &set, 0, nullptr);
+            vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pc);
+            vkCmdDispatch(cmd, (dst.width + kGroupSize - 1) / kGroupSize, (dst.height + kGroupSize - 1) / kGroupSize, 1);
+
+            // The level is read by the next dispatch.
+            if (level + 1 == m_mipCount)
+                break;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier.subresourceRange.baseMipLevel = level;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                                 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+        ++m_buildCount;
+    }
+
+} // namespace Engine
@@ -0,0 +1,454 @@
+#include "utils/HitchDetector.h"
+#include "Engine/RenderStats.h"
+#include "utils/AllocTracker.h"
+#include "utils/Log.h"
+#include "utils/MemoryTracker.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string_view>
+
+namespace Engine
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        // Same layout as TraceCapture files: CPU threads, GPU queue, frame markers on the first row
+        constexpr int kCpuPid = 1;
+        constexpr int kGpuPid = 2;
+        constexpr int kFrameTid = 0;
+
+        // Frames measured before the median is trusted
+        constexpr uint32_t kMinMedianFrames = 30;
+        // Scopes listed for the hitch frame, most self time first
+        constexpr size_t kHitchScopes = 12;
+        // Of those, named in the log line
+        constexpr size_t kLoggedScopes = 3;
+
+        struct AssetEvent
+        {
+            const char *category = nullptr;
+            std::string name;
+            uint64_t startNs = 0;
+            uint64_t endNs = 0;
+        };
+
+        struct Record
+        {
+            uint64_t frame = 0;
+            HitchDetector::FrameInfo info;
+            float medianMs = 0.0f;
+            bool hitch = false;
+            uint64_t cpuBytes[MemoryTracker::kCategoryCount] = {};
+            RenderCounters render;
+            AllocCounts heap;                       // ENGINE_ALLOC_TRACKING builds
+            Profiler::Frame cpu;                    // names by pointer, as the profiler keeps them
+            std::vector<TraceCapture::GpuSpan> gpu; // empty when no new GPU frame was collected
+            std::vector<AssetEvent> assets;
+        };
+
+        struct ScopeTotal
+        {
+            std::string_view name;
+            double selfMs = 0.0;
+            double totalMs = 0.0;
+            uint32_t calls = 0;
+            uint64_t allocations = 0; // inclusive
+        };
+
+        struct DetectorState
+        {
+            std::atomic<bool> enabled{false};
+            HitchDetectorConfig config;
+
+            // historyFrames + 1 + framesAfter records, oldest at (next - count)
+            std::vector<Record> ring;
+            size_t next = 0;
+            size_t count = 0;
+            uint64_t frameIndex = 0;
+            uint64_t lastGpuFrameNs = 0;
+
+            std::vector<float> frameTimes; // last medianFrames measured frames
+            size_t frameTimesNext = 0;
+            std::vector<float> scratch;
+
+            uint32_t framesLeft = 0; // after the hitch, before the dump; 0: not capturing
+            uint64_t hitchFrame = 0;
+            uint32_t cooldown = 0;
+            uint32_t dumps = 0;
+            bool skipNext = false;   // the frame after a dump pays for writing it
+
+            std::mutex assetMutex;
+            std::vector<AssetEvent> pendingAssets;
+        };
+
+        DetectorState &GetState()
+        {
+            static DetectorState state;
+            return state;
+        }
+
+        float Median_Internal(DetectorState &s)
+        {
+            if (s.frameTimes.size() < kMinMedianFrames)
+                return 0.0f;
+            s.scratch.assign(s.frameTimes.begin(), s.frameTimes.end());
+            auto mid = s.scratch.begin() + static_cast<std::ptrdiff_t>(s.scratch.size() / 2);
+            std::nth_element(s.scratch.begin(), mid, s.scratch.end());
+            return *mid;
+        }
+
+        void PushFrameTime_Internal(DetectorState &s, float ms)
+        {
+            if (s.frameTimes.size() < s.config.medianFrames)
+            {
+                s.frameTimes.push_back(ms);
+                return;
+            }
+            s.frameTimes[s.frameTimesNext] = ms;
+            s.frameTimesNext = (s.frameTimesNext + 1) % s.frameTimes.size();
+        }
+
+        const Record &RecordAt_Internal(const DetectorState &s, size_t i)
+        {
+            return s.ring[(s.next + s.ring.size() - s.count + i) % s.ring.size()];
+        }
+
+        // Per scope name over one frame: self time (minus nested scopes) and inclusive time
+        std::vector<ScopeTotal> ScopeTotals_Internal(const Profiler::Frame &frame)
+        {
+            const std::vector<Profiler::Event> &events = frame.events;
+            std::vector<double> selfMs(events.size(), 0.0);
+            std::vector<size_t> open;
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                const Profiler::Event &e = events[i];
+                if (i > 0 && events[i - 1].thread != e.thread)
+                    open.clear();
+                while (!open.empty() && events[open.back()].depth >= e.depth)
+                    open.pop_back();
+                const double ms = static_cast<double>(e.endNs - e.startNs) * 1e-6;
+                selfMs[i] += ms;
+                if (!open.empty() && events[open.back()].depth + 1u == e.depth)
+                    selfMs[open.back()] -= ms;
+                open.push_back(i);
+            }
+
+            std::map<std::string_view, ScopeTotal> byName;
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                if (!events[i].name)
+                    continue;
+                ScopeTotal &t = byName[events[i].name];
+                t.name = events[i].name;
+                t.selfMs += std::max(selfMs[i], 0.0);
+                t.totalMs += static_cast<double>(events[i].endNs - events[i].startNs) * 1e-6;
+                ++t.calls;
+                t.allocations += events[i].allocations;
+            }
+            std::vector<ScopeTotal> totals;
+            totals.reserve(byName.size());
+            for (const auto &[name, total] : byName)
+                totals.push_back(total);
+            std::sort(totals.begin(), totals.end(), [](const ScopeTotal &a, const ScopeTotal &b)
+                      { return a.selfMs > b.selfMs; });
+            return totals;
+        }
+
+        int TrackId_Internal(std::map<std::string, int> &tracks, const std::string &label)
+        {
+            auto it = tracks.find(label);
+            if (it != tracks.end())
+                return it->second;
+            const int tid = kFrameTid + 1 + static_cast<int>(tracks.size());
+            tracks.emplace(label, tid);
+            return tid;
+        }
+
+        json Metadata_Internal(const char *kind, int pid, int tid, const std::string &name)
+        {
+            return {{"ph", "M"}, {"pid", pid}, {"tid", tid}, {"name", kind}, {"args", {{"name", name}}}};
+        }
+
+        json TraceEvents_Internal(const DetectorState &s)
+        {
+            const uint64_t originNs = RecordAt_Internal(s, 0).cpu.startNs;
+            auto toUs = [originNs](uint64_t ns)
+            { return ns > originNs ? static_cast<double>(ns - originNs) * 1e-3 : 0.0; };
+            json events = json::array();
+            auto span = [&](int pid, int tid, const std::string &name, const char *category, uint64_t startNs, uint64_t endNs)
+            {
+                const double ts = toUs(startNs);
+                events.push_back({{"ph", "X"}, {"pid", pid}, {"tid", tid}, {"name", name}, {"cat", category}, {"ts", ts},
+                                  {"dur", std::max(toUs(endNs) - ts, 0.0)}});
+            };
+
+            std::map<std::string, int> cpuThreads;
+            std::map<std::string, int> gpuTracks;
+            uint64_t asyncId = 0;
+            for (size_t i = 0; i < s.count; ++i)
+            {
+                const Record &r = RecordAt_Internal(s, i);
+                const std::string frameName = (r.hitch ? "HITCH Frame " : "Frame ") + std::to_string(r.frame);
+                if (r.cpu.endNs > r.cpu.startNs)
+                    span(kCpuPid, kFrameTid, frameName, "frame", r.cpu.startNs, r.cpu.endNs);
+
+                std::vector<int> tids(r.cpu.threads.size());
+                for (size_t t = 0; t < r.cpu.threads.size(); ++t)
+                    tids[t] = TrackId_Internal(cpuThreads, r.cpu.threads[t]);
+                for (const Profiler::Event &e : r.cpu.events)
+                {
+                    if (e.thread < tids.size() && e.name)
+                        span(kCpuPid, tids[e.thread], e.name, "cpu", e.startNs, e.endNs);
+                }
+                for (const TraceCapture::GpuSpan &g : r.gpu)
+                {
+                    const int tid = g.track == "Frame" ? kFrameTid : TrackId_Internal(gpuTracks, g.track);
+                    span(kGpuPid, tid, g.name, "gpu", g.startNs, g.endNs);
+                }
+                for (const AssetEvent &a : r.assets)
+                {
+                    const double ts = toUs(a.startNs);
+                    ++asyncId;
+                    events.push_back({{"ph", "b"}, {"pid", kCpuPid}, {"id", asyncId}, {"name", a.name}, {"cat", a.category}, {"ts", ts}});
+                    events.push_back({{"ph", "e"}, {"pid", kCpuPid}, {"id", asyncId}, {"name", a.name}, {"cat", a.category},
+                                      {"ts", std::max(toUs(a.endNs), ts)}});
+                }
+            }
+
+            json out = json::array();
+            out.push_back(Metadata_Internal("process_name", kCpuPid, 0, "CPU"));
+            out.push_back(Metadata_Internal("process_name", kGpuPid, 0, "GPU"));
+            out.push_back(Metadata_Internal("thread_name", kCpuPid, kFrameTid, "Frames"));
+            out.push_back(Metadata_Internal("thread_name", kGpuPid, kFrameTid, "Frames"));
+            for (const auto &[label, tid] : cpuThreads)
+                out.push_back(Metadata_Internal("thread_name", kCpuPid, tid, label));
+            for (const auto &[label, tid] : gpuTracks)
+                out.push_back(Metadata_Internal("thread_name", kGpuPid, tid, label));
+            for (json &e : events)
+                out.push_back(std::move(e));
+            return out;
+        }
+
+        json FrameSummary_Internal(const Record &r, const Record *previous)
+        {
+            const double toMB = 1.0 / (1024.0 * 1024.0);
+            json cpuMemory = json::object();
+            for (size_t c = 0; c < MemoryTracker::kCategoryCount; ++c)
+                cpuMemory[MemoryTracker::name(static_cast<CpuMemoryCategory>(c))] = static_cast<double>(r.cpuBytes[c]) * toMB;
+
+            json assets = json::array();
+            for (const AssetEvent &a : r.assets)
+                assets.push_back({{"category", a.category}, {"name", a.name},
+                                  {"ms", static_cast<double>(a.endNs - std::min(a.startNs, a.endNs)) * 1e-6}});
+
+            const int64_t allocationDelta = previous ? static_cast<int64_t>(r.info.gpuAllocations) - static_cast<int64_t>(previous->info.gpuAllocations) : 0;
+            return {{"frame", r.frame},
+                    {"hitch", r.hitch},
+                    {"frameMs", r.info.frameMs},
+                    {"cpuMs", r.info.cpuMs},
+                    {"gpuMs", r.info.gpuMs},
+                    {"medianMs", r.medianMs},
+                    {"gpuAllocations", r.info.gpuAllocations},
+                    {"gpuAllocationsDelta", allocationDelta},
+                    {"gpuUsedMB", static_cast<double>(r.info.gpuUsedBytes) * toMB},
+                    {"heapAllocations", r.heap.allocations},
+                    {"heapBytes", r.heap.bytes},
+                    {"cpuMemoryMB", std::move(cpuMemory)},
+                    {"render", {{"drawCalls", r.render.drawCalls}, {"instances", r.render.instances},
+                                {"triangles", r.render.triangles}, {"uploadBytes", r.render.uploadBytes}}},
+                    {"scopesDropped", r.cpu.dropped},
+                    {"assets", std::move(assets)}};
+        }
+
+        // Writes the ring; the hitch frame is framesAfter records from the newest
+        void Dump_Internal(DetectorState &s)
+        {
+            const Record *hitch = nullptr;
+            json frames = json::array();
+            for (size_t i = 0; i < s.count; ++i)
+            {
+                const Record &r = RecordAt_Internal(s, i);
+                frames.push_back(FrameSummary_Internal(r, i > 0 ? &RecordAt_Internal(s, i - 1) : nullptr));
+                if (r.frame == s.hitchFrame)
+                    hitch = &r;
+            }
+            if (!hitch)
+                return;
+
+            const std::vector<ScopeTotal> totals = ScopeTotals_Internal(hitch->cpu);
+            json scopes = json::array();
+            std::string heaviest;
+            for (size_t i = 0; i < totals.size() && i < kHitchScopes; ++i)
+            {
+                const ScopeTotal &t = totals[i];
+                scopes.push_back({{"name", std::string(t.name)}, {"selfMs", t.selfMs}, {"totalMs", t.totalMs}, {"calls", t.calls},
+                                  {"allocations", t.allocations}});
+                if (i < kLoggedScopes)
+                {
+                    char part[160];
+                    std::snprintf(part, sizeof(part), "%s%.*s %.1f ms", i > 0 ? ", " : "", static_cast<int>(t.name.size()),
+                                  t.name.data(), t.selfMs);
+                    heaviest += part;
+                }
+            }
+
+            json root;
+            root["traceEvents"] = TraceEvents_Internal(s);
+            root["displayTimeUnit"] = "ms";
+            root["hitch"] = {{"frame", hitch->frame},
+                             {"frameMs", hitch->info.frameMs},
+                             {"medianMs", hitch->medianMs},
+                             {"threshold", s.config.threshold},
+                             {"scopes", std::move(scopes)}};
+            root["frames"] = std::move(frames);
+
+            std::error_code ec;
+            if (!s.config.directory.empty())
+                std::filesystem::create_directories(s.config.directory, ec);
+            const std::time_t now = std::time(nullptr);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+            std::filesystem::path path(s.config.directory);
+            path /= "hitch_" + std::string(stamp) + "_f" + std::to_string(hitch->frame) + ".json";
+
+            std::ofstream out(path);
+            if (!out.good())
+            {
+                ENGINE_LOG_ERROR("[HitchDetector] Cannot write %s", path.string().c_str());
+                return;
+            }
+            out << root.dump();
+            ENGINE_LOG_WARN("[HitchDetector] Frame %llu took %.1f ms (median %.1f ms); most self time: %s -> %s",
+                            static_cast<unsigned long long>(hitch->frame), hitch->info.frameMs, hitch->medianMs,
+                            heaviest.empty() ? "no scopes" : heaviest.c_str(), path.string().c_str());
+        }
+    } // namespace
+
+    void HitchDetector::enable(const HitchDetectorConfig &config)
+    {
+        DetectorState &s = GetState();
+        s.config = config;
+        s.config.medianFrames = std::max(s.config.medianFrames, kMinMedianFrames);
+        s.ring.assign(static_cast<size_t>(s.config.historyFrames) + 1u + s.config.framesAfter, Record{});
+        s.next = 0;
+        s.count = 0;
+        s.lastGpuFrameNs = 0;
+        s.frameTimes.clear();
+        s.frameTimes.reserve(s.config.medianFrames);
+        s.frameTimesNext = 0;
+        s.framesLeft = 0;
+        s.cooldown = 0;
+        s.dumps = 0;
+        s.skipNext = false;
+        {
+            std::lock_guard<std::mutex> lock(s.assetMutex);
+            s.pendingAssets.clear();
+        }
+        s.enabled.store(true, std::memory_order_relaxed);
+        ENGINE_LOG_INFO("[HitchDetector] Watching for frames over %.1fx the median (at least %.1f ms) -> %s",
+                        s.config.threshold, s.config.minHitchMs, s.config.directory.c_str());
+    }
+
+    void HitchDetector::disable()
+    {
+        DetectorState &s = GetState();
+        s.enabled.store(false, std::memory_order_relaxed);
+        std::vector<Record>().swap(s.ring);
+        s.count = 0;
+        std::lock_guard<std::mutex> lock(s.assetMutex);
+        s.pendingAssets.clear();
+    }
+
+    bool HitchDetector::enabled()
+    {
+        return GetState().enabled.load(std::memory_order_relaxed);
+    }
+
+    uint32_t HitchDetector::dumpsWritten()
+    {
+        return GetState().dumps;
+    }
+
+    void HitchDetector::assetEvent(const char *category, const std::string &name, uint64_t startNs, uint64_t endNs)
+    {
+        DetectorState &s = GetState();
+        if (!s.enabled.load(std::memory_order_relaxed))
+            return;
+        std::lock_guard<std::mutex> lock(s.assetMutex);
+        s.pendingAssets.push_back(AssetEvent{category, name, startNs, endNs});
+    }
+
+    bool HitchDetector::addFrame(const FrameInfo &info, const Profiler::Frame &cpu, const std::vector<TraceCapture::GpuSpan> &gpu)
+    {
+        DetectorState &s = GetState();
+        if (!s.enabled.load(std::memory_order_relaxed) || s.ring.empty())
+            return false;
+
+        // Copy-assigning into the reused record keeps its buffers' capacity
+        Record &r = s.ring[s.next];
+        r.frame = s.frameIndex++;
+        r.info = info;
+        for (size_t c = 0; c < MemoryTracker::kCategoryCount; ++c)
+            r.cpuBytes[c] = MemoryTracker::current(static_cast<CpuMemoryCategory>(c));
+        r.render = RenderStats::lastFrame().total;
+        r.heap = AllocTracker::lastFrame();
+        r.cpu = cpu;
+        r.gpu.clear();
+        const uint64_t gpuFrameNs = gpu.empty() ? 0 : gpu.front().startNs;
+        if (gpuFrameNs != 0 && gpuFrameNs != s.lastGpuFrameNs)
+        {
+            s.lastGpuFrameNs = gpuFrameNs;
+            r.gpu = gpu;
+        }
+        r.assets.clear();
+        {
+            std::lock_guard<std::mutex> lock(s.assetMutex);
+            r.assets.swap(s.pendingAssets);
+        }
+        s.next = (s.next + 1) % s.ring.size();
+        s.count = std::min(s.count + 1, s.ring.size());
+
+        const bool measured = !s.skipNext;
+        s.skipNext = false;
+        r.medianMs = Median_Internal(s);
+        r.hitch = measured && r.medianMs > 0.0f && info.frameMs >= s.config.minHitchMs &&
+                  info.frameMs > s.config.threshold * r.medianMs;
+        if (measured)
+            PushFrameTime_Internal(s, info.frameMs);
+        if (s.cooldown > 0)
+            --s.cooldown;
+
+        // A hitch starts a capture; further hitches before the dump only get marked in it
+        if (s.framesLeft == 0)
+        {
+            if (!r.hitch || s.cooldown > 0 || s.dumps >= s.config.maxDumps)
+                return false;
+            s.hitchFrame = r.frame;
+            s.framesLeft = s.config.framesAfter + 1u;
+        }
+        if (--s.framesLeft > 0)
+            return false;
+
+        Dump_Internal(s);
+        ++s.dumps;
+        s.cooldown = s.config.cooldownFrames;
+        s.skipNext = true;
+        if (s.dumps >= s.config.maxDumps)
+        {
+            ENGINE_LOG_INFO("[HitchDetector] Wrote %u dumps, stopping", s.dumps);
+            disable();
+        }
+        return true;
+    }
+
+} // namespace Engine
@@ -1,6 +1,7 @@
 #include "Engine/ImGuiLayer.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/Window.h"
+#include "utils/PipelineCache.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -49,7 +50,7 @@ namespace Engine
         initInfo.Device = ctx.GetDevice();
         initInfo.QueueFamily = ctx.GetGraphicsQueueFamilyIndex();
         initInfo.Queue = ctx.GetGraphicsQueue();
-        initInfo.PipelineCache = VK_NULL_HANDLE;
+        initInfo.PipelineCache = PipelineCache::HandleFor(ctx.GetDevice());
         initInfo.DescriptorPool = m_descriptorPool;
         initInfo.Subpass = 0;
         initInfo.MinImageCount = imageCount;
@@ -1,39 +1,38 @@
 #include "utils/ImageUtils.h"
+#include <algorithm>
 #include <cstring>
-#include <stdexcept>
 
 namespace Engine
 {
     // ============================================================
-    // Memory helper
+    // Staging buffer
     // ============================================================
 
-    static uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeBits, VkMemoryPropertyFlags props)
+    VkResult CreateStagingBuffer(
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        const void *dataBytes,
+        VkDeviceSize dataSize,
+        StagingBufferHandle &out)
     {
-        VkPhysicalDeviceMemoryProperties memProps{};
-        vkGetPhysicalDeviceMemoryProperties(phys, &memProps);
+        if (!dataBytes || dataSize == 0)
+            return VK_ERROR_INITIALIZATION_FAILED;
 
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-        {
-            if ((typeBits & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & props) == props)
-                return i;
-        }
+        VkResult r = CreateStagingBuffer(device, physicalDevice, dataSize, out);
+        if (r != VK_SUCCESS)
+            return r;
 
-        throw std::runtime_error("ImageUtils: failed to find suitable memory type");
+        std::memcpy(out.memory.mapped, dataBytes, static_cast<size_t>(dataSize));
+        return VK_SUCCESS;
     }
 
-    // ============================================================
-    // Staging buffer
-    // ============================================================
-
     VkResult CreateStagingBuffer(
         VkDevice device,
-        VkPhysicalDevice physicalDevice,
-        const void *dataBytes,
+        VkPhysicalDevice /*physicalDevice*/,
         VkDeviceSize dataSize,
         StagingBufferHandle &out)
     {
-        if (!dataBytes || dataSize == 0)
+        if (dataSize == 0)
             return VK_ERROR_INITIALIZATION_FAILED;
 
         VkBufferCreateInfo bi{};
@@ -46,17 +45,8 @@ namespace Engine
         if (r != VK_SUCCESS)
             return r;
 
-        VkMemoryRequirements req{};
-        vkGetBufferMemoryRequirements(device, out.buffer, &req);
-
-        VkMemoryAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        ai.allocationSize = req.size;
-        ai.memoryTypeIndex = findMemoryType(
-            physicalDevice, req.memoryTypeBits,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        r = vkAllocateMemory(device, &ai, nullptr, &out.memory);
+        r = AllocateBufferMemory(device, out.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 out.memory, MemoryStrategy::Linear, MemoryCategory::Staging);
         if (r != VK_SUCCESS)
         {
             vkDestroyBuffer(device, out.buffer, nullptr);
@@ -64,24 +54,6 @@ namespace Engine
             return r;
         }
 
-        r = vkBindBufferMemory(device, out.buffer, out.memory, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyBuffer(device, out.buffer, nullptr);
-            vkFreeMemory(device, out.memory, nullptr);
-            out.buffer = VK_NULL_HANDLE;
-            out.memory = VK_NULL_HANDLE;
-            return r;
-        }
-
-        void *mapped = nullptr;
-        r = vkMapMemory(device, out.memory, 0, dataSize, 0, &mapped);
-        if (r != VK_SUCCESS)
-            return r;
-
-        std::memcpy(mapped, dataBytes, static_cast<size_t>(dataSize));
-        vkUnmapMemory(device, out.memory);
-
         out.size = dataSize;
         return VK_SUCCESS;
     }
@@ -93,11 +65,7 @@ namespace Engine
             vkDestroyBuffer(device, h.buffer, nullptr);
             h.buffer = VK_NULL_HANDLE;
         }
-        if (h.memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, h.memory, nullptr);
-            h.memory = VK_NULL_HANDLE;
-        }
+        FreeMemory(h.memory);
         h.size = 0;
     }
 
@@ -105,55 +73,178 @@ namespace Engine
     // UploadContext
     // ============================================================
 
+    // Allocates and begins one primary one-time-submit command buffer.
+    static bool beginOneTimeCommands(VkDevice device, VkCommandPool pool, VkCommandBuffer &outCmd)
+    {
+        VkCommandBufferAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc.commandPool = pool;
+        alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc.commandBufferCount = 1;
+
+        VkResult r = vkAllocateCommandBuffers(device, &alloc, &outCmd);
+        if (r != VK_SUCCESS)
+        {
+            outCmd = VK_NULL_HANDLE;
+            return false;
+        }
+
+        VkCommandBufferBeginInfo begin{};
+        begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        r = vkBeginCommandBuffer(outCmd, &begin);
+        if (r != VK_SUCCESS)
+        {
+            vkFreeCommandBuffers(device, pool, 1, &outCmd);
+            outCmd = VK_NULL_HANDLE;
+            return false;
+        }
+        return true;
+    }
+
     bool BeginUploadContext(
         UploadContext &ctx,
         VkDevice device,
         VkPhysicalDevice physicalDevice,
         VkCommandPool commandPool,
         VkQueue queue)
+    {
+        return BeginUploadContext(ctx, device, physicalDevice, commandPool, queue, VK_QUEUE_FAMILY_IGNORED,
+                                  VK_NULL_HANDLE, VK_NULL_HANDLE, VK_QUEUE_FAMILY_IGNORED);
+    }
+
+    bool BeginUploadContext(
+        UploadContext &ctx,
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        VkCommandPool commandPool,
+        VkQueue queue,
+        uint32_t graphicsFamily,
+        VkCommandPool transferPool,
+        VkQueue transferQueue,
+        uint32_t transferFamily)
     {
         ctx.device = device;
         ctx.physicalDevice = physicalDevice;
         ctx.commandPool = commandPool;
         ctx.queue = queue;
+        ctx.transferPool = VK_NULL_HANDLE;
+        ctx.transferQueue = VK_NULL_HANDLE;
+        ctx.transferCmd = VK_NULL_HANDLE;
+        ctx.transferFamily = VK_QUEUE_FAMILY_IGNORED;
+        ctx.graphicsFamily = VK_QUEUE_FAMILY_IGNORED;
         ctx.pendingStaging.clear();
+        ctx.stagingBlock = SIZE_MAX;
+        ctx.stagingUsed = 0;
+        ctx.fence = VK_NULL_HANDLE;
+        ctx.copiedSemaphore = VK_NULL_HANDLE;
         ctx.begun = false;
+        ctx.submitted = false;
 
-        // Allocate one primary command buffer
-        VkCommandBufferAllocateInfo alloc{};
-        alloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        alloc.commandPool = commandPool;
-        alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        alloc.commandBufferCount = 1;
+        if (!beginOneTimeCommands(device, commandPool, ctx.cmd))
+            return false;
 
-        VkResult r = vkAllocateCommandBuffers(device, &alloc, &ctx.cmd);
-        if (r != VK_SUCCESS)
+        // Copies on the dedicated transfer queue; without its command buffer they stay in cmd.
+        const bool dedicated = transferQueue != VK_NULL_HANDLE && transferPool != VK_NULL_HANDLE &&
+                               transferFamily != VK_QUEUE_FAMILY_IGNORED && transferFamily != graphicsFamily;
+        if (dedicated && beginOneTimeCommands(device, transferPool, ctx.transferCmd))
+        {
+            ctx.transferPool = transferPool;
+            ctx.transferQueue = transferQueue;
+            ctx.transferFamily = transferFamily;
+            ctx.graphicsFamily = graphicsFamily;
+        }
+
+        ctx.begun = true;
+        return true;
+    }
+
+    // Where staging copies are recorded.
+    static VkCommandBuffer copyCommands(const UploadContext &ctx)
+    {
+        return (ctx.transferCmd != VK_NULL_HANDLE) ? ctx.transferCmd : ctx.cmd;
+    }
+
+    static void freeTransferCommands(UploadContext &ctx)
+    {
+        if (ctx.transferCmd != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(ctx.device, ctx.transferPool, 1, &ctx.transferCmd);
+        ctx.transferCmd = VK_NULL_HANDLE;
+    }
+
+    // Staging slices: 16-byte aligned, a multiple of every texel block size copied here.
+    static constexpr VkDeviceSize kStagingSliceAlignment = 16;
+
+    // Makes a block of at least 'size' bytes current (the old one keeps its slices until FinishUpload()).
+    static bool beginStagingBlock(UploadContext &ctx, VkDeviceSize size)
+    {
+        StagingBufferHandle block{};
+        if (CreateStagingBuffer(ctx.device, ctx.physicalDevice, std::max(size, kUploadStagingBlockSize), block) != VK_SUCCESS)
             return false;
+        ctx.pendingStaging.push_back(block);
+        ctx.stagingBlock = ctx.pendingStaging.size() - 1;
+        ctx.stagingUsed = 0;
+        return true;
+    }
 
-        VkCommandBufferBeginInfo begin{};
-        begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    bool ReserveStaging(UploadContext &ctx, VkDeviceSize bytes)
+    {
+        if (!ctx.begun || ctx.stagingBlock != SIZE_MAX || bytes == 0)
+            return false;
+        return beginStagingBlock(ctx, bytes);
+    }
 
-        r = vkBeginCommandBuffer(ctx.cmd, &begin);
-        if (r != VK_SUCCESS)
-        {
-            vkFreeCommandBuffers(device, commandPool, 1, &ctx.cmd);
-            ctx.cmd = VK_NULL_HANDLE;
+    bool AllocateStaging(UploadContext &ctx, VkDeviceSize size, StagingSlice &out)
+    {
+        if (!ctx.begun || ctx.submitted || size == 0)
             return false;
+
+        VkDeviceSize offset = (ctx.stagingUsed + kStagingSliceAlignment - 1) & ~(kStagingSliceAlignment - 1);
+        if (ctx.stagingBlock == SIZE_MAX || offset + size > ctx.pendingStaging[ctx.stagingBlock].size)
+        {
+            if (!beginStagingBlock(ctx, size))
+                return false;
+            offset = 0;
         }
 
-        ctx.begun = true;
+        const StagingBufferHandle &block = ctx.pendingStaging[ctx.stagingBlock];
+        out.buffer = block.buffer;
+        out.offset = offset;
+        out.mapped = static_cast<uint8_t *>(block.memory.mapped) + offset;
+        ctx.stagingUsed = offset + size;
+        return true;
+    }
+
+    bool StageBytes(UploadContext &ctx, const void *data, VkDeviceSize size, StagingSlice &out)
+    {
+        if (!data || !AllocateStaging(ctx, size, out))
+            return false;
+        std::memcpy(out.mapped, data, static_cast<size_t>(size));
         return true;
     }
 
     bool EndSubmitAndWait(UploadContext &ctx)
     {
-        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE)
+        if (!EndSubmit(ctx))
+            return false;
+        // Wait once for the whole model upload
+        return FinishUpload(ctx);
+    }
+
+    bool EndSubmit(UploadContext &ctx)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE || ctx.submitted)
             return false;
 
         VkResult r = vkEndCommandBuffer(ctx.cmd);
+        if (r == VK_SUCCESS && ctx.transferCmd != VK_NULL_HANDLE)
+            r = vkEndCommandBuffer(ctx.transferCmd);
         if (r != VK_SUCCESS)
+        {
+            freeTransferCommands(ctx);
             return false;
+        }
 
         // Fence so we can wait for completion (better than queueWaitIdle spam)
         VkFence fence = VK_NULL_HANDLE;
@@ -161,23 +252,86 @@ namespace Engine
         fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
         r = vkCreateFence(ctx.device, &fi, nullptr, &fence);
         if (r != VK_SUCCESS)
+        {
+            freeTransferCommands(ctx);
             return false;
+        }
+
+        // The copies first, on the transfer queue; the graphics work waits for them at its transfer
+        // stage (the ownership acquires, then blits and transitions).
+        VkSemaphore copied = VK_NULL_HANDLE;
+        if (ctx.transferCmd != VK_NULL_HANDLE)
+        {
+            VkSemaphoreCreateInfo si{};
+            si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            r = vkCreateSemaphore(ctx.device, &si, nullptr, &copied);
+            if (r == VK_SUCCESS)
+            {
+                VkSubmitInfo transferSubmit{};
+                transferSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                transferSubmit.commandBufferCount = 1;
+                transferSubmit.pCommandBuffers = &ctx.transferCmd;
+                transferSubmit.signalSemaphoreCount = 1;
+                transferSubmit.pSignalSemaphores = &copied;
+                r = vkQueueSubmit(ctx.transferQueue, 1, &transferSubmit, VK_NULL_HANDLE);
+            }
+            if (r != VK_SUCCESS)
+            {
+                if (copied != VK_NULL_HANDLE)
+                    vkDestroySemaphore(ctx.device, copied, nullptr);
+                vkDestroyFence(ctx.device, fence, nullptr);
+                freeTransferCommands(ctx);
+                return false;
+            }
+        }
 
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
         VkSubmitInfo submit{};
         submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.waitSemaphoreCount = (copied != VK_NULL_HANDLE) ? 1u : 0u;
+        submit.pWaitSemaphores = &copied;
+        submit.pWaitDstStageMask = &waitStage;
         submit.commandBufferCount = 1;
         submit.pCommandBuffers = &ctx.cmd;
 
         r = vkQueueSubmit(ctx.queue, 1, &submit, fence);
         if (r != VK_SUCCESS)
         {
+            // The transfer submit may still be running: nothing it uses can go before it is done.
+            if (copied != VK_NULL_HANDLE)
+            {
+                vkQueueWaitIdle(ctx.transferQueue);
+                vkDestroySemaphore(ctx.device, copied, nullptr);
+            }
             vkDestroyFence(ctx.device, fence, nullptr);
+            freeTransferCommands(ctx);
             return false;
         }
 
-        // Wait once for the whole model upload
-        r = vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(ctx.device, fence, nullptr);
+        ctx.fence = fence;
+        ctx.copiedSemaphore = copied;
+        ctx.submitted = true;
+        return true;
+    }
+
+    bool IsUploadComplete(const UploadContext &ctx)
+    {
+        return ctx.submitted && vkGetFenceStatus(ctx.device, ctx.fence) == VK_SUCCESS;
+    }
+
+    bool FinishUpload(UploadContext &ctx)
+    {
+        if (!ctx.submitted)
+            return false;
+
+        VkResult r = vkWaitForFences(ctx.device, 1, &ctx.fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(ctx.device, ctx.fence, nullptr);
+        ctx.fence = VK_NULL_HANDLE;
+        if (ctx.copiedSemaphore != VK_NULL_HANDLE)
+            vkDestroySemaphore(ctx.device, ctx.copiedSemaphore, nullptr);
+        ctx.copiedSemaphore = VK_NULL_HANDLE;
+        freeTransferCommands(ctx);
+        ctx.submitted = false;
 
         if (r != VK_SUCCESS)
             return false;
@@ -186,6 +340,8 @@ namespace Engine
         for (auto &sb : ctx.pendingStaging)
             DestroyStagingBuffer(ctx.device, sb);
         ctx.pendingStaging.clear();
+        ctx.stagingBlock = SIZE_MAX;
+        ctx.stagingUsed = 0;
 
         // Free command buffer
         vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &ctx.cmd);
@@ -207,21 +363,23 @@ namespace Engine
         VkFormat format,
         VkImageUsageFlags usage,
         VkImage &outImage,
-        VkDeviceMemory &outMemory)
+        MemoryAllocation &outMemory,
+        MemoryCategory category)
     {
-        return CreateImage2D(device, physicalDevice, width, height, format, usage, 1u, outImage, outMemory);
+        return CreateImage2D(device, physicalDevice, width, height, format, usage, 1u, outImage, outMemory, category);
     }
 
     VkResult CreateImage2D(
         VkDevice device,
-        VkPhysicalDevice physicalDevice,
+        VkPhysicalDevice /*physicalDevice*/,
         uint32_t width,
         uint32_t height,
         VkFormat format,
         VkImageUsageFlags usage,
         uint32_t mipLevels,
         VkImage &outImage,
-        VkDeviceMemory &outMemory)
+        MemoryAllocation &outMemory,
+        MemoryCategory category)
     {
         VkImageCreateInfo ii{};
         ii.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -242,15 +400,8 @@ namespace Engine
         if (r != VK_SUCCESS)
             return r;
 
-        VkMemoryRequirements req{};
-        vkGetImageMemoryRequirements(device, outImage, &req);
-
-        VkMemoryAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        ai.allocationSize = req.size;
-        ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        r = vkAllocateMemory(device, &ai, nullptr, &outMemory);
+        // Large images (render targets, big textures) get dedicated memory inside the allocator.
+        r = AllocateImageMemory(device, outImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outMemory, category);
         if (r != VK_SUCCESS)
         {
             vkDestroyImage(device, outImage, nullptr);
@@ -258,16 +409,6 @@ namespace Engine
             return r;
         }
 
-        r = vkBindImageMemory(device, outImage, outMemory, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyImage(device, outImage, nullptr);
-            vkFreeMemory(device, outMemory, nullptr);
-            outImage = VK_NULL_HANDLE;
-            outMemory = VK_NULL_HANDLE;
-            return r;
-        }
-
         return VK_SUCCESS;
     }
 
@@ -354,6 +495,17 @@ namespace Engine
         VkImageLayout oldLayout,
         VkImageLayout newLayout,
         VkImageAspectFlags aspectFlags)
+    {
+        CmdTransitionImageLayout(ctx, image, oldLayout, newLayout, aspectFlags, 1);
+    }
+
+    void CmdTransitionImageLayout(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageLayout oldLayout,
+        VkImageLayout newLayout,
+        VkImageAspectFlags aspectFlags,
+        uint32_t mipLevels)
     {
         VkImageMemoryBarrier barrier{};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -365,7 +517,7 @@ namespace Engine
 
         barrier.subresourceRange.aspectMask = aspectFlags;
         barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.levelCount = mipLevels;
         barrier.subresourceRange.baseArrayLayer = 0;
         barrier.subresourceRange.layerCount = 1;
 
@@ -376,8 +528,10 @@ namespace Engine
         barrier.srcAccessMask = srcAccess;
         barrier.dstAccessMask = dstAccess;
 
+        // Layouts for the staging copy go with the copy.
+        const bool forCopy = oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
         vkCmdPipelineBarrier(
-            ctx.cmd,
+            forCopy ? copyCommands(ctx) : ctx.cmd,
             srcStage,
             dstStage,
             0,
@@ -407,7 +561,7 @@ namespace Engine
         region.imageExtent = {width, height, 1};
 
         vkCmdCopyBufferToImage(
-            ctx.cmd,
+            copyCommands(ctx),
             buffer,
             image,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -415,6 +569,110 @@ namespace Engine
             &region);
     }
 
+    void CmdCopyBufferToImage(
+        UploadContext &ctx,
+        const StagingSlice &src,
+        VkImage image,
+        uint32_t width,
+        uint32_t height)
+    {
+        VkBufferImageCopy region{};
+        region.bufferOffset = src.offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {width, height, 1};
+
+        vkCmdCopyBufferToImage(copyCommands(ctx), src.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    void CmdCopyBuffer(
+        UploadContext &ctx,
+        const StagingSlice &src,
+        VkBuffer dst,
+        VkDeviceSize size,
+        VkDeviceSize dstOffset)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE || size == 0)
+            return;
+
+        VkBufferCopy region{};
+        region.srcOffset = src.offset;
+        region.dstOffset = dstOffset;
+        region.size = size;
+        vkCmdCopyBuffer(ctx.cmd, src.buffer, dst, 1, &region);
+    }
+
+    void CmdCopyMipChainToImage(
+        UploadContext &ctx,
+        const StagingSlice &src,
+        VkImage image,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevels,
+        uint32_t blockBytes)
+    {
+        std::vector<VkBufferImageCopy> regions(mipLevels);
+        VkDeviceSize offset = src.offset;
+        for (uint32_t mip = 0; mip < mipLevels; ++mip)
+        {
+            const uint32_t w = std::max(width >> mip, 1u);
+            const uint32_t h = std::max(height >> mip, 1u);
+            VkBufferImageCopy &region = regions[mip];
+            region.bufferOffset = offset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = mip;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = {w, h, 1};
+            offset += VkDeviceSize((w + 3) / 4) * ((h + 3) / 4) * blockBytes;
+        }
+
+        vkCmdCopyBufferToImage(copyCommands(ctx), src.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               mipLevels, regions.data());
+    }
+
+    void CmdAcquireUploadedImage(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageAspectFlags aspectFlags)
+    {
+        CmdAcquireUploadedImage(ctx, image, aspectFlags, 1);
+    }
+
+    void CmdAcquireUploadedImage(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageAspectFlags aspectFlags,
+        uint32_t mipLevels)
+    {
+        if (ctx.transferCmd == VK_NULL_HANDLE)
+            return;
+
+        // The same barrier on both queues: the release makes the copy available, the acquire
+        // (after the semaphore) makes it visible to the graphics queue's transfers and shaders.
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = ctx.transferFamily;
+        barrier.dstQueueFamilyIndex = ctx.graphicsFamily;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = aspectFlags;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(ctx.transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(ctx.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
     bool CmdGenerateMipmaps(
         UploadContext &ctx,
         VkImage image,
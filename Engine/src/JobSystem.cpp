@@ -0,0 +1,155 @@
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    static thread_local uint32_t t_threadIndex = 0;
+
+    JobSystem::JobSystem(uint32_t workerCount)
+    {
+        if (workerCount == UINT32_MAX)
+        {
+            const uint32_t hw = std::thread::hardware_concurrency();
+            workerCount = (hw > 1) ? (hw - 1) : 0;
+        }
+
+        m_queues.reserve(workerCount + 1);
+        for (uint32_t i = 0; i < workerCount + 1; ++i)
+            m_queues.emplace_back(std::make_unique<WorkerQueue>());
+
+        m_workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i)
+            m_workers.emplace_back([this, i]()
+                                   { workerLoop(i + 1); });
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop.store(true, std::memory_order_release);
+        }
+        m_sleepCv.notify_all();
+
+        for (auto &t : m_workers)
+        {
+            if (t.joinable())
+                t.join();
+        }
+    }
+
+    uint32_t JobSystem::currentThreadIndex()
+    {
+        return t_threadIndex;
+    }
+
+    void JobSystem::submit(Counter &counter, std::function<void()> job)
+    {
+        counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+        // Workers push onto their own deque; everyone else uses the shared queue 0.
+        const uint32_t qi = (t_threadIndex < m_queues.size()) ? t_threadIndex : 0u;
+        {
+            // The queued count is only touched under a queue lock, so it never underflows.
+            std::lock_guard<std::mutex> lock(m_queues[qi]->mutex);
+            m_queues[qi]->jobs.push_back(Job{std::move(job), &counter});
+            m_queuedJobs.fetch_add(1, std::memory_order_release);
+        }
+
+        {
+            // Sleepers re-check the predicate under this lock; taking it orders the wakeup.
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_sleepCv.notify_one();
+    }
+
+    bool JobSystem::popOrSteal(uint32_t queueIndex, Job &out)
+    {
+        // Own queue first (LIFO keeps recently produced data hot).
+        {
+            WorkerQueue &q = *m_queues[queueIndex];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.jobs.empty())
+            {
+                out = std::move(q.jobs.back());
+                q.jobs.pop_back();
+                m_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+
+        // Steal the oldest job from any other queue.
+        const uint32_t n = static_cast<uint32_t>(m_queues.size());
+        for (uint32_t k = 1; k < n; ++k)
+        {
+            WorkerQueue &q = *m_queues[(queueIndex + k) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.jobs.empty())
+            {
+                out = std::move(q.jobs.front());
+                q.jobs.pop_front();
+                m_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void JobSystem::execute(Job &job)
+    {
+        if (job.fn)
+            job.fn();
+
+        if (job.counter && job.counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            // Wake waiters blocked in wait(); taking the lock avoids a lost wakeup.
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_sleepCv.notify_all();
+        }
+    }
+
+    void JobSystem::workerLoop(uint32_t workerIndex)
+    {
+        t_threadIndex = workerIndex;
+
+        while (true)
+        {
+            Job job;
+            if (popOrSteal(workerIndex, job))
+            {
+                execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCv.wait(lock, [this]()
+                           { return m_stop.load(std::memory_order_acquire) ||
+                                    m_queuedJobs.load(std::memory_order_acquire) > 0; });
+            if (m_stop.load(std::memory_order_acquire))
+                return;
+        }
+    }
+
+    void JobSystem::wait(Counter &counter)
+    {
+        const uint32_t qi = (t_threadIndex < m_queues.size()) ? t_threadIndex : 0u;
+
+        while (!counter.done())
+        {
+            Job job;
+            if (popOrSteal(qi, job))
+            {
+                execute(job);
+                continue;
+            }
+
+            // Nothing to help with: sleep until new work arrives or the counter completes.
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCv.wait(lock, [&]()
+                           { return counter.done() ||
+                                    m_queuedJobs.load(std::memory_order_acquire) > 0; });
+        }
+    }
+
+} // namespace Engine
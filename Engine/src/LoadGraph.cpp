@@ -0,0 +1,179 @@
+#include "utils/LoadGraph.h"
+#include "utils/JobSystem.h"
+#include "utils/Log.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+
+namespace Engine
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double MsSince(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        enum class Result : uint8_t
+        {
+            Pending,
+            Ok,
+            Failed,
+            Skipped
+        };
+    } // namespace
+
+    LoadGraph::TaskId LoadGraph::add(std::string name, Affinity affinity, std::function<bool()> fn,
+                                     std::initializer_list<TaskId> dependencies)
+    {
+        const TaskId id = static_cast<TaskId>(m_tasks.size());
+        Task task;
+        task.name = std::move(name);
+        task.affinity = affinity;
+        task.fn = std::move(fn);
+        m_tasks.push_back(std::move(task));
+        for (TaskId dependency : dependencies)
+            addDependency(id, dependency);
+        return id;
+    }
+
+    void LoadGraph::addDependency(TaskId task, TaskId dependency)
+    {
+        if (task >= m_tasks.size() || dependency >= task)
+        {
+            ENGINE_LOG_ERROR("[LoadGraph] Invalid dependency %u -> %u", task, dependency);
+            return;
+        }
+        m_tasks[dependency].dependents.push_back(task);
+        ++m_tasks[task].dependencyCount;
+    }
+
+    bool LoadGraph::run(JobSystem &jobs)
+    {
+        const Clock::time_point start = Clock::now();
+        const size_t taskCount = m_tasks.size();
+        m_stats = Stats{};
+        m_stats.tasks = static_cast<uint32_t>(taskCount);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<TaskId> mainReady; // ready tasks for the calling thread
+        std::vector<Result> results(taskCount, Result::Pending);
+        std::vector<uint8_t> poisoned(taskCount, 0); // a dependency failed or was skipped
+        size_t finished = 0;
+        JobSystem::Counter counter;
+        const bool workersInline = jobs.workerCount() == 0;
+
+        std::function<void(TaskId)> schedule;
+        auto finish = [&](TaskId id, Result result, double ms)
+        {
+            std::vector<TaskId> ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                results[id] = result;
+                m_tasks[id].ms = ms;
+                for (TaskId dependent : m_tasks[id].dependents)
+                {
+                    if (result != Result::Ok)
+                        poisoned[dependent] = 1;
+                    if (--m_tasks[dependent].dependencyCount == 0)
+                        ready.push_back(dependent);
+                }
+                ++finished;
+            }
+            for (TaskId next : ready)
+                schedule(next);
+            cv.notify_all();
+        };
+
+        auto runTask = [&](TaskId id)
+        {
+            bool skip = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                skip = poisoned[id] != 0;
+            }
+            if (skip)
+            {
+                finish(id, Result::Skipped, 0.0);
+                return;
+            }
+
+            const Clock::time_point taskStart = Clock::now();
+            bool ok = false;
+            try
+            {
+                ok = !m_tasks[id].fn || m_tasks[id].fn();
+            }
+            catch (const std::exception &e)
+            {
+                ENGINE_LOG_ERROR("[LoadGraph] Task '%s' threw: %s", m_tasks[id].name.c_str(), e.what());
+            }
+            if (!ok)
+                ENGINE_LOG_WARN("[LoadGraph] Task '%s' failed", m_tasks[id].name.c_str());
+            finish(id, ok ? Result::Ok : Result::Failed, MsSince(taskStart));
+        };
+
+        schedule = [&](TaskId id)
+        {
+            if (m_tasks[id].affinity == Affinity::Main || workersInline)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                mainReady.push_back(id);
+                return;
+            }
+            jobs.submit(counter, [&runTask, id]()
+                        { runTask(id); });
+        };
+
+        std::vector<TaskId> roots;
+        for (TaskId id = 0; id < taskCount; ++id)
+        {
+            if (m_tasks[id].dependencyCount == 0)
+                roots.push_back(id);
+        }
+        for (TaskId id : roots)
+            schedule(id);
+
+        // Main-thread tasks as they become ready, until every task has finished
+        for (;;)
+        {
+            TaskId id = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]()
+                        { return !mainReady.empty() || finished == taskCount; });
+                if (mainReady.empty())
+                    break;
+                id = mainReady.front();
+                mainReady.pop_front();
+            }
+            runTask(id);
+        }
+        jobs.wait(counter);
+
+        const Task *slowest = nullptr;
+        for (TaskId id = 0; id < taskCount; ++id)
+        {
+            m_stats.failed += results[id] == Result::Failed ? 1u : 0u;
+            m_stats.skipped += results[id] == Result::Skipped ? 1u : 0u;
+            m_stats.taskMs += m_tasks[id].ms;
+            if (!slowest || m_tasks[id].ms > slowest->ms)
+                slowest = &m_tasks[id];
+        }
+        m_stats.wallMs = MsSince(start);
+
+        ENGINE_LOG_INFO("[LoadGraph] %u tasks in %.1f ms (%.1f ms of work, %u failed, %u skipped); slowest: %s (%.1f ms)",
+                        m_stats.tasks, m_stats.wallMs, m_stats.taskMs, m_stats.failed, m_stats.skipped,
+                        slowest ? slowest->name.c_str() : "-", slowest ? slowest->ms : 0.0);
+
+        m_tasks.clear();
+        return m_stats.failed == 0 && m_stats.skipped == 0;
+    }
+
+} // namespace Engine
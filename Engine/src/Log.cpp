@@ -0,0 +1,283 @@
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Engine::Log
+{
+    static_assert((kRingSlots & (kRingSlots - 1)) == 0, "kRingSlots must be a power of two");
+
+    namespace
+    {
+        constexpr auto kFlushInterval = std::chrono::milliseconds(5);
+
+        struct Slot
+        {
+            Level level = Level::Info;
+            uint16_t length = 0;
+            char text[kMessageBytes];
+        };
+
+        // Single producer (the owning thread), single consumer (whoever holds the drain lock).
+        struct Ring
+        {
+            alignas(64) std::atomic<uint32_t> head{0}; // written by the producer
+            alignas(64) std::atomic<uint32_t> tail{0}; // written by the consumer
+            std::atomic<uint64_t> dropped{0};
+            bool inUse = false; // guarded by Logger::m_registryMutex
+            Slot slots[kRingSlots];
+        };
+
+        class Logger
+        {
+        public:
+            Logger()
+            {
+                m_flusher = std::thread([this]()
+                                        { flusherLoop(); });
+            }
+
+            Ring *acquireRing()
+            {
+                std::lock_guard<std::mutex> lock(m_registryMutex);
+                for (auto &ring : m_rings)
+                {
+                    if (!ring->inUse)
+                    {
+                        ring->inUse = true;
+                        return ring.get();
+                    }
+                }
+                m_rings.emplace_back(std::make_unique<Ring>());
+                m_rings.back()->inUse = true;
+                return m_rings.back().get();
+            }
+
+            void releaseRing(Ring *ring)
+            {
+                std::lock_guard<std::mutex> lock(m_registryMutex);
+                ring->inUse = false;
+            }
+
+            void wake() { m_wakeCv.notify_one(); }
+
+            bool stopped() const { return m_stopped.load(std::memory_order_acquire); }
+
+            // Drain every ring into the console. Safe from any thread.
+            void drain()
+            {
+                std::lock_guard<std::mutex> drainLock(m_drainMutex);
+                {
+                    std::lock_guard<std::mutex> lock(m_registryMutex);
+                    m_drainList.clear();
+                    for (auto &ring : m_rings)
+                        m_drainList.push_back(ring.get());
+                }
+
+                m_out.clear();
+                m_err.clear();
+                for (Ring *ring : m_drainList)
+                {
+                    uint32_t t = ring->tail.load(std::memory_order_relaxed);
+                    const uint32_t h = ring->head.load(std::memory_order_acquire);
+                    for (; t != h; ++t)
+                    {
+                        const Slot &slot = ring->slots[t & (kRingSlots - 1)];
+                        std::string &dst = (slot.level >= Level::Warn) ? m_err : m_out;
+                        dst.append(slot.text, slot.length);
+                        dst.push_back('\n');
+                    }
+                    ring->tail.store(t, std::memory_order_release);
+
+                    const uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+                    if (dropped)
+                    {
+                        m_droppedTotal.fetch_add(dropped, std::memory_order_relaxed);
+                        char note[64];
+                        const int n = std::snprintf(note, sizeof(note), "[Log] %llu messages dropped (ring full)\n",
+                                                    static_cast<unsigned long long>(dropped));
+                        m_err.append(note, static_cast<size_t>(std::max(n, 0)));
+                    }
+                }
+
+                if (!m_out.empty())
+                {
+                    std::fwrite(m_out.data(), 1, m_out.size(), stdout);
+                    std::fflush(stdout);
+                }
+                if (!m_err.empty())
+                {
+                    std::fwrite(m_err.data(), 1, m_err.size(), stderr);
+                    std::fflush(stderr);
+                }
+            }
+
+            // Console write for messages logged after shutdown().
+            void writeDirect(Level lvl, const char *text, size_t length)
+            {
+                std::lock_guard<std::mutex> drainLock(m_drainMutex);
+                FILE *stream = (lvl >= Level::Warn) ? stderr : stdout;
+                std::fwrite(text, 1, length, stream);
+                std::fputc('\n', stream);
+                std::fflush(stream);
+            }
+
+            void shutdown()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_wakeMutex);
+                    if (m_stopped.exchange(true, std::memory_order_acq_rel))
+                        return;
+                }
+                m_wakeCv.notify_one();
+                if (m_flusher.joinable())
+                    m_flusher.join();
+                drain();
+            }
+
+            uint64_t droppedTotal() const { return m_droppedTotal.load(std::memory_order_relaxed); }
+
+        private:
+            void flusherLoop()
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                while (!m_stopped.load(std::memory_order_acquire))
+                {
+                    m_wakeCv.wait_for(lock, kFlushInterval);
+                    lock.unlock();
+                    drain();
+                    lock.lock();
+                }
+            }
+
+            std::mutex m_registryMutex;
+            std::vector<std::unique_ptr<Ring>> m_rings; // never shrinks; rings are reused
+
+            std::mutex m_drainMutex;
+            std::vector<Ring *> m_drainList;
+            std::string m_out, m_err;
+            std::atomic<uint64_t> m_droppedTotal{0};
+
+            std::mutex m_wakeMutex;
+            std::condition_variable m_wakeCv;
+            std::atomic<bool> m_stopped{false};
+            std::thread m_flusher;
+        };
+
+        std::atomic<bool> s_created{false};
+        std::atomic<uint8_t> s_level{0};
+
+        // Intentionally never destroyed: threads may log during static destruction.
+        Logger &logger()
+        {
+            static Logger *instance = []()
+            {
+                Logger *l = new Logger();
+                s_created.store(true, std::memory_order_release);
+                return l;
+            }();
+            return *instance;
+        }
+
+        // Returns the thread's ring to the pool when the thread exits.
+        struct ThreadRing
+        {
+            Ring *ring = nullptr;
+            ~ThreadRing()
+            {
+                if (ring)
+                    logger().releaseRing(ring);
+            }
+        };
+
+        thread_local ThreadRing t_ring;
+
+        // Final drain at exit (also covers std::exit()).
+        struct ExitFlush
+        {
+            ~ExitFlush() { shutdown(); }
+        } s_exitFlush;
+    } // namespace
+
+    void write(Level lvl, const char *fmt, ...)
+    {
+        if (static_cast<uint8_t>(lvl) < s_level.load(std::memory_order_relaxed) || lvl >= Level::Off)
+            return;
+
+        Logger &log = logger();
+        if (log.stopped())
+        {
+            char text[kMessageBytes];
+            va_list args;
+            va_start(args, fmt);
+            const int n = std::vsnprintf(text, sizeof(text), fmt, args);
+            va_end(args);
+            log.writeDirect(lvl, text, static_cast<size_t>(std::clamp(n, 0, int(kMessageBytes) - 1)));
+            return;
+        }
+
+        if (!t_ring.ring)
+            t_ring.ring = log.acquireRing();
+        Ring &ring = *t_ring.ring;
+
+        const uint32_t h = ring.head.load(std::memory_order_relaxed);
+        const uint32_t used = h - ring.tail.load(std::memory_order_acquire);
+        if (used >= kRingSlots)
+        {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Slot &slot = ring.slots[h & (kRingSlots - 1)];
+        va_list args;
+        va_start(args, fmt);
+        const int n = std::vsnprintf(slot.text, kMessageBytes, fmt, args);
+        va_end(args);
+        int length = std::clamp(n, 0, int(kMessageBytes) - 1);
+        if (length > 0 && slot.text[length - 1] == '\n') // the flusher terminates lines itself
+            --length;
+        slot.length = static_cast<uint16_t>(length);
+        slot.level = lvl;
+        ring.head.store(h + 1, std::memory_order_release);
+
+        // Errors and a half-full ring get drained now instead of on the next poll.
+        if (lvl >= Level::Error || used + 1 == kRingSlots / 2)
+            log.wake();
+    }
+
+    void setLevel(Level lvl)
+    {
+        s_level.store(static_cast<uint8_t>(lvl), std::memory_order_relaxed);
+    }
+
+    Level level()
+    {
+        return static_cast<Level>(s_level.load(std::memory_order_relaxed));
+    }
+
+    void flush()
+    {
+        logger().drain();
+    }
+
+    void shutdown()
+    {
+        if (s_created.load(std::memory_order_acquire))
+            logger().shutdown();
+    }
+
+    uint64_t droppedCount()
+    {
+        return s_created.load(std::memory_order_acquire) ? logger().droppedTotal() : 0;
+    }
+
+} // namespace Engine::Log
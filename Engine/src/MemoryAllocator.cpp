@@ -0,0 +1,804 @@
+#include "utils/MemoryAllocator.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t kNone = UINT32_MAX;
+
+        inline uint32_t lowestBit(uint32_t v)
+        {
+#if defined(_MSC_VER)
+            unsigned long i = 0;
+            _BitScanForward(&i, v);
+            return static_cast<uint32_t>(i);
+#else
+            return static_cast<uint32_t>(__builtin_ctz(v));
+#endif
+        }
+
+        inline uint32_t highestBit(uint64_t v)
+        {
+#if defined(_MSC_VER)
+            unsigned long i = 0;
+            _BitScanReverse64(&i, v);
+            return static_cast<uint32_t>(i);
+#else
+            return 63u - static_cast<uint32_t>(__builtin_clzll(v));
+#endif
+        }
+
+        inline VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+        {
+            return (v + alignment - 1) & ~(alignment - 1);
+        }
+
+        // Two-level segregated fit over one block's [0, size) range. First level: power of two
+        // size classes; second level: kSLCount linear subdivisions of each. Sizes below
+        // kSmallSize share first level 0. Physically adjacent free ranges are always merged, so a
+        // free node's neighbours are in use.
+        class Tlsf
+        {
+        public:
+            static constexpr uint32_t kAlignLog2 = 4; // 16-byte granularity
+            static constexpr VkDeviceSize kMinAlign = VkDeviceSize(1) << kAlignLog2;
+            static constexpr uint32_t kSLLog2 = 4;
+            static constexpr uint32_t kSLCount = 1u << kSLLog2;
+            static constexpr uint32_t kFLShift = kSLLog2 + kAlignLog2;
+            static constexpr VkDeviceSize kSmallSize = VkDeviceSize(1) << kFLShift;
+            static constexpr uint32_t kFLCount = 40 - kFLShift + 1; // blocks up to 1 TiB
+
+            void init(VkDeviceSize size)
+            {
+                m_nodes.clear();
+                m_spare.clear();
+                m_flBitmap = 0;
+                std::fill(std::begin(m_slBitmap), std::end(m_slBitmap), 0u);
+                for (auto &row : m_heads)
+                    std::fill(std::begin(row), std::end(row), kNone);
+
+                const uint32_t n = newNode();
+                m_nodes[n].offset = 0;
+                m_nodes[n].size = size & ~(kMinAlign - 1);
+                insertFree(n);
+            }
+
+            bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &outOffset, uint32_t &outNode)
+            {
+                size = alignUp(std::max(size, kMinAlign), kMinAlign);
+                alignment = std::max(alignment, kMinAlign);
+                // Offsets are kMinAlign multiples, so the front padding is at most alignment - kMinAlign.
+                const uint32_t n = findFree(size + (alignment - kMinAlign));
+                if (n == kNone)
+                    return false;
+                removeFree(n);
+
+                const VkDeviceSize aligned = alignUp(m_nodes[n].offset, alignment);
+                const VkDeviceSize pad = aligned - m_nodes[n].offset;
+                if (pad > 0)
+                {
+                    const uint32_t p = newNode();
+                    Node &node = m_nodes[n];
+                    Node &front = m_nodes[p];
+                    front.offset = node.offset;
+                    front.size = pad;
+                    front.prevPhys = node.prevPhys;
+                    front.nextPhys = n;
+                    if (node.prevPhys != kNone)
+                        m_nodes[node.prevPhys].nextPhys = p;
+                    node.prevPhys = p;
+                    node.offset = aligned;
+                    node.size -= pad;
+                    insertFree(p);
+                }
+                if (m_nodes[n].size - size >= kMinAlign)
+                {
+                    const uint32_t t = newNode();
+                    Node &node = m_nodes[n];
+                    Node &tail = m_nodes[t];
+                    tail.offset = node.offset + size;
+                    tail.size = node.size - size;
+                    tail.prevPhys = n;
+                    tail.nextPhys = node.nextPhys;
+                    if (node.nextPhys != kNone)
+                        m_nodes[node.nextPhys].prevPhys = t;
+                    node.nextPhys = t;
+                    node.size = size;
+                    insertFree(t);
+                }
+
+                m_nodes[n].free = false;
+                outOffset = m_nodes[n].offset;
+                outNode = n;
+                return true;
+            }
+
+            void free(uint32_t n)
+            {
+                if (n >= m_nodes.size() || m_nodes[n].free)
+                    return;
+                m_nodes[n].free = true;
+
+                const uint32_t prev = m_nodes[n].prevPhys;
+                if (prev != kNone && m_nodes[prev].free)
+                {
+                    removeFree(prev);
+                    absorbNext(prev);
+                    n = prev;
+                }
+                const uint32_t next = m_nodes[n].nextPhys;
+                if (next != kNone && m_nodes[next].free)
+                {
+                    removeFree(next);
+                    absorbNext(n);
+                }
+                insertFree(n);
+            }
+
+        private:
+            struct Node
+            {
+                VkDeviceSize offset = 0;
+                VkDeviceSize size = 0;
+                uint32_t prevPhys = kNone;
+                uint32_t nextPhys = kNone;
+                uint32_t prevFree = kNone;
+                uint32_t nextFree = kNone;
+                bool free = true;
+            };
+
+            static void mapping(VkDeviceSize size, uint32_t &fl, uint32_t &sl)
+            {
+                if (size < kSmallSize)
+                {
+                    fl = 0;
+                    sl = static_cast<uint32_t>(size / (kSmallSize / kSLCount));
+                }
+                else
+                {
+                    const uint32_t f = highestBit(size);
+                    sl = static_cast<uint32_t>(size >> (f - kSLLog2)) ^ kSLCount;
+                    fl = f - (kFLShift - 1);
+                }
+            }
+
+            // First free node of a class whose every member is >= size.
+            uint32_t findFree(VkDeviceSize size) const
+            {
+                if (size >= kSmallSize)
+                    size += (VkDeviceSize(1) << (highestBit(size) - kSLLog2)) - 1;
+                uint32_t fl = 0, sl = 0;
+                mapping(size, fl, sl);
+                if (fl >= kFLCount)
+                    return kNone;
+
+                uint32_t slMap = m_slBitmap[fl] & (~0u << sl);
+                if (slMap == 0)
+                {
+                    const uint32_t flMap = (fl + 1 < 32) ? (m_flBitmap & (~0u << (fl + 1))) : 0u;
+                    if (flMap == 0)
+                        return kNone;
+                    fl = lowestBit(flMap);
+                    slMap = m_slBitmap[fl];
+                }
+                return m_heads[fl][lowestBit(slMap)];
+            }
+
+            void insertFree(uint32_t n)
+            {
+                uint32_t fl = 0, sl = 0;
+                mapping(m_nodes[n].size, fl, sl);
+                Node &node = m_nodes[n];
+                node.free = true;
+                node.prevFree = kNone;
+                node.nextFree = m_heads[fl][sl];
+                if (node.nextFree != kNone)
+                    m_nodes[node.nextFree].prevFree = n;
+                m_heads[fl][sl] = n;
+                m_flBitmap |= 1u << fl;
+                m_slBitmap[fl] |= 1u << sl;
+            }
+
+            void removeFree(uint32_t n)
+            {
+                uint32_t fl = 0, sl = 0;
+                mapping(m_nodes[n].size, fl, sl);
+                Node &node = m_nodes[n];
+                if (node.prevFree != kNone)
+                    m_nodes[node.prevFree].nextFree = node.nextFree;
+                if (node.nextFree != kNone)
+                    m_nodes[node.nextFree].prevFree = node.prevFree;
+                if (m_heads[fl][sl] == n)
+                {
+                    m_heads[fl][sl] = node.nextFree;
+                    if (node.nextFree == kNone)
+                    {
+                        m_slBitmap[fl] &= ~(1u << sl);
+                        if (m_slBitmap[fl] == 0)
+                            m_flBitmap &= ~(1u << fl);
+                    }
+                }
+                node.prevFree = node.nextFree = kNone;
+            }
+
+            // Merges n's physical successor into n and recycles the successor's node.
+            void absorbNext(uint32_t n)
+            {
+                const uint32_t next = m_nodes[n].nextPhys;
+                m_nodes[n].size += m_nodes[next].size;
+                m_nodes[n].nextPhys = m_nodes[next].nextPhys;
+                if (m_nodes[n].nextPhys != kNone)
+                    m_nodes[m_nodes[n].nextPhys].prevPhys = n;
+                m_nodes[next] = Node{};
+                m_spare.push_back(next);
+            }
+
+            uint32_t newNode()
+            {
+                if (!m_spare.empty())
+                {
+                    const uint32_t n = m_spare.back();
+                    m_spare.pop_back();
+                    m_nodes[n] = Node{};
+                    return n;
+                }
+                m_nodes.push_back(Node{});
+                return static_cast<uint32_t>(m_nodes.size() - 1);
+            }
+
+            std::vector<Node> m_nodes;
+            std::vector<uint32_t> m_spare;
+            uint32_t m_flBitmap = 0;
+            uint32_t m_slBitmap[kFLCount] = {};
+            uint32_t m_heads[kFLCount][kSLCount];
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::pair<VkDevice, MemoryAllocator *>> entries;
+        };
+
+        Registry &registry()
+        {
+            static Registry r;
+            return r;
+        }
+    } // namespace
+
+    struct MemoryAllocator::Block
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        uint8_t *mapped = nullptr;
+        VkDeviceSize used = 0;
+        uint32_t liveCount = 0;
+        VkDeviceSize head = 0; // Linear
+        Tlsf tlsf;             // General
+    };
+
+    struct MemoryAllocator::Pool
+    {
+        uint32_t memoryType = 0;
+        bool isImage = false;
+        MemoryStrategy strategy = MemoryStrategy::General;
+        VkDeviceSize blockSize = 0;
+        std::vector<std::unique_ptr<Block>> blocks; // destroyed blocks leave null slots (indices are stable)
+    };
+
+    MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice phys)
+        : m_device(device), m_phys(phys)
+    {
+        vkGetPhysicalDeviceMemoryProperties(phys, &m_memoryProperties);
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(phys, &props);
+        m_maxAllocations = props.limits.maxMemoryAllocationCount;
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.entries.emplace_back(device, this);
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.entries.erase(std::remove_if(r.entries.begin(), r.entries.end(),
+                                           [this](const std::pair<VkDevice, MemoryAllocator *> &e)
+                                           { return e.second == this; }),
+                            r.entries.end());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint32_t leaked = m_dedicatedCount;
+        for (auto &pool : m_pools)
+        {
+            for (auto &block : pool->blocks)
+            {
+                if (!block)
+                    continue;
+                leaked += block->liveCount;
+                destroyBlock(*block);
+            }
+        }
+        if (leaked > 0)
+            ENGINE_LOG_WARN("[MemoryAllocator] %u allocations still live at shutdown", leaked);
+    }
+
+    MemoryAllocator *MemoryAllocator::ForDevice(VkDevice device)
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto &e : r.entries)
+        {
+            if (e.first == device)
+                return e.second;
+        }
+        return nullptr;
+    }
+
+    bool MemoryAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t &outType) const
+    {
+        for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+        {
+            if ((typeBits & (1u << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                outType = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool MemoryAllocator::isHostVisible(uint32_t memoryType) const
+    {
+        return (m_memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    }
+
+    uint32_t MemoryAllocator::poolFor(uint32_t memoryType, bool isImage, MemoryStrategy strategy)
+    {
+        for (uint32_t p = 0; p < static_cast<uint32_t>(m_pools.size()); ++p)
+        {
+            const Pool &pool = *m_pools[p];
+            if (pool.memoryType == memoryType && pool.isImage == isImage && pool.strategy == strategy)
+                return p;
+        }
+
+        auto pool = std::make_unique<Pool>();
+        pool->memoryType = memoryType;
+        pool->isImage = isImage;
+        pool->strategy = strategy;
+        // Small heaps (e.g. a 256 MB host-visible device-local window) get proportionally smaller blocks.
+        const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[memoryType].heapIndex].size;
+        const VkDeviceSize preferred = isHostVisible(memoryType) ? kHostVisibleBlockBytes : kDeviceLocalBlockBytes;
+        pool->blockSize = std::max<VkDeviceSize>(std::min(preferred, heapSize / 8), VkDeviceSize(1) << 20);
+        m_pools.push_back(std::move(pool));
+        return static_cast<uint32_t>(m_pools.size() - 1);
+    }
+
+    VkResult MemoryAllocator::createBlock(Pool &pool, VkDeviceSize minSize, uint32_t &outBlock)
+    {
+        VkMemoryAllocateInfo ai{};
+        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        ai.allocationSize = std::max(pool.blockSize, minSize);
+        ai.memoryTypeIndex = pool.memoryType;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkResult r = vkAllocateMemory(m_device, &ai, nullptr, &memory);
+        // Out of memory: retry with smaller blocks down to what this request needs.
+        while (r != VK_SUCCESS && ai.allocationSize / 2 >= minSize && ai.allocationSize / 2 >= (VkDeviceSize(1) << 20))
+        {
+            ai.allocationSize /= 2;
+            r = vkAllocateMemory(m_device, &ai, nullptr, &memory);
+        }
+        if (r != VK_SUCCESS)
+            return r;
+
+        void *mapped = nullptr;
+        if (isHostVisible(pool.memoryType))
+        {
+            r = vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+            if (r != VK_SUCCESS)
+            {
+                vkFreeMemory(m_device, memory, nullptr);
+                return r;
+            }
+        }
+
+        auto block = std::make_unique<Block>();
+        block->memory = memory;
+        block->size = ai.allocationSize;
+        block->mapped = static_cast<uint8_t *>(mapped);
+        if (pool.strategy == MemoryStrategy::General)
+            block->tlsf.init(block->size);
+
+        uint32_t slot = 0;
+        while (slot < pool.blocks.size() && pool.blocks[slot])
+            ++slot;
+        if (slot == pool.blocks.size())
+            pool.blocks.push_back(std::move(block));
+        else
+            pool.blocks[slot] = std::move(block);
+        outBlock = slot;
+        return VK_SUCCESS;
+    }
+
+    void MemoryAllocator::destroyBlock(Block &block)
+    {
+        if (block.mapped)
+            vkUnmapMemory(m_device, block.memory);
+        if (block.memory != VK_NULL_HANDLE)
+            vkFreeMemory(m_device, block.memory, nullptr);
+        block.memory = VK_NULL_HANDLE;
+        block.mapped = nullptr;
+    }
+
+    VkResult MemoryAllocator::allocateDedicated(VkDeviceSize size, uint32_t memoryType, MemoryAllocation &out)
+    {
+        VkMemoryAllocateInfo ai{};
+        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        ai.allocationSize = size;
+        ai.memoryTypeIndex = memoryType;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkResult r = vkAllocateMemory(m_device, &ai, nullptr, &memory);
+        if (r != VK_SUCCESS)
+            return r;
+
+        void *mapped = nullptr;
+        if (isHostVisible(memoryType))
+        {
+            r = vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+            if (r != VK_SUCCESS)
+            {
+                vkFreeMemory(m_device, memory, nullptr);
+                return r;
+            }
+        }
+
+        out = MemoryAllocation{};
+        out.memory = memory;
+        out.size = size;
+        out.mapped = mapped;
+        out.allocator = this;
+        out.block = memoryType; // dedicated: memory type, for stats
+        ++m_dedicatedCount;
+        m_dedicatedBytes += size;
+        m_dedicatedHeapBytes[m_memoryProperties.memoryTypes[memoryType].heapIndex] += size;
+        if (m_memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+            m_dedicatedDeviceLocalBytes += size;
+        return VK_SUCCESS;
+    }
+
+    VkResult MemoryAllocator::allocate(const VkMemoryRequirements &requirements,
+                                       VkMemoryPropertyFlags properties,
+                                       bool isImage,
+                                       MemoryStrategy strategy,
+                                       MemoryAllocation &out,
+                                       MemoryCategory category)
+    {
+        out = MemoryAllocation{};
+        uint32_t memoryType = 0;
+        if (!findMemoryType(requirements.memoryTypeBits, properties, memoryType))
+        {
+            ENGINE_LOG_ERROR("[MemoryAllocator] No memory type for bits 0x%x with properties 0x%x",
+                             requirements.memoryTypeBits, static_cast<uint32_t>(properties));
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint32_t poolIndex = poolFor(memoryType, isImage, strategy);
+        Pool &pool = *m_pools[poolIndex];
+        const VkDeviceSize size = requirements.size;
+        const VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+        if (size > pool.blockSize / 2 || (isImage && size >= kDedicatedImageBytes))
+        {
+            const VkResult r = allocateDedicated(size, memoryType, out);
+            if (r == VK_SUCCESS)
+            {
+                out.category = category;
+                trackAllocation(category, size);
+            }
+            return r;
+        }
+
+        uint32_t blockIndex = kNone;
+        VkDeviceSize offset = 0;
+        uint32_t node = 0;
+        auto tryBlock = [&](uint32_t b) -> bool
+        {
+            Block &block = *pool.blocks[b];
+            if (strategy == MemoryStrategy::General)
+                return block.tlsf.allocate(size, alignment, offset, node);
+            const VkDeviceSize start = alignUp(block.head, alignment);
+            if (start + size > block.size)
+                return false;
+            offset = start;
+            block.head = start + size;
+            return true;
+        };
+
+        for (uint32_t b = 0; b < static_cast<uint32_t>(pool.blocks.size()) && blockIndex == kNone; ++b)
+        {
+            if (pool.blocks[b] && tryBlock(b))
+                blockIndex = b;
+        }
+        if (blockIndex == kNone)
+        {
+            uint32_t b = 0;
+            const VkResult r = createBlock(pool, size + alignment, b);
+            if (r != VK_SUCCESS)
+                return r;
+            if (!tryBlock(b))
+                return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+            blockIndex = b;
+        }
+
+        Block &block = *pool.blocks[blockIndex];
+        block.used += size;
+        ++block.liveCount;
+
+        out.memory = block.memory;
+        out.offset = offset;
+        out.size = size;
+        out.mapped = block.mapped ? block.mapped + offset : nullptr;
+        out.allocator = this;
+        out.pool = poolIndex;
+        out.block = blockIndex;
+        out.node = node;
+        out.category = category;
+        trackAllocation(category, size);
+        return VK_SUCCESS;
+    }
+
+    void MemoryAllocator::trackAllocation(MemoryCategory category, VkDeviceSize size)
+    {
+        const size_t c = static_cast<size_t>(category);
+        m_categoryBytes[c] += size;
+        m_categoryPeakBytes[c] = std::max(m_categoryPeakBytes[c], m_categoryBytes[c]);
+    }
+
+    void MemoryAllocator::free(MemoryAllocation &allocation)
+    {
+        if (!allocation.isValid())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        VkDeviceSize &categoryBytes = m_categoryBytes[static_cast<size_t>(allocation.category)];
+        categoryBytes -= std::min(categoryBytes, allocation.size);
+        if (allocation.pool == kNone)
+        {
+            if (allocation.mapped)
+                vkUnmapMemory(m_device, allocation.memory);
+            vkFreeMemory(m_device, allocation.memory, nullptr);
+            --m_dedicatedCount;
+            m_dedicatedBytes -= allocation.size;
+            m_dedicatedHeapBytes[m_memoryProperties.memoryTypes[allocation.block].heapIndex] -= allocation.size;
+            if (m_memoryProperties.memoryTypes[allocation.block].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                m_dedicatedDeviceLocalBytes -= allocation.size;
+            allocation = MemoryAllocation{};
+            return;
+        }
+
+        if (allocation.pool >= m_pools.size())
+        {
+            allocation = MemoryAllocation{};
+            return;
+        }
+        Pool &pool = *m_pools[allocation.pool];
+        if (allocation.block >= pool.blocks.size() || !pool.blocks[allocation.block])
+        {
+            allocation = MemoryAllocation{};
+            return;
+        }
+
+        Block &block = *pool.blocks[allocation.block];
+        if (pool.strategy == MemoryStrategy::General)
+            block.tlsf.free(allocation.node);
+        block.used -= std::min(block.used, allocation.size);
+        if (block.liveCount > 0)
+            --block.liveCount;
+
+        if (block.liveCount == 0)
+        {
+            block.head = 0;
+            // Keep one empty block per pool so alloc/free cycles do not hit vkAllocateMemory.
+            bool otherEmpty = false;
+            for (uint32_t b = 0; b < static_cast<uint32_t>(pool.blocks.size()); ++b)
+            {
+                if (b != allocation.block && pool.blocks[b] && pool.blocks[b]->liveCount == 0)
+                    otherEmpty = true;
+            }
+            if (otherEmpty)
+            {
+                destroyBlock(block);
+                pool.blocks[allocation.block].reset();
+            }
+        }
+        allocation = MemoryAllocation{};
+    }
+
+    void MemoryAllocator::trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &pool : m_pools)
+        {
+            bool kept = false;
+            for (auto &block : pool->blocks)
+            {
+                if (!block || block->liveCount > 0)
+                    continue;
+                if (!kept)
+                {
+                    kept = true;
+                    continue;
+                }
+                destroyBlock(*block);
+                block.reset();
+            }
+        }
+    }
+
+    MemoryAllocator::Stats MemoryAllocator::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats s{};
+        s.maxDeviceAllocations = m_maxAllocations;
+        s.dedicatedCount = m_dedicatedCount;
+        s.dedicatedBytes = m_dedicatedBytes;
+        s.allocationCount = m_dedicatedCount;
+        s.usedBytes = m_dedicatedBytes;
+        s.deviceLocalBytes = m_dedicatedDeviceLocalBytes;
+        for (const auto &pool : m_pools)
+        {
+            const VkMemoryPropertyFlags flags = m_memoryProperties.memoryTypes[pool->memoryType].propertyFlags;
+            for (const auto &block : pool->blocks)
+            {
+                if (!block)
+                    continue;
+                ++s.blockCount;
+                s.blockBytes += block->size;
+                s.usedBytes += block->used;
+                s.allocationCount += block->liveCount;
+                if (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                    s.deviceLocalBytes += block->size;
+                if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+                    s.hostVisibleBytes += block->size;
+            }
+        }
+        s.deviceAllocations = s.blockCount + s.dedicatedCount;
+        std::copy(std::begin(m_categoryBytes), std::end(m_categoryBytes), std::begin(s.categoryBytes));
+        std::copy(std::begin(m_categoryPeakBytes), std::end(m_categoryPeakBytes), std::begin(s.categoryPeakBytes));
+        return s;
+    }
+
+    std::vector<MemoryAllocator::HeapBudget> MemoryAllocator::getHeapBudgets() const
+    {
+        std::vector<HeapBudget> heaps(m_memoryProperties.memoryHeapCount);
+        for (uint32_t h = 0; h < m_memoryProperties.memoryHeapCount; ++h)
+        {
+            heaps[h].size = m_memoryProperties.memoryHeaps[h].size;
+            heaps[h].budget = heaps[h].size;
+            heaps[h].deviceLocal = (m_memoryProperties.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        }
+
+#if defined(VK_EXT_memory_budget)
+        if (m_memoryBudget)
+        {
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+            budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+            VkPhysicalDeviceMemoryProperties2 props{};
+            props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            props.pNext = &budget;
+            vkGetPhysicalDeviceMemoryProperties2(m_phys, &props);
+            for (uint32_t h = 0; h < m_memoryProperties.memoryHeapCount; ++h)
+            {
+                heaps[h].budget = budget.heapBudget[h];
+                heaps[h].usage = budget.heapUsage[h];
+            }
+            return heaps;
+        }
+#endif
+
+        // No driver numbers: what this allocator holds in each heap
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto &pool : m_pools)
+        {
+            const uint32_t heap = m_memoryProperties.memoryTypes[pool->memoryType].heapIndex;
+            for (const auto &block : pool->blocks)
+            {
+                if (block)
+                    heaps[heap].usage += block->size;
+            }
+        }
+        for (uint32_t h = 0; h < m_memoryProperties.memoryHeapCount; ++h)
+            heaps[h].usage += m_dedicatedHeapBytes[h];
+        return heaps;
+    }
+
+    const char *MemoryCategoryName(MemoryCategory category)
+    {
+        switch (category)
+        {
+        case MemoryCategory::Geometry:
+            return "Geometry";
+        case MemoryCategory::Textures:
+            return "Textures";
+        case MemoryCategory::RenderTargets:
+            return "Render targets";
+        case MemoryCategory::Dynamic:
+            return "Per-frame dynamic";
+        case MemoryCategory::Staging:
+            return "Staging";
+        default:
+            return "Other";
+        }
+    }
+
+    VkResult AllocateBufferMemory(VkDevice device,
+                                  VkBuffer buffer,
+                                  VkMemoryPropertyFlags properties,
+                                  MemoryAllocation &out,
+                                  MemoryStrategy strategy,
+                                  MemoryCategory category)
+    {
+        out = MemoryAllocation{};
+        MemoryAllocator *allocator = MemoryAllocator::ForDevice(device);
+        if (!allocator || buffer == VK_NULL_HANDLE)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        VkMemoryRequirements req{};
+        vkGetBufferMemoryRequirements(device, buffer, &req);
+        VkResult r = allocator->allocate(req, properties, false, strategy, out, category);
+        if (r != VK_SUCCESS)
+            return r;
+
+        r = vkBindBufferMemory(device, buffer, out.memory, out.offset);
+        if (r != VK_SUCCESS)
+            allocator->free(out);
+        return r;
+    }
+
+    VkResult AllocateImageMemory(VkDevice device,
+                                 VkImage image,
+                                 VkMemoryPropertyFlags properties,
+                                 MemoryAllocation &out,
+                                 MemoryCategory category)
+    {
+        out = MemoryAllocation{};
+        MemoryAllocator *allocator = MemoryAllocator::ForDevice(device);
+        if (!allocator || image == VK_NULL_HANDLE)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        VkMemoryRequirements req{};
+        vkGetImageMemoryRequirements(device, image, &req);
+        VkResult r = allocator->allocate(req, properties, true, MemoryStrategy::General, out, category);
+        if (r != VK_SUCCESS)
+            return r;
+
+        r = vkBindImageMemory(device, image, out.memory, out.offset);
+        if (r != VK_SUCCESS)
+            allocator->free(out);
+        return r;
+    }
+
+    void FreeMemory(MemoryAllocation &allocation)
+    {
+        if (allocation.allocator)
+            allocation.allocator->free(allocation);
+        else
+            allocation = MemoryAllocation{};
+    }
+
+} // namespace Engine
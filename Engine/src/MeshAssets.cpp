@@ -1,4 +1,7 @@
 #include "assets/MeshAsset.h"
+#include "assets/MeshCodec.h"
+#include "utils/ImageUtils.h" // UploadContext
+#include <algorithm>
 #include <cstring>
 
 namespace Engine
@@ -8,120 +11,213 @@ namespace Engine
                            VkPhysicalDevice phys,
                            VkCommandPool commandPool,
                            VkQueue queue,
+                           GeometryArena &arena,
                            const MeshData &data)
     {
+        const VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(data.vertexBytes.size());
+        const uint32_t stride = data.vertexStride;
+        if (vertexBytes == 0 || stride == 0)
+            return false;
+
         // 1) Vertex: create host-visible staging buffer and fill it
         VertexBufferHandle stagingVB{};
         VkResult rv = CreateOrUpdateVertexBuffer(
             device, phys,
             data.vertexBytes.data(),
-            static_cast<VkDeviceSize>(data.vertexBytes.size()),
+            vertexBytes,
             stagingVB);
         if (rv != VK_SUCCESS)
             return false;
 
-        // 2) Vertex: create device-local destination and copy
-        VkBuffer dstVBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory dstVMemory = VK_NULL_HANDLE;
-        rv = CreateDeviceLocalBuffer(
-            device, phys,
-            static_cast<VkDeviceSize>(data.vertexBytes.size()),
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            dstVBuffer, dstVMemory);
-        if (rv != VK_SUCCESS)
+        // 2) Vertex: take a stride-aligned arena range and copy
+        GeometryArena::Range vertexRange = arena.allocate(GeometryArena::Vertex, vertexBytes, stride);
+        if (!vertexRange.isValid())
         {
             DestroyVertexBuffer(device, stagingVB);
             return false;
         }
+        const VkBuffer dstVBuffer = arena.getBuffer(GeometryArena::Vertex, vertexRange.block);
         rv = CopyBuffer(device, commandPool, queue,
                         stagingVB.buffer, dstVBuffer,
-                        static_cast<VkDeviceSize>(data.vertexBytes.size()));
+                        vertexBytes, vertexRange.offset);
         // Free staging after copy
         DestroyVertexBuffer(device, stagingVB);
         if (rv != VK_SUCCESS)
         {
-            vkDestroyBuffer(device, dstVBuffer, nullptr);
-            vkFreeMemory(device, dstVMemory, nullptr);
+            arena.free(GeometryArena::Vertex, vertexRange);
             return false;
         }
-        // Store device-local vertex buffer
-        m_vb.buffer = dstVBuffer;
-        m_vb.memory = dstVMemory;
 
         // 3) Index: create host-visible staging buffer and fill it
         IndexBufferHandle stagingIB{};
         VkDeviceSize indexBytes = 0;
+        VkDeviceSize indexSize = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
         if (data.indexFormat == 1)
         {
+            indexSize = sizeof(uint32_t);
             indexBytes = static_cast<VkDeviceSize>(data.indices32.size() * sizeof(uint32_t));
             rv = CreateOrUpdateIndexBuffer(
                 device, phys,
                 data.indices32.data(),
                 indexBytes,
                 stagingIB);
-            m_indexType = VK_INDEX_TYPE_UINT32;
-            m_indexCount = data.indexCount;
+            indexType = VK_INDEX_TYPE_UINT32;
         }
         else
         {
+            indexSize = sizeof(uint16_t);
             indexBytes = static_cast<VkDeviceSize>(data.indices16.size() * sizeof(uint16_t));
             rv = CreateOrUpdateIndexBuffer(
                 device, phys,
                 data.indices16.data(),
                 indexBytes,
                 stagingIB);
-            m_indexType = VK_INDEX_TYPE_UINT16;
-            m_indexCount = data.indexCount;
+            indexType = VK_INDEX_TYPE_UINT16;
         }
         if (rv != VK_SUCCESS)
         {
-            // Clean up vertex device-local resources
-            DestroyVertexBuffer(device, m_vb);
+            // Return the vertex range
+            arena.free(GeometryArena::Vertex, vertexRange);
             return false;
         }
 
-        // 4) Index: create device-local destination and copy
-        VkBuffer dstIBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory dstIMemory = VK_NULL_HANDLE;
-        rv = CreateDeviceLocalBuffer(
-            device, phys,
-            indexBytes,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            dstIBuffer, dstIMemory);
-        if (rv != VK_SUCCESS)
+        // 4) Index: take an index-aligned arena range and copy
+        GeometryArena::Range indexRange = arena.allocate(GeometryArena::Index, indexBytes, indexSize);
+        if (!indexRange.isValid())
         {
             DestroyIndexBuffer(device, stagingIB);
-            DestroyVertexBuffer(device, m_vb);
+            arena.free(GeometryArena::Vertex, vertexRange);
             return false;
         }
+        const VkBuffer dstIBuffer = arena.getBuffer(GeometryArena::Index, indexRange.block);
         rv = CopyBuffer(device, commandPool, queue,
                         stagingIB.buffer, dstIBuffer,
-                        indexBytes);
+                        indexBytes, indexRange.offset);
         // Free staging after copy
         DestroyIndexBuffer(device, stagingIB);
         if (rv != VK_SUCCESS)
         {
-            vkDestroyBuffer(device, dstIBuffer, nullptr);
-            vkFreeMemory(device, dstIMemory, nullptr);
-            DestroyVertexBuffer(device, m_vb);
+            arena.free(GeometryArena::Index, indexRange);
+            arena.free(GeometryArena::Vertex, vertexRange);
             return false;
         }
-        // Store device-local index buffer
-        m_ib.buffer = dstIBuffer;
-        m_ib.memory = dstIMemory;
 
-        // 5) Copy AABB
-        std::memcpy(m_aabbMin, data.aabbMin, sizeof(m_aabbMin));
-        std::memcpy(m_aabbMax, data.aabbMax, sizeof(m_aabbMax));
+        assignRanges(arena, vertexRange, indexRange, indexType, data);
+        return true;
+    }
+
+    bool MeshAsset::upload_Deferred(UploadContext &ctx, GeometryArena &arena, const MeshData &data)
+    {
+        const bool index32 = data.indexFormat == 1;
+        const void *indexData = index32 ? static_cast<const void *>(data.indices32.data()) : static_cast<const void *>(data.indices16.data());
+        const size_t indexCount = index32 ? data.indices32.size() : data.indices16.size();
+        if (data.vertexBytes.size() != static_cast<size_t>(data.vertexCount) * data.vertexStride || indexCount != data.indexCount)
+            return false;
+        return upload_Deferred(ctx, arena, data, data.vertexBytes.data(), indexData);
+    }
+
+    bool MeshAsset::upload_Deferred(UploadContext &ctx, GeometryArena &arena, const MeshData &data,
+                                    const void *vertexData, const void *indexData)
+    {
+        return upload_Deferred(ctx, arena, data, vertexData, 0, indexData, 0);
+    }
+
+    bool MeshAsset::upload_Deferred(UploadContext &ctx, GeometryArena &arena, const MeshData &data,
+                                    const void *vertexData, size_t vertexEncodedSize,
+                                    const void *indexData, size_t indexEncodedSize)
+    {
+        const uint32_t stride = data.vertexStride;
+        const VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(data.vertexCount) * stride;
+        if (!ctx.begun || vertexBytes == 0 || !vertexData || !indexData)
+            return false;
+
+        const bool index32 = data.indexFormat == 1;
+        const VkDeviceSize indexSize = index32 ? sizeof(uint32_t) : sizeof(uint16_t);
+        const VkDeviceSize indexBytes = static_cast<VkDeviceSize>(data.indexCount) * indexSize;
+
+        // Slices of the context's staging memory, alive until its upload has run; coded streams
+        // are decoded into them, raw ones copied
+        StagingSlice stagingVB{};
+        StagingSlice stagingIB{};
+        if (!AllocateStaging(ctx, vertexBytes, stagingVB) || !AllocateStaging(ctx, indexBytes, stagingIB))
+            return false;
+        if (vertexEncodedSize != 0)
+        {
+            if (!meshcodec::DecodeVertexBuffer(stagingVB.mapped, data.vertexCount, stride,
+                                               static_cast<const uint8_t *>(vertexData), vertexEncodedSize))
+                return false;
+        }
+        else
+            std::memcpy(stagingVB.mapped, vertexData, static_cast<size_t>(vertexBytes));
+        if (indexEncodedSize != 0)
+        {
+            if (!meshcodec::DecodeIndexBuffer(stagingIB.mapped, data.indexCount, static_cast<size_t>(indexSize),
+                                              static_cast<const uint8_t *>(indexData), indexEncodedSize))
+                return false;
+        }
+        else
+            std::memcpy(stagingIB.mapped, indexData, static_cast<size_t>(indexBytes));
+
+        GeometryArena::Range vertexRange = arena.allocate(GeometryArena::Vertex, vertexBytes, stride);
+        if (!vertexRange.isValid())
+            return false;
+        GeometryArena::Range indexRange = arena.allocate(GeometryArena::Index, indexBytes, indexSize);
+        if (!indexRange.isValid())
+        {
+            arena.free(GeometryArena::Vertex, vertexRange);
+            return false;
+        }
+
+        CmdCopyBuffer(ctx, stagingVB, arena.getBuffer(GeometryArena::Vertex, vertexRange.block), vertexBytes, vertexRange.offset);
+        CmdCopyBuffer(ctx, stagingIB, arena.getBuffer(GeometryArena::Index, indexRange.block), indexBytes, indexRange.offset);
 
+        assignRanges(arena, vertexRange, indexRange, index32 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16, data);
         return true;
     }
 
-    void MeshAsset::destroy(VkDevice device)
+    void MeshAsset::assignRanges(GeometryArena &arena, const GeometryArena::Range &vertexRange, const GeometryArena::Range &indexRange,
+                                 VkIndexType indexType, const MeshData &data)
     {
-        DestroyVertexBuffer(device, m_vb);
-        DestroyIndexBuffer(device, m_ib);
+        const VkDeviceSize indexSize = (indexType == VK_INDEX_TYPE_UINT32) ? sizeof(uint32_t) : sizeof(uint16_t);
+
+        // Store arena ranges and the draw offsets they imply
+        m_arena = &arena;
+        m_vertexRange = vertexRange;
+        m_indexRange = indexRange;
+        m_vb = arena.getBuffer(GeometryArena::Vertex, vertexRange.block);
+        m_ib = arena.getBuffer(GeometryArena::Index, indexRange.block);
+        m_indexType = indexType;
+        m_indexCount = data.indexCount;
+        m_firstIndex = static_cast<uint32_t>(indexRange.offset / indexSize);
+        m_vertexOffset = static_cast<int32_t>(vertexRange.offset / data.vertexStride);
+
+        // Copy AABB; compact positions span its longest axis (GltfToSmodel quantizes the same way)
+        std::memcpy(m_aabbMin, data.aabbMin, sizeof(m_aabbMin));
+        std::memcpy(m_aabbMax, data.aabbMax, sizeof(m_aabbMax));
+        m_compact = data.compactVertices;
+        float span = 0.0f;
+        for (int a = 0; a < 3; ++a)
+        {
+            m_positionDequant[a] = m_aabbMin[a];
+            span = std::max(span, m_aabbMax[a] - m_aabbMin[a]);
+        }
+        m_positionDequant[3] = span;
+    }
+
+    void MeshAsset::destroy()
+    {
+        if (m_arena)
+        {
+            m_arena->free(GeometryArena::Vertex, m_vertexRange);
+            m_arena->free(GeometryArena::Index, m_indexRange);
+        }
+        m_arena = nullptr;
+        m_vb = VK_NULL_HANDLE;
+        m_ib = VK_NULL_HANDLE;
         m_indexCount = 0;
+        m_firstIndex = 0;
+        m_vertexOffset = 0;
     }
 
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
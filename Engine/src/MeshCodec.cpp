@@ -0,0 +1,142 @@
+#include "assets/MeshCodec.h"
+
+#include <cstring>
+
+namespace Engine::meshcodec
+{
+    namespace
+    {
+        inline uint8_t Unzigzag8(uint8_t v)
+        {
+            return static_cast<uint8_t>((v >> 1) ^ (0u - (v & 1u)));
+        }
+
+        inline uint32_t Unzigzag32(uint32_t v)
+        {
+            return (v >> 1) ^ (0u - (v & 1u));
+        }
+
+        // One byte lane of a block: 'groups' groups of zigzagged deltas into 'out'. Returns the end
+        // of the lane's data, or nullptr when it runs past 'end'.
+        const uint8_t *DecodeLane(const uint8_t *src, const uint8_t *end, uint8_t *out, uint32_t groups)
+        {
+            const size_t headerBytes = (groups + 3u) / 4u;
+            if (size_t(end - src) < headerBytes)
+                return nullptr;
+            const uint8_t *header = src;
+            const uint8_t *data = src + headerBytes;
+
+            for (uint32_t g = 0; g < groups; ++g, out += kVertexGroupSize)
+            {
+                const uint32_t mode = (header[g / 4u] >> ((g % 4u) * 2u)) & 3u;
+                switch (mode)
+                {
+                case 0:
+                    std::memset(out, 0, kVertexGroupSize);
+                    break;
+                case 1:
+                    if (end - data < 4)
+                        return nullptr;
+                    for (uint32_t i = 0; i < kVertexGroupSize; ++i)
+                        out[i] = (data[i >> 2] >> ((i & 3u) * 2u)) & 3u;
+                    data += 4;
+                    break;
+                case 2:
+                    if (end - data < 8)
+                        return nullptr;
+                    for (uint32_t i = 0; i < kVertexGroupSize; ++i)
+                        out[i] = (data[i >> 1] >> ((i & 1u) * 4u)) & 15u;
+                    data += 8;
+                    break;
+                default:
+                    if (end - data < 16)
+                        return nullptr;
+                    std::memcpy(out, data, kVertexGroupSize);
+                    data += 16;
+                    break;
+                }
+            }
+            return data;
+        }
+    } // namespace
+
+    bool DecodeVertexBuffer(void *dst, size_t vertexCount, size_t stride, const uint8_t *src, size_t srcSize)
+    {
+        if ((!dst && vertexCount != 0) || !src || stride == 0 || stride > kMaxVertexStride || srcSize < 1 || src[0] != kVertexCodecHeader)
+            return false;
+        const uint8_t *end = src + srcSize;
+        ++src;
+
+        uint8_t *out = static_cast<uint8_t *>(dst);
+        const uint32_t blockSize = VertexBlockSize(static_cast<uint32_t>(stride));
+        uint8_t last[kMaxVertexStride] = {};
+        uint8_t deltas[kVertexBlockMaxVertices];
+        uint8_t block[kVertexBlockMaxBytes]; // VertexBlockSize() keeps a block within it
+
+        for (size_t begin = 0; begin < vertexCount; begin += blockSize)
+        {
+            const size_t count = (vertexCount - begin < blockSize) ? vertexCount - begin : blockSize;
+            const uint32_t groups = static_cast<uint32_t>((count + kVertexGroupSize - 1) / kVertexGroupSize);
+
+            // Lane by lane: the deltas of one byte are decoded together, then summed into the block
+            for (size_t k = 0; k < stride; ++k)
+            {
+                src = DecodeLane(src, end, deltas, groups);
+                if (!src)
+                    return false;
+
+                uint8_t value = last[k];
+                uint8_t *o = block + k;
+                for (size_t i = 0; i < count; ++i, o += stride)
+                {
+                    value = static_cast<uint8_t>(value + Unzigzag8(deltas[i]));
+                    *o = value;
+                }
+                last[k] = value;
+            }
+
+            // The block is built in cache; 'dst' (often write-combined staging memory) only sees
+            // one sequential copy
+            std::memcpy(out + begin * stride, block, count * stride);
+        }
+        return src == end;
+    }
+
+    bool DecodeIndexBuffer(void *dst, size_t indexCount, size_t indexSize, const uint8_t *src, size_t srcSize)
+    {
+        if ((!dst && indexCount != 0) || !src || (indexSize != 2 && indexSize != 4) || srcSize < 1 || src[0] != kIndexCodecHeader)
+            return false;
+        const uint8_t *end = src + srcSize;
+        ++src;
+
+        uint32_t last[2] = {0, 0};
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            // LEB128, at most 5 bytes (33 significant bits)
+            uint64_t v = 0;
+            for (uint32_t shift = 0;; shift += 7)
+            {
+                if (src == end || shift > 28)
+                    return false;
+                const uint8_t byte = *src++;
+                v |= uint64_t(byte & 0x7fu) << shift;
+                if ((byte & 0x80u) == 0)
+                    break;
+            }
+
+            const uint32_t baseline = static_cast<uint32_t>(v & 1u);
+            const uint32_t index = last[baseline] + Unzigzag32(static_cast<uint32_t>(v >> 1));
+            last[baseline] = index;
+
+            if (indexSize == 4)
+                std::memcpy(static_cast<uint8_t *>(dst) + i * 4, &index, 4);
+            else
+            {
+                const uint16_t index16 = static_cast<uint16_t>(index);
+                std::memcpy(static_cast<uint8_t *>(dst) + i * 2, &index16, 2);
+            }
+        }
+        return src == end;
+    }
+
+} // namespace Engine::meshcodec
@@ -2,9 +2,9 @@
 #include "Engine/Pipeline.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
-#include "Engine/PerformanceMonitor.h"
+#include "Engine/RenderStats.h"
+#include "utils/Log.h"
 #include <stdexcept>
-#include <iostream>
 
 namespace Engine
 {
@@ -154,7 +154,7 @@ namespace Engine
 
         if (m_binding.vertexBuffer == VK_NULL_HANDLE || m_binding.indexBuffer == VK_NULL_HANDLE || m_binding.indexCount == 0)
         {
-            std::cout << "MeshRenderPassModule: warning - no mesh bound or index count is zero, skipping draw\n";
+            ENGINE_LOG_WARN("MeshRenderPassModule: warning - no mesh bound or index count is zero, skipping draw");
             return;
         }
 
@@ -163,7 +163,14 @@ namespace Engine
         vkCmdBindIndexBuffer(cmd, m_binding.indexBuffer, m_binding.indexOffset, m_binding.indexType);
 
         vkCmdDrawIndexed(cmd, m_binding.indexCount, 1, 0, 0, 0);
-        DrawCallCounter::increment();
+
+        RenderCounters stats;
+        stats.drawCalls = 1;
+        stats.instances = 1;
+        stats.triangles = stats.visibleTriangles = m_binding.indexCount / 3;
+        stats.pipelineBinds = 1;
+        stats.bufferBinds = 2;
+        RenderStats::addPass(name(), stats);
     }
 
     void MeshRenderPassModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
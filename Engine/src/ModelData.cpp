@@ -0,0 +1,229 @@
+#include "assets/ModelData.h"
+
+// Needed for glm/gtx/* headers (matrix_decompose)
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine
+{
+    static constexpr float kFitTargetSize = 10.0f; // target size of models after scaling (fitScale)
+
+    static ModelAsset::NodeTRS DecomposeTRS_Internal(const glm::mat4 &m)
+    {
+        ModelAsset::NodeTRS out{};
+        glm::vec3 skew;
+        glm::vec4 perspective;
+        glm::decompose(m, out.s, out.r, out.t, skew, perspective);
+        out.r = glm::normalize(out.r);
+        return out;
+    }
+
+    // V2 node graph: records, child/primitive index tables, traversal order and globals.
+    void CopyModelNodes(const smodel::SModelFileView &view, ModelAsset &model)
+    {
+        if (view.nodeCount() == 0)
+            return;
+
+        model.nodes.resize(view.nodeCount());
+        model.nodePrimitiveIndices.resize(view.nodePrimitiveIndexCount());
+        model.nodeChildIndices.resize(view.nodeChildIndexCount());
+
+        // Copy primitive indices array
+        if (view.nodePrimitiveIndexCount() > 0 && view.nodePrimitiveIndices)
+        {
+            std::memcpy(model.nodePrimitiveIndices.data(), view.nodePrimitiveIndices, sizeof(uint32_t) * view.nodePrimitiveIndexCount());
+        }
+
+        // Copy child indices array
+        if (view.nodeChildIndexCount() > 0 && view.nodeChildIndices)
+        {
+            std::memcpy(model.nodeChildIndices.data(), view.nodeChildIndices, sizeof(uint32_t) * view.nodeChildIndexCount());
+        }
+
+        // Track first root (parentIndex == UINT32_MAX)
+        uint32_t rootIdx = 0;
+        const uint32_t U32_MAX = ~0u;
+
+        for (uint32_t i = 0; i < view.nodeCount(); ++i)
+        {
+            const Engine::smodel::SModelNodeRecord &nr = view.nodes[i];
+            ModelAsset::ModelNode &dst = model.nodes[i];
+
+            dst.parentIndex = nr.parentIndex;
+            dst.firstChildIndex = nr.childCount ? nr.firstChildIndex : U32_MAX;
+            dst.childCount = nr.childCount;
+            dst.firstPrimitiveIndex = nr.firstPrimitiveIndex;
+            dst.primitiveCount = nr.primitiveCount;
+            dst.debugName = view.getStringOrEmpty(nr.nameStrOffset);
+
+            // Copy local matrix (column-major)
+            std::memcpy(glm::value_ptr(dst.localMatrix), nr.localMatrix, sizeof(nr.localMatrix));
+
+            // Defer global computation; ordering is not guaranteed.
+            dst.globalMatrix = glm::mat4(1.0f);
+
+            if (nr.parentIndex == U32_MAX)
+                rootIdx = i;
+        }
+
+        model.rootNodeIndex = rootIdx;
+
+        // Compute globals in parents-before-children order (built from the child lists).
+        model.buildNodeOrder();
+        model.recomputeGlobals();
+    }
+
+    // V3 clips (node TRS only) and the rest pose they override; needs the nodes.
+    void CopyModelAnimations(const smodel::SModelFileView &view, ModelAsset &model)
+    {
+        if (view.animClipCount() > 0)
+        {
+            model.animClips.resize(view.animClipCount());
+            std::memcpy(model.animClips.data(), view.animClips, sizeof(smodel::SModelAnimationClipRecord) * view.animClipCount());
+        }
+        if (view.animChannelCount() > 0)
+        {
+            model.animChannels.resize(view.animChannelCount());
+            std::memcpy(model.animChannels.data(), view.animChannels, sizeof(smodel::SModelAnimationChannelRecord) * view.animChannelCount());
+        }
+        if (view.animSamplerCount() > 0)
+        {
+            model.animSamplers.resize(view.animSamplerCount());
+            std::memcpy(model.animSamplers.data(), view.animSamplers, sizeof(smodel::SModelAnimationSamplerRecord) * view.animSamplerCount());
+        }
+        if (view.animTimesCount() > 0)
+        {
+            model.animTimes.resize(view.animTimesCount());
+            std::memcpy(model.animTimes.data(), view.animTimes, sizeof(float) * view.animTimesCount());
+        }
+        if (view.animValuesCount() > 0)
+        {
+            model.animValues.resize(view.animValuesCount());
+            std::memcpy(model.animValues.data(), view.animValues, sizeof(float) * view.animValuesCount());
+        }
+
+        // --------------------------
+        // Initialize runtime animation TRS buffers from node local matrices
+        // --------------------------
+        model.restTRS.resize(model.nodes.size());
+        model.animatedTRS.resize(model.nodes.size());
+        for (size_t i = 0; i < model.nodes.size(); i++)
+        {
+            const glm::mat4 local = model.nodes[i].localMatrix;
+            model.restTRS[i] = DecomposeTRS_Internal(local);
+            model.animatedTRS[i] = model.restTRS[i];
+        }
+        model.normalizeRotationKeys();
+        model.buildPoseCache();
+    }
+
+    void ComputeModelBounds(ModelAsset &model, const std::vector<PrimitiveBounds> &primitives)
+    {
+        model.hasBounds = false;
+        model.fitScale = 1.0f;
+        for (int a = 0; a < 3; ++a)
+            model.center[a] = model.boundsMin[a] = model.boundsMax[a] = 0.0f;
+
+        // Union of the primitives' mesh boxes
+        for (const PrimitiveBounds &b : primitives)
+        {
+            if (!b.valid)
+                continue;
+            for (int a = 0; a < 3; ++a)
+            {
+                model.boundsMin[a] = model.hasBounds ? std::min(model.boundsMin[a], b.min[a]) : b.min[a];
+                model.boundsMax[a] = model.hasBounds ? std::max(model.boundsMax[a], b.max[a]) : b.max[a];
+            }
+            model.hasBounds = true;
+        }
+
+        auto fit = [&model](float fallbackScale)
+        {
+            float maxExtent = 0.0f;
+            for (int a = 0; a < 3; ++a)
+            {
+                model.center[a] = 0.5f * (model.boundsMin[a] + model.boundsMax[a]);
+                maxExtent = std::max(maxExtent, model.boundsMax[a] - model.boundsMin[a]);
+            }
+            const float epsilon = 1e-4f;
+            model.fitScale = (maxExtent > epsilon) ? (kFitTargetSize / maxExtent) : fallbackScale;
+        };
+        if (model.hasBounds)
+            fit(4.0f);
+
+        // Node graph: recompute in node-global space (node transforms applied)
+        bool firstCorner = true;
+        glm::vec3 bmin(0.0f);
+        glm::vec3 bmax(0.0f);
+        for (const auto &node : model.nodes)
+        {
+            for (uint32_t k = 0; k < node.primitiveCount; ++k)
+            {
+                const uint32_t primIndex = model.nodePrimitiveIndices[node.firstPrimitiveIndex + k];
+                if (primIndex >= primitives.size() || !primitives[primIndex].valid)
+                    continue;
+                const float *mn = primitives[primIndex].min;
+                const float *mx = primitives[primIndex].max;
+                for (uint32_t c = 0; c < 8; ++c)
+                {
+                    const glm::vec3 corner((c & 1) ? mx[0] : mn[0], (c & 2) ? mx[1] : mn[1], (c & 4) ? mx[2] : mn[2]);
+                    const glm::vec4 w = node.globalMatrix * glm::vec4(corner, 1.0f);
+                    const glm::vec3 p(w.x, w.y, w.z);
+                    bmin = firstCorner ? p : glm::min(bmin, p);
+                    bmax = firstCorner ? p : glm::max(bmax, p);
+                    firstCorner = false;
+                }
+            }
+        }
+        if (!firstCorner)
+        {
+            for (int a = 0; a < 3; ++a)
+            {
+                model.boundsMin[a] = bmin[a];
+                model.boundsMax[a] = bmax[a];
+            }
+            model.hasBounds = true;
+            fit(1.0f);
+        }
+    }
+
+    bool BuildModelPose(const smodel::SModelFileView &view, ModelAsset &out)
+    {
+        out = ModelAsset{};
+        if (view.nodeCount() == 0)
+            return false;
+        CopyModelNodes(view, out);
+        CopyModelAnimations(view, out);
+        return true;
+    }
+
+    bool BuildModelData(const smodel::SModelFileView &view, ModelAsset &out)
+    {
+        out = ModelAsset{};
+        if (view.nodeCount() == 0 && view.primitiveCount() == 0)
+            return false;
+
+        std::vector<PrimitiveBounds> bounds(view.primitiveCount());
+        for (uint32_t i = 0; i < view.primitiveCount(); ++i)
+        {
+            const uint32_t meshIndex = view.primitives[i].meshIndex;
+            if (meshIndex >= view.meshCount())
+                continue;
+            const smodel::SModelMeshRecord &mesh = view.meshes[meshIndex];
+            std::memcpy(bounds[i].min, mesh.aabbMin, sizeof(bounds[i].min));
+            std::memcpy(bounds[i].max, mesh.aabbMax, sizeof(bounds[i].max));
+            bounds[i].valid = true;
+        }
+
+        CopyModelNodes(view, out);
+        ComputeModelBounds(out, bounds);
+        CopyModelAnimations(view, out);
+        return true;
+    }
+
+} // namespace Engine
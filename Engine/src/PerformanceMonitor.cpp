@@ -1,33 +1,68 @@
 #include "Engine/PerformanceMonitor.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/Renderer.h"
+#include "Engine/RenderStats.h"
 #include "Engine/Window.h"
+#include "utils/AllocTracker.h"
+#include "utils/HitchDetector.h"
+#include "utils/MemoryAllocator.h"
+#include "utils/MemoryTracker.h"
+#include "utils/Profiler.h"
+#include "utils/TraceCapture.h"
 
 #include <imgui.h>
 #include <algorithm>
 #include <numeric>
-#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string_view>
 
 namespace Engine
 {
-    // Global atomic draw call counter
-    static std::atomic<uint32_t> g_drawCallCount{0};
-
-    void DrawCallCounter::increment(uint32_t count)
+    namespace
     {
-        g_drawCallCount.fetch_add(count, std::memory_order_relaxed);
-    }
+        // Heap bars turn red from this share of the budget
+        constexpr float kMemoryBudgetWarning = 0.9f;
 
-    void DrawCallCounter::reset()
-    {
-        g_drawCallCount.store(0, std::memory_order_relaxed);
-    }
+        // Models listed under Rendering, most triangles first
+        constexpr size_t kRenderStatsModels = 8;
 
-    uint32_t DrawCallCounter::get()
-    {
-        return g_drawCallCount.load(std::memory_order_relaxed);
-    }
+        // 1234567 -> "1.23M"
+        void FormatCount_Internal(char *out, size_t size, uint64_t n)
+        {
+            if (n >= 1000000u)
+                std::snprintf(out, size, "%.2fM", static_cast<double>(n) / 1e6);
+            else if (n >= 10000u)
+                std::snprintf(out, size, "%.1fK", static_cast<double>(n) / 1e3);
+            else
+                std::snprintf(out, size, "%llu", static_cast<unsigned long long>(n));
+        }
+
+        void RenderCountersText_Internal(const char *label, const RenderCounters &c, bool disabled)
+        {
+            char instances[16], triangles[16], visible[16];
+            FormatCount_Internal(instances, sizeof(instances), c.instances);
+            FormatCount_Internal(triangles, sizeof(triangles), c.triangles);
+            FormatCount_Internal(visible, sizeof(visible), c.visibleTriangles);
+            const char *fmt = "  %-24s %4u draws %7s inst %7s/%7s tris  P%u D%u B%u  %.1f KB";
+            const double kb = static_cast<double>(c.uploadBytes) / 1024.0;
+            if (disabled)
+                ImGui::TextDisabled(fmt, label, c.drawCalls, instances, triangles, visible, c.pipelineBinds, c.descriptorBinds,
+                                    c.bufferBinds, kb);
+            else
+                ImGui::Text(fmt, label, c.drawCalls, instances, triangles, visible, c.pipelineBinds, c.descriptorBinds,
+                            c.bufferBinds, kb);
+        }
+
+        // Stable per-name color so a scope keeps its color from frame to frame
+        ImU32 ScopeColor_Internal(const char *name)
+        {
+            const size_t hash = std::hash<std::string_view>{}(std::string_view(name));
+            const float hue = static_cast<float>(hash % 360u) / 360.0f;
+            return ImColor::HSV(hue, 0.55f, 0.75f);
+        }
+    } // namespace
 
     PerformanceMonitor::PerformanceMonitor()
         : m_frameStart(Clock::now())
@@ -58,12 +93,19 @@ namespace Engine
     void PerformanceMonitor::beginFrame()
     {
         m_frameStart = Clock::now();
-        DrawCallCounter::reset();
+        RenderStats::beginFrame();
+        AllocTracker::beginFrame();
+        Profiler::beginFrame();
     }
 
     void PerformanceMonitor::endFrame()
     {
         auto now = Clock::now();
+        RenderStats::endFrame();
+        AllocTracker::endFrame();
+        Profiler::endFrame();
+        collectGpuSpans();
+        recordTraceFrame();
         
         // Calculate frame time
         float frameTimeMs = std::chrono::duration<float, std::milli>(now - m_lastFrameEnd).count();
@@ -79,14 +121,14 @@ namespace Engine
             m_frameTimeHistory.pop_front();
         }
 
-        // Get draw call count from global counter
-        m_lastFrameDrawCalls = DrawCallCounter::get();
-
         // Get GPU time from renderer if available
         if (m_renderer)
         {
             m_gpuTimeMs = m_renderer->getGpuTimeMs();
         }
+        // Share of the frame the GPU was busy with it
+        m_gpuUsagePercent = frameTimeMs > 0.0f ? std::min(m_gpuTimeMs / frameTimeMs * 100.0f, 100.0f) : 0.0f;
+        recordHitchFrame(frameTimeMs);
 
         // Apply EMA (Exponential Moving Average) smoothing for display values
         // Formula: smoothed = alpha * current + (1 - alpha) * smoothed_previous
@@ -109,21 +151,83 @@ namespace Engine
         m_frameTimeMs = frameTimeMs;
     }
 
-    void PerformanceMonitor::recordDrawCall(uint32_t primitiveCount)
+    void PerformanceMonitor::toggle()
     {
-        DrawCallCounter::increment(1);
-        m_primitiveCount += primitiveCount;
+        setVisible(!m_visible);
     }
 
-    void PerformanceMonitor::resetDrawCalls()
+    void PerformanceMonitor::setVisible(bool visible)
     {
-        DrawCallCounter::reset();
-        m_primitiveCount = 0;
+        m_visible = visible;
+        updateProfilerEnabled();
     }
 
-    void PerformanceMonitor::toggle()
+    void PerformanceMonitor::updateProfilerEnabled()
+    {
+        Profiler::setEnabled(m_visible || TraceCapture::active() || HitchDetector::enabled());
+    }
+
+    bool PerformanceMonitor::startTraceCapture(const std::string &path, uint32_t frames)
+    {
+        const bool profilerWasEnabled = Profiler::enabled();
+        if (!TraceCapture::begin(path, frames))
+            return false;
+        m_profilerEnabledBeforeTrace = profilerWasEnabled;
+        Profiler::setEnabled(true);
+        return true;
+    }
+
+    void PerformanceMonitor::enableHitchDetector(const HitchDetectorConfig &config)
+    {
+        HitchDetector::enable(config);
+        updateProfilerEnabled();
+    }
+
+    void PerformanceMonitor::disableHitchDetector()
     {
-        m_visible = !m_visible;
+        HitchDetector::disable();
+        updateProfilerEnabled();
+    }
+
+    void PerformanceMonitor::collectGpuSpans()
+    {
+        m_gpuSpans.clear();
+        if (!TraceCapture::active() && !HitchDetector::enabled())
+            return;
+        if (m_renderer && m_renderer->getGpuFrameEndNs() > 0)
+        {
+            m_gpuSpans.push_back({"GPU frame", "Frame", m_renderer->getGpuFrameStartNs(), m_renderer->getGpuFrameEndNs()});
+            for (const GpuProfiler::PassTiming &pass : m_renderer->getGpuPassTimings())
+                m_gpuSpans.push_back({pass.name, pass.stage, pass.startNs, pass.endNs});
+        }
+    }
+
+    void PerformanceMonitor::recordTraceFrame()
+    {
+        if (!TraceCapture::active())
+            return;
+        if (TraceCapture::addFrame(Profiler::lastFrame(), m_gpuSpans))
+            Profiler::setEnabled(m_visible || m_profilerEnabledBeforeTrace || HitchDetector::enabled());
+    }
+
+    void PerformanceMonitor::recordHitchFrame(float frameTimeMs)
+    {
+        if (!HitchDetector::enabled())
+            return;
+
+        HitchDetector::FrameInfo info;
+        info.frameMs = frameTimeMs;
+        info.cpuMs = m_cpuTimeMs;
+        info.gpuMs = m_gpuTimeMs;
+        if (const MemoryAllocator *allocator = m_ctx ? m_ctx->GetMemoryAllocator() : nullptr)
+        {
+            const MemoryAllocator::Stats mem = allocator->getStats();
+            info.gpuAllocations = mem.allocationCount;
+            info.gpuUsedBytes = mem.usedBytes;
+        }
+        // The detector switches itself off after its last dump
+        if (HitchDetector::addFrame(info, Profiler::lastFrame(), m_gpuSpans) && !HitchDetector::enabled())
+            updateProfilerEnabled();
     }
 
     void PerformanceMonitor::updateMetrics()
@@ -178,6 +282,11 @@ namespace Engine
         m_01percentLowFPS = (avg01PercentTime > 0.0f) ? (1000.0f / avg01PercentTime) : 0.0f;
     }
 
+    uint32_t PerformanceMonitor::getDrawCallCount() const
+    {
+        return RenderStats::lastFrame().total.drawCalls;
+    }
+
     uint32_t PerformanceMonitor::getResolutionWidth() const
     {
         if (m_window)
@@ -257,7 +366,7 @@ namespace Engine
             // GPU time from Vulkan timestamp queries (also EMA-smoothed)
             if (m_gpuTimeMs > 0.0f)
             {
-                ImGui::Text("  GPU:   %.2f ms", m_smoothedGpuTimeMs);
+                ImGui::Text("  GPU:   %.2f ms (%.0f%% busy)", m_smoothedGpuTimeMs, m_gpuUsagePercent);
             }
             else
             {
@@ -266,6 +375,34 @@ namespace Engine
 
             ImGui::Spacing();
 
+            // Frame pacing: queue depth, low-latency mode and the input-to-photon estimate
+            if (m_renderer)
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("Latency");
+                ImGui::PopStyleColor();
+                ImGui::Text("  Frames in flight: %u / %u", m_renderer->getFramesInFlight(), m_renderer->getMaxFramesInFlight());
+                if (m_renderer->lowLatencyEnabled())
+                {
+                    ImGui::Text("  Low latency: on (%s)", m_renderer->presentWaitSupported() ? "present wait" : "fences");
+                    ImGui::Text("  Pacing sleep: %.2f ms / %.2f ms", m_renderer->getPacingSleepMs(), m_renderer->getDisplayIntervalMs());
+                }
+                else
+                {
+                    ImGui::Text("  Low latency: off");
+                }
+                if (m_renderer->getInputLatencyMs() > 0.0f)
+                {
+                    ImGui::Text("  Input to photon: %s%.1f ms", m_renderer->inputLatencyFromPresent() ? "" : "~",
+                                m_renderer->getInputLatencyMs());
+                }
+                else
+                {
+                    ImGui::TextDisabled("  Input to photon: N/A");
+                }
+                ImGui::Spacing();
+            }
+
             // Resolution & Refresh Rate
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
             ImGui::Text("Display");
@@ -278,15 +415,275 @@ namespace Engine
 
             ImGui::Spacing();
 
-            // Draw Calls Section
+            // Render statistics of the last frame: totals, per pass, then the heaviest models.
+            // Triangles: submitted / after culling; binds: pipelines, descriptor sets, buffers.
+            const RenderStats::Frame &render = RenderStats::lastFrame();
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
             ImGui::Text("Rendering");
             ImGui::PopStyleColor();
-            ImGui::Text("  Draw Calls: %u", m_lastFrameDrawCalls);
+            RenderCountersText_Internal("Total", render.total, false);
+            for (const RenderStats::PassStats &pass : render.passes)
+                RenderCountersText_Internal(pass.name, pass.counters, false);
+            const size_t modelCount = std::min(render.models.size(), kRenderStatsModels);
+            for (size_t i = 0; i < modelCount; ++i)
+            {
+                const RenderStats::ModelStats &model = render.models[i];
+                const size_t slash = model.name.find_last_of("/\\");
+                const std::string file = slash == std::string::npos ? model.name : model.name.substr(slash + 1);
+                RenderCountersText_Internal(file.c_str(), model.counters, true);
+            }
+            if (render.models.size() > modelCount)
+                ImGui::TextDisabled("  ... %zu more models", render.models.size() - modelCount);
+
+            // GPU time per module stage, from the renderer's timestamp queries
+            const std::vector<GpuProfiler::PassTiming> *passes = m_renderer ? &m_renderer->getGpuPassTimings() : nullptr;
+            if (passes && !passes->empty())
+            {
+                const bool statistics = m_renderer->pipelineStatisticsEnabled();
+                ImGui::Spacing();
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("GPU Passes");
+                ImGui::PopStyleColor();
+                for (const GpuProfiler::PassTiming &pass : *passes)
+                {
+                    ImGui::Text("  %-28s %-7s %6.3f ms", pass.name, pass.stage, pass.ms);
+                    if (statistics)
+                    {
+                        ImGui::TextDisabled("    VS %llu  FS %llu  CS %llu", static_cast<unsigned long long>(pass.vertexInvocations),
+                                            static_cast<unsigned long long>(pass.fragmentInvocations),
+                                            static_cast<unsigned long long>(pass.computeInvocations));
+                    }
+                }
+            }
+
+            // Device memory (allocator blocks vs. the device's allocation limit)
+            if (const MemoryAllocator *allocator = m_ctx ? m_ctx->GetMemoryAllocator() : nullptr)
+            {
+                const MemoryAllocator::Stats mem = allocator->getStats();
+                const double toMB = 1.0 / (1024.0 * 1024.0);
+
+                ImGui::Spacing();
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("GPU Memory");
+                ImGui::PopStyleColor();
+                ImGui::Text("  Allocations: %u / %u", mem.deviceAllocations, mem.maxDeviceAllocations);
+                ImGui::Text("  Blocks: %u  Dedicated: %u", mem.blockCount, mem.dedicatedCount);
+                ImGui::Text("  Used: %.1f / %.1f MB", static_cast<double>(mem.usedBytes) * toMB,
+                            static_cast<double>(mem.blockBytes + mem.dedicatedBytes) * toMB);
+                ImGui::TextDisabled("  Device: %.1f MB  Host: %.1f MB", static_cast<double>(mem.deviceLocalBytes) * toMB,
+                                    static_cast<double>(mem.hostVisibleBytes) * toMB);
+
+                // Live allocations per category, with the high-water mark
+                for (size_t c = 0; c < static_cast<size_t>(MemoryCategory::Count); ++c)
+                {
+                    if (mem.categoryPeakBytes[c] == 0)
+                        continue;
+                    ImGui::Text("  %-18s %7.1f MB", MemoryCategoryName(static_cast<MemoryCategory>(c)),
+                                static_cast<double>(mem.categoryBytes[c]) * toMB);
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("peak %.1f", static_cast<double>(mem.categoryPeakBytes[c]) * toMB);
+                }
+
+                // Heap usage against the budget; on small cards the device-local heap is the limit
+                ImGui::TextDisabled("  Heaps (%s)", allocator->memoryBudgetEnabled() ? "driver budget" : "engine usage / heap size");
+                const std::vector<MemoryAllocator::HeapBudget> heaps = allocator->getHeapBudgets();
+                for (size_t h = 0; h < heaps.size(); ++h)
+                {
+                    const MemoryAllocator::HeapBudget &heap = heaps[h];
+                    const float fraction = heap.budget > 0 ? static_cast<float>(static_cast<double>(heap.usage) / static_cast<double>(heap.budget)) : 0.0f;
+                    char label[64];
+                    std::snprintf(label, sizeof(label), "%.0f / %.0f MB", static_cast<double>(heap.usage) * toMB,
+                                  static_cast<double>(heap.budget) * toMB);
+                    ImGui::Text("  %u %-6s", static_cast<unsigned>(h), heap.deviceLocal ? "device" : "host");
+                    ImGui::SameLine();
+                    const bool nearBudget = fraction >= kMemoryBudgetWarning;
+                    if (nearBudget)
+                        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+                    ImGui::ProgressBar(std::min(fraction, 1.0f), ImVec2(160.0f, 0.0f), label);
+                    if (nearBudget)
+                        ImGui::PopStyleColor();
+                }
+            }
+
+            // CPU memory the owners report to MemoryTracker
+            ImGui::Spacing();
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+            ImGui::Text("CPU Memory");
+            ImGui::PopStyleColor();
+            const double toMB = 1.0 / (1024.0 * 1024.0);
+            for (size_t c = 0; c < MemoryTracker::kCategoryCount; ++c)
+            {
+                const CpuMemoryCategory category = static_cast<CpuMemoryCategory>(c);
+                ImGui::Text("  %-18s %7.1f MB", MemoryTracker::name(category), static_cast<double>(MemoryTracker::current(category)) * toMB);
+                ImGui::SameLine();
+                ImGui::TextDisabled("peak %.1f", static_cast<double>(MemoryTracker::peak(category)) * toMB);
+            }
+
+            // Heap allocations of the last frame (ENGINE_ALLOC_TRACKING builds)
+            if (AllocTracker::enabled())
+            {
+                const AllocCounts &heap = AllocTracker::lastFrame();
+                ImGui::Text("  Heap: %llu allocs (%.1f KB), %llu frees / frame", static_cast<unsigned long long>(heap.allocations),
+                            static_cast<double>(heap.bytes) / 1024.0, static_cast<unsigned long long>(heap.frees));
+                if (AllocTracker::violations() > 0)
+                {
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+                    ImGui::Text("  No-alloc scope violations: %u", AllocTracker::violations());
+                    ImGui::PopStyleColor();
+                }
+            }
 
             ImGui::Spacing();
             ImGui::Separator();
             ImGui::TextDisabled("Press F1 to toggle");
+            ImGui::TextDisabled("F2: low latency  F3: frames in flight");
+            if (TraceCapture::active())
+                ImGui::TextDisabled("F5: capturing trace (%u frames left)", TraceCapture::remaining());
+            else
+                ImGui::TextDisabled("F5: capture trace");
+            if (HitchDetector::enabled())
+                ImGui::TextDisabled("Hitch detector: %u dumps", HitchDetector::dumpsWritten());
+            if (m_renderer && m_renderer->pipelineStatisticsSupported())
+            {
+                ImGui::TextDisabled("F4: pipeline statistics (%s)", m_renderer->pipelineStatisticsEnabled() ? "on" : "off");
+            }
+        }
+        ImGui::End();
+
+        renderProfilerWindow();
+    }
+
+    void PerformanceMonitor::renderProfilerWindow()
+    {
+        const Profiler::Frame &frame = Profiler::lastFrame();
+        if (frame.threads.empty())
+            return;
+
+        ImGuiWindowFlags windowFlags =
+            ImGuiWindowFlags_NoDecoration |
+            ImGuiWindowFlags_NoSavedSettings |
+            ImGuiWindowFlags_NoFocusOnAppearing |
+            ImGuiWindowFlags_NoNav |
+            ImGuiWindowFlags_NoMove;
+
+        // Bottom-left corner, 60% of the viewport wide; the height fits the content
+        const float padding = 10.0f;
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImVec2 workPos = viewport->WorkPos;
+        ImVec2 workSize = viewport->WorkSize;
+        ImGui::SetNextWindowPos(ImVec2(workPos.x + padding, workPos.y + workSize.y - padding), ImGuiCond_Always, ImVec2(0.0f, 1.0f));
+        ImGui::SetNextWindowSize(ImVec2(workSize.x * 0.6f, 0.0f), ImGuiCond_Always);
+        ImGui::SetNextWindowBgAlpha(0.75f);
+
+        if (ImGui::Begin("CPU Timeline", nullptr, windowFlags))
+        {
+            const uint64_t spanNs = std::max<uint64_t>(frame.endNs - frame.startNs, 1);
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.4f, 0.9f, 0.4f, 1.0f));
+            ImGui::Text("CPU Timeline");
+            ImGui::PopStyleColor();
+            ImGui::SameLine();
+            ImGui::TextDisabled("(last frame, %.2f ms)", static_cast<double>(spanNs) * 1e-6);
+            ImGui::Separator();
+
+            // One track per thread, one row per scope depth
+            std::vector<uint32_t> rows(frame.threads.size(), 1u);
+            for (const Profiler::Event &e : frame.events)
+                rows[e.thread] = std::max(rows[e.thread], e.depth + 1u);
+
+            const float labelWidth = ImGui::CalcTextSize("Worker 000").x + ImGui::GetStyle().ItemSpacing.x;
+            const float rowHeight = ImGui::GetTextLineHeight() + 2.0f;
+            const float trackWidth = std::max(ImGui::GetContentRegionAvail().x - labelWidth, 50.0f);
+            ImDrawList* draw = ImGui::GetWindowDrawList();
+            const Profiler::Event* hovered = nullptr;
+
+            size_t next = 0;
+            for (size_t t = 0; t < frame.threads.size(); ++t)
+            {
+                const ImVec2 origin = ImGui::GetCursorScreenPos();
+                const float trackX = origin.x + labelWidth;
+                const float trackHeight = static_cast<float>(rows[t]) * rowHeight;
+                ImGui::TextUnformatted(frame.threads[t].c_str());
+                draw->AddRectFilled(ImVec2(trackX, origin.y), ImVec2(trackX + trackWidth, origin.y + trackHeight),
+                                    IM_COL32(255, 255, 255, 16));
+
+                // Events are grouped by thread; scopes straddling the frame edges are clipped
+                for (; next < frame.events.size() && frame.events[next].thread == t; ++next)
+                {
+                    const Profiler::Event &e = frame.events[next];
+                    auto toX = [&](uint64_t ns)
+                    {
+                        const double offset = ns > frame.startNs ? static_cast<double>(ns - frame.startNs) : 0.0;
+                        return trackX + static_cast<float>(std::min(offset / static_cast<double>(spanNs), 1.0)) * trackWidth;
+                    };
+                    const float x0 = toX(e.startNs);
+                    const float x1 = std::max(toX(e.endNs), x0 + 1.0f);
+                    const float y0 = origin.y + static_cast<float>(e.depth) * rowHeight;
+                    const float y1 = y0 + rowHeight - 1.0f;
+
+                    draw->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), ScopeColor_Internal(e.name));
+                    if (x1 - x0 > 24.0f)
+                    {
+                        draw->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+                        draw->AddText(ImVec2(x0 + 2.0f, y0 + 1.0f), IM_COL32(255, 255, 255, 255), e.name);
+                        draw->PopClipRect();
+                    }
+                    if (ImGui::IsMouseHoveringRect(ImVec2(x0, y0), ImVec2(x1, y1)))
+                        hovered = &e;
+                }
+
+                ImGui::SetCursorScreenPos(origin);
+                ImGui::Dummy(ImVec2(labelWidth + trackWidth, trackHeight));
+            }
+
+            if (hovered)
+            {
+                if (AllocTracker::enabled())
+                    ImGui::SetTooltip("%s\n%.3f ms\n%u allocs (%.1f KB)", hovered->name,
+                                      static_cast<double>(hovered->endNs - hovered->startNs) * 1e-6, hovered->allocations,
+                                      static_cast<double>(hovered->allocBytes) / 1024.0);
+                else
+                    ImGui::SetTooltip("%s\n%.3f ms", hovered->name, static_cast<double>(hovered->endNs - hovered->startNs) * 1e-6);
+            }
+            if (frame.dropped > 0)
+            {
+                ImGui::TextDisabled("%u scopes dropped", frame.dropped);
+            }
+
+            // Per-scope totals, heaviest first
+            const std::vector<Profiler::ScopeStats>& stats = Profiler::stats();
+            const size_t maxRows = 16;
+            ImGui::Spacing();
+            const bool allocations = AllocTracker::enabled();
+            if (!stats.empty() && ImGui::BeginTable("##ProfilerScopes", allocations ? 5 : 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Avg ms");
+                ImGui::TableSetupColumn("Max ms");
+                ImGui::TableSetupColumn("Calls");
+                if (allocations)
+                    ImGui::TableSetupColumn("Allocs");
+                ImGui::TableHeadersRow();
+                for (size_t i = 0; i < stats.size() && i < maxRows; ++i)
+                {
+                    const Profiler::ScopeStats& st = stats[i];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(st.name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", st.avgMs);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", st.maxMs);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", st.calls);
+                    if (allocations)
+                    {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", st.allocations);
+                    }
+                }
+                ImGui::EndTable();
+            }
+            ImGui::TextDisabled("Averages smoothed; max over the last %u frames", Profiler::kStatsWindow);
         }
         ImGui::End();
     }
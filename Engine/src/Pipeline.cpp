@@ -1,11 +1,185 @@
 #include "Engine/Pipeline.h"
+#include "utils/PipelineCache.h"
 #include <fstream>
 #include <stdexcept>
 #include <vector>
 #include <cstring>
+#include <type_traits>
 
 namespace Engine
 {
+    // Byte key of a graphics pipeline description for PipelineCache sharing: every state the
+    // pipeline is built from, pointers followed. Empty when some state cannot be described
+    // (extension structs in pNext), so the pipeline is not shared.
+    class PipelineKey
+    {
+    public:
+        template <typename T>
+        void add(const T &v)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "PipelineKey::add needs plain data");
+            m_bytes.append(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+
+        void addBytes(const void *data, size_t size)
+        {
+            add(size);
+            m_bytes.append(static_cast<const char *>(data), size);
+        }
+
+        void addString(const char *str)
+        {
+            addBytes(str, str ? std::strlen(str) : 0);
+        }
+
+        void append(const std::string &bytes) { m_bytes += bytes; }
+
+        void fail() { m_ok = false; }
+        bool ok() const { return m_ok; }
+        std::string take() { return m_ok ? std::move(m_bytes) : std::string(); }
+
+    private:
+        std::string m_bytes;
+        bool m_ok = true;
+    };
+
+    static std::string describePipeline(const PipelineCache &cache, const PipelineCreateInfo &info,
+                                        const VkGraphicsPipelineCreateInfo &p, const std::vector<VkDynamicState> &dynamicStates)
+    {
+        PipelineKey key;
+        key.add(p.renderPass);
+        key.add(p.subpass);
+
+        // Layout: by handle when shared, by contents when this wrapper made one (identically defined
+        // layouts are compatible).
+        key.add(info.pipelineLayout);
+        if (info.pipelineLayout == VK_NULL_HANDLE)
+        {
+            key.add(info.descriptorSetLayouts.size());
+            for (VkDescriptorSetLayout l : info.descriptorSetLayouts)
+                key.add(l);
+            key.add(info.pushConstantRanges.size());
+            for (const VkPushConstantRange &r : info.pushConstantRanges)
+                key.add(r);
+        }
+
+        key.add(p.stageCount);
+        for (uint32_t i = 0; i < p.stageCount; ++i)
+        {
+            const VkPipelineShaderStageCreateInfo &st = p.pStages[i];
+            if (st.pNext)
+                key.fail();
+            key.add(st.flags);
+            key.add(st.stage);
+            key.append(cache.shaderModuleKey(st.module));
+            key.addString(st.pName);
+            const VkSpecializationInfo *spec = st.pSpecializationInfo;
+            key.add(spec ? spec->mapEntryCount : ~0u);
+            if (spec)
+            {
+                for (uint32_t e = 0; e < spec->mapEntryCount; ++e)
+                    key.add(spec->pMapEntries[e]);
+                key.addBytes(spec->pData, spec->dataSize);
+            }
+        }
+
+        const VkPipelineVertexInputStateCreateInfo &vi = *p.pVertexInputState;
+        if (vi.pNext)
+            key.fail();
+        key.add(vi.vertexBindingDescriptionCount);
+        for (uint32_t i = 0; i < vi.vertexBindingDescriptionCount; ++i)
+            key.add(vi.pVertexBindingDescriptions[i]);
+        key.add(vi.vertexAttributeDescriptionCount);
+        for (uint32_t i = 0; i < vi.vertexAttributeDescriptionCount; ++i)
+            key.add(vi.pVertexAttributeDescriptions[i]);
+
+        const VkPipelineInputAssemblyStateCreateInfo &ia = *p.pInputAssemblyState;
+        if (ia.pNext)
+            key.fail();
+        key.add(ia.topology);
+        key.add(ia.primitiveRestartEnable);
+
+        key.add(dynamicStates.size());
+        for (VkDynamicState d : dynamicStates)
+            key.add(d);
+
+        const VkPipelineRasterizationStateCreateInfo &rs = *p.pRasterizationState;
+        if (rs.pNext)
+            key.fail();
+        key.add(rs.depthClampEnable);
+        key.add(rs.rasterizerDiscardEnable);
+        key.add(rs.polygonMode);
+        key.add(rs.cullMode);
+        key.add(rs.frontFace);
+        key.add(rs.depthBiasEnable);
+        key.add(rs.depthBiasConstantFactor);
+        key.add(rs.depthBiasClamp);
+        key.add(rs.depthBiasSlopeFactor);
+        key.add(rs.lineWidth);
+
+        const VkPipelineMultisampleStateCreateInfo &ms = *p.pMultisampleState;
+        if (ms.pNext)
+            key.fail();
+        key.add(ms.rasterizationSamples);
+        key.add(ms.sampleShadingEnable);
+        key.add(ms.minSampleShading);
+        key.add(ms.pSampleMask ? ms.pSampleMask[0] : ~0u);
+        key.add(ms.alphaToCoverageEnable);
+        key.add(ms.alphaToOneEnable);
+
+        const VkPipelineDepthStencilStateCreateInfo &ds = *p.pDepthStencilState;
+        if (ds.pNext)
+            key.fail();
+        key.add(ds.depthTestEnable);
+        key.add(ds.depthWriteEnable);
+        key.add(ds.depthCompareOp);
+        key.add(ds.depthBoundsTestEnable);
+        key.add(ds.stencilTestEnable);
+        key.add(ds.front);
+        key.add(ds.back);
+        key.add(ds.minDepthBounds);
+        key.add(ds.maxDepthBounds);
+
+        const VkPipelineColorBlendStateCreateInfo &cb = *p.pColorBlendState;
+        if (cb.pNext)
+            key.fail();
+        key.add(cb.logicOpEnable);
+        key.add(cb.logicOp);
+        key.add(cb.attachmentCount);
+        for (uint32_t i = 0; i < cb.attachmentCount; ++i)
+            key.add(cb.pAttachments[i]);
+        for (float c : cb.blendConstants)
+            key.add(c);
+
+        return key.take();
+    }
+
+    SpecializationConstants &SpecializationConstants::set(uint32_t constantId, uint32_t value)
+    {
+        for (const VkSpecializationMapEntry &e : m_entries)
+        {
+            if (e.constantID == constantId)
+            {
+                m_data[e.offset / sizeof(uint32_t)] = value;
+                return *this;
+            }
+        }
+        m_entries.push_back({constantId, static_cast<uint32_t>(m_data.size() * sizeof(uint32_t)), sizeof(uint32_t)});
+        m_data.push_back(value);
+        return *this;
+    }
+
+    const VkSpecializationInfo *SpecializationConstants::info() const
+    {
+        if (m_entries.empty())
+            return nullptr;
+        m_info.mapEntryCount = static_cast<uint32_t>(m_entries.size());
+        m_info.pMapEntries = m_entries.data();
+        m_info.dataSize = m_data.size() * sizeof(uint32_t);
+        m_info.pData = m_data.data();
+        return &m_info;
+    }
+
     Pipeline::~Pipeline()
     {
         // Explicit destroy must be called by owner with the VkDevice.
@@ -35,6 +209,10 @@ namespace Engine
         {
             throw std::runtime_error("Failed to create shader module from: " + spvPath);
         }
+
+        // Pipelines from the same code can be shared even though every load makes a new module.
+        if (PipelineCache *cache = PipelineCache::ForDevice(device))
+            cache->registerShaderModule(module, PipelineCache::HashBytes(buffer.data(), buffer.size()));
         return module;
     }
 
@@ -188,7 +366,24 @@ namespace Engine
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex = -1;
 
-        VkResult res = vkCreateGraphicsPipelines(device, info.pipelineCache, 1, &pipelineInfo, nullptr, &m_pipeline);
+        // An identical live pipeline is shared; new ones go through the engine's VkPipelineCache unless
+        // the caller passed its own.
+        PipelineCache *cache = PipelineCache::ForDevice(device);
+        const std::string key = cache ? describePipeline(*cache, info, pipelineInfo, dynamicStates) : std::string();
+        if (!key.empty())
+        {
+            m_pipeline = cache->acquire(key);
+            if (m_pipeline != VK_NULL_HANDLE)
+            {
+                m_layout = layout;
+                return VK_SUCCESS;
+            }
+        }
+
+        const VkPipelineCache vkCache = (info.pipelineCache != VK_NULL_HANDLE) ? info.pipelineCache : PipelineCache::HandleFor(device);
+        VkResult res = vkCreateGraphicsPipelines(device, vkCache, 1, &pipelineInfo, nullptr, &m_pipeline);
+        if (res == VK_SUCCESS && !key.empty())
+            m_pipeline = cache->insert(key, m_pipeline);
         if (res != VK_SUCCESS)
         {
             if (m_ownsLayout && layout != VK_NULL_HANDLE)
@@ -208,7 +403,10 @@ namespace Engine
     {
         if (m_pipeline != VK_NULL_HANDLE)
         {
-            vkDestroyPipeline(device, m_pipeline, nullptr);
+            // Shared pipelines are destroyed by the cache with their last user.
+            PipelineCache *cache = PipelineCache::ForDevice(device);
+            if (!cache || !cache->release(m_pipeline))
+                vkDestroyPipeline(device, m_pipeline, nullptr);
             m_pipeline = VK_NULL_HANDLE;
         }
         if (m_ownsLayout && m_layout != VK_NULL_HANDLE)
@@ -0,0 +1,268 @@
+#include "utils/PipelineCache.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr uint32_t kFileMagic = 0x43504E45u; // "ENPC"
+        constexpr uint32_t kFileVersion = 1;
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::pair<VkDevice, PipelineCache *>> entries;
+        };
+
+        Registry &registry()
+        {
+            static Registry r;
+            return r;
+        }
+    } // namespace
+
+    uint64_t PipelineCache::HashBytes(const void *data, size_t size)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= bytes[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    PipelineCache::FileHeader PipelineCache::makeHeader() const
+    {
+        FileHeader header;
+        header.magic = kFileMagic;
+        header.version = kFileVersion;
+        header.vendorID = m_props.vendorID;
+        header.deviceID = m_props.deviceID;
+        header.driverVersion = m_props.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, m_props.pipelineCacheUUID, VK_UUID_SIZE);
+        return header;
+    }
+
+    PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice phys, std::string path)
+        : m_device(device), m_path(std::move(path))
+    {
+        vkGetPhysicalDeviceProperties(phys, &m_props);
+
+        // Initial data: only from a file written for this device and driver.
+        std::vector<char> data;
+        std::ifstream file(m_path, std::ios::binary);
+        if (file.is_open())
+        {
+            FileHeader header;
+            const FileHeader expected = makeHeader();
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+            const bool match = file.gcount() == static_cast<std::streamsize>(sizeof(header)) &&
+                               header.magic == expected.magic && header.version == expected.version &&
+                               header.vendorID == expected.vendorID && header.deviceID == expected.deviceID &&
+                               header.driverVersion == expected.driverVersion &&
+                               std::memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+            if (match && header.dataSize > 0 && header.dataSize < (uint64_t(1) << 30))
+            {
+                data.resize(static_cast<size_t>(header.dataSize));
+                file.read(data.data(), static_cast<std::streamsize>(data.size()));
+                if (file.gcount() != static_cast<std::streamsize>(data.size()) || HashBytes(data.data(), data.size()) != header.dataHash)
+                {
+                    ENGINE_LOG_WARN("[PipelineCache] Ignoring damaged cache file %s", m_path.c_str());
+                    data.clear();
+                }
+            }
+            else if (!match)
+            {
+                ENGINE_LOG_WARN("[PipelineCache] Ignoring %s: written for another device or driver", m_path.c_str());
+            }
+        }
+
+        VkPipelineCacheCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        info.initialDataSize = data.size();
+        info.pInitialData = data.empty() ? nullptr : data.data();
+        if (vkCreatePipelineCache(m_device, &info, nullptr, &m_cache) != VK_SUCCESS && !data.empty())
+        {
+            // The driver rejected the data: start empty.
+            info.initialDataSize = 0;
+            info.pInitialData = nullptr;
+            data.clear();
+            if (vkCreatePipelineCache(m_device, &info, nullptr, &m_cache) != VK_SUCCESS)
+                m_cache = VK_NULL_HANDLE;
+        }
+        if (m_cache == VK_NULL_HANDLE)
+            ENGINE_LOG_WARN("[PipelineCache] vkCreatePipelineCache failed; pipelines build without a cache");
+        m_stats.loadedBytes = data.size();
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.entries.emplace_back(device, this);
+    }
+
+    PipelineCache::~PipelineCache()
+    {
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.entries.erase(std::remove_if(r.entries.begin(), r.entries.end(),
+                                           [this](const std::pair<VkDevice, PipelineCache *> &e)
+                                           { return e.second == this; }),
+                            r.entries.end());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_shared.empty())
+            ENGINE_LOG_WARN("[PipelineCache] %u shared pipelines still live at shutdown", static_cast<uint32_t>(m_shared.size()));
+        for (auto &entry : m_shared)
+            vkDestroyPipeline(m_device, entry.second.pipeline, nullptr);
+        m_shared.clear();
+        m_keyOf.clear();
+
+        if (m_cache != VK_NULL_HANDLE)
+            vkDestroyPipelineCache(m_device, m_cache, nullptr);
+    }
+
+    bool PipelineCache::save() const
+    {
+        if (m_cache == VK_NULL_HANDLE)
+            return false;
+
+        size_t size = 0;
+        if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0)
+            return false;
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) != VK_SUCCESS)
+            return false;
+        data.resize(size);
+
+        FileHeader header = makeHeader();
+        header.dataSize = data.size();
+        header.dataHash = HashBytes(data.data(), data.size());
+
+        // Write next to the target and swap it in, so a crash mid-write leaves the old file.
+        const std::string temp = m_path + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                ENGINE_LOG_WARN("[PipelineCache] Cannot write %s", temp.c_str());
+                return false;
+            }
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file.good())
+            {
+                ENGINE_LOG_WARN("[PipelineCache] Failed writing %s", temp.c_str());
+                return false;
+            }
+        }
+        std::remove(m_path.c_str());
+        if (std::rename(temp.c_str(), m_path.c_str()) != 0)
+        {
+            ENGINE_LOG_WARN("[PipelineCache] Cannot replace %s", m_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    VkPipeline PipelineCache::acquire(const std::string &key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_shared.find(key);
+        if (it == m_shared.end())
+        {
+            ++m_stats.misses;
+            return VK_NULL_HANDLE;
+        }
+        ++it->second.refs;
+        ++m_stats.hits;
+        return it->second.pipeline;
+    }
+
+    VkPipeline PipelineCache::insert(const std::string &key, VkPipeline pipeline)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_shared.find(key);
+        if (it != m_shared.end())
+        {
+            vkDestroyPipeline(m_device, pipeline, nullptr);
+            ++it->second.refs;
+            return it->second.pipeline;
+        }
+        m_shared.emplace(key, Shared{pipeline, 1u});
+        m_keyOf.emplace(pipeline, key);
+        return pipeline;
+    }
+
+    bool PipelineCache::release(VkPipeline pipeline)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto key = m_keyOf.find(pipeline);
+        if (key == m_keyOf.end())
+            return false;
+        auto it = m_shared.find(key->second);
+        if (it != m_shared.end() && --it->second.refs == 0)
+        {
+            vkDestroyPipeline(m_device, pipeline, nullptr);
+            m_shared.erase(it);
+            m_keyOf.erase(key);
+        }
+        return true;
+    }
+
+    void PipelineCache::registerShaderModule(VkShaderModule module, uint64_t codeHash)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shaderHashes[module] = codeHash;
+    }
+
+    std::string PipelineCache::shaderModuleKey(VkShaderModule module) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string key;
+        auto it = m_shaderHashes.find(module);
+        const char tag = (it != m_shaderHashes.end()) ? 'S' : 'H';
+        key.push_back(tag);
+        if (it != m_shaderHashes.end())
+            key.append(reinterpret_cast<const char *>(&it->second), sizeof(it->second));
+        else
+            key.append(reinterpret_cast<const char *>(&module), sizeof(module));
+        return key;
+    }
+
+    PipelineCache::Stats PipelineCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats s = m_stats;
+        s.sharedPipelines = static_cast<uint32_t>(m_shared.size());
+        return s;
+    }
+
+    PipelineCache *PipelineCache::ForDevice(VkDevice device)
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto &e : r.entries)
+        {
+            if (e.first == device)
+                return e.second;
+        }
+        return nullptr;
+    }
+
+    VkPipelineCache PipelineCache::HandleFor(VkDevice device)
+    {
+        PipelineCache *cache = ForDevice(device);
+        return cache ? cache->getHandle() : VK_NULL_HANDLE;
+    }
+
+} // namespace Engine
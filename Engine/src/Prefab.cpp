@@ -0,0 +1,432 @@
+#include "ECS/Prefab.h"
+#include "utils/MappedFile.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace Engine::ECS
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        constexpr uint32_t kCacheMagic = 0x43465053u; // "SPFC"
+        constexpr uint32_t kCacheVersion = 1;          // bump when the parser or a default type changes
+
+        // Component types a prefab may give defaults for, by name. Calls f(T{}) for a known name.
+        template <typename F>
+        bool visitDefaultType(const std::string &name, F &&f)
+        {
+            if (name == "Position")
+                f(Position{});
+            else if (name == "Velocity")
+                f(Velocity{});
+            else if (name == "Health")
+                f(Health{});
+            else if (name == "MoveTarget")
+                f(MoveTarget{});
+            else if (name == "MoveSpeed")
+                f(MoveSpeed{});
+            else if (name == "Radius")
+                f(Radius{});
+            else if (name == "Separation")
+                f(Separation{});
+            else if (name == "AvoidanceParams")
+                f(AvoidanceParams{});
+            else if (name == "Facing")
+                f(Facing{});
+            else
+                return false;
+            return true;
+        }
+
+        // Fields missing from the JSON keep the component's own defaults.
+        void readDefault(const json &j, Position &v)
+        {
+            v.x = j.value("x", v.x);
+            v.y = j.value("y", v.y);
+            v.z = j.value("z", v.z);
+        }
+        void readDefault(const json &j, Velocity &v)
+        {
+            v.x = j.value("x", v.x);
+            v.y = j.value("y", v.y);
+            v.z = j.value("z", v.z);
+        }
+        void readDefault(const json &j, Health &v) { v.value = j.value("value", v.value); }
+        void readDefault(const json &j, MoveTarget &v)
+        {
+            v.x = j.value("x", v.x);
+            v.y = j.value("y", v.y);
+            v.z = j.value("z", v.z);
+            auto active = j.find("active");
+            if (active != j.end())
+                v.active = active->is_boolean() ? uint8_t(active->get<bool>()) : static_cast<uint8_t>(active->get<int>());
+        }
+        void readDefault(const json &j, MoveSpeed &v) { v.value = j.value("value", v.value); }
+        void readDefault(const json &j, Radius &v) { v.r = j.value("r", v.r); }
+        void readDefault(const json &j, Separation &v) { v.value = j.value("value", v.value); }
+        void readDefault(const json &j, AvoidanceParams &v)
+        {
+            v.strength = j.value("strength", v.strength);
+            v.maxAccel = j.value("maxAccel", v.maxAccel);
+            v.blend = j.value("blend", v.blend);
+        }
+        void readDefault(const json &j, Facing &v) { v.yaw = j.value("yaw", v.yaw); }
+
+        uint64_t hashSource(const uint8_t *data, size_t size)
+        {
+            uint64_t h = 14695981039346656037ull;
+            for (size_t i = 0; i < size; ++i)
+            {
+                h ^= data[i];
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        // Cache file encoding (native endianness): u32 counts/lengths, strings as length + bytes.
+        struct CacheWriter
+        {
+            std::vector<uint8_t> bytes;
+
+            void u32(uint32_t v) { raw(&v, sizeof(v)); }
+            void u64(uint64_t v) { raw(&v, sizeof(v)); }
+            void str(const std::string &s)
+            {
+                u32(static_cast<uint32_t>(s.size()));
+                raw(s.data(), s.size());
+            }
+            void raw(const void *p, size_t n)
+            {
+                const uint8_t *b = static_cast<const uint8_t *>(p);
+                bytes.insert(bytes.end(), b, b + n);
+            }
+        };
+
+        struct CacheReader
+        {
+            const uint8_t *cur = nullptr;
+            const uint8_t *end = nullptr;
+            bool ok = true;
+
+            bool raw(void *dst, size_t n)
+            {
+                if (!ok || static_cast<size_t>(end - cur) < n)
+                    return ok = false;
+                std::memcpy(dst, cur, n);
+                cur += n;
+                return true;
+            }
+            uint32_t u32()
+            {
+                uint32_t v = 0;
+                raw(&v, sizeof(v));
+                return v;
+            }
+            uint64_t u64()
+            {
+                uint64_t v = 0;
+                raw(&v, sizeof(v));
+                return v;
+            }
+            std::string str()
+            {
+                const uint32_t n = u32();
+                if (!ok || static_cast<size_t>(end - cur) < n)
+                {
+                    ok = false;
+                    return std::string();
+                }
+                std::string s(reinterpret_cast<const char *>(cur), n);
+                cur += n;
+                return s;
+            }
+        };
+    } // namespace
+
+    bool parsePrefabJson(const std::string &jsonText, PrefabDefinition &out, std::string *error)
+    {
+        out = PrefabDefinition{};
+
+        const json doc = json::parse(jsonText, nullptr, /*allow_exceptions=*/false);
+        if (doc.is_discarded() || !doc.is_object())
+        {
+            if (error)
+                *error = "not a JSON object";
+            return false;
+        }
+
+        try
+        {
+            out.name = doc.value("name", std::string());
+
+            auto components = doc.find("components");
+            if (components != doc.end() && components->is_array())
+            {
+                for (const json &c : *components)
+                {
+                    if (c.is_string())
+                        out.components.push_back(c.get<std::string>());
+                }
+            }
+
+            // JSON schema: "visual": { "model": "path" , ... }
+            auto visual = doc.find("visual");
+            if (visual != doc.end() && visual->is_object())
+                out.modelPath = visual->value("model", std::string());
+
+            auto defaults = doc.find("defaults");
+            if (defaults != doc.end() && defaults->is_object())
+            {
+                for (auto it = defaults->begin(); it != defaults->end(); ++it)
+                {
+                    const std::string &component = it.key();
+                    const json &value = it.value();
+                    const bool known = visitDefaultType(component, [&](auto tag)
+                                                        {
+                                                            using T = decltype(tag);
+                                                            T v{};
+                                                            if (value.is_object())
+                                                                readDefault(value, v);
+                                                            out.defaults.emplace_back(component, DefaultValue(v)); });
+                    if (!known)
+                        ENGINE_LOG_WARN("[Prefab] %s: no typed default for component %s, ignored", out.name.c_str(), component.c_str());
+                }
+            }
+        }
+        catch (const json::exception &e)
+        {
+            if (error)
+                *error = e.what();
+            return false;
+        }
+        return true;
+    }
+
+    Prefab instantiatePrefab(const PrefabDefinition &def,
+                             ComponentRegistry &registry,
+                             ArchetypeManager &archetypes,
+                             Engine::IModelProvider &assets)
+    {
+        Prefab p;
+        p.name = def.name;
+        p.signature = buildSignatureFromNames(def.components, registry);
+
+        // Optional visuals: if a model is present, start loading it and apply a RenderModel default.
+        // With AssetManager the handle is pending until update() finishes the load; systems skip it until then.
+        if (!def.modelPath.empty())
+        {
+            Engine::ModelHandle h = assets.loadModelAsync(def.modelPath);
+            if (h.isValid())
+            {
+                const uint32_t rmId = registry.ensureId("RenderModel");
+                p.signature.set(rmId);
+
+                RenderModel rm{};
+                rm.handle = h;
+                p.defaults[rmId] = rm;
+
+                // Also add per-entity animation state (defaults: Idle animation, playing, looping)
+                const uint32_t raId = registry.ensureId("RenderAnimation");
+                p.signature.set(raId);
+
+                RenderAnimation ra{};
+                ra.clipIndex = 65;    // Stand_Idle_0 animation
+                ra.playing = true;    // Start playing immediately
+                ra.loop = true;       // Loop the animation
+                ra.speed = 1.0f;
+                ra.timeSec = 0.0f;
+                p.defaults[raId] = ra;
+            }
+            else
+            {
+                ENGINE_LOG_WARN("[Prefab] Warning: Failed to load model mesh: %s for prefab %s", def.modelPath.c_str(), p.name.c_str());
+            }
+        }
+
+        // Resolve archetype (after any signature adjustments like RenderMesh)
+        p.archetypeId = archetypes.getOrCreate(p.signature);
+
+        for (const auto &d : def.defaults)
+            p.defaults.emplace(registry.ensureId(d.first), d.second);
+
+        // Validate defaults align with signature; drop mismatches to keep consistency.
+        if (!p.validateDefaults())
+        {
+            for (auto it = p.defaults.begin(); it != p.defaults.end();)
+            {
+                if (!p.signature.has(it->first))
+                    it = p.defaults.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        return p;
+    }
+
+    PrefabCache::PrefabCache(std::string path)
+        : m_path(std::move(path))
+    {
+        MappedFile file;
+        if (!file.open(m_path) || file.size() == 0)
+            return;
+
+        CacheReader r;
+        r.cur = reinterpret_cast<const uint8_t *>(file.data());
+        r.end = r.cur + file.size();
+        if (r.u32() != kCacheMagic || r.u32() != kCacheVersion)
+        {
+            ENGINE_LOG_WARN("[PrefabCache] Ignoring %s: not a version %u prefab cache", m_path.c_str(), kCacheVersion);
+            return;
+        }
+
+        const uint32_t entryCount = r.u32();
+        for (uint32_t i = 0; i < entryCount && r.ok; ++i)
+        {
+            const std::string source = r.str();
+            Entry entry;
+            entry.sourceHash = r.u64();
+            entry.def.name = r.str();
+            entry.def.modelPath = r.str();
+
+            const uint32_t componentCount = r.u32();
+            for (uint32_t c = 0; c < componentCount && r.ok; ++c)
+                entry.def.components.push_back(r.str());
+
+            const uint32_t defaultCount = r.u32();
+            for (uint32_t d = 0; d < defaultCount && r.ok; ++d)
+            {
+                const std::string component = r.str();
+                const uint32_t size = r.u32();
+                const bool known = visitDefaultType(component, [&](auto tag)
+                                                    {
+                                                        using T = decltype(tag);
+                                                        T v{};
+                                                        if (size != sizeof(T) || !r.raw(&v, sizeof(T)))
+                                                        {
+                                                            r.ok = false;
+                                                            return;
+                                                        }
+                                                        entry.def.defaults.emplace_back(component, DefaultValue(v)); });
+                if (!known)
+                    r.ok = false;
+            }
+
+            if (r.ok)
+                m_entries[source] = std::move(entry);
+        }
+
+        if (!r.ok)
+        {
+            ENGINE_LOG_WARN("[PrefabCache] Ignoring damaged cache file %s", m_path.c_str());
+            m_entries.clear();
+        }
+    }
+
+    bool PrefabCache::load(const std::string &sourcePath, PrefabDefinition &out)
+    {
+        FileData source;
+        if (!VirtualFileSystem::read(sourcePath, source) || source.empty())
+            return false;
+        const uint64_t hash = hashSource(source.data(), source.size());
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(sourcePath);
+            if (it != m_entries.end() && it->second.sourceHash == hash)
+            {
+                it->second.used = true;
+                out = it->second.def;
+                ++m_stats.hits;
+                return true;
+            }
+            ++m_stats.misses;
+        }
+
+        std::string error;
+        const std::string text(reinterpret_cast<const char *>(source.data()), source.size());
+        if (!parsePrefabJson(text, out, &error))
+        {
+            ENGINE_LOG_ERROR("[Prefab] Failed to parse %s: %s", sourcePath.c_str(), error.c_str());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry &entry = m_entries[sourcePath];
+        entry.sourceHash = hash;
+        entry.def = out;
+        entry.used = true;
+        m_dirty = true;
+        return true;
+    }
+
+    bool PrefabCache::save()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint32_t used = 0;
+        for (const auto &kv : m_entries)
+            used += kv.second.used ? 1u : 0u;
+
+        // Nothing reparsed and no source gone: the file on disk is current
+        if (!m_dirty && used == m_entries.size())
+            return true;
+
+        CacheWriter w;
+        w.u32(kCacheMagic);
+        w.u32(kCacheVersion);
+        w.u32(used);
+
+        for (const auto &kv : m_entries)
+        {
+            const Entry &entry = kv.second;
+            if (!entry.used)
+                continue;
+            w.str(kv.first);
+            w.u64(entry.sourceHash);
+            w.str(entry.def.name);
+            w.str(entry.def.modelPath);
+            w.u32(static_cast<uint32_t>(entry.def.components.size()));
+            for (const std::string &c : entry.def.components)
+                w.str(c);
+            w.u32(static_cast<uint32_t>(entry.def.defaults.size()));
+            for (const auto &d : entry.def.defaults)
+            {
+                w.str(d.first);
+                w.u32(d.second.size());
+                w.raw(d.second.data(), d.second.size());
+            }
+        }
+
+        // Write next to the target and swap it in, so a crash mid-write leaves the old file.
+        const std::string temp = m_path + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                ENGINE_LOG_WARN("[PrefabCache] Cannot write %s", temp.c_str());
+                return false;
+            }
+            file.write(reinterpret_cast<const char *>(w.bytes.data()), static_cast<std::streamsize>(w.bytes.size()));
+            if (!file.good())
+            {
+                ENGINE_LOG_WARN("[PrefabCache] Failed writing %s", temp.c_str());
+                return false;
+            }
+        }
+        std::remove(m_path.c_str());
+        if (std::rename(temp.c_str(), m_path.c_str()) != 0)
+        {
+            ENGINE_LOG_WARN("[PrefabCache] Cannot replace %s", m_path.c_str());
+            return false;
+        }
+        m_dirty = false;
+        return true;
+    }
+
+} // namespace Engine::ECS
@@ -0,0 +1,284 @@
+#include "utils/Profiler.h"
+#include "utils/AllocTracker.h"
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace Engine
+{
+    std::atomic<bool> Profiler::s_enabled{false};
+
+    namespace
+    {
+        // Scopes of one thread. The open-scope stack is only touched by its thread; 'events' is
+        // shared with endFrame() under 'mutex'.
+        struct ThreadBuffer
+        {
+            std::thread::id id;
+            uint32_t jobIndex = 0; // JobSystem::currentThreadIndex()
+
+            const char *names[Profiler::kMaxDepth] = {};
+            uint64_t starts[Profiler::kMaxDepth] = {};
+            uint64_t allocStarts[Profiler::kMaxDepth] = {}; // AllocTracker::threadAllocations()
+            uint64_t allocByteStarts[Profiler::kMaxDepth] = {};
+            uint32_t depth = 0;
+
+            std::mutex mutex;
+            std::vector<Profiler::Event> events;
+            uint32_t dropped = 0;
+            bool retired = false; // the thread has exited
+        };
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        };
+
+        Registry &GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        struct ThreadHandle
+        {
+            std::shared_ptr<ThreadBuffer> buffer;
+
+            ~ThreadHandle()
+            {
+                if (!buffer)
+                    return;
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                buffer->retired = true;
+            }
+        };
+
+        ThreadBuffer &LocalBuffer()
+        {
+            thread_local ThreadHandle handle;
+            if (!handle.buffer)
+            {
+                handle.buffer = std::make_shared<ThreadBuffer>();
+                handle.buffer->id = std::this_thread::get_id();
+                handle.buffer->jobIndex = JobSystem::currentThreadIndex();
+                Registry &registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.buffers.push_back(handle.buffer);
+            }
+            return *handle.buffer;
+        }
+
+        constexpr float kAverageSmoothing = 0.1f;
+
+        struct StatsEntry
+        {
+            const char *name = nullptr;
+            float history[Profiler::kStatsWindow] = {};
+            float frameMs = 0.0f; // accumulated during endFrame()
+            uint32_t frameCalls = 0;
+            uint32_t frameAllocations = 0;
+            uint64_t frameAllocBytes = 0;
+            float avgMs = 0.0f;
+            bool seen = false;
+            uint32_t idleFrames = 0;
+        };
+
+        // Owned by the thread calling endFrame()
+        struct FrameState
+        {
+            uint64_t frameStart = 0;
+            uint32_t cursor = 0; // history slot of the frame being published
+            Profiler::Frame frame;
+            std::unordered_map<std::string_view, StatsEntry> entries;
+            std::vector<Profiler::ScopeStats> stats;
+        };
+
+        FrameState &GetFrameState()
+        {
+            static FrameState state;
+            return state;
+        }
+
+        std::string ThreadLabel_Internal(const ThreadBuffer &buffer, uint32_t &otherThreads)
+        {
+            if (buffer.jobIndex != 0)
+                return "Worker " + std::to_string(buffer.jobIndex);
+            if (buffer.id == std::this_thread::get_id())
+                return "Main";
+            return "Thread " + std::to_string(++otherThreads);
+        }
+    } // namespace
+
+    void Profiler::setEnabled(bool enabled)
+    {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    uint64_t Profiler::now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    void Profiler::begin(const char *name)
+    {
+        ThreadBuffer &b = LocalBuffer();
+        if (b.depth < kMaxDepth)
+        {
+            b.names[b.depth] = name;
+            b.allocStarts[b.depth] = AllocTracker::threadAllocations();
+            b.allocByteStarts[b.depth] = AllocTracker::threadBytes();
+            b.starts[b.depth] = now();
+        }
+        ++b.depth; // deeper scopes are counted but not recorded
+    }
+
+    void Profiler::end()
+    {
+        const uint64_t endNs = now();
+        ThreadBuffer &b = LocalBuffer();
+        if (b.depth == 0)
+            return;
+        const uint32_t depth = --b.depth;
+        if (depth >= kMaxDepth)
+            return;
+
+        Event e;
+        e.name = b.names[depth];
+        e.startNs = b.starts[depth];
+        e.endNs = endNs;
+        e.depth = static_cast<uint16_t>(depth);
+        e.allocations = static_cast<uint32_t>(AllocTracker::threadAllocations() - b.allocStarts[depth]);
+        e.allocBytes = AllocTracker::threadBytes() - b.allocByteStarts[depth];
+
+        std::lock_guard<std::mutex> lock(b.mutex);
+        if (b.events.size() < kMaxEventsPerThread)
+            b.events.push_back(e);
+        else
+            ++b.dropped;
+    }
+
+    void Profiler::beginFrame()
+    {
+        GetFrameState().frameStart = now();
+    }
+
+    void Profiler::endFrame()
+    {
+        FrameState &s = GetFrameState();
+        Frame &frame = s.frame;
+        frame.startNs = s.frameStart;
+        frame.endNs = now();
+        frame.events.clear();
+        frame.threads.clear();
+        frame.dropped = 0;
+
+        // Drain every thread, dropping the buffers of threads that have exited
+        {
+            Registry &registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            uint32_t otherThreads = 0;
+            for (size_t i = 0; i < registry.buffers.size();)
+            {
+                ThreadBuffer &b = *registry.buffers[i];
+                std::lock_guard<std::mutex> bufferLock(b.mutex);
+                if (b.retired && b.events.empty())
+                {
+                    registry.buffers.erase(registry.buffers.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+
+                const uint16_t thread = static_cast<uint16_t>(frame.threads.size());
+                frame.threads.push_back(ThreadLabel_Internal(b, otherThreads));
+                const size_t first = frame.events.size();
+                for (Event e : b.events)
+                {
+                    e.thread = thread;
+                    frame.events.push_back(e);
+                }
+                // Scopes are recorded as they close, children before their parent
+                std::sort(frame.events.begin() + static_cast<std::ptrdiff_t>(first), frame.events.end(),
+                          [](const Event &x, const Event &y)
+                          { return x.startNs != y.startNs ? x.startNs < y.startNs : x.depth < y.depth; });
+                frame.dropped += b.dropped;
+                b.events.clear();
+                b.dropped = 0;
+                ++i;
+            }
+        }
+
+        if (!enabled())
+        {
+            frame.events.clear();
+            s.entries.clear();
+            s.stats.clear();
+            return;
+        }
+
+        for (const Event &e : frame.events)
+        {
+            StatsEntry &entry = s.entries[std::string_view(e.name)];
+            entry.name = e.name;
+            entry.frameMs += static_cast<float>(e.endNs - e.startNs) * 1e-6f;
+            ++entry.frameCalls;
+            entry.frameAllocations += e.allocations;
+            entry.frameAllocBytes += e.allocBytes;
+        }
+
+        s.stats.clear();
+        for (auto it = s.entries.begin(); it != s.entries.end();)
+        {
+            StatsEntry &entry = it->second;
+            entry.idleFrames = entry.frameCalls ? 0u : entry.idleFrames + 1u;
+            if (entry.idleFrames >= kStatsWindow)
+            {
+                it = s.entries.erase(it);
+                continue;
+            }
+
+            entry.history[s.cursor] = entry.frameMs;
+            entry.avgMs = entry.seen ? kAverageSmoothing * entry.frameMs + (1.0f - kAverageSmoothing) * entry.avgMs
+                                     : entry.frameMs;
+            entry.seen = true;
+
+            ScopeStats out;
+            out.name = entry.name;
+            out.lastMs = entry.frameMs;
+            out.avgMs = entry.avgMs;
+            out.maxMs = *std::max_element(entry.history, entry.history + kStatsWindow);
+            out.calls = entry.frameCalls;
+            out.allocations = entry.frameAllocations;
+            out.allocBytes = entry.frameAllocBytes;
+            s.stats.push_back(out);
+
+            entry.frameMs = 0.0f;
+            entry.frameCalls = 0;
+            entry.frameAllocations = 0;
+            entry.frameAllocBytes = 0;
+            ++it;
+        }
+        s.cursor = (s.cursor + 1) % kStatsWindow;
+
+        std::sort(s.stats.begin(), s.stats.end(), [](const ScopeStats &a, const ScopeStats &b)
+                  { return a.avgMs > b.avgMs; });
+    }
+
+    const Profiler::Frame &Profiler::lastFrame()
+    {
+        return GetFrameState().frame;
+    }
+
+    const std::vector<Profiler::ScopeStats> &Profiler::stats()
+    {
+        return GetFrameState().stats;
+    }
+
+} // namespace Engine
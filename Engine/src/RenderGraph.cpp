@@ -0,0 +1,715 @@
+#include "Engine/RenderGraph.h"
+#include "utils/DeletionQueue.h"
+#include "utils/Log.h"
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr VkAccessFlags kWriteAccess = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                               VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        // Imported state of resources not seen for this many frames is dropped (more than frames in flight).
+        constexpr uint64_t kImportStateFrames = 8;
+
+        template <typename T>
+        uint64_t HandleKey(T handle)
+        {
+            return (uint64_t)(handle); // dispatchable pointers and non-dispatchable uint64_t handles alike
+        }
+    } // namespace
+
+    RenderGraph::AccessInfo RenderGraph::Info(Access access)
+    {
+        switch (access)
+        {
+        case Access::IndirectRead:
+            return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, false};
+        case Access::VertexRead:
+            return {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, false};
+        case Access::IndexRead:
+            return {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, false};
+        case Access::UniformRead:
+            return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_UNIFORM_READ_BIT, false};
+        case Access::VertexShaderRead:
+            return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false};
+        case Access::MeshShaderRead:
+#if defined(VK_EXT_mesh_shader)
+            return {VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT, VK_ACCESS_SHADER_READ_BIT, false};
+#else
+            return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false};
+#endif
+        case Access::FragmentSampled:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false};
+        case Access::ComputeRead:
+        case Access::ComputeSampled:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false};
+        case Access::ComputeWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, true};
+        case Access::ComputeReadWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, true};
+        case Access::TransferRead:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, false};
+        case Access::TransferWrite:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, true};
+        case Access::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, true};
+        case Access::DepthAttachment:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, true};
+        case Access::DepthRead:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, false};
+        }
+        return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, true};
+    }
+
+    VkImageLayout RenderGraph::LayoutFor(Access access, VkImageAspectFlags aspect)
+    {
+        const bool depth = (aspect & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+        switch (access)
+        {
+        case Access::FragmentSampled:
+        case Access::ComputeSampled:
+        case Access::VertexShaderRead:
+            return depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        case Access::ComputeRead:
+        case Access::ComputeWrite:
+        case Access::ComputeReadWrite:
+        case Access::MeshShaderRead:
+            return VK_IMAGE_LAYOUT_GENERAL;
+        case Access::TransferRead:
+            return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        case Access::TransferWrite:
+            return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        case Access::ColorAttachment:
+            return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        case Access::DepthAttachment:
+            return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        case Access::DepthRead:
+            return VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        default:
+            return VK_IMAGE_LAYOUT_GENERAL;
+        }
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        destroy();
+    }
+
+    void RenderGraph::init(VkDevice device)
+    {
+        m_device = device;
+    }
+
+    void RenderGraph::destroy()
+    {
+        destroyTransients();
+        m_resources.clear();
+        m_passes.clear();
+        m_order.clear();
+        m_importIndex.clear();
+        m_importState.clear();
+        m_device = VK_NULL_HANDLE;
+    }
+
+    void RenderGraph::reset()
+    {
+        destroyTransients();
+        m_importState.clear();
+    }
+
+    void RenderGraph::beginFrame()
+    {
+        ++m_frame;
+        m_resources.clear();
+        m_passes.clear();
+        m_order.clear();
+        m_importIndex.clear();
+        m_asyncWaitStages = 0;
+        m_stats = Stats{};
+    }
+
+    RenderGraph::Handle RenderGraph::importImage(const char *name, VkImage image, VkImageView view, VkImageAspectFlags aspect,
+                                                 uint32_t mipLevels, VkImageLayout layout)
+    {
+        const uint64_t key = HandleKey(image);
+        auto found = m_importIndex.find(key);
+        if (found != m_importIndex.end())
+            return found->second;
+
+        Resource r;
+        r.name = name;
+        r.kind = Kind::ImportedImage;
+        r.key = key;
+        r.image = image;
+        r.view = view;
+        r.aspect = aspect;
+        r.mipLevels = std::max(mipLevels, 1u);
+        auto state = m_importState.find(key);
+        if (state != m_importState.end())
+            r.state = state->second.state;
+        else
+            r.state.layout = layout;
+
+        const Handle h = static_cast<Handle>(m_resources.size());
+        m_resources.push_back(r);
+        m_importIndex.emplace(key, h);
+        return h;
+    }
+
+    RenderGraph::Handle RenderGraph::importBuffer(const char *name, VkBuffer buffer)
+    {
+        const uint64_t key = HandleKey(buffer);
+        auto found = m_importIndex.find(key);
+        if (found != m_importIndex.end())
+            return found->second;
+
+        Resource r;
+        r.name = name;
+        r.kind = Kind::ImportedBuffer;
+        r.key = key;
+        r.buffer = buffer;
+        auto state = m_importState.find(key);
+        if (state != m_importState.end())
+            r.state = state->second.state;
+
+        const Handle h = static_cast<Handle>(m_resources.size());
+        m_resources.push_back(r);
+        m_importIndex.emplace(key, h);
+        return h;
+    }
+
+    RenderGraph::Handle RenderGraph::createImage(const char *name, const ImageDesc &desc)
+    {
+        Resource r;
+        r.name = name;
+        r.kind = Kind::TransientImage;
+        r.desc = desc;
+        r.desc.mipLevels = std::max(desc.mipLevels, 1u);
+        r.aspect = desc.aspect;
+        r.mipLevels = r.desc.mipLevels;
+        r.transient = m_stats.transientImages++;
+
+        const Handle h = static_cast<Handle>(m_resources.size());
+        m_resources.push_back(r);
+        return h;
+    }
+
+    void RenderGraph::PassBuilder::read(Handle resource, Access access)
+    {
+        m_graph.addUse(m_pass, resource, access, false, false);
+    }
+
+    void RenderGraph::PassBuilder::write(Handle resource, Access access, bool discard)
+    {
+        m_graph.addUse(m_pass, resource, access, true, discard);
+    }
+
+    void RenderGraph::PassBuilder::sideEffect()
+    {
+        m_graph.m_passes[m_pass].sideEffect = true;
+    }
+
+    void RenderGraph::addUse(uint32_t pass, Handle resource, Access access, bool write, bool discard)
+    {
+        if (resource >= m_resources.size())
+        {
+            ENGINE_LOG_ERROR("[RenderGraph] Pass '%s' uses an invalid resource", m_passes[pass].name);
+            return;
+        }
+        m_passes[pass].uses.push_back(Use{resource, access, write || Info(access).write, discard});
+    }
+
+    void RenderGraph::addPass(const char *name, Queue queue, const SetupFn &setup, ExecuteFn execute)
+    {
+        const uint32_t index = static_cast<uint32_t>(m_passes.size());
+        m_passes.emplace_back();
+        m_passes.back().name = name;
+        m_passes.back().queue = queue;
+        m_passes.back().execute = std::move(execute);
+        ++m_stats.passes;
+
+        PassBuilder builder(*this, index);
+        if (setup)
+            setup(builder);
+    }
+
+    void RenderGraph::compile()
+    {
+        cull();
+        assignQueues();
+        realizeTransients();
+        planBarriers();
+
+        // Keep imported state for the next frames; forget resources gone for a while (recreated buffers).
+        for (const Resource &r : m_resources)
+        {
+            if (r.kind != Kind::TransientImage)
+                m_importState[r.key] = ImportState{r.state, m_frame};
+        }
+        for (auto it = m_importState.begin(); it != m_importState.end();)
+        {
+            if (m_frame - it->second.frame > kImportStateFrames)
+                it = m_importState.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void RenderGraph::cull()
+    {
+        // Backwards: a pass lives if it has side effects or writes something a live later pass (or,
+        // for imported resources, the outside world) reads.
+        std::vector<bool> needed(m_resources.size());
+        for (size_t i = 0; i < m_resources.size(); ++i)
+            needed[i] = m_resources[i].kind != Kind::TransientImage;
+
+        for (size_t i = m_passes.size(); i-- > 0;)
+        {
+            Pass &p = m_passes[i];
+            bool alive = p.sideEffect;
+            for (const Use &u : p.uses)
+                alive = alive || (u.write && needed[u.resource]);
+            p.alive = alive;
+            if (!alive)
+                continue;
+            for (const Use &u : p.uses)
+            {
+                // Read-modify-write accesses (blending, depth tests, ComputeReadWrite) read the old contents too.
+                const bool readsOld = !u.write || (!u.discard && (Info(u.access).access & ~kWriteAccess) != 0);
+                if (readsOld)
+                    needed[u.resource] = true;
+            }
+        }
+
+        m_order.clear();
+        for (uint32_t i = 0; i < m_passes.size(); ++i)
+        {
+            if (m_passes[i].alive)
+                m_order.push_back(i);
+            else
+                ++m_stats.culledPasses;
+        }
+
+        for (uint32_t pos = 0; pos < m_order.size(); ++pos)
+        {
+            for (const Use &u : m_passes[m_order[pos]].uses)
+            {
+                Resource &r = m_resources[u.resource];
+                if (!r.used)
+                    r.firstUse = pos;
+                r.lastUse = pos;
+                r.used = true;
+            }
+        }
+    }
+
+    void RenderGraph::assignQueues()
+    {
+        // An async request holds if the pass touches only buffers that no graphics pass of this frame
+        // touched before it; graphics passes after it wait on the async submission instead.
+        std::vector<bool> touchedByGraphics(m_resources.size(), false);
+        for (uint32_t index : m_order)
+        {
+            Pass &p = m_passes[index];
+            if (p.queue == Queue::AsyncCompute)
+            {
+                bool ok = m_asyncEnabled;
+                for (const Use &u : p.uses)
+                    ok = ok && m_resources[u.resource].kind == Kind::ImportedBuffer && !touchedByGraphics[u.resource];
+                if (ok)
+                {
+                    ++m_stats.asyncPasses;
+                    continue;
+                }
+                p.queue = Queue::Graphics;
+            }
+            for (const Use &u : p.uses)
+                touchedByGraphics[u.resource] = true;
+        }
+    }
+
+    void RenderGraph::realizeTransients()
+    {
+        // Signature of the transient set: descriptions and lifetimes, in creation order.
+        m_signature.clear();
+        std::vector<Handle> transients;
+        for (Handle h = 0; h < m_resources.size(); ++h)
+        {
+            const Resource &r = m_resources[h];
+            if (r.kind != Kind::TransientImage)
+                continue;
+            transients.push_back(h);
+            m_signature.push_back((uint64_t(r.desc.format) << 32) | r.desc.usage);
+            m_signature.push_back((uint64_t(r.desc.extent.width) << 32) | r.desc.extent.height);
+            m_signature.push_back((uint64_t(r.desc.mipLevels) << 32) | r.desc.aspect);
+            m_signature.push_back(r.used ? ((uint64_t(r.firstUse) << 32) | r.lastUse) : ~uint64_t(0));
+        }
+
+        if (m_signature != m_transientSignature || m_transients.size() != transients.size())
+        {
+            retireTransients();
+            m_transientSignature = m_signature;
+
+            MemoryAllocator *allocator = MemoryAllocator::ForDevice(m_device);
+            std::vector<VkMemoryRequirements> reqs(transients.size());
+            m_transients.resize(transients.size());
+            for (size_t i = 0; i < transients.size(); ++i)
+            {
+                const Resource &r = m_resources[transients[i]];
+                if (!r.used)
+                    continue;
+
+                VkImageCreateInfo ici{};
+                ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                ici.imageType = VK_IMAGE_TYPE_2D;
+                ici.format = r.desc.format;
+                ici.extent = {r.desc.extent.width, r.desc.extent.height, 1};
+                ici.mipLevels = r.desc.mipLevels;
+                ici.arrayLayers = 1;
+                ici.samples = VK_SAMPLE_COUNT_1_BIT;
+                ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+                ici.usage = r.desc.usage;
+                ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                if (vkCreateImage(m_device, &ici, nullptr, &m_transients[i].image) != VK_SUCCESS)
+                {
+                    ENGINE_LOG_ERROR("[RenderGraph] vkCreateImage failed for transient '%s'", r.name);
+                    m_transients[i].image = VK_NULL_HANDLE;
+                    continue;
+                }
+                vkGetImageMemoryRequirements(m_device, m_transients[i].image, &reqs[i]);
+            }
+
+            // Greedy first-fit by first use: an image shares the memory of an earlier one whose
+            // lifetime ended before it starts, preferring the slot closest in size.
+            struct SlotPlan
+            {
+                VkMemoryRequirements req{};
+                uint32_t lastUse = 0;
+            };
+            std::vector<SlotPlan> plans;
+            std::vector<size_t> byFirstUse;
+            for (size_t i = 0; i < transients.size(); ++i)
+            {
+                if (m_transients[i].image != VK_NULL_HANDLE)
+                    byFirstUse.push_back(i);
+            }
+            std::sort(byFirstUse.begin(), byFirstUse.end(), [&](size_t a, size_t b)
+                      { return m_resources[transients[a]].firstUse < m_resources[transients[b]].firstUse; });
+
+            VkDeviceSize imageBytes = 0;
+            for (size_t i : byFirstUse)
+            {
+                const Resource &r = m_resources[transients[i]];
+                const VkMemoryRequirements &req = reqs[i];
+                imageBytes += req.size;
+
+                uint32_t best = kInvalid;
+                VkDeviceSize bestWaste = ~VkDeviceSize(0);
+                for (uint32_t s = 0; s < plans.size(); ++s)
+                {
+                    const SlotPlan &plan = plans[s];
+                    if (plan.lastUse >= r.firstUse || (plan.req.memoryTypeBits & req.memoryTypeBits) == 0)
+                        continue;
+                    const VkDeviceSize waste = plan.req.size > req.size ? plan.req.size - req.size : req.size - plan.req.size;
+                    if (waste < bestWaste)
+                    {
+                        best = s;
+                        bestWaste = waste;
+                    }
+                }
+                if (best == kInvalid)
+                {
+                    best = static_cast<uint32_t>(plans.size());
+                    plans.push_back(SlotPlan{req, r.lastUse});
+                }
+                else
+                {
+                    SlotPlan &plan = plans[best];
+                    plan.req.size = std::max(plan.req.size, req.size);
+                    plan.req.alignment = std::max(plan.req.alignment, req.alignment);
+                    plan.req.memoryTypeBits &= req.memoryTypeBits;
+                    plan.lastUse = r.lastUse;
+                }
+                m_transients[i].slot = best;
+            }
+
+            m_slots.resize(plans.size());
+            for (size_t s = 0; s < plans.size(); ++s)
+            {
+                VkResult res = allocator ? allocator->allocate(plans[s].req, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true,
+                                                               MemoryStrategy::General, m_slots[s].memory,
+                                                               MemoryCategory::RenderTargets)
+                                         : VK_ERROR_INITIALIZATION_FAILED;
+                if (res != VK_SUCCESS)
+                    ENGINE_LOG_ERROR("[RenderGraph] Transient memory allocation failed (%llu bytes)",
+                                     static_cast<unsigned long long>(plans[s].req.size));
+            }
+
+            for (size_t i : byFirstUse)
+            {
+                Transient &t = m_transients[i];
+                const Resource &r = m_resources[transients[i]];
+                const MemoryAllocation &mem = m_slots[t.slot].memory;
+                if (!mem.isValid() || vkBindImageMemory(m_device, t.image, mem.memory, mem.offset) != VK_SUCCESS)
+                {
+                    vkDestroyImage(m_device, t.image, nullptr);
+                    t.image = VK_NULL_HANDLE;
+                    continue;
+                }
+
+                VkImageViewCreateInfo vci{};
+                vci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                vci.image = t.image;
+                vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                vci.format = r.desc.format;
+                vci.subresourceRange.aspectMask = r.desc.aspect;
+                vci.subresourceRange.levelCount = r.desc.mipLevels;
+                vci.subresourceRange.layerCount = 1;
+                if (vkCreateImageView(m_device, &vci, nullptr, &t.view) != VK_SUCCESS)
+                    t.view = VK_NULL_HANDLE;
+            }
+
+            VkDeviceSize slotBytes = 0;
+            for (const SlotPlan &plan : plans)
+                slotBytes += plan.req.size;
+            m_stats.transientBytes = slotBytes;
+            m_stats.aliasedBytes = imageBytes > slotBytes ? imageBytes - slotBytes : 0;
+        }
+        else
+        {
+            for (const TransientSlot &slot : m_slots)
+                m_stats.transientBytes += slot.memory.size;
+        }
+        m_stats.transientSlots = static_cast<uint32_t>(m_slots.size());
+
+        for (Handle h : transients)
+        {
+            Resource &r = m_resources[h];
+            r.image = m_transients[r.transient].image;
+            r.view = m_transients[r.transient].view;
+        }
+    }
+
+    void RenderGraph::destroyTransients()
+    {
+        for (Transient &t : m_transients)
+        {
+            if (t.view != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, t.view, nullptr);
+            if (t.image != VK_NULL_HANDLE)
+                vkDestroyImage(m_device, t.image, nullptr);
+        }
+        m_transients.clear();
+        for (TransientSlot &slot : m_slots)
+            FreeMemory(slot.memory);
+        m_slots.clear();
+        m_transientSignature.clear();
+    }
+
+    void RenderGraph::retireTransients()
+    {
+        // Frames in flight may still use the old set: it goes once they are done, without a device wait
+        if (!m_transients.empty() || !m_slots.empty())
+        {
+            auto transients = std::make_shared<std::vector<Transient>>(std::move(m_transients));
+            auto slots = std::make_shared<std::vector<TransientSlot>>(std::move(m_slots));
+            VkDevice device = m_device;
+            DeletionQueue::Defer(device, [device, transients, slots]()
+                                 {
+                                     for (Transient &t : *transients)
+                                     {
+                                         if (t.view != VK_NULL_HANDLE)
+                                             vkDestroyImageView(device, t.view, nullptr);
+                                         if (t.image != VK_NULL_HANDLE)
+                                             vkDestroyImage(device, t.image, nullptr);
+                                     }
+                                     for (TransientSlot &slot : *slots)
+                                         FreeMemory(slot.memory);
+                                 });
+        }
+        m_transients.clear();
+        m_slots.clear();
+        m_transientSignature.clear();
+    }
+
+    void RenderGraph::planBarriers()
+    {
+        std::vector<bool> transientSeen(m_resources.size(), false);
+
+        for (uint32_t index : m_order)
+        {
+            Pass &p = m_passes[index];
+            Barriers &b = p.barriers;
+            b = Barriers{};
+            b.memory.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+            for (const Use &u : p.uses)
+            {
+                Resource &r = m_resources[u.resource];
+                State &s = r.state;
+                const AccessInfo info = Info(u.access);
+                const bool isImage = r.kind != Kind::ImportedBuffer;
+                const VkImageLayout layout = isImage ? LayoutFor(u.access, r.aspect) : VK_IMAGE_LAYOUT_UNDEFINED;
+                bool discard = u.discard;
+
+                if (r.kind == Kind::TransientImage && !transientSeen[u.resource])
+                {
+                    // First access this frame: wait for the slot's previous occupant, contents undefined.
+                    transientSeen[u.resource] = true;
+                    const TransientSlot *slot = r.image != VK_NULL_HANDLE ? &m_slots[m_transients[r.transient].slot] : nullptr;
+                    s = State{};
+                    s.writeStages = slot ? slot->lastStages : 0;
+                    s.writeAccess = slot ? slot->lastWriteAccess : 0;
+                    discard = true;
+                }
+
+                if (s.queue != p.queue)
+                {
+                    // Queue hop: the semaphore between the submissions orders and makes visible
+                    // everything before it (see Notes); the graphics side waits at this access.
+                    if (p.queue == Queue::Graphics)
+                        m_asyncWaitStages |= info.stages;
+                    s = State{};
+                    s.queue = p.queue;
+                }
+
+                const bool transition = isImage && (discard || layout != s.layout);
+                VkPipelineStageFlags src = 0;
+                VkAccessFlags srcAccess = 0;
+                bool needed = false;
+                if (u.write || transition)
+                {
+                    // WAW / WAR, or a layout transition (a write itself).
+                    src = s.writeStages | s.readStages;
+                    srcAccess = s.writeAccess;
+                    needed = transition || src != 0;
+                }
+                else if (s.writeStages != 0 &&
+                         ((info.stages & ~s.visibleStages) != 0 || (info.access & ~s.visibleAccess) != 0))
+                {
+                    // RAW not yet made visible to this stage.
+                    src = s.writeStages;
+                    srcAccess = s.writeAccess;
+                    needed = true;
+                }
+
+                if (needed)
+                {
+                    b.srcStages |= src;
+                    b.dstStages |= info.stages;
+                    if (isImage)
+                    {
+                        VkImageMemoryBarrier ib{};
+                        ib.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                        ib.srcAccessMask = srcAccess;
+                        ib.dstAccessMask = info.access;
+                        ib.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : s.layout;
+                        ib.newLayout = layout;
+                        ib.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                        ib.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                        ib.image = r.image;
+                        ib.subresourceRange.aspectMask = r.aspect;
+                        ib.subresourceRange.levelCount = r.mipLevels;
+                        ib.subresourceRange.layerCount = 1;
+                        if (ib.image != VK_NULL_HANDLE)
+                            b.images.push_back(ib);
+                    }
+                    else
+                    {
+                        b.memory.srcAccessMask |= srcAccess;
+                        b.memory.dstAccessMask |= info.access;
+                    }
+                }
+
+                if (u.write || transition)
+                {
+                    s.writeStages = info.stages;
+                    s.writeAccess = u.write ? (info.access & kWriteAccess) : 0;
+                    s.readStages = u.write ? 0 : info.stages;
+                    s.visibleStages = info.stages;
+                    s.visibleAccess = info.access;
+                }
+                else
+                {
+                    if (needed)
+                    {
+                        s.visibleStages |= info.stages;
+                        s.visibleAccess |= info.access;
+                    }
+                    s.readStages |= info.stages;
+                }
+                s.layout = isImage ? layout : s.layout;
+                s.queue = p.queue;
+            }
+
+            if (b.srcStages == 0 && b.dstStages != 0)
+                b.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            if (b.dstStages != 0)
+            {
+                ++m_stats.barrierBatches;
+                m_stats.imageBarriers += static_cast<uint32_t>(b.images.size());
+                if (b.memory.srcAccessMask != 0 || b.memory.dstAccessMask != 0)
+                    ++m_stats.memoryBarriers;
+            }
+        }
+
+        // What the next occupant of every transient slot waits for.
+        for (Handle h = 0; h < m_resources.size(); ++h)
+        {
+            const Resource &r = m_resources[h];
+            if (r.kind != Kind::TransientImage || !r.used || r.image == VK_NULL_HANDLE)
+                continue;
+            TransientSlot &slot = m_slots[m_transients[r.transient].slot];
+            slot.lastStages = r.state.writeStages | r.state.readStages;
+            slot.lastWriteAccess = r.state.writeAccess;
+        }
+    }
+
+    void RenderGraph::execute(VkCommandBuffer cmd, VkCommandBuffer asyncCmd)
+    {
+        if (hasAsyncWork() && asyncCmd == VK_NULL_HANDLE)
+            ENGINE_LOG_ERROR("[RenderGraph] Async passes compiled but no async command buffer given; recording them on graphics");
+
+        for (uint32_t index : m_order)
+        {
+            Pass &p = m_passes[index];
+            ENGINE_PROFILE_SCOPE(p.name);
+            VkCommandBuffer target = (p.queue == Queue::AsyncCompute && asyncCmd != VK_NULL_HANDLE) ? asyncCmd : cmd;
+
+            const Barriers &b = p.barriers;
+            if (b.dstStages != 0)
+            {
+                const bool memory = b.memory.srcAccessMask != 0 || b.memory.dstAccessMask != 0;
+                vkCmdPipelineBarrier(target, b.srcStages, b.dstStages, 0,
+                                     memory ? 1u : 0u, memory ? &b.memory : nullptr,
+                                     0, nullptr,
+                                     static_cast<uint32_t>(b.images.size()), b.images.empty() ? nullptr : b.images.data());
+            }
+            if (p.execute)
+                p.execute(target);
+        }
+    }
+
+    VkImage RenderGraph::getImage(Handle image) const
+    {
+        return image < m_resources.size() ? m_resources[image].image : VK_NULL_HANDLE;
+    }
+
+    VkImageView RenderGraph::getImageView(Handle image) const
+    {
+        return image < m_resources.size() ? m_resources[image].view : VK_NULL_HANDLE;
+    }
+
+} // namespace Engine
@@ -0,0 +1,99 @@
+#include "Engine/RenderStats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace Engine
+{
+    namespace
+    {
+        struct State
+        {
+            std::mutex mutex;
+            RenderStats::Frame current;
+            std::unordered_map<uint64_t, size_t> modelIndex; // key -> current.models
+            RenderStats::Frame last;
+        };
+
+        State &GetState()
+        {
+            static State s;
+            return s;
+        }
+    } // namespace
+
+    RenderCounters &RenderCounters::operator+=(const RenderCounters &o)
+    {
+        drawCalls += o.drawCalls;
+        instances += o.instances;
+        triangles += o.triangles;
+        visibleTriangles += o.visibleTriangles;
+        pipelineBinds += o.pipelineBinds;
+        descriptorBinds += o.descriptorBinds;
+        bufferBinds += o.bufferBinds;
+        uploadBytes += o.uploadBytes;
+        return *this;
+    }
+
+    bool RenderCounters::empty() const
+    {
+        return drawCalls == 0 && instances == 0 && triangles == 0 && visibleTriangles == 0 && pipelineBinds == 0 &&
+               descriptorBinds == 0 && bufferBinds == 0 && uploadBytes == 0;
+    }
+
+    void RenderStats::beginFrame()
+    {
+        State &s = GetState();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.current.passes.clear();
+        s.current.models.clear();
+        s.current.total = RenderCounters{};
+        s.modelIndex.clear();
+    }
+
+    void RenderStats::endFrame()
+    {
+        State &s = GetState();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        std::sort(s.current.models.begin(), s.current.models.end(), [](const ModelStats &a, const ModelStats &b)
+                  { return a.counters.triangles > b.counters.triangles; });
+        // Swap so both frames keep their capacity; beginFrame() clears the old one.
+        std::swap(s.last, s.current);
+        s.modelIndex.clear();
+    }
+
+    void RenderStats::addPass(const char *pass, const RenderCounters &counters)
+    {
+        State &s = GetState();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.current.total += counters;
+        for (PassStats &p : s.current.passes)
+        {
+            if (p.name == pass || std::strcmp(p.name, pass) == 0)
+            {
+                p.counters += counters;
+                return;
+            }
+        }
+        s.current.passes.push_back(PassStats{pass, counters});
+    }
+
+    void RenderStats::addModel(uint64_t key, const std::string &name, const RenderCounters &counters)
+    {
+        State &s = GetState();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto [it, inserted] = s.modelIndex.emplace(key, s.current.models.size());
+        if (inserted)
+            s.current.models.push_back(ModelStats{key, name, counters});
+        else
+            s.current.models[it->second].counters += counters;
+    }
+
+    const RenderStats::Frame &RenderStats::lastFrame()
+    {
+        return GetState().last;
+    }
+
+} // namespace Engine
@@ -1,13 +1,27 @@
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <thread>
 #include "Engine/Renderer.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
+#include "Engine/Camera.h"
+#include "utils/DeletionQueue.h"
 #include "utils/ImageUtils.h"
+#include "utils/JobSystem.h"
+#include "utils/Log.h"
+#include "utils/Profiler.h"
 
 namespace Engine
 {
+    // Frame pacing: smoothing of the pacing estimates, the low-latency sleep's safety margin (at least,
+    // or 10% of the display interval), and how long a present wait may block.
+    static constexpr float kPacingSmoothing = 0.1f;
+    static constexpr float kPacingMarginMs = 1.0f;
+    static constexpr float kPacingMaxIntervalMs = 250.0f; // longer gaps (resize, hitches) are not intervals
+    static constexpr uint64_t kPresentWaitTimeoutNs = 100000000ull;
+
     static VkFormat findSupportedFormat(
         VkPhysicalDevice phys,
         const std::vector<VkFormat> &candidates,
@@ -64,6 +78,13 @@ namespace Engine
 
         m_swapchainImageFormat = m_swapchain->GetImageFormat();
         m_extent = m_swapchain->GetExtent();
+
+        m_framesInFlight = m_maxFrames;
+#if defined(VK_KHR_present_wait)
+        if (m_ctx->SupportsPresentWait())
+            m_waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(m_device, "vkWaitForPresentKHR"));
+        m_presentWaitSupported = m_waitForPresent != nullptr;
+#endif
     }
 
     Renderer::~Renderer()
@@ -95,6 +116,7 @@ namespace Engine
 
         // prepare per-frame slots
         m_frames.resize(m_maxFrames);
+        m_pacing.assign(m_maxFrames, FramePacing{});
 
         // swapchain-dependent
         m_swapchainImageFormat = m_swapchain->GetImageFormat();
@@ -103,15 +125,20 @@ namespace Engine
         createDepthResources();
         createMainRenderPass();
         createFramebuffers();
+        createDepthPrepass();
+        createGlobalResources();
         createSyncObjects();
         createCommandPoolsAndBuffers();
         createTimestampQueryPool();
+        if (!m_uploadRing.init(m_device, m_ctx->GetPhysicalDevice(), m_maxFrames))
+            throw std::runtime_error("Renderer::init - failed to create the upload ring");
+        m_graph.init(m_device);
 
         // notify registered passes so they can create pipelines/resources that depend on renderpass/framebuffers
         for (auto &p : m_passes)
         {
             if (p)
-                p->onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+                createPass(*p);
         }
 
         m_initialized = true;
@@ -124,6 +151,7 @@ namespace Engine
 
         // prepare per-frame slots
         m_frames.resize(m_maxFrames);
+        m_pacing.assign(m_maxFrames, FramePacing{});
 
         // swapchain-dependent
         m_swapchainImageFormat = m_swapchain->GetImageFormat();
@@ -132,15 +160,20 @@ namespace Engine
         createDepthResources();
         createMainRenderPass();
         createFramebuffers();
+        createDepthPrepass();
+        createGlobalResources();
         createSyncObjects();
         createCommandPoolsAndBuffers();
         createTimestampQueryPool();
+        if (!m_uploadRing.init(m_device, m_ctx->GetPhysicalDevice(), m_maxFrames))
+            throw std::runtime_error("Renderer::init - failed to create the upload ring");
+        m_graph.init(m_device);
 
         // notify registered passes so they can create pipelines/resources that depend on renderpass/framebuffers
         for (auto &p : m_passes)
         {
             if (p)
-                p->onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+                createPass(*p);
         }
 
         m_initialized = true;
@@ -161,7 +194,11 @@ namespace Engine
                 p->onDestroy(*m_ctx);
         }
 
+        m_graph.destroy();
+        m_uploadRing.destroy();
+        destroyGlobalResources();
         destroyTimestampQueryPool();
+        destroySecondaryPools();
         destroyCommandPoolsAndBuffers();
         destroySyncObjects();
 
@@ -175,6 +212,7 @@ namespace Engine
         }
         m_framebuffers.clear();
 
+        destroyDepthPrepass();
         destroyDepthResources();
 
         // Destroy main render pass
@@ -195,10 +233,26 @@ namespace Engine
         if (m_initialized)
         {
             // Immediately call onCreate so the pass can create pipelines that depend on renderpass/framebuffers.
-            pass->onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+            createPass(*pass);
         }
     }
 
+    void Renderer::createPass(RenderPassModule &pass)
+    {
+        pass.setGlobalSetLayout(m_globalSetLayout);
+        pass.setDepthPrepass(m_depthPrepassRenderPass);
+        pass.onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+    }
+
+    void Renderer::setDepthPrepass(bool enabled)
+    {
+        if (m_depthPrepass == enabled)
+            return;
+        m_depthPrepass = enabled;
+        if (m_initialized)
+            recreateSwapchainDependent();
+    }
+
     void Renderer::createMainRenderPass()
     {
         if (m_depthFormat == VK_FORMAT_UNDEFINED)
@@ -217,15 +271,16 @@ namespace Engine
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
-        // Depth attachment (one image per swapchain image)
+        // Depth attachment (one image per swapchain image). The render graph moves it into the
+        // attachment layout and orders it against the pre-pass and the Hi-Z build (drawFrame()).
         VkAttachmentDescription depthAttachment{};
         depthAttachment.format = m_depthFormat;
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.loadOp = m_depthPrepass ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR; // keep what the pre-pass drew
         depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         VkAttachmentReference colorAttachmentRef{};
@@ -242,14 +297,14 @@ namespace Engine
         subpass.pColorAttachments = &colorAttachmentRef;
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-        // Subpass dependency from external -> subpass 0
+        // Subpass dependency from external -> subpass 0: the swapchain image (acquire semaphore wait)
         VkSubpassDependency dependency{};
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         dependency.srcAccessMask = 0;
-        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
         VkRenderPassCreateInfo rpInfo{};
         rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -307,10 +362,25 @@ namespace Engine
             throw std::runtime_error("Renderer::createDepthResources - failed to find supported depth format");
         }
 
+        // The Hi-Z build samples the pre-pass depth when the format allows it.
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        m_depthSampled = false;
+        if (m_depthPrepass)
+        {
+            VkFormatProperties props{};
+            vkGetPhysicalDeviceFormatProperties(m_ctx->GetPhysicalDevice(), m_depthFormat, &props);
+            m_depthSampled = (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+            if (m_depthSampled)
+                usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+            else
+                ENGINE_LOG_WARN("[Renderer] Depth format cannot be sampled: depth pre-pass without a Hi-Z pyramid");
+        }
+
         const auto &imageViews = m_swapchain->GetImageViews();
         m_depthImages.resize(imageViews.size(), VK_NULL_HANDLE);
-        m_depthMemories.resize(imageViews.size(), VK_NULL_HANDLE);
+        m_depthMemories.resize(imageViews.size());
         m_depthImageViews.resize(imageViews.size(), VK_NULL_HANDLE);
+        m_depthSampledViews.resize(m_depthSampled ? imageViews.size() : 0, VK_NULL_HANDLE);
 
         for (size_t i = 0; i < imageViews.size(); ++i)
         {
@@ -320,9 +390,10 @@ namespace Engine
                 m_extent.width,
                 m_extent.height,
                 m_depthFormat,
-                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                usage,
                 m_depthImages[i],
-                m_depthMemories[i]);
+                m_depthMemories[i],
+                MemoryCategory::RenderTargets);
             if (r != VK_SUCCESS)
             {
                 throw std::runtime_error("Renderer::createDepthResources - failed to create depth image");
@@ -338,11 +409,24 @@ namespace Engine
             {
                 throw std::runtime_error("Renderer::createDepthResources - failed to create depth image view");
             }
+
+            // Sampling reads the depth aspect only.
+            if (m_depthSampled &&
+                CreateImageView2D(m_device, m_depthImages[i], m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, m_depthSampledViews[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::createDepthResources - failed to create depth sampling view");
+            }
         }
     }
 
     void Renderer::destroyDepthResources()
     {
+        for (auto &iv : m_depthSampledViews)
+        {
+            if (iv != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, iv, nullptr);
+        }
+        m_depthSampledViews.clear();
         for (auto &iv : m_depthImageViews)
         {
             if (iv != VK_NULL_HANDLE)
@@ -361,20 +445,101 @@ namespace Engine
         }
         for (auto &mem : m_depthMemories)
         {
-            if (mem != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, mem, nullptr);
-                mem = VK_NULL_HANDLE;
-            }
+            FreeMemory(mem);
         }
         m_depthImageViews.clear();
         m_depthImages.clear();
         m_depthMemories.clear();
     }
 
+    void Renderer::createDepthPrepass()
+    {
+        destroyDepthPrepass();
+        if (!m_depthPrepass)
+            return;
+
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = m_depthFormat;
+        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 0;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 0;
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+        VkRenderPassCreateInfo rpInfo{};
+        rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        rpInfo.attachmentCount = 1;
+        rpInfo.pAttachments = &depthAttachment;
+        rpInfo.subpassCount = 1;
+        rpInfo.pSubpasses = &subpass;
+
+        // No subpass dependencies: the render graph orders the depth against the passes around it.
+        if (vkCreateRenderPass(m_device, &rpInfo, nullptr, &m_depthPrepassRenderPass) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Renderer::createDepthPrepass - failed to create render pass");
+        }
+
+        m_depthPrepassFramebuffers.resize(m_depthImageViews.size(), VK_NULL_HANDLE);
+        for (size_t i = 0; i < m_depthImageViews.size(); ++i)
+        {
+            VkFramebufferCreateInfo fbInfo{};
+            fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            fbInfo.renderPass = m_depthPrepassRenderPass;
+            fbInfo.attachmentCount = 1;
+            fbInfo.pAttachments = &m_depthImageViews[i];
+            fbInfo.width = m_extent.width;
+            fbInfo.height = m_extent.height;
+            fbInfo.layers = 1;
+
+            if (vkCreateFramebuffer(m_device, &fbInfo, nullptr, &m_depthPrepassFramebuffers[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::createDepthPrepass - failed to create framebuffer");
+            }
+        }
+
+        // Optional: the pre-pass still saves shading without the pyramid.
+        if (m_depthSampled)
+            m_hiZ.init(m_device, m_ctx->GetPhysicalDevice(), m_extent, m_depthSampledViews,
+                       VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL); // RenderGraph::Access::ComputeSampled
+    }
+
+    void Renderer::destroyDepthPrepass()
+    {
+        m_hiZ.destroy();
+        for (auto fb : m_depthPrepassFramebuffers)
+        {
+            if (fb != VK_NULL_HANDLE)
+                vkDestroyFramebuffer(m_device, fb, nullptr);
+        }
+        m_depthPrepassFramebuffers.clear();
+        if (m_depthPrepassRenderPass != VK_NULL_HANDLE)
+        {
+            vkDestroyRenderPass(m_device, m_depthPrepassRenderPass, nullptr);
+            m_depthPrepassRenderPass = VK_NULL_HANDLE;
+        }
+    }
+
     void Renderer::recreateSwapchainDependent()
     {
-        vkDeviceWaitIdle(m_device);
+        // Pipelines and framebuffers are destroyed directly below: wait for the device, and run the
+        // deferred destructions while it is idle anyway
+        if (DeletionQueue *deletionQueue = m_ctx->GetDeletionQueue())
+            deletionQueue->flush();
+        else
+            vkDeviceWaitIdle(m_device);
+        // The depth images and the pyramid are recreated: the graph forgets their layouts.
+        m_graph.reset();
 
         // Destroy pass-owned resources that depend on renderpass/framebuffers
         for (auto &p : m_passes)
@@ -390,6 +555,7 @@ namespace Engine
         }
         m_framebuffers.clear();
 
+        destroyDepthPrepass();
         destroyDepthResources();
 
         if (m_mainRenderPass != VK_NULL_HANDLE)
@@ -405,14 +571,150 @@ namespace Engine
         createDepthResources();
         createMainRenderPass();
         createFramebuffers();
+        createDepthPrepass();
 
         for (auto &p : m_passes)
         {
             if (!p)
                 continue;
             p->onResize(*m_ctx, m_extent);
-            p->onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+            createPass(*p);
+        }
+    }
+
+    void Renderer::createGlobalResources()
+    {
+        destroyGlobalResources();
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 1;
+        dsl.pBindings = &binding;
+        if (vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_globalSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Renderer::createGlobalResources - failed to create descriptor set layout");
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSize.descriptorCount = m_maxFrames;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = m_maxFrames;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_globalPool) != VK_SUCCESS)
+            throw std::runtime_error("Renderer::createGlobalResources - failed to create descriptor pool");
+
+        m_globalFrames.resize(m_maxFrames);
+        for (GlobalFrame &g : m_globalFrames)
+        {
+            VkBufferCreateInfo bufInfo{};
+            bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufInfo.size = sizeof(GlobalUniforms);
+            bufInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+            bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if (vkCreateBuffer(m_device, &bufInfo, nullptr, &g.buffer) != VK_SUCCESS ||
+                AllocateBufferMemory(m_device, g.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                     g.memory, MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS ||
+                !g.memory.mapped)
+                throw std::runtime_error("Renderer::createGlobalResources - failed to create uniform buffer");
+
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_globalPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &m_globalSetLayout;
+            if (vkAllocateDescriptorSets(m_device, &allocInfo, &g.set) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createGlobalResources - failed to allocate descriptor set");
+
+            VkDescriptorBufferInfo bufferInfo{g.buffer, 0, sizeof(GlobalUniforms)};
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = g.set;
+            write.dstBinding = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &bufferInfo;
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        }
+
+        m_framesDrawn = 0;
+        m_startTime = std::chrono::steady_clock::now();
+        m_lastFrameTime = m_startTime;
+    }
+
+    void Renderer::destroyGlobalResources()
+    {
+        for (GlobalFrame &g : m_globalFrames)
+        {
+            if (g.buffer != VK_NULL_HANDLE)
+                vkDestroyBuffer(m_device, g.buffer, nullptr);
+            FreeMemory(g.memory);
+        }
+        m_globalFrames.clear();
+        if (m_globalPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_globalPool, nullptr);
+            m_globalPool = VK_NULL_HANDLE;
+        }
+        if (m_globalSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_globalSetLayout, nullptr);
+            m_globalSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    void Renderer::updateGlobals(FrameContext &frame)
+    {
+        const float aspect = (m_extent.height > 0) ? (static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height)) : 1.0f;
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::vec3 position;
+        if (m_camera)
+        {
+            m_camera->SetAspect(aspect);
+            view = m_camera->GetViewMatrix();
+            proj = m_camera->GetProjectionMatrix();
+            position = m_camera->GetPosition();
         }
+        else
+        {
+            position = glm::vec3(0, 0, 3);
+            view = glm::lookAt(position, glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+            proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
+            proj[1][1] *= -1.0f;
+        }
+        const glm::mat4 viewProj = proj * view;
+
+        const auto now = std::chrono::steady_clock::now();
+        GlobalUniforms &g = m_globals;
+        std::memcpy(g.view, &view[0][0], sizeof(g.view));
+        std::memcpy(g.proj, &proj[0][0], sizeof(g.proj));
+        std::memcpy(g.viewProj, &viewProj[0][0], sizeof(g.viewProj));
+        g.cameraPos[0] = position.x;
+        g.cameraPos[1] = position.y;
+        g.cameraPos[2] = position.z;
+        g.cameraPos[3] = 1.0f;
+        g.time[0] = std::chrono::duration<float>(now - m_startTime).count();
+        g.time[1] = std::chrono::duration<float>(now - m_lastFrameTime).count();
+        g.frame[0] = static_cast<uint32_t>(m_framesDrawn);
+        g.frame[1] = frame.frameIndex;
+        g.frame[2] = m_extent.width;
+        g.frame[3] = m_extent.height;
+        m_lastFrameTime = now;
+        ++m_framesDrawn;
+
+        // The slot's fence was waited on: the GPU is done with its buffer.
+        GlobalFrame &slot = m_globalFrames[frame.frameIndex % static_cast<uint32_t>(m_globalFrames.size())];
+        std::memcpy(slot.memory.mapped, &g, sizeof(GlobalUniforms));
+        frame.globalSet = slot.set;
+        frame.globals = &m_globals;
     }
 
     void Renderer::createSyncObjects()
@@ -444,7 +746,8 @@ namespace Engine
 
     void Renderer::createCommandPoolsAndBuffers()
     {
-        // For now we create one command pool and buffer per frame in flight to support only single threaded rendering
+        // One command pool and primary buffer per frame in flight; parallel recording adds per-thread
+        // pools of secondary buffers (recordPassesParallel())
         for (uint32_t i = 0; i < m_maxFrames; ++i)
         {
             FrameContext &f = m_frames[i];
@@ -481,23 +784,36 @@ namespace Engine
         frame.frameIndex = m_currentFrame;
 
         // Wait for previous frame to finish
-        VkResult r = vkWaitForFences(m_device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+        VkResult r = VK_SUCCESS;
+        {
+            ENGINE_PROFILE_SCOPE("Renderer::waitFence");
+            r = vkWaitForFences(m_device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+        }
         if (r != VK_SUCCESS)
         {
-            fprintf(stderr, "vkWaitForFences failed: %d\n", r);
+            ENGINE_LOG_ERROR("vkWaitForFences failed: %d", static_cast<int>(r));
             // Recover strategy: mark device lost or try a soft return
             return;
         }
 
+        // The slot's previous frame has finished: what was queued for destruction up to it can go
+        DeletionQueue *deletionQueue = m_ctx->GetDeletionQueue();
+        if (deletionQueue && frame.deletionSerial != 0)
+            deletionQueue->collect(frame.deletionSerial);
+
         // Acquire next image
         uint32_t imageIndex = 0;
-        VkResult acquireRes = vkAcquireNextImageKHR(
-            m_device,
-            m_swapchain->GetSwapchain(),
-            UINT64_MAX,
-            frame.imageAcquiredSemaphore,
-            VK_NULL_HANDLE,
-            &imageIndex);
+        VkResult acquireRes = VK_SUCCESS;
+        {
+            ENGINE_PROFILE_SCOPE("Renderer::acquire");
+            acquireRes = vkAcquireNextImageKHR(
+                m_device,
+                m_swapchain->GetSwapchain(),
+                UINT64_MAX,
+                frame.imageAcquiredSemaphore,
+                VK_NULL_HANDLE,
+                &imageIndex);
+        }
 
         if (acquireRes == VK_ERROR_OUT_OF_DATE_KHR)
         {
@@ -509,10 +825,16 @@ namespace Engine
         }
         if (acquireRes != VK_SUCCESS && acquireRes != VK_SUBOPTIMAL_KHR)
         {
-            fprintf(stderr, "vkAcquireNextImageKHR failed: %d\n", acquireRes);
+            ENGINE_LOG_ERROR("vkAcquireNextImageKHR failed: %d", static_cast<int>(acquireRes));
             return; // Do not reset the fence on failure paths
         }
 
+        // The GPU is done with this slot: its upload memory can be rewritten.
+        m_uploadRing.beginFrame(m_currentFrame);
+        frame.uploadRing = &m_uploadRing;
+        frame.hiZ = m_hiZ.isValid() ? &m_hiZ : nullptr;
+        updateGlobals(frame);
+
         // Record command buffer
         vkResetCommandBuffer(frame.commandBuffer, 0);
 
@@ -521,57 +843,23 @@ namespace Engine
         beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
 
-        // GPU timestamp: reset queries for this frame
-        const uint32_t startQuery = m_currentFrame * 2;
-        const uint32_t endQuery = startQuery + 1;
-        if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE)
-        {
-            vkCmdResetQueryPool(frame.commandBuffer, m_timestampQueryPool, startQuery, 2);
-            // Write start timestamp (at top of pipe for earliest possible time)
-            vkCmdWriteTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampQueryPool, startQuery);
-        }
-
-        // Begin render pass
-        VkClearValue clears[2]{};
-        clears[0].color = {{0.02f, 0.02f, 0.04f, 1.0f}};
-        clears[1].depthStencil = {1.0f, 0};
-
-        VkRenderPassBeginInfo rpBegin{};
-        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        rpBegin.renderPass = m_mainRenderPass;
-        rpBegin.framebuffer = m_framebuffers[imageIndex];
-        rpBegin.renderArea.offset = {0, 0};
-        rpBegin.renderArea.extent = m_extent;
-        rpBegin.clearValueCount = 2;
-        rpBegin.pClearValues = clears;
-
-        vkCmdBeginRenderPass(frame.commandBuffer, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+        // GPU timestamps: the slot's previous frame is done, read its results and reset its queries
+        m_gpuProfiler.beginFrame(m_currentFrame, frame.commandBuffer);
 
-        // Let modules record draw commands
-        for (auto &p : m_passes)
+        // The frame's passes in a render graph, which places the barriers between them
         {
-            if (p)
-                p->record(frame, frame.commandBuffer);
+            ENGINE_PROFILE_SCOPE("Renderer::buildGraph");
+            buildFrameGraph(frame, imageIndex);
+            m_graph.compile();
         }
+        m_graph.execute(frame.commandBuffer);
 
-        // Render ImGui if callback is set
-        if (m_imguiRenderCallback)
-        {
-            m_imguiRenderCallback(frame.commandBuffer);
-        }
-
-        vkCmdEndRenderPass(frame.commandBuffer);
-
-        // GPU timestamp: write end timestamp (at bottom of pipe for latest possible time)
-        if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE)
-        {
-            vkCmdWriteTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampQueryPool, endQuery);
-        }
+        m_gpuProfiler.endFrame(frame.commandBuffer);
 
         vkEndCommandBuffer(frame.commandBuffer);
 
         // Submit to graphics queue
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT};
+        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submitInfo.waitSemaphoreCount = 1;
@@ -583,37 +871,24 @@ namespace Engine
         submitInfo.pSignalSemaphores = &frame.renderFinishedSemaphore;
 
         vkResetFences(m_device, 1, &frame.inFlightFence);
-        vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, frame.inFlightFence);
-
-        // Read GPU timestamp results from the PREVIOUS frame (which has definitely completed due to fence wait above)
-        // We read from the previous frame's queries since the current frame hasn't finished yet
-        if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE && m_maxFrames > 1)
-        {
-            // Calculate the previous frame's query indices
-            const uint32_t prevFrame = (m_currentFrame + m_maxFrames - 1) % m_maxFrames;
-            const uint32_t prevStartQuery = prevFrame * 2;
-            uint64_t timestamps[2] = {0, 0};
-            
-            VkResult queryResult = vkGetQueryPoolResults(
-                m_device,
-                m_timestampQueryPool,
-                prevStartQuery,
-                2,  // Query count
-                sizeof(timestamps),
-                timestamps,
-                sizeof(uint64_t),
-                VK_QUERY_RESULT_64_BIT
-            );
-
-            if (queryResult == VK_SUCCESS && timestamps[1] > timestamps[0])
-            {
-                // Calculate GPU time in milliseconds
-                // timestampPeriod is in nanoseconds per tick
-                const uint64_t ticksDelta = timestamps[1] - timestamps[0];
-                const float nanoseconds = static_cast<float>(ticksDelta) * m_timestampPeriod;
-                m_gpuTimeMs = nanoseconds / 1000000.0f;  // Convert ns to ms
-            }
+        {
+            ENGINE_PROFILE_SCOPE("Renderer::submit");
+            vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, frame.inFlightFence);
+        }
+        if (deletionQueue)
+            frame.deletionSerial = deletionQueue->endFrame();
+
+        // The slot's frame for input-to-photon: input time from waitForFrame(), present id below
+        FramePacing &pacing = m_pacing[m_currentFrame];
+        pacing.inputTime = m_inputTime;
+        pacing.presentId = 0;
+        pacing.pending = m_inputSampled;
+        if (m_inputSampled)
+        {
+            const float cpuMs = std::chrono::duration<float, std::milli>(PacingClock::now() - m_inputTime).count();
+            m_cpuFrameMs = m_cpuFrameMs > 0.0f ? m_cpuFrameMs + kPacingSmoothing * (cpuMs - m_cpuFrameMs) : cpuMs;
         }
+        m_inputSampled = false;
 
         // Present
         VkPresentInfoKHR presentInfo{};
@@ -625,11 +900,302 @@ namespace Engine
         presentInfo.pSwapchains = swapchains;
         presentInfo.pImageIndices = &imageIndex;
 
-        vkQueuePresentKHR(m_presentQueue, &presentInfo);
+#if defined(VK_KHR_present_wait)
+        // Every present carries an id once the device has present waits, so the low-latency mode can
+        // be switched on at any time. Ids only grow; a new swapchain starts waiting from its first.
+        VkPresentIdKHR presentIds{};
+        if (m_presentWaitSupported)
+        {
+            if (m_presentSwapchain != swapchains[0])
+            {
+                m_presentSwapchain = swapchains[0];
+                m_swapchainFirstPresentId = m_presentId + 1;
+            }
+            pacing.presentId = ++m_presentId;
+            presentIds.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+            presentIds.swapchainCount = 1;
+            presentIds.pPresentIds = &pacing.presentId;
+            presentInfo.pNext = &presentIds;
+        }
+#endif
+
+        {
+            ENGINE_PROFILE_SCOPE("Renderer::present");
+            vkQueuePresentKHR(m_presentQueue, &presentInfo);
+        }
         // Advance frame index
         m_currentFrame = (m_currentFrame + 1) % m_maxFrames;
     }
 
+    void Renderer::setFramesInFlight(uint32_t frames)
+    {
+        m_framesInFlight = std::clamp(frames, 1u, std::max(m_maxFrames, 1u));
+    }
+
+    void Renderer::waitForFrame()
+    {
+        if (!m_initialized)
+            return;
+
+        // Frames-in-flight limit: the next frame starts once the one submitted m_framesInFlight frames
+        // ago has finished. With every slot in use that is the slot drawFrame() reuses next.
+        const uint32_t slot = (m_currentFrame + m_maxFrames - m_framesInFlight) % m_maxFrames;
+        VkResult r = vkWaitForFences(m_device, 1, &m_frames[slot].inFlightFence, VK_TRUE, UINT64_MAX);
+        if (r != VK_SUCCESS)
+        {
+            ENGINE_LOG_ERROR("vkWaitForFences failed: %d", static_cast<int>(r));
+            return;
+        }
+        const bool presentPaced = m_lowLatency && m_presentWaitSupported;
+        if (presentPaced)
+            waitForPresentQueue();
+
+        // The display interval: time between pacing points once the waits above have blocked. It is the
+        // refresh interval when the display limits the frame rate, the frame time when it does not.
+        const PacingClock::time_point woke = PacingClock::now();
+        if (m_lastPacingWake != PacingClock::time_point{})
+        {
+            const float intervalMs = std::chrono::duration<float, std::milli>(woke - m_lastPacingWake).count();
+            if (intervalMs < kPacingMaxIntervalMs)
+                m_displayIntervalMs = m_displayIntervalMs > 0.0f
+                                          ? m_displayIntervalMs + kPacingSmoothing * (intervalMs - m_displayIntervalMs)
+                                          : intervalMs;
+        }
+        m_lastPacingWake = woke;
+
+        // Without present waits: frames the GPU has finished since the last pacing point, on screen
+        // about one display interval later
+        if (!presentPaced)
+        {
+            const auto scanout = std::chrono::duration_cast<PacingClock::duration>(
+                std::chrono::duration<float, std::milli>(m_displayIntervalMs));
+            for (uint32_t i = 0; i < m_maxFrames; ++i)
+            {
+                if (m_pacing[i].pending && vkGetFenceStatus(m_device, m_frames[i].inFlightFence) == VK_SUCCESS)
+                    recordInputLatency(m_pacing[i], woke + scanout, false);
+            }
+        }
+
+        // Just-in-time start: sleep off the part of the display interval the frame's CPU and GPU work
+        // (as measured over the last frames) does not need, so its input is sampled as late as possible.
+        m_pacingSleepMs = 0.0f;
+        if (m_lowLatency && m_displayIntervalMs > 0.0f)
+        {
+            const float marginMs = std::max(kPacingMarginMs, 0.1f * m_displayIntervalMs);
+            m_pacingSleepMs = std::max(0.0f, m_displayIntervalMs - (m_cpuFrameMs + m_gpuProfiler.getFrameMs()) - marginMs);
+            if (m_pacingSleepMs > 0.0f)
+                std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(m_pacingSleepMs));
+        }
+
+        m_inputTime = PacingClock::now();
+        m_inputSampled = true;
+    }
+
+    void Renderer::waitForPresentQueue()
+    {
+#if defined(VK_KHR_present_wait)
+        if (!m_waitForPresent || m_presentSwapchain == VK_NULL_HANDLE || m_presentSwapchain != m_swapchain->GetSwapchain())
+            return;
+
+        // At most m_framesInFlight - 1 presents may still be queued: wait for the one before them
+        const uint64_t queued = m_framesInFlight - 1;
+        if (m_presentId < m_swapchainFirstPresentId + queued)
+            return;
+        const uint64_t target = m_presentId - queued;
+        const VkResult r = m_waitForPresent(m_device, m_presentSwapchain, target, kPresentWaitTimeoutNs);
+        if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR)
+            return; // timeout, or the swapchain is out of date: drawFrame() recreates it
+
+        const PacingClock::time_point onScreen = PacingClock::now();
+        for (FramePacing &p : m_pacing)
+        {
+            if (!p.pending || p.presentId == 0 || p.presentId > target)
+                continue;
+            if (p.presentId == target)
+                recordInputLatency(p, onScreen, true);
+            else
+                p.pending = false; // on screen before this wait: its time is unknown
+        }
+#endif
+    }
+
+    void Renderer::recordInputLatency(FramePacing &pacing, PacingClock::time_point onScreen, bool fromPresent)
+    {
+        pacing.pending = false;
+        const float ms = std::chrono::duration<float, std::milli>(onScreen - pacing.inputTime).count();
+        if (m_inputLatencyMs > 0.0f && fromPresent == m_latencyFromPresent)
+            m_inputLatencyMs += kPacingSmoothing * (ms - m_inputLatencyMs);
+        else
+            m_inputLatencyMs = ms;
+        m_latencyFromPresent = fromPresent;
+    }
+
+    void Renderer::buildFrameGraph(FrameContext &frame, uint32_t imageIndex)
+    {
+        using Access = RenderGraph::Access;
+        using Queue = RenderGraph::Queue;
+        m_graph.beginFrame();
+
+        // The swapchain color image stays with the main render pass and the acquire/present semaphores.
+        const RenderGraph::Handle depth = m_graph.importImage("depth", m_depthImages[imageIndex], m_depthImageViews[imageIndex],
+                                                              depthAspectFlags(m_depthFormat), 1);
+
+        // Compute work the draws depend on (e.g. GPU crowd simulation writing instance buffers), one
+        // pass per module, then the modules' own passes
+        for (auto &p : m_passes)
+        {
+            if (!p)
+                continue;
+            RenderPassModule *module = p.get();
+            m_graph.addPass(
+                "compute", Queue::Graphics,
+                [&](RenderGraph::PassBuilder &b)
+                {
+                    b.sideEffect();
+                    module->declareCompute(m_graph, b, frame);
+                },
+                [this, module, &frame](VkCommandBuffer cmd)
+                {
+                    ENGINE_PROFILE_SCOPE(module->name());
+                    const uint32_t scope = m_gpuProfiler.beginScope(cmd, module->name(), "compute");
+                    module->recordCompute(frame, cmd);
+                    m_gpuProfiler.endScope(cmd, scope);
+                });
+        }
+        for (auto &p : m_passes)
+        {
+            if (p)
+                p->setupGraph(m_graph, frame);
+        }
+
+        // Depth pre-pass, then the pyramid the next frame's culling tests against
+        if (m_depthPrepassRenderPass != VK_NULL_HANDLE)
+        {
+            m_graph.addPass(
+                "depth prepass", Queue::Graphics,
+                [&](RenderGraph::PassBuilder &b)
+                {
+                    b.write(depth, Access::DepthAttachment, true);
+                    for (auto &p : m_passes)
+                    {
+                        if (p)
+                            p->declareDraws(m_graph, b, frame);
+                    }
+                },
+                [this, &frame, imageIndex](VkCommandBuffer cmd)
+                { recordDepthPrepass(frame, imageIndex, cmd); });
+
+            if (m_hiZ.isValid())
+            {
+                const RenderGraph::Handle hiZ = m_graph.importImage("hi-z", m_hiZ.getImage(), m_hiZ.getView(),
+                                                                    VK_IMAGE_ASPECT_COLOR_BIT, m_hiZ.getMipCount());
+                m_graph.addPass(
+                    "hi-z build", Queue::Graphics,
+                    [&](RenderGraph::PassBuilder &b)
+                    {
+                        b.read(depth, Access::ComputeSampled);
+                        b.write(hiZ, Access::ComputeWrite, true);
+                    },
+                    [this, imageIndex](VkCommandBuffer cmd)
+                    {
+                        const uint32_t scope = m_gpuProfiler.beginScope(cmd, "HiZPyramid", "compute");
+                        m_hiZ.build(cmd, imageIndex);
+                        m_gpuProfiler.endScope(cmd, scope);
+                    });
+            }
+        }
+
+        m_graph.addPass(
+            "main", Queue::Graphics,
+            [&](RenderGraph::PassBuilder &b)
+            {
+                b.sideEffect(); // presented
+                b.write(depth, Access::DepthAttachment, m_depthPrepassRenderPass == VK_NULL_HANDLE);
+                for (auto &p : m_passes)
+                {
+                    if (p)
+                        p->declareDraws(m_graph, b, frame);
+                }
+            },
+            [this, &frame, imageIndex](VkCommandBuffer cmd)
+            { recordMainPass(frame, imageIndex, cmd); });
+    }
+
+    void Renderer::recordDepthPrepass(FrameContext &frame, uint32_t imageIndex, VkCommandBuffer cmd)
+    {
+        VkClearValue depthClear{};
+        depthClear.depthStencil = {1.0f, 0};
+
+        VkRenderPassBeginInfo prepassBegin{};
+        prepassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        prepassBegin.renderPass = m_depthPrepassRenderPass;
+        prepassBegin.framebuffer = m_depthPrepassFramebuffers[imageIndex];
+        prepassBegin.renderArea.offset = {0, 0};
+        prepassBegin.renderArea.extent = m_extent;
+        prepassBegin.clearValueCount = 1;
+        prepassBegin.pClearValues = &depthClear;
+
+        vkCmdBeginRenderPass(cmd, &prepassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        for (auto &p : m_passes)
+        {
+            if (!p)
+                continue;
+            ENGINE_PROFILE_SCOPE(p->name());
+            const uint32_t scope = m_gpuProfiler.beginScope(cmd, p->name(), "depth");
+            p->recordDepthPrepass(frame, cmd);
+            m_gpuProfiler.endScope(cmd, scope);
+        }
+        vkCmdEndRenderPass(cmd);
+    }
+
+    void Renderer::recordMainPass(FrameContext &frame, uint32_t imageIndex, VkCommandBuffer cmd)
+    {
+        VkClearValue clears[2]{};
+        clears[0].color = {{0.02f, 0.02f, 0.04f, 1.0f}};
+        clears[1].depthStencil = {1.0f, 0};
+
+        VkRenderPassBeginInfo rpBegin{};
+        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin.renderPass = m_mainRenderPass;
+        rpBegin.framebuffer = m_framebuffers[imageIndex];
+        rpBegin.renderArea.offset = {0, 0};
+        rpBegin.renderArea.extent = m_extent;
+        rpBegin.clearValueCount = 2;
+        rpBegin.pClearValues = clears;
+
+        if (m_jobs)
+        {
+            // Modules and ImGui record secondary command buffers on the job system
+            vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            recordPassesParallel(frame, m_framebuffers[imageIndex]);
+        }
+        else
+        {
+            vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+            // Let modules record draw commands
+            for (auto &p : m_passes)
+            {
+                if (!p)
+                    continue;
+                ENGINE_PROFILE_SCOPE(p->name());
+                const uint32_t scope = m_gpuProfiler.beginScope(cmd, p->name(), "draw");
+                p->record(frame, cmd);
+                m_gpuProfiler.endScope(cmd, scope);
+            }
+
+            // Render ImGui if callback is set
+            if (m_imguiRenderCallback)
+            {
+                const uint32_t scope = m_gpuProfiler.beginScope(cmd, "ImGui", "draw");
+                m_imguiRenderCallback(cmd);
+                m_gpuProfiler.endScope(cmd, scope);
+            }
+        }
+
+        vkCmdEndRenderPass(cmd);
+    }
+
     void Renderer::destroySyncObjects()
     {
         for (auto &f : m_frames)
@@ -665,44 +1231,151 @@ namespace Engine
         }
     }
 
-    void Renderer::createTimestampQueryPool()
+    void Renderer::recordPassesParallel(FrameContext &frame, VkFramebuffer framebuffer)
     {
-        destroyTimestampQueryPool();
+        // One pool per recording thread for this slot; the GPU is done with its last use.
+        const uint32_t threads = m_jobs->threadCount();
+        if (m_secondaryPools.size() < m_maxFrames)
+            m_secondaryPools.resize(m_maxFrames);
+        std::vector<SecondaryPool> &pools = m_secondaryPools[frame.frameIndex];
+        for (SecondaryPool &sp : pools)
+        {
+            vkResetCommandPool(m_device, sp.pool, 0);
+            sp.used = 0;
+        }
+        while (pools.size() < threads)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = m_ctx->GetGraphicsQueueFamilyIndex();
 
-        // Check if the device supports timestamps
-        VkPhysicalDeviceProperties props{};
-        vkGetPhysicalDeviceProperties(m_ctx->GetPhysicalDevice(), &props);
+            SecondaryPool sp;
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &sp.pool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::recordPassesParallel - failed to create command pool");
+            }
+            pools.push_back(std::move(sp));
+        }
 
-        if (props.limits.timestampComputeAndGraphics == VK_FALSE)
+        // Slices are decided here, in registration order; ImGui is not thread safe and records on this
+        // thread while the jobs run.
+        m_recordTasks.clear();
+        for (auto &p : m_passes)
         {
-            m_timestampsSupported = false;
-            return;
+            if (!p)
+                continue;
+            const uint32_t slices = p->prepareRecord(frame, threads);
+            for (uint32_t s = 0; s < slices; ++s)
+                m_recordTasks.push_back(RecordTask{p.get(), s, slices, VK_NULL_HANDLE});
         }
+        if (m_imguiRenderCallback)
+            m_recordTasks.push_back(RecordTask{});
 
-        m_timestampPeriod = props.limits.timestampPeriod; // Nanoseconds per tick
-        m_timestampsSupported = true;
+        JobSystem::Counter counter;
+        for (RecordTask &task : m_recordTasks)
+        {
+            if (!task.pass)
+                continue;
+            m_jobs->submit(counter, [this, &frame, &task, framebuffer]()
+                           {
+                               ENGINE_PROFILE_SCOPE(task.pass->name());
+                               task.cmd = beginSecondary(frame.frameIndex, framebuffer);
+                               if (task.cmd == VK_NULL_HANDLE)
+                                   return;
+                               const uint32_t scope = m_gpuProfiler.beginScope(task.cmd, task.pass->name(), "draw");
+                               task.pass->recordSlice(frame, task.cmd, task.slice, task.sliceCount);
+                               m_gpuProfiler.endScope(task.cmd, scope);
+                               vkEndCommandBuffer(task.cmd);
+                           });
+        }
+        if (m_imguiRenderCallback)
+        {
+            RecordTask &ui = m_recordTasks.back();
+            ui.cmd = beginSecondary(frame.frameIndex, framebuffer);
+            if (ui.cmd != VK_NULL_HANDLE)
+            {
+                const uint32_t scope = m_gpuProfiler.beginScope(ui.cmd, "ImGui", "draw");
+                m_imguiRenderCallback(ui.cmd);
+                m_gpuProfiler.endScope(ui.cmd, scope);
+                vkEndCommandBuffer(ui.cmd);
+            }
+        }
+        m_jobs->wait(counter);
 
-        // Create a query pool with 2 queries per frame (start and end)
-        // We use 2 * maxFrames to have per-frame queries
-        VkQueryPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
-        poolInfo.queryCount = m_maxFrames * 2; // 2 timestamps per frame
+        m_secondaryCmds.clear();
+        for (const RecordTask &task : m_recordTasks)
+        {
+            if (task.cmd != VK_NULL_HANDLE)
+                m_secondaryCmds.push_back(task.cmd);
+        }
+        if (!m_secondaryCmds.empty())
+            vkCmdExecuteCommands(frame.commandBuffer, static_cast<uint32_t>(m_secondaryCmds.size()), m_secondaryCmds.data());
+    }
 
-        if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_timestampQueryPool) != VK_SUCCESS)
+    VkCommandBuffer Renderer::beginSecondary(uint32_t frameSlot, VkFramebuffer framebuffer)
+    {
+        SecondaryPool &sp = m_secondaryPools[frameSlot][JobSystem::currentThreadIndex()];
+        if (sp.used == sp.buffers.size())
         {
-            m_timestampsSupported = false;
-            m_timestampQueryPool = VK_NULL_HANDLE;
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = sp.pool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &cmd) != VK_SUCCESS)
+            {
+                ENGINE_LOG_ERROR("[Renderer] Failed to allocate a secondary command buffer");
+                return VK_NULL_HANDLE;
+            }
+            sp.buffers.push_back(cmd);
         }
+        VkCommandBuffer cmd = sp.buffers[sp.used++];
+
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.renderPass = m_mainRenderPass;
+        inheritance.subpass = 0;
+        inheritance.framebuffer = framebuffer;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritance;
+        vkBeginCommandBuffer(cmd, &beginInfo);
+        return cmd;
     }
 
-    void Renderer::destroyTimestampQueryPool()
+    void Renderer::destroySecondaryPools()
     {
-        if (m_timestampQueryPool != VK_NULL_HANDLE)
+        for (auto &pools : m_secondaryPools)
         {
-            vkDestroyQueryPool(m_device, m_timestampQueryPool, nullptr);
-            m_timestampQueryPool = VK_NULL_HANDLE;
+            for (SecondaryPool &sp : pools)
+            {
+                if (sp.pool != VK_NULL_HANDLE)
+                    vkDestroyCommandPool(m_device, sp.pool, nullptr);
+            }
         }
-        m_timestampsSupported = false;
+        m_secondaryPools.clear();
+    }
+
+    void Renderer::createTimestampQueryPool()
+    {
+        m_gpuProfiler.init(m_device, m_ctx->GetPhysicalDevice(), m_ctx->GetGraphicsQueueFamilyIndex(), m_maxFrames,
+                           m_ctx->SupportsPipelineStatistics(), m_ctx->SupportsCalibratedTimestamps());
+        m_gpuProfiler.setPipelineStatistics(m_pipelineStatistics);
+    }
+
+    void Renderer::destroyTimestampQueryPool()
+    {
+        m_gpuProfiler.destroy();
+    }
+
+    void Renderer::setPipelineStatistics(bool enabled)
+    {
+        m_pipelineStatistics = enabled;
+        m_gpuProfiler.setPipelineStatistics(enabled);
     }
 }
\ No newline at end of file
@@ -1,56 +1,46 @@
 #include "assets/MeshFormats.h"
-#include <cstdio>
+#include "assets/MeshCodec.h"
+#include "utils/VirtualFileSystem.h"
 #include <cstring>
 
 namespace Engine
 {
 
-    static bool fread_exact(FILE *f, void *dst, size_t bytes)
+    static bool range_inside(uint64_t offset, uint64_t bytes, uint64_t fileSize)
     {
-        return std::fread(dst, 1, bytes, f) == bytes;
+        return offset <= fileSize && bytes <= fileSize - offset;
     }
-    static size_t file_size(FILE *f)
+
+    static void resize_indices(MeshData &out)
     {
-        long cur = std::ftell(f);
-        std::fseek(f, 0, SEEK_END);
-        long end = std::ftell(f);
-        std::fseek(f, cur, SEEK_SET);
-        return end >= 0 ? static_cast<size_t>(end) : 0;
+        if (out.indexFormat == 1)
+            out.indices32.resize(out.indexCount);
+        else
+            out.indices16.resize(out.indexCount);
     }
 
-    bool LoadSMeshV0FromFile(const std::string &path, MeshData &out)
+    static void *index_data(MeshData &out)
     {
-        FILE *f = std::fopen(path.c_str(), "rb");
-        if (!f)
-            return false;
+        return out.indexFormat == 1 ? static_cast<void *>(out.indices32.data()) : static_cast<void *>(out.indices16.data());
+    }
 
+    static bool load_smesh_v0(const uint8_t *base, uint64_t fsize, MeshData &out)
+    {
         SMeshHeaderV0 hdr{};
-        if (!fread_exact(f, &hdr, sizeof(hdr)))
-        {
-            std::fclose(f);
+        if (fsize < sizeof(hdr))
             return false;
-        }
+        std::memcpy(&hdr, base, sizeof(hdr));
 
         if (hdr.vertexStride != 32)
-        {
-            std::fclose(f);
             return false;
-        }
         if (hdr.indexFormat > 1u)
-        {
-            std::fclose(f);
             return false;
-        }
 
-        size_t fsize = file_size(f);
         size_t vertexBytes = static_cast<size_t>(hdr.vertexCount) * hdr.vertexStride;
         size_t indexBytes = static_cast<size_t>(hdr.indexCount) * (hdr.indexFormat == 0 ? sizeof(uint16_t) : sizeof(uint32_t));
-        if (hdr.vertexDataOffset + vertexBytes > fsize ||
-            hdr.indexDataOffset + indexBytes > fsize)
-        {
-            std::fclose(f);
+        if (!range_inside(hdr.vertexDataOffset, vertexBytes, fsize) ||
+            !range_inside(hdr.indexDataOffset, indexBytes, fsize))
             return false;
-        }
 
         out.vertexCount = hdr.vertexCount;
         out.indexCount = hdr.indexCount;
@@ -59,37 +49,77 @@ namespace Engine
         std::memcpy(out.aabbMin, hdr.aabbMin, sizeof(out.aabbMin));
         std::memcpy(out.aabbMax, hdr.aabbMax, sizeof(out.aabbMax));
 
-        out.vertexBytes.resize(vertexBytes);
-        std::fseek(f, static_cast<long>(hdr.vertexDataOffset), SEEK_SET);
-        if (!fread_exact(f, out.vertexBytes.data(), out.vertexBytes.size()))
-        {
-            std::fclose(f);
+        out.vertexBytes.assign(base + hdr.vertexDataOffset, base + hdr.vertexDataOffset + vertexBytes);
+        resize_indices(out);
+        std::memcpy(index_data(out), base + hdr.indexDataOffset, indexBytes);
+        return true;
+    }
+
+    static bool load_smesh_v1(const uint8_t *base, uint64_t fsize, MeshData &out)
+    {
+        SMeshHeaderV1 hdr{};
+        if (fsize < sizeof(hdr))
             return false;
-        }
+        std::memcpy(&hdr, base, sizeof(hdr));
+
+        if (hdr.versionMajor != SMESH_VERSION_MAJOR || hdr.headerSize < sizeof(hdr))
+            return false;
+        if (hdr.vertexStride != 32 || hdr.indexFormat > 1u)
+            return false;
+        if (!range_inside(hdr.vertexDataOffset, hdr.vertexDataSize, fsize) ||
+            !range_inside(hdr.indexDataOffset, hdr.indexDataSize, fsize))
+            return false;
+
+        const size_t vertexBytes = static_cast<size_t>(hdr.vertexCount) * hdr.vertexStride;
+        const size_t indexSize = hdr.indexFormat == 0 ? sizeof(uint16_t) : sizeof(uint32_t);
+        const size_t indexBytes = static_cast<size_t>(hdr.indexCount) * indexSize;
+        const bool vertexCodec = (hdr.flags & SMESH_VERTEX_CODEC) != 0;
+        const bool indexCodec = (hdr.flags & SMESH_INDEX_CODEC) != 0;
+        if ((!vertexCodec && hdr.vertexDataSize != vertexBytes) || (!indexCodec && hdr.indexDataSize != indexBytes))
+            return false;
+
+        out.vertexCount = hdr.vertexCount;
+        out.indexCount = hdr.indexCount;
+        out.vertexStride = hdr.vertexStride;
+        out.indexFormat = hdr.indexFormat;
+        std::memcpy(out.aabbMin, hdr.aabbMin, sizeof(out.aabbMin));
+        std::memcpy(out.aabbMax, hdr.aabbMax, sizeof(out.aabbMax));
 
-        if (hdr.indexFormat == 1)
+        const uint8_t *vertexSrc = base + hdr.vertexDataOffset;
+        const uint8_t *indexSrc = base + hdr.indexDataOffset;
+
+        out.vertexBytes.resize(vertexBytes);
+        if (vertexCodec)
         {
-            out.indices32.resize(hdr.indexCount);
-            std::fseek(f, static_cast<long>(hdr.indexDataOffset), SEEK_SET);
-            if (!fread_exact(f, out.indices32.data(), out.indices32.size() * sizeof(uint32_t)))
-            {
-                std::fclose(f);
+            if (!meshcodec::DecodeVertexBuffer(out.vertexBytes.data(), hdr.vertexCount, hdr.vertexStride, vertexSrc,
+                                               static_cast<size_t>(hdr.vertexDataSize)))
                 return false;
-            }
         }
         else
-        {
-            out.indices16.resize(hdr.indexCount);
-            std::fseek(f, static_cast<long>(hdr.indexDataOffset), SEEK_SET);
-            if (!fread_exact(f, out.indices16.data(), out.indices16.size() * sizeof(uint16_t)))
-            {
-                std::fclose(f);
-                return false;
-            }
-        }
+            std::memcpy(out.vertexBytes.data(), vertexSrc, vertexBytes);
 
-        std::fclose(f);
+        resize_indices(out);
+        if (indexCodec)
+            return meshcodec::DecodeIndexBuffer(index_data(out), hdr.indexCount, indexSize, indexSrc, static_cast<size_t>(hdr.indexDataSize));
+        std::memcpy(index_data(out), indexSrc, indexBytes);
         return true;
     }
 
-} // namespace Engine
\ No newline at end of file
+    bool LoadSMeshFromFile(const std::string &path, MeshData &out)
+    {
+        FileData file;
+        if (!VirtualFileSystem::read(path, file))
+            return false;
+
+        const uint8_t *base = file.data();
+        const uint64_t fsize = file.size();
+
+        uint32_t magic = 0;
+        if (fsize >= sizeof(magic))
+            std::memcpy(&magic, base, sizeof(magic));
+        if (magic == SMESH_MAGIC)
+            return load_smesh_v1(base, fsize, out);
+        return load_smesh_v0(base, fsize, out);
+    }
+
+} // namespace Engine
@@ -1,6 +1,6 @@
 #include "assets/SModelLoader.h"
+#include "assets/MeshCodec.h"
 
-#include <fstream>
 #include <sstream>
 #include <cstring> // std::memcpy
 #include <limits>
@@ -88,33 +88,24 @@ namespace Engine
             outView = SModelFileView{}; // reset
 
             // --------------------------
-            // Read file bytes
+            // Read the file (packed or loose)
             // --------------------------
-            std::ifstream file(path, std::ios::binary | std::ios::ate);
-            if (!file.is_open())
+            // The record tables and the blob are used in place: no copy of the file is made before
+            // the blob slices go to staging memory (unless it is stored compressed in a pack).
+            if (!VirtualFileSystem::read(path, outView.file))
             {
                 outError = "Failed to open file: " + path;
                 return false;
             }
-
-            const std::streamsize fileSize = file.tellg();
-            if (fileSize <= 0)
+            if (outView.file.empty())
             {
                 outError = "File is empty: " + path;
                 return false;
             }
 
-            file.seekg(0, std::ios::beg);
-
-            outView.fileBytes.resize(static_cast<size_t>(fileSize));
-            if (!file.read(reinterpret_cast<char *>(outView.fileBytes.data()), fileSize))
-            {
-                outError = "Failed to read file bytes: " + path;
-                return false;
-            }
-
-            const uint64_t uFileSize = static_cast<uint64_t>(outView.fileBytes.size());
-            if (uFileSize < sizeof(SModelHeader))
+            const uint8_t *base = outView.data();
+            const uint64_t uFileSize = outView.size();
+            if (uFileSize < kSModelHeaderV6Size)
             {
                 outError = "File too small to contain SModelHeader.";
                 return false;
@@ -123,7 +114,7 @@ namespace Engine
             // --------------------------
             // Interpret header
             // --------------------------
-            outView.header = reinterpret_cast<const SModelHeader *>(outView.fileBytes.data());
+            outView.header = reinterpret_cast<const SModelHeader *>(base);
 
             // Basic compatibility
             if (!isHeaderCompatible(*outView.header))
@@ -132,6 +123,13 @@ namespace Engine
                 return false;
             }
 
+            // V7 headers carry the meshlet fields as well.
+            if (outView.header->versionMajor >= 7 && uFileSize < sizeof(SModelHeader))
+            {
+                outError = "File too small to contain SModelHeader.";
+                return false;
+            }
+
             // Extra sanity check: header fileSizeBytes should match actual file size
             if (outView.header->fileSizeBytes != 0 && outView.header->fileSizeBytes != uFileSize)
             {
@@ -248,10 +246,20 @@ namespace Engine
                 }
             }
 
+            // V7: meshlet tables
+            if (outView.header->versionMajor >= 7)
+            {
+                if (!tableRangeValid<SModelMeshletRecord>(outView.header->meshletsOffset, outView.header->meshletCount, uFileSize, outError))
+                    return false;
+                if (!tableRangeValid<uint32_t>(outView.header->meshletVerticesOffset, outView.header->meshletVertexCount, uFileSize, outError))
+                    return false;
+                if (!tableRangeValid<uint8_t>(outView.header->meshletTrianglesOffset, outView.header->meshletTriangleBytes, uFileSize, outError))
+                    return false;
+            }
+
             // --------------------------
             // Build pointers/views
             // --------------------------
-            const uint8_t *base = outView.fileBytes.data();
 
             outView.meshes = reinterpret_cast<const SModelMeshRecord *>(base + outView.header->meshesOffset);
             outView.primitives = reinterpret_cast<const SModelPrimitiveRecord *>(base + outView.header->primitivesOffset);
@@ -306,6 +314,20 @@ namespace Engine
                     return false;
             }
 
+            // V7: meshlet pointers (optional sections)
+            if (outView.header->versionMajor >= 7)
+            {
+                outView.meshlets = ptrAt<SModelMeshletRecord>(base, uFileSize, outView.header->meshletsOffset, outView.header->meshletCount, outError);
+                if (!outError.empty())
+                    return false;
+                outView.meshletVertices = ptrAt<uint32_t>(base, uFileSize, outView.header->meshletVerticesOffset, outView.header->meshletVertexCount, outError);
+                if (!outError.empty())
+                    return false;
+                outView.meshletTriangles = ptrAt<uint8_t>(base, uFileSize, outView.header->meshletTrianglesOffset, outView.header->meshletTriangleBytes, outError);
+                if (!outError.empty())
+                    return false;
+            }
+
             // --------------------------
             // Validate record internal offsets (blob offsets)
             // --------------------------
@@ -337,14 +359,44 @@ namespace Engine
                     return false;
                 }
 
+                if ((m.layoutFlags & VTX_COMPACT) != 0 && m.vertexStride != kCompactVertexStride)
+                {
+                    outError = "Compact mesh has invalid vertexStride (meshIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
+
+                // V9 codec streams: only their decoder knows their size, it checks the slice when the
+                // mesh is uploaded
+                const bool vertexCodec = (m.layoutFlags & MESH_VERTEX_CODEC) != 0;
+                const bool indexCodec = (m.layoutFlags & MESH_INDEX_CODEC) != 0;
+                if ((vertexCodec || indexCodec) && outView.header->versionMajor < 9)
+                {
+                    outError = "Mesh uses codec streams before V9 (meshIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
+                if ((vertexCodec && (m.vertexStride > meshcodec::kMaxVertexStride || m.vertexDataSize == 0)) ||
+                    (indexCodec && m.indexDataSize == 0))
+                {
+                    outError = "Codec mesh has invalid stream sizes (meshIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
+
                 // Ensure vertex blob size matches count*stride if cooked in that way.
                 // Not strictly required, but good for catching tool mistakes.
                 const uint64_t expectedVBSize = uint64_t(m.vertexCount) * uint64_t(m.vertexStride);
-                if (m.vertexDataSize != expectedVBSize)
+                if (!vertexCodec && m.vertexDataSize != expectedVBSize)
                 {
                     outError = "Mesh vertexDataSize mismatch (meshIndex=" + std::to_string(i) + ")";
                     return false;
                 }
+
+                // Index bytes are staged straight from the blob, so the slice must hold all of them.
+                const uint64_t expectedIBSize = uint64_t(m.indexCount) * (m.indexType == 0 ? sizeof(uint16_t) : sizeof(uint32_t));
+                if (!indexCodec && m.indexDataSize < expectedIBSize)
+                {
+                    outError = "Mesh indexDataSize too small (meshIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
             }
 
             // Validate texture image slices
@@ -357,6 +409,17 @@ namespace Engine
                     outError = "Texture image data slice out of blob bounds (textureIndex=" + std::to_string(i) + ")";
                     return false;
                 }
+
+                // V8 block-compressed textures are uploaded as stored: the slice must be exactly their mip chain.
+                if (BlockBytes(t.encoding) != 0)
+                {
+                    if (outView.header->versionMajor < 8 || t.width == 0 || t.height == 0 ||
+                        t.imageDataSize != BlockMipChainBytes(t.encoding, t.width, t.height))
+                    {
+                        outError = "Block-compressed texture has an invalid size or mip chain (textureIndex=" + std::to_string(i) + ")";
+                        return false;
+                    }
+                }
             }
 
             // Validate primitive references
@@ -376,10 +439,74 @@ namespace Engine
                     return false;
                 }
 
+                // Mesh LOD chain: coarser levels come later in the table, which also rules out cycles.
+                if (p.lodNext != 0)
+                {
+                    const SModelPrimitiveRecord *lod = (p.lodNext > i && p.lodNext < outView.header->primitiveCount)
+                                                           ? &outView.primitives[p.lodNext]
+                                                           : nullptr;
+                    if (!lod || lod->meshIndex != p.meshIndex || lod->materialIndex != p.materialIndex || lod->skinIndex != p.skinIndex)
+                    {
+                        outError = "Primitive lodNext is invalid (primitiveIndex=" + std::to_string(i) + ")";
+                        return false;
+                    }
+                }
+
                 // If indexCount is 0 in cooked data, we can treat it as "draw full mesh later".
                 // But having 0 is usually not intended; keep it allowed for flexibility.
             }
 
+            // V7: validate meshlets (grouped by primitive, inside the tables and the primitive's range)
+            const uint32_t meshletCount = outView.meshletCount();
+            for (uint32_t i = 0; i < meshletCount; i++)
+            {
+                const SModelMeshletRecord &m = outView.meshlets[i];
+                const std::string where = " (meshletIndex=" + std::to_string(i) + ")";
+
+                if (m.primitiveIndex >= outView.header->primitiveCount || (i > 0 && m.primitiveIndex < outView.meshlets[i - 1].primitiveIndex))
+                {
+                    outError = "Meshlet primitiveIndex is invalid" + where;
+                    return false;
+                }
+                if (m.vertexCount == 0 || m.vertexCount > kMeshletMaxVertices || m.triangleCount == 0 || m.triangleCount > kMeshletMaxTriangles)
+                {
+                    outError = "Meshlet vertexCount/triangleCount out of range" + where;
+                    return false;
+                }
+                if (uint64_t(m.firstVertex) + m.vertexCount > outView.meshletVertexCount() ||
+                    (uint64_t(m.firstTriangle) + m.triangleCount) * 3u > outView.meshletTriangleBytes())
+                {
+                    outError = "Meshlet table range out of bounds" + where;
+                    return false;
+                }
+
+                const SModelPrimitiveRecord &p = outView.primitives[m.primitiveIndex];
+                if (uint64_t(m.firstIndex) + uint64_t(m.triangleCount) * 3u > p.indexCount)
+                {
+                    outError = "Meshlet index range outside its primitive" + where;
+                    return false;
+                }
+
+                const uint32_t meshVertexCount = outView.meshes[p.meshIndex].vertexCount;
+                for (uint32_t v = 0; v < m.vertexCount; ++v)
+                {
+                    if (outView.meshletVertices[m.firstVertex + v] >= meshVertexCount)
+                    {
+                        outError = "Meshlet references invalid vertex" + where;
+                        return false;
+                    }
+                }
+                const uint8_t *tris = outView.meshletTriangles + size_t(m.firstTriangle) * 3u;
+                for (uint32_t t = 0; t < uint32_t(m.triangleCount) * 3u; ++t)
+                {
+                    if (tris[t] >= m.vertexCount)
+                    {
+                        outError = "Meshlet triangle references invalid local vertex" + where;
+                        return false;
+                    }
+                }
+            }
+
             // Validate material texture indices
             for (uint32_t i = 0; i < outView.header->materialCount; i++)
             {
@@ -526,9 +653,14 @@ namespace Engine
             {
                 return interp == uint8_t(SModelAnimInterpolation::Step) || interp == uint8_t(SModelAnimInterpolation::Linear) || interp == uint8_t(SModelAnimInterpolation::CubicSpline);
             };
-            auto isValidValueType = [](uint8_t vt)
+            const uint16_t versionMajor = outView.header->versionMajor;
+            auto isValidValueType = [versionMajor](uint8_t vt)
             {
-                return vt == uint8_t(SModelAnimValueType::Vec3) || vt == uint8_t(SModelAnimValueType::Quat);
+                if (vt == uint8_t(SModelAnimValueType::Vec3) || vt == uint8_t(SModelAnimValueType::Quat))
+                    return true;
+                // V5: packed samplers
+                return versionMajor >= 5 &&
+                       (vt == uint8_t(SModelAnimValueType::Vec3Range) || vt == uint8_t(SModelAnimValueType::QuatSmallest3));
             };
 
             // Validate clips
@@ -608,13 +740,11 @@ namespace Engine
                     return false;
                 }
 
-                const uint64_t expected = (s.valueType == uint8_t(SModelAnimValueType::Vec3))
-                                              ? uint64_t(s.timeCount) * 3ull
-                                              : uint64_t(s.timeCount) * 4ull;
+                const uint64_t expected = packedValueWords(s.valueType, s.timeCount);
 
                 if (uint64_t(s.valueCount) != expected)
                 {
-                    outError = "Animation sampler valueCount does not match timeCount * valueWidth";
+                    outError = "Animation sampler valueCount does not match timeCount and valueType";
                     return false;
                 }
 
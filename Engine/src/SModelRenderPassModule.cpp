@@ -1,18 +1,26 @@
 #include "Engine/SModelRenderPassModule.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
-#include "Engine/PerformanceMonitor.h"
+#include "Engine/RenderStats.h"
+#include "Engine/UploadRing.h"
 #include "assets/ModelAsset.h"
 #include "assets/MeshAsset.h"
 #include "assets/MaterialAsset.h"
+#include "utils/DeletionQueue.h"
 #include "utils/ImageUtils.h"
+#include "utils/Log.h"
+#include "utils/PipelineCache.h"
+#include "utils/Profiler.h"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstring>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
-#include <unordered_set>
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace Engine
@@ -32,6 +40,45 @@ namespace Engine
         return glm::mat4(1.0f);
     }
 
+    // Stages of the mesh shader path; none without VK_EXT_mesh_shader headers.
+#if defined(VK_EXT_mesh_shader)
+    static constexpr VkShaderStageFlags kMeshPathStages = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+#else
+    static constexpr VkShaderStageFlags kMeshPathStages = 0;
+#endif
+
+    static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+    {
+        return alignment > 1 ? ((v + alignment - 1) / alignment) * alignment : v;
+    }
+
+    // One number per model handle: baked palette order, RenderStats keys.
+    static uint64_t modelKey(const ModelHandle &h)
+    {
+        return (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id);
+    }
+
+    // Clip planes (a, b, c, d) of a view-projection matrix, unit normals pointing inside: left,
+    // right, bottom, top, near (w + z >= 0, conservative for 0..1 depth), far.
+    static void frustumPlanes(const glm::mat4 &m, float out[6][4])
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            const int axis = i / 2;
+            const float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+            float len2 = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                out[i][c] = m[c][3] + sign * m[c][axis];
+                if (c < 3)
+                    len2 += out[i][c] * out[i][c];
+            }
+            const float inv = (len2 > 0.0f) ? 1.0f / std::sqrt(len2) : 0.0f;
+            for (int c = 0; c < 4; ++c)
+                out[i][c] *= inv;
+        }
+    }
+
     SModelRenderPassModule::~SModelRenderPassModule()
     {
         // resources freed in onDestroy
@@ -97,23 +144,9 @@ namespace Engine
                 return false;
         }
 
-        // Descriptor pool (size tuned to current model if available)
-        uint32_t uniqueMatCount = 32;
-        if (m_assets && m_model.isValid())
-        {
-            if (ModelAsset *model = m_assets->getModel(m_model))
-            {
-                std::unordered_set<uint64_t> unique;
-                unique.reserve(model->primitives.size());
-                for (const auto &p : model->primitives)
-                {
-                    if (p.material.isValid())
-                        unique.insert(p.material.id);
-                }
-                if (!unique.empty())
-                    uniqueMatCount = static_cast<uint32_t>(unique.size());
-            }
-        }
+        // One pool serves the materials of every batched model, with room for the sets a texture
+        // restream retires (freed a few frames later).
+        const uint32_t uniqueMatCount = 2u * kMaterialSetCapacity;
 
         VkDescriptorPoolSize poolSize{};
         poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -121,6 +154,7 @@ namespace Engine
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         poolInfo.maxSets = uniqueMatCount;
         poolInfo.poolSizeCount = 1;
         poolInfo.pPoolSizes = &poolSize;
@@ -136,9 +170,12 @@ namespace Engine
     {
         m_materialSetCache.clear();
 
+        // Queued after the retired sets' frees, so it runs after them
         if (m_materialPool != VK_NULL_HANDLE)
         {
-            vkDestroyDescriptorPool(m_device, m_materialPool, nullptr);
+            VkDevice device = m_device;
+            VkDescriptorPool pool = m_materialPool;
+            DeletionQueue::Defer(device, [device, pool]() { vkDestroyDescriptorPool(device, pool, nullptr); });
             m_materialPool = VK_NULL_HANDLE;
         }
 
@@ -161,20 +198,6 @@ namespace Engine
         if (m_materialPool == VK_NULL_HANDLE || m_materialSetLayout == VK_NULL_HANDLE)
             return VK_NULL_HANDLE;
 
-        auto it = m_materialSetCache.find(h.id);
-        if (it != m_materialSetCache.end())
-            return it->second;
-
-        VkDescriptorSetAllocateInfo alloc{};
-        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc.descriptorPool = m_materialPool;
-        alloc.descriptorSetCount = 1;
-        alloc.pSetLayouts = &m_materialSetLayout;
-
-        VkDescriptorSet set = VK_NULL_HANDLE;
-        if (vkAllocateDescriptorSets(m_device, &alloc, &set) != VK_SUCCESS)
-            return VK_NULL_HANDLE;
-
         VkImageView view = m_fallbackWhiteTexture.getView();
         VkSampler sampler = m_fallbackWhiteTexture.getSampler();
 
@@ -190,6 +213,30 @@ namespace Engine
             }
         }
 
+        // A restreamed texture has a new view: a new set, since frames in flight may still use the
+        // old one (freed through the deletion queue once they are done)
+        auto it = m_materialSetCache.find(h.id);
+        if (it != m_materialSetCache.end())
+        {
+            if (it->second.view == view)
+                return it->second.set;
+            VkDevice device = m_device;
+            VkDescriptorPool pool = m_materialPool;
+            VkDescriptorSet retired = it->second.set;
+            DeletionQueue::Defer(device, [device, pool, retired]() { vkFreeDescriptorSets(device, pool, 1, &retired); });
+            m_materialSetCache.erase(it);
+        }
+
+        VkDescriptorSetAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = m_materialPool;
+        alloc.descriptorSetCount = 1;
+        alloc.pSetLayouts = &m_materialSetLayout;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(m_device, &alloc, &set) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+
         VkDescriptorImageInfo di{};
         di.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         di.imageView = view;
@@ -205,93 +252,383 @@ namespace Engine
         write.pImageInfo = &di;
         vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
 
-        m_materialSetCache.emplace(h.id, set);
+        m_materialSetCache.emplace(h.id, MaterialSet{set, view});
         return set;
     }
 
-    void SModelRenderPassModule::setModelMatrix(const float *m16)
+    bool SModelRenderPassModule::createBindlessResources(VulkanContext &ctx, size_t frameCount)
     {
-        if (!m16)
-        {
-            setIdentity(m_pc.model);
-            return;
-        }
-        std::memcpy(m_pc.model, m16, sizeof(float) * 16);
+        destroyBindlessResources();
+        if (!ctx.SupportsDescriptorIndexing() || !m_fallbackWhiteTexture.isValid())
+            return false;
+
+        if (frameCount == 0)
+            frameCount = 1;
+
+        // The array is sized once, as large as the fragment stage allows (up to kMaxBindlessTextures);
+        // it is partially bound, so only the written elements need to be valid.
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &props);
+        const VkPhysicalDeviceLimits &limits = props.limits;
+        m_bindlessTextureCapacity = std::min({kMaxBindlessTextures, limits.maxPerStageDescriptorSamplers,
+                                              limits.maxPerStageDescriptorSampledImages, limits.maxDescriptorSetSamplers,
+                                              limits.maxDescriptorSetSampledImages});
+        if (m_bindlessTextureCapacity < 2)
+            return false;
+
+        // Bindings: 0 texture array, 1 material table.
+        VkDescriptorSetLayoutBinding bindings[2]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = m_bindlessTextureCapacity;
+        bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        const VkDescriptorBindingFlags bindingFlags[2] = {VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, 0};
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+        flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        flagsInfo.bindingCount = 2;
+        flagsInfo.pBindingFlags = bindingFlags;
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.pNext = &flagsInfo;
+        dsl.bindingCount = 2;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_bindlessSetLayout) != VK_SUCCESS)
+            return false;
+
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = static_cast<uint32_t>(frameCount) * m_bindlessTextureCapacity;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount);
+
+        VkDescriptorPoolCreateInfo pci{};
+        pci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pci.maxSets = static_cast<uint32_t>(frameCount);
+        pci.poolSizeCount = 2;
+        pci.pPoolSizes = poolSizes;
+        if (vkCreateDescriptorPool(m_device, &pci, nullptr, &m_bindlessPool) != VK_SUCCESS)
+            return false;
+
+        m_bindlessFrames.resize(frameCount);
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_bindlessSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = m_bindlessPool;
+        alloc.descriptorSetCount = static_cast<uint32_t>(frameCount);
+        alloc.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(m_device, &alloc, sets.data()) != VK_SUCCESS)
+            return false;
+
+        for (size_t i = 0; i < frameCount; ++i)
+            m_bindlessFrames[i].set = sets[i];
+        return true;
     }
 
-    void SModelRenderPassModule::setInstances(const glm::mat4 *instanceWorlds, uint32_t count)
+    void SModelRenderPassModule::destroyBindlessResources()
     {
-        m_instanceWorlds.clear();
-        if (!instanceWorlds || count == 0)
+        if (m_device == VK_NULL_HANDLE)
             return;
 
-        m_instanceWorlds.assign(instanceWorlds, instanceWorlds + count);
+        for (BindlessFrame &bf : m_bindlessFrames)
+            destroyBuffer(bf.materialBuffer, bf.materialMemory, &bf.materialMapped);
+        m_bindlessFrames.clear();
+
+        if (m_bindlessPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_bindlessPool, nullptr);
+            m_bindlessPool = VK_NULL_HANDLE;
+        }
+        if (m_bindlessSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_bindlessSetLayout, nullptr);
+            m_bindlessSetLayout = VK_NULL_HANDLE;
+        }
+        m_bindlessTextureCapacity = 0;
     }
 
-    void SModelRenderPassModule::setNodePalette(const glm::mat4 *nodeGlobals, uint32_t instanceCount, uint32_t nodeCount)
+    bool SModelRenderPassModule::updateBindlessFrame(BindlessFrame &frame)
     {
-        m_nodePalette.clear();
-        m_paletteInstanceCount = 0;
-        m_paletteNodeCount = 0;
+        if (!m_assets || frame.set == VK_NULL_HANDLE)
+            return false;
 
-        if (!nodeGlobals || instanceCount == 0 || nodeCount == 0)
-            return;
+        const uint32_t materialCount = m_assets->getMaterialIndexCount();
+        if (materialCount > frame.materialCapacity || frame.materialBuffer == VK_NULL_HANDLE)
+        {
+            uint32_t cap = std::max(frame.materialCapacity, 64u);
+            while (cap < materialCount)
+                cap *= 2;
+
+            destroyBuffer(frame.materialBuffer, frame.materialMemory, &frame.materialMapped);
+            frame.materialCapacity = 0;
+            if (!createBuffer(frame.materialBuffer, frame.materialMemory, static_cast<VkDeviceSize>(cap) * sizeof(MaterialGpu),
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              &frame.materialMapped))
+            {
+                destroyBuffer(frame.materialBuffer, frame.materialMemory, &frame.materialMapped);
+                return false;
+            }
+            frame.materialCapacity = cap;
+
+            VkDescriptorBufferInfo bi{};
+            bi.buffer = frame.materialBuffer;
+            bi.offset = 0;
+            bi.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = frame.set;
+            write.dstBinding = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &bi;
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        }
+
+        // Texture array: rewritten only when textures or materials came, went or were restreamed.
+        // Freed indices point back at the fallback so no element references a destroyed view.
+        if (frame.textureVersion != m_assets->getBindlessVersion())
+        {
+            const uint32_t count = std::min(m_assets->getTextureIndexCount() + 1u, m_bindlessTextureCapacity);
+            m_bindlessImageInfos.resize(count);
+            for (uint32_t e = 0; e < count; ++e)
+            {
+                VkDescriptorImageInfo &di = m_bindlessImageInfos[e];
+                di.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                di.imageView = m_fallbackWhiteTexture.getView();
+                di.sampler = m_fallbackWhiteTexture.getSampler();
+                const TextureAsset *tex = (e > 0) ? m_assets->getTextureAtIndex(e - 1) : nullptr;
+                if (tex && tex->getView() != VK_NULL_HANDLE && tex->getSampler() != VK_NULL_HANDLE)
+                {
+                    di.imageView = tex->getView();
+                    di.sampler = tex->getSampler();
+                }
+            }
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = frame.set;
+            write.dstBinding = 0;
+            write.dstArrayElement = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.descriptorCount = count;
+            write.pImageInfo = m_bindlessImageInfos.data();
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+            frame.textureVersion = m_assets->getBindlessVersion();
+        }
 
-        m_paletteInstanceCount = instanceCount;
-        m_paletteNodeCount = nodeCount;
-        const size_t total = static_cast<size_t>(instanceCount) * static_cast<size_t>(nodeCount);
-        m_nodePalette.assign(nodeGlobals, nodeGlobals + total);
+        // Material table: every frame, like the per-draw push constants it replaces (material
+        // parameters are plain fields and may change at any time).
+        MaterialGpu *gpu = static_cast<MaterialGpu *>(frame.materialMapped);
+        for (uint32_t i = 0; i < materialCount; ++i)
+        {
+            MaterialGpu g{};
+            if (const MaterialAsset *mat = m_assets->getMaterialAtIndex(i))
+            {
+                std::memcpy(g.baseColorFactor, mat->baseColorFactor, sizeof(g.baseColorFactor));
+                g.alphaCutoff = mat->alphaCutoff;
+                g.alphaMode = mat->alphaMode;
+                const uint32_t t = m_assets->getTextureIndex(mat->baseColorTexture);
+                g.baseColorTexture = (t != AssetManager::kInvalidIndex && t + 1u < m_bindlessTextureCapacity) ? t + 1u : 0u;
+            }
+            gpu[i] = g;
+        }
+        return true;
     }
 
-    void SModelRenderPassModule::setJointPalette(const glm::mat4 *jointMatrices, uint32_t instanceCount, uint32_t jointCount)
+    void SModelRenderPassModule::clearBatches()
     {
-        m_jointPalette.clear();
-        m_jointPaletteJointCount = 0;
+        m_batches.clear();
+    }
 
-        if (!jointMatrices || instanceCount == 0 || jointCount == 0)
+    void SModelRenderPassModule::addBatch(const Batch &batch)
+    {
+        if (!batch.model.isValid())
             return;
 
-        m_jointPaletteJointCount = jointCount;
-        const size_t total = static_cast<size_t>(instanceCount) * static_cast<size_t>(jointCount);
-        m_jointPalette.assign(jointMatrices, jointMatrices + total);
+        BatchEntry e{};
+        e.model = batch.model;
+        const bool external = batch.instanceSource != VK_NULL_HANDLE && batch.instanceCount > 0;
+        e.instanceCount = external ? batch.instanceCount : (batch.worlds && batch.instanceCount > 0) ? batch.instanceCount : 1u;
+        if (external)
+        {
+            e.instanceSource = batch.instanceSource;
+            e.instanceSourceOffset = batch.instanceSourceOffset;
+        }
+        else if (batch.worlds && batch.instanceCount > 0)
+        {
+            e.worlds = batch.worlds;
+        }
+
+        // Pose counts must match the instances; otherwise instance i uses pose i.
+        e.hasPoses = batch.instanceCount == e.instanceCount && (batch.poses || batch.poseIndices);
+        if (e.hasPoses)
+        {
+            e.poses = batch.poses;
+            e.poseIndices = batch.poses ? nullptr : batch.poseIndices;
+        }
+
+        e.poseCount = batch.poseCount;
+        if (batch.nodePalette && batch.poseCount > 0 && batch.nodeCount > 0)
+        {
+            e.nodePalette = batch.nodePalette;
+            e.nodeCount = batch.nodeCount;
+        }
+        if (batch.jointPalette && batch.poseCount > 0 && batch.jointCount > 0)
+        {
+            e.jointPalette = batch.jointPalette;
+            e.jointCount = batch.jointCount;
+        }
+
+        e.baked = batch.baked;
+        if (e.worlds)
+            e.impostorCount = std::min(batch.impostorCount, e.instanceCount);
+
+        // Levels past the last one draw with it.
+        e.hasLodCounts = batch.lodCounts && batch.lodCount > 0;
+        for (uint32_t k = 0; e.hasLodCounts && k < batch.lodCount; ++k)
+            e.lodCounts[std::min(k, ModelAsset::kMaxMeshLods - 1)] += batch.lodCounts[k];
+
+        m_batches.push_back(e);
     }
 
-    bool SModelRenderPassModule::refreshModelMatrix()
+    const SModelRenderPassModule::ModelInfo &SModelRenderPassModule::modelInfo(ModelHandle h, const ModelAsset &model)
     {
-        if (!m_assets || !m_model.isValid())
+        const uint64_t key = (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id);
+        auto found = m_modelInfos.find(key);
+        if (found == m_modelInfos.end())
         {
-            setIdentity(m_pc.model);
-            return false;
+            found = m_modelInfos.emplace(key, ModelInfo{}).first;
+            computeModelInfo(model, found->second);
+            buildModelDraws(model, found->second);
         }
+        return found->second;
+    }
 
-        ModelAsset *model = m_assets->getModel(m_model);
-        if (!model)
+    void SModelRenderPassModule::buildModelDraws(const ModelAsset &model, ModelInfo &info) const
+    {
+        for (auto &list : info.draws)
+            list.clear();
+        if (!m_assets)
+            return;
+
+        // Every drawable primitive, by node (rendered node palette entry) when the model has a node
+        // graph, once per mesh LOD.
+        auto addDraws = [&](uint32_t primIndex, uint32_t nodeSlot)
         {
-            setIdentity(m_pc.model);
-            return false;
+            if (primIndex >= model.primitives.size())
+                return;
+            for (uint32_t lod = 0; lod < ModelAsset::kMaxMeshLods; ++lod)
+            {
+                const ModelPrimitive &prim = model.primitives[model.lodPrimitive(primIndex, lod)];
+                MeshAsset *mesh = m_assets->getMesh(prim.mesh);
+                MaterialAsset *mat = m_assets->getMaterial(prim.material);
+                if (!mesh || !mat || prim.indexCount == 0 || mat->alphaMode > 2)
+                    continue;
+                if (mesh->getVertexBuffer() == VK_NULL_HANDLE || mesh->getIndexBuffer() == VK_NULL_HANDLE)
+                    continue;
+
+                ModelDraw d{};
+                d.prim = &prim;
+                d.mesh = mesh;
+                d.mat = mat;
+                d.nodeSlot = nodeSlot;
+                d.lod = lod;
+                d.pass = mat->alphaMode;
+                d.materialIndex = m_assets->getMaterialIndex(prim.material);
+                d.geometryKey = mesh->getGeometryKey();
+
+                PushConstantsModel &pc = d.pc;
+                for (uint32_t r = 0; r < 3; ++r)
+                {
+                    for (uint32_t c = 0; c < 4; ++c)
+                        pc.model[r * 4 + c] = info.model[c * 4 + r];
+                }
+                std::memcpy(pc.positionDequant, mesh->getPositionDequant(), sizeof(pc.positionDequant));
+                std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
+                pc.materialParams[0] = mat->alphaCutoff;
+                pc.materialParams[1] = static_cast<float>(mat->alphaMode);
+                pc.nodeIndex = nodeSlot;
+                pc.materialIndex = d.materialIndex;
+                if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model.skins.size())
+                {
+                    const auto &skin = model.skins[static_cast<uint32_t>(prim.skinIndex)];
+                    pc.skinBaseJoint = skin.jointBase;
+                    pc.skinJointCount = skin.jointCount;
+                }
+                d.variant = shaderVariant(mesh->isCompact(), pc.skinJointCount > 0);
+                info.draws[d.pass].push_back(d);
+            }
+        };
+
+        const bool nodeGraph = !model.nodes.empty() && model.renderedSlot.size() == model.nodes.size();
+        if (!model.nodes.empty())
+        {
+            for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(model.nodes.size()); ++nodeIndex)
+            {
+                const auto &node = model.nodes[nodeIndex];
+                const uint32_t nodeSlot = (nodeGraph && model.renderedSlot[nodeIndex] != ~0u) ? model.renderedSlot[nodeIndex] : 0u;
+                for (uint32_t k = 0; k < node.primitiveCount; ++k)
+                {
+                    const size_t ix = static_cast<size_t>(node.firstPrimitiveIndex) + k;
+                    if (ix < model.nodePrimitiveIndices.size())
+                        addDraws(model.nodePrimitiveIndices[ix], nodeSlot);
+                }
+            }
+        }
+        else
+        {
+            // No node graph: every primitive with the base model matrix (LODs through their base).
+            for (uint32_t primIndex = 0; primIndex < static_cast<uint32_t>(model.primitives.size()); ++primIndex)
+            {
+                if (!model.primitives[primIndex].isLod)
+                    addDraws(primIndex, 0u);
+            }
         }
+    }
+
+    void SModelRenderPassModule::computeModelInfo(const ModelAsset &model, ModelInfo &out) const
+    {
+        setIdentity(out.model);
+        out.hasSphere = false;
 
         // Prefer precomputed bounds/scale from AssetManager
         float center[3] = {0.0f, 0.0f, 0.0f};
         float minY = 0.0f;
         float scale = 1.0f;
-        bool hasBounds = model->hasBounds;
+        float halfDiagonal = 0.0f;
+        bool hasBounds = model.hasBounds;
+
+        auto halfLength = [](const float *mn, const float *mx)
+        {
+            const float dx = mx[0] - mn[0];
+            const float dy = mx[1] - mn[1];
+            const float dz = mx[2] - mn[2];
+            return 0.5f * std::sqrt(dx * dx + dy * dy + dz * dz);
+        };
 
-        if (model->hasBounds)
+        if (model.hasBounds)
         {
-            center[0] = model->center[0];
-            center[1] = model->center[1];
-            center[2] = model->center[2];
-            minY = model->boundsMin[1];
-            scale = model->fitScale;
+            center[0] = model.center[0];
+            center[1] = model.center[1];
+            center[2] = model.center[2];
+            minY = model.boundsMin[1];
+            scale = model.fitScale;
+            halfDiagonal = halfLength(model.boundsMin, model.boundsMax);
         }
-        else
+        else if (m_assets)
         {
             // Fallback: compute from meshes now
             float bmin[3] = {0.0f, 0.0f, 0.0f};
             float bmax[3] = {0.0f, 0.0f, 0.0f};
             bool first = true;
-            for (const ModelPrimitive &prim : model->primitives)
+            for (const ModelPrimitive &prim : model.primitives)
             {
                 MeshAsset *mesh = m_assets->getMesh(prim.mesh);
                 if (!mesh)
@@ -331,27 +668,30 @@ namespace Engine
                 const float target = 20.0f;
                 const float epsilon = 1e-4f;
                 scale = (maxExtent > epsilon) ? (target / maxExtent) : 1.0f;
+                halfDiagonal = halfLength(bmin, bmax);
                 hasBounds = true;
             }
         }
 
         if (!hasBounds)
-        {
-            setIdentity(m_pc.model);
-            return false;
-        }
+            return;
 
         // Build M = S * T:
         // - center in XZ so the model rotates nicely around its middle
         // - align base (AABB minY) to y=0 so characters sit on the ground
-        setIdentity(m_pc.model);
-        m_pc.model[0] = scale;
-        m_pc.model[5] = scale;
-        m_pc.model[10] = scale;
-        m_pc.model[12] = -center[0] * scale;
-        m_pc.model[13] = -minY * scale;
-        m_pc.model[14] = -center[2] * scale;
-        return true;
+        out.model[0] = scale;
+        out.model[5] = scale;
+        out.model[10] = scale;
+        out.model[12] = -center[0] * scale;
+        out.model[13] = -minY * scale;
+        out.model[14] = -center[2] * scale;
+
+        // The same transform applied to the bounds center.
+        out.sphere[0] = 0.0f;
+        out.sphere[1] = (center[1] - minY) * scale;
+        out.sphere[2] = 0.0f;
+        out.sphere[3] = halfDiagonal * scale;
+        out.hasSphere = halfDiagonal > 0.0f;
     }
 
     void SModelRenderPassModule::onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs)
@@ -359,28 +699,59 @@ namespace Engine
         (void)fbs;
         m_device = ctx.GetDevice();
         m_physicalDevice = ctx.GetPhysicalDevice();
+        m_graphicsQueue = ctx.GetGraphicsQueue();
+        m_graphicsQueueFamily = ctx.GetGraphicsQueueFamilyIndex();
         m_extent = ctx.GetSwapChain() ? ctx.GetSwapChain()->GetExtent() : VkExtent2D{};
+        m_hiZBuild = 0; // a new pyramid
+
+        // Meshlet draws: vkCmdDrawIndexedIndirectCount (compute path) and the mesh shader path are
+        // device functions of optional features.
+        m_cmdDrawIndexedIndirectCount = nullptr;
+        if (ctx.SupportsDrawIndirectCount())
+            m_cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(
+                vkGetDeviceProcAddr(m_device, "vkCmdDrawIndexedIndirectCount"));
+        m_drawIndirectCount = m_cmdDrawIndexedIndirectCount != nullptr;
+        m_meshShaders = false;
+#if defined(VK_EXT_mesh_shader)
+        m_cmdDrawMeshTasksIndirect = nullptr;
+        if (m_meshShadersRequested && ctx.SupportsMeshShaders())
+            m_cmdDrawMeshTasksIndirect = reinterpret_cast<PFN_vkCmdDrawMeshTasksIndirectEXT>(
+                vkGetDeviceProcAddr(m_device, "vkCmdDrawMeshTasksIndirectEXT"));
+        m_meshShaders = m_cmdDrawMeshTasksIndirect != nullptr;
+#endif
 
-        // Default model matrix: center/scale from bounds if available
-        if (!refreshModelMatrix())
+        const size_t frameCount = fbs.size();
+        if (!createPaletteResources(ctx, frameCount > 0 ? frameCount : 1))
         {
-            setIdentity(m_pc.model);
+            throw std::runtime_error("SModelRenderPassModule: failed to create palette resources");
         }
 
-        const size_t frameCount = fbs.size();
-        if (!createCameraResources(ctx, frameCount > 0 ? frameCount : 1))
+        if (!createMaterialResources(ctx))
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to create camera resources");
+            throw std::runtime_error("SModelRenderPassModule: failed to create material resources");
         }
 
-        if (!createInstanceResources(ctx, frameCount > 0 ? frameCount : 1))
+        // Optional: one descriptor set per material without descriptor indexing (or the bindless shader,
+        // see createPipelines()).
+        m_bindless = m_bindlessRequested && createBindlessResources(ctx, frameCount > 0 ? frameCount : 1);
+        if (!m_bindless)
+            destroyBindlessResources();
+
+        // Optional: stay on direct draws when the device or smodel_cull.comp.spv is missing. Before the
+        // pipelines: the mesh shader path reads the culling set.
+        try
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to create instance resources");
+            m_cullAvailable = createCullResources(ctx, frameCount > 0 ? frameCount : 1);
         }
-
-        if (!createMaterialResources(ctx))
+        catch (const std::exception &e)
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to create material resources");
+            ENGINE_LOG_WARN("[SModel] GPU culling disabled: %s", e.what());
+            m_cullAvailable = false;
+        }
+        if (!m_cullAvailable)
+        {
+            destroyCullResources();
+            m_meshShaders = false;
         }
 
         createPipelines(ctx, pass);
@@ -411,259 +782,96 @@ namespace Engine
         return cb;
     }
 
-    bool SModelRenderPassModule::createCameraResources(VulkanContext &ctx, size_t frameCount)
+    bool SModelRenderPassModule::createPaletteResources(VulkanContext &ctx, size_t frameCount)
     {
-        destroyCameraResources();
+        destroyPaletteResources();
 
         if (frameCount == 0)
             frameCount = 1;
 
-        VkDescriptorSetLayoutBinding camBinding{};
-        camBinding.binding = 0;
-        camBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        camBinding.descriptorCount = 1;
-        camBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
         VkDescriptorSetLayoutBinding paletteBinding{};
-        paletteBinding.binding = 1;
+        paletteBinding.binding = 0;
         paletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         paletteBinding.descriptorCount = 1;
-        paletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        paletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | (m_meshShaders ? kMeshPathStages : 0);
 
         VkDescriptorSetLayoutBinding jointPaletteBinding{};
-        jointPaletteBinding.binding = 2;
+        jointPaletteBinding.binding = 1;
         jointPaletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         jointPaletteBinding.descriptorCount = 1;
         jointPaletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
         VkDescriptorSetLayoutCreateInfo dsl{};
         dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        VkDescriptorSetLayoutBinding bindings[3] = {camBinding, paletteBinding, jointPaletteBinding};
-        dsl.bindingCount = 3;
+        VkDescriptorSetLayoutBinding bindings[2] = {paletteBinding, jointPaletteBinding};
+        dsl.bindingCount = 2;
         dsl.pBindings = bindings;
 
-        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_cameraSetLayout) != VK_SUCCESS)
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_paletteSetLayout) != VK_SUCCESS)
         {
             return false;
         }
 
-        // Pool: one uniform buffer descriptor + two storage buffer descriptors per frame
-        VkDescriptorPoolSize poolSizes[2]{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(frameCount);
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount) * 2u;
+        // Pool: two sets per frame (ring and baked palettes), each two storage buffer descriptors
+        const uint32_t setCount = static_cast<uint32_t>(frameCount) * 2u;
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = setCount * 2u;
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.maxSets = static_cast<uint32_t>(frameCount);
-        poolInfo.poolSizeCount = 2;
-        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = setCount;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
 
-        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_cameraPool) != VK_SUCCESS)
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_palettePool) != VK_SUCCESS)
         {
             return false;
         }
 
-        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_cameraSetLayout);
+        std::vector<VkDescriptorSetLayout> layouts(setCount, m_paletteSetLayout);
         VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = m_cameraPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(frameCount);
+        allocInfo.descriptorPool = m_palettePool;
+        allocInfo.descriptorSetCount = setCount;
         allocInfo.pSetLayouts = layouts.data();
 
-        m_cameraFrames.resize(frameCount);
+        m_paletteFrames.resize(frameCount);
 
-        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        std::vector<VkDescriptorSet> sets(setCount, VK_NULL_HANDLE);
         if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
         {
             return false;
         }
 
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(ctx.GetPhysicalDevice(), &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        const VkDeviceSize bufSize = sizeof(CameraUBO);
+        // The ring palettes are written by prepareFrame() once the frame's ring buffer is known; the
+        // baked palette buffers start small and grow with the baked models drawn.
         for (size_t i = 0; i < frameCount; ++i)
         {
-            CameraFrame &cf = m_cameraFrames[i];
-            cf.set = sets[i];
-
-            VkBufferCreateInfo binfo{};
-            binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            binfo.size = bufSize;
-            binfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-            binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &binfo, nullptr, &cf.buffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements memReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.buffer, &memReq);
-
-            VkMemoryAllocateInfo mai{};
-            mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            mai.allocationSize = memReq.size;
-            uint32_t memType = 0;
-            if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-                return false;
-            mai.memoryTypeIndex = memType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &mai, nullptr, &cf.memory) != VK_SUCCESS)
-                return false;
-
-            vkBindBufferMemory(ctx.GetDevice(), cf.buffer, cf.memory, 0);
-
-            // Palette SSBO (host-visible, coherent, persistently mapped)
-            constexpr uint32_t kDefaultPaletteCapacityMatrices = 1024;
-            cf.paletteCapacityMatrices = kDefaultPaletteCapacityMatrices;
-
-            VkBufferCreateInfo pbinfo{};
-            pbinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            pbinfo.size = static_cast<VkDeviceSize>(cf.paletteCapacityMatrices) * sizeof(glm::mat4);
-            pbinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            pbinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &pbinfo, nullptr, &cf.paletteBuffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements pmemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.paletteBuffer, &pmemReq);
-
-            VkMemoryAllocateInfo pmai{};
-            pmai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            pmai.allocationSize = pmemReq.size;
-            uint32_t pmemType = 0;
-            if (!findMemoryType(pmemReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pmemType))
-                return false;
-            pmai.memoryTypeIndex = pmemType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &pmai, nullptr, &cf.paletteMemory) != VK_SUCCESS)
-                return false;
-
-            vkBindBufferMemory(ctx.GetDevice(), cf.paletteBuffer, cf.paletteMemory, 0);
-
-            cf.paletteMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.paletteMemory, 0, VK_WHOLE_SIZE, 0, &cf.paletteMapped) != VK_SUCCESS)
-                return false;
-
-            // Joint palette SSBO (host-visible, coherent, persistently mapped)
-            constexpr uint32_t kDefaultJointPaletteCapacityMatrices = 1024;
-            cf.jointPaletteCapacityMatrices = kDefaultJointPaletteCapacityMatrices;
-
-            VkBufferCreateInfo jbinfo{};
-            jbinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            jbinfo.size = static_cast<VkDeviceSize>(cf.jointPaletteCapacityMatrices) * sizeof(glm::mat4);
-            jbinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            jbinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &jbinfo, nullptr, &cf.jointPaletteBuffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements jmemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.jointPaletteBuffer, &jmemReq);
-
-            VkMemoryAllocateInfo jmai{};
-            jmai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            jmai.allocationSize = jmemReq.size;
-            uint32_t jmemType = 0;
-            if (!findMemoryType(jmemReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, jmemType))
-                return false;
-            jmai.memoryTypeIndex = jmemType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &jmai, nullptr, &cf.jointPaletteMemory) != VK_SUCCESS)
+            PaletteFrame &cf = m_paletteFrames[i];
+            cf.set = sets[i * 2];
+            cf.bakedSet = sets[i * 2 + 1];
+            if (!ensurePaletteCapacity(cf, 1) || !ensureJointPaletteCapacity(cf, 1))
                 return false;
-
-            vkBindBufferMemory(ctx.GetDevice(), cf.jointPaletteBuffer, cf.jointPaletteMemory, 0);
-
-            cf.jointPaletteMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.jointPaletteMemory, 0, VK_WHOLE_SIZE, 0, &cf.jointPaletteMapped) != VK_SUCCESS)
-                return false;
-
-            VkDescriptorBufferInfo dbi{};
-            dbi.buffer = cf.buffer;
-            dbi.offset = 0;
-            dbi.range = bufSize;
-
-            VkDescriptorBufferInfo pbi{};
-            pbi.buffer = cf.paletteBuffer;
-            pbi.offset = 0;
-            pbi.range = static_cast<VkDeviceSize>(cf.paletteCapacityMatrices) * sizeof(glm::mat4);
-
-            VkDescriptorBufferInfo jbi{};
-            jbi.buffer = cf.jointPaletteBuffer;
-            jbi.offset = 0;
-            jbi.range = static_cast<VkDeviceSize>(cf.jointPaletteCapacityMatrices) * sizeof(glm::mat4);
-
-            VkWriteDescriptorSet writes[3]{};
-            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[0].dstSet = cf.set;
-            writes[0].dstBinding = 0;
-            writes[0].dstArrayElement = 0;
-            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            writes[0].descriptorCount = 1;
-            writes[0].pBufferInfo = &dbi;
-
-            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[1].dstSet = cf.set;
-            writes[1].dstBinding = 1;
-            writes[1].dstArrayElement = 0;
-            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            writes[1].descriptorCount = 1;
-            writes[1].pBufferInfo = &pbi;
-
-            writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[2].dstSet = cf.set;
-            writes[2].dstBinding = 2;
-            writes[2].dstArrayElement = 0;
-            writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            writes[2].descriptorCount = 1;
-            writes[2].pBufferInfo = &jbi;
-
-            vkUpdateDescriptorSets(ctx.GetDevice(), 3, writes, 0, nullptr);
         }
 
         return true;
     }
 
-    void SModelRenderPassModule::destroyCameraResources()
+    void SModelRenderPassModule::destroyPaletteResources()
     {
-        for (auto &cf : m_cameraFrames)
+        for (auto &cf : m_paletteFrames)
         {
-            if (cf.paletteMapped && cf.paletteMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.paletteMemory);
-                cf.paletteMapped = nullptr;
-            }
+            cf.paletteMapped = nullptr;
 
-            if (cf.jointPaletteMapped && cf.jointPaletteMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.jointPaletteMemory);
-                cf.jointPaletteMapped = nullptr;
-            }
+            cf.jointPaletteMapped = nullptr;
 
             if (cf.paletteBuffer != VK_NULL_HANDLE)
             {
                 vkDestroyBuffer(m_device, cf.paletteBuffer, nullptr);
                 cf.paletteBuffer = VK_NULL_HANDLE;
             }
-            if (cf.paletteMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.paletteMemory, nullptr);
-                cf.paletteMemory = VK_NULL_HANDLE;
-            }
+            FreeMemory(cf.paletteMemory);
             cf.paletteCapacityMatrices = 0;
 
             if (cf.jointPaletteBuffer != VK_NULL_HANDLE)
@@ -671,123 +879,77 @@ namespace Engine
                 vkDestroyBuffer(m_device, cf.jointPaletteBuffer, nullptr);
                 cf.jointPaletteBuffer = VK_NULL_HANDLE;
             }
-            if (cf.jointPaletteMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.jointPaletteMemory, nullptr);
-                cf.jointPaletteMemory = VK_NULL_HANDLE;
-            }
+            FreeMemory(cf.jointPaletteMemory);
             cf.jointPaletteCapacityMatrices = 0;
 
-            if (cf.buffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.buffer, nullptr);
-                cf.buffer = VK_NULL_HANDLE;
-            }
-            if (cf.memory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.memory, nullptr);
-                cf.memory = VK_NULL_HANDLE;
-            }
             cf.set = VK_NULL_HANDLE;
+            cf.bakedSet = VK_NULL_HANDLE;
+            cf.ringBuffer = VK_NULL_HANDLE;
         }
-        m_cameraFrames.clear();
+        m_paletteFrames.clear();
 
-        if (m_cameraPool != VK_NULL_HANDLE)
+        if (m_palettePool != VK_NULL_HANDLE)
         {
-            vkDestroyDescriptorPool(m_device, m_cameraPool, nullptr);
-            m_cameraPool = VK_NULL_HANDLE;
+            vkDestroyDescriptorPool(m_device, m_palettePool, nullptr);
+            m_palettePool = VK_NULL_HANDLE;
         }
-        if (m_cameraSetLayout != VK_NULL_HANDLE)
+        if (m_paletteSetLayout != VK_NULL_HANDLE)
         {
-            vkDestroyDescriptorSetLayout(m_device, m_cameraSetLayout, nullptr);
-            m_cameraSetLayout = VK_NULL_HANDLE;
+            vkDestroyDescriptorSetLayout(m_device, m_paletteSetLayout, nullptr);
+            m_paletteSetLayout = VK_NULL_HANDLE;
         }
     }
 
-    bool SModelRenderPassModule::ensurePaletteCapacity(CameraFrame &frame, uint32_t neededMatrices)
+    bool SModelRenderPassModule::ensurePaletteCapacity(PaletteFrame &frame, uint32_t neededMatrices)
     {
         if (neededMatrices <= frame.paletteCapacityMatrices)
             return true;
         if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
             return false;
-        if (frame.set == VK_NULL_HANDLE)
+        if (frame.bakedSet == VK_NULL_HANDLE)
             return false;
+        ENGINE_PROFILE_SCOPE("SModel::growPalette");
 
         uint32_t newCap = std::max<uint32_t>(1u, frame.paletteCapacityMatrices);
         while (newCap < neededMatrices)
             newCap *= 2u;
 
-        if (frame.paletteMapped && frame.paletteMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.paletteMemory);
-            frame.paletteMapped = nullptr;
-        }
+        frame.paletteMapped = nullptr;
         if (frame.paletteBuffer != VK_NULL_HANDLE)
         {
             vkDestroyBuffer(m_device, frame.paletteBuffer, nullptr);
             frame.paletteBuffer = VK_NULL_HANDLE;
         }
-        if (frame.paletteMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, frame.paletteMemory, nullptr);
-            frame.paletteMemory = VK_NULL_HANDLE;
-        }
-
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
+        FreeMemory(frame.paletteMemory);
 
         VkBufferCreateInfo binfo{};
         binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4);
+        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(PaletteMatrix);
         binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
         binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
         if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.paletteBuffer) != VK_SUCCESS)
             return false;
 
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.paletteBuffer, &memReq);
-
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
-
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.paletteMemory) != VK_SUCCESS)
+        if (AllocateBufferMemory(m_device, frame.paletteBuffer,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.paletteMemory,
+                                 MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS)
             return false;
 
-        vkBindBufferMemory(m_device, frame.paletteBuffer, frame.paletteMemory, 0);
-
-        frame.paletteMapped = nullptr;
-        if (vkMapMemory(m_device, frame.paletteMemory, 0, VK_WHOLE_SIZE, 0, &frame.paletteMapped) != VK_SUCCESS)
-            return false;
+        frame.paletteMapped = frame.paletteMemory.mapped;
 
         frame.paletteCapacityMatrices = newCap;
+        frame.bakedModels.clear();
 
         VkDescriptorBufferInfo pbi{};
         pbi.buffer = frame.paletteBuffer;
         pbi.offset = 0;
-        pbi.range = static_cast<VkDeviceSize>(frame.paletteCapacityMatrices) * sizeof(glm::mat4);
+        pbi.range = static_cast<VkDeviceSize>(frame.paletteCapacityMatrices) * sizeof(PaletteMatrix);
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = frame.set;
-        write.dstBinding = 1;
+        write.dstSet = frame.bakedSet;
+        write.dstBinding = 0;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         write.descriptorCount = 1;
@@ -797,90 +959,56 @@ namespace Engine
         return true;
     }
 
-    bool SModelRenderPassModule::ensureJointPaletteCapacity(CameraFrame &frame, uint32_t neededMatrices)
+    bool SModelRenderPassModule::ensureJointPaletteCapacity(PaletteFrame &frame, uint32_t neededMatrices)
     {
         if (neededMatrices <= frame.jointPaletteCapacityMatrices)
             return true;
         if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
             return false;
-        if (frame.set == VK_NULL_HANDLE)
+        if (frame.bakedSet == VK_NULL_HANDLE)
             return false;
+        ENGINE_PROFILE_SCOPE("SModel::growJointPalette");
 
         uint32_t newCap = std::max<uint32_t>(1u, frame.jointPaletteCapacityMatrices);
         while (newCap < neededMatrices)
             newCap *= 2u;
 
-        if (frame.jointPaletteMapped && frame.jointPaletteMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.jointPaletteMemory);
-            frame.jointPaletteMapped = nullptr;
-        }
+        frame.jointPaletteMapped = nullptr;
         if (frame.jointPaletteBuffer != VK_NULL_HANDLE)
         {
             vkDestroyBuffer(m_device, frame.jointPaletteBuffer, nullptr);
             frame.jointPaletteBuffer = VK_NULL_HANDLE;
         }
-        if (frame.jointPaletteMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, frame.jointPaletteMemory, nullptr);
-            frame.jointPaletteMemory = VK_NULL_HANDLE;
-        }
-
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
+        FreeMemory(frame.jointPaletteMemory);
 
         VkBufferCreateInfo binfo{};
         binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4);
+        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(PaletteMatrix);
         binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
         binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
         if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.jointPaletteBuffer) != VK_SUCCESS)
             return false;
 
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.jointPaletteBuffer, &memReq);
-
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
-
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.jointPaletteMemory) != VK_SUCCESS)
+        if (AllocateBufferMemory(m_device, frame.jointPaletteBuffer,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.jointPaletteMemory,
+                                 MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS)
             return false;
 
-        vkBindBufferMemory(m_device, frame.jointPaletteBuffer, frame.jointPaletteMemory, 0);
-
-        frame.jointPaletteMapped = nullptr;
-        if (vkMapMemory(m_device, frame.jointPaletteMemory, 0, VK_WHOLE_SIZE, 0, &frame.jointPaletteMapped) != VK_SUCCESS)
-            return false;
+        frame.jointPaletteMapped = frame.jointPaletteMemory.mapped;
 
         frame.jointPaletteCapacityMatrices = newCap;
+        frame.bakedModels.clear();
 
         VkDescriptorBufferInfo jbi{};
         jbi.buffer = frame.jointPaletteBuffer;
         jbi.offset = 0;
-        jbi.range = static_cast<VkDeviceSize>(frame.jointPaletteCapacityMatrices) * sizeof(glm::mat4);
+        jbi.range = static_cast<VkDeviceSize>(frame.jointPaletteCapacityMatrices) * sizeof(PaletteMatrix);
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = frame.set;
-        write.dstBinding = 2;
+        write.dstSet = frame.bakedSet;
+        write.dstBinding = 1;
         write.dstArrayElement = 0;
         write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         write.descriptorCount = 1;
@@ -890,200 +1018,408 @@ namespace Engine
         return true;
     }
 
-    bool SModelRenderPassModule::createInstanceResources(VulkanContext &ctx, size_t frameCount)
+    void SModelRenderPassModule::writeRingSets(PaletteFrame &frame, VkBuffer ringBuffer)
     {
-        destroyInstanceResources();
-
-        if (frameCount == 0)
-            frameCount = 1;
+        // Both palettes of the ring set. Palette entries are addressed from the start of the ring
+        // buffer, so this only runs when the ring hands out another buffer.
+        VkDescriptorBufferInfo pbi{};
+        pbi.buffer = ringBuffer;
+        pbi.offset = 0;
+        pbi.range = VK_WHOLE_SIZE;
 
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
+        VkWriteDescriptorSet writes[2]{};
+        for (uint32_t w = 0; w < 2; ++w)
         {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(ctx.GetPhysicalDevice(), &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
+            writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[w].dstSet = frame.set;
+            writes[w].dstBinding = w;
+            writes[w].dstArrayElement = 0;
+            writes[w].descriptorCount = 1;
+            writes[w].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[w].pBufferInfo = &pbi;
+        }
+
+        vkUpdateDescriptorSets(m_device, 2, writes, 0, nullptr);
+        frame.ringBuffer = ringBuffer;
+    }
+
+    bool SModelRenderPassModule::createBuffer(VkBuffer &buffer, MemoryAllocation &memory, VkDeviceSize size, VkBufferUsageFlags usage,
+                                              VkMemoryPropertyFlags properties, void **mapped)
+    {
+        VkBufferCreateInfo binfo{};
+        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        binfo.size = size;
+        binfo.usage = usage;
+        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(m_device, &binfo, nullptr, &buffer) != VK_SUCCESS)
             return false;
-        };
 
-        m_instanceFrames.resize(frameCount);
+        // Per-frame lists (materials, visible instances, indirect commands) and impostor bake inputs
+        if (AllocateBufferMemory(m_device, buffer, properties, memory, MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS)
+            return false;
 
-        // Start with a modest default capacity; grows on demand.
-        constexpr uint32_t kDefaultCapacity = 256;
-        const VkDeviceSize bufSize = static_cast<VkDeviceSize>(kDefaultCapacity) * sizeof(glm::mat4);
+        if (mapped)
+        {
+            *mapped = memory.mapped;
+            if (!*mapped)
+                return false;
+        }
+        return true;
+    }
 
-        for (size_t i = 0; i < frameCount; ++i)
+    void SModelRenderPassModule::destroyBuffer(VkBuffer &buffer, MemoryAllocation &memory, void **mapped)
+    {
+        if (mapped)
+            *mapped = nullptr;
+        if (buffer != VK_NULL_HANDLE)
         {
-            InstanceFrame &fr = m_instanceFrames[i];
-            fr.capacity = kDefaultCapacity;
+            vkDestroyBuffer(m_device, buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
+        }
+        FreeMemory(memory);
+    }
 
-            VkBufferCreateInfo binfo{};
-            binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            binfo.size = bufSize;
-            binfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-            binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bool SModelRenderPassModule::createCullResources(VulkanContext &ctx, size_t frameCount)
+    {
+        (void)ctx;
+        destroyCullResources();
 
-            if (vkCreateBuffer(ctx.GetDevice(), &binfo, nullptr, &fr.buffer) != VK_SUCCESS)
-                return false;
+        if (frameCount == 0)
+            frameCount = 1;
 
-            VkMemoryRequirements memReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), fr.buffer, &memReq);
+        // Bindings: 0 instance worlds, 1 instance poses, 2 visible worlds, 3 visible poses, 4 indirect,
+        // 5 batches, 6 external instance worlds, 7 Hi-Z pyramid, 8 occlusion parameters, 9 meshlet
+        // block, 10 meshlet draws, 11 meshlet commands, 12 vertex block (smodel.mesh). The mesh shader
+        // path binds the set as its set 3.
+        constexpr uint32_t kBindingCount = 13;
+        constexpr uint32_t kHiZBinding = 7;
+        VkDescriptorSetLayoutBinding bindings[kBindingCount]{};
+        for (uint32_t b = 0; b < kBindingCount; ++b)
+        {
+            const bool meshPath = b == 2 || b == 3 || b == 9 || b == 10 || b == 12;
+            bindings[b].binding = b;
+            bindings[b].descriptorType = (b == kHiZBinding) ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[b].descriptorCount = 1;
+            bindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | ((meshPath && m_meshShaders) ? kMeshPathStages : 0);
+        }
 
-            VkMemoryAllocateInfo mai{};
-            mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            mai.allocationSize = memReq.size;
-            uint32_t memType = 0;
-            if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-                return false;
-            mai.memoryTypeIndex = memType;
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = kBindingCount;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_cullSetLayout) != VK_SUCCESS)
+            return false;
 
-            if (vkAllocateMemory(ctx.GetDevice(), &mai, nullptr, &fr.memory) != VK_SUCCESS)
-                return false;
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[0].descriptorCount = static_cast<uint32_t>(frameCount) * (kBindingCount - 1);
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount);
+
+        VkDescriptorPoolCreateInfo pci{};
+        pci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pci.maxSets = static_cast<uint32_t>(frameCount);
+        pci.poolSizeCount = 2;
+        pci.pPoolSizes = poolSizes;
+        if (vkCreateDescriptorPool(m_device, &pci, nullptr, &m_cullPool) != VK_SUCCESS)
+            return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), fr.buffer, fr.memory, 0);
+        VkPushConstantRange range{};
+        range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        range.offset = 0;
+        range.size = sizeof(PushConstantsCull);
+
+        VkPipelineLayoutCreateInfo plci{};
+        plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plci.setLayoutCount = 1;
+        plci.pSetLayouts = &m_cullSetLayout;
+        plci.pushConstantRangeCount = 1;
+        plci.pPushConstantRanges = &range;
+        if (vkCreatePipelineLayout(m_device, &plci, nullptr, &m_cullPipelineLayout) != VK_SUCCESS)
+            return false;
 
-            fr.mapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), fr.memory, 0, VK_WHOLE_SIZE, 0, &fr.mapped) != VK_SUCCESS)
-                return false;
+        // Same module for every pass, selected by the kPass specialization constant.
+        VkShaderModule module = Pipeline::createShaderModuleFromFile(m_device, "shaders/smodel_cull.comp.spv");
+
+        uint32_t passIds[3] = {0u, 1u, 2u};
+        VkSpecializationMapEntry entry{0, 0, sizeof(uint32_t)};
+        VkSpecializationInfo specs[3]{};
+        VkComputePipelineCreateInfo infos[3]{};
+        for (uint32_t p = 0; p < 3; ++p)
+        {
+            specs[p].mapEntryCount = 1;
+            specs[p].pMapEntries = &entry;
+            specs[p].dataSize = sizeof(uint32_t);
+            specs[p].pData = &passIds[p];
+
+            infos[p].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            infos[p].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            infos[p].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            infos[p].stage.module = module;
+            infos[p].stage.pName = "main";
+            infos[p].stage.pSpecializationInfo = &specs[p];
+            infos[p].layout = m_cullPipelineLayout;
         }
+        const VkResult res = vkCreateComputePipelines(m_device, PipelineCache::HandleFor(m_device), 3, infos, nullptr, m_cullPipelines);
+        vkDestroyShaderModule(m_device, module, nullptr);
+        if (res != VK_SUCCESS)
+            return false;
+
+        m_cullFrames.resize(frameCount);
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_cullSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = m_cullPool;
+        alloc.descriptorSetCount = static_cast<uint32_t>(frameCount);
+        alloc.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(m_device, &alloc, sets.data()) != VK_SUCCESS)
+            return false;
 
+        // Start with a modest default capacity; grows on demand.
+        constexpr uint32_t kDefaultInstances = 256;
+        constexpr uint32_t kDefaultDraws = 64;
+        constexpr uint32_t kDefaultBatches = 8;
+        constexpr uint32_t kDefaultMeshletDraws = 16;
+        constexpr uint32_t kDefaultMeshletCommands = 1024;
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            m_cullFrames[i].set = sets[i];
+            if (!ensureCullCapacity(m_cullFrames[i], kDefaultInstances, kDefaultDraws, kDefaultBatches, kDefaultMeshletDraws,
+                                    kDefaultMeshletCommands))
+                return false;
+        }
         return true;
     }
 
-    void SModelRenderPassModule::destroyInstanceResources()
+    void SModelRenderPassModule::destroyCullResources()
     {
         if (m_device == VK_NULL_HANDLE)
             return;
 
-        for (auto &fr : m_instanceFrames)
+        for (auto &cf : m_cullFrames)
         {
-            if (fr.mapped && fr.memory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, fr.memory);
-                fr.mapped = nullptr;
-            }
-
-            if (fr.buffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, fr.buffer, nullptr);
-                fr.buffer = VK_NULL_HANDLE;
-            }
+            destroyBuffer(cf.visibleBuffer, cf.visibleMemory, nullptr);
+            destroyBuffer(cf.visiblePoseBuffer, cf.visiblePoseMemory, nullptr);
+            destroyBuffer(cf.indirectBuffer, cf.indirectMemory, &cf.indirectMapped);
+            destroyBuffer(cf.batchBuffer, cf.batchMemory, &cf.batchMapped);
+            destroyBuffer(cf.meshletDrawBuffer, cf.meshletDrawMemory, &cf.meshletDrawMapped);
+            destroyBuffer(cf.meshletCommandBuffer, cf.meshletCommandMemory, nullptr);
+        }
+        m_cullFrames.clear();
 
-            if (fr.memory != VK_NULL_HANDLE)
+        for (VkPipeline &p : m_cullPipelines)
+        {
+            if (p != VK_NULL_HANDLE)
             {
-                vkFreeMemory(m_device, fr.memory, nullptr);
-                fr.memory = VK_NULL_HANDLE;
+                vkDestroyPipeline(m_device, p, nullptr);
+                p = VK_NULL_HANDLE;
             }
-
-            fr.capacity = 0;
         }
-        m_instanceFrames.clear();
+        if (m_cullPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_cullPipelineLayout, nullptr);
+            m_cullPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_cullPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_cullPool, nullptr); // frees the sets
+            m_cullPool = VK_NULL_HANDLE;
+        }
+        if (m_cullSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_cullSetLayout, nullptr);
+            m_cullSetLayout = VK_NULL_HANDLE;
+        }
+        m_cullAvailable = false;
     }
 
-    bool SModelRenderPassModule::ensureInstanceCapacity(InstanceFrame &frame, uint32_t needed)
+    bool SModelRenderPassModule::ensureCullCapacity(CullFrame &frame, uint32_t instances, uint32_t draws, uint32_t batches,
+                                                    uint32_t meshletDraws, uint32_t meshletCommands)
     {
-        if (needed <= frame.capacity)
-            return true;
-        if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
-            return false;
-
-        // Grow by doubling.
-        uint32_t newCap = std::max<uint32_t>(1u, frame.capacity);
-        while (newCap < needed)
-            newCap *= 2u;
-
-        if (frame.mapped && frame.memory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.memory);
-            frame.mapped = nullptr;
-        }
-        if (frame.buffer != VK_NULL_HANDLE)
+        // The previous frame using this slot has completed (Renderer waited on its fence).
+        if (instances > frame.capacity)
         {
-            vkDestroyBuffer(m_device, frame.buffer, nullptr);
-            frame.buffer = VK_NULL_HANDLE;
+            ENGINE_PROFILE_SCOPE("SModel::growCullBuffers");
+            // Grow by doubling.
+            uint32_t newCap = std::max<uint32_t>(1u, frame.capacity);
+            while (newCap < instances)
+                newCap *= 2u;
+
+            destroyBuffer(frame.visibleBuffer, frame.visibleMemory, nullptr);
+            destroyBuffer(frame.visiblePoseBuffer, frame.visiblePoseMemory, nullptr);
+            frame.capacity = 0;
+
+            const VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+            if (!createBuffer(frame.visibleBuffer, frame.visibleMemory, static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4),
+                              usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr))
+                return false;
+            if (!createBuffer(frame.visiblePoseBuffer, frame.visiblePoseMemory, static_cast<VkDeviceSize>(newCap) * sizeof(InstancePose),
+                              usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr))
+                return false;
+            frame.capacity = newCap;
         }
-        if (frame.memory != VK_NULL_HANDLE)
+
+        if (batches > frame.batchCapacity)
         {
-            vkFreeMemory(m_device, frame.memory, nullptr);
-            frame.memory = VK_NULL_HANDLE;
+            uint32_t newCap = std::max<uint32_t>(1u, frame.batchCapacity);
+            while (newCap < batches)
+                newCap *= 2u;
+
+            destroyBuffer(frame.batchBuffer, frame.batchMemory, &frame.batchMapped);
+            frame.batchCapacity = 0;
+
+            if (!createBuffer(frame.batchBuffer, frame.batchMemory, static_cast<VkDeviceSize>(newCap) * sizeof(CullBatchGpu),
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.batchMapped))
+                return false;
+            frame.batchCapacity = newCap;
         }
 
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
+        // Bucket counts, commands, the bucket of every command, then the meshlet draws' command counts.
+        const VkDeviceSize needed = static_cast<VkDeviceSize>(batches) * ModelAsset::kMaxMeshLods * sizeof(uint32_t) +
+                                    static_cast<VkDeviceSize>(draws) * (sizeof(VkDrawIndexedIndirectCommand) + sizeof(uint32_t)) +
+                                    static_cast<VkDeviceSize>(meshletDraws) * sizeof(uint32_t);
+        if (needed > frame.indirectCapacity)
         {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
+            VkDeviceSize newSize = std::max<VkDeviceSize>(256u, frame.indirectCapacity);
+            while (newSize < needed)
+                newSize *= 2u;
 
-        const VkDeviceSize bufSize = static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4);
-        VkBufferCreateInfo binfo{};
-        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = bufSize;
-        binfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            destroyBuffer(frame.indirectBuffer, frame.indirectMemory, &frame.indirectMapped);
+            frame.indirectCapacity = 0;
 
-        if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.buffer) != VK_SUCCESS)
-            return false;
+            if (!createBuffer(frame.indirectBuffer, frame.indirectMemory, newSize,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.indirectMapped))
+                return false;
+            frame.indirectCapacity = newSize;
+        }
 
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.buffer, &memReq);
+        if (meshletDraws > frame.meshletDrawCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(1u, frame.meshletDrawCapacity);
+            while (newCap < meshletDraws)
+                newCap *= 2u;
 
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
+            destroyBuffer(frame.meshletDrawBuffer, frame.meshletDrawMemory, &frame.meshletDrawMapped);
+            frame.meshletDrawCapacity = 0;
 
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.memory) != VK_SUCCESS)
-            return false;
+            if (!createBuffer(frame.meshletDrawBuffer, frame.meshletDrawMemory,
+                              sizeof(MeshletFrameGpu) + static_cast<VkDeviceSize>(newCap) * sizeof(MeshletDrawGpu),
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.meshletDrawMapped))
+                return false;
+            frame.meshletDrawCapacity = newCap;
+        }
 
-        vkBindBufferMemory(m_device, frame.buffer, frame.memory, 0);
+        if (meshletCommands > frame.meshletCommandCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(1u, frame.meshletCommandCapacity);
+            while (newCap < meshletCommands)
+                newCap *= 2u;
 
-        frame.mapped = nullptr;
-        if (vkMapMemory(m_device, frame.memory, 0, VK_WHOLE_SIZE, 0, &frame.mapped) != VK_SUCCESS)
-            return false;
+            destroyBuffer(frame.meshletCommandBuffer, frame.meshletCommandMemory, nullptr);
+            frame.meshletCommandCapacity = 0;
 
-        frame.capacity = newCap;
+            if (!createBuffer(frame.meshletCommandBuffer, frame.meshletCommandMemory,
+                              static_cast<VkDeviceSize>(newCap) * sizeof(VkDrawIndexedIndirectCommand),
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, nullptr))
+                return false;
+            frame.meshletCommandCapacity = newCap;
+        }
         return true;
     }
 
     void SModelRenderPassModule::createPipelines(VulkanContext &ctx, VkRenderPass pass)
     {
-        if (m_cameraSetLayout == VK_NULL_HANDLE)
+        if (m_globalSetLayout == VK_NULL_HANDLE || m_paletteSetLayout == VK_NULL_HANDLE)
         {
-            throw std::runtime_error("SModelRenderPassModule: camera descriptor set layout not created");
+            throw std::runtime_error("SModelRenderPassModule: global or palette descriptor set layout not created");
         }
         if (m_materialSetLayout == VK_NULL_HANDLE)
         {
             throw std::runtime_error("SModelRenderPassModule: material descriptor set layout not created");
         }
 
-        // Shared pipeline layout: camera set + push constants.
+        // Load shader modules
+        VkShaderModule vert = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel.vert.spv");
+        VkShaderModule frag = VK_NULL_HANDLE;
+        if (m_bindless)
+        {
+            try
+            {
+                frag = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel_bindless.frag.spv");
+            }
+            catch (const std::exception &e)
+            {
+                ENGINE_LOG_WARN("[SModel] Bindless materials disabled: %s", e.what());
+            }
+            if (frag == VK_NULL_HANDLE)
+            {
+                m_bindless = false;
+                destroyBindlessResources();
+            }
+        }
+        if (frag == VK_NULL_HANDLE)
+            frag = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel.frag.spv");
+        if (vert == VK_NULL_HANDLE || frag == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("SModelRenderPassModule: failed to load shader modules (smodel.vert/frag.spv)");
+        }
+
+        // Optional: the mesh shader path for meshlet draws; without it they take the compute path.
+        VkShaderModule task = VK_NULL_HANDLE;
+        VkShaderModule mesh = VK_NULL_HANDLE;
+        if (m_meshShaders)
+        {
+            try
+            {
+                task = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel.task.spv");
+                mesh = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel.mesh.spv");
+            }
+            catch (const std::exception &e)
+            {
+                ENGINE_LOG_WARN("[SModel] Mesh shaders disabled: %s", e.what());
+            }
+            m_meshShaders = task != VK_NULL_HANDLE && mesh != VK_NULL_HANDLE;
+        }
+
+        // Optional: impostors. Their atlases are baked with per-material sets, so with bindless
+        // materials the bake pipelines take smodel.frag on their own.
+        VkShaderModule bakeFrag = VK_NULL_HANDLE;
+        m_impostors = false;
+        if (m_impostorsRequested)
+        {
+            try
+            {
+                m_impostors = createImpostorResources(ctx, pass);
+                if (m_impostors)
+                    bakeFrag = m_bindless ? Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel.frag.spv") : frag;
+            }
+            catch (const std::exception &e)
+            {
+                ENGINE_LOG_WARN("[SModel] Impostors disabled: %s", e.what());
+            }
+            m_impostors = m_impostors && bakeFrag != VK_NULL_HANDLE;
+            if (!m_impostors)
+                destroyImpostorResources();
+        }
+
+        // Shared pipeline layout: global set (Renderer), palette set, material (or bindless) set + push
+        // constants; with mesh shaders the culling set as set 3.
+        m_pushStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | (m_meshShaders ? kMeshPathStages : 0);
         VkPushConstantRange pcRange{};
-        pcRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pcRange.stageFlags = m_pushStages;
         pcRange.offset = 0;
         pcRange.size = sizeof(PushConstantsModel);
 
         VkPipelineLayoutCreateInfo plInfo{};
         plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        VkDescriptorSetLayout setLayouts[2] = {m_cameraSetLayout, m_materialSetLayout};
-        plInfo.setLayoutCount = 2;
+        VkDescriptorSetLayout setLayouts[4] = {m_globalSetLayout, m_paletteSetLayout, m_bindless ? m_bindlessSetLayout : m_materialSetLayout,
+                                               m_cullSetLayout};
+        plInfo.setLayoutCount = m_meshShaders ? 4u : 3u;
         plInfo.pSetLayouts = setLayouts;
         plInfo.pushConstantRangeCount = 1;
         plInfo.pPushConstantRanges = &pcRange;
@@ -1100,14 +1436,6 @@ namespace Engine
         pci.subpass = 0;
         pci.pipelineLayout = m_pipelineLayout;
 
-        // Load shader modules
-        VkShaderModule vert = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel.vert.spv");
-        VkShaderModule frag = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel.frag.spv");
-        if (vert == VK_NULL_HANDLE || frag == VK_NULL_HANDLE)
-        {
-            throw std::runtime_error("SModelRenderPassModule: failed to load shader modules (smodel.vert/frag.spv)");
-        }
-
         VkPipelineShaderStageCreateInfo vs{};
         vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -1120,29 +1448,39 @@ namespace Engine
         fs.module = frag;
         fs.pName = "main";
 
-        pci.shaderStages = {vs, fs};
-
-        // Vertex input:
-        //  binding 0: VertexPNTTJW (72 bytes)
+        VkPipelineShaderStageCreateInfo bakeFs = fs;
+        bakeFs.module = bakeFrag;
+
+        VkPipelineShaderStageCreateInfo ts{};
+        VkPipelineShaderStageCreateInfo ms{};
+#if defined(VK_EXT_mesh_shader)
+        ts.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        ts.stage = VK_SHADER_STAGE_TASK_BIT_EXT;
+        ts.module = task;
+        ts.pName = "main";
+        ms.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        ms.stage = VK_SHADER_STAGE_MESH_BIT_EXT;
+        ms.module = mesh;
+        ms.pName = "main";
+#endif
+
+        // Vertex input, binding 0 per format (filled below):
+        //  VertexPNTTJW (72 bytes) or the compact layout (smodel::kCompactVertexStride)
         //  binding 1: Instance mat4 (64 bytes), advanced per-instance
-        std::array<VkVertexInputBindingDescription, 2> bindingDescs{};
+        //  binding 2: Instance pose (InstancePose, 12 bytes), advanced per-instance
+        std::array<VkVertexInputBindingDescription, 3> bindingDescs{};
         bindingDescs[0].binding = 0;
-        bindingDescs[0].stride = 72;
         bindingDescs[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
         bindingDescs[1].binding = 1;
         bindingDescs[1].stride = sizeof(glm::mat4);
         bindingDescs[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
-        std::array<VkVertexInputAttributeDescription, 10> attrs{};
-        attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};     // pos
-        attrs[1] = {1, 0, VK_FORMAT_R32G32B32_SFLOAT, 12};    // normal
-        attrs[2] = {2, 0, VK_FORMAT_R32G32_SFLOAT, 24};       // uv0
-        attrs[3] = {3, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 32}; // tangent
+        bindingDescs[2].binding = 2;
+        bindingDescs[2].stride = sizeof(InstancePose);
+        bindingDescs[2].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
-        // Skinning inputs
-        attrs[4] = {8, 0, VK_FORMAT_R16G16B16A16_UINT, 48};   // joints (u16x4)
-        attrs[5] = {9, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 56}; // weights (f32x4)
+        std::array<VkVertexInputAttributeDescription, 12> attrs{};
 
         // mat4 consumes 4 locations (vec4 columns)
         attrs[6] = {4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 0};
@@ -1150,6 +1488,9 @@ namespace Engine
         attrs[8] = {6, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 32};
         attrs[9] = {7, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 48};
 
+        attrs[10] = {10, 2, VK_FORMAT_R32G32_UINT, 0}; // pose0, pose1
+        attrs[11] = {11, 2, VK_FORMAT_R32_SFLOAT, 8};  // blend
+
         VkPipelineVertexInputStateCreateInfo vi{};
         vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         vi.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescs.size());
@@ -1194,344 +1535,1904 @@ namespace Engine
         pci.depthStencil = ds;
         pci.depthStencilProvided = true;
 
-        // Pipelines: OPAQUE / MASK / BLEND (mask currently uses same state as opaque)
+        // Shader variants: smodel.vert (and smodel.mesh) kCompactVertices (constant_id 0) and kSkinned
+        // (1), set per variant below; smodel.frag kAlphaMask (0) for the MASK pipelines.
+        SpecializationConstants vertSpec;
+        SpecializationConstants maskSpec;
+        maskSpec.setBool(0, true);
+        VkPipelineShaderStageCreateInfo fsMask = fs;
+        fsMask.pSpecializationInfo = maskSpec.info();
+        VkPipelineShaderStageCreateInfo bakeFsMask = bakeFs;
+        bakeFsMask.pSpecializationInfo = maskSpec.info();
+
+        const bool prepass = m_depthPrepassPass != VK_NULL_HANDLE;
+        VkResult result = VK_SUCCESS;
+        VkResult meshResult = VK_SUCCESS;
+        VkResult bakeResult = VK_SUCCESS;
+        // The mesh shader variant of a pipeline: same state, no vertex input.
+        auto createMeshPipeline = [&](Pipeline &out, const PipelineCreateInfo &from, const VkPipelineShaderStageCreateInfo *fragment)
+        {
+            if (!m_meshShaders)
+                return;
+            PipelineCreateInfo meshPci = from;
+            meshPci.shaderStages = fragment ? std::vector<VkPipelineShaderStageCreateInfo>{ts, ms, *fragment}
+                                            : std::vector<VkPipelineShaderStageCreateInfo>{ts, ms};
+            meshPci.vertexInputProvided = false;
+            meshPci.inputAssemblyProvided = false;
+            if (out.create(meshPci) != VK_SUCCESS)
+                meshResult = VK_ERROR_INITIALIZATION_FAILED;
+        };
         VkPipelineColorBlendAttachmentState attOpaque{};
         VkPipelineColorBlendStateCreateInfo cbOpaque = makeBlendState(false, attOpaque);
-        pci.colorBlend = cbOpaque;
-        pci.colorBlendProvided = true;
-        VkResult r0 = m_pipelineOpaque.create(pci);
-
         VkPipelineColorBlendAttachmentState attMask{};
         VkPipelineColorBlendStateCreateInfo cbMask = makeBlendState(false, attMask);
-        pci.colorBlend = cbMask;
-        pci.colorBlendProvided = true;
-        VkResult r1 = m_pipelineMask.create(pci);
-
         VkPipelineColorBlendAttachmentState attBlend{};
         VkPipelineColorBlendStateCreateInfo cbBlend = makeBlendState(true, attBlend);
-        pci.colorBlend = cbBlend;
-        pci.colorBlendProvided = true;
-
-        // Transparent: test depth but don't write
-        pci.depthStencil.depthWriteEnable = VK_FALSE;
-        VkResult r2 = m_pipelineBlend.create(pci);
-
-        // Cleanup shader modules
-        vkDestroyShaderModule(pci.device, vert, nullptr);
-        vkDestroyShaderModule(pci.device, frag, nullptr);
-
-        if (r0 != VK_SUCCESS || r1 != VK_SUCCESS || r2 != VK_SUCCESS)
+        for (uint32_t variant = 0; variant < kShaderVariantCount; ++variant)
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to create one or more pipelines");
-        }
-    }
-
-    void SModelRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
-    {
-        if (!m_enabled)
-            return;
-        if (!m_assets || !m_model.isValid())
-            return;
-        if (m_extent.width == 0 || m_extent.height == 0)
-            return;
-
-        ModelAsset *model = m_assets->getModel(m_model);
-        if (!model || model->primitives.empty())
-            return;
-
-        VkViewport vp{0.0f, 0.0f, static_cast<float>(m_extent.width), static_cast<float>(m_extent.height), 0.0f, 1.0f};
-        VkRect2D sc{{0, 0}, {m_extent.width, m_extent.height}};
-        vkCmdSetViewport(cmd, 0, 1, &vp);
-        vkCmdSetScissor(cmd, 0, 1, &sc);
+            const bool compact = (variant & 1u) != 0;
+            const bool skinned = (variant & 2u) != 0;
+            const uint32_t format = compact ? 1u : 0u;
+            vertSpec.setBool(0, compact).setBool(1, skinned);
+            vs.pSpecializationInfo = vertSpec.info();
+            ms.pSpecializationInfo = vertSpec.info(); // smodel.mesh has kCompactVertices too
+            // Meshlet draws are unskinned: the mesh pipelines come with the unskinned variants
+            auto createMeshVariant = [&](Pipeline *pipelines, const PipelineCreateInfo &from, const VkPipelineShaderStageCreateInfo *fragment)
+            {
+                if (!skinned)
+                    createMeshPipeline(pipelines[format], from, fragment);
+            };
 
-        // Update camera UBO for this frame
-        const uint32_t camIndex = (!m_cameraFrames.empty()) ? (frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())) : 0;
-        CameraFrame *camFrame = (!m_cameraFrames.empty()) ? &m_cameraFrames[camIndex] : nullptr;
-        if (camFrame && camFrame->memory != VK_NULL_HANDLE)
-        {
-            CameraUBO ubo{};
-            const float aspect = (m_extent.height > 0) ? (static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height)) : 1.0f;
-            if (m_camera)
+            if (compact)
             {
-                m_camera->SetAspect(aspect);
-                ubo.view = m_camera->GetViewMatrix();
-                ubo.proj = m_camera->GetProjectionMatrix();
+                bindingDescs[0].stride = smodel::kCompactVertexStride;
+                attrs[0] = {0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0};  // pos (+ tangent sign)
+                attrs[1] = {1, 0, VK_FORMAT_R16G16B16A16_SNORM, 8};  // octahedral normal, tangent
+                attrs[2] = {2, 0, VK_FORMAT_R16G16_SFLOAT, 16};      // uv0
+                attrs[3] = {3, 0, VK_FORMAT_R16G16B16A16_SNORM, 8};  // tangent (same bytes as normal)
+                attrs[4] = {8, 0, VK_FORMAT_R8G8B8A8_UINT, 20};      // joints (u8x4)
+                attrs[5] = {9, 0, VK_FORMAT_R8G8B8A8_UNORM, 24};     // weights (unorm8x4)
             }
             else
             {
-                glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
-                glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
-                proj[1][1] *= -1.0f;
-                ubo.view = view;
-                ubo.proj = proj;
+                bindingDescs[0].stride = 72;
+                attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};     // pos
+                attrs[1] = {1, 0, VK_FORMAT_R32G32B32_SFLOAT, 12};    // normal
+                attrs[2] = {2, 0, VK_FORMAT_R32G32_SFLOAT, 24};       // uv0
+                attrs[3] = {3, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 32}; // tangent
+
+                // Skinning inputs (declared by smodel.vert, so bound for every variant; the unskinned
+                // ones never read them)
+                attrs[4] = {8, 0, VK_FORMAT_R16G16B16A16_UINT, 48};   // joints (u16x4)
+                attrs[5] = {9, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 56}; // weights (f32x4)
             }
 
-            void *mapped = nullptr;
-            if (vkMapMemory(m_device, camFrame->memory, 0, sizeof(CameraUBO), 0, &mapped) == VK_SUCCESS && mapped)
+            // Depth pre-pass: opaque draws into the depth-only pass, no fragment stage.
+            pci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+            if (prepass)
             {
-                std::memcpy(mapped, &ubo, sizeof(CameraUBO));
-                vkUnmapMemory(m_device, camFrame->memory);
+                PipelineCreateInfo depthPci = pci;
+                depthPci.renderPass = m_depthPrepassPass;
+                depthPci.shaderStages = {vs};
+                VkPipelineColorBlendStateCreateInfo cbDepth{};
+                cbDepth.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+                cbDepth.attachmentCount = 0;
+                depthPci.colorBlend = cbDepth;
+                depthPci.colorBlendProvided = true;
+                if (m_pipelineDepth[variant].create(depthPci) != VK_SUCCESS)
+                    result = VK_ERROR_INITIALIZATION_FAILED;
+                createMeshVariant(m_meshPipelineDepth, depthPci, nullptr);
+
+                // Everything else tests against the pre-pass depth, which opaque draws already wrote.
+                pci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
             }
-        }
-
-        // Update instance buffer for this frame
-        const uint32_t instIndex = (!m_instanceFrames.empty()) ? (frameCtx.frameIndex % static_cast<uint32_t>(m_instanceFrames.size())) : 0;
-        InstanceFrame *instFrame = (!m_instanceFrames.empty()) ? &m_instanceFrames[instIndex] : nullptr;
-
-        const uint32_t instanceCount = m_instanceWorlds.empty() ? 1u : static_cast<uint32_t>(m_instanceWorlds.size());
-        if (instFrame)
-        {
-            if (!ensureInstanceCapacity(*instFrame, instanceCount))
-                return;
 
-            const glm::mat4 *src = m_instanceWorlds.empty() ? nullptr : m_instanceWorlds.data();
-            if (src)
-            {
-                std::memcpy(instFrame->mapped, src, sizeof(glm::mat4) * instanceCount);
-            }
-            else
+            // Pipelines: OPAQUE / MASK / BLEND (mask: opaque state, alpha-tested fragment variant)
+            pci.shaderStages = {vs, fs};
+            pci.colorBlend = cbOpaque;
+            pci.colorBlendProvided = true;
+            pci.depthStencil.depthWriteEnable = prepass ? VK_FALSE : VK_TRUE;
+            if (m_pipelineOpaque[variant].create(pci) != VK_SUCCESS)
+                result = VK_ERROR_INITIALIZATION_FAILED;
+            createMeshVariant(m_meshPipelineOpaque, pci, &fs);
+            pci.depthStencil.depthWriteEnable = VK_TRUE;
+
+            pci.shaderStages = {vs, fsMask};
+            pci.colorBlend = cbMask;
+            if (m_pipelineMask[variant].create(pci) != VK_SUCCESS)
+                result = VK_ERROR_INITIALIZATION_FAILED;
+            createMeshVariant(m_meshPipelineMask, pci, &fsMask);
+
+            // Transparent: test depth but don't write
+            pci.shaderStages = {vs, fs};
+            pci.colorBlend = cbBlend;
+            pci.depthStencil.depthWriteEnable = VK_FALSE;
+            if (m_pipelineBlend[variant].create(pci) != VK_SUCCESS)
+                result = VK_ERROR_INITIALIZATION_FAILED;
+            pci.depthStencil.depthWriteEnable = VK_TRUE;
+
+            // Impostor bake: opaque state into the bake pass, MASK materials alpha tested as usual.
+            if (m_impostors)
             {
-                const glm::mat4 I = identityMat4();
-                std::memcpy(instFrame->mapped, &I, sizeof(glm::mat4));
+                PipelineCreateInfo bakePci = pci;
+                bakePci.renderPass = m_impostorBakePass;
+                bakePci.pipelineLayout = m_impostorBakeLayout;
+                bakePci.colorBlend = cbOpaque;
+                bakePci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+                bakePci.shaderStages = {vs, bakeFs};
+                if (m_impostorBakePipelines[variant].create(bakePci) != VK_SUCCESS)
+                    bakeResult = VK_ERROR_INITIALIZATION_FAILED;
+                bakePci.shaderStages = {vs, bakeFsMask};
+                if (m_impostorBakePipelines[kShaderVariantCount + variant].create(bakePci) != VK_SUCCESS)
+                    bakeResult = VK_ERROR_INITIALIZATION_FAILED;
             }
         }
 
-        // Update node palette buffer for this frame (SSBO in set=0 binding=1).
-        const uint32_t nodeCount = model->nodes.empty() ? 1u : static_cast<uint32_t>(model->nodes.size());
-        const uint32_t neededMatrices = instanceCount * nodeCount;
-        if (camFrame && camFrame->paletteMapped)
+        // Cleanup shader modules
+        vkDestroyShaderModule(pci.device, vert, nullptr);
+        vkDestroyShaderModule(pci.device, frag, nullptr);
+        if (task != VK_NULL_HANDLE)
+            vkDestroyShaderModule(pci.device, task, nullptr);
+        if (mesh != VK_NULL_HANDLE)
+            vkDestroyShaderModule(pci.device, mesh, nullptr);
+        if (bakeFrag != VK_NULL_HANDLE && bakeFrag != frag)
+            vkDestroyShaderModule(pci.device, bakeFrag, nullptr);
+
+        if (bakeResult != VK_SUCCESS)
         {
-            if (!ensurePaletteCapacity(*camFrame, neededMatrices))
-                return;
-
-            const size_t expected = static_cast<size_t>(neededMatrices);
-
-            // Prefer the explicitly provided palette; otherwise fall back to the model's current node globals.
-            if (m_nodePalette.size() == expected)
-            {
-                std::memcpy(camFrame->paletteMapped, m_nodePalette.data(), sizeof(glm::mat4) * expected);
-            }
-            else
-            {
-                // Build a minimal fallback palette: replicate current per-node globals for each instance.
-                std::vector<glm::mat4> fallback;
-                fallback.resize(expected);
-                const uint32_t modelNodeCount = static_cast<uint32_t>(model->nodes.size());
-                for (uint32_t inst = 0; inst < instanceCount; ++inst)
-                {
-                    for (uint32_t ni = 0; ni < nodeCount; ++ni)
-                    {
-                        glm::mat4 g = glm::mat4(1.0f);
-                        if (ni < modelNodeCount)
-                            g = model->nodes[ni].globalMatrix;
-                        fallback[static_cast<size_t>(inst) * nodeCount + ni] = g;
-                    }
-                }
-                std::memcpy(camFrame->paletteMapped, fallback.data(), sizeof(glm::mat4) * expected);
-            }
+            ENGINE_LOG_WARN("[SModel] Impostors disabled: bake pipeline creation failed");
+            destroyImpostorResources();
+            m_impostors = false;
         }
 
-        // Update joint palette buffer for this frame (SSBO in set=0 binding=2).
-        const uint32_t jointStride = (model->totalJointCount > 0) ? model->totalJointCount : 1u;
-        const uint32_t neededJointMatrices = instanceCount * jointStride;
-        if (camFrame && camFrame->jointPaletteMapped)
+        // Meshlet draws fall back to the compute path (the layout keeps set 3 and the mesh stages).
+        if (meshResult != VK_SUCCESS)
         {
-            if (!ensureJointPaletteCapacity(*camFrame, neededJointMatrices))
-                return;
-
-            const size_t expected = static_cast<size_t>(neededJointMatrices);
-            if (model->totalJointCount > 0 && m_jointPaletteJointCount == model->totalJointCount && m_jointPalette.size() == expected)
+            ENGINE_LOG_WARN("[SModel] Mesh shaders disabled: pipeline creation failed");
+            for (uint32_t format = 0; format < kVertexFormatCount; ++format)
             {
-                std::memcpy(camFrame->jointPaletteMapped, m_jointPalette.data(), sizeof(glm::mat4) * expected);
-            }
-            else
-            {
-                // Default to identity matrices. Shader will not use these unless skinJointCount > 0.
-                std::vector<glm::mat4> fallback;
-                fallback.assign(expected, glm::mat4(1.0f));
-                std::memcpy(camFrame->jointPaletteMapped, fallback.data(), sizeof(glm::mat4) * expected);
+                m_meshPipelineOpaque[format].destroy(pci.device);
+                m_meshPipelineMask[format].destroy(pci.device);
+                m_meshPipelineDepth[format].destroy(pci.device);
             }
+            m_meshShaders = false;
         }
 
-        // Pass ordering like glTF: 0=OPAQUE,1=MASK,2=BLEND
-        for (uint32_t pass = 0; pass < 3; ++pass)
+        if (result != VK_SUCCESS)
         {
-            const Pipeline *pipe = nullptr;
-            if (pass == 0)
-                pipe = &m_pipelineOpaque;
-            else if (pass == 1)
-                pipe = &m_pipelineMask;
-            else
-                pipe = &m_pipelineBlend;
-
-            pipe->bind(cmd);
-
-            if (camFrame && camFrame->set != VK_NULL_HANDLE)
-            {
-                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &camFrame->set, 0, nullptr);
-            }
-
-            if (instFrame && instFrame->buffer != VK_NULL_HANDLE)
-            {
-                VkDeviceSize instOffset = 0;
-                vkCmdBindVertexBuffers(cmd, 1, 1, &instFrame->buffer, &instOffset);
-            }
-
-            if (!model->nodes.empty())
-            {
-                // Draw by nodes: push base model matrix + node index; vertex shader fetches node matrix from palette
-                const glm::mat4 baseM = glm::make_mat4(m_pc.model);
-                for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(model->nodes.size()); ++nodeIndex)
-                {
-                    const auto &node = model->nodes[nodeIndex];
-
-                    for (uint32_t k = 0; k < node.primitiveCount; ++k)
-                    {
-                        const uint32_t primIndex = model->nodePrimitiveIndices[node.firstPrimitiveIndex + k];
-                        if (primIndex >= model->primitives.size())
-                            continue;
-                        const ModelPrimitive &prim = model->primitives[primIndex];
-
-                        MeshAsset *mesh = m_assets->getMesh(prim.mesh);
-                        MaterialAsset *mat = m_assets->getMaterial(prim.material);
-                        if (!mesh || !mat)
-                            continue;
-                        if (mat->alphaMode != pass)
-                            continue;
-
-                        VkDescriptorSet matSet = getOrCreateMaterialSet(prim.material, mat);
-                        if (matSet != VK_NULL_HANDLE)
-                        {
-                            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &matSet, 0, nullptr);
-                        }
-
-                        PushConstantsModel pc{};
-                        std::memcpy(pc.model, glm::value_ptr(baseM), sizeof(pc.model));
-                        std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
-                        pc.materialParams[0] = mat->alphaCutoff;
-                        pc.materialParams[1] = static_cast<float>(mat->alphaMode);
-                        pc.materialParams[2] = 0.0f;
-                        pc.materialParams[3] = 0.0f;
-                        pc.nodeIndex = nodeIndex;
-                        pc.nodeCount = static_cast<uint32_t>(model->nodes.size());
-
-                        // Skinning per-primitive
-                        pc.jointPaletteStride = jointStride;
-                        if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model->skins.size())
-                        {
-                            const auto &skin = model->skins[static_cast<uint32_t>(prim.skinIndex)];
-                            pc.skinBaseJoint = skin.jointBase;
-                            pc.skinJointCount = skin.jointCount;
-                        }
-                        else
-                        {
-                            pc.skinBaseJoint = 0;
-                            pc.skinJointCount = 0;
-                        }
-                        vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
-
-                        VkBuffer vb = mesh->getVertexBuffer();
-                        VkBuffer ib = mesh->getIndexBuffer();
-                        if (vb == VK_NULL_HANDLE || ib == VK_NULL_HANDLE || prim.indexCount == 0)
-                            continue;
-
-                        VkDeviceSize vbOffset = 0;
-                        vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &vbOffset);
-                        vkCmdBindIndexBuffer(cmd, ib, 0, mesh->getIndexType());
-
-                        vkCmdDrawIndexed(cmd, prim.indexCount, instanceCount, prim.firstIndex, prim.vertexOffset, 0);
-                        DrawCallCounter::increment();
-                    }
-                }
-            }
-            else
-            {
-                // Fallback: draw all primitives with base model matrix
-                const glm::mat4 baseM = glm::make_mat4(m_pc.model);
-                for (const ModelPrimitive &prim : model->primitives)
-                {
-                    MeshAsset *mesh = m_assets->getMesh(prim.mesh);
-                    MaterialAsset *mat = m_assets->getMaterial(prim.material);
-                    if (!mesh || !mat)
-                        continue;
-                    if (mat->alphaMode != pass)
-                        continue;
-
-                    VkDescriptorSet matSet = getOrCreateMaterialSet(prim.material, mat);
-                    if (matSet != VK_NULL_HANDLE)
-                    {
-                        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &matSet, 0, nullptr);
-                    }
-
-                    PushConstantsModel pc{};
-                    std::memcpy(pc.model, glm::value_ptr(baseM), sizeof(pc.model));
-                    std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
-                    pc.materialParams[0] = mat->alphaCutoff;
-                    pc.materialParams[1] = static_cast<float>(mat->alphaMode);
-                    pc.materialParams[2] = 0.0f;
-                    pc.materialParams[3] = 0.0f;
-                    pc.nodeIndex = 0;
-                    pc.nodeCount = 1;
-
-                    pc.jointPaletteStride = jointStride;
-                    if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model->skins.size())
-                    {
-                        const auto &skin = model->skins[static_cast<uint32_t>(prim.skinIndex)];
-                        pc.skinBaseJoint = skin.jointBase;
-                        pc.skinJointCount = skin.jointCount;
-                    }
-                    else
-                    {
-                        pc.skinBaseJoint = 0;
-                        pc.skinJointCount = 0;
-                    }
-                    vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
-
-                    VkBuffer vb = mesh->getVertexBuffer();
-                    VkBuffer ib = mesh->getIndexBuffer();
-                    if (vb == VK_NULL_HANDLE || ib == VK_NULL_HANDLE || prim.indexCount == 0)
-                        continue;
-
-                    VkDeviceSize vbOffset = 0;
-                    vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &vbOffset);
-                    vkCmdBindIndexBuffer(cmd, ib, 0, mesh->getIndexType());
-
-                    vkCmdDrawIndexed(cmd, prim.indexCount, instanceCount, prim.firstIndex, prim.vertexOffset, 0);
-                    DrawCallCounter::increment();
-                }
-            }
+            throw std::runtime_error("SModelRenderPassModule: failed to create one or more pipelines");
         }
     }
 
-    void SModelRenderPassModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
+    uint32_t SModelRenderPassModule::impostorFrameCount(const ModelAsset &model)
     {
-        (void)ctx;
-        m_extent = newExtent;
+        const uint32_t clips = std::min(static_cast<uint32_t>(model.animClips.size()), kImpostorMaxClips);
+        return (clips > 0) ? clips * kImpostorFramesPerClip : 1u;
     }
 
-    void SModelRenderPassModule::destroyResources()
+    uint32_t SModelRenderPassModule::impostorFrame(const ModelAsset &model, uint32_t clip, float timeSec)
     {
-        if (m_device == VK_NULL_HANDLE)
-            return;
-
-        destroyCameraResources();
-        destroyInstanceResources();
-        destroyMaterialResources();
+        if (clip >= std::min(static_cast<uint32_t>(model.animClips.size()), kImpostorMaxClips))
+            return 0;
+        const float duration = model.animClips[clip].durationSec;
+        if (duration <= 1e-6f)
+            return clip * kImpostorFramesPerClip;
+        float t = std::fmod(timeSec, duration);
+        if (t < 0.0f)
+            t += duration;
+        const uint32_t k = static_cast<uint32_t>(std::lround(t / duration * static_cast<float>(kImpostorFramesPerClip)));
+        return clip * kImpostorFramesPerClip + k % kImpostorFramesPerClip;
+    }
 
-        m_pipelineOpaque.destroy(m_device);
-        m_pipelineMask.destroy(m_device);
-        m_pipelineBlend.destroy(m_device);
+    bool SModelRenderPassModule::createImpostorResources(VulkanContext &ctx, VkRenderPass pass)
+    {
+        destroyImpostorResources();
+        VkDevice device = ctx.GetDevice();
 
-        if (m_pipelineLayout != VK_NULL_HANDLE)
+        VkShaderModule vert = Pipeline::createShaderModuleFromFile(device, "shaders/impostor.vert.spv");
+        VkShaderModule frag = VK_NULL_HANDLE;
+        try
         {
-            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
-            m_pipelineLayout = VK_NULL_HANDLE;
+            frag = Pipeline::createShaderModuleFromFile(device, "shaders/impostor.frag.spv");
+        }
+        catch (...)
+        {
+            vkDestroyShaderModule(device, vert, nullptr);
+            throw;
+        }
+        if (vert == VK_NULL_HANDLE || frag == VK_NULL_HANDLE)
+        {
+            if (vert != VK_NULL_HANDLE)
+                vkDestroyShaderModule(device, vert, nullptr);
+            if (frag != VK_NULL_HANDLE)
+                vkDestroyShaderModule(device, frag, nullptr);
+            ENGINE_LOG_WARN("[SModel] Impostors disabled: failed to load impostor.vert/frag.spv");
+            return false;
+        }
+
+        // Bake pass: atlas mip 0 (left in TRANSFER_DST for the mip blits) and a depth buffer.
+        VkAttachmentDescription attachments[2]{};
+        attachments[0].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        attachments[1].format = VK_FORMAT_D16_UNORM;
+        attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference colorRef{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkAttachmentReference depthRef{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorRef;
+        subpass.pDepthStencilAttachment = &depthRef;
+
+        VkSubpassDependency dependency{};
+        dependency.srcSubpass = 0;
+        dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        VkRenderPassCreateInfo rpInfo{};
+        rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        rpInfo.attachmentCount = 2;
+        rpInfo.pAttachments = attachments;
+        rpInfo.subpassCount = 1;
+        rpInfo.pSubpasses = &subpass;
+        rpInfo.dependencyCount = 1;
+        rpInfo.pDependencies = &dependency;
+
+        bool ok = vkCreateRenderPass(device, &rpInfo, nullptr, &m_impostorBakePass) == VK_SUCCESS;
+
+        // Bake layout: smodel.vert/smodel.frag with per-material sets.
+        VkPushConstantRange bakeRange{VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel)};
+        VkDescriptorSetLayout bakeSets[3] = {m_globalSetLayout, m_paletteSetLayout, m_materialSetLayout};
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 3;
+        plInfo.pSetLayouts = bakeSets;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &bakeRange;
+        ok = ok && vkCreatePipelineLayout(device, &plInfo, nullptr, &m_impostorBakeLayout) == VK_SUCCESS;
+
+        // Impostor layout: global set, atlas set (a material-layout set).
+        VkPushConstantRange range{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstantsImpostor)};
+        VkDescriptorSetLayout sets[2] = {m_globalSetLayout, m_materialSetLayout};
+        plInfo.setLayoutCount = 2;
+        plInfo.pSetLayouts = sets;
+        plInfo.pPushConstantRanges = &range;
+        ok = ok && vkCreatePipelineLayout(device, &plInfo, nullptr, &m_impostorLayout) == VK_SUCCESS;
+
+        // One atlas set per model.
+        VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kImpostorAtlasCapacity};
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        poolInfo.maxSets = kImpostorAtlasCapacity;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        ok = ok && vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_impostorPool) == VK_SUCCESS;
+        ok = ok && CreateTextureSampler(device, ctx.GetPhysicalDevice(), VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                        VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, 1.0f,
+                                        static_cast<float>(kImpostorMipLevels), m_impostorSampler) == VK_SUCCESS;
+
+        if (ok)
+        {
+            PipelineCreateInfo pci{};
+            pci.device = device;
+            pci.renderPass = pass;
+            pci.subpass = 0;
+            pci.pipelineLayout = m_impostorLayout;
+
+            VkPipelineShaderStageCreateInfo stages[2]{};
+            stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+            stages[0].module = vert;
+            stages[0].pName = "main";
+            stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+            stages[1].module = frag;
+            stages[1].pName = "main";
+            pci.shaderStages = {stages[0], stages[1]};
+
+            // Instance data only: binding 0 world matrix, binding 1 InstancePose (pose0: impostor frame).
+            VkVertexInputBindingDescription bindings[2]{};
+            bindings[0] = {0, sizeof(glm::mat4), VK_VERTEX_INPUT_RATE_INSTANCE};
+            bindings[1] = {1, sizeof(InstancePose), VK_VERTEX_INPUT_RATE_INSTANCE};
+            VkVertexInputAttributeDescription attrs[5]{};
+            for (uint32_t c = 0; c < 4; ++c)
+                attrs[c] = {c, 0, VK_FORMAT_R32G32B32A32_SFLOAT, c * 16};
+            attrs[4] = {4, 1, VK_FORMAT_R32G32_UINT, 0};
+
+            VkPipelineVertexInputStateCreateInfo vi{};
+            vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vi.vertexBindingDescriptionCount = 2;
+            vi.pVertexBindingDescriptions = bindings;
+            vi.vertexAttributeDescriptionCount = 5;
+            vi.pVertexAttributeDescriptions = attrs;
+            pci.vertexInput = vi;
+            pci.vertexInputProvided = true;
+
+            VkPipelineInputAssemblyStateCreateInfo ia{};
+            ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+            ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+            pci.inputAssembly = ia;
+            pci.inputAssemblyProvided = true;
+
+            VkPipelineRasterizationStateCreateInfo rs{};
+            rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rs.polygonMode = VK_POLYGON_MODE_FILL;
+            rs.lineWidth = 1.0f;
+            rs.cullMode = VK_CULL_MODE_NONE;
+            rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            pci.rasterization = rs;
+            pci.rasterizationProvided = true;
+
+            pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+            // Alpha tested and depth written like masked draws, after the pre-pass when there is one.
+            VkPipelineDepthStencilStateCreateInfo ds{};
+            ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+            ds.depthTestEnable = VK_TRUE;
+            ds.depthWriteEnable = VK_TRUE;
+            ds.depthCompareOp = (m_depthPrepassPass != VK_NULL_HANDLE) ? VK_COMPARE_OP_LESS_OR_EQUAL : VK_COMPARE_OP_LESS;
+            pci.depthStencil = ds;
+            pci.depthStencilProvided = true;
+
+            VkPipelineColorBlendAttachmentState att{};
+            pci.colorBlend = makeBlendState(false, att);
+            pci.colorBlendProvided = true;
+
+            ok = m_impostorPipeline.create(pci) == VK_SUCCESS;
+        }
+
+        vkDestroyShaderModule(device, vert, nullptr);
+        vkDestroyShaderModule(device, frag, nullptr);
+        if (!ok)
+            ENGINE_LOG_WARN("[SModel] Impostors disabled: failed to create their resources");
+        return ok;
+    }
+
+    void SModelRenderPassModule::destroyImpostorAtlas(ImpostorAtlas &atlas)
+    {
+        if (atlas.set != VK_NULL_HANDLE && m_impostorPool != VK_NULL_HANDLE)
+            vkFreeDescriptorSets(m_device, m_impostorPool, 1, &atlas.set);
+        atlas.set = VK_NULL_HANDLE;
+        if (atlas.view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_device, atlas.view, nullptr);
+            atlas.view = VK_NULL_HANDLE;
+        }
+        if (atlas.image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_device, atlas.image, nullptr);
+            atlas.image = VK_NULL_HANDLE;
+        }
+        FreeMemory(atlas.memory);
+    }
+
+    void SModelRenderPassModule::destroyImpostorResources()
+    {
+        for (auto &entry : m_impostorAtlases)
+            destroyImpostorAtlas(entry.second);
+        m_impostorAtlases.clear();
+
+        for (Pipeline &pipeline : m_impostorBakePipelines)
+            pipeline.destroy(m_device);
+        m_impostorPipeline.destroy(m_device);
+
+        if (m_impostorSampler != VK_NULL_HANDLE)
+        {
+            vkDestroySampler(m_device, m_impostorSampler, nullptr);
+            m_impostorSampler = VK_NULL_HANDLE;
+        }
+        if (m_impostorPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_impostorPool, nullptr);
+            m_impostorPool = VK_NULL_HANDLE;
+        }
+        if (m_impostorLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_impostorLayout, nullptr);
+            m_impostorLayout = VK_NULL_HANDLE;
+        }
+        if (m_impostorBakeLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_impostorBakeLayout, nullptr);
+            m_impostorBakeLayout = VK_NULL_HANDLE;
+        }
+        if (m_impostorBakePass != VK_NULL_HANDLE)
+        {
+            vkDestroyRenderPass(m_device, m_impostorBakePass, nullptr);
+            m_impostorBakePass = VK_NULL_HANDLE;
+        }
+    }
+
+    bool SModelRenderPassModule::bakeImpostor(ModelHandle model)
+    {
+        const ModelAsset *asset = m_assets ? m_assets->getModel(model) : nullptr;
+        return asset && impostorAtlas(model, *asset) != nullptr;
+    }
+
+    const SModelRenderPassModule::ImpostorAtlas *SModelRenderPassModule::impostorAtlas(ModelHandle h, const ModelAsset &model)
+    {
+        if (!m_impostors)
+            return nullptr;
+        const uint64_t key = (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id);
+        auto found = m_impostorAtlases.find(key);
+        if (found == m_impostorAtlases.end())
+        {
+            found = m_impostorAtlases.emplace(key, ImpostorAtlas{}).first;
+            ImpostorAtlas &atlas = found->second;
+            atlas.failed = m_impostorAtlases.size() > kImpostorAtlasCapacity || !bakeImpostorAtlas(model, modelInfo(h, model), atlas);
+            if (atlas.failed)
+            {
+                ENGINE_LOG_WARN("[SModel] Impostor atlas bake failed; the model's impostors draw as meshes");
+                destroyImpostorAtlas(atlas);
+            }
+        }
+        return found->second.failed ? nullptr : &found->second;
+    }
+
+    bool SModelRenderPassModule::bakeImpostorAtlas(const ModelAsset &model, const ModelInfo &info, ImpostorAtlas &out)
+    {
+        const VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+        const uint32_t frames = impostorFrameCount(model);
+        const uint32_t cells = kImpostorViews * frames;
+        const uint32_t width = kImpostorViews * kImpostorCellSize;
+        const uint32_t height = frames * kImpostorCellSize;
+
+        VkFormatProperties formatProps{};
+        vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProps);
+        const uint32_t mipLevels = (formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? kImpostorMipLevels : 1u;
+        out.frameCount = frames;
+        if (CreateImage2D(m_device, m_physicalDevice, width, height, format,
+                          VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                          mipLevels, out.image, out.memory, MemoryCategory::RenderTargets) != VK_SUCCESS)
+            return false;
+        if (CreateImageView2D(m_device, out.image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, out.view) != VK_SUCCESS)
+            return false;
+
+        // Bake-only resources, released before returning: targets, camera, per-frame palettes, instances.
+        VkImageView colorView = VK_NULL_HANDLE;
+        VkImage depthImage = VK_NULL_HANDLE;
+        MemoryAllocation depthMemory;
+        VkImageView depthView = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        VkBuffer globalsBuffer = VK_NULL_HANDLE, nodeBuffer = VK_NULL_HANDLE, jointBuffer = VK_NULL_HANDLE, instanceBuffer = VK_NULL_HANDLE;
+        MemoryAllocation globalsMemory, nodeMemory, jointMemory, instanceMemory;
+        void *globalsMapped = nullptr, *nodeMapped = nullptr, *jointMapped = nullptr, *instanceMapped = nullptr;
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        auto release = [&]()
+        {
+            if (commandPool != VK_NULL_HANDLE)
+                vkDestroyCommandPool(m_device, commandPool, nullptr);
+            if (pool != VK_NULL_HANDLE)
+                vkDestroyDescriptorPool(m_device, pool, nullptr);
+            destroyBuffer(globalsBuffer, globalsMemory, &globalsMapped);
+            destroyBuffer(nodeBuffer, nodeMemory, &nodeMapped);
+            destroyBuffer(jointBuffer, jointMemory, &jointMapped);
+            destroyBuffer(instanceBuffer, instanceMemory, &instanceMapped);
+            if (framebuffer != VK_NULL_HANDLE)
+                vkDestroyFramebuffer(m_device, framebuffer, nullptr);
+            if (depthView != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, depthView, nullptr);
+            if (depthImage != VK_NULL_HANDLE)
+                vkDestroyImage(m_device, depthImage, nullptr);
+            FreeMemory(depthMemory);
+            if (colorView != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, colorView, nullptr);
+        };
+
+        bool ok = CreateImageView2D(m_device, out.image, format, VK_IMAGE_ASPECT_COLOR_BIT, colorView) == VK_SUCCESS &&
+                  CreateImage2D(m_device, m_physicalDevice, width, height, VK_FORMAT_D16_UNORM, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                depthImage, depthMemory, MemoryCategory::RenderTargets) == VK_SUCCESS &&
+                  CreateImageView2D(m_device, depthImage, VK_FORMAT_D16_UNORM, VK_IMAGE_ASPECT_DEPTH_BIT, depthView) == VK_SUCCESS;
+        if (ok)
+        {
+            VkImageView views[2] = {colorView, depthView};
+            VkFramebufferCreateInfo fbInfo{};
+            fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            fbInfo.renderPass = m_impostorBakePass;
+            fbInfo.attachmentCount = 2;
+            fbInfo.pAttachments = views;
+            fbInfo.width = width;
+            fbInfo.height = height;
+            fbInfo.layers = 1;
+            ok = vkCreateFramebuffer(m_device, &fbInfo, nullptr, &framebuffer) == VK_SUCCESS;
+        }
+
+        // Palettes of every frame, laid out like a batch's: [frame][rendered node] and [frame][joint].
+        const uint32_t renderedNodes = static_cast<uint32_t>(model.renderedNodes.size());
+        const bool nodeGraph = !model.nodes.empty() && model.renderedSlot.size() == model.nodes.size();
+        const uint32_t nodeCount = (nodeGraph && renderedNodes > 0) ? renderedNodes : 1u;
+        const uint32_t jointStride = (model.totalJointCount > 0) ? model.totalJointCount : 1u;
+        const VkMemoryPropertyFlags hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        ok = ok && createBuffer(globalsBuffer, globalsMemory, sizeof(GlobalUniforms), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, hostProps, &globalsMapped);
+        ok = ok && createBuffer(nodeBuffer, nodeMemory, sizeof(PaletteMatrix) * frames * nodeCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                hostProps, &nodeMapped);
+        ok = ok && createBuffer(jointBuffer, jointMemory, sizeof(PaletteMatrix) * frames * jointStride, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                hostProps, &jointMapped);
+        ok = ok && createBuffer(instanceBuffer, instanceMemory, (sizeof(glm::mat4) + sizeof(InstancePose)) * cells,
+                                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostProps, &instanceMapped);
+        if (!ok)
+        {
+            release();
+            return false;
+        }
+
+        PaletteMatrix *nodeDst = static_cast<PaletteMatrix *>(nodeMapped);
+        PaletteMatrix *jointDst = static_cast<PaletteMatrix *>(jointMapped);
+        std::fill_n(nodeDst, static_cast<size_t>(frames) * nodeCount, PaletteMatrix::identity());
+        std::fill_n(jointDst, static_cast<size_t>(frames) * jointStride, PaletteMatrix::identity());
+        ModelAsset::PoseScratch scratch;
+        std::vector<glm::mat4> globals;
+        for (uint32_t f = 0; f < frames; ++f)
+        {
+            globals.clear();
+            if (!model.animClips.empty())
+            {
+                const uint32_t clip = f / kImpostorFramesPerClip;
+                const float t = model.animClips[clip].durationSec * static_cast<float>(f % kImpostorFramesPerClip) /
+                                static_cast<float>(kImpostorFramesPerClip);
+                model.evaluatePoseInto(clip, t, scratch, globals);
+            }
+            if (globals.size() != model.nodes.size())
+            {
+                globals.resize(model.nodes.size());
+                for (size_t n = 0; n < model.nodes.size(); ++n)
+                    globals[n] = model.nodes[n].globalMatrix;
+            }
+            const uint32_t globalCount = static_cast<uint32_t>(globals.size());
+            if (nodeGraph && renderedNodes > 0)
+                model.gatherRenderedNodes(globals.data(), globalCount, nodeDst + static_cast<size_t>(f) * nodeCount);
+            if (model.totalJointCount > 0)
+                model.computeJointMatrices(globals.data(), globalCount, jointDst + static_cast<size_t>(f) * jointStride);
+        }
+
+        // Instance (view v, frame f) turns the model by -v * 2pi / views about its up axis, so the fixed
+        // camera sees it from azimuth v * 2pi / views (impostor.vert picks the column back from it).
+        glm::mat4 *worlds = static_cast<glm::mat4 *>(instanceMapped);
+        InstancePose *poses = reinterpret_cast<InstancePose *>(worlds + cells);
+        for (uint32_t v = 0; v < kImpostorViews; ++v)
+        {
+            const float azimuth = 6.28318530718f * static_cast<float>(v) / static_cast<float>(kImpostorViews);
+            const glm::mat4 turn = glm::rotate(glm::mat4(1.0f), -azimuth, glm::vec3(0.0f, 1.0f, 0.0f));
+            for (uint32_t f = 0; f < frames; ++f)
+            {
+                worlds[v * frames + f] = turn;
+                poses[v * frames + f] = InstancePose{f, f, 0.0f};
+            }
+        }
+
+        // Orthographic camera over the bounding sphere, looking down at kElevation from +Z; Y flipped
+        // like the Renderer's projection.
+        constexpr float kElevation = 0.6f; // radians
+        const glm::vec3 center(info.sphere[0], info.sphere[1], info.sphere[2]);
+        const float radius = (info.hasSphere && info.sphere[3] > 0.0f) ? info.sphere[3] : 1.0f;
+        const glm::vec3 eye = center + 2.0f * radius * glm::vec3(0.0f, std::sin(kElevation), std::cos(kElevation));
+        const float zNear = 0.5f * radius;
+        const float zFar = 3.5f * radius;
+        const glm::mat4 view = glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 proj(0.0f);
+        proj[0][0] = 1.0f / radius;
+        proj[1][1] = -1.0f / radius;
+        proj[2][2] = -1.0f / (zFar - zNear);
+        proj[3][2] = -zNear / (zFar - zNear);
+        proj[3][3] = 1.0f;
+        const glm::mat4 viewProj = proj * view;
+        GlobalUniforms g{};
+        std::memcpy(g.view, glm::value_ptr(view), sizeof(g.view));
+        std::memcpy(g.proj, glm::value_ptr(proj), sizeof(g.proj));
+        std::memcpy(g.viewProj, glm::value_ptr(viewProj), sizeof(g.viewProj));
+        g.cameraPos[0] = eye.x;
+        g.cameraPos[1] = eye.y;
+        g.cameraPos[2] = eye.z;
+        g.frame[2] = kImpostorCellSize;
+        g.frame[3] = kImpostorCellSize;
+        std::memcpy(globalsMapped, &g, sizeof(g));
+
+        // Sets 0 and 1 of the bake.
+        VkDescriptorPoolSize poolSizes[2] = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}, {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2}};
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = 2;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        VkDescriptorSet sets[2] = {};
+        VkDescriptorSetLayout setLayouts[2] = {m_globalSetLayout, m_paletteSetLayout};
+        VkDescriptorSetAllocateInfo setAlloc{};
+        setAlloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setAlloc.descriptorSetCount = 2;
+        setAlloc.pSetLayouts = setLayouts;
+        ok = vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &pool) == VK_SUCCESS;
+        setAlloc.descriptorPool = pool;
+        ok = ok && vkAllocateDescriptorSets(m_device, &setAlloc, sets) == VK_SUCCESS;
+        if (!ok)
+        {
+            release();
+            return false;
+        }
+        VkDescriptorBufferInfo bufferInfos[3] = {{globalsBuffer, 0, sizeof(GlobalUniforms)},
+                                                 {nodeBuffer, 0, VK_WHOLE_SIZE},
+                                                 {jointBuffer, 0, VK_WHOLE_SIZE}};
+        VkWriteDescriptorSet writes[3]{};
+        for (uint32_t w = 0; w < 3; ++w)
+        {
+            writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[w].dstSet = (w == 0) ? sets[0] : sets[1];
+            writes[w].dstBinding = (w == 0) ? 0u : w - 1u;
+            writes[w].descriptorCount = 1;
+            writes[w].descriptorType = (w == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[w].pBufferInfo = &bufferInfos[w];
+        }
+        vkUpdateDescriptorSets(m_device, 3, writes, 0, nullptr);
+
+        VkCommandPoolCreateInfo cmdPoolInfo{};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = m_graphicsQueueFamily;
+        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        UploadContext upload{};
+        if (vkCreateCommandPool(m_device, &cmdPoolInfo, nullptr, &commandPool) != VK_SUCCESS ||
+            !BeginUploadContext(upload, m_device, m_physicalDevice, commandPool, m_graphicsQueue))
+        {
+            release();
+            return false;
+        }
+        VkCommandBuffer cmd = upload.cmd;
+
+        VkClearValue clears[2]{};
+        clears[0].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
+        clears[1].depthStencil = {1.0f, 0};
+        VkRenderPassBeginInfo rpBegin{};
+        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin.renderPass = m_impostorBakePass;
+        rpBegin.framebuffer = framebuffer;
+        rpBegin.renderArea = {{0, 0}, {width, height}};
+        rpBegin.clearValueCount = 2;
+        rpBegin.pClearValues = clears;
+        vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorBakeLayout, 0, 2, sets, 0, nullptr);
+        const VkBuffer instanceBuffers[2] = {instanceBuffer, instanceBuffer};
+        const VkDeviceSize instanceOffsets[2] = {0, sizeof(glm::mat4) * cells};
+        vkCmdBindVertexBuffers(cmd, 1, 2, instanceBuffers, instanceOffsets);
+
+        // Every full-resolution primitive, by node like prepareFrame(), into each cell.
+        auto drawPrimitive = [&](uint32_t primIndex, uint32_t nodeSlot)
+        {
+            if (primIndex >= model.primitives.size())
+                return;
+            const ModelPrimitive &prim = model.primitives[primIndex];
+            MeshAsset *mesh = m_assets->getMesh(prim.mesh);
+            MaterialAsset *mat = m_assets->getMaterial(prim.material);
+            if (!mesh || !mat || prim.indexCount == 0 || mat->alphaMode > 2)
+                return;
+            if (mesh->getVertexBuffer() == VK_NULL_HANDLE || mesh->getIndexBuffer() == VK_NULL_HANDLE)
+                return;
+            VkDescriptorSet matSet = getOrCreateMaterialSet(prim.material, mat);
+            if (matSet == VK_NULL_HANDLE)
+                return;
+
+            PushConstantsModel pc{};
+            for (uint32_t r = 0; r < 3; ++r)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                    pc.model[r * 4 + c] = info.model[c * 4 + r];
+            }
+            std::memcpy(pc.positionDequant, mesh->getPositionDequant(), sizeof(pc.positionDequant));
+            std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
+            pc.materialParams[0] = mat->alphaCutoff;
+            pc.materialParams[1] = static_cast<float>(mat->alphaMode);
+            pc.nodeIndex = nodeSlot;
+            pc.nodeCount = nodeCount;
+            pc.jointPaletteStride = jointStride;
+            if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model.skins.size())
+            {
+                const auto &skin = model.skins[static_cast<uint32_t>(prim.skinIndex)];
+                pc.skinBaseJoint = skin.jointBase;
+                pc.skinJointCount = skin.jointCount;
+            }
+
+            const uint32_t bakeVariant = (mat->alphaMode == 1 ? kShaderVariantCount : 0u) + shaderVariant(mesh->isCompact(), pc.skinJointCount > 0);
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorBakePipelines[bakeVariant].getVkPipeline());
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorBakeLayout, 2, 1, &matSet, 0, nullptr);
+            vkCmdPushConstants(cmd, m_impostorBakeLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                               sizeof(PushConstantsModel), &pc);
+            const VkBuffer vertexBuffer = mesh->getVertexBuffer();
+            const VkDeviceSize zero = 0;
+            vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, &zero);
+            vkCmdBindIndexBuffer(cmd, mesh->getIndexBuffer(), 0, mesh->getIndexType());
+            for (uint32_t v = 0; v < kImpostorViews; ++v)
+            {
+                for (uint32_t f = 0; f < frames; ++f)
+                {
+                    const VkViewport vp{static_cast<float>(v * kImpostorCellSize), static_cast<float>(f * kImpostorCellSize),
+                                        static_cast<float>(kImpostorCellSize), static_cast<float>(kImpostorCellSize), 0.0f, 1.0f};
+                    const VkRect2D sc{{static_cast<int32_t>(v * kImpostorCellSize), static_cast<int32_t>(f * kImpostorCellSize)},
+                                      {kImpostorCellSize, kImpostorCellSize}};
+                    vkCmdSetViewport(cmd, 0, 1, &vp);
+                    vkCmdSetScissor(cmd, 0, 1, &sc);
+                    vkCmdDrawIndexed(cmd, prim.indexCount, 1, prim.firstIndex, prim.vertexOffset, v * frames + f);
+                }
+            }
+        };
+        if (!model.nodes.empty())
+        {
+            for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(model.nodes.size()); ++nodeIndex)
+            {
+                const auto &node = model.nodes[nodeIndex];
+                const uint32_t nodeSlot = (nodeGraph && model.renderedSlot[nodeIndex] != ~0u) ? model.renderedSlot[nodeIndex] : 0u;
+                for (uint32_t k = 0; k < node.primitiveCount; ++k)
+                {
+                    const size_t ix = static_cast<size_t>(node.firstPrimitiveIndex) + k;
+                    if (ix < model.nodePrimitiveIndices.size())
+                        drawPrimitive(model.nodePrimitiveIndices[ix], nodeSlot);
+                }
+            }
+        }
+        else
+        {
+            for (uint32_t primIndex = 0; primIndex < static_cast<uint32_t>(model.primitives.size()); ++primIndex)
+            {
+                if (!model.primitives[primIndex].isLod)
+                    drawPrimitive(primIndex, 0u);
+            }
+        }
+        vkCmdEndRenderPass(cmd);
+
+        // Mip 0 is in TRANSFER_DST (the bake pass's final layout).
+        if (mipLevels > 1)
+            ok = CmdGenerateMipmaps(upload, out.image, format, static_cast<int32_t>(width), static_cast<int32_t>(height), mipLevels);
+        else
+            CmdTransitionImageLayout(upload, out.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                     VK_IMAGE_ASPECT_COLOR_BIT);
+        ok = EndSubmitAndWait(upload) && ok;
+        release();
+        if (!ok)
+            return false;
+
+        VkDescriptorSetAllocateInfo atlasAlloc{};
+        atlasAlloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        atlasAlloc.descriptorPool = m_impostorPool;
+        atlasAlloc.descriptorSetCount = 1;
+        atlasAlloc.pSetLayouts = &m_materialSetLayout;
+        if (vkAllocateDescriptorSets(m_device, &atlasAlloc, &out.set) != VK_SUCCESS)
+            return false;
+        VkDescriptorImageInfo di{m_impostorSampler, out.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = out.set;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &di;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        return true;
+    }
+
+    void SModelRenderPassModule::recordImpostors(const PreparedFrame &frame, VkCommandBuffer cmd)
+    {
+        RenderCounters passStats;
+        bool bound = false;
+        for (const FrameBatch &fb : m_frameBatches)
+        {
+            if (fb.impostorCount == 0 || !fb.impostor)
+                continue;
+            if (!bound)
+            {
+                VkViewport vp{0.0f, 0.0f, static_cast<float>(m_extent.width), static_cast<float>(m_extent.height), 0.0f, 1.0f};
+                VkRect2D sc{{0, 0}, {m_extent.width, m_extent.height}};
+                vkCmdSetViewport(cmd, 0, 1, &vp);
+                vkCmdSetScissor(cmd, 0, 1, &sc);
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorPipeline.getVkPipeline());
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorLayout, 0, 1, &frame.globalSet, 0, nullptr);
+                passStats.pipelineBinds = 1;
+                passStats.descriptorBinds = 1;
+                bound = true;
+            }
+
+            // The batch's last instances, in its own worlds and the frame's poses.
+            const uint32_t first = fb.entry->instanceCount - fb.impostorCount;
+            const VkBuffer buffers[2] = {fb.worldBuffer, frame.ringBuffer};
+            const VkDeviceSize offsets[2] = {fb.worldOffset + static_cast<VkDeviceSize>(first) * sizeof(glm::mat4),
+                                             frame.posesOffset + static_cast<VkDeviceSize>(fb.instanceFirst + first) * sizeof(InstancePose)};
+            vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorLayout, 1, 1, &fb.impostor->set, 0, nullptr);
+
+            PushConstantsImpostor pc{};
+            std::memcpy(pc.sphere, fb.info->sphere, sizeof(pc.sphere));
+            if (!fb.info->hasSphere)
+                pc.sphere[3] = 1.0f;
+            pc.grid[0] = kImpostorViews;
+            pc.grid[1] = fb.impostor->frameCount;
+            vkCmdPushConstants(cmd, m_impostorLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstantsImpostor), &pc);
+            vkCmdDraw(cmd, 4, fb.impostorCount, 0, 0);
+
+            // Impostors are never culled on the GPU: every quad submitted is drawn.
+            RenderCounters batchStats;
+            batchStats.drawCalls = 1;
+            batchStats.triangles = batchStats.visibleTriangles = 2ull * fb.impostorCount;
+            batchStats.descriptorBinds = 1;
+            batchStats.bufferBinds = 1;
+            passStats += batchStats;
+            RenderStats::addModel(modelKey(fb.entry->model), m_assets->getModelPath(fb.entry->model), batchStats);
+        }
+        if (bound)
+            RenderStats::addPass(name(), passStats);
+    }
+
+    bool SModelRenderPassModule::prepareFrame(FrameContext &frameCtx)
+    {
+        m_prepared = PreparedFrame{};
+        m_frameBatches.clear();
+        m_draws.clear();
+        if (!m_assets || m_batches.empty())
+            return false;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return false;
+        UploadRing *ring = frameCtx.uploadRing;
+        if (m_paletteFrames.empty() || !ring || frameCtx.globalSet == VK_NULL_HANDLE || !frameCtx.globals)
+            return false;
+
+        PaletteFrame *paletteFrame = &m_paletteFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_paletteFrames.size())];
+        if (!paletteFrame->paletteMapped || !paletteFrame->jointPaletteMapped)
+            return false;
+        BindlessFrame *bindlessFrame = nullptr;
+        if (m_bindless && !m_bindlessFrames.empty())
+        {
+            bindlessFrame = &m_bindlessFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_bindlessFrames.size())];
+            if (!updateBindlessFrame(*bindlessFrame))
+                return false;
+        }
+
+        // Batches of loaded models, one instance range each. Palette entries per batch: baked clip
+        // frames, shared poses when every instance names one, else one per instance.
+        uint32_t instanceCount = 0;
+        uint32_t ownWorldCount = 0;
+        uint32_t impostorCount = 0;
+        m_frameBakedModels.clear();
+        m_bakedOrder.clear();
+        for (const BatchEntry &e : m_batches)
+        {
+            ModelAsset *model = m_assets->getModel(e.model);
+            if (!model || model->primitives.empty())
+                continue;
+
+            FrameBatch fb{};
+            fb.entry = &e;
+            fb.model = model;
+            fb.info = &modelInfo(e.model, *model);
+            fb.instanceFirst = instanceCount;
+            instanceCount += e.instanceCount;
+            if (e.impostorCount > 0)
+            {
+                fb.impostor = impostorAtlas(e.model, *model);
+                fb.impostorCount = fb.impostor ? e.impostorCount : 0u;
+                impostorCount += fb.impostorCount;
+            }
+            if (e.instanceSource == VK_NULL_HANDLE)
+            {
+                fb.worldFirst = ownWorldCount;
+                ownWorldCount += e.instanceCount;
+            }
+
+            const uint32_t renderedNodes = static_cast<uint32_t>(model->renderedNodes.size());
+            const bool nodeGraph = !model->nodes.empty() && model->renderedSlot.size() == model->nodes.size();
+            fb.baked = e.baked && model->hasBakedAnimation() && !model->nodes.empty() &&
+                       model->bakedNodeGlobals.size() == static_cast<size_t>(model->bakedFrameCount) * renderedNodes;
+            const bool sharedPoses = !fb.baked && e.poseCount > 0 && e.hasPoses;
+            fb.poseCount = fb.baked ? model->bakedFrameCount : sharedPoses ? e.poseCount : e.instanceCount;
+            fb.nodeCount = (nodeGraph && renderedNodes > 0) ? renderedNodes : 1u;
+            fb.nodeMatrices = (nodeGraph && renderedNodes == 0) ? 1u : fb.poseCount * fb.nodeCount;
+            fb.jointStride = (model->totalJointCount > 0) ? model->totalJointCount : 1u;
+            if (fb.baked)
+                m_bakedOrder.push_back(static_cast<uint32_t>(m_frameBatches.size()));
+            m_frameBatches.push_back(fb);
+        }
+        if (m_frameBatches.empty())
+            return false;
+        requestTextureDetail(frameCtx);
+
+        // Palette layout: the baked frames of every baked model in the frame slot's baked buffers, in
+        // handle order so the slot keeps them while the set of baked models stays the same; the other
+        // batches' palettes in the upload ring.
+        std::sort(m_bakedOrder.begin(), m_bakedOrder.end(), [&](uint32_t a, uint32_t b)
+                  { return modelKey(m_frameBatches[a].entry->model) < modelKey(m_frameBatches[b].entry->model); });
+        uint32_t bakedNodeEnd = 0;
+        uint32_t bakedJointEnd = 0;
+        for (uint32_t b : m_bakedOrder)
+        {
+            FrameBatch &fb = m_frameBatches[b];
+            const uint64_t key = modelKey(fb.entry->model);
+            if (!m_frameBakedModels.empty() && m_frameBakedModels.back() == key)
+            {
+                // Another batch of the same model shares its frames.
+                const FrameBatch &prev = m_frameBatches[m_bakedOrder[m_frameBakedModels.size() - 1]];
+                fb.nodeBase = prev.nodeBase;
+                fb.jointBase = prev.jointBase;
+                continue;
+            }
+            m_frameBakedModels.push_back(key);
+            fb.nodeBase = bakedNodeEnd;
+            fb.jointBase = bakedJointEnd;
+            bakedNodeEnd += fb.nodeMatrices;
+            bakedJointEnd += fb.poseCount * fb.jointStride;
+        }
+        uint32_t nodeEnd = 0;
+        uint32_t jointEnd = 0;
+        for (FrameBatch &fb : m_frameBatches)
+        {
+            if (fb.baked)
+                continue;
+            fb.nodeBase = nodeEnd;
+            fb.jointBase = jointEnd;
+            nodeEnd += fb.nodeMatrices;
+            jointEnd += fb.poseCount * fb.jointStride;
+        }
+
+        // One upload ring allocation for the frame: node and joint palettes, own worlds, poses. Its
+        // start is aligned for all of them, and to a palette entry so the ring palettes, bound from
+        // the start of the ring buffer, index whole entries.
+        const VkDeviceSize storageAlign = ring->storageAlignment();
+        const VkDeviceSize entryBytes = sizeof(PaletteMatrix);
+        const VkDeviceSize nodeRel = 0;
+        const VkDeviceSize jointRel = nodeRel + static_cast<VkDeviceSize>(nodeEnd) * entryBytes;
+        const VkDeviceSize worldsRel = alignUp(jointRel + static_cast<VkDeviceSize>(jointEnd) * entryBytes, storageAlign);
+        const VkDeviceSize worldsBytes = static_cast<VkDeviceSize>(std::max(ownWorldCount, 1u)) * sizeof(glm::mat4);
+        const VkDeviceSize posesRel = alignUp(worldsRel + worldsBytes, storageAlign);
+        const VkDeviceSize posesBytes = static_cast<VkDeviceSize>(instanceCount) * sizeof(InstancePose);
+        const VkDeviceSize baseAlign = std::lcm(entryBytes, storageAlign);
+        const UploadRing::Allocation upload = ring->allocate(posesRel + posesBytes, baseAlign);
+        if (!upload.isValid())
+            return false;
+        if (paletteFrame->ringBuffer != upload.buffer)
+            writeRingSets(*paletteFrame, upload.buffer);
+        uint8_t *uploadBytes = static_cast<uint8_t *>(upload.mapped);
+
+        const uint32_t ringNodeBase = static_cast<uint32_t>((upload.offset + nodeRel) / entryBytes);
+        const uint32_t ringJointBase = static_cast<uint32_t>((upload.offset + jointRel) / entryBytes);
+        for (FrameBatch &fb : m_frameBatches)
+        {
+            if (fb.baked)
+                continue;
+            fb.nodeBase += ringNodeBase;
+            fb.jointBase += ringJointBase;
+        }
+
+        // Each batch's worlds (unless they already live on the GPU) and poses at its instance range.
+        glm::mat4 *worlds = reinterpret_cast<glm::mat4 *>(uploadBytes + worldsRel);
+        InstancePose *poses = reinterpret_cast<InstancePose *>(uploadBytes + posesRel);
+        for (FrameBatch &fb : m_frameBatches)
+        {
+            const BatchEntry &e = *fb.entry;
+            fb.uploadBytes = sizeof(InstancePose) * e.instanceCount;
+            if (e.instanceSource != VK_NULL_HANDLE)
+            {
+                fb.worldBuffer = e.instanceSource;
+                fb.worldOffset = e.instanceSourceOffset;
+            }
+            else
+            {
+                if (e.worlds)
+                    std::memcpy(worlds + fb.worldFirst, e.worlds, sizeof(glm::mat4) * e.instanceCount);
+                else
+                    worlds[fb.worldFirst] = identityMat4();
+                fb.uploadBytes += sizeof(glm::mat4) * (e.worlds ? e.instanceCount : 1u);
+                fb.worldBuffer = upload.buffer;
+                fb.worldOffset = upload.offset + worldsRel + static_cast<VkDeviceSize>(fb.worldFirst) * sizeof(glm::mat4);
+            }
+
+            // Impostors name an atlas frame instead.
+            const uint32_t impostorFirst = e.instanceCount - fb.impostorCount;
+            for (uint32_t i = 0; i < e.instanceCount; ++i)
+            {
+                InstancePose p = e.poses ? e.poses[i] : e.poseIndices ? InstancePose{e.poseIndices[i], e.poseIndices[i], 0.0f} : InstancePose{i, i, 0.0f};
+                if (i >= impostorFirst)
+                {
+                    p.pose0 = std::min(p.pose0, fb.impostor->frameCount - 1u);
+                    p.pose1 = p.pose0;
+                    p.blend = 0.0f;
+                }
+                else
+                {
+                    p.pose0 = std::min(p.pose0, fb.poseCount - 1u);
+                    p.pose1 = std::min(p.pose1, fb.poseCount - 1u);
+                }
+                poses[fb.instanceFirst + i] = p;
+            }
+        }
+
+        // Baked frames go to the frame slot's baked palette buffers (PaletteFrame::bakedSet); growing
+        // either drops the frames they held.
+        if (!ensurePaletteCapacity(*paletteFrame, std::max(bakedNodeEnd, 1u)))
+            return false;
+        if (!ensureJointPaletteCapacity(*paletteFrame, std::max(bakedJointEnd, 1u)))
+            return false;
+        const bool bakeResident = paletteFrame->bakedModels == m_frameBakedModels;
+        PaletteMatrix *ringNodes = reinterpret_cast<PaletteMatrix *>(uploadBytes + nodeRel);
+        PaletteMatrix *ringJoints = reinterpret_cast<PaletteMatrix *>(uploadBytes + jointRel);
+        for (FrameBatch &fb : m_frameBatches)
+        {
+            const BatchEntry &e = *fb.entry;
+            const ModelAsset *model = fb.model;
+            const uint32_t renderedNodes = static_cast<uint32_t>(model->renderedNodes.size());
+            const bool nodeGraph = !model->nodes.empty() && model->renderedSlot.size() == model->nodes.size();
+            PaletteMatrix *nodeDst = fb.baked ? static_cast<PaletteMatrix *>(paletteFrame->paletteMapped) + fb.nodeBase
+                                              : ringNodes + (fb.nodeBase - ringNodeBase);
+            PaletteMatrix *jointDst = fb.baked ? static_cast<PaletteMatrix *>(paletteFrame->jointPaletteMapped) + fb.jointBase
+                                               : ringJoints + (fb.jointBase - ringJointBase);
+            const size_t nodeExpected = fb.nodeMatrices;
+            const size_t jointExpected = static_cast<size_t>(fb.poseCount) * fb.jointStride;
+
+            // Baked frames are static: upload once per frame slot.
+            if (fb.baked && bakeResident)
+                continue;
+            fb.uploadBytes += sizeof(PaletteMatrix) * (nodeExpected + jointExpected);
+            if (fb.baked)
+            {
+                if (renderedNodes > 0)
+                    std::memcpy(nodeDst, model->bakedNodeGlobals.data(), sizeof(PaletteMatrix) * nodeExpected);
+                else
+                    nodeDst[0] = PaletteMatrix::identity();
+                if (model->totalJointCount > 0 && model->bakedJoints.size() == jointExpected)
+                    std::memcpy(jointDst, model->bakedJoints.data(), sizeof(PaletteMatrix) * jointExpected);
+                else
+                    std::fill_n(jointDst, jointExpected, PaletteMatrix::identity());
+                continue;
+            }
+
+            // Prefer the explicitly provided palette; otherwise fall back to the model's current node globals.
+            if (e.nodeCount == fb.nodeCount && static_cast<size_t>(e.poseCount) * e.nodeCount == nodeExpected)
+            {
+                std::memcpy(nodeDst, e.nodePalette, sizeof(PaletteMatrix) * nodeExpected);
+            }
+            else
+            {
+                // Minimal fallback palette: replicate the current rendered node globals for each pose.
+                for (uint32_t k = 0; k < fb.nodeCount; ++k)
+                {
+                    const bool valid = nodeGraph && k < renderedNodes && model->renderedNodes[k] < model->nodes.size();
+                    nodeDst[k] = valid ? PaletteMatrix::fromMat4(model->nodes[model->renderedNodes[k]].globalMatrix)
+                                       : PaletteMatrix::identity();
+                }
+                for (size_t i = fb.nodeCount; i < nodeExpected; ++i)
+                    nodeDst[i] = nodeDst[i % fb.nodeCount];
+            }
+
+            if (model->totalJointCount > 0 && e.jointCount == model->totalJointCount &&
+                static_cast<size_t>(e.poseCount) * e.jointCount == jointExpected)
+            {
+                std::memcpy(jointDst, e.jointPalette, sizeof(PaletteMatrix) * jointExpected);
+            }
+            else
+            {
+                // Default to identity matrices. Shader will not use these unless skinJointCount > 0.
+                std::fill_n(jointDst, jointExpected, PaletteMatrix::identity());
+            }
+        }
+        paletteFrame->bakedModels = m_frameBakedModels;
+
+        // Draw list: the resolved draws of every batch's model (buildModelDraws()) at the mesh LODs
+        // it has instances at.
+        uint32_t blendBatches = 0;
+        for (uint32_t b = 0; b < static_cast<uint32_t>(m_frameBatches.size()); ++b)
+        {
+            FrameBatch &fb = m_frameBatches[b];
+            const BatchEntry &e = *fb.entry;
+            ModelAsset *model = fb.model;
+
+            // Mesh LOD instance ranges: the caller's buckets when they cover every instance but the
+            // impostors. Impostors without an atlas draw with the coarsest range, which they follow.
+            const uint32_t meshed = e.instanceCount - e.impostorCount;
+            uint32_t lodTotal = 0;
+            for (uint32_t k = 0; k < ModelAsset::kMaxMeshLods; ++k)
+                lodTotal += e.lodCounts[k];
+            const bool lodBuckets = e.hasLodCounts && model->meshLodCount > 1 && lodTotal == meshed;
+            uint32_t coarsest = lodBuckets ? std::min(model->meshLodCount, ModelAsset::kMaxMeshLods) - 1 : 0u;
+            for (uint32_t k = 0; k < ModelAsset::kMaxMeshLods; ++k)
+            {
+                fb.lodCount[k] = lodBuckets ? e.lodCounts[k] : (k == 0 ? meshed : 0u);
+                if (fb.lodCount[k] > 0)
+                    coarsest = std::max(coarsest, k);
+            }
+            fb.lodCount[coarsest] += e.impostorCount - fb.impostorCount;
+            for (uint32_t k = 0, first = 0; k < ModelAsset::kMaxMeshLods; ++k)
+            {
+                fb.lodFirst[k] = first;
+                first += fb.lodCount[k];
+            }
+
+            // The model's resolved draws, per alpha mode, for the mesh LODs with instances.
+            for (uint32_t pass = 0; pass < 3; ++pass)
+            {
+                for (const ModelDraw &draw : fb.info->draws[pass])
+                {
+                    if (fb.lodCount[draw.lod] > 0)
+                        m_draws.push_back(DrawItem{&draw, b});
+                }
+                if (pass == 2 && !fb.info->draws[2].empty())
+                    ++blendBatches;
+            }
+        }
+
+        // Blended batches are drawn back to front, by the distance of their instances' mean bounds
+        // center; only measured when the frame has blended draws.
+        if (blendBatches > 0)
+        {
+            const glm::vec3 eye = glm::make_vec3(frameCtx.globals->cameraPos);
+            for (FrameBatch &fb : m_frameBatches)
+            {
+                if (fb.info->draws[2].empty())
+                    continue;
+                const BatchEntry &e = *fb.entry;
+                const glm::vec4 center(fb.info->hasSphere ? glm::make_vec3(fb.info->sphere) : glm::vec3(0.0f), 1.0f);
+                glm::vec3 mean(center);
+                if (e.worlds && e.instanceCount > 0)
+                {
+                    glm::vec3 sum(0.0f);
+                    for (uint32_t i = 0; i < e.instanceCount; ++i)
+                        sum += glm::vec3(e.worlds[i] * center);
+                    mean = sum / static_cast<float>(e.instanceCount);
+                }
+                fb.blendDistance = glm::distance(eye, mean);
+            }
+        }
+
+        // One sequence for all batches, like glTF: OPAQUE, MASK, then BLEND. Opaque and masked draws
+        // are keyed by pipeline, material (its descriptor set; not with bindless materials), geometry
+        // arena buffers and palette set (baked or ring) so consecutive draws share binds; blended ones
+        // go farthest batch first, each in submission order.
+        // Indirect commands follow this order.
+        m_packets.clear();
+        m_meshKeys.clear();
+        for (uint32_t d = 0; d < static_cast<uint32_t>(m_draws.size()); ++d)
+        {
+            const DrawItem &item = m_draws[d];
+            const ModelDraw &draw = *item.src;
+            uint64_t key = 0;
+            if (draw.pass == 2)
+            {
+                uint32_t distanceBits = 0;
+                std::memcpy(&distanceBits, &m_frameBatches[item.batch].blendDistance, sizeof(distanceBits));
+                key = DrawPackets::makeOrderedKey(draw.pass, (static_cast<uint64_t>(~distanceBits) << 30) | d);
+            }
+            else
+            {
+                const uint32_t mesh = m_meshKeys.emplace(draw.geometryKey, static_cast<uint32_t>(m_meshKeys.size())).first->second;
+                const uint32_t material = m_bindless ? 0u : draw.materialIndex;
+                key = DrawPackets::makeKey(draw.pass, draw.pass * kShaderVariantCount + draw.variant, material, mesh,
+                                           m_frameBatches[item.batch].baked ? 1u : 0u);
+            }
+            m_packets.push_back(DrawPacket{key, d});
+        }
+        DrawPackets::sort(m_packets, m_packetScratch);
+        m_sortedDraws.resize(m_draws.size());
+        for (size_t i = 0; i < m_packets.size(); ++i)
+            m_sortedDraws[i] = m_draws[m_packets[i].index];
+        m_draws.swap(m_sortedDraws);
+
+        // Instances and uploads are counted once per frame here; draws, triangles and binds as they
+        // are recorded.
+        RenderCounters passStats;
+        for (const FrameBatch &fb : m_frameBatches)
+        {
+            RenderCounters batchStats;
+            batchStats.instances = fb.entry->instanceCount;
+            batchStats.uploadBytes = fb.uploadBytes;
+            passStats += batchStats;
+            RenderStats::addModel(modelKey(fb.entry->model), m_assets->getModelPath(fb.entry->model), batchStats);
+        }
+        RenderStats::addPass(name(), passStats);
+
+        m_prepared.valid = true;
+        m_prepared.frameIndex = frameCtx.frameIndex;
+        m_prepared.paletteFrame = paletteFrame;
+        m_prepared.globalSet = frameCtx.globalSet;
+        m_prepared.ringBuffer = upload.buffer;
+        m_prepared.worldsOffset = upload.offset + worldsRel;
+        m_prepared.worldsBytes = worldsBytes;
+        m_prepared.posesOffset = upload.offset + posesRel;
+        m_prepared.posesBytes = posesBytes;
+        m_prepared.bindlessFrame = bindlessFrame;
+        m_prepared.instanceCount = instanceCount;
+        m_prepared.impostorCount = impostorCount;
+        m_prepared.viewProj = glm::make_mat4(frameCtx.globals->viewProj);
+        return true;
+    }
+
+    void SModelRenderPassModule::requestTextureDetail(const FrameContext &frameCtx)
+    {
+        // Texture streaming: the nearest mesh instance of each batch sets the on-screen size of its
+        // materials (bounding sphere diameter in pixels). Worlds already on the GPU are not known
+        // here; those batches ask for full detail.
+        const GlobalUniforms &g = *frameCtx.globals;
+        const float pixelsPerUnit = std::fabs(g.proj[5]) * 0.5f * static_cast<float>(m_extent.height);
+        const glm::vec3 eye = glm::make_vec3(g.cameraPos);
+        for (const FrameBatch &fb : m_frameBatches)
+        {
+            const BatchEntry &e = *fb.entry;
+            const uint32_t meshInstances = e.instanceCount - fb.impostorCount;
+            if (meshInstances == 0)
+                continue;
+
+            float pixels = std::numeric_limits<float>::max();
+            if (e.worlds && fb.info->hasSphere)
+            {
+                const glm::vec4 center(fb.info->sphere[0], fb.info->sphere[1], fb.info->sphere[2], 1.0f);
+                pixels = 0.0f;
+                for (uint32_t i = 0; i < meshInstances; ++i)
+                {
+                    const glm::mat4 &w = e.worlds[i];
+                    const float scale2 = std::max({glm::dot(glm::vec3(w[0]), glm::vec3(w[0])), glm::dot(glm::vec3(w[1]), glm::vec3(w[1])),
+                                                   glm::dot(glm::vec3(w[2]), glm::vec3(w[2]))});
+                    const float radius = fb.info->sphere[3] * std::sqrt(scale2);
+                    const float distance = std::max(glm::length(glm::vec3(w * center) - eye) - radius, 1e-3f);
+                    pixels = std::max(pixels, 2.0f * radius * pixelsPerUnit / distance);
+                }
+            }
+
+            MaterialHandle last{};
+            for (const auto &prim : fb.model->primitives)
+            {
+                if (prim.material.id == last.id && prim.material.generation == last.generation)
+                    continue;
+                last = prim.material;
+                m_assets->requestTextureDetail(prim.material, pixels);
+            }
+        }
+    }
+
+    uint32_t SModelRenderPassModule::prepareMeshletDraws(uint32_t &outWork, VkBuffer &outVertexBlock)
+    {
+        m_meshletDraws.clear();
+        outWork = 0;
+        outVertexBlock = VK_NULL_HANDLE;
+        if (!m_meshletCulling || (!m_meshShaders && !m_drawIndirectCount))
+            return UINT32_MAX;
+
+        // Full-resolution opaque and masked primitives of static, unskinned models: the rest node
+        // matrix is what they draw with, so it bounds their meshlets.
+        uint32_t block = UINT32_MAX;
+        for (DrawItem &item : m_draws)
+        {
+            const ModelDraw &draw = *item.src;
+            const FrameBatch &fb = m_frameBatches[item.batch];
+            const ModelAsset *model = fb.model;
+            const ModelPrimitive &prim = *draw.prim;
+            if (draw.lod != 0 || draw.pass == 2 || prim.meshletCount == 0 || prim.skinIndex >= 0 || fb.baked ||
+                !model->animClips.empty() || model->meshletBlock == UINT32_MAX)
+                continue;
+            if (block != UINT32_MAX && model->meshletBlock != block)
+                continue;
+
+            const uint32_t instances = fb.lodCount[0];
+            const uint64_t work = static_cast<uint64_t>(instances) * prim.meshletCount;
+            if (m_meshShaders)
+            {
+                // Task group counts: (meshlet groups, visible instances, 1)
+                const uint32_t groups = (prim.meshletCount + kTaskMeshlets - 1) / kTaskMeshlets;
+                if (instances > 0xFFFFu || groups > 0xFFFFu || static_cast<uint64_t>(groups) * instances > kMaxTaskGroups)
+                    continue;
+                if (outVertexBlock != VK_NULL_HANDLE && draw.mesh->getVertexBuffer() != outVertexBlock)
+                    continue;
+                outVertexBlock = draw.mesh->getVertexBuffer();
+            }
+            else if (outWork + work > kMaxMeshletWork)
+            {
+                continue;
+            }
+            block = model->meshletBlock;
+
+            glm::mat4 node(1.0f);
+            const bool nodeGraph = !model->nodes.empty() && model->renderedSlot.size() == model->nodes.size();
+            if (nodeGraph && draw.nodeSlot < model->renderedNodes.size() && model->renderedNodes[draw.nodeSlot] < model->nodes.size())
+                node = model->nodes[model->renderedNodes[draw.nodeSlot]].globalMatrix;
+            const glm::mat4 m = glm::make_mat4(fb.info->model) * node;
+
+            MeshletDrawGpu g{};
+            for (uint32_t r = 0; r < 3; ++r)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                    g.rows[r][c] = m[c][r];
+            }
+            g.firstMeshlet = prim.firstMeshlet;
+            g.meshletCount = prim.meshletCount;
+            g.instanceFirst = fb.instanceFirst + fb.lodFirst[0];
+            g.bucket = item.batch * ModelAsset::kMaxMeshLods;
+            g.workFirst = outWork;
+            g.commandFirst = outWork;
+            g.firstIndex = prim.firstIndex;
+            g.vertexOffset = prim.vertexOffset;
+            g.coneCulling = draw.mat->doubleSided ? 0u : 1u;
+            if (!m_meshShaders)
+                outWork += static_cast<uint32_t>(work);
+
+            item.meshletDraw = static_cast<uint32_t>(m_meshletDraws.size());
+            m_meshletDraws.push_back(g);
+        }
+        return block;
+    }
+
+    void SModelRenderPassModule::readCullStats(CullFrame &frame)
+    {
+        // Per draw: its bucket's visible instances times its triangles, for every time it was drawn.
+        // Meshlet culling is not seen here: those draws count their whole primitive.
+        // (Statistics only: the host reads the counts without a barrier to the host domain.)
+        if (frame.statsDraws.empty() || !frame.indirectMapped)
+            return;
+        const uint32_t *bucketCounts = static_cast<const uint32_t *>(frame.indirectMapped);
+        m_statsScratch.reset();
+        ArenaVector<uint64_t> visible(frame.statsModels.size(), 0, ArenaAllocator<uint64_t>(&m_statsScratch));
+        RenderCounters passStats;
+        for (const CullFrame::StatsDraw &d : frame.statsDraws)
+        {
+            if (d.recorded == 0 || d.batch >= visible.size())
+                continue;
+            const uint64_t triangles = static_cast<uint64_t>(bucketCounts[d.bucket]) * d.triangles * d.recorded;
+            visible[d.batch] += triangles;
+            passStats.visibleTriangles += triangles;
+        }
+        frame.statsDraws.clear();
+        if (passStats.visibleTriangles == 0)
+            return;
+
+        RenderStats::addPass(name(), passStats);
+        for (size_t b = 0; b < visible.size(); ++b)
+        {
+            if (visible[b] == 0)
+                continue;
+            RenderCounters batchStats;
+            batchStats.visibleTriangles = visible[b];
+            const ModelHandle h = frame.statsModels[b];
+            RenderStats::addModel(modelKey(h), m_assets ? m_assets->getModelPath(h) : std::string(), batchStats);
+        }
+    }
+
+    void SModelRenderPassModule::recordCompute(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        m_prepared.valid = false;
+        if (!m_enabled || !m_gpuCulling || !m_cullAvailable || m_cullFrames.empty())
+            return;
+        if (!prepareFrame(frameCtx) || m_draws.empty())
+            return;
+
+        // One external world buffer at most, and the shader indexes whole matrices, so every external
+        // range must start on one.
+        VkBuffer external = VK_NULL_HANDLE;
+        for (const FrameBatch &fb : m_frameBatches)
+        {
+            const BatchEntry &e = *fb.entry;
+            if (e.instanceSource == VK_NULL_HANDLE)
+                continue;
+            if ((e.instanceSourceOffset % sizeof(glm::mat4)) != 0 || (external != VK_NULL_HANDLE && external != e.instanceSource))
+                return;
+            external = e.instanceSource;
+        }
+
+        CullFrame &cf = m_cullFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_cullFrames.size())];
+        readCullStats(cf);
+        const uint32_t batchCount = static_cast<uint32_t>(m_frameBatches.size());
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+        uint32_t meshletWork = 0;
+        VkBuffer vertexBlock = VK_NULL_HANDLE;
+        const uint32_t meshletBlock = prepareMeshletDraws(meshletWork, vertexBlock);
+        const uint32_t meshletDrawCount = static_cast<uint32_t>(m_meshletDraws.size());
+        if (!ensureCullCapacity(cf, m_prepared.instanceCount, drawCount, batchCount, meshletDrawCount, meshletWork))
+            return;
+
+        // Batch table: bounds, instance range, world source and mesh LOD ranges.
+        CullBatchGpu *gpuBatches = static_cast<CullBatchGpu *>(cf.batchMapped);
+        for (uint32_t b = 0; b < batchCount; ++b)
+        {
+            const FrameBatch &fb = m_frameBatches[b];
+            const BatchEntry &e = *fb.entry;
+            CullBatchGpu g{};
+            std::memcpy(g.sphere, fb.info->sphere, sizeof(g.sphere));
+            if (!fb.info->hasSphere)
+                g.sphere[3] = -1.0f;
+            g.instanceFirst = fb.instanceFirst;
+            g.instanceCount = e.instanceCount - fb.impostorCount; // impostors are drawn as they are
+            g.worldSource = (e.instanceSource != VK_NULL_HANDLE) ? 1u : 0u;
+            g.worldFirst = g.worldSource ? static_cast<uint32_t>(e.instanceSourceOffset / sizeof(glm::mat4)) : fb.worldFirst;
+            for (uint32_t k = 0; k < ModelAsset::kMaxMeshLods; ++k)
+                g.lodEnd[k] = fb.instanceFirst + fb.lodFirst[k] + fb.lodCount[k];
+            gpuBatches[b] = g;
+        }
+
+        // Visible count (0) of every (batch, mesh LOD) bucket, then commands with instanceCount 0;
+        // the COMMANDS pass copies their bucket's visible count in. firstInstance stays 0
+        // (drawIndirectFirstInstance is optional): record() binds each bucket's range instead.
+        uint32_t *bucketCounts = static_cast<uint32_t *>(cf.indirectMapped);
+        std::fill_n(bucketCounts, batchCount * ModelAsset::kMaxMeshLods, 0u);
+        VkDrawIndexedIndirectCommand *cmds = reinterpret_cast<VkDrawIndexedIndirectCommand *>(bucketCounts + batchCount * ModelAsset::kMaxMeshLods);
+        uint32_t *drawBuckets = reinterpret_cast<uint32_t *>(cmds + drawCount);
+        cf.statsDraws.resize(drawCount);
+        cf.statsModels.resize(batchCount);
+        for (uint32_t b = 0; b < batchCount; ++b)
+            cf.statsModels[b] = m_frameBatches[b].entry->model;
+        for (uint32_t d = 0; d < drawCount; ++d)
+        {
+            const ModelPrimitive &prim = *m_draws[d].src->prim;
+            cmds[d].indexCount = prim.indexCount;
+            cmds[d].instanceCount = 0;
+            cmds[d].firstIndex = prim.firstIndex;
+            cmds[d].vertexOffset = prim.vertexOffset;
+            cmds[d].firstInstance = 0;
+            drawBuckets[d] = m_draws[d].batch * ModelAsset::kMaxMeshLods + m_draws[d].src->lod;
+            cf.statsDraws[d] = CullFrame::StatsDraw{m_draws[d].batch, drawBuckets[d], prim.indexCount / 3, 0};
+        }
+
+        // Meshlet draws: their table, and the command count (0) of each after the draw buckets. Mesh
+        // shader draws take their task counts from their command instead, (groups, visible, 1) once
+        // the COMMANDS pass wrote the visible count.
+        const uint32_t countWordFirst = static_cast<uint32_t>(drawBuckets + drawCount - bucketCounts);
+        std::fill_n(drawBuckets + drawCount, meshletDrawCount, 0u);
+        MeshletFrameGpu meshletFrame{};
+        std::memcpy(meshletFrame.viewProj, glm::value_ptr(m_prepared.viewProj), sizeof(meshletFrame.viewProj));
+        frustumPlanes(m_prepared.viewProj, meshletFrame.planes);
+        std::memcpy(meshletFrame.cameraPos, frameCtx.globals->cameraPos, sizeof(meshletFrame.cameraPos));
+        meshletFrame.drawCount = meshletDrawCount;
+        meshletFrame.workCount = meshletWork;
+        meshletFrame.countWordFirst = countWordFirst;
+        std::memcpy(cf.meshletDrawMapped, &meshletFrame, sizeof(meshletFrame));
+        if (meshletDrawCount > 0)
+            std::memcpy(static_cast<uint8_t *>(cf.meshletDrawMapped) + sizeof(MeshletFrameGpu), m_meshletDraws.data(),
+                        sizeof(MeshletDrawGpu) * meshletDrawCount);
+        if (m_meshShaders)
+        {
+            for (uint32_t d = 0; d < drawCount; ++d)
+            {
+                if (m_draws[d].meshletDraw == UINT32_MAX)
+                    continue;
+                cmds[d].indexCount = (m_draws[d].src->prim->meshletCount + kTaskMeshlets - 1) / kTaskMeshlets;
+                cmds[d].firstIndex = 1;
+                cmds[d].vertexOffset = 0;
+            }
+        }
+
+        // Inputs change every frame (the worlds and poses move in the upload ring, another external buffer).
+        // Without meshlet draws, bindings 9 and 12 get stand-ins.
+        constexpr uint32_t kBindingCount = 13;
+        const GeometryArena &arena = m_assets->getGeometryArena();
+        VkDescriptorBufferInfo infos[kBindingCount]{};
+        infos[0].buffer = m_prepared.ringBuffer;
+        infos[1].buffer = m_prepared.ringBuffer;
+        infos[2].buffer = cf.visibleBuffer;
+        infos[3].buffer = cf.visiblePoseBuffer;
+        infos[4].buffer = cf.indirectBuffer;
+        infos[5].buffer = cf.batchBuffer;
+        infos[6].buffer = (external != VK_NULL_HANDLE) ? external : m_prepared.ringBuffer;
+        infos[9].buffer = (meshletBlock != UINT32_MAX) ? arena.getBuffer(GeometryArena::Meshlet, meshletBlock) : cf.meshletDrawBuffer;
+        infos[10].buffer = cf.meshletDrawBuffer;
+        infos[11].buffer = cf.meshletCommandBuffer;
+        infos[12].buffer = (vertexBlock != VK_NULL_HANDLE) ? vertexBlock : cf.meshletDrawBuffer;
+        VkWriteDescriptorSet writes[kBindingCount]{};
+        uint32_t writeCount = 0;
+        for (uint32_t b = 0; b < kBindingCount; ++b)
+        {
+            if (infos[b].buffer == VK_NULL_HANDLE)
+                continue; // 7 and 8 below
+            infos[b].offset = 0;
+            infos[b].range = VK_WHOLE_SIZE;
+            if (b == 0)
+            {
+                infos[b].offset = m_prepared.worldsOffset;
+                infos[b].range = m_prepared.worldsBytes;
+            }
+            else if (b == 1)
+            {
+                infos[b].offset = m_prepared.posesOffset;
+                infos[b].range = m_prepared.posesBytes;
+            }
+            VkWriteDescriptorSet &w = writes[writeCount++];
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = cf.set;
+            w.dstBinding = b;
+            w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            w.descriptorCount = 1;
+            w.pBufferInfo = &infos[b];
+        }
+        vkUpdateDescriptorSets(m_device, writeCount, writes, 0, nullptr);
+
+        // Occlusion: only against a pyramid that holds this pass's own last pre-pass (the pyramid
+        // starts empty and is rebuilt with the swapchain); the fallback texture keeps binding 7 valid.
+        const HiZPyramid *hiZ = frameCtx.hiZ;
+        const bool occlusion = m_occlusionCulling && hiZ && m_hiZBuild != 0 && hiZ->getBuildCount() == m_hiZBuild;
+        UploadRing::Allocation occAlloc = frameCtx.uploadRing->allocateStorage(sizeof(OcclusionGpu));
+        if (!occAlloc.isValid())
+            return;
+        OcclusionGpu occ{};
+        if (occlusion)
+        {
+            std::memcpy(occ.viewProj, glm::value_ptr(m_hiZViewProj), sizeof(occ.viewProj));
+            occ.enabled = 1u;
+            occ.mipCount = hiZ->getMipCount();
+            occ.depthWidth = hiZ->getDepthExtent().width;
+            occ.depthHeight = hiZ->getDepthExtent().height;
+        }
+        std::memcpy(occAlloc.mapped, &occ, sizeof(occ));
+
+        VkDescriptorImageInfo hiZInfo{};
+        hiZInfo.sampler = occlusion ? hiZ->getSampler() : m_fallbackWhiteTexture.getSampler();
+        hiZInfo.imageView = occlusion ? hiZ->getView() : m_fallbackWhiteTexture.getView();
+        hiZInfo.imageLayout = occlusion ? hiZ->getLayout() : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkDescriptorBufferInfo occInfo{occAlloc.buffer, occAlloc.offset, sizeof(OcclusionGpu)};
+        VkWriteDescriptorSet occWrites[2]{};
+        occWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        occWrites[0].dstSet = cf.set;
+        occWrites[0].dstBinding = 7;
+        occWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        occWrites[0].descriptorCount = 1;
+        occWrites[0].pImageInfo = &hiZInfo;
+        occWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        occWrites[1].dstSet = cf.set;
+        occWrites[1].dstBinding = 8;
+        occWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        occWrites[1].descriptorCount = 1;
+        occWrites[1].pBufferInfo = &occInfo;
+        vkUpdateDescriptorSets(m_device, 2, occWrites, 0, nullptr);
+
+        PushConstantsCull pc{};
+        frustumPlanes(m_prepared.viewProj, pc.planes);
+        pc.instanceCount = m_prepared.instanceCount;
+        pc.batchCount = batchCount;
+        pc.drawCount = drawCount;
+        pc.poseWordBase = 0; // binding 1 starts at the poses
+
+        // Instance sources, the pyramid and the draws' reads of the output are ordered by the render
+        // graph (declareCompute(), declareDraws()); the barrier here is between the two dispatches.
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0, 1, &cf.set, 0, nullptr);
+        vkCmdPushConstants(cmd, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantsCull), &pc);
+
+        // One dispatch over the instances of every batch.
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelines[0]);
+        vkCmdDispatch(cmd, (pc.instanceCount + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelines[1]);
+        vkCmdDispatch(cmd, (drawCount + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+
+        // Writes words COMMANDS does not touch, so no barrier between the two.
+        if (meshletWork > 0)
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelines[2]);
+            vkCmdDispatch(cmd, (meshletWork + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+        }
+
+        m_prepared.cullFrame = &cf;
+        m_prepared.meshletCountOffset = static_cast<VkDeviceSize>(countWordFirst) * sizeof(uint32_t);
+    }
+
+    bool SModelRenderPassModule::cullingPossible() const
+    {
+        return m_enabled && m_gpuCulling && m_cullAvailable && !m_cullFrames.empty() && !m_batches.empty();
+    }
+
+    void SModelRenderPassModule::declareCompute(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx)
+    {
+        using Access = RenderGraph::Access;
+        if (!cullingPossible())
+            return;
+
+        for (const BatchEntry &e : m_batches)
+        {
+            if (e.instanceSource != VK_NULL_HANDLE)
+                pass.read(graph.importBuffer("smodel instances", e.instanceSource), Access::ComputeRead);
+        }
+        if (m_occlusionCulling && frameCtx.hiZ)
+        {
+            const HiZPyramid &hiZ = *frameCtx.hiZ;
+            pass.read(graph.importImage("hi-z", hiZ.getImage(), hiZ.getView(), VK_IMAGE_ASPECT_COLOR_BIT, hiZ.getMipCount()),
+                      Access::ComputeRead);
+        }
+
+        // Buffers grown by recordCompute() are new and have nothing to wait for; the graph batches
+        // buffer hazards into global barriers, so the handles declared here stand for them.
+        const CullFrame &cf = m_cullFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_cullFrames.size())];
+        pass.write(graph.importBuffer("smodel visible", cf.visibleBuffer), Access::ComputeWrite);
+        pass.write(graph.importBuffer("smodel visible poses", cf.visiblePoseBuffer), Access::ComputeWrite);
+        pass.write(graph.importBuffer("smodel indirect", cf.indirectBuffer), Access::ComputeReadWrite);
+        pass.write(graph.importBuffer("smodel meshlet commands", cf.meshletCommandBuffer), Access::ComputeWrite);
+    }
+
+    void SModelRenderPassModule::declareDraws(RenderGraph &graph, RenderGraph::PassBuilder &pass, FrameContext &frameCtx)
+    {
+        using Access = RenderGraph::Access;
+        if (!m_enabled)
+            return;
+
+        // Direct draws read external worlds as instance attributes; culled draws the compacted output.
+        for (const BatchEntry &e : m_batches)
+        {
+            if (e.instanceSource != VK_NULL_HANDLE)
+                pass.read(graph.importBuffer("smodel instances", e.instanceSource), Access::VertexRead);
+        }
+        if (cullingPossible())
+        {
+            const CullFrame &cf = m_cullFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_cullFrames.size())];
+            pass.read(graph.importBuffer("smodel visible", cf.visibleBuffer), Access::VertexRead);
+            pass.read(graph.importBuffer("smodel visible poses", cf.visiblePoseBuffer), Access::VertexRead);
+            pass.read(graph.importBuffer("smodel indirect", cf.indirectBuffer), Access::IndirectRead);
+            pass.read(graph.importBuffer("smodel meshlet commands", cf.meshletCommandBuffer), Access::IndirectRead);
+            if (m_meshShaders)
+            {
+                pass.read(graph.importBuffer("smodel visible", cf.visibleBuffer), Access::MeshShaderRead);
+                pass.read(graph.importBuffer("smodel visible poses", cf.visiblePoseBuffer), Access::MeshShaderRead);
+            }
+        }
+    }
+
+    void SModelRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (prepareRecord(frameCtx, 1) > 0)
+            recordSlice(frameCtx, cmd, 0, 1);
+    }
+
+    uint32_t SModelRenderPassModule::prepareRecord(FrameContext &frameCtx, uint32_t maxSlices)
+    {
+        if (!m_enabled)
+        {
+            m_prepared.valid = false;
+            return 0;
+        }
+        if (!m_prepared.valid || m_prepared.frameIndex != frameCtx.frameIndex)
+        {
+            if (!prepareFrame(frameCtx))
+                return 0;
+        }
+        m_recording = m_prepared;
+        m_prepared.valid = false;
+        if (m_draws.empty() && m_recording.impostorCount == 0)
+            return 0;
+
+        // Material sets are created on first use: resolve them here so the slices only read.
+        m_drawMaterialSets.assign(m_draws.size(), VK_NULL_HANDLE);
+        if (!m_recording.bindlessFrame)
+        {
+            for (size_t d = 0; d < m_draws.size(); ++d)
+                m_drawMaterialSets[d] = getOrCreateMaterialSet(m_draws[d].src->prim->material, m_draws[d].src->mat);
+        }
+
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+        const uint32_t slices = (drawCount + kDrawsPerSlice - 1) / kDrawsPerSlice;
+        return std::max(1u, std::min(slices, maxSlices));
+    }
+
+    void SModelRenderPassModule::recordDepthPrepass(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (!m_enabled || m_pipelineDepth[0].getVkPipeline() == VK_NULL_HANDLE)
+            return;
+        // Without GPU culling the frame is prepared here; prepareRecord() keeps it.
+        if (!m_prepared.valid || m_prepared.frameIndex != frameCtx.frameIndex)
+        {
+            if (!prepareFrame(frameCtx))
+                return;
+        }
+        if (!m_draws.empty())
+            recordDraws(m_prepared, cmd, 0, static_cast<uint32_t>(m_draws.size()), true);
+
+        // The Renderer builds the pyramid from this depth next; the next frame's culling tests with it.
+        if (frameCtx.hiZ)
+        {
+            m_hiZBuild = frameCtx.hiZ->getBuildCount() + 1;
+            m_hiZViewProj = m_prepared.viewProj;
+        }
+    }
+
+    void SModelRenderPassModule::recordSlice(FrameContext &frameCtx, VkCommandBuffer cmd, uint32_t slice, uint32_t sliceCount)
+    {
+        (void)frameCtx;
+        const uint64_t drawCount = m_draws.size();
+        const uint32_t drawBegin = static_cast<uint32_t>(drawCount * slice / sliceCount);
+        const uint32_t drawEnd = static_cast<uint32_t>(drawCount * (slice + 1) / sliceCount);
+        if (drawBegin < drawEnd)
+            recordDraws(m_recording, cmd, drawBegin, drawEnd, false);
+        if (slice + 1 == sliceCount && m_recording.impostorCount > 0)
+            recordImpostors(m_recording, cmd);
+    }
+
+    void SModelRenderPassModule::recordDraws(const PreparedFrame &frame, VkCommandBuffer cmd, uint32_t drawBegin, uint32_t drawEnd, bool depthOnly)
+    {
+        VkViewport vp{0.0f, 0.0f, static_cast<float>(m_extent.width), static_cast<float>(m_extent.height), 0.0f, 1.0f};
+        VkRect2D sc{{0, 0}, {m_extent.width, m_extent.height}};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        PaletteFrame *paletteFrame = frame.paletteFrame;
+        CullFrame *cullFrame = frame.cullFrame;
+        const VkDeviceSize cmdBase = static_cast<VkDeviceSize>(m_frameBatches.size()) * ModelAsset::kMaxMeshLods * sizeof(uint32_t);
+
+        // Only what changes is rebound (DrawStateCache). The pipelines share one layout, so every set
+        // stays bound across pipeline switches: the global set is bound once, and so is the bindless
+        // material set. Set 1 switches between the ring and baked palettes (grouped by the sort).
+        // The depth pipeline reads sets 0 and 1 only; the mesh shader pipelines also set 3.
+        BindlessFrame *bindlessFrame = frame.bindlessFrame;
+        DrawStateCache state(cmd);
+        const VkPipelineBindPoint graphics = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        state.bindDescriptorSet(graphics, m_pipelineLayout, 0, frame.globalSet);
+        if (bindlessFrame && !depthOnly)
+            state.bindDescriptorSet(graphics, m_pipelineLayout, 2, bindlessFrame->set);
+
+        // RenderStats per batch: draws, triangles (visible ones now unless the GPU culls them) and
+        // the binds each draw issued. The sets bound above go to the pass only.
+        std::vector<RenderCounters> batchStats(m_frameBatches.size());
+        auto countDraw = [&](uint32_t d, const uint32_t (&bindsBefore)[3])
+        {
+            const DrawItem &item = m_draws[d];
+            RenderCounters &s = batchStats[item.batch];
+            const uint64_t triangles = static_cast<uint64_t>(item.src->prim->indexCount / 3) *
+                                       m_frameBatches[item.batch].lodCount[item.src->lod];
+            ++s.drawCalls;
+            s.triangles += triangles;
+            if (!cullFrame)
+                s.visibleTriangles += triangles;
+            else if (d < cullFrame->statsDraws.size())
+                ++cullFrame->statsDraws[d].recorded;
+            s.pipelineBinds += state.pipelineBinds() - bindsBefore[0];
+            s.descriptorBinds += state.descriptorBinds() - bindsBefore[1];
+            s.bufferBinds += state.bufferBinds() - bindsBefore[2];
+        };
+
+        for (uint32_t d = drawBegin; d < drawEnd; ++d)
+        {
+            const DrawItem &item = m_draws[d];
+            const ModelDraw &draw = *item.src;
+            if (depthOnly && draw.pass != 0)
+                continue;
+            const ModelPrimitive &prim = *draw.prim;
+            const FrameBatch &fb = m_frameBatches[item.batch];
+            const uint32_t bindsBefore[3] = {state.pipelineBinds(), state.descriptorBinds(), state.bufferBinds()};
+
+            // Meshlet draws (only culled frames have them): smodel.task/smodel.mesh, or the compute path's
+            // commands with the usual pipelines.
+            const bool meshlets = cullFrame && item.meshletDraw != UINT32_MAX;
+            const bool meshShader = meshlets && m_meshShaders;
+            const Pipeline *pipelines = depthOnly ? m_pipelineDepth : (draw.pass == 0) ? m_pipelineOpaque : (draw.pass == 1) ? m_pipelineMask : m_pipelineBlend;
+            if (meshShader)
+                pipelines = depthOnly ? m_meshPipelineDepth : (draw.pass == 0) ? m_meshPipelineOpaque : m_meshPipelineMask;
+            const Pipeline &pipeline = pipelines[meshShader ? (draw.variant & 1u) : draw.variant]; // meshlet draws are unskinned
+            state.bindPipeline(graphics, pipeline.getVkPipeline());
+            state.bindDescriptorSet(graphics, m_pipelineLayout, 1, fb.baked ? paletteFrame->bakedSet : paletteFrame->set);
+            if (meshShader)
+                state.bindDescriptorSet(graphics, m_pipelineLayout, 3, cullFrame->set);
+
+            if (!bindlessFrame && !depthOnly)
+            {
+                VkDescriptorSet matSet = m_drawMaterialSets[d];
+                if (matSet != VK_NULL_HANDLE)
+                    state.bindDescriptorSet(graphics, m_pipelineLayout, 2, matSet);
+            }
+
+            // The draw's push constants with the batch's palette bases and strides; the vertex shader
+            // fetches the node matrix from the palette.
+            PushConstantsModel pc = draw.pc;
+            pc.nodeCount = fb.nodeCount;
+            pc.nodeBase = fb.nodeBase;
+            pc.jointPaletteStride = fb.jointStride;
+            pc.jointBase = fb.jointBase;
+            if (meshShader)
+                pc.skinBaseJoint = item.meshletDraw; // unskinned; smodel.mesh reads it as its MeshletDraw
+            state.pushConstants(m_pipelineLayout, m_pushStages, sizeof(PushConstantsModel), &pc);
+
+#if defined(VK_EXT_mesh_shader)
+            if (meshShader)
+            {
+                // Task counts (meshlet groups, visible instances, 1) in the draw's command slot.
+                const VkDeviceSize cmdOffset = cmdBase + static_cast<VkDeviceSize>(d) * sizeof(VkDrawIndexedIndirectCommand);
+                m_cmdDrawMeshTasksIndirect(cmd, cullFrame->indirectBuffer, cmdOffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+                countDraw(d, bindsBefore);
+                continue;
+            }
+#endif
+
+            state.bindVertexBuffer(0, draw.mesh->getVertexBuffer(), 0);
+            state.bindIndexBuffer(draw.mesh->getIndexBuffer(), 0, draw.mesh->getIndexType());
+
+            // Instance data of the draw's (batch, mesh LOD) bucket: the compacted visible instances
+            // written by recordCompute(), else the batch's worlds and poses. Meshlet commands carry the
+            // visible slot in firstInstance, so they read the buffers from the start.
+            const uint32_t lodFirst = fb.lodFirst[draw.lod];
+            const VkDeviceSize first = meshlets ? 0 : static_cast<VkDeviceSize>(fb.instanceFirst) + lodFirst;
+            if (cullFrame)
+            {
+                state.bindVertexBuffer(1, cullFrame->visibleBuffer, first * sizeof(glm::mat4));
+                state.bindVertexBuffer(2, cullFrame->visiblePoseBuffer, first * sizeof(InstancePose));
+            }
+            else
+            {
+                state.bindVertexBuffer(1, fb.worldBuffer, fb.worldOffset + static_cast<VkDeviceSize>(lodFirst) * sizeof(glm::mat4));
+                state.bindVertexBuffer(2, frame.ringBuffer, frame.posesOffset + first * sizeof(InstancePose));
+            }
+
+            if (meshlets)
+            {
+                // One single-instance command per surviving (instance, meshlet), counted by the GPU.
+                const MeshletDrawGpu &md = m_meshletDraws[item.meshletDraw];
+                m_cmdDrawIndexedIndirectCount(cmd, cullFrame->meshletCommandBuffer,
+                                              static_cast<VkDeviceSize>(md.commandFirst) * sizeof(VkDrawIndexedIndirectCommand),
+                                              cullFrame->indirectBuffer, frame.meshletCountOffset + static_cast<VkDeviceSize>(item.meshletDraw) * sizeof(uint32_t),
+                                              fb.lodCount[0] * md.meshletCount, sizeof(VkDrawIndexedIndirectCommand));
+            }
+            else if (cullFrame)
+            {
+                const VkDeviceSize cmdOffset = cmdBase + static_cast<VkDeviceSize>(d) * sizeof(VkDrawIndexedIndirectCommand);
+                vkCmdDrawIndexedIndirect(cmd, cullFrame->indirectBuffer, cmdOffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+            }
+            else
+            {
+                vkCmdDrawIndexed(cmd, prim.indexCount, fb.lodCount[draw.lod], prim.firstIndex, prim.vertexOffset, 0);
+            }
+            countDraw(d, bindsBefore);
         }
 
-        if (m_cameraSetLayout != VK_NULL_HANDLE)
+        RenderCounters passStats;
+        for (size_t b = 0; b < batchStats.size(); ++b)
         {
-            vkDestroyDescriptorSetLayout(m_device, m_cameraSetLayout, nullptr);
-            m_cameraSetLayout = VK_NULL_HANDLE;
+            if (batchStats[b].drawCalls == 0)
+                continue;
+            passStats += batchStats[b];
+            const ModelHandle h = m_frameBatches[b].entry->model;
+            RenderStats::addModel(modelKey(h), m_assets->getModelPath(h), batchStats[b]);
+        }
+        passStats.pipelineBinds = state.pipelineBinds();
+        passStats.descriptorBinds = state.descriptorBinds();
+        passStats.bufferBinds = state.bufferBinds();
+        RenderStats::addPass(name(), passStats);
+    }
+
+    void SModelRenderPassModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
+    {
+        (void)ctx;
+        m_extent = newExtent;
+    }
+
+    void SModelRenderPassModule::destroyResources()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        destroyImpostorResources();
+        destroyCullResources();
+        destroyPaletteResources();
+        destroyBindlessResources();
+        destroyMaterialResources();
+
+        for (uint32_t variant = 0; variant < kShaderVariantCount; ++variant)
+        {
+            m_pipelineOpaque[variant].destroy(m_device);
+            m_pipelineMask[variant].destroy(m_device);
+            m_pipelineBlend[variant].destroy(m_device);
+            m_pipelineDepth[variant].destroy(m_device);
+        }
+        for (uint32_t format = 0; format < kVertexFormatCount; ++format)
+        {
+            m_meshPipelineOpaque[format].destroy(m_device);
+            m_meshPipelineMask[format].destroy(m_device);
+            m_meshPipelineDepth[format].destroy(m_device);
+        }
+
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+            m_pipelineLayout = VK_NULL_HANDLE;
         }
     }
 
@@ -0,0 +1,669 @@
+#include "utils/SimdKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ENGINE_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ENGINE_TARGET_AVX2
+#else
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define ENGINE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Engine::Simd
+{
+    namespace
+    {
+        constexpr float kMinDist = 1e-6f;
+
+        // ---------------- Scalar ----------------
+
+        bool axpyScalar(float *dst, const float *src, uint32_t n, float scale)
+        {
+            bool any = false;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                dst[i] += src[i] * scale;
+                any |= (src[i] != 0.0f);
+            }
+            return any;
+        }
+
+        void steerScalar(const float *dx, const float *dz, const float *maxSpeed, uint32_t n,
+                         float arrivalRadius, float dt, float *outDist, float *outVx, float *outVz)
+        {
+            const bool clampStep = dt > kMinDist;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const float dist = std::sqrt(dx[i] * dx[i] + dz[i] * dz[i]);
+                float speed = maxSpeed[i];
+                if (clampStep)
+                    speed = std::min(speed, std::max(0.0f, dist - arrivalRadius) / dt);
+                const bool far = dist > kMinDist;
+                const float safe = far ? dist : 1.0f;
+                outDist[i] = dist;
+                outVx[i] = far ? (dx[i] / safe) * speed : 0.0f;
+                outVz[i] = far ? (dz[i] / safe) * speed : 0.0f;
+            }
+        }
+
+        void nlerpQuatScalar(float *soa, uint32_t stride, uint32_t n)
+        {
+            float *ax = soa, *ay = soa + stride, *az = soa + 2 * stride, *aw = soa + 3 * stride;
+            const float *bx = soa + 4 * stride, *by = soa + 5 * stride, *bz = soa + 6 * stride, *bw = soa + 7 * stride;
+            const float *t = soa + 8 * stride;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const float d = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+                const bool flip = d < 0.0f;
+                const float x = ax[i] + ((flip ? -bx[i] : bx[i]) - ax[i]) * t[i];
+                const float y = ay[i] + ((flip ? -by[i] : by[i]) - ay[i]) * t[i];
+                const float z = az[i] + ((flip ? -bz[i] : bz[i]) - az[i]) * t[i];
+                const float w = aw[i] + ((flip ? -bw[i] : bw[i]) - aw[i]) * t[i];
+                const float len2 = x * x + y * y + z * z + w * w;
+                const bool valid = len2 > 0.0f;
+                const float inv = 1.0f / std::sqrt(valid ? len2 : 1.0f);
+                ax[i] = valid ? x * inv : 0.0f;
+                ay[i] = valid ? y * inv : 0.0f;
+                az[i] = valid ? z * inv : 0.0f;
+                aw[i] = valid ? w * inv : 1.0f;
+            }
+        }
+
+        void composeTRSScalar(const float *soa, uint32_t stride, uint32_t n, float *outMat4)
+        {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const float *p = soa + i;
+                float x = p[3 * stride], y = p[4 * stride], z = p[5 * stride], w = p[6 * stride];
+                const float len2 = x * x + y * y + z * z + w * w;
+                const bool valid = len2 > 0.0f;
+                const float inv = 1.0f / std::sqrt(valid ? len2 : 1.0f);
+                x = valid ? x * inv : 0.0f;
+                y = valid ? y * inv : 0.0f;
+                z = valid ? z * inv : 0.0f;
+                w = valid ? w * inv : 1.0f;
+
+                const float xx = x * x, yy = y * y, zz = z * z;
+                const float xy = x * y, xz = x * z, yz = y * z;
+                const float wx = w * x, wy = w * y, wz = w * z;
+                const float sx = p[7 * stride], sy = p[8 * stride], sz = p[9 * stride];
+
+                float *m = outMat4 + static_cast<size_t>(i) * 16;
+                m[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+                m[1] = (2.0f * (xy + wz)) * sx;
+                m[2] = (2.0f * (xz - wy)) * sx;
+                m[3] = 0.0f;
+                m[4] = (2.0f * (xy - wz)) * sy;
+                m[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+                m[6] = (2.0f * (yz + wx)) * sy;
+                m[7] = 0.0f;
+                m[8] = (2.0f * (xz + wy)) * sz;
+                m[9] = (2.0f * (yz - wx)) * sz;
+                m[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+                m[11] = 0.0f;
+                m[12] = p[0];
+                m[13] = p[stride];
+                m[14] = p[2 * stride];
+                m[15] = 1.0f;
+            }
+        }
+
+#if ENGINE_SIMD_X86
+        // ---------------- SSE2 ----------------
+
+        bool axpySSE2(float *dst, const float *src, uint32_t n, float scale)
+        {
+            const __m128 s = _mm_set1_ps(scale);
+            __m128 nz = _mm_setzero_ps();
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const __m128 v = _mm_loadu_ps(src + i);
+                _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(v, s)));
+                nz = _mm_or_ps(nz, _mm_cmpneq_ps(v, _mm_setzero_ps()));
+            }
+            const bool any = _mm_movemask_ps(nz) != 0;
+            return axpyScalar(dst + i, src + i, n - i, scale) || any;
+        }
+
+        void steerSSE2(const float *dx, const float *dz, const float *maxSpeed, uint32_t n,
+                       float arrivalRadius, float dt, float *outDist, float *outVx, float *outVz)
+        {
+            const bool clampStep = dt > kMinDist;
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 minDist = _mm_set1_ps(kMinDist);
+            const __m128 radius = _mm_set1_ps(arrivalRadius);
+            const __m128 vdt = _mm_set1_ps(clampStep ? dt : 1.0f);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const __m128 x = _mm_loadu_ps(dx + i);
+                const __m128 z = _mm_loadu_ps(dz + i);
+                const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(z, z)));
+                __m128 speed = _mm_loadu_ps(maxSpeed + i);
+                if (clampStep)
+                    speed = _mm_min_ps(speed, _mm_div_ps(_mm_max_ps(zero, _mm_sub_ps(dist, radius)), vdt));
+                const __m128 far = _mm_cmpgt_ps(dist, minDist);
+                const __m128 safe = _mm_or_ps(_mm_and_ps(far, dist), _mm_andnot_ps(far, one));
+                _mm_storeu_ps(outDist + i, dist);
+                _mm_storeu_ps(outVx + i, _mm_and_ps(far, _mm_mul_ps(_mm_div_ps(x, safe), speed)));
+                _mm_storeu_ps(outVz + i, _mm_and_ps(far, _mm_mul_ps(_mm_div_ps(z, safe), speed)));
+            }
+            steerScalar(dx + i, dz + i, maxSpeed + i, n - i, arrivalRadius, dt, outDist + i, outVx + i, outVz + i);
+        }
+
+        // Lane k of 'c' holds component k of four column-major matrices; writes them to out[0..63].
+        inline void storeMatricesSSE2(float *out, const __m128 (&c)[16])
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                __m128 r0 = c[col * 4 + 0], r1 = c[col * 4 + 1], r2 = c[col * 4 + 2], r3 = c[col * 4 + 3];
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(out + 0 * 16 + col * 4, r0);
+                _mm_storeu_ps(out + 1 * 16 + col * 4, r1);
+                _mm_storeu_ps(out + 2 * 16 + col * 4, r2);
+                _mm_storeu_ps(out + 3 * 16 + col * 4, r3);
+            }
+        }
+
+        void nlerpQuatSSE2(float *soa, uint32_t stride, uint32_t n)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 sign = _mm_set1_ps(-0.0f);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                float *p = soa + i;
+                const __m128 ax = _mm_loadu_ps(p), ay = _mm_loadu_ps(p + stride);
+                const __m128 az = _mm_loadu_ps(p + 2 * stride), aw = _mm_loadu_ps(p + 3 * stride);
+                __m128 bx = _mm_loadu_ps(p + 4 * stride), by = _mm_loadu_ps(p + 5 * stride);
+                __m128 bz = _mm_loadu_ps(p + 6 * stride), bw = _mm_loadu_ps(p + 7 * stride);
+                const __m128 t = _mm_loadu_ps(p + 8 * stride);
+
+                const __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                                                       _mm_mul_ps(az, bz)), _mm_mul_ps(aw, bw));
+                const __m128 flip = _mm_and_ps(_mm_cmplt_ps(d, zero), sign);
+                bx = _mm_xor_ps(bx, flip);
+                by = _mm_xor_ps(by, flip);
+                bz = _mm_xor_ps(bz, flip);
+                bw = _mm_xor_ps(bw, flip);
+
+                const __m128 x = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), t));
+                const __m128 y = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), t));
+                const __m128 z = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), t));
+                const __m128 w = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), t));
+                const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                          _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+                const __m128 valid = _mm_cmpgt_ps(len2, zero);
+                const __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(_mm_or_ps(_mm_and_ps(valid, len2), _mm_andnot_ps(valid, one))));
+                _mm_storeu_ps(p, _mm_and_ps(valid, _mm_mul_ps(x, inv)));
+                _mm_storeu_ps(p + stride, _mm_and_ps(valid, _mm_mul_ps(y, inv)));
+                _mm_storeu_ps(p + 2 * stride, _mm_and_ps(valid, _mm_mul_ps(z, inv)));
+                _mm_storeu_ps(p + 3 * stride, _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(w, inv)), _mm_andnot_ps(valid, one)));
+            }
+            nlerpQuatScalar(soa + i, stride, n - i);
+        }
+
+        void composeTRSSSE2(const float *soa, uint32_t stride, uint32_t n, float *outMat4)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const float *p = soa + i;
+                __m128 x = _mm_loadu_ps(p + 3 * stride), y = _mm_loadu_ps(p + 4 * stride);
+                __m128 z = _mm_loadu_ps(p + 5 * stride), w = _mm_loadu_ps(p + 6 * stride);
+                const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                          _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+                const __m128 valid = _mm_cmpgt_ps(len2, zero);
+                const __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(_mm_or_ps(_mm_and_ps(valid, len2), _mm_andnot_ps(valid, one))));
+                x = _mm_and_ps(valid, _mm_mul_ps(x, inv));
+                y = _mm_and_ps(valid, _mm_mul_ps(y, inv));
+                z = _mm_and_ps(valid, _mm_mul_ps(z, inv));
+                w = _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(w, inv)), _mm_andnot_ps(valid, one));
+
+                const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+                const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+                const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+                const __m128 sx = _mm_loadu_ps(p + 7 * stride), sy = _mm_loadu_ps(p + 8 * stride);
+                const __m128 sz = _mm_loadu_ps(p + 9 * stride);
+
+                const __m128 c[16] = {
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+                    zero,
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+                    zero,
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+                    zero,
+                    _mm_loadu_ps(p),
+                    _mm_loadu_ps(p + stride),
+                    _mm_loadu_ps(p + 2 * stride),
+                    one,
+                };
+                storeMatricesSSE2(outMat4 + static_cast<size_t>(i) * 16, c);
+            }
+            composeTRSScalar(soa + i, stride, n - i, outMat4 + static_cast<size_t>(i) * 16);
+        }
+
+        // ---------------- AVX2 ----------------
+
+        ENGINE_TARGET_AVX2 bool axpyAVX2(float *dst, const float *src, uint32_t n, float scale)
+        {
+            const __m256 s = _mm256_set1_ps(scale);
+            __m256 nz = _mm256_setzero_ps();
+            uint32_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m256 v = _mm256_loadu_ps(src + i);
+                _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(v, s)));
+                nz = _mm256_or_ps(nz, _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_NEQ_UQ));
+            }
+            const bool any = _mm256_movemask_ps(nz) != 0;
+            return axpySSE2(dst + i, src + i, n - i, scale) || any;
+        }
+
+        ENGINE_TARGET_AVX2 void steerAVX2(const float *dx, const float *dz, const float *maxSpeed, uint32_t n,
+                                          float arrivalRadius, float dt, float *outDist, float *outVx, float *outVz)
+        {
+            const bool clampStep = dt > kMinDist;
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 minDist = _mm256_set1_ps(kMinDist);
+            const __m256 radius = _mm256_set1_ps(arrivalRadius);
+            const __m256 vdt = _mm256_set1_ps(clampStep ? dt : 1.0f);
+            uint32_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m256 x = _mm256_loadu_ps(dx + i);
+                const __m256 z = _mm256_loadu_ps(dz + i);
+                const __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(z, z)));
+                __m256 speed = _mm256_loadu_ps(maxSpeed + i);
+                if (clampStep)
+                    speed = _mm256_min_ps(speed, _mm256_div_ps(_mm256_max_ps(zero, _mm256_sub_ps(dist, radius)), vdt));
+                const __m256 far = _mm256_cmp_ps(dist, minDist, _CMP_GT_OQ);
+                const __m256 safe = _mm256_blendv_ps(one, dist, far);
+                _mm256_storeu_ps(outDist + i, dist);
+                _mm256_storeu_ps(outVx + i, _mm256_and_ps(far, _mm256_mul_ps(_mm256_div_ps(x, safe), speed)));
+                _mm256_storeu_ps(outVz + i, _mm256_and_ps(far, _mm256_mul_ps(_mm256_div_ps(z, safe), speed)));
+            }
+            steerSSE2(dx + i, dz + i, maxSpeed + i, n - i, arrivalRadius, dt, outDist + i, outVx + i, outVz + i);
+        }
+
+        ENGINE_TARGET_AVX2 void nlerpQuatAVX2(float *soa, uint32_t stride, uint32_t n)
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 sign = _mm256_set1_ps(-0.0f);
+            uint32_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                float *p = soa + i;
+                const __m256 ax = _mm256_loadu_ps(p), ay = _mm256_loadu_ps(p + stride);
+                const __m256 az = _mm256_loadu_ps(p + 2 * stride), aw = _mm256_loadu_ps(p + 3 * stride);
+                __m256 bx = _mm256_loadu_ps(p + 4 * stride), by = _mm256_loadu_ps(p + 5 * stride);
+                __m256 bz = _mm256_loadu_ps(p + 6 * stride), bw = _mm256_loadu_ps(p + 7 * stride);
+                const __m256 t = _mm256_loadu_ps(p + 8 * stride);
+
+                const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)),
+                                                             _mm256_mul_ps(az, bz)), _mm256_mul_ps(aw, bw));
+                const __m256 flip = _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_LT_OQ), sign);
+                bx = _mm256_xor_ps(bx, flip);
+                by = _mm256_xor_ps(by, flip);
+                bz = _mm256_xor_ps(bz, flip);
+                bw = _mm256_xor_ps(bw, flip);
+
+                const __m256 x = _mm256_add_ps(ax, _mm256_mul_ps(_mm256_sub_ps(bx, ax), t));
+                const __m256 y = _mm256_add_ps(ay, _mm256_mul_ps(_mm256_sub_ps(by, ay), t));
+                const __m256 z = _mm256_add_ps(az, _mm256_mul_ps(_mm256_sub_ps(bz, az), t));
+                const __m256 w = _mm256_add_ps(aw, _mm256_mul_ps(_mm256_sub_ps(bw, aw), t));
+                const __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+                                                                _mm256_mul_ps(z, z)), _mm256_mul_ps(w, w));
+                const __m256 valid = _mm256_cmp_ps(len2, zero, _CMP_GT_OQ);
+                const __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(_mm256_blendv_ps(one, len2, valid)));
+                _mm256_storeu_ps(p, _mm256_and_ps(valid, _mm256_mul_ps(x, inv)));
+                _mm256_storeu_ps(p + stride, _mm256_and_ps(valid, _mm256_mul_ps(y, inv)));
+                _mm256_storeu_ps(p + 2 * stride, _mm256_and_ps(valid, _mm256_mul_ps(z, inv)));
+                _mm256_storeu_ps(p + 3 * stride, _mm256_blendv_ps(one, _mm256_mul_ps(w, inv), valid));
+            }
+            nlerpQuatSSE2(soa + i, stride, n - i);
+        }
+
+        ENGINE_TARGET_AVX2 void composeTRSAVX2(const float *soa, uint32_t stride, uint32_t n, float *outMat4)
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 two = _mm256_set1_ps(2.0f);
+            uint32_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const float *p = soa + i;
+                __m256 x = _mm256_loadu_ps(p + 3 * stride), y = _mm256_loadu_ps(p + 4 * stride);
+                __m256 z = _mm256_loadu_ps(p + 5 * stride), w = _mm256_loadu_ps(p + 6 * stride);
+                const __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+                                                                _mm256_mul_ps(z, z)), _mm256_mul_ps(w, w));
+                const __m256 valid = _mm256_cmp_ps(len2, zero, _CMP_GT_OQ);
+                const __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(_mm256_blendv_ps(one, len2, valid)));
+                x = _mm256_and_ps(valid, _mm256_mul_ps(x, inv));
+                y = _mm256_and_ps(valid, _mm256_mul_ps(y, inv));
+                z = _mm256_and_ps(valid, _mm256_mul_ps(z, inv));
+                w = _mm256_blendv_ps(one, _mm256_mul_ps(w, inv), valid);
+
+                const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+                const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+                const __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+                const __m256 sx = _mm256_loadu_ps(p + 7 * stride), sy = _mm256_loadu_ps(p + 8 * stride);
+                const __m256 sz = _mm256_loadu_ps(p + 9 * stride);
+
+                const __m256 c[16] = {
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+                    zero,
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+                    zero,
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+                    zero,
+                    _mm256_loadu_ps(p),
+                    _mm256_loadu_ps(p + stride),
+                    _mm256_loadu_ps(p + 2 * stride),
+                    one,
+                };
+
+                // Transpose as two 4-wide halves.
+                __m128 lo[16], hi[16];
+                for (int k = 0; k < 16; ++k)
+                {
+                    lo[k] = _mm256_castps256_ps128(c[k]);
+                    hi[k] = _mm256_extractf128_ps(c[k], 1);
+                }
+                float *out = outMat4 + static_cast<size_t>(i) * 16;
+                storeMatricesSSE2(out, lo);
+                storeMatricesSSE2(out + 64, hi);
+            }
+            composeTRSSSE2(soa + i, stride, n - i, outMat4 + static_cast<size_t>(i) * 16);
+        }
+
+        bool cpuHasAVX2()
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+                return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif // ENGINE_SIMD_X86
+
+#if ENGINE_SIMD_NEON
+        // ---------------- NEON ----------------
+
+        bool axpyNEON(float *dst, const float *src, uint32_t n, float scale)
+        {
+            const float32x4_t s = vdupq_n_f32(scale);
+            uint32x4_t nz = vdupq_n_u32(0);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const float32x4_t v = vld1q_f32(src + i);
+                vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(v, s)));
+                nz = vorrq_u32(nz, vmvnq_u32(vceqq_f32(v, vdupq_n_f32(0.0f))));
+            }
+            const bool any = vmaxvq_u32(nz) != 0;
+            return axpyScalar(dst + i, src + i, n - i, scale) || any;
+        }
+
+        void steerNEON(const float *dx, const float *dz, const float *maxSpeed, uint32_t n,
+                       float arrivalRadius, float dt, float *outDist, float *outVx, float *outVz)
+        {
+            const bool clampStep = dt > kMinDist;
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            const float32x4_t one = vdupq_n_f32(1.0f);
+            const float32x4_t minDist = vdupq_n_f32(kMinDist);
+            const float32x4_t radius = vdupq_n_f32(arrivalRadius);
+            const float32x4_t vdt = vdupq_n_f32(clampStep ? dt : 1.0f);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const float32x4_t x = vld1q_f32(dx + i);
+                const float32x4_t z = vld1q_f32(dz + i);
+                const float32x4_t dist = vsqrtq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(z, z)));
+                float32x4_t speed = vld1q_f32(maxSpeed + i);
+                if (clampStep)
+                    speed = vminq_f32(speed, vdivq_f32(vmaxq_f32(zero, vsubq_f32(dist, radius)), vdt));
+                const uint32x4_t far = vcgtq_f32(dist, minDist);
+                const float32x4_t safe = vbslq_f32(far, dist, one);
+                const float32x4_t vx = vmulq_f32(vdivq_f32(x, safe), speed);
+                const float32x4_t vz = vmulq_f32(vdivq_f32(z, safe), speed);
+                vst1q_f32(outDist + i, dist);
+                vst1q_f32(outVx + i, vbslq_f32(far, vx, zero));
+                vst1q_f32(outVz + i, vbslq_f32(far, vz, zero));
+            }
+            steerScalar(dx + i, dz + i, maxSpeed + i, n - i, arrivalRadius, dt, outDist + i, outVx + i, outVz + i);
+        }
+        void nlerpQuatNEON(float *soa, uint32_t stride, uint32_t n)
+        {
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            const float32x4_t one = vdupq_n_f32(1.0f);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                float *p = soa + i;
+                const float32x4_t ax = vld1q_f32(p), ay = vld1q_f32(p + stride);
+                const float32x4_t az = vld1q_f32(p + 2 * stride), aw = vld1q_f32(p + 3 * stride);
+                float32x4_t bx = vld1q_f32(p + 4 * stride), by = vld1q_f32(p + 5 * stride);
+                float32x4_t bz = vld1q_f32(p + 6 * stride), bw = vld1q_f32(p + 7 * stride);
+                const float32x4_t t = vld1q_f32(p + 8 * stride);
+
+                const float32x4_t d = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(ax, bx), vmulq_f32(ay, by)),
+                                                          vmulq_f32(az, bz)), vmulq_f32(aw, bw));
+                const uint32x4_t flip = vcltq_f32(d, zero);
+                bx = vbslq_f32(flip, vnegq_f32(bx), bx);
+                by = vbslq_f32(flip, vnegq_f32(by), by);
+                bz = vbslq_f32(flip, vnegq_f32(bz), bz);
+                bw = vbslq_f32(flip, vnegq_f32(bw), bw);
+
+                const float32x4_t x = vaddq_f32(ax, vmulq_f32(vsubq_f32(bx, ax), t));
+                const float32x4_t y = vaddq_f32(ay, vmulq_f32(vsubq_f32(by, ay), t));
+                const float32x4_t z = vaddq_f32(az, vmulq_f32(vsubq_f32(bz, az), t));
+                const float32x4_t w = vaddq_f32(aw, vmulq_f32(vsubq_f32(bw, aw), t));
+                const float32x4_t len2 = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)),
+                                                             vmulq_f32(z, z)), vmulq_f32(w, w));
+                const uint32x4_t valid = vcgtq_f32(len2, zero);
+                const float32x4_t inv = vdivq_f32(one, vsqrtq_f32(vbslq_f32(valid, len2, one)));
+                vst1q_f32(p, vbslq_f32(valid, vmulq_f32(x, inv), zero));
+                vst1q_f32(p + stride, vbslq_f32(valid, vmulq_f32(y, inv), zero));
+                vst1q_f32(p + 2 * stride, vbslq_f32(valid, vmulq_f32(z, inv), zero));
+                vst1q_f32(p + 3 * stride, vbslq_f32(valid, vmulq_f32(w, inv), one));
+            }
+            nlerpQuatScalar(soa + i, stride, n - i);
+        }
+
+        void composeTRSNEON(const float *soa, uint32_t stride, uint32_t n, float *outMat4)
+        {
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            const float32x4_t one = vdupq_n_f32(1.0f);
+            const float32x4_t two = vdupq_n_f32(2.0f);
+            uint32_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const float *p = soa + i;
+                float32x4_t x = vld1q_f32(p + 3 * stride), y = vld1q_f32(p + 4 * stride);
+                float32x4_t z = vld1q_f32(p + 5 * stride), w = vld1q_f32(p + 6 * stride);
+                const float32x4_t len2 = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)),
+                                                             vmulq_f32(z, z)), vmulq_f32(w, w));
+                const uint32x4_t valid = vcgtq_f32(len2, zero);
+                const float32x4_t inv = vdivq_f32(one, vsqrtq_f32(vbslq_f32(valid, len2, one)));
+                x = vbslq_f32(valid, vmulq_f32(x, inv), zero);
+                y = vbslq_f32(valid, vmulq_f32(y, inv), zero);
+                z = vbslq_f32(valid, vmulq_f32(z, inv), zero);
+                w = vbslq_f32(valid, vmulq_f32(w, inv), one);
+
+                const float32x4_t xx = vmulq_f32(x, x), yy = vmulq_f32(y, y), zz = vmulq_f32(z, z);
+                const float32x4_t xy = vmulq_f32(x, y), xz = vmulq_f32(x, z), yz = vmulq_f32(y, z);
+                const float32x4_t wx = vmulq_f32(w, x), wy = vmulq_f32(w, y), wz = vmulq_f32(w, z);
+                const float32x4_t sx = vld1q_f32(p + 7 * stride), sy = vld1q_f32(p + 8 * stride);
+                const float32x4_t sz = vld1q_f32(p + 9 * stride);
+
+                const float32x4x4_t cols[4] = {
+                    {{vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(yy, zz))), sx),
+                      vmulq_f32(vmulq_f32(two, vaddq_f32(xy, wz)), sx),
+                      vmulq_f32(vmulq_f32(two, vsubq_f32(xz, wy)), sx),
+                      zero}},
+                    {{vmulq_f32(vmulq_f32(two, vsubq_f32(xy, wz)), sy),
+                      vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(xx, zz))), sy),
+                      vmulq_f32(vmulq_f32(two, vaddq_f32(yz, wx)), sy),
+                      zero}},
+                    {{vmulq_f32(vmulq_f32(two, vaddq_f32(xz, wy)), sz),
+                      vmulq_f32(vmulq_f32(two, vsubq_f32(yz, wx)), sz),
+                      vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(xx, yy))), sz),
+                      zero}},
+                    {{vld1q_f32(p), vld1q_f32(p + stride), vld1q_f32(p + 2 * stride), one}},
+                };
+
+                // vst4q interleaves: element k's column lands in tmp[4k .. 4k+3].
+                float *out = outMat4 + static_cast<size_t>(i) * 16;
+                float tmp[16];
+                for (int col = 0; col < 4; ++col)
+                {
+                    vst4q_f32(tmp, cols[col]);
+                    for (int k = 0; k < 4; ++k)
+                        std::memcpy(out + k * 16 + col * 4, tmp + k * 4, 4 * sizeof(float));
+                }
+            }
+            composeTRSScalar(soa + i, stride, n - i, outMat4 + static_cast<size_t>(i) * 16);
+        }
+#endif // ENGINE_SIMD_NEON
+
+        struct KernelTable
+        {
+            Level level = Level::Scalar;
+            bool (*axpy)(float *, const float *, uint32_t, float) = axpyScalar;
+            void (*steer)(const float *, const float *, const float *, uint32_t, float, float, float *, float *, float *) = steerScalar;
+            void (*nlerpQuat)(float *, uint32_t, uint32_t) = nlerpQuatScalar;
+            void (*composeTRS)(const float *, uint32_t, uint32_t, float *) = composeTRSScalar;
+        };
+
+        // Highest level the CPU supports, capped by ENGINE_SIMD if set.
+        Level detectLevel()
+        {
+            Level best = Level::Scalar;
+#if ENGINE_SIMD_X86
+            best = cpuHasAVX2() ? Level::AVX2 : Level::SSE2;
+#elif ENGINE_SIMD_NEON
+            best = Level::NEON;
+#endif
+            if (const char *cap = std::getenv("ENGINE_SIMD"))
+            {
+                if (std::strcmp(cap, "scalar") == 0)
+                    best = Level::Scalar;
+                else if (std::strcmp(cap, "sse2") == 0 && best == Level::AVX2)
+                    best = Level::SSE2;
+            }
+            return best;
+        }
+
+        const KernelTable &kernels()
+        {
+            static const KernelTable table = []()
+            {
+                KernelTable t;
+                t.level = detectLevel();
+#if ENGINE_SIMD_X86
+                if (t.level == Level::AVX2)
+                {
+                    t.axpy = axpyAVX2;
+                    t.steer = steerAVX2;
+                    t.nlerpQuat = nlerpQuatAVX2;
+                    t.composeTRS = composeTRSAVX2;
+                }
+                else if (t.level == Level::SSE2)
+                {
+                    t.axpy = axpySSE2;
+                    t.steer = steerSSE2;
+                    t.nlerpQuat = nlerpQuatSSE2;
+                    t.composeTRS = composeTRSSSE2;
+                }
+#elif ENGINE_SIMD_NEON
+                if (t.level == Level::NEON)
+                {
+                    t.axpy = axpyNEON;
+                    t.steer = steerNEON;
+                    t.nlerpQuat = nlerpQuatNEON;
+                    t.composeTRS = composeTRSNEON;
+                }
+#endif
+                return t;
+            }();
+            return table;
+        }
+    } // namespace
+
+    Level activeLevel() { return kernels().level; }
+
+    const char *levelName(Level level)
+    {
+        switch (level)
+        {
+        case Level::SSE2:
+            return "SSE2";
+        case Level::AVX2:
+            return "AVX2";
+        case Level::NEON:
+            return "NEON";
+        default:
+            return "Scalar";
+        }
+    }
+
+    bool axpy(float *dst, const float *src, uint32_t n, float scale)
+    {
+        return kernels().axpy(dst, src, n, scale);
+    }
+
+    void steer(const float *dx, const float *dz, const float *maxSpeed, uint32_t n,
+               float arrivalRadius, float dt, float *outDist, float *outVx, float *outVz)
+    {
+        kernels().steer(dx, dz, maxSpeed, n, arrivalRadius, dt, outDist, outVx, outVz);
+    }
+
+    void nlerpQuat(float *soa, uint32_t stride, uint32_t n)
+    {
+        kernels().nlerpQuat(soa, stride, n);
+    }
+
+    void composeTRS(const float *soa, uint32_t stride, uint32_t n, float *outMat4)
+    {
+        kernels().composeTRS(soa, stride, n, outMat4);
+    }
+
+} // namespace Engine::Simd
@@ -1,7 +1,7 @@
 #include "Engine/SwapChain.h"
 #include <GLFW/glfw3.h> // only if you need glfw helpers elsewhere; not required here
+#include "utils/Log.h"
 #include <stdexcept>
-#include <iostream>
 #include <algorithm>
 
 namespace Engine
@@ -93,12 +93,13 @@ namespace Engine
 
         m_ImageFormat = surfaceFormat.format;
         m_Extent = extent;
+        m_PresentMode = presentMode;
 
         // create image views for use in framebuffers
         createImageViews();
 
         // If replacing an old swapchain, cleanup the old one (vkDestroySwapchainKHR must be handled by caller or here if oldSwapchain used)
-        std::cout << "SwapChain initialized: images=" << m_Images.size() << " format=" << m_ImageFormat << "\n";
+        ENGINE_LOG_INFO("SwapChain initialized: images=%zu format=%d", m_Images.size(), static_cast<int>(m_ImageFormat));
     }
 
     void SwapChain::Cleanup()
@@ -140,6 +141,11 @@ namespace Engine
 
     VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &available) const
     {
+        for (const auto &av : available)
+        {
+            if (av == m_PreferredPresentMode)
+                return av;
+        }
         for (const auto &av : available)
         {
             if (av == VK_PRESENT_MODE_MAILBOX_KHR)
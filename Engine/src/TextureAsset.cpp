@@ -1,4 +1,5 @@
 #include "assets/TextureAsset.h"
+#include "assets/ModelFormat.h"
 #include "utils/ImageUtils.h"
 
 #include <cstdlib>
@@ -52,23 +53,20 @@ namespace Engine
 
         const VkDeviceSize pixelBytes = VkDeviceSize(width) * VkDeviceSize(height) * 4u;
 
-        // 1) Create staging buffer (must survive until submit finishes)
-        StagingBufferHandle staging{};
-        VkResult r = CreateStagingBuffer(ctx.device, ctx.physicalDevice, rgbaPixels, pixelBytes, staging);
-        if (r != VK_SUCCESS)
+        // 1) Copy the pixels into the context's staging memory (alive until its upload has run)
+        StagingSlice staging{};
+        if (!StageBytes(ctx, rgbaPixels, pixelBytes, staging))
             return false;
 
-        // Keep staging alive until EndSubmitAndWait
-        ctx.pendingStaging.push_back(staging);
-
         // 2) Create GPU image (with mip levels)
-        r = CreateImage2D(
+        VkResult r = CreateImage2D(
             ctx.device, ctx.physicalDevice,
             width, height,
             m_format,
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             m_mipLevels,
-            m_image, m_memory);
+            m_image, m_memory,
+            MemoryCategory::Textures);
 
         if (r != VK_SUCCESS)
             return false;
@@ -81,7 +79,8 @@ namespace Engine
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
             VK_IMAGE_ASPECT_COLOR_BIT);
 
-        CmdCopyBufferToImage(ctx, staging.buffer, m_image, width, height);
+        CmdCopyBufferToImage(ctx, staging, m_image, width, height);
+        CmdAcquireUploadedImage(ctx, m_image, VK_IMAGE_ASPECT_COLOR_BIT);
 
         // 3b) Generate mipmaps if possible; otherwise just transition mip 0.
         if (m_mipLevels > 1)
@@ -140,6 +139,221 @@ namespace Engine
         return true;
     }
 
+    // ------------------------------------------------------------
+    // BCn CPU decode (devices without textureCompressionBC)
+    // ------------------------------------------------------------
+
+    static void decodeBC1Block(const uint8_t *block, uint8_t (&rgba)[16][4])
+    {
+        const uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        const uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+        uint8_t palette[4][4];
+        auto expand = [](uint16_t c, uint8_t(&out)[4])
+        {
+            out[0] = static_cast<uint8_t>(((c >> 11) & 31) * 255 / 31);
+            out[1] = static_cast<uint8_t>(((c >> 5) & 63) * 255 / 63);
+            out[2] = static_cast<uint8_t>((c & 31) * 255 / 31);
+            out[3] = 255;
+        };
+        expand(c0, palette[0]);
+        expand(c1, palette[1]);
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            if (c0 > c1)
+            {
+                palette[2][ch] = static_cast<uint8_t>((2 * palette[0][ch] + palette[1][ch]) / 3);
+                palette[3][ch] = static_cast<uint8_t>((palette[0][ch] + 2 * palette[1][ch]) / 3);
+            }
+            else
+            {
+                palette[2][ch] = static_cast<uint8_t>((palette[0][ch] + palette[1][ch]) / 2);
+                palette[3][ch] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = (c0 > c1) ? 255 : 0;
+
+        const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t(block[7]) << 24);
+        for (int i = 0; i < 16; ++i)
+            std::memcpy(rgba[i], palette[(indices >> (2 * i)) & 3], 4);
+    }
+
+    // One channel (BC3 alpha, BC5 red/green)
+    static void decodeBC4Block(const uint8_t *block, uint8_t (&rgba)[16][4], int channel)
+    {
+        const uint32_t a0 = block[0];
+        const uint32_t a1 = block[1];
+        uint8_t palette[8] = {static_cast<uint8_t>(a0), static_cast<uint8_t>(a1)};
+        for (uint32_t k = 1; k < 7; ++k)
+        {
+            if (a0 > a1)
+                palette[k + 1] = static_cast<uint8_t>(((7 - k) * a0 + k * a1) / 7);
+            else if (k < 5)
+                palette[k + 1] = static_cast<uint8_t>(((5 - k) * a0 + k * a1) / 5);
+        }
+        if (a0 <= a1)
+        {
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indices = 0;
+        for (int b = 0; b < 6; ++b)
+            indices |= uint64_t(block[2 + b]) << (8 * b);
+        for (int i = 0; i < 16; ++i)
+            rgba[i][channel] = palette[(indices >> (3 * i)) & 7];
+    }
+
+    // Mip 0 of a BC1/BC3/BC5 image to RGBA8 (BC5: blue 0, alpha 255, like the hardware)
+    static void decodeBlockImage(const uint8_t *blocks, uint32_t encoding, uint32_t width, uint32_t height, std::vector<uint8_t> &outRgba)
+    {
+        const auto enc = static_cast<smodel::ImageEncoding>(encoding);
+        const uint32_t blockBytes = smodel::BlockBytes(encoding);
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        outRgba.assign(size_t(width) * height * 4u, 0);
+        for (uint32_t by = 0; by < blocksY; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                const uint8_t *block = blocks + (size_t(by) * blocksX + bx) * blockBytes;
+                uint8_t texels[16][4] = {};
+                if (enc == smodel::ImageEncoding::BC1)
+                    decodeBC1Block(block, texels);
+                else if (enc == smodel::ImageEncoding::BC3)
+                {
+                    decodeBC1Block(block + 8, texels);
+                    decodeBC4Block(block, texels, 3);
+                }
+                else
+                {
+                    decodeBC4Block(block, texels, 0);
+                    decodeBC4Block(block + 8, texels, 1);
+                    for (auto &t : texels)
+                    {
+                        t[2] = 0;
+                        t[3] = 255;
+                    }
+                }
+
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    const uint32_t x = bx * 4 + (i & 3);
+                    const uint32_t y = by * 4 + (i >> 2);
+                    if (x < width && y < height)
+                        std::memcpy(&outRgba[(size_t(y) * width + x) * 4u], texels[i], 4);
+                }
+            }
+        }
+    }
+
+    static VkFormat blockFormat(uint32_t encoding, bool srgb)
+    {
+        switch (static_cast<smodel::ImageEncoding>(encoding))
+        {
+        case smodel::ImageEncoding::BC1:
+            return srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case smodel::ImageEncoding::BC3:
+            return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        case smodel::ImageEncoding::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        default:
+            return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    bool TextureAsset::uploadBlockCompressed_Deferred(
+        UploadContext &ctx,
+        const uint8_t *blockBytes,
+        size_t byteSize,
+        uint32_t encoding,
+        uint32_t width,
+        uint32_t height,
+        bool srgbFormat,
+        VkSamplerAddressMode wrapU,
+        VkSamplerAddressMode wrapV,
+        VkFilter minFilter,
+        VkFilter magFilter,
+        VkSamplerMipmapMode mipMode,
+        float maxAnisotropy,
+        uint32_t firstMip)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE || !blockBytes || width == 0 || height == 0)
+            return false;
+        const VkFormat format = blockFormat(encoding, srgbFormat);
+        if (format == VK_FORMAT_UNDEFINED || byteSize != smodel::BlockMipChainBytes(encoding, width, height))
+            return false;
+
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(ctx.physicalDevice, format, &props);
+        if ((props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0)
+        {
+            std::vector<uint8_t> rgba;
+            decodeBlockImage(blockBytes, encoding, width, height, rgba);
+            return uploadRGBA8_Deferred(ctx, rgba.data(), width, height, srgbFormat && format != VK_FORMAT_BC5_UNORM_BLOCK,
+                                        wrapU, wrapV, minFilter, magFilter, mipMode, maxAnisotropy);
+        }
+
+        if (isValid())
+            destroy(ctx.device);
+
+        // The chain from 'firstMip' on is the full chain of that mip's size
+        firstMip = std::min(firstMip, smodel::FullMipCount(width, height) - 1u);
+        size_t skipped = 0;
+        for (uint32_t mip = 0; mip < firstMip; ++mip)
+            skipped += static_cast<size_t>(smodel::BlockMipBytes(encoding, width, height, mip));
+
+        m_width = std::max(width >> firstMip, 1u);
+        m_height = std::max(height >> firstMip, 1u);
+        m_mipLevels = smodel::FullMipCount(m_width, m_height);
+        m_firstMip = firstMip;
+        m_format = format;
+
+        // 1) The chain into staging, as stored
+        StagingSlice staging{};
+        if (!StageBytes(ctx, blockBytes + skipped, byteSize - skipped, staging))
+            return false;
+
+        // 2) GPU image with every mip (nothing is blitted)
+        VkResult r = CreateImage2D(
+            ctx.device, ctx.physicalDevice,
+            m_width, m_height,
+            m_format,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            m_mipLevels,
+            m_image, m_memory,
+            MemoryCategory::Textures);
+        if (r != VK_SUCCESS)
+            return false;
+
+        // 3) One copy region per mip, then straight to shader reads
+        CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        CmdCopyMipChainToImage(ctx, staging, m_image, m_width, m_height, m_mipLevels, smodel::BlockBytes(encoding));
+        CmdAcquireUploadedImage(ctx, m_image, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+
+        // 4) View + sampler
+        r = CreateImageView2D(ctx.device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels, m_view);
+        if (r != VK_SUCCESS)
+            return false;
+
+        r = CreateTextureSampler(
+            ctx.device,
+            ctx.physicalDevice,
+            wrapU,
+            wrapV,
+            minFilter,
+            magFilter,
+            mipMode,
+            maxAnisotropy,
+            static_cast<float>(m_mipLevels - 1),
+            m_sampler);
+
+        return r == VK_SUCCESS;
+    }
+
     bool TextureAsset::uploadEncodedImage_Deferred(
         UploadContext &ctx,
         const uint8_t *encodedBytes,
@@ -189,6 +403,56 @@ namespace Engine
         return ok;
     }
 
+    bool TextureAsset::decodeImage(
+        const uint8_t *encodedBytes,
+        size_t encodedSize,
+        std::vector<uint8_t> &outRgba,
+        uint32_t &outWidth,
+        uint32_t &outHeight)
+    {
+        if (!encodedBytes || encodedSize == 0)
+            return false;
+
+        int w = 0, h = 0, comp = 0;
+        unsigned char *decoded = stbi_load_from_memory(
+            encodedBytes,
+            static_cast<int>(encodedSize),
+            &w, &h,
+            &comp,
+            4);
+
+        if (!decoded || w <= 0 || h <= 0)
+        {
+            if (decoded)
+                stbi_image_free(decoded);
+            return false;
+        }
+
+        outWidth = static_cast<uint32_t>(w);
+        outHeight = static_cast<uint32_t>(h);
+        outRgba.assign(decoded, decoded + size_t(outWidth) * size_t(outHeight) * 4u);
+        stbi_image_free(decoded);
+        return true;
+    }
+
+    bool TextureAsset::probeImage(
+        const uint8_t *encodedBytes,
+        size_t encodedSize,
+        uint32_t &outWidth,
+        uint32_t &outHeight)
+    {
+        if (!encodedBytes || encodedSize == 0)
+            return false;
+
+        int w = 0, h = 0, comp = 0;
+        if (!stbi_info_from_memory(encodedBytes, static_cast<int>(encodedSize), &w, &h, &comp) || w <= 0 || h <= 0)
+            return false;
+
+        outWidth = static_cast<uint32_t>(w);
+        outHeight = static_cast<uint32_t>(h);
+        return true;
+    }
+
     void TextureAsset::destroy(VkDevice device)
     {
         if (m_sampler != VK_NULL_HANDLE)
@@ -209,15 +473,12 @@ namespace Engine
             m_image = VK_NULL_HANDLE;
         }
 
-        if (m_memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, m_memory, nullptr);
-            m_memory = VK_NULL_HANDLE;
-        }
+        FreeMemory(m_memory);
 
         m_width = 0;
         m_height = 0;
         m_mipLevels = 1;
+        m_firstMip = 0;
         m_format = VK_FORMAT_R8G8B8A8_UNORM;
     }
 
@@ -0,0 +1,215 @@
+#include "utils/TraceCapture.h"
+#include "utils/Log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace Engine
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        // Chrome trace processes: one for the CPU threads, one for the GPU queue
+        constexpr int kCpuPid = 1;
+        constexpr int kGpuPid = 2;
+        // Frame markers get the first row of each process
+        constexpr int kFrameTid = 0;
+
+        struct CaptureState
+        {
+            std::mutex mutex;
+            std::atomic<bool> active{false};
+            std::string path;
+            uint32_t remaining = 0;
+            uint32_t frameIndex = 0;
+            uint64_t originNs = 0;
+            uint64_t lastGpuFrameNs = 0; // GPU results repeat while no new frame was collected
+            std::vector<json> events;
+            std::map<std::string, int> cpuThreads; // thread label -> tid
+            std::map<std::string, int> gpuTracks;
+        };
+
+        CaptureState &GetState()
+        {
+            static CaptureState state;
+            return state;
+        }
+
+        // Microseconds from the capture start; earlier times (a load requested before it) clamp to 0
+        double ToUs_Internal(const CaptureState &s, uint64_t ns)
+        {
+            return ns > s.originNs ? static_cast<double>(ns - s.originNs) * 1e-3 : 0.0;
+        }
+
+        void AddSpan_Internal(CaptureState &s, int pid, int tid, const std::string &name, const char *category,
+                              uint64_t startNs, uint64_t endNs)
+        {
+            const double ts = ToUs_Internal(s, startNs);
+            const double dur = std::max(ToUs_Internal(s, endNs) - ts, 0.0);
+            s.events.push_back({{"ph", "X"}, {"pid", pid}, {"tid", tid}, {"name", name}, {"cat", category}, {"ts", ts},
+                                {"dur", dur}});
+        }
+
+        int TrackId_Internal(std::map<std::string, int> &tracks, const std::string &label)
+        {
+            auto it = tracks.find(label);
+            if (it != tracks.end())
+                return it->second;
+            const int tid = kFrameTid + 1 + static_cast<int>(tracks.size());
+            tracks.emplace(label, tid);
+            return tid;
+        }
+
+        json Metadata_Internal(const char *kind, int pid, int tid, const std::string &name)
+        {
+            return {{"ph", "M"}, {"pid", pid}, {"tid", tid}, {"name", kind}, {"args", {{"name", name}}}};
+        }
+
+        bool Write_Internal(CaptureState &s)
+        {
+            json events = json::array();
+            events.push_back(Metadata_Internal("process_name", kCpuPid, 0, "CPU"));
+            events.push_back(Metadata_Internal("process_name", kGpuPid, 0, "GPU"));
+            events.push_back(Metadata_Internal("thread_name", kCpuPid, kFrameTid, "Frames"));
+            events.push_back(Metadata_Internal("thread_name", kGpuPid, kFrameTid, "Frames"));
+            for (const auto &[label, tid] : s.cpuThreads)
+                events.push_back(Metadata_Internal("thread_name", kCpuPid, tid, label));
+            for (const auto &[label, tid] : s.gpuTracks)
+                events.push_back(Metadata_Internal("thread_name", kGpuPid, tid, label));
+            for (json &e : s.events)
+                events.push_back(std::move(e));
+
+            json root;
+            root["traceEvents"] = std::move(events);
+            root["displayTimeUnit"] = "ms";
+            root["otherData"] = {{"frames", s.frameIndex}};
+
+            std::ofstream out(s.path);
+            if (!out.good())
+            {
+                ENGINE_LOG_ERROR("[TraceCapture] Cannot write %s", s.path.c_str());
+                return false;
+            }
+            out << root.dump();
+            return out.good();
+        }
+    } // namespace
+
+    bool TraceCapture::begin(const std::string &path, uint32_t frames)
+    {
+        CaptureState &s = GetState();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.active.load(std::memory_order_relaxed) || frames == 0)
+            return false;
+
+        s.path = path;
+        s.remaining = frames;
+        s.frameIndex = 0;
+        s.originNs = Profiler::now();
+        s.lastGpuFrameNs = 0;
+        s.events.clear();
+        s.cpuThreads.clear();
+        s.gpuTracks.clear();
+        s.active.store(true, std::memory_order_relaxed);
+        ENGINE_LOG_INFO("[TraceCapture] Recording %u frames -> %s", frames, path.c_str());
+        return true;
+    }
+
+    bool TraceCapture::active()
+    {
+        return GetState().active.load(std::memory_order_relaxed);
+    }
+
+    uint32_t TraceCapture::remaining()
+    {
+        CaptureState &s = GetState();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.active.load(std::memory_order_relaxed) ? s.remaining : 0;
+    }
+
+    void TraceCapture::instant(const char *category, const std::string &name)
+    {
+        CaptureState &s = GetState();
+        if (!s.active.load(std::memory_order_relaxed))
+            return;
+        const uint64_t now = Profiler::now();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.active.load(std::memory_order_relaxed))
+            return;
+        s.events.push_back({{"ph", "i"}, {"s", "g"}, {"pid", kCpuPid}, {"tid", kFrameTid}, {"name", name},
+                            {"cat", category}, {"ts", ToUs_Internal(s, now)}});
+    }
+
+    void TraceCapture::asyncSpan(const char *category, const std::string &name, uint64_t id, uint64_t startNs,
+                                 uint64_t endNs)
+    {
+        CaptureState &s = GetState();
+        if (!s.active.load(std::memory_order_relaxed))
+            return;
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (!s.active.load(std::memory_order_relaxed) || endNs < s.originNs)
+            return;
+        const double ts = ToUs_Internal(s, startNs);
+        const double te = std::max(ToUs_Internal(s, endNs), ts);
+        s.events.push_back({{"ph", "b"}, {"pid", kCpuPid}, {"id", id}, {"name", name}, {"cat", category}, {"ts", ts}});
+        s.events.push_back({{"ph", "e"}, {"pid", kCpuPid}, {"id", id}, {"name", name}, {"cat", category}, {"ts", te}});
+    }
+
+    bool TraceCapture::addFrame(const Profiler::Frame &frame, const std::vector<GpuSpan> &gpu)
+    {
+        CaptureState &s = GetState();
+        if (!s.active.load(std::memory_order_relaxed))
+            return false;
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        const std::string frameName = "Frame " + std::to_string(s.frameIndex);
+        if (frame.endNs > frame.startNs)
+            AddSpan_Internal(s, kCpuPid, kFrameTid, frameName, "frame", frame.startNs, frame.endNs);
+
+        std::vector<int> tids(frame.threads.size());
+        for (size_t i = 0; i < frame.threads.size(); ++i)
+            tids[i] = TrackId_Internal(s.cpuThreads, frame.threads[i]);
+        for (const Profiler::Event &e : frame.events)
+        {
+            if (e.thread < tids.size() && e.name)
+                AddSpan_Internal(s, kCpuPid, tids[e.thread], e.name, "cpu", e.startNs, e.endNs);
+        }
+        if (frame.dropped > 0)
+            s.events.push_back({{"ph", "i"}, {"s", "p"}, {"pid", kCpuPid}, {"tid", kFrameTid},
+                                {"name", std::to_string(frame.dropped) + " scopes dropped"}, {"cat", "cpu"},
+                                {"ts", ToUs_Internal(s, frame.endNs)}});
+
+        // The GPU frame arriving now is frames-in-flight old; skip it when nothing new was collected
+        const uint64_t gpuFrameNs = gpu.empty() ? 0 : gpu.front().startNs;
+        if (gpuFrameNs != 0 && gpuFrameNs != s.lastGpuFrameNs)
+        {
+            s.lastGpuFrameNs = gpuFrameNs;
+            for (const GpuSpan &span : gpu)
+            {
+                if (span.endNs < s.originNs)
+                    continue;
+                const int tid = span.track == "Frame" ? kFrameTid : TrackId_Internal(s.gpuTracks, span.track);
+                AddSpan_Internal(s, kGpuPid, tid, span.name, "gpu", span.startNs, span.endNs);
+            }
+        }
+
+        ++s.frameIndex;
+        if (--s.remaining > 0)
+            return false;
+
+        s.active.store(false, std::memory_order_relaxed);
+        const size_t eventCount = s.events.size();
+        if (Write_Internal(s))
+            ENGINE_LOG_INFO("[TraceCapture] Wrote %u frames, %zu events -> %s", s.frameIndex, eventCount, s.path.c_str());
+        s.events.clear();
+        s.events.shrink_to_fit();
+        return true;
+    }
+
+} // namespace Engine
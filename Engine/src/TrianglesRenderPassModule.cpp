@@ -1,7 +1,7 @@
 #include "Engine/TrianglesRenderPassModule.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
-#include "Engine/PerformanceMonitor.h"
+#include "Engine/RenderStats.h"
 #include "utils/BufferUtils.h"
 #include <stdexcept>
 #include <cstring>
@@ -87,7 +87,14 @@ namespace Engine
 
         const uint32_t instanceCount = (m_instances.instanceCount > 0 ? m_instances.instanceCount : 1);
         vkCmdDraw(cmd, m_binding.vertexCount, instanceCount, 0, 0);
-        DrawCallCounter::increment();
+
+        RenderCounters stats;
+        stats.drawCalls = 1;
+        stats.instances = instanceCount;
+        stats.triangles = stats.visibleTriangles = static_cast<uint64_t>(m_binding.vertexCount / 3) * instanceCount;
+        stats.pipelineBinds = 1;
+        stats.bufferBinds = 2;
+        RenderStats::addPass(name(), stats);
     }
 
     void TrianglesRenderPassModule::onDestroy(VulkanContext &ctx)
@@ -0,0 +1,176 @@
+#include "Engine/UploadRing.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+    {
+        return alignment > 1 ? ((v + alignment - 1) / alignment) * alignment : v;
+    }
+
+    static VkDeviceSize nextPowerOfTwo(VkDeviceSize v)
+    {
+        VkDeviceSize p = 1;
+        while (p < v)
+            p <<= 1;
+        return p;
+    }
+
+    UploadRing::~UploadRing()
+    {
+        destroy();
+    }
+
+    bool UploadRing::init(VkDevice device, VkPhysicalDevice phys, uint32_t slotCount, VkDeviceSize slotBytes)
+    {
+        destroy();
+        m_device = device;
+
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(phys, &props);
+        m_uniformAlignment = std::max<VkDeviceSize>(props.limits.minUniformBufferOffsetAlignment, 16);
+        m_storageAlignment = std::max<VkDeviceSize>(props.limits.minStorageBufferOffsetAlignment, 16);
+        m_maxBufferBytes = props.limits.maxStorageBufferRange;
+
+        const VkDeviceSize bytes = std::min(nextPowerOfTwo(std::max<VkDeviceSize>(slotBytes, 1)), m_maxBufferBytes);
+        m_slots.resize(std::max(slotCount, 1u));
+        for (Slot &slot : m_slots)
+        {
+            if (!createBuffer(bytes, slot.current))
+            {
+                ENGINE_LOG_ERROR("[UploadRing] Failed to create a %llu byte slot buffer", static_cast<unsigned long long>(bytes));
+                destroy();
+                return false;
+            }
+        }
+        m_slot = 0;
+        return true;
+    }
+
+    void UploadRing::destroy()
+    {
+        for (Slot &slot : m_slots)
+        {
+            for (Buffer &b : slot.retired)
+                destroyBuffer(b);
+            destroyBuffer(slot.current);
+        }
+        m_slots.clear();
+        m_slot = 0;
+    }
+
+    bool UploadRing::createBuffer(VkDeviceSize size, Buffer &out)
+    {
+        VkBufferCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        info.size = size;
+        info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(m_device, &info, nullptr, &out.buffer) != VK_SUCCESS)
+        {
+            out.buffer = VK_NULL_HANDLE;
+            return false;
+        }
+        if (AllocateBufferMemory(m_device, out.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 out.memory, MemoryStrategy::General, MemoryCategory::Dynamic) != VK_SUCCESS ||
+            !out.memory.mapped)
+        {
+            destroyBuffer(out);
+            return false;
+        }
+        out.size = size;
+        return true;
+    }
+
+    void UploadRing::destroyBuffer(Buffer &buffer)
+    {
+        if (buffer.buffer != VK_NULL_HANDLE)
+            vkDestroyBuffer(m_device, buffer.buffer, nullptr);
+        FreeMemory(buffer.memory);
+        buffer = Buffer{};
+    }
+
+    void UploadRing::beginFrame(uint32_t slotIndex)
+    {
+        if (m_slots.empty())
+            return;
+        m_slot = slotIndex % static_cast<uint32_t>(m_slots.size());
+        ++m_frameSerial;
+        Slot &slot = m_slots[m_slot];
+
+        for (Buffer &b : slot.retired)
+            destroyBuffer(b);
+        slot.retired.clear();
+
+        // The slot's last frame did not fit one buffer: one that holds it all from now on.
+        if (slot.used > slot.current.size)
+        {
+            const VkDeviceSize bytes = std::min(nextPowerOfTwo(slot.used), m_maxBufferBytes);
+            Buffer grown;
+            if (createBuffer(bytes, grown))
+            {
+                destroyBuffer(slot.current);
+                slot.current = grown;
+            }
+        }
+        slot.head = 0;
+        slot.used = 0;
+    }
+
+    UploadRing::Allocation UploadRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        Allocation a{};
+        if (m_slots.empty() || size == 0 || size > m_maxBufferBytes)
+            return a;
+
+        Slot &slot = m_slots[m_slot];
+        VkDeviceSize start = alignUp(slot.head, alignment);
+        if (slot.current.buffer == VK_NULL_HANDLE || start + size > slot.current.size)
+        {
+            // Out of room: continue in a buffer twice the size, keeping the full one for this frame.
+            const VkDeviceSize bytes = std::min(std::max(nextPowerOfTwo(size), slot.current.size * 2), m_maxBufferBytes);
+            Buffer next;
+            if (!createBuffer(bytes, next))
+            {
+                ENGINE_LOG_ERROR("[UploadRing] Failed to grow slot %u to %llu bytes", m_slot, static_cast<unsigned long long>(bytes));
+                return a;
+            }
+            if (slot.current.buffer != VK_NULL_HANDLE)
+                slot.retired.push_back(slot.current);
+            slot.current = next;
+            slot.head = 0;
+            start = 0;
+        }
+
+        slot.used += (start - slot.head) + size;
+        slot.head = start + size;
+
+        a.buffer = slot.current.buffer;
+        a.offset = start;
+        a.size = size;
+        a.mapped = static_cast<uint8_t *>(slot.current.memory.mapped) + start;
+        return a;
+    }
+
+    VkDeviceSize UploadRing::getCapacityBytes() const
+    {
+        VkDeviceSize bytes = 0;
+        for (const Slot &slot : m_slots)
+        {
+            bytes += slot.current.size;
+            for (const Buffer &b : slot.retired)
+                bytes += b.size;
+        }
+        return bytes;
+    }
+
+    VkDeviceSize UploadRing::getUsedBytes() const
+    {
+        return m_slots.empty() ? 0 : m_slots[m_slot].used;
+    }
+
+} // namespace Engine
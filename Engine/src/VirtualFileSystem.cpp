@@ -0,0 +1,325 @@
+#include "utils/VirtualFileSystem.h"
+#include "assets/PackFormat.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <system_error>
+
+namespace Engine
+{
+    namespace
+    {
+        struct MountedPack
+        {
+            std::string path;
+            MappedFile file;
+            const pack::PackEntry *entries = nullptr; // sorted by pathHash
+            uint32_t entryCount = 0;
+            const char *strings = nullptr;
+            uint64_t stringsSize = 0;
+
+            const uint8_t *bytes() const { return reinterpret_cast<const uint8_t *>(file.data()); }
+            const char *entryPath(const pack::PackEntry &e) const { return strings + e.pathOffset; }
+
+            const pack::PackEntry *find(const std::string &normalized) const
+            {
+                const uint64_t hash = pack::HashPath(normalized);
+                const pack::PackEntry *end = entries + entryCount;
+                const pack::PackEntry *it = std::lower_bound(entries, end, hash, [](const pack::PackEntry &e, uint64_t h)
+                                                             { return e.pathHash < h; });
+                for (; it != end && it->pathHash == hash; ++it)
+                {
+                    if (normalized == entryPath(*it))
+                        return it;
+                }
+                return nullptr;
+            }
+        };
+
+        struct MountTable
+        {
+            std::shared_mutex mutex;
+            std::vector<std::unique_ptr<MountedPack>> packs; // later ones first in lookups
+        };
+
+        MountTable &mounts()
+        {
+            static MountTable table;
+            return table;
+        }
+
+        // LZ4 block format: sequences of literals and back-references, the last one literals only.
+        bool DecompressLZ4Block(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize)
+        {
+            const uint8_t *ip = src;
+            const uint8_t *const iend = src + srcSize;
+            uint8_t *op = dst;
+            uint8_t *const oend = dst + dstSize;
+
+            auto readLength = [&](size_t &length) -> bool
+            {
+                uint8_t b = 255;
+                while (b == 255)
+                {
+                    if (ip >= iend)
+                        return false;
+                    b = *ip++;
+                    length += b;
+                }
+                return true;
+            };
+
+            while (ip < iend)
+            {
+                const uint8_t token = *ip++;
+
+                size_t literals = token >> 4;
+                if (literals == 15 && !readLength(literals))
+                    return false;
+                if (literals > static_cast<size_t>(iend - ip) || literals > static_cast<size_t>(oend - op))
+                    return false;
+                std::memcpy(op, ip, literals);
+                ip += literals;
+                op += literals;
+                if (ip == iend)
+                    break; // the last sequence has no match
+
+                if (iend - ip < 2)
+                    return false;
+                const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+                ip += 2;
+                if (offset == 0 || offset > static_cast<size_t>(op - dst))
+                    return false;
+
+                size_t match = token & 15u;
+                if (match == 15 && !readLength(match))
+                    return false;
+                match += 4;
+                if (match > static_cast<size_t>(oend - op))
+                    return false;
+
+                // Byte by byte: the match may overlap what it writes
+                const uint8_t *from = op - offset;
+                for (size_t i = 0; i < match; ++i)
+                    op[i] = from[i];
+                op += match;
+            }
+            return op == oend;
+        }
+    } // namespace
+
+    std::string VirtualFileSystem::normalizePath(const std::string &path)
+    {
+        std::string out = path;
+        std::replace(out.begin(), out.end(), '\\', '/');
+        while (out.rfind("./", 0) == 0)
+            out.erase(0, 2);
+        return out;
+    }
+
+    bool VirtualFileSystem::mountPack(const std::string &packPath)
+    {
+        auto mounted = std::make_unique<MountedPack>();
+        mounted->path = packPath;
+        if (!mounted->file.open(packPath))
+        {
+            ENGINE_LOG_ERROR("[VFS] Cannot map pack %s", packPath.c_str());
+            return false;
+        }
+
+        // Validate the header, the tables and every entry's range once, so reads need no checks
+        const uint8_t *base = mounted->bytes();
+        const uint64_t fileSize = mounted->file.size();
+        pack::PackHeader header{};
+        if (fileSize < sizeof(header))
+        {
+            ENGINE_LOG_ERROR("[VFS] %s is too small to be a pack", packPath.c_str());
+            return false;
+        }
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, "SPAK", 4) != 0 || header.version != pack::kPackVersion)
+        {
+            ENGINE_LOG_ERROR("[VFS] %s is not a version %u pack", packPath.c_str(), pack::kPackVersion);
+            return false;
+        }
+        const uint64_t tocBytes = uint64_t(header.entryCount) * sizeof(pack::PackEntry);
+        if (header.tocOffset % alignof(uint64_t) != 0 || header.tocOffset > fileSize || tocBytes > fileSize - header.tocOffset ||
+            header.stringTableOffset > fileSize || header.stringTableSize > fileSize - header.stringTableOffset ||
+            (header.stringTableSize > 0 && base[header.stringTableOffset + header.stringTableSize - 1] != 0))
+        {
+            ENGINE_LOG_ERROR("[VFS] %s has a corrupt table of contents", packPath.c_str());
+            return false;
+        }
+
+        mounted->entries = reinterpret_cast<const pack::PackEntry *>(base + header.tocOffset);
+        mounted->entryCount = header.entryCount;
+        mounted->strings = reinterpret_cast<const char *>(base + header.stringTableOffset);
+        mounted->stringsSize = header.stringTableSize;
+        for (uint32_t i = 0; i < header.entryCount; ++i)
+        {
+            const pack::PackEntry &e = mounted->entries[i];
+            const bool compressionOk = e.compression == uint32_t(pack::PackCompression::None) ? e.storedSize == e.size
+                                                                                               : e.compression == uint32_t(pack::PackCompression::LZ4);
+            if (e.offset > fileSize || e.storedSize > fileSize - e.offset || e.pathOffset >= header.stringTableSize ||
+                !compressionOk || (i > 0 && mounted->entries[i - 1].pathHash > e.pathHash))
+            {
+                ENGINE_LOG_ERROR("[VFS] %s: entry %u is corrupt", packPath.c_str(), i);
+                return false;
+            }
+        }
+
+        MountTable &table = mounts();
+        std::unique_lock lock(table.mutex);
+        table.packs.insert(table.packs.begin(), std::move(mounted));
+        ENGINE_LOG_INFO("[VFS] Mounted %s (%u files)", packPath.c_str(), header.entryCount);
+        return true;
+    }
+
+    void VirtualFileSystem::unmountAll()
+    {
+        MountTable &table = mounts();
+        std::unique_lock lock(table.mutex);
+        table.packs.clear();
+    }
+
+    uint32_t VirtualFileSystem::getMountedPackCount()
+    {
+        MountTable &table = mounts();
+        std::shared_lock lock(table.mutex);
+        return static_cast<uint32_t>(table.packs.size());
+    }
+
+    bool VirtualFileSystem::exists(const std::string &path)
+    {
+        const std::string normalized = normalizePath(path);
+        {
+            MountTable &table = mounts();
+            std::shared_lock lock(table.mutex);
+            for (const auto &p : table.packs)
+            {
+                if (p->find(normalized))
+                    return true;
+            }
+        }
+        std::error_code ec;
+        return std::filesystem::is_regular_file(normalized, ec);
+    }
+
+    bool VirtualFileSystem::read(const std::string &path, FileData &out)
+    {
+        out.reset();
+        const std::string normalized = normalizePath(path);
+        {
+            MountTable &table = mounts();
+            std::shared_lock lock(table.mutex);
+            for (const auto &p : table.packs)
+            {
+                const pack::PackEntry *e = p->find(normalized);
+                if (!e)
+                    continue;
+
+                const uint8_t *stored = p->bytes() + e->offset;
+                if (e->compression == uint32_t(pack::PackCompression::None))
+                {
+                    out.m_data = stored;
+                    out.m_size = static_cast<size_t>(e->size);
+                    return true;
+                }
+
+                out.m_owned.resize(static_cast<size_t>(e->size));
+                if (!DecompressLZ4Block(stored, static_cast<size_t>(e->storedSize), out.m_owned.data(), out.m_owned.size()))
+                {
+                    ENGINE_LOG_ERROR("[VFS] %s: corrupt compressed data for %s", p->path.c_str(), normalized.c_str());
+                    out.reset();
+                    return false;
+                }
+                out.m_data = out.m_owned.data();
+                out.m_size = out.m_owned.size();
+                return true;
+            }
+        }
+
+        if (out.m_file.open(normalized))
+        {
+            out.m_data = reinterpret_cast<const uint8_t *>(out.m_file.data());
+            out.m_size = out.m_file.size();
+            return true;
+        }
+
+        // Not mappable: read it
+        std::ifstream in(normalized, std::ios::binary | std::ios::ate);
+        if (!in.is_open())
+            return false;
+        const std::streamsize fileSize = in.tellg();
+        if (fileSize < 0)
+            return false;
+        in.seekg(0, std::ios::beg);
+        out.m_owned.resize(static_cast<size_t>(fileSize));
+        if (fileSize > 0 && !in.read(reinterpret_cast<char *>(out.m_owned.data()), fileSize))
+        {
+            out.reset();
+            return false;
+        }
+        out.m_data = out.m_owned.data();
+        out.m_size = out.m_owned.size();
+        return true;
+    }
+
+    std::string VirtualFileSystem::readText(const std::string &path)
+    {
+        FileData file;
+        if (!read(path, file) || file.empty())
+            return std::string();
+        return std::string(reinterpret_cast<const char *>(file.data()), file.size());
+    }
+
+    std::vector<std::string> VirtualFileSystem::list(const std::string &directory, const std::string &extension)
+    {
+        std::string dir = normalizePath(directory);
+        while (!dir.empty() && dir.back() == '/')
+            dir.pop_back();
+        const std::string prefix = dir.empty() ? std::string() : dir + "/";
+
+        auto matches = [&](const std::string &path)
+        {
+            return path.size() > prefix.size() + extension.size() && path.compare(0, prefix.size(), prefix) == 0 &&
+                   path.find('/', prefix.size()) == std::string::npos &&
+                   path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+        };
+
+        std::set<std::string> found;
+        {
+            MountTable &table = mounts();
+            std::shared_lock lock(table.mutex);
+            for (const auto &p : table.packs)
+            {
+                for (uint32_t i = 0; i < p->entryCount; ++i)
+                {
+                    std::string path = p->entryPath(p->entries[i]);
+                    if (matches(path))
+                        found.insert(std::move(path));
+                }
+            }
+        }
+
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(dir.empty() ? "." : dir, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (!it->is_regular_file(ec))
+                continue;
+            std::string path = prefix + it->path().filename().generic_string();
+            if (matches(path))
+                found.insert(std::move(path));
+        }
+
+        return std::vector<std::string>(found.begin(), found.end());
+    }
+
+} // namespace Engine
@@ -2,8 +2,11 @@
 #include "Engine/Window.h"
 #include "Engine/SwapChain.h"
 #include "utils/VulkanValidationUtils.h"
+#include "utils/MemoryAllocator.h"
+#include "utils/PipelineCache.h"
+#include "utils/DeletionQueue.h"
+#include "utils/Log.h"
 #include <GLFW/glfw3.h> // for glfwCreateWindowSurface
-#include <iostream>
 #include <vector>
 #include <set>
 #include <stdexcept>
@@ -33,6 +36,10 @@ namespace Engine
         createSurface();
         pickPhysicalDeviceForPresentation();
         createLogicalDevice();
+        m_MemoryAllocator = std::make_unique<MemoryAllocator>(m_Device, m_SelectedDeviceInfo.physicalDevice);
+        m_MemoryAllocator->setMemoryBudgetEnabled(m_MemoryBudget);
+        m_PipelineCache = std::make_unique<PipelineCache>(m_Device, m_SelectedDeviceInfo.physicalDevice);
+        m_DeletionQueue = std::make_unique<DeletionQueue>(m_Device);
 
         m_SwapChain = std::make_unique<SwapChain>(
             m_Device,
@@ -55,6 +62,18 @@ namespace Engine
             vkDeviceWaitIdle(m_Device);
         }
 
+        // Keep what the driver compiled this run for the next one.
+        if (m_PipelineCache)
+        {
+            m_PipelineCache->save();
+            m_PipelineCache.reset();
+        }
+
+        // The device is idle: destroy what is still queued, then every buffer and image is gone and
+        // the allocator's blocks can go.
+        m_DeletionQueue.reset();
+        m_MemoryAllocator.reset();
+
         // Destroy device first (this will free device-local resources)
         if (m_Device != VK_NULL_HANDLE)
         {
@@ -143,7 +162,15 @@ namespace Engine
         appInfo.applicationVersion = VK_MAKE_VERSION(0, 1, 0);
         appInfo.pEngineName = "MyEngine";
         appInfo.engineVersion = VK_MAKE_VERSION(0, 1, 0);
-        appInfo.apiVersion = VK_API_VERSION_1_0;
+
+        // Vulkan 1.2 when the loader has it (descriptor indexing, see createLogicalDevice), else 1.0.
+        uint32_t loaderVersion = VK_API_VERSION_1_0;
+        auto enumerateVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+            vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion"));
+        if (enumerateVersion && enumerateVersion(&loaderVersion) != VK_SUCCESS)
+            loaderVersion = VK_API_VERSION_1_0;
+        m_InstanceApiVersion = (loaderVersion >= VK_API_VERSION_1_2) ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
+        appInfo.apiVersion = m_InstanceApiVersion;
 
         VkInstanceCreateInfo ci{};
         ci.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -195,7 +222,7 @@ namespace Engine
             populateDebugMessengerCreateInfo(debugCreateInfo);
             if (CreateDebugUtilsMessengerEXT(m_Instance, &debugCreateInfo, nullptr, &m_DebugMessenger) != VK_SUCCESS)
             {
-                std::cerr << "Warning: failed to set up debug messenger!" << std::endl;
+                ENGINE_LOG_WARN("Warning: failed to set up debug messenger!");
                 m_DebugMessenger = VK_NULL_HANDLE;
             }
         }
@@ -214,7 +241,7 @@ namespace Engine
         {
             throw std::runtime_error("Failed to create window surface via GLFW");
         }
-        std::cout << "Vulkan surface created successfully." << std::endl;
+        ENGINE_LOG_INFO("Vulkan surface created successfully.");
     }
 
     void VulkanContext::pickPhysicalDeviceForPresentation()
@@ -279,6 +306,21 @@ namespace Engine
             ++i;
         }
 
+        // Queues beside the graphics one: the first transfer-only family that can copy any image
+        // region (texel granularity 1), and the first compute family without graphics.
+        for (uint32_t f = 0; f < queueFamilyCount; ++f)
+        {
+            const VkQueueFamilyProperties &qf = queueFamilies[f];
+            if (qf.queueCount == 0 || (qf.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                continue;
+            const VkExtent3D &granularity = qf.minImageTransferGranularity;
+            if (!indices.transferFamily && (qf.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(qf.queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+                granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+                indices.transferFamily = f;
+            if (!indices.computeFamily && (qf.queueFlags & VK_QUEUE_COMPUTE_BIT))
+                indices.computeFamily = f;
+        }
+
         return indices;
     }
 
@@ -325,6 +367,10 @@ namespace Engine
         std::set<uint32_t> uniqueQueueFamilies;
         uniqueQueueFamilies.insert(indices.graphicsFamily.value());
         uniqueQueueFamilies.insert(indices.presentFamily.value());
+        if (indices.transferFamily)
+            uniqueQueueFamilies.insert(indices.transferFamily.value());
+        if (indices.computeFamily)
+            uniqueQueueFamilies.insert(indices.computeFamily.value());
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -341,15 +387,182 @@ namespace Engine
         VkPhysicalDeviceFeatures deviceFeatures{};
         // deviceFeatures.samplerAnisotropy = VK_TRUE; // enable if needed
 
+        // Block-compressed textures (.smodel V8, GltfToSmodel --compress-textures); without them
+        // TextureAsset decodes the blocks on the CPU.
+        VkPhysicalDeviceFeatures supportedFeatures{};
+        vkGetPhysicalDeviceFeatures(m_SelectedDeviceInfo.physicalDevice, &supportedFeatures);
+        deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+        // Per-pass shader invocation counts (Renderer::setPipelineStatistics())
+        deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+        m_PipelineStatistics = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
+        // Descriptor indexing (Vulkan 1.2): one partially bound, runtime-sized texture array indexed
+        // from push constants. Enabled when the instance and the device both support it.
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        std::vector<const char *> enabledExtensions = deviceExtensions;
+        bool vulkan12 = false;
+        m_DescriptorIndexing = false;
+        m_DrawIndirectCount = false;
+        m_MeshShaders = false;
+        m_PresentWait = false;
+        m_MemoryBudget = false;
+        m_CalibratedTimestamps = false;
+#if defined(VK_EXT_mesh_shader)
+        VkPhysicalDeviceMeshShaderFeaturesEXT meshFeatures{};
+        meshFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+#endif
+#if defined(VK_KHR_present_wait)
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+#endif
+        if (m_InstanceApiVersion >= VK_API_VERSION_1_2)
+        {
+            VkPhysicalDeviceProperties props{};
+            vkGetPhysicalDeviceProperties(m_SelectedDeviceInfo.physicalDevice, &props);
+            if (props.apiVersion >= VK_API_VERSION_1_2)
+            {
+                vulkan12 = true;
+                VkPhysicalDeviceVulkan12Features supported12{};
+                supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+                VkPhysicalDeviceFeatures2 supported{};
+                supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                supported.pNext = &supported12;
+                uint32_t extCount = 0;
+                vkEnumerateDeviceExtensionProperties(m_SelectedDeviceInfo.physicalDevice, nullptr, &extCount, nullptr);
+                std::vector<VkExtensionProperties> exts(extCount);
+                vkEnumerateDeviceExtensionProperties(m_SelectedDeviceInfo.physicalDevice, nullptr, &extCount, exts.data());
+                auto hasExtension = [&exts](const char *name)
+                {
+                    return std::any_of(exts.begin(), exts.end(), [name](const VkExtensionProperties &e)
+                                       { return std::strcmp(e.extensionName, name) == 0; });
+                };
+                // Optional feature structs are chained behind supported12 (query) and features12 (enable)
+                void **supportedTail = &supported12.pNext;
+#if defined(VK_EXT_mesh_shader)
+                VkPhysicalDeviceMeshShaderFeaturesEXT supportedMesh{};
+                supportedMesh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+                const bool hasMeshExt = hasExtension(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+                if (hasMeshExt)
+                {
+                    *supportedTail = &supportedMesh;
+                    supportedTail = &supportedMesh.pNext;
+                }
+#endif
+#if defined(VK_KHR_present_wait)
+                VkPhysicalDevicePresentIdFeaturesKHR supportedPresentId{};
+                supportedPresentId.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+                VkPhysicalDevicePresentWaitFeaturesKHR supportedPresentWait{};
+                supportedPresentWait.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+                const bool hasPresentWaitExt = hasExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+                                               hasExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                if (hasPresentWaitExt)
+                {
+                    *supportedTail = &supportedPresentId;
+                    supportedPresentId.pNext = &supportedPresentWait;
+                    supportedTail = &supportedPresentWait.pNext;
+                }
+#endif
+                vkGetPhysicalDeviceFeatures2(m_SelectedDeviceInfo.physicalDevice, &supported);
+
+                if (supported.features.shaderSampledImageArrayDynamicIndexing && supported12.descriptorIndexing &&
+                    supported12.runtimeDescriptorArray && supported12.descriptorBindingPartiallyBound)
+                {
+                    deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+                    features12.descriptorIndexing = VK_TRUE;
+                    features12.runtimeDescriptorArray = VK_TRUE;
+                    features12.descriptorBindingPartiallyBound = VK_TRUE;
+                    m_DescriptorIndexing = true;
+                }
+
+                // GPU-built draw lists: meshlet culling emits a variable number of draws per primitive
+                // (count from a buffer) with the instance in firstInstance.
+                if (supported12.drawIndirectCount && supported.features.drawIndirectFirstInstance)
+                {
+                    features12.drawIndirectCount = VK_TRUE;
+                    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+                    m_DrawIndirectCount = true;
+                }
+
+                void **enabledTail = &features12.pNext;
+#if defined(VK_EXT_mesh_shader)
+                // Mesh shaders (task + mesh) for the meshlet draw path
+                if (hasMeshExt && supportedMesh.taskShader && supportedMesh.meshShader)
+                {
+                    meshFeatures.taskShader = VK_TRUE;
+                    meshFeatures.meshShader = VK_TRUE;
+                    *enabledTail = &meshFeatures;
+                    enabledTail = &meshFeatures.pNext;
+                    enabledExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+                    m_MeshShaders = true;
+                }
+#endif
+#if defined(VK_KHR_present_wait)
+                // Present ids and vkWaitForPresentKHR for the renderer's low-latency frame pacing
+                if (hasPresentWaitExt && supportedPresentId.presentId && supportedPresentWait.presentWait)
+                {
+                    presentIdFeatures.presentId = VK_TRUE;
+                    presentWaitFeatures.presentWait = VK_TRUE;
+                    *enabledTail = &presentIdFeatures;
+                    presentIdFeatures.pNext = &presentWaitFeatures;
+                    enabledTail = &presentWaitFeatures.pNext;
+                    enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                    enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                    m_PresentWait = true;
+                }
+#endif
+#if defined(VK_EXT_memory_budget)
+                // Driver heap budget and usage for the memory overlay (MemoryAllocator::getHeapBudgets())
+                if (hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+                {
+                    enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+                    m_MemoryBudget = true;
+                }
+#endif
+#if defined(VK_EXT_calibrated_timestamps)
+                // GPU timestamps placed on the CPU clock (GpuProfiler, trace captures): needs the device
+                // domain and the host clock Profiler::now() reads
+                if (hasExtension(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+                {
+                    auto getDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+                        vkGetInstanceProcAddr(m_Instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+                    uint32_t domainCount = 0;
+                    std::vector<VkTimeDomainEXT> domains;
+                    if (getDomains && getDomains(m_SelectedDeviceInfo.physicalDevice, &domainCount, nullptr) == VK_SUCCESS)
+                    {
+                        domains.resize(domainCount);
+                        getDomains(m_SelectedDeviceInfo.physicalDevice, &domainCount, domains.data());
+                        domains.resize(domainCount);
+                    }
+#if defined(_WIN32)
+                    const VkTimeDomainEXT hostDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+                    const VkTimeDomainEXT hostDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+                    const bool hasDevice = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end();
+                    const bool hasHost = std::find(domains.begin(), domains.end(), hostDomain) != domains.end();
+                    if (hasDevice && hasHost)
+                    {
+                        enabledExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+                        m_CalibratedTimestamps = true;
+                    }
+                }
+#endif
+            }
+        }
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = vulkan12 ? &features12 : nullptr;
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
         createInfo.pEnabledFeatures = &deviceFeatures;
 
-        // Device extensions (swapchain)
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        // Device extensions (swapchain, optional mesh shaders)
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
         // No device layers (deprecated), validation layers enabled at instance level if desired
         createInfo.enabledLayerCount = 0;
@@ -359,12 +572,21 @@ namespace Engine
         {
             throw std::runtime_error("Failed to create logical device");
         }
-        std::cout << "Logical device created\n";
+        ENGINE_LOG_INFO("Logical device created (descriptor indexing: %s, draw indirect count: %s, mesh shaders: %s, present wait: %s, memory budget: %s, calibrated timestamps: %s)",
+                        m_DescriptorIndexing ? "on" : "off", m_DrawIndirectCount ? "on" : "off", m_MeshShaders ? "on" : "off",
+                        m_PresentWait ? "on" : "off", m_MemoryBudget ? "on" : "off", m_CalibratedTimestamps ? "on" : "off");
 
         // Retrieve queue handles
         vkGetDeviceQueue(m_Device, indices.graphicsFamily.value(), 0, &m_GraphicsQueue);
         vkGetDeviceQueue(m_Device, indices.presentFamily.value(), 0, &m_PresentQueue);
-
-        std::cout << "Graphics queue and Present queue retrieved\n";
+        m_TransferQueue = m_GraphicsQueue;
+        if (indices.transferFamily)
+            vkGetDeviceQueue(m_Device, indices.transferFamily.value(), 0, &m_TransferQueue);
+        m_ComputeQueue = m_GraphicsQueue;
+        if (indices.computeFamily)
+            vkGetDeviceQueue(m_Device, indices.computeFamily.value(), 0, &m_ComputeQueue);
+
+        ENGINE_LOG_INFO("Queues retrieved (dedicated transfer: %s, async compute: %s)",
+                        indices.transferFamily ? "yes" : "no", indices.computeFamily ? "yes" : "no");
     }
 }
\ No newline at end of file
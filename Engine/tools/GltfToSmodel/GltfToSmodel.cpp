@@ -1,20 +1,36 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/DefaultIOSystem.h>
 
 #include <cstdint>
+#include <cstdlib>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
 
 // Your engine format header (adjust include path if needed)
 #include "assets/ModelFormat.h"
+#include "common/MeshOptimize.h"
+#include "common/TextureCompress.h"
+#include "common/MeshCompress.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "ThirdParty/Stb/stb_image.h"
 
 #ifndef AI_MATKEY_GLTF_ALPHACUTOFF
 // Older Assimp doesn't expose this macro, but the property exists in glTF materials.
@@ -141,6 +157,112 @@ struct VertexPNTTJW
 };
 static_assert(sizeof(VertexPNTTJW) == 72, "VertexPNTTJW expected to be 72 bytes");
 
+// ------------------------------------------------------------
+// Compact vertex layout (--compact-vertices, sm::VTX_COMPACT)
+// ------------------------------------------------------------
+// Positions are unorm16 over the mesh AABB's longest axis from aabbMin (the runtime
+// dequantizes with MeshAsset::getPositionDequant()), normal and tangent octahedral snorm16,
+// UVs half floats, joints u8 and weights unorm8 summing to 255.
+struct VertexCompact
+{
+    uint16_t pos[4]; // w: tangent handedness
+    int16_t normalTangent[4];
+    uint16_t uv0[2];
+    uint8_t joints[4];
+    uint8_t weights[4];
+};
+static_assert(sizeof(VertexCompact) == sm::kCompactVertexStride, "VertexCompact must match smodel::kCompactVertexStride");
+
+static uint16_t FloatToHalf(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    const uint32_t sign = (x >> 16) & 0x8000u;
+    const uint32_t absBits = x & 0x7FFFFFFFu;
+    if (absBits >= 0x7F800000u) // inf / nan
+        return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+    if (absBits >= 0x477FF000u) // rounds past the largest half
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    if (absBits < 0x38800000u) // subnormal half (or zero)
+    {
+        float a;
+        std::memcpy(&a, &absBits, sizeof(a));
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::lround(a * 16777216.0f))); // 2^24
+    }
+    // Normal: rebias the exponent, round the mantissa to nearest even.
+    const uint32_t rounded = absBits + 0x0FFFu + ((absBits >> 13) & 1u);
+    return static_cast<uint16_t>(sign | ((rounded - 0x38000000u) >> 13));
+}
+
+static int16_t ToSnorm16(float v)
+{
+    return static_cast<int16_t>(std::lround(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f));
+}
+
+// Unit vector to [-1, 1]^2 (smodel.vert octDecode).
+static void OctEncode(const float n[3], int16_t out[2])
+{
+    const float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    float x = (l1 > 0.0f) ? n[0] / l1 : 0.0f;
+    float y = (l1 > 0.0f) ? n[1] / l1 : 0.0f;
+    if (n[2] < 0.0f)
+    {
+        const float ox = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float oy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = ox;
+        y = oy;
+    }
+    out[0] = ToSnorm16(x);
+    out[1] = ToSnorm16(y);
+}
+
+// False when a joint index does not fit 8 bits (the mesh then stays VertexPNTTJW).
+static bool EncodeCompact(const std::vector<VertexPNTTJW> &in, const float aabbMin[3], const float aabbMax[3],
+                          std::vector<VertexCompact> &out)
+{
+    float span = 0.0f;
+    for (int a = 0; a < 3; ++a)
+        span = std::max(span, aabbMax[a] - aabbMin[a]);
+    const float invSpan = (span > 0.0f) ? 1.0f / span : 0.0f;
+
+    out.resize(in.size());
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        const VertexPNTTJW &v = in[i];
+        VertexCompact &c = out[i];
+        for (int a = 0; a < 3; ++a)
+        {
+            const float t = std::min(std::max((v.pos[a] - aabbMin[a]) * invSpan, 0.0f), 1.0f);
+            c.pos[a] = static_cast<uint16_t>(std::lround(t * 65535.0f));
+        }
+        c.pos[3] = (v.tangent[3] < 0.0f) ? 0u : 65535u;
+
+        OctEncode(v.normal, &c.normalTangent[0]);
+        OctEncode(v.tangent, &c.normalTangent[2]);
+
+        c.uv0[0] = FloatToHalf(v.uv0[0]);
+        c.uv0[1] = FloatToHalf(v.uv0[1]);
+
+        // Weights rounded to 1/255; the largest absorbs the rounding so they still sum to 1.
+        int sum = 0;
+        int largest = 0;
+        for (int j = 0; j < 4; ++j)
+        {
+            if (v.joints[j] > 255u)
+                return false;
+            c.joints[j] = static_cast<uint8_t>(v.joints[j]);
+            const float w = std::min(std::max(v.weights[j], 0.0f), 1.0f);
+            c.weights[j] = static_cast<uint8_t>(std::lround(w * 255.0f));
+            sum += c.weights[j];
+            if (v.weights[j] > v.weights[largest])
+                largest = j;
+        }
+        if (sum > 0)
+            c.weights[largest] = static_cast<uint8_t>(std::min(std::max(int(c.weights[largest]) + 255 - sum, 0), 255));
+    }
+    return true;
+}
+
 // ------------------------------------------------------------
 // AABB compute
 // ------------------------------------------------------------
@@ -169,6 +291,344 @@ static void ComputeAABB(const std::vector<VertexPNTTJW> &v, float outMin[3], flo
     }
 }
 
+// ------------------------------------------------------------
+// Mesh LODs: vertex clustering
+// ------------------------------------------------------------
+// Each LOD snaps vertices to a grid over the mesh AABB (kMeshLodBaseCells cells along the
+// longest axis, halved per level) and keeps one existing vertex per cell, the one nearest the
+// cell's mean position. Triangles that collapse are dropped. Only index data changes: the
+// LOD shares the vertex buffer, including joints and weights.
+static constexpr uint32_t kMeshLodLevels = 3;      // coarser levels after the full mesh
+static constexpr uint32_t kMeshLodBaseCells = 48;  // grid resolution of the first LOD
+static constexpr uint32_t kMeshLodMinTriangles = 16;
+static constexpr float kMeshLodMaxRatio = 0.8f;    // a level must drop at least 20% of the triangles
+
+static std::vector<uint32_t> SimplifyByClustering(const std::vector<VertexPNTTJW> &vertices,
+                                                  const std::vector<uint32_t> &indices,
+                                                  const float aabbMin[3], const float aabbMax[3],
+                                                  uint32_t cellsOnLongestAxis)
+{
+    std::vector<uint32_t> out;
+    if (vertices.empty() || indices.size() < 3 || cellsOnLongestAxis == 0)
+        return out;
+
+    float extent = 0.0f;
+    for (int a = 0; a < 3; ++a)
+        extent = std::max(extent, aabbMax[a] - aabbMin[a]);
+    if (extent <= 0.0f)
+        return out;
+    const float cellSize = extent / static_cast<float>(cellsOnLongestAxis);
+
+    auto cellOf = [&](const VertexPNTTJW &v)
+    {
+        uint64_t key = 0;
+        for (int a = 0; a < 3; ++a)
+        {
+            const float t = (v.pos[a] - aabbMin[a]) / cellSize;
+            const uint64_t c = static_cast<uint64_t>(std::min(std::max(t, 0.0f), float(cellsOnLongestAxis)));
+            key = (key << 21) | (c & 0x1FFFFFu);
+        }
+        return key;
+    };
+
+    // Cell of every referenced vertex and the cells' mean positions.
+    struct Cell
+    {
+        double sum[3] = {0.0, 0.0, 0.0};
+        uint32_t count = 0;
+        uint32_t rep = ~0u;
+        float repDist2 = 0.0f;
+    };
+    std::unordered_map<uint64_t, uint32_t> cellIndex;
+    std::vector<Cell> cells;
+    std::vector<uint32_t> vertexCell(vertices.size(), ~0u);
+    for (uint32_t idx : indices)
+    {
+        if (idx >= vertices.size() || vertexCell[idx] != ~0u)
+            continue;
+        const auto found = cellIndex.emplace(cellOf(vertices[idx]), static_cast<uint32_t>(cells.size()));
+        if (found.second)
+            cells.emplace_back();
+        Cell &c = cells[found.first->second];
+        for (int a = 0; a < 3; ++a)
+            c.sum[a] += vertices[idx].pos[a];
+        ++c.count;
+        vertexCell[idx] = found.first->second;
+    }
+
+    for (uint32_t vi = 0; vi < vertices.size(); ++vi)
+    {
+        if (vertexCell[vi] == ~0u)
+            continue;
+        Cell &c = cells[vertexCell[vi]];
+        float d2 = 0.0f;
+        for (int a = 0; a < 3; ++a)
+        {
+            const float d = vertices[vi].pos[a] - static_cast<float>(c.sum[a] / c.count);
+            d2 += d * d;
+        }
+        if (c.rep == ~0u || d2 < c.repDist2)
+        {
+            c.rep = vi;
+            c.repDist2 = d2;
+        }
+    }
+
+    // Remap, drop collapsed and repeated triangles (the latter only while indices fit 21 bits).
+    const bool dedupe = vertices.size() <= 0x1FFFFFu;
+    std::unordered_set<uint64_t> seen;
+    out.reserve(indices.size() / 2);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        uint32_t tri[3];
+        bool valid = true;
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t idx = indices[t + k];
+            valid = valid && idx < vertices.size();
+            tri[k] = valid ? cells[vertexCell[idx]].rep : 0u;
+        }
+        if (!valid || tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2])
+            continue;
+
+        // Same triangle with the same winding, whatever vertex it starts at.
+        const int first = (tri[0] < tri[1]) ? ((tri[0] < tri[2]) ? 0 : 2) : ((tri[1] < tri[2]) ? 1 : 2);
+        const uint64_t a = tri[first], b = tri[(first + 1) % 3], c = tri[(first + 2) % 3];
+        if (dedupe && !seen.insert((a << 42) | (b << 21) | c).second)
+            continue;
+
+        out.insert(out.end(), tri, tri + 3);
+    }
+    return out;
+}
+
+// ------------------------------------------------------------
+// Meshlets
+// ------------------------------------------------------------
+// Greedy clustering of a primitive's triangles: each meshlet grows by the adjacent triangle that
+// adds the fewest new vertices, and starts over from the next unused triangle when it is full or
+// has no unused neighbour left. The primitive's index range is rewritten in meshlet order so each
+// meshlet is also a contiguous range of the index buffer.
+static void ComputeMeshletBounds(const std::vector<VertexPNTTJW> &vertices, const std::vector<uint32_t> &meshletVertices,
+                                 const std::vector<uint8_t> &meshletTriangles, sm::SModelMeshletRecord &m)
+{
+    float bmin[3] = {vertices[meshletVertices[0]].pos[0], vertices[meshletVertices[0]].pos[1], vertices[meshletVertices[0]].pos[2]};
+    float bmax[3] = {bmin[0], bmin[1], bmin[2]};
+    for (uint32_t vi : meshletVertices)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            bmin[a] = std::min(bmin[a], vertices[vi].pos[a]);
+            bmax[a] = std::max(bmax[a], vertices[vi].pos[a]);
+        }
+    }
+
+    float radius2 = 0.0f;
+    for (int a = 0; a < 3; ++a)
+        m.center[a] = 0.5f * (bmin[a] + bmax[a]);
+    for (uint32_t vi : meshletVertices)
+    {
+        float d2 = 0.0f;
+        for (int a = 0; a < 3; ++a)
+        {
+            const float d = vertices[vi].pos[a] - m.center[a];
+            d2 += d * d;
+        }
+        radius2 = std::max(radius2, d2);
+    }
+    m.radius = std::sqrt(radius2);
+
+    // Normal cone: the axis averages the face normals; the apex sits behind the cluster so the
+    // cone contains every triangle's plane (same construction as meshoptimizer's cluster bounds).
+    std::vector<float> normals;
+    normals.reserve(meshletTriangles.size());
+    float axis[3] = {0.0f, 0.0f, 0.0f};
+    for (size_t t = 0; t + 2 < meshletTriangles.size(); t += 3)
+    {
+        const float *p0 = vertices[meshletVertices[meshletTriangles[t + 0]]].pos;
+        const float *p1 = vertices[meshletVertices[meshletTriangles[t + 1]]].pos;
+        const float *p2 = vertices[meshletVertices[meshletTriangles[t + 2]]].pos;
+        const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len <= 1e-20f)
+            continue; // degenerate: no facing
+        for (int a = 0; a < 3; ++a)
+        {
+            n[a] /= len;
+            axis[a] += n[a];
+        }
+        normals.insert(normals.end(), {n[0], n[1], n[2], p0[0], p0[1], p0[2]});
+    }
+
+    for (int a = 0; a < 3; ++a)
+    {
+        m.coneApex[a] = m.center[a];
+        m.coneAxis[a] = 0.0f;
+    }
+    m.coneCutoff = 1.0f;
+
+    const float axisLen = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (normals.empty() || axisLen <= 1e-6f)
+        return;
+    for (int a = 0; a < 3; ++a)
+        axis[a] /= axisLen;
+
+    float minDot = 1.0f;
+    for (size_t i = 0; i < normals.size(); i += 6)
+        minDot = std::min(minDot, normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]);
+    if (minDot <= 0.1f)
+        return; // spread over (nearly) a hemisphere: some triangle always faces the eye
+
+    float maxT = 0.0f;
+    for (size_t i = 0; i < normals.size(); i += 6)
+    {
+        const float *n = &normals[i];
+        const float *p0 = &normals[i + 3];
+        const float dc = (m.center[0] - p0[0]) * n[0] + (m.center[1] - p0[1]) * n[1] + (m.center[2] - p0[2]) * n[2];
+        const float dn = axis[0] * n[0] + axis[1] * n[1] + axis[2] * n[2];
+        maxT = std::max(maxT, dc / dn);
+    }
+
+    for (int a = 0; a < 3; ++a)
+    {
+        m.coneApex[a] = m.center[a] - axis[a] * maxT;
+        m.coneAxis[a] = axis[a];
+    }
+    m.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+static void BuildMeshlets(const std::vector<VertexPNTTJW> &vertices, std::vector<uint32_t> &indices, uint32_t indexCount,
+                          uint32_t primitiveIndex, std::vector<sm::SModelMeshletRecord> &outMeshlets,
+                          std::vector<uint32_t> &outVertices, std::vector<uint8_t> &outTriangles)
+{
+    const uint32_t triCount = indexCount / 3u;
+    if (triCount == 0)
+        return;
+    for (uint32_t i = 0; i < triCount * 3u; ++i)
+    {
+        if (indices[i] >= vertices.size())
+            return; // invalid source indices: leave the primitive without meshlets
+    }
+
+    // Vertex -> triangle adjacency (CSR).
+    std::vector<uint32_t> adjFirst(vertices.size() + 1, 0);
+    for (uint32_t i = 0; i < triCount * 3u; ++i)
+        ++adjFirst[indices[i] + 1];
+    for (size_t v = 0; v < vertices.size(); ++v)
+        adjFirst[v + 1] += adjFirst[v];
+    std::vector<uint32_t> adjTris(triCount * 3u);
+    {
+        std::vector<uint32_t> fill(adjFirst.begin(), adjFirst.end() - 1);
+        for (uint32_t i = 0; i < triCount * 3u; ++i)
+            adjTris[fill[indices[i]]++] = i / 3u;
+    }
+
+    std::vector<uint8_t> used(triCount, 0);
+    std::vector<uint32_t> localOf(vertices.size(), ~0u);
+    std::vector<uint32_t> reordered;
+    reordered.reserve(triCount * 3u);
+
+    std::vector<uint32_t> mv; // meshlet vertices (mesh indices)
+    std::vector<uint8_t> mt;  // meshlet triangles (local indices)
+
+    auto newVertexCount = [&](uint32_t tri)
+    {
+        uint32_t n = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[tri * 3u + k];
+            bool dup = false;
+            for (int j = 0; j < k; ++j)
+                dup = dup || indices[tri * 3u + j] == v;
+            n += (localOf[v] == ~0u && !dup) ? 1u : 0u;
+        }
+        return n;
+    };
+
+    auto flush = [&]()
+    {
+        if (mt.empty())
+            return;
+        sm::SModelMeshletRecord m{};
+        m.primitiveIndex = primitiveIndex;
+        m.firstIndex = static_cast<uint32_t>(reordered.size());
+        m.firstVertex = static_cast<uint32_t>(outVertices.size());
+        m.firstTriangle = static_cast<uint32_t>(outTriangles.size() / 3u);
+        m.vertexCount = static_cast<uint16_t>(mv.size());
+        m.triangleCount = static_cast<uint16_t>(mt.size() / 3u);
+        ComputeMeshletBounds(vertices, mv, mt, m);
+
+        for (uint8_t local : mt)
+            reordered.push_back(mv[local]);
+        outVertices.insert(outVertices.end(), mv.begin(), mv.end());
+        outTriangles.insert(outTriangles.end(), mt.begin(), mt.end());
+        outMeshlets.push_back(m);
+
+        for (uint32_t v : mv)
+            localOf[v] = ~0u;
+        mv.clear();
+        mt.clear();
+    };
+
+    auto addTriangle = [&](uint32_t tri)
+    {
+        used[tri] = 1;
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = indices[tri * 3u + k];
+            if (localOf[v] == ~0u)
+            {
+                localOf[v] = static_cast<uint32_t>(mv.size());
+                mv.push_back(v);
+            }
+            mt.push_back(static_cast<uint8_t>(localOf[v]));
+        }
+    };
+
+    uint32_t scan = 0;
+    for (;;)
+    {
+        // Best unused neighbour of the current meshlet.
+        uint32_t best = ~0u, bestCost = 4;
+        for (uint32_t v : mv)
+        {
+            for (uint32_t a = adjFirst[v]; a < adjFirst[v + 1] && bestCost > 0; ++a)
+            {
+                const uint32_t tri = adjTris[a];
+                if (used[tri])
+                    continue;
+                const uint32_t cost = newVertexCount(tri);
+                if (cost < bestCost)
+                {
+                    best = tri;
+                    bestCost = cost;
+                }
+            }
+            if (bestCost == 0)
+                break;
+        }
+
+        if (best == ~0u)
+        {
+            while (scan < triCount && used[scan])
+                ++scan;
+            if (scan == triCount)
+                break;
+            best = scan;
+            bestCost = newVertexCount(best);
+        }
+
+        if (mv.size() + bestCost > sm::kMeshletMaxVertices || mt.size() / 3u + 1u > sm::kMeshletMaxTriangles)
+            flush();
+        addTriangle(best);
+    }
+    flush();
+
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+}
+
 // ------------------------------------------------------------
 // Assimp matrix conversion
 // aiMatrix4x4 is row-major; runtime expects column-major float arrays.
@@ -293,7 +753,8 @@ struct LoadedImageBytes
 static LoadedImageBytes LoadTextureBytesFromAssimp(
     const aiScene *scene,
     const std::string &modelDir,
-    const std::string &assimpPath)
+    const std::string &assimpPath,
+    std::ostream &log)
 {
     LoadedImageBytes out{};
     out.debugURI = assimpPath;
@@ -304,14 +765,14 @@ static LoadedImageBytes LoadTextureBytesFromAssimp(
         const int idx = EmbeddedTextureIndex(assimpPath);
         if (!scene || idx < 0 || idx >= (int)scene->mNumTextures)
         {
-            std::cout << "Embedded texture index invalid: " << assimpPath << "\n";
+            log << "Embedded texture index invalid: " << assimpPath << "\n";
             return out;
         }
 
         const aiTexture *tex = scene->mTextures[idx];
         if (!tex)
         {
-            std::cout << "Embedded texture missing: " << assimpPath << "\n";
+            log << "Embedded texture missing: " << assimpPath << "\n";
             return out;
         }
 
@@ -328,7 +789,7 @@ static LoadedImageBytes LoadTextureBytesFromAssimp(
 
         // If it's raw (rare for glTF), we cannot store as compressed reliably without encoding.
         // You can add stb_image_write here later if you want to support it.
-        std::cout << "WARNING: Embedded texture is raw (mHeight>0). Not supported in phase 1: "
+        log << "WARNING: Embedded texture is raw (mHeight>0). Not supported in phase 1: "
                   << assimpPath << "\n";
         return out;
     }
@@ -337,7 +798,7 @@ static LoadedImageBytes LoadTextureBytesFromAssimp(
     const std::string resolved = ResolveTexturePath(modelDir, assimpPath);
     if (!ReadFileBytes(resolved, out.bytes))
     {
-        std::cout << "Failed to read external texture: " << resolved << "\n";
+        log << "Failed to read external texture: " << resolved << "\n";
         return out;
     }
 
@@ -376,64 +837,197 @@ static inline float TicksToSeconds(double ticks, double ticksPerSecond)
     return (float)(ticks / tps);
 }
 
-static uint16_t AddVec3Sampler(const aiVectorKey *keys,
-                               uint32_t keyCount,
-                               double tps,
-                               sm::SModelAnimInterpolation interp,
-                               std::vector<float> &animTimes,
-                               std::vector<float> &animValues,
-                               std::vector<sm::SModelAnimationSamplerRecord> &animSamplers)
+// Keyframe reduction tolerances (absolute, per component): scene units, unit quaternion
+// components (~2e-4 rad) and scale factors.
+static constexpr float kTranslationTolerance = 1e-4f;
+static constexpr float kRotationTolerance = 1e-4f;
+static constexpr float kScaleTolerance = 1e-4f;
+
+struct AnimCompressionStats
+{
+    uint64_t keysIn = 0;
+    uint64_t keysOut = 0;
+    uint64_t rawWords = 0; // what the samplers would take as plain floats
+};
+
+// Value of a linear sampler between keys a and b at times[k], like the runtime: lerp for vec3,
+// shorter-arc nlerp for quaternions (width 4).
+static void InterpolateKey(const std::vector<float> &times, const std::vector<float> &values, uint32_t width,
+                           uint32_t a, uint32_t b, uint32_t k, float *out)
+{
+    const float dt = times[b] - times[a];
+    const float alpha = (dt <= 1e-8f) ? 0.0f : std::min(std::max((times[k] - times[a]) / dt, 0.0f), 1.0f);
+    const float *va = values.data() + size_t(a) * width;
+    const float *vb = values.data() + size_t(b) * width;
+
+    float sign = 1.0f;
+    if (width == 4)
+    {
+        const float d = va[0] * vb[0] + va[1] * vb[1] + va[2] * vb[2] + va[3] * vb[3];
+        sign = (d < 0.0f) ? -1.0f : 1.0f;
+    }
+
+    float len2 = 0.0f;
+    for (uint32_t c = 0; c < width; ++c)
+    {
+        out[c] = va[c] + (vb[c] * sign - va[c]) * alpha;
+        len2 += out[c] * out[c];
+    }
+    if (width == 4 && len2 > 0.0f)
+    {
+        const float inv = 1.0f / std::sqrt(len2);
+        for (uint32_t c = 0; c < 4; ++c)
+            out[c] *= inv;
+    }
+}
+
+// Largest per-component difference; quaternions compare against the closer of q and -q.
+static float KeyError(const float *x, const float *y, uint32_t width)
+{
+    float err = 0.0f, errNeg = 0.0f;
+    for (uint32_t c = 0; c < width; ++c)
+    {
+        err = std::max(err, std::fabs(x[c] - y[c]));
+        errNeg = std::max(errNeg, std::fabs(x[c] + y[c]));
+    }
+    return (width == 4) ? std::min(err, errNeg) : err;
+}
+
+// Greedy keyframe reduction for linear samplers: a key is dropped when interpolating between
+// the kept keys around it reproduces every dropped key within 'tolerance'. A track that never
+// leaves 'tolerance' of its first key collapses to that key. Returns the kept key indices.
+static std::vector<uint32_t> ReduceKeys(const std::vector<float> &times, const std::vector<float> &values,
+                                        uint32_t width, float tolerance)
+{
+    const uint32_t n = static_cast<uint32_t>(times.size());
+    std::vector<uint32_t> kept;
+    if (n == 0)
+        return kept;
+
+    bool constant = true;
+    for (uint32_t k = 1; k < n && constant; ++k)
+        constant = KeyError(values.data(), values.data() + size_t(k) * width, width) <= tolerance;
+    kept.push_back(0);
+    if (constant)
+        return kept;
+
+    float interp[4];
+    auto segmentFits = [&](uint32_t a, uint32_t b)
+    {
+        for (uint32_t k = a + 1; k < b; ++k)
+        {
+            InterpolateKey(times, values, width, a, b, k, interp);
+            if (KeyError(interp, values.data() + size_t(k) * width, width) > tolerance)
+                return false;
+        }
+        return true;
+    };
+
+    uint32_t anchor = 0;
+    for (uint32_t b = 2; b < n; ++b)
+    {
+        if (!segmentFits(anchor, b))
+        {
+            anchor = b - 1;
+            kept.push_back(anchor);
+        }
+    }
+    kept.push_back(n - 1);
+    return kept;
+}
+
+// Reduce, then append one packed (V5) sampler: Vec3Range for width 3, QuatSmallest3 for width 4.
+static uint16_t AddPackedSampler(const std::vector<float> &times,
+                                 const std::vector<float> &values,
+                                 uint32_t width,
+                                 float tolerance,
+                                 sm::SModelAnimInterpolation interp,
+                                 std::vector<float> &animTimes,
+                                 std::vector<float> &animValues,
+                                 std::vector<sm::SModelAnimationSamplerRecord> &animSamplers,
+                                 AnimCompressionStats &stats)
 {
+    const std::vector<uint32_t> kept = ReduceKeys(times, values, width, tolerance);
+
+    std::vector<float> keptValues;
+    keptValues.reserve(kept.size() * width);
+    for (uint32_t k : kept)
+        keptValues.insert(keptValues.end(), values.begin() + size_t(k) * width, values.begin() + size_t(k + 1) * width);
+
     sm::SModelAnimationSamplerRecord s{};
     s.firstTime = (uint32_t)animTimes.size();
-    s.timeCount = keyCount;
+    s.timeCount = (uint32_t)kept.size();
     s.firstValue = (uint32_t)animValues.size();
-    s.valueCount = keyCount * 3;
     s.interpolation = (uint8_t)interp;
-    s.valueType = (uint8_t)sm::SModelAnimValueType::Vec3;
 
-    for (uint32_t i = 0; i < keyCount; i++)
+    for (uint32_t k : kept)
+        animTimes.push_back(times[k]);
+
+    if (width == 4)
+    {
+        s.valueType = (uint8_t)sm::SModelAnimValueType::QuatSmallest3;
+        sm::encodeQuatSmallest3(keptValues.data(), s.timeCount, animValues);
+    }
+    else
     {
-        animTimes.push_back(TicksToSeconds(keys[i].mTime, tps));
-        animValues.push_back((float)keys[i].mValue.x);
-        animValues.push_back((float)keys[i].mValue.y);
-        animValues.push_back((float)keys[i].mValue.z);
+        s.valueType = (uint8_t)sm::SModelAnimValueType::Vec3Range;
+        sm::encodeVec3Range(keptValues.data(), s.timeCount, animValues);
     }
+    s.valueCount = (uint32_t)(animValues.size() - s.firstValue);
+
+    stats.keysIn += times.size();
+    stats.keysOut += kept.size();
+    stats.rawWords += values.size();
 
     uint32_t samplerIndex = (uint32_t)animSamplers.size();
     animSamplers.push_back(s);
     return (uint16_t)samplerIndex;
 }
 
-static uint16_t AddQuatSampler(const aiQuatKey *keys,
+static uint16_t AddVec3Sampler(const aiVectorKey *keys,
                                uint32_t keyCount,
                                double tps,
+                               float tolerance,
                                sm::SModelAnimInterpolation interp,
                                std::vector<float> &animTimes,
                                std::vector<float> &animValues,
-                               std::vector<sm::SModelAnimationSamplerRecord> &animSamplers)
+                               std::vector<sm::SModelAnimationSamplerRecord> &animSamplers,
+                               AnimCompressionStats &stats)
 {
-    sm::SModelAnimationSamplerRecord s{};
-    s.firstTime = (uint32_t)animTimes.size();
-    s.timeCount = keyCount;
-    s.firstValue = (uint32_t)animValues.size();
-    s.valueCount = keyCount * 4;
-    s.interpolation = (uint8_t)interp;
-    s.valueType = (uint8_t)sm::SModelAnimValueType::Quat;
-
+    std::vector<float> times(keyCount);
+    std::vector<float> values(size_t(keyCount) * 3);
     for (uint32_t i = 0; i < keyCount; i++)
     {
-        animTimes.push_back(TicksToSeconds(keys[i].mTime, tps));
-        // Store quat as XYZW (consistent with loader validation expectations)
-        animValues.push_back((float)keys[i].mValue.x);
-        animValues.push_back((float)keys[i].mValue.y);
-        animValues.push_back((float)keys[i].mValue.z);
-        animValues.push_back((float)keys[i].mValue.w);
+        times[i] = TicksToSeconds(keys[i].mTime, tps);
+        values[i * 3 + 0] = (float)keys[i].mValue.x;
+        values[i * 3 + 1] = (float)keys[i].mValue.y;
+        values[i * 3 + 2] = (float)keys[i].mValue.z;
     }
+    return AddPackedSampler(times, values, 3, tolerance, interp, animTimes, animValues, animSamplers, stats);
+}
 
-    uint32_t samplerIndex = (uint32_t)animSamplers.size();
-    animSamplers.push_back(s);
-    return (uint16_t)samplerIndex;
+static uint16_t AddQuatSampler(const aiQuatKey *keys,
+                               uint32_t keyCount,
+                               double tps,
+                               sm::SModelAnimInterpolation interp,
+                               std::vector<float> &animTimes,
+                               std::vector<float> &animValues,
+                               std::vector<sm::SModelAnimationSamplerRecord> &animSamplers,
+                               AnimCompressionStats &stats)
+{
+    std::vector<float> times(keyCount);
+    std::vector<float> values(size_t(keyCount) * 4);
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+        times[i] = TicksToSeconds(keys[i].mTime, tps);
+
+        // XYZW, normalized so reduction compares unit quaternions
+        float q[4] = {(float)keys[i].mValue.x, (float)keys[i].mValue.y, (float)keys[i].mValue.z, (float)keys[i].mValue.w};
+        const float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (uint32_t c = 0; c < 4; ++c)
+            values[i * 4 + c] = (len > 0.0f) ? q[c] / len : (c == 3 ? 1.0f : 0.0f);
+    }
+    return AddPackedSampler(times, values, 4, kRotationTolerance, interp, animTimes, animValues, animSamplers, stats);
 }
 
 static void WriteBytes(std::ofstream &out, const std::vector<uint8_t> &b)
@@ -449,23 +1043,77 @@ static void WriteChars(std::ofstream &out, const std::vector<char> &c)
 }
 
 // ------------------------------------------------------------
-// Main
+// Conversion options (shared by single-file and batch mode)
 // ------------------------------------------------------------
-int main(int argc, char **argv)
+struct ConvertOptions
 {
-    if (argc < 3)
+    bool compactVertices = false;
+    bool buildMeshlets = true;
+    bool optimizeMeshes = true;
+    bool compressTextures = false;
+    bool compressMeshes = false;
+    uint32_t meshThreads = 1; // threads for per-mesh processing inside one model
+};
+
+// Bump when the converter's output changes for the same input and options; batch mode then
+// rebuilds everything.
+static constexpr uint32_t kConverterRevision = 1;
+
+// Runs fn(i) for every i in [0, count) on up to 'threads' threads (the calling one included).
+static void ParallelFor(size_t count, uint32_t threads, const std::function<void(size_t)> &fn)
+{
+    const size_t workers = std::min<size_t>(std::max<uint32_t>(threads, 1u), count);
+    if (workers <= 1)
     {
-        std::cout << "Usage: GltfToSModel <input.gltf/.glb> <output.smodel>\n";
-        return 0;
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto work = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+            fn(i);
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t t = 1; t < workers; ++t)
+        pool.emplace_back(work);
+    work();
+    for (std::thread &t : pool)
+        t.join();
+}
+
+// Records every file Assimp opens (the glTF and its buffers), so batch mode knows what an output
+// depends on. Owned by the Importer once installed.
+class RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    Assimp::IOStream *Open(const char *file, const char *mode = "rb") override
+    {
+        Assimp::IOStream *stream = Assimp::DefaultIOSystem::Open(file, mode);
+        if (stream)
+            opened.insert(NormalizePathSlashes(file));
+        return stream;
     }
 
-    const std::string inputPath = NormalizePathSlashes(argv[1]);
-    const std::string outputPath = NormalizePathSlashes(argv[2]);
+    std::set<std::string> opened;
+};
+
+// ------------------------------------------------------------
+// ConvertModel: one .gltf/.glb -> one .smodel
+// ------------------------------------------------------------
+// Progress and summary go to 'log'. When 'dependencies' is given it receives every file the
+// output was built from (the model, its buffers and external textures).
+static int ConvertModel(const std::string &inputPath, const std::string &outputPath, const ConvertOptions &opts,
+                        std::ostream &log, std::vector<std::string> *dependencies = nullptr)
+{
     const std::string modelDir = GetDirectoryOfFile(inputPath);
 
-    std::cout << "Input  : " << inputPath << "\n";
-    std::cout << "Output : " << outputPath << "\n";
-    std::cout << "ModelDir: " << modelDir << "\n";
+    log << "Input  : " << inputPath << "\n";
+    log << "Output : " << outputPath << "\n";
+    log << "ModelDir: " << modelDir << "\n";
 
     // ------------------------------------------------------------
     // Assimp importer options:
@@ -473,15 +1121,17 @@ int main(int argc, char **argv)
     // - GenNormals: normals exist
     // - CalcTangentSpace: tangents exist (when UV exists)
     // - JoinIdenticalVertices: reduces duplicates
+    // Triangle and vertex order is left to tools::OptimizeMesh below.
     // ------------------------------------------------------------
     Assimp::Importer importer;
+    RecordingIOSystem *io = new RecordingIOSystem();
+    importer.SetIOHandler(io);
 
     const unsigned flags =
         aiProcess_Triangulate |
         aiProcess_GenNormals |
         aiProcess_CalcTangentSpace |
         aiProcess_JoinIdenticalVertices |
-        aiProcess_ImproveCacheLocality |
         aiProcess_LimitBoneWeights |
         aiProcess_RemoveRedundantMaterials |
         aiProcess_SortByPType;
@@ -489,7 +1139,7 @@ int main(int argc, char **argv)
     const aiScene *scene = importer.ReadFile(inputPath, flags);
     if (!scene)
     {
-        std::cout << "Assimp failed: " << importer.GetErrorString() << "\n";
+        log << "Assimp failed: " << importer.GetErrorString() << "\n";
         return 1;
     }
 
@@ -512,7 +1162,13 @@ int main(int argc, char **argv)
     std::vector<sm::SModelAnimationChannelRecord> animChannels;
     std::vector<sm::SModelAnimationSamplerRecord> animSamplers;
     std::vector<float> animTimes;  // seconds
-    std::vector<float> animValues; // packed floats (vec3/quats)
+    std::vector<float> animValues; // 32-bit words, packed samplers (V5)
+    AnimCompressionStats animStats;
+
+    // Optimization pass totals over all base ranges (LODs not included).
+    size_t optVerticesIn = 0, optVerticesOut = 0, optTriangles = 0;
+    double optMissesIn = 0.0, optMissesOut = 0.0;
+    uint64_t meshBytesRaw = 0, meshBytesStored = 0;
 
     // Skinning (V4)
     struct TmpSkin
@@ -532,6 +1188,8 @@ int main(int argc, char **argv)
     // key = resolved path or "*0"
     // ------------------------------------------------------------
     std::unordered_map<std::string, int32_t> textureKeyToIndex;
+    uint32_t texCompressed = 0;
+    uint64_t texBytesIn = 0, texBytesOut = 0;
 
     // Create & store a new texture record (or return existing index)
     auto AcquireTextureIndex = [&](const std::string &assimpTexPath,
@@ -554,7 +1212,7 @@ int main(int argc, char **argv)
             return it->second;
 
         // Load bytes
-        LoadedImageBytes img = LoadTextureBytesFromAssimp(scene, modelDir, assimpTexPath);
+        LoadedImageBytes img = LoadTextureBytesFromAssimp(scene, modelDir, assimpTexPath, log);
         if (!img.ok)
             return -1;
 
@@ -579,10 +1237,49 @@ int main(int argc, char **argv)
         tr.mipFilter = DefaultMipNone();
         tr.maxAnisotropy = 1.0f;
 
-        // Blob store (compressed)
-        blob.align(8);
-        tr.imageDataOffset = blob.append(img.bytes.data(), img.bytes.size());
-        tr.imageDataSize = static_cast<uint32_t>(img.bytes.size());
+        if (opts.compressTextures)
+        {
+            // Decode and cook to BCn: normal maps keep two channels (BC5), alpha picks BC3 over BC1
+            int w = 0, h = 0, comp = 0;
+            stbi_uc *pixels = stbi_load_from_memory(img.bytes.data(), static_cast<int>(img.bytes.size()), &w, &h, &comp, STBI_rgb_alpha);
+            if (pixels)
+            {
+                tools::RgbaImage rgba;
+                rgba.width = static_cast<uint32_t>(w);
+                rgba.height = static_cast<uint32_t>(h);
+                rgba.rgba.assign(pixels, pixels + size_t(w) * size_t(h) * 4u);
+                stbi_image_free(pixels);
+
+                const sm::ImageEncoding encoding = type == aiTextureType_NORMALS ? sm::ImageEncoding::BC5
+                                                   : tools::HasAlpha(rgba)       ? sm::ImageEncoding::BC3
+                                                                                 : sm::ImageEncoding::BC1;
+                const std::vector<uint8_t> blocks = tools::CompressMipChain(std::move(rgba), encoding, isSRGB);
+
+                tr.encoding = static_cast<uint32_t>(encoding);
+                tr.width = static_cast<uint32_t>(w);
+                tr.height = static_cast<uint32_t>(h);
+                tr.mipFilter = static_cast<uint32_t>(sm::MipMode::Linear); // the chain is in the file
+
+                blob.align(16);
+                tr.imageDataOffset = blob.append(blocks.data(), blocks.size());
+                tr.imageDataSize = static_cast<uint64_t>(blocks.size());
+                texBytesIn += img.bytes.size();
+                texBytesOut += blocks.size();
+                ++texCompressed;
+            }
+            else
+            {
+                log << "Warning: could not decode " << key << " (" << stbi_failure_reason() << "), keeping its encoded bytes\n";
+            }
+        }
+
+        if (tr.imageDataSize == 0)
+        {
+            // Blob store (compressed)
+            blob.align(8);
+            tr.imageDataOffset = blob.append(img.bytes.data(), img.bytes.size());
+            tr.imageDataSize = static_cast<uint32_t>(img.bytes.size());
+        }
 
         const int32_t newIndex = static_cast<int32_t>(textureRecords.size());
         textureRecords.push_back(tr);
@@ -772,19 +1469,68 @@ int main(int argc, char **argv)
 
     std::vector<int32_t> meshIndexToPrimIndex(scene->mNumMeshes, -1);
 
-    for (uint32_t meshIdx = 0; meshIdx < scene->mNumMeshes; ++meshIdx)
+    // Mesh LOD index ranges, turned into primitive records once every mesh is emitted.
+    struct PendingLod
+    {
+        uint32_t basePrimitive;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+    std::vector<PendingLod> pendingLods;
+
+    // Meshlets of the base primitives (V7 sections).
+    std::vector<sm::SModelMeshletRecord> meshlets;
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint8_t> meshletTriangles;
+
+    // Per-mesh processing (vertex packing, optimization, meshlets, AABB, LODs, compact encoding) is
+    // independent between meshes and runs in parallel; the results are appended to the tables in
+    // mesh order afterwards, so the output does not depend on the thread count.
+    struct ProcessedMesh
+    {
+        bool valid = false;
+        bool hasSkin = false;
+        TmpSkin skin;
+
+        std::vector<VertexPNTTJW> vertices;
+        std::vector<uint32_t> indices; // base range, then the LOD ranges
+        uint32_t baseIndexCount = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> lodRanges; // firstIndex, indexCount
+        float aabbMin[3] = {};
+        float aabbMax[3] = {};
+
+        std::vector<VertexCompact> compact;
+        bool writeCompact = false;
+
+        // Mesh codec streams (--compress-meshes), empty when the raw bytes are kept
+        std::vector<uint8_t> vertexCodec;
+        std::vector<uint8_t> indexCodec;
+
+        // Meshlets numbered from 0; rebased when appended
+        std::vector<sm::SModelMeshletRecord> meshlets;
+        std::vector<uint32_t> meshletVertices;
+        std::vector<uint8_t> meshletTriangles;
+
+        size_t optVerticesIn = 0, optVerticesOut = 0, optTriangles = 0;
+        double optMissesIn = 0.0, optMissesOut = 0.0;
+    };
+
+    std::vector<ProcessedMesh> processed(scene->mNumMeshes);
+    auto ProcessMesh = [&](size_t meshIdx)
     {
         const aiMesh *mesh = scene->mMeshes[meshIdx];
         if (!mesh)
-            continue;
+            return;
 
-        int32_t skinIndex = -1;
+        ProcessedMesh &pm = processed[meshIdx];
+        pm.valid = true;
 
         // If this mesh has bones, build per-vertex joint/weight data and a TmpSkin.
         std::vector<std::vector<std::pair<uint16_t, float>>> influences; // per vertex: (jointIx, weight)
         if (mesh->HasBones() && mesh->mNumBones > 0)
         {
-            TmpSkin skin;
+            TmpSkin &skin = pm.skin;
+            pm.hasSkin = true;
             skin.name = (mesh->mName.length > 0) ? std::string(mesh->mName.C_Str()) + "_skin" : ("skin_" + std::to_string(meshIdx));
             skin.jointNodeNames.reserve(mesh->mNumBones);
             skin.inverseBindMatrices.reserve(size_t(mesh->mNumBones) * 16u);
@@ -831,13 +1577,10 @@ int main(int argc, char **argv)
                     influences[w.mVertexId].push_back({jointIx, w.mWeight});
                 }
             }
-
-            skinIndex = static_cast<int32_t>(tmpSkins.size());
-            tmpSkins.push_back(std::move(skin));
         }
 
         // Build vertex array
-        std::vector<VertexPNTTJW> vertices;
+        std::vector<VertexPNTTJW> &vertices = pm.vertices;
         vertices.resize(mesh->mNumVertices);
 
         for (uint32_t vi = 0; vi < mesh->mNumVertices; ++vi)
@@ -892,7 +1635,7 @@ int main(int argc, char **argv)
             }
 
             // Skinning (up to 4 weights)
-            if (skinIndex >= 0 && vi < influences.size())
+            if (pm.hasSkin && vi < influences.size())
             {
                 auto &inf = influences[vi];
                 if (!inf.empty())
@@ -921,7 +1664,7 @@ int main(int argc, char **argv)
         }
 
         // Build index array (triangulated)
-        std::vector<uint32_t> indices;
+        std::vector<uint32_t> &indices = pm.indices;
         indices.reserve(mesh->mNumFaces * 3);
 
         for (uint32_t fi = 0; fi < mesh->mNumFaces; ++fi)
@@ -935,6 +1678,97 @@ int main(int argc, char **argv)
             indices.push_back(face.mIndices[2]);
         }
 
+        // Offline dedupe + vertex cache / overdraw / fetch ordering of the full-detail range. Runs
+        // before meshlets (they grow along this order) and LODs (simplified from its vertices).
+        if (opts.optimizeMeshes && !indices.empty())
+        {
+            const size_t triangles = indices.size() / 3;
+            pm.optVerticesIn = vertices.size();
+            pm.optMissesIn = double(tools::ComputeACMR(indices, vertices.size())) * double(triangles);
+
+            tools::OptimizeMesh(vertices, indices, [](const VertexPNTTJW &v)
+                                { return v.pos; });
+
+            pm.optVerticesOut = vertices.size();
+            pm.optMissesOut = double(tools::ComputeACMR(indices, vertices.size())) * double(triangles);
+            pm.optTriangles = triangles;
+        }
+
+        // Meshlets of the full-detail range; this reorders its triangles.
+        if (opts.buildMeshlets)
+            BuildMeshlets(vertices, indices, static_cast<uint32_t>(indices.size()), 0u,
+                          pm.meshlets, pm.meshletVertices, pm.meshletTriangles);
+
+        // Mesh LODs: simplified index ranges appended to the same index buffer.
+        ComputeAABB(vertices, pm.aabbMin, pm.aabbMax);
+
+        pm.baseIndexCount = static_cast<uint32_t>(indices.size());
+        size_t prevCount = indices.size();
+        for (uint32_t cells = kMeshLodBaseCells; cells >= 2 && pm.lodRanges.size() < kMeshLodLevels; cells /= 2)
+        {
+            std::vector<uint32_t> lod = SimplifyByClustering(vertices, indices, pm.aabbMin, pm.aabbMax, cells);
+            if (lod.size() < size_t(kMeshLodMinTriangles) * 3u)
+                break;
+            if (float(lod.size()) > float(prevCount) * kMeshLodMaxRatio)
+                continue; // grid still finer than the mesh
+            if (opts.optimizeMeshes)
+                tools::OptimizeVertexCache(lod, vertices.size());
+            pm.lodRanges.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lod.size())});
+            indices.insert(indices.end(), lod.begin(), lod.end());
+            prevCount = lod.size();
+        }
+
+        pm.writeCompact = opts.compactVertices && EncodeCompact(vertices, pm.aabbMin, pm.aabbMax, pm.compact);
+
+        // Codec streams, each kept only when smaller than the raw bytes
+        if (opts.compressMeshes)
+        {
+            const void *vertexBytes = pm.writeCompact ? static_cast<const void *>(pm.compact.data()) : static_cast<const void *>(vertices.data());
+            const size_t stride = pm.writeCompact ? sizeof(VertexCompact) : sizeof(VertexPNTTJW);
+            pm.vertexCodec = tools::EncodeVertexBuffer(vertexBytes, vertices.size(), stride);
+            if (pm.vertexCodec.size() >= vertices.size() * stride)
+                pm.vertexCodec.clear();
+            pm.indexCodec = tools::EncodeIndexBuffer(indices.data(), indices.size());
+            if (pm.indexCodec.size() >= indices.size() * sizeof(uint32_t))
+                pm.indexCodec.clear();
+        }
+    };
+    ParallelFor(scene->mNumMeshes, opts.meshThreads, ProcessMesh);
+
+    for (uint32_t meshIdx = 0; meshIdx < scene->mNumMeshes; ++meshIdx)
+    {
+        ProcessedMesh &pm = processed[meshIdx];
+        if (!pm.valid)
+            continue;
+        const aiMesh *mesh = scene->mMeshes[meshIdx];
+
+        int32_t skinIndex = -1;
+        if (pm.hasSkin)
+        {
+            skinIndex = static_cast<int32_t>(tmpSkins.size());
+            tmpSkins.push_back(std::move(pm.skin));
+        }
+
+        optVerticesIn += pm.optVerticesIn;
+        optVerticesOut += pm.optVerticesOut;
+        optTriangles += pm.optTriangles;
+        optMissesIn += pm.optMissesIn;
+        optMissesOut += pm.optMissesOut;
+
+        const uint32_t primIndex = static_cast<uint32_t>(primRecords.size());
+        for (sm::SModelMeshletRecord m : pm.meshlets)
+        {
+            m.primitiveIndex = primIndex;
+            m.firstVertex += static_cast<uint32_t>(meshletVertices.size());
+            m.firstTriangle += static_cast<uint32_t>(meshletTriangles.size() / 3u);
+            meshlets.push_back(m);
+        }
+        meshletVertices.insert(meshletVertices.end(), pm.meshletVertices.begin(), pm.meshletVertices.end());
+        meshletTriangles.insert(meshletTriangles.end(), pm.meshletTriangles.begin(), pm.meshletTriangles.end());
+
+        const std::vector<VertexPNTTJW> &vertices = pm.vertices;
+        const std::vector<uint32_t> &indices = pm.indices;
+
         // Fill mesh record
         sm::SModelMeshRecord mr{};
         {
@@ -942,28 +1776,63 @@ int main(int argc, char **argv)
             mr.nameStrOffset = strings.add(meshName);
         }
 
+        const bool writeCompact = pm.writeCompact;
+        const std::vector<VertexCompact> &compact = pm.compact;
+        if (opts.compactVertices && !writeCompact)
+            log << "Mesh " << meshIdx << ": joint indices above 255, keeping full-float vertices\n";
+
         mr.vertexCount = static_cast<uint32_t>(vertices.size());
         mr.indexCount = static_cast<uint32_t>(indices.size());
-        mr.vertexStride = static_cast<uint32_t>(sizeof(VertexPNTTJW));
+        mr.vertexStride = writeCompact ? sm::kCompactVertexStride : static_cast<uint32_t>(sizeof(VertexPNTTJW));
 
         // layout flags should match your enum in ModelFormats.h
         // If your enum differs, update accordingly.
         mr.layoutFlags = sm::VTX_POS | sm::VTX_NORMAL | sm::VTX_UV0 | sm::VTX_TANGENT | sm::VTX_JOINTS | sm::VTX_WEIGHTS;
+        if (writeCompact)
+            mr.layoutFlags |= sm::VTX_COMPACT;
 
         // Indices are always U32 in phase 1
         mr.indexType = 1; // assume 1=U32 (match your IndexType enum if different)
 
         // AABB
-        ComputeAABB(vertices, mr.aabbMin, mr.aabbMax);
-
-        // Store vertex/index bytes in blob
-        blob.align(8);
-        mr.vertexDataOffset = blob.append(vertices.data(), vertices.size() * sizeof(VertexPNTTJW));
-        mr.vertexDataSize = static_cast<uint32_t>(vertices.size() * sizeof(VertexPNTTJW));
+        std::memcpy(mr.aabbMin, pm.aabbMin, sizeof(pm.aabbMin));
+        std::memcpy(mr.aabbMax, pm.aabbMax, sizeof(pm.aabbMax));
+
+        // Store vertex/index bytes in blob, each stream on a 16-byte boundary (V9)
+        const uint64_t rawVertexBytes = uint64_t(vertices.size()) * mr.vertexStride;
+        const uint64_t rawIndexBytes = uint64_t(indices.size()) * sizeof(uint32_t);
+        blob.align(16);
+        if (!pm.vertexCodec.empty())
+        {
+            mr.layoutFlags |= sm::MESH_VERTEX_CODEC;
+            mr.vertexDataOffset = blob.append(pm.vertexCodec.data(), pm.vertexCodec.size());
+            mr.vertexDataSize = pm.vertexCodec.size();
+        }
+        else if (writeCompact)
+        {
+            mr.vertexDataOffset = blob.append(compact.data(), compact.size() * sizeof(VertexCompact));
+            mr.vertexDataSize = static_cast<uint32_t>(compact.size() * sizeof(VertexCompact));
+        }
+        else
+        {
+            mr.vertexDataOffset = blob.append(vertices.data(), vertices.size() * sizeof(VertexPNTTJW));
+            mr.vertexDataSize = static_cast<uint32_t>(vertices.size() * sizeof(VertexPNTTJW));
+        }
 
-        blob.align(8);
-        mr.indexDataOffset = blob.append(indices.data(), indices.size() * sizeof(uint32_t));
-        mr.indexDataSize = static_cast<uint32_t>(indices.size() * sizeof(uint32_t));
+        blob.align(16);
+        if (!pm.indexCodec.empty())
+        {
+            mr.layoutFlags |= sm::MESH_INDEX_CODEC;
+            mr.indexDataOffset = blob.append(pm.indexCodec.data(), pm.indexCodec.size());
+            mr.indexDataSize = pm.indexCodec.size();
+        }
+        else
+        {
+            mr.indexDataOffset = blob.append(indices.data(), indices.size() * sizeof(uint32_t));
+            mr.indexDataSize = static_cast<uint32_t>(indices.size() * sizeof(uint32_t));
+        }
+        meshBytesRaw += rawVertexBytes + rawIndexBytes;
+        meshBytesStored += mr.vertexDataSize + mr.indexDataSize;
 
         const uint32_t outMeshIndex = static_cast<uint32_t>(meshRecords.size());
         meshRecords.push_back(mr);
@@ -973,12 +1842,32 @@ int main(int argc, char **argv)
         pr.meshIndex = outMeshIndex;
         pr.materialIndex = static_cast<uint32_t>(mesh->mMaterialIndex);
         pr.firstIndex = 0;
-        pr.indexCount = mr.indexCount;
+        pr.indexCount = pm.baseIndexCount;
         pr.vertexOffset = 0;
         pr.skinIndex = skinIndex;
+        pr.lodNext = 0;
 
         primRecords.push_back(pr);
         meshIndexToPrimIndex[meshIdx] = static_cast<int32_t>(primRecords.size() - 1);
+
+        for (const auto &range : pm.lodRanges)
+            pendingLods.push_back({static_cast<uint32_t>(primRecords.size() - 1), range.first, range.second});
+    }
+
+    // LOD primitives go after every primitive the node graph references (lodNext 0 = none).
+    for (const PendingLod &lod : pendingLods)
+    {
+        // Walk to the end of the chain built so far.
+        uint32_t tail = lod.basePrimitive;
+        while (primRecords[tail].lodNext != 0)
+            tail = primRecords[tail].lodNext;
+
+        sm::SModelPrimitiveRecord pr = primRecords[lod.basePrimitive];
+        pr.firstIndex = lod.firstIndex;
+        pr.indexCount = lod.indexCount;
+        pr.lodNext = 0;
+        primRecords[tail].lodNext = static_cast<uint32_t>(primRecords.size());
+        primRecords.push_back(pr);
     }
 
     // ------------------------------------------------------------
@@ -1071,7 +1960,7 @@ int main(int argc, char **argv)
             auto it = nodeNameToIndex.find(jointName);
             if (it == nodeNameToIndex.end())
             {
-                std::cout << "Skin joint node not found in node table: '" << jointName << "'\n";
+                log << "Skin joint node not found in node table: '" << jointName << "'\n";
                 return 2;
             }
             skinJointNodeIndices.push_back(it->second);
@@ -1130,10 +2019,12 @@ int main(int argc, char **argv)
                     const uint16_t samplerIndex = AddVec3Sampler(ch->mPositionKeys,
                                                                  (uint32_t)ch->mNumPositionKeys,
                                                                  tps,
+                                                                 kTranslationTolerance,
                                                                  interp,
                                                                  animTimes,
                                                                  animValues,
-                                                                 animSamplers);
+                                                                 animSamplers,
+                                                                 animStats);
 
                     sm::SModelAnimationChannelRecord outCh{};
                     outCh.targetNode = targetNode;
@@ -1152,7 +2043,8 @@ int main(int argc, char **argv)
                                                                  interp,
                                                                  animTimes,
                                                                  animValues,
-                                                                 animSamplers);
+                                                                 animSamplers,
+                                                                 animStats);
 
                     sm::SModelAnimationChannelRecord outCh{};
                     outCh.targetNode = targetNode;
@@ -1168,10 +2060,12 @@ int main(int argc, char **argv)
                     const uint16_t samplerIndex = AddVec3Sampler(ch->mScalingKeys,
                                                                  (uint32_t)ch->mNumScalingKeys,
                                                                  tps,
+                                                                 kScaleTolerance,
                                                                  interp,
                                                                  animTimes,
                                                                  animValues,
-                                                                 animSamplers);
+                                                                 animSamplers,
+                                                                 animStats);
 
                     sm::SModelAnimationChannelRecord outCh{};
                     outCh.targetNode = targetNode;
@@ -1209,13 +2103,14 @@ int main(int argc, char **argv)
     // SkinJointNodeIndices
     // SkinInverseBindMatrices
     // Anim*
+    // Meshlets, MeshletVertices, MeshletTriangles
     // StringTable
     // Blob
     // ------------------------------------------------------------
     sm::SModelHeader header{};
     header.magic = sm::SMODEL_MAGIC;
-    header.versionMajor = 4;
-    header.versionMinor = 0;
+    header.versionMajor = sm::SMODEL_VERSION_MAJOR;
+    header.versionMinor = sm::SMODEL_VERSION_MINOR;
 
     header.meshCount = static_cast<uint32_t>(meshRecords.size());
     header.primitiveCount = static_cast<uint32_t>(primRecords.size());
@@ -1233,6 +2128,9 @@ int main(int argc, char **argv)
     header.animSamplersCount = static_cast<uint32_t>(animSamplers.size());
     header.animTimesCount = static_cast<uint32_t>(animTimes.size());
     header.animValuesCount = static_cast<uint32_t>(animValues.size());
+    header.meshletCount = static_cast<uint32_t>(meshlets.size());
+    header.meshletVertexCount = static_cast<uint32_t>(meshletVertices.size());
+    header.meshletTriangleBytes = static_cast<uint32_t>(meshletTriangles.size());
 
     uint64_t cursor = sizeof(sm::SModelHeader);
 
@@ -1286,7 +2184,20 @@ int main(int argc, char **argv)
     header.animValuesOffset = static_cast<uint32_t>(cursor);
     cursor += uint64_t(animValues.size()) * sizeof(float);
 
+    // V7: meshlets
+    header.meshletsOffset = static_cast<uint32_t>(cursor);
+    cursor += uint64_t(meshlets.size()) * sizeof(sm::SModelMeshletRecord);
+
+    header.meshletVerticesOffset = static_cast<uint32_t>(cursor);
+    cursor += uint64_t(meshletVertices.size()) * sizeof(uint32_t);
+
+    header.meshletTrianglesOffset = static_cast<uint32_t>(cursor);
+    cursor += uint64_t(meshletTriangles.size());
+
+    // Zero padding at the end of the string table starts the blob on a 16-byte boundary, so the
+    // mesh streams aligned within it are aligned in the (mapped) file too
     header.stringTableOffset = cursor;
+    strings.data.resize(strings.data.size() + size_t((16u - (cursor + strings.data.size()) % 16u) % 16u), 0);
     header.stringTableSize = static_cast<uint64_t>(strings.data.size());
     cursor += strings.data.size();
 
@@ -1304,7 +2215,7 @@ int main(int argc, char **argv)
     std::ofstream out(outputPath, std::ios::binary);
     if (!out.is_open())
     {
-        std::cout << "Failed to open output file: " << outputPath << "\n";
+        log << "Failed to open output file: " << outputPath << "\n";
         return 2;
     }
 
@@ -1324,27 +2235,289 @@ int main(int argc, char **argv)
     WriteVector(out, animSamplers);
     WriteVector(out, animTimes);
     WriteVector(out, animValues);
+    WriteVector(out, meshlets);
+    WriteVector(out, meshletVertices);
+    WriteBytes(out, meshletTriangles);
     WriteChars(out, strings.data);
     WriteBytes(out, blob.bytes);
 
     out.close();
 
-    std::cout << "\nCook complete \n";
-    std::cout << "Meshes     : " << header.meshCount << "\n";
-    std::cout << "Primitives : " << header.primitiveCount << "\n";
-    std::cout << "Materials  : " << header.materialCount << "\n";
-    std::cout << "Textures   : " << header.textureCount << "\n";
-    std::cout << "Nodes      : " << header.nodeCount << "\n";
-    std::cout << "NodePrimIx : " << header.nodePrimitiveIndexCount << "\n";
-    std::cout << "Skins      : " << header.skinCount << "\n";
-    std::cout << "AnimClips  : " << header.animClipsCount << "\n";
-    std::cout << "AnimChans  : " << header.animChannelsCount << "\n";
-    std::cout << "AnimSamplers: " << header.animSamplersCount << "\n";
-    std::cout << "AnimTimes  : " << header.animTimesCount << " floats\n";
-    std::cout << "AnimValues : " << header.animValuesCount << " floats\n";
-    std::cout << "StringTable: " << header.stringTableSize << " bytes\n";
-    std::cout << "Blob       : " << header.blobSize << " bytes\n";
-    std::cout << "FileSize   : " << header.fileSizeBytes << " bytes\n";
+    log << "\nCook complete \n";
+    log << "Meshes     : " << header.meshCount << "\n";
+    log << "Primitives : " << header.primitiveCount << " (" << pendingLods.size() << " mesh LODs)\n";
+    log << "Materials  : " << header.materialCount << "\n";
+    log << "Textures   : " << header.textureCount << "\n";
+    log << "Nodes      : " << header.nodeCount << "\n";
+    log << "NodePrimIx : " << header.nodePrimitiveIndexCount << "\n";
+    log << "Skins      : " << header.skinCount << "\n";
+    log << "AnimClips  : " << header.animClipsCount << "\n";
+    log << "AnimChans  : " << header.animChannelsCount << "\n";
+    log << "AnimSamplers: " << header.animSamplersCount << "\n";
+    log << "AnimTimes  : " << header.animTimesCount << " floats\n";
+    log << "AnimKeys   : " << animStats.keysOut << " of " << animStats.keysIn << " kept\n";
+    log << "AnimValues : " << header.animValuesCount << " words (" << animStats.rawWords << " as floats)\n";
+    log << "Meshlets   : " << header.meshletCount << " (" << header.meshletVertexCount << " vertex refs, "
+              << header.meshletTriangleBytes / 3u << " triangles)\n";
+    if (optTriangles > 0)
+        log << "Optimized  : ACMR " << optMissesIn / double(optTriangles) << " -> " << optMissesOut / double(optTriangles)
+                  << ", vertices " << optVerticesIn << " -> " << optVerticesOut << "\n";
+    if (opts.compressMeshes)
+        log << "MeshCodec  : " << meshBytesRaw << " vertex/index bytes -> " << meshBytesStored << " stored\n";
+    if (texCompressed > 0)
+        log << "TexCompress: " << texCompressed << " textures, " << texBytesIn << " encoded bytes -> " << texBytesOut
+                  << " BCn bytes with mips\n";
+    log << "StringTable: " << header.stringTableSize << " bytes\n";
+    log << "Blob       : " << header.blobSize << " bytes\n";
+    log << "FileSize   : " << header.fileSizeBytes << " bytes\n";
+
+    if (dependencies)
+    {
+        std::set<std::string> deps = io->opened;
+        for (const auto &kv : textureKeyToIndex)
+        {
+            if (!IsEmbeddedTexturePath(kv.first))
+                deps.insert(kv.first);
+        }
+        dependencies->assign(deps.begin(), deps.end());
+    }
 
     return 0;
 }
+
+// ------------------------------------------------------------
+// Batch mode: content-hash up-to-date checks
+// ------------------------------------------------------------
+// Next to each output, <output>.deps records the options key and the FNV-1a hash of every file
+// the output was built from. An output is skipped while all of them still match.
+static bool HashFile(const std::string &path, uint64_t &outHash)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return false;
+
+    uint64_t h = 14695981039346656037ull;
+    std::vector<char> buffer(1 << 16);
+    while (f)
+    {
+        f.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const std::streamsize got = f.gcount();
+        for (std::streamsize i = 0; i < got; ++i)
+        {
+            h ^= static_cast<uint8_t>(buffer[static_cast<size_t>(i)]);
+            h *= 1099511628211ull;
+        }
+    }
+    outHash = h;
+    return true;
+}
+
+static std::string OptionsKey(const ConvertOptions &opts)
+{
+    std::ostringstream key;
+    key << "smodel" << sm::SMODEL_VERSION_MAJOR << "." << sm::SMODEL_VERSION_MINOR << " rev" << kConverterRevision
+        << " compact" << opts.compactVertices << " meshlets" << opts.buildMeshlets
+        << " optimize" << opts.optimizeMeshes << " bc" << opts.compressTextures << " meshcodec" << opts.compressMeshes;
+    return key.str();
+}
+
+static bool IsUpToDate(const std::string &outputPath, const std::string &optionsKey)
+{
+    if (!std::filesystem::exists(outputPath))
+        return false;
+    std::ifstream deps(outputPath + ".deps");
+    std::string line;
+    if (!std::getline(deps, line) || line != optionsKey)
+        return false;
+
+    bool any = false;
+    while (std::getline(deps, line))
+    {
+        const size_t space = line.find(' ');
+        if (space == std::string::npos)
+            return false;
+        const uint64_t recorded = std::strtoull(line.substr(0, space).c_str(), nullptr, 16);
+        uint64_t current = 0;
+        if (!HashFile(line.substr(space + 1), current) || current != recorded)
+            return false;
+        any = true;
+    }
+    return any;
+}
+
+static void WriteDeps(const std::string &outputPath, const std::string &optionsKey, const std::vector<std::string> &dependencies)
+{
+    std::ofstream deps(outputPath + ".deps", std::ios::trunc);
+    deps << optionsKey << "\n";
+    for (const std::string &path : dependencies)
+    {
+        uint64_t h = 0;
+        if (HashFile(path, h))
+            deps << std::hex << h << std::dec << " " << path << "\n";
+    }
+}
+
+struct BatchJob
+{
+    std::string input;
+    std::string output;
+};
+
+// A directory converts every .gltf/.glb below it to <outputDir>/<relative path>.smodel. A manifest
+// lists one "<input> [output]" per line ('#' comments; relative paths are relative to the
+// manifest; a missing output goes to <outputDir>/<name>.smodel).
+static bool CollectBatchJobs(const std::string &source, const std::string &outputDir, std::vector<BatchJob> &jobs)
+{
+    namespace fs = std::filesystem;
+    if (fs::is_directory(source))
+    {
+        for (auto &entry : fs::recursive_directory_iterator(source))
+        {
+            if (!entry.is_regular_file())
+                continue;
+            const std::string ext = entry.path().extension().string();
+            if (ext != ".gltf" && ext != ".glb")
+                continue;
+            fs::path out = fs::path(outputDir) / fs::relative(entry.path(), source);
+            out.replace_extension(".smodel");
+            jobs.push_back({NormalizePathSlashes(entry.path().string()), NormalizePathSlashes(out.string())});
+        }
+        std::sort(jobs.begin(), jobs.end(), [](const BatchJob &a, const BatchJob &b)
+                  { return a.input < b.input; });
+        return true;
+    }
+
+    std::ifstream manifest(source);
+    if (!manifest.is_open())
+        return false;
+    const fs::path base = fs::path(source).parent_path();
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        std::istringstream fields(line);
+        std::string input, output;
+        if (!(fields >> input) || input[0] == '#')
+            continue;
+        fs::path in = fs::path(input).is_absolute() ? fs::path(input) : base / input;
+        fs::path out;
+        if (fields >> output)
+            out = fs::path(output).is_absolute() ? fs::path(output) : base / output;
+        else
+            out = fs::path(outputDir) / (in.stem().string() + ".smodel");
+        jobs.push_back({NormalizePathSlashes(in.string()), NormalizePathSlashes(out.string())});
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// Main
+// ------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: GltfToSModel <input.gltf/.glb> <output.smodel> [options]\n";
+        std::cout << "       GltfToSModel --batch <input_dir|manifest.txt> <output_dir> [options] [--jobs N] [--force]\n";
+        std::cout << "  --compact-vertices  quantized 28-byte vertices (VTX_COMPACT) instead of 72-byte VertexPNTTJW\n";
+        std::cout << "  --no-meshlets       skip the meshlet sections (primitives keep their source triangle order)\n";
+        std::cout << "  --no-optimize       keep Assimp's vertex and triangle order (no dedupe, cache, overdraw or fetch pass)\n";
+        std::cout << "  --compress-textures BC1/BC3/BC5 with the full mip chain instead of the source PNG/JPG bytes\n";
+        std::cout << "  --compress-meshes   store vertex and index streams with the mesh codec (assets/MeshCodec.h)\n";
+        std::cout << "  --jobs N            worker threads (default: all cores), shared by models and their meshes\n";
+        std::cout << "  --force             batch: convert even when <output>.deps says the output is up to date\n";
+        return 0;
+    }
+
+    const bool batch = std::string(argv[1]) == "--batch";
+    const int firstOption = batch ? 4 : 3;
+    if (batch && argc < 4)
+    {
+        std::cout << "--batch needs <input_dir|manifest.txt> <output_dir>\n";
+        return 1;
+    }
+
+    ConvertOptions opts;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false;
+    for (int a = firstOption; a < argc; ++a)
+    {
+        const std::string opt = argv[a];
+        if (opt == "--compact-vertices")
+            opts.compactVertices = true;
+        else if (opt == "--no-meshlets")
+            opts.buildMeshlets = false;
+        else if (opt == "--no-optimize")
+            opts.optimizeMeshes = false;
+        else if (opt == "--compress-textures")
+            opts.compressTextures = true;
+        else if (opt == "--compress-meshes")
+            opts.compressMeshes = true;
+        else if (opt == "--jobs" && a + 1 < argc)
+            threads = static_cast<uint32_t>(std::max(1, std::atoi(argv[++a])));
+        else if (opt == "--force")
+            force = true;
+        else
+            std::cout << "Ignoring unknown option: " << opt << "\n";
+    }
+
+    if (!batch)
+    {
+        opts.meshThreads = threads;
+        return ConvertModel(NormalizePathSlashes(argv[1]), NormalizePathSlashes(argv[2]), opts, std::cout);
+    }
+
+    std::vector<BatchJob> jobs;
+    if (!CollectBatchJobs(NormalizePathSlashes(argv[2]), NormalizePathSlashes(argv[3]), jobs))
+    {
+        std::cout << "Cannot read batch source: " << argv[2] << "\n";
+        return 1;
+    }
+
+    const std::string optionsKey = OptionsKey(opts);
+    std::vector<BatchJob> pending;
+    for (const BatchJob &job : jobs)
+    {
+        if (force || !IsUpToDate(job.output, optionsKey))
+            pending.push_back(job);
+    }
+
+    // Models in parallel; the threads left over go to the meshes of each model.
+    const uint32_t modelThreads = static_cast<uint32_t>(std::min<size_t>(threads, std::max<size_t>(pending.size(), 1)));
+    opts.meshThreads = std::max(1u, threads / modelThreads);
+
+    std::mutex printMutex;
+    std::atomic<uint32_t> failures{0};
+    const auto start = std::chrono::steady_clock::now();
+    auto ConvertJob = [&](size_t i)
+    {
+        const BatchJob &job = pending[i];
+        std::ostringstream log;
+        std::vector<std::string> dependencies;
+        int rc = 1;
+        try
+        {
+            rc = ConvertModel(job.input, job.output, opts, log, &dependencies);
+        }
+        catch (const std::exception &e)
+        {
+            log << "Conversion threw: " << e.what() << "\n";
+        }
+        if (rc == 0)
+            WriteDeps(job.output, optionsKey, dependencies);
+        else
+            ++failures;
+
+        std::lock_guard<std::mutex> lock(printMutex);
+        std::cout << log.str();
+        if (rc != 0)
+            std::cout << "FAILED: " << job.input << "\n";
+        std::cout << "\n";
+    };
+    ParallelFor(pending.size(), modelThreads, ConvertJob);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Batch: " << jobs.size() << " models, " << jobs.size() - pending.size() << " up to date, "
+              << pending.size() - failures.load() << " converted, " << failures.load() << " failed in " << seconds
+              << " s (" << modelThreads << " x " << opts.meshThreads << " threads)\n";
+    return failures.load() == 0 ? 0 : 3;
+}
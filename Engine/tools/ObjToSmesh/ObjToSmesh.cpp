@@ -1,7 +1,9 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
-#include "assets/MeshFormats.h" // reuse SMeshHeaderV0
+#include "assets/MeshFormats.h" // SMeshHeaderV1
+#include "common/MeshCompress.h"
+#include "common/MeshOptimize.h"
 
 #include <cstdint>
 #include <cstdio>
@@ -85,7 +87,7 @@ static int32_t qfloat(float x, float scale)
     return static_cast<int32_t>(std::round(x * scale));
 }
 
-static bool convertObjToSMesh(const fs::path &objPath, const fs::path &outPath)
+static bool convertObjToSMesh(const fs::path &objPath, const fs::path &outPath, bool compress)
 {
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
@@ -203,13 +205,23 @@ static bool convertObjToSMesh(const fs::path &objPath, const fs::path &outPath)
         return false;
     }
 
+    // Vertex cache / overdraw / fetch ordering (the quantized remap above already merged duplicates).
+    const float acmrBefore = tools::ComputeACMR(indices, vertices.size());
+    tools::OptimizeMesh(vertices, indices, [](const VertexPNUT &v)
+                        { return &v.px; });
+    const float acmrAfter = tools::ComputeACMR(indices, vertices.size());
+
     // Normalize positions into a stable [-1, 1] range so the runtime shader can
     // use inPosition directly as clip-space without a camera/model matrix.
     // We center the mesh on its AABB center and scale by the largest half-extent.
     float aabbMin[3], aabbMax[3];
     computeAABB(vertices, aabbMin, aabbMax);
 
-    Engine::SMeshHeaderV0 hdr{};
+    Engine::SMeshHeaderV1 hdr{};
+    hdr.magic = Engine::SMESH_MAGIC;
+    hdr.versionMajor = Engine::SMESH_VERSION_MAJOR;
+    hdr.versionMinor = Engine::SMESH_VERSION_MINOR;
+    hdr.headerSize = sizeof(Engine::SMeshHeaderV1);
     hdr.vertexCount = static_cast<uint32_t>(vertices.size());
     hdr.indexCount = static_cast<uint32_t>(indices.size());
     hdr.vertexStride = sizeof(VertexPNUT); // 32
@@ -221,17 +233,42 @@ static bool convertObjToSMesh(const fs::path &objPath, const fs::path &outPath)
     hdr.aabbMax[1] = aabbMax[1];
     hdr.aabbMax[2] = aabbMax[2];
 
-    const uint32_t headerSize = sizeof(Engine::SMeshHeaderV0);
-    const uint32_t vertexBytes = hdr.vertexCount * hdr.vertexStride;
-    const uint32_t indexBytes = hdr.indexCount * sizeof(uint32_t);
-    hdr.vertexDataOffset = headerSize;
-    hdr.indexDataOffset = headerSize + vertexBytes;
+    const size_t rawVertexBytes = size_t(hdr.vertexCount) * hdr.vertexStride;
+    const size_t rawIndexBytes = size_t(hdr.indexCount) * sizeof(uint32_t);
+    std::vector<uint8_t> vertexSection(reinterpret_cast<const uint8_t *>(vertices.data()),
+                                       reinterpret_cast<const uint8_t *>(vertices.data()) + rawVertexBytes);
+    std::vector<uint8_t> indexSection(reinterpret_cast<const uint8_t *>(indices.data()),
+                                      reinterpret_cast<const uint8_t *>(indices.data()) + rawIndexBytes);
+    if (compress)
+    {
+        // Each stream stays raw unless the codec makes it smaller
+        std::vector<uint8_t> encoded = tools::EncodeVertexBuffer(vertices.data(), vertices.size(), sizeof(VertexPNUT));
+        if (encoded.size() < vertexSection.size())
+        {
+            vertexSection = std::move(encoded);
+            hdr.flags |= Engine::SMESH_VERTEX_CODEC;
+        }
+        encoded = tools::EncodeIndexBuffer(indices.data(), indices.size());
+        if (encoded.size() < indexSection.size())
+        {
+            indexSection = std::move(encoded);
+            hdr.flags |= Engine::SMESH_INDEX_CODEC;
+        }
+    }
+
+    // Sections on 16-byte boundaries
+    auto alignUp = [](uint64_t v)
+    { return (v + Engine::SMESH_SECTION_ALIGNMENT - 1) & ~uint64_t(Engine::SMESH_SECTION_ALIGNMENT - 1); };
+    hdr.vertexDataOffset = alignUp(sizeof(hdr));
+    hdr.vertexDataSize = vertexSection.size();
+    hdr.indexDataOffset = alignUp(hdr.vertexDataOffset + hdr.vertexDataSize);
+    hdr.indexDataSize = indexSection.size();
 
     std::vector<uint8_t> blob;
-    blob.resize(headerSize + vertexBytes + indexBytes);
+    blob.resize(static_cast<size_t>(hdr.indexDataOffset + hdr.indexDataSize), 0);
     std::memcpy(blob.data(), &hdr, sizeof(hdr));
-    std::memcpy(blob.data() + hdr.vertexDataOffset, vertices.data(), vertexBytes);
-    std::memcpy(blob.data() + hdr.indexDataOffset, indices.data(), indexBytes);
+    std::memcpy(blob.data() + hdr.vertexDataOffset, vertexSection.data(), vertexSection.size());
+    std::memcpy(blob.data() + hdr.indexDataOffset, indexSection.data(), indexSection.size());
 
     fs::create_directories(outPath.parent_path());
     if (!writeBinary(outPath.string(), blob))
@@ -239,26 +276,39 @@ static bool convertObjToSMesh(const fs::path &objPath, const fs::path &outPath)
         std::cerr << "Failed to write: " << outPath << "\n";
         return false;
     }
-    std::cout << "Wrote " << outPath << " (verts=" << hdr.vertexCount << ", indices=" << hdr.indexCount << ")\n";
+    std::cout << "Wrote " << outPath << " (verts=" << hdr.vertexCount << ", indices=" << hdr.indexCount
+              << ", ACMR " << acmrBefore << " -> " << acmrAfter << ", " << blob.size() << " bytes, raw "
+              << sizeof(hdr) + rawVertexBytes + rawIndexBytes << ")\n";
     return true;
 }
 
 int main(int argc, char **argv)
 {
-    if (argc < 3)
+    // --compress: store the vertex and index sections with the mesh codec (MeshCodec.h)
+    bool compress = false;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--compress")
+            compress = true;
+        else
+            positional.push_back(arg);
+    }
+    if (positional.size() < 2)
     {
-        std::cerr << "Usage: ObjToSMesh <input_obj_or_dir> <output_dir>\n";
+        std::cerr << "Usage: ObjToSMesh [--compress] <input_obj_or_dir> <output_dir>\n";
         return 1;
     }
-    fs::path input = argv[1];
-    fs::path outDir = argv[2];
+    fs::path input = positional[0];
+    fs::path outDir = positional[1];
     std::error_code ec;
     fs::create_directories(outDir, ec);
 
     if (fs::is_regular_file(input) && input.extension() == ".obj")
     {
         fs::path outPath = outDir / (input.stem().string() + ".smesh");
-        return convertObjToSMesh(input, outPath) ? 0 : 2;
+        return convertObjToSMesh(input, outPath, compress) ? 0 : 2;
     }
     else if (fs::is_directory(input))
     {
@@ -271,7 +321,7 @@ int main(int argc, char **argv)
                 fs::path outPath = outDir / rel;
                 outPath.replace_extension(".smesh");
                 fs::create_directories(outPath.parent_path(), ec);
-                if (!convertObjToSMesh(p.path(), outPath))
+                if (!convertObjToSMesh(p.path(), outPath, compress))
                     failures++;
             }
         }
@@ -0,0 +1,232 @@
+#include "assets/PackFormat.h"
+#include "common/Lz4Compress.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace Engine::pack;
+
+struct PackInput
+{
+    std::string path; // stored path, relative to --base, '/' separated
+    fs::path file;
+};
+
+struct PackedFile
+{
+    PackInput input;
+    std::vector<uint8_t> stored;
+    uint64_t size = 0;
+    PackCompression compression = PackCompression::None;
+};
+
+static bool readBinary(const fs::path &path, std::vector<uint8_t> &out)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return false;
+    const std::streamsize size = in.tellg();
+    if (size < 0)
+        return false;
+    in.seekg(0, std::ios::beg);
+    out.resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(in.read(reinterpret_cast<char *>(out.data()), size));
+}
+
+static uint64_t alignUp(uint64_t v, uint64_t a)
+{
+    return (v + a - 1) / a * a;
+}
+
+static void printUsage()
+{
+    std::cerr << "Usage: PackAssets <output.spak> <input_file_or_dir>... [--base <dir>] [--lz4]\n"
+              << "  Inputs are resolved against --base (default: the current directory) and stored\n"
+              << "  under their path relative to it, e.g. --base bin entities assets Scinerio.json\n"
+              << "  --lz4  LZ4-compress entries that shrink (default: store everything uncompressed)\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const fs::path output = argv[1];
+    fs::path base = fs::current_path();
+    bool useLz4 = false;
+    std::vector<std::string> inputArgs;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--lz4")
+            useLz4 = true;
+        else if (arg == "--base" && i + 1 < argc)
+            base = argv[++i];
+        else if (arg.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+        else
+            inputArgs.push_back(arg);
+    }
+
+    std::error_code ec;
+    base = fs::absolute(base, ec);
+    const fs::path outputAbs = fs::absolute(output, ec);
+
+    // Collect files; the first input naming a path wins
+    std::vector<PackInput> inputs;
+    std::set<std::string> seen;
+    auto addFile = [&](const fs::path &file)
+    {
+        if (fs::equivalent(file, outputAbs, ec))
+            return;
+        const std::string rel = fs::relative(file, base, ec).generic_string();
+        if (ec || rel.empty() || rel.rfind("..", 0) == 0)
+        {
+            std::cerr << "Skipping " << file.string() << ": not under " << base.string() << "\n";
+            return;
+        }
+        if (seen.insert(rel).second)
+            inputs.push_back({rel, file});
+    };
+
+    for (const std::string &arg : inputArgs)
+    {
+        const fs::path p = fs::absolute(base / arg, ec);
+        if (fs::is_regular_file(p))
+            addFile(p);
+        else if (fs::is_directory(p))
+        {
+            std::vector<fs::path> files;
+            for (auto &entry : fs::recursive_directory_iterator(p))
+            {
+                if (entry.is_regular_file())
+                    files.push_back(entry.path());
+            }
+            std::sort(files.begin(), files.end());
+            for (const fs::path &f : files)
+                addFile(f);
+        }
+        else
+        {
+            std::cerr << "Input not found: " << p.string() << "\n";
+            return 2;
+        }
+    }
+
+    if (inputs.empty())
+    {
+        std::cerr << "Nothing to pack\n";
+        return 2;
+    }
+
+    // Read (and compress) every file
+    std::vector<PackedFile> files;
+    files.reserve(inputs.size());
+    uint64_t totalSize = 0;
+    uint64_t totalStored = 0;
+    uint32_t compressedCount = 0;
+    for (PackInput &in : inputs)
+    {
+        PackedFile f;
+        f.input = std::move(in);
+        if (!readBinary(f.input.file, f.stored))
+        {
+            std::cerr << "Failed to read " << f.input.file.string() << "\n";
+            return 3;
+        }
+        f.size = f.stored.size();
+        if (useLz4 && !f.stored.empty())
+        {
+            std::vector<uint8_t> lz4 = tools::CompressLZ4Block(f.stored.data(), f.stored.size());
+            if (lz4.size() < f.stored.size())
+            {
+                f.stored = std::move(lz4);
+                f.compression = PackCompression::LZ4;
+                ++compressedCount;
+            }
+        }
+        totalSize += f.size;
+        totalStored += f.stored.size();
+        files.push_back(std::move(f));
+    }
+
+    // TOC sorted by hash; equal hashes (collisions) are told apart by path at read time
+    std::stable_sort(files.begin(), files.end(), [](const PackedFile &a, const PackedFile &b)
+                     { return HashPath(a.input.path) < HashPath(b.input.path); });
+
+    std::vector<char> strings;
+    std::vector<PackEntry> toc(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        toc[i].pathHash = HashPath(files[i].input.path);
+        toc[i].pathOffset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), files[i].input.path.begin(), files[i].input.path.end());
+        strings.push_back('\0');
+    }
+
+    PackHeader header{};
+    std::memcpy(header.magic, "SPAK", 4);
+    header.version = kPackVersion;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    header.tocOffset = sizeof(PackHeader);
+    header.stringTableOffset = header.tocOffset + toc.size() * sizeof(PackEntry);
+    header.stringTableSize = strings.size();
+
+    uint64_t cursor = header.stringTableOffset + header.stringTableSize;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        cursor = alignUp(cursor, kPackDataAlignment);
+        toc[i].offset = cursor;
+        toc[i].size = files[i].size;
+        toc[i].storedSize = files[i].stored.size();
+        toc[i].compression = static_cast<uint32_t>(files[i].compression);
+        cursor += toc[i].storedSize;
+    }
+    header.fileSizeBytes = cursor;
+
+    if (!output.parent_path().empty())
+        fs::create_directories(output.parent_path(), ec);
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Failed to open " << output.string() << " for writing\n";
+        return 4;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(PackEntry)));
+    out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+    uint64_t written = header.stringTableOffset + header.stringTableSize;
+    static const char kZeros[kPackDataAlignment] = {};
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        out.write(kZeros, static_cast<std::streamsize>(toc[i].offset - written));
+        out.write(reinterpret_cast<const char *>(files[i].stored.data()), static_cast<std::streamsize>(files[i].stored.size()));
+        written = toc[i].offset + toc[i].storedSize;
+    }
+    if (!out)
+    {
+        std::cerr << "Failed writing " << output.string() << "\n";
+        return 4;
+    }
+
+    std::cout << "PackAssets: " << files.size() << " files -> " << output.string() << "\n"
+              << "  " << totalSize << " bytes -> " << totalStored << " stored (" << compressedCount
+              << " LZ4), pack " << header.fileSizeBytes << " bytes\n";
+    return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+// ------------------------------------------------------------
+// LZ4 block compression for the asset packer
+// ------------------------------------------------------------
+// Emits the raw LZ4 block format (no frame) that VirtualFileSystem decompresses. Greedy parse with
+// a single-entry hash table: fast and small, roughly what LZ4's default level produces. Honors
+// the format's end-of-block rules (last 5 bytes are literals, no match starts in the last 12).
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace tools
+{
+    namespace lz4_detail
+    {
+        static constexpr size_t kMinMatch = 4;
+        static constexpr size_t kLastLiterals = 5;
+        static constexpr size_t kMatchStartLimit = 12;
+        static constexpr size_t kMaxOffset = 65535;
+        static constexpr int kHashBits = 16;
+
+        inline uint32_t Read32(const uint8_t *p)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline void PutLength(std::vector<uint8_t> &out, size_t length)
+        {
+            while (length >= 255)
+            {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back(static_cast<uint8_t>(length));
+        }
+
+        inline void PutSequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t literalCount,
+                                size_t offset, size_t matchLength)
+        {
+            const size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+            const uint8_t token = static_cast<uint8_t>(((literalCount < 15 ? literalCount : 15) << 4) |
+                                                       (matchCode < 15 ? matchCode : 15));
+            out.push_back(token);
+            if (literalCount >= 15)
+                PutLength(out, literalCount - 15);
+            out.insert(out.end(), literals, literals + literalCount);
+            if (!matchLength)
+                return;
+            out.push_back(static_cast<uint8_t>(offset & 0xFF));
+            out.push_back(static_cast<uint8_t>(offset >> 8));
+            if (matchCode >= 15)
+                PutLength(out, matchCode - 15);
+        }
+    } // namespace lz4_detail
+
+    inline std::vector<uint8_t> CompressLZ4Block(const uint8_t *src, size_t size)
+    {
+        using namespace lz4_detail;
+
+        std::vector<uint8_t> out;
+        out.reserve(size + size / 255 + 16);
+
+        size_t anchor = 0;
+        if (size > kMatchStartLimit)
+        {
+            std::vector<uint32_t> table(size_t(1) << kHashBits, UINT32_MAX);
+            const size_t matchEndLimit = size - kLastLiterals;
+
+            size_t i = 0;
+            while (i + kMatchStartLimit < size)
+            {
+                const uint32_t seq = Read32(src + i);
+                const uint32_t h = (seq * 2654435761u) >> (32 - kHashBits);
+                const uint32_t candidate = table[h];
+                table[h] = static_cast<uint32_t>(i);
+
+                if (candidate == UINT32_MAX || i - candidate > kMaxOffset || Read32(src + candidate) != seq)
+                {
+                    ++i;
+                    continue;
+                }
+
+                size_t length = kMinMatch;
+                while (i + length < matchEndLimit && src[candidate + length] == src[i + length])
+                    ++length;
+
+                PutSequence(out, src + anchor, i - anchor, i - candidate, length);
+                i += length;
+                anchor = i;
+            }
+        }
+
+        PutSequence(out, src + anchor, size - anchor, 0, 0);
+        return out;
+    }
+
+} // namespace tools
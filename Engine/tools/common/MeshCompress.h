@@ -0,0 +1,134 @@
+#pragma once
+
+// ------------------------------------------------------------
+// Vertex / index stream encoders for .smesh v1 and .smodel V9
+// ------------------------------------------------------------
+// Emits the streams described in assets/MeshCodec.h, which the runtime decodes (MeshCodec.cpp).
+// Run them on vertex-cache / vertex-fetch optimized geometry (MeshOptimize.h): the codecs only
+// pay off when neighbouring vertices and indices are close. Callers keep the raw bytes when the
+// encoded stream is not smaller.
+
+#include "assets/MeshCodec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace tools
+{
+    namespace meshcodec_detail
+    {
+        inline uint8_t Zigzag8(uint8_t v)
+        {
+            const int8_t s = static_cast<int8_t>(v);
+            return static_cast<uint8_t>((uint8_t(s) << 1) ^ uint8_t(s >> 7));
+        }
+
+        inline uint32_t Zigzag32(uint32_t v)
+        {
+            const int32_t s = static_cast<int32_t>(v);
+            return (v << 1) ^ uint32_t(s >> 31);
+        }
+
+        // One byte lane: group modes in the header, then each group at the smallest width that holds it
+        inline void EncodeLane(std::vector<uint8_t> &out, const uint8_t *deltas, uint32_t groups)
+        {
+            using Engine::meshcodec::kVertexGroupSize;
+
+            const size_t headerAt = out.size();
+            out.resize(out.size() + (groups + 3u) / 4u, 0);
+            for (uint32_t g = 0; g < groups; ++g)
+            {
+                const uint8_t *d = deltas + size_t(g) * kVertexGroupSize;
+                uint8_t maxValue = 0;
+                for (uint32_t i = 0; i < kVertexGroupSize; ++i)
+                    maxValue = d[i] > maxValue ? d[i] : maxValue;
+
+                const uint32_t mode = maxValue == 0 ? 0u : maxValue < 4 ? 1u : maxValue < 16 ? 2u : 3u;
+                out[headerAt + g / 4u] |= static_cast<uint8_t>(mode << ((g % 4u) * 2u));
+                if (mode == 1)
+                {
+                    uint8_t packed[4] = {};
+                    for (uint32_t i = 0; i < kVertexGroupSize; ++i)
+                        packed[i >> 2] |= static_cast<uint8_t>(d[i] << ((i & 3u) * 2u));
+                    out.insert(out.end(), packed, packed + 4);
+                }
+                else if (mode == 2)
+                {
+                    uint8_t packed[8] = {};
+                    for (uint32_t i = 0; i < kVertexGroupSize; ++i)
+                        packed[i >> 1] |= static_cast<uint8_t>(d[i] << ((i & 1u) * 4u));
+                    out.insert(out.end(), packed, packed + 8);
+                }
+                else if (mode == 3)
+                    out.insert(out.end(), d, d + kVertexGroupSize);
+            }
+        }
+    } // namespace meshcodec_detail
+
+    // 'stride' must be at most Engine::meshcodec::kMaxVertexStride.
+    inline std::vector<uint8_t> EncodeVertexBuffer(const void *vertices, size_t vertexCount, size_t stride)
+    {
+        using namespace Engine::meshcodec;
+        using namespace meshcodec_detail;
+
+        const uint8_t *src = static_cast<const uint8_t *>(vertices);
+        std::vector<uint8_t> out;
+        out.reserve(vertexCount * stride / 2 + 16);
+        out.push_back(kVertexCodecHeader);
+
+        const uint32_t blockSize = VertexBlockSize(static_cast<uint32_t>(stride));
+        uint8_t last[kMaxVertexStride] = {};
+        uint8_t deltas[kVertexBlockMaxVertices];
+
+        for (size_t begin = 0; begin < vertexCount; begin += blockSize)
+        {
+            const size_t count = (vertexCount - begin < blockSize) ? vertexCount - begin : blockSize;
+            const uint32_t groups = static_cast<uint32_t>((count + kVertexGroupSize - 1) / kVertexGroupSize);
+
+            for (size_t k = 0; k < stride; ++k)
+            {
+                std::memset(deltas, 0, sizeof(deltas));
+                uint8_t previous = last[k];
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const uint8_t value = src[(begin + i) * stride + k];
+                    deltas[i] = Zigzag8(static_cast<uint8_t>(value - previous));
+                    previous = value;
+                }
+                last[k] = previous;
+                EncodeLane(out, deltas, groups);
+            }
+        }
+        return out;
+    }
+
+    inline std::vector<uint8_t> EncodeIndexBuffer(const uint32_t *indices, size_t indexCount)
+    {
+        using namespace meshcodec_detail;
+
+        std::vector<uint8_t> out;
+        out.reserve(indexCount * 2 + 16);
+        out.push_back(Engine::meshcodec::kIndexCodecHeader);
+
+        uint32_t last[2] = {0, 0};
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            const uint32_t index = indices[i];
+            const uint32_t d0 = Zigzag32(index - last[0]);
+            const uint32_t d1 = Zigzag32(index - last[1]);
+            const uint32_t baseline = d1 < d0 ? 1u : 0u;
+            last[baseline] = index;
+
+            uint64_t v = (uint64_t(baseline ? d1 : d0) << 1) | baseline;
+            while (v >= 0x80u)
+            {
+                out.push_back(static_cast<uint8_t>(v | 0x80u));
+                v >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(v));
+        }
+        return out;
+    }
+
+} // namespace tools
@@ -0,0 +1,414 @@
+#pragma once
+
+// ------------------------------------------------------------
+// Offline index/vertex buffer optimization shared by the converters
+// ------------------------------------------------------------
+// Run in this order on a triangle list (the meshoptimizer pipeline):
+//   1) DeduplicateVertices   - bitwise-identical vertices collapse into one
+//   2) OptimizeVertexCache   - triangle order for post-transform cache reuse (Forsyth scoring)
+//   3) OptimizeOverdraw      - cache-friendly clusters sorted outside-in (Sander et al.)
+//   4) OptimizeVertexFetch   - vertices renumbered in first-use order, unreferenced ones dropped
+// Each step keeps the mesh's triangles (and their winding) unchanged; only order and numbering move.
+//
+// Vertex types must be trivially copyable with no padding; positions are read through a
+// `const float *(const V &)` accessor returning x, y, z.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace tools
+{
+    // Post-transform cache model of the scoring and statistics (typical hardware reuse window).
+    static constexpr uint32_t kVertexCacheSize = 16;
+
+    // Overdraw clusters may cost at most this much ACMR over the cache-optimized order.
+    static constexpr float kOverdrawThreshold = 1.05f;
+
+    // Average cache miss ratio: transformed vertices per triangle with a FIFO cache of cacheSize.
+    // 0.5 is ideal for a regular grid, 3 is no reuse at all.
+    inline float ComputeACMR(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = kVertexCacheSize)
+    {
+        if (indices.size() < 3)
+            return 0.0f;
+
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t timestamp = cacheSize + 1;
+        size_t misses = 0;
+        for (uint32_t v : indices)
+        {
+            if (timestamp - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = timestamp++;
+                ++misses;
+            }
+        }
+        return float(misses) / float(indices.size() / 3);
+    }
+
+    // Collapses vertices with identical bytes and rewrites the indices. Returns the new vertex count.
+    template <typename V>
+    size_t DeduplicateVertices(std::vector<V> &vertices, std::vector<uint32_t> &indices)
+    {
+        static_assert(std::is_trivially_copyable<V>::value, "vertices are compared bytewise");
+        if (vertices.empty())
+            return 0;
+
+        auto hashVertex = [](const V &v) -> uint64_t
+        {
+            uint64_t h = 1469598103934665603ull;
+            const unsigned char *p = reinterpret_cast<const unsigned char *>(&v);
+            for (size_t i = 0; i < sizeof(V); ++i)
+            {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+            return h;
+        };
+
+        // Open addressing over unique vertex ids, power of two capacity at <= 50% load.
+        size_t capacity = 1;
+        while (capacity < vertices.size() * 2)
+            capacity <<= 1;
+        const uint32_t kEmpty = ~0u;
+        std::vector<uint32_t> table(capacity, kEmpty);
+
+        std::vector<V> unique;
+        unique.reserve(vertices.size());
+        std::vector<uint32_t> remap(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            size_t slot = size_t(hashVertex(vertices[i])) & (capacity - 1);
+            for (;;)
+            {
+                const uint32_t id = table[slot];
+                if (id == kEmpty)
+                {
+                    table[slot] = static_cast<uint32_t>(unique.size());
+                    remap[i] = table[slot];
+                    unique.push_back(vertices[i]);
+                    break;
+                }
+                if (std::memcmp(&unique[id], &vertices[i], sizeof(V)) == 0)
+                {
+                    remap[i] = id;
+                    break;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+        }
+
+        for (uint32_t &ix : indices)
+            ix = remap[ix];
+        vertices.swap(unique);
+        return vertices.size();
+    }
+
+    // Reorders triangles for post-transform vertex cache reuse: greedy emission of the best
+    // scoring triangle next to the simulated cache (Forsyth's algorithm with meshoptimizer's
+    // tuned score tables). Disconnected pieces continue from the lowest unemitted triangle.
+    inline void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount)
+    {
+        const size_t faceCount = indices.size() / 3;
+        if (faceCount < 2 || vertexCount == 0)
+            return;
+
+        static constexpr uint32_t kCacheSize = kVertexCacheSize;
+        static constexpr uint32_t kValenceMax = 8;
+        static const float kScoreCache[kCacheSize + 1] = {0.0f, 0.779f, 0.791f, 0.789f, 0.981f, 0.843f, 0.726f, 0.847f, 0.882f,
+                                                          0.867f, 0.799f, 0.642f, 0.613f, 0.600f, 0.568f, 0.372f, 0.234f};
+        static const float kScoreLive[kValenceMax + 1] = {0.0f, 0.995f, 0.713f, 0.450f, 0.404f, 0.059f, 0.005f, 0.147f, 0.006f};
+
+        // cachePosition: -1 when not cached, else 0 = most recent
+        auto vertexScore = [&](int32_t cachePosition, uint32_t liveTriangles) -> float
+        {
+            return kScoreCache[1 + cachePosition] + kScoreLive[std::min(liveTriangles, kValenceMax)];
+        };
+
+        // Vertex -> triangles adjacency; triangles are removed from it as they're emitted.
+        std::vector<uint32_t> liveCount(vertexCount, 0);
+        for (uint32_t v : indices)
+            ++liveCount[v];
+        std::vector<uint32_t> adjOffset(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+            adjOffset[v + 1] = adjOffset[v] + liveCount[v];
+        std::vector<uint32_t> adjFill(adjOffset.begin(), adjOffset.end() - 1);
+        std::vector<uint32_t> adjacency(indices.size());
+        for (size_t f = 0; f < faceCount; ++f)
+            for (size_t k = 0; k < 3; ++k)
+                adjacency[adjFill[indices[f * 3 + k]]++] = static_cast<uint32_t>(f);
+
+        std::vector<float> vScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            vScore[v] = vertexScore(-1, liveCount[v]);
+
+        std::vector<float> tScore(faceCount);
+        for (size_t f = 0; f < faceCount; ++f)
+            tScore[f] = vScore[indices[f * 3 + 0]] + vScore[indices[f * 3 + 1]] + vScore[indices[f * 3 + 2]];
+
+        std::vector<uint8_t> emitted(faceCount, 0);
+        std::vector<uint32_t> out;
+        out.reserve(indices.size());
+
+        uint32_t cache[kCacheSize + 3];
+        uint32_t cacheNew[kCacheSize + 3];
+        uint32_t cacheCount = 0;
+        size_t inputCursor = 0;
+        int64_t current = 0;
+
+        while (current >= 0)
+        {
+            const size_t f = size_t(current);
+            const uint32_t a = indices[f * 3 + 0], b = indices[f * 3 + 1], c = indices[f * 3 + 2];
+            out.push_back(a);
+            out.push_back(b);
+            out.push_back(c);
+            emitted[f] = 1;
+
+            // New cache: the triangle's vertices in front, then the old entries (minus duplicates).
+            uint32_t newCount = 0;
+            cacheNew[newCount++] = a;
+            if (b != a)
+                cacheNew[newCount++] = b;
+            if (c != a && c != b)
+                cacheNew[newCount++] = c;
+            for (uint32_t i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t v = cache[i];
+                if (v != a && v != b && v != c)
+                    cacheNew[newCount++] = v;
+            }
+            std::copy(cacheNew, cacheNew + newCount, cache);
+            cacheCount = std::min(newCount, kCacheSize);
+
+            // Remove the triangle from its vertices' adjacency.
+            const uint32_t corners[3] = {a, b, c};
+            for (uint32_t v : corners)
+            {
+                uint32_t *list = adjacency.data() + adjOffset[v];
+                const uint32_t n = liveCount[v];
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    if (list[i] == f)
+                    {
+                        list[i] = list[n - 1];
+                        break;
+                    }
+                }
+                --liveCount[v];
+            }
+
+            // Rescore the cache and the entries past kCacheSize that just fell out of it (as uncached),
+            // then continue with the best scoring triangle touching them.
+            current = -1;
+            float bestScore = 0.0f;
+            for (uint32_t i = 0; i < newCount; ++i)
+            {
+                const uint32_t v = cache[i];
+                const int32_t position = (i < kCacheSize) ? int32_t(i) : -1;
+                const float score = vertexScore(position, liveCount[v]);
+                const float delta = score - vScore[v];
+                vScore[v] = score;
+
+                const uint32_t *list = adjacency.data() + adjOffset[v];
+                for (uint32_t t = 0; t < liveCount[v]; ++t)
+                {
+                    const uint32_t tri = list[t];
+                    tScore[tri] += delta;
+                    if (tScore[tri] > bestScore)
+                    {
+                        bestScore = tScore[tri];
+                        current = tri;
+                    }
+                }
+            }
+
+            if (current < 0)
+            {
+                while (inputCursor < faceCount && emitted[inputCursor])
+                    ++inputCursor;
+                if (inputCursor < faceCount)
+                    current = int64_t(inputCursor);
+            }
+        }
+
+        indices.swap(out);
+    }
+
+    // Reorders triangles to reduce overdraw without giving up much cache reuse (Sander, Nehab and
+    // Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"). Expects the
+    // output of OptimizeVertexCache: it is split at cache breaks into clusters, and clusters are
+    // sorted so those facing away from the mesh center (its silhouette, likely occluders) draw first.
+    template <typename V, typename PositionOf>
+    void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<V> &vertices, PositionOf positionOf,
+                          float threshold = kOverdrawThreshold)
+    {
+        const size_t faceCount = indices.size() / 3;
+        if (faceCount < 2 || vertices.empty())
+            return;
+
+        constexpr uint32_t kCacheSize = kVertexCacheSize;
+        std::vector<uint32_t> timestamps(vertices.size(), 0);
+        uint32_t timestamp = kCacheSize + 1;
+        auto updateCache = [&](size_t f) -> uint32_t
+        {
+            uint32_t misses = 0;
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v = indices[f * 3 + k];
+                if (timestamp - timestamps[v] > kCacheSize)
+                {
+                    timestamps[v] = timestamp++;
+                    ++misses;
+                }
+            }
+            return misses;
+        };
+
+        // Hard boundaries: a triangle missing all three vertices starts a new patch.
+        std::vector<uint32_t> hard;
+        for (size_t f = 0; f < faceCount; ++f)
+        {
+            if (updateCache(f) == 3 || f == 0)
+                hard.push_back(static_cast<uint32_t>(f));
+        }
+
+        // Soft boundaries: split each patch wherever the running ACMR is already within threshold of
+        // the patch's own, so the split doesn't cost more than that.
+        std::vector<uint32_t> clusters;
+        for (size_t h = 0; h < hard.size(); ++h)
+        {
+            const size_t start = hard[h];
+            const size_t end = (h + 1 < hard.size()) ? hard[h + 1] : faceCount;
+
+            timestamp += kCacheSize + 1;
+            uint32_t patchMisses = 0;
+            for (size_t f = start; f < end; ++f)
+                patchMisses += updateCache(f);
+            const float patchThreshold = threshold * float(patchMisses) / float(end - start);
+
+            const size_t firstCluster = clusters.size();
+            clusters.push_back(static_cast<uint32_t>(start));
+            timestamp += kCacheSize + 1;
+            uint32_t runMisses = 0, runFaces = 0;
+            for (size_t f = start; f < end; ++f)
+            {
+                runMisses += updateCache(f);
+                ++runFaces;
+                if (float(runMisses) / float(runFaces) <= patchThreshold)
+                {
+                    clusters.push_back(static_cast<uint32_t>(f + 1));
+                    timestamp += kCacheSize + 1;
+                    runMisses = 0;
+                    runFaces = 0;
+                }
+            }
+
+            // Drop the empty cluster a split on the last triangle leaves, and fold an unfinished
+            // tail (the run never got under the threshold) into the cluster before it.
+            if (clusters.back() == end)
+                clusters.pop_back();
+            else if (runFaces > 0 && clusters.size() - firstCluster > 1)
+                clusters.pop_back();
+        }
+
+        // Sort key per cluster: dot(cluster centroid - mesh centroid, cluster normal), area-weighted.
+        double meshCentroid[3] = {0.0, 0.0, 0.0};
+        for (uint32_t v : indices)
+        {
+            const float *p = positionOf(vertices[v]);
+            meshCentroid[0] += p[0];
+            meshCentroid[1] += p[1];
+            meshCentroid[2] += p[2];
+        }
+        for (double &c : meshCentroid)
+            c /= double(indices.size());
+
+        std::vector<float> sortKey(clusters.size());
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            const size_t start = clusters[c];
+            const size_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : faceCount;
+
+            float centroid[3] = {0.0f, 0.0f, 0.0f};
+            float normal[3] = {0.0f, 0.0f, 0.0f};
+            float areaSum = 0.0f;
+            for (size_t f = start; f < end; ++f)
+            {
+                const float *p0 = positionOf(vertices[indices[f * 3 + 0]]);
+                const float *p1 = positionOf(vertices[indices[f * 3 + 1]]);
+                const float *p2 = positionOf(vertices[indices[f * 3 + 2]]);
+                const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                const float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (int k = 0; k < 3; ++k)
+                {
+                    centroid[k] += (p0[k] + p1[k] + p2[k]) * (area / 3.0f);
+                    normal[k] += n[k];
+                }
+                areaSum += area;
+            }
+
+            const float invArea = (areaSum > 0.0f) ? 1.0f / areaSum : 0.0f;
+            const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            const float invNormal = (normalLength > 0.0f) ? 1.0f / normalLength : 0.0f;
+            float key = 0.0f;
+            for (int k = 0; k < 3; ++k)
+                key += (centroid[k] * invArea - float(meshCentroid[k])) * (normal[k] * invNormal);
+            sortKey[c] = key;
+        }
+
+        std::vector<uint32_t> order(clusters.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                         { return sortKey[a] > sortKey[b]; });
+
+        std::vector<uint32_t> out;
+        out.reserve(indices.size());
+        for (uint32_t c : order)
+        {
+            const size_t start = clusters[c];
+            const size_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : faceCount;
+            out.insert(out.end(), indices.begin() + start * 3, indices.begin() + end * 3);
+        }
+        indices.swap(out);
+    }
+
+    // Renumbers vertices in the order the index buffer first references them, so vertex fetch
+    // walks memory mostly forward. Unreferenced vertices are dropped. Returns the new vertex count.
+    template <typename V>
+    size_t OptimizeVertexFetch(std::vector<V> &vertices, std::vector<uint32_t> &indices)
+    {
+        const uint32_t kUnused = ~0u;
+        std::vector<uint32_t> remap(vertices.size(), kUnused);
+        std::vector<V> out;
+        out.reserve(vertices.size());
+        for (uint32_t &ix : indices)
+        {
+            if (remap[ix] == kUnused)
+            {
+                remap[ix] = static_cast<uint32_t>(out.size());
+                out.push_back(vertices[ix]);
+            }
+            ix = remap[ix];
+        }
+        vertices.swap(out);
+        return vertices.size();
+    }
+
+    // The full pipeline above, in order.
+    template <typename V, typename PositionOf>
+    void OptimizeMesh(std::vector<V> &vertices, std::vector<uint32_t> &indices, PositionOf positionOf)
+    {
+        DeduplicateVertices(vertices, indices);
+        OptimizeVertexCache(indices, vertices.size());
+        OptimizeOverdraw(indices, vertices, positionOf);
+        OptimizeVertexFetch(vertices, indices);
+    }
+
+} // namespace tools
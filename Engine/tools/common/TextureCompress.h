@@ -0,0 +1,364 @@
+#pragma once
+
+// ------------------------------------------------------------
+// Offline BCn texture compression shared by the converters
+// ------------------------------------------------------------
+// Produces the .smodel V8 block-compressed layout (assets/model/SModelTextureRecord.h): the full
+// mip chain down to 1x1, mip 0 first, each mip's 4x4 blocks in row order. Runtime uploads it as
+// stored, so there is no image decode and no mip generation at load.
+//   - BC1: RGB endpoints along the principal axis of the block's colors, refined by least squares
+//   - BC3: BC1 color + BC4 alpha
+//   - BC5: two BC4 channels (red/green; tangent-space normal x/y)
+// Mips are box-filtered from the previous level, averaging sRGB color in linear space.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "assets/ModelFormat.h"
+
+namespace tools
+{
+    struct RgbaImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> rgba; // width * height * 4
+    };
+
+    // Least-squares refinement passes of the BC1 endpoints.
+    static constexpr int kBC1RefineIterations = 2;
+
+    inline bool HasAlpha(const RgbaImage &image)
+    {
+        for (size_t i = 3; i < image.rgba.size(); i += 4)
+        {
+            if (image.rgba[i] != 255)
+                return true;
+        }
+        return false;
+    }
+
+    inline const float *SrgbToLinearTable()
+    {
+        static const std::vector<float> table = []
+        {
+            std::vector<float> t(256);
+            for (int i = 0; i < 256; ++i)
+            {
+                const float c = float(i) / 255.0f;
+                t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return t;
+        }();
+        return table.data();
+    }
+
+    inline uint8_t LinearToSrgb8(float c)
+    {
+        c = std::clamp(c, 0.0f, 1.0f);
+        const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::lround(s * 255.0f));
+    }
+
+    // Next mip: 2x2 box filter (edges clamp for odd sizes).
+    inline RgbaImage DownsampleImage(const RgbaImage &src, bool srgb)
+    {
+        RgbaImage dst;
+        dst.width = std::max(src.width / 2, 1u);
+        dst.height = std::max(src.height / 2, 1u);
+        dst.rgba.resize(size_t(dst.width) * dst.height * 4u);
+
+        const float *toLinear = SrgbToLinearTable();
+        for (uint32_t y = 0; y < dst.height; ++y)
+        {
+            const uint32_t y0 = std::min(y * 2, src.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+            for (uint32_t x = 0; x < dst.width; ++x)
+            {
+                const uint32_t x0 = std::min(x * 2, src.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+                const uint8_t *p[4] = {&src.rgba[(size_t(y0) * src.width + x0) * 4u], &src.rgba[(size_t(y0) * src.width + x1) * 4u],
+                                       &src.rgba[(size_t(y1) * src.width + x0) * 4u], &src.rgba[(size_t(y1) * src.width + x1) * 4u]};
+                uint8_t *out = &dst.rgba[(size_t(y) * dst.width + x) * 4u];
+                for (int c = 0; c < 4; ++c)
+                {
+                    if (srgb && c < 3)
+                    {
+                        const float sum = toLinear[p[0][c]] + toLinear[p[1][c]] + toLinear[p[2][c]] + toLinear[p[3][c]];
+                        out[c] = LinearToSrgb8(sum * 0.25f);
+                    }
+                    else
+                    {
+                        out[c] = static_cast<uint8_t>((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+                    }
+                }
+            }
+        }
+        return dst;
+    }
+
+    // ------------------------------------------------------------
+    // Block encoders
+    // ------------------------------------------------------------
+
+    inline uint16_t PackRgb565(const float (&c)[3])
+    {
+        const auto q = [](float v, int maxValue)
+        { return static_cast<uint16_t>(std::clamp(std::lround(v * float(maxValue) / 255.0f), 0L, long(maxValue))); };
+        return static_cast<uint16_t>((q(c[0], 31) << 11) | (q(c[1], 63) << 5) | q(c[2], 31));
+    }
+
+    // Bit replication, as the hardware expands it
+    inline void UnpackRgb565(uint16_t c, float (&out)[3])
+    {
+        const uint32_t r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        out[0] = float((r << 3) | (r >> 2));
+        out[1] = float((g << 2) | (g >> 4));
+        out[2] = float((b << 3) | (b >> 2));
+    }
+
+    // 16 texels (row-major RGBA) -> 8 bytes, always the 4-color mode (c0 > c1, or c0 == c1 with index 0)
+    inline void EncodeBC1Block(const uint8_t (&texels)[16][4], uint8_t *out)
+    {
+        float px[16][3];
+        float mean[3] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                px[i][c] = float(texels[i][c]);
+                mean[c] += px[i][c] / 16.0f;
+            }
+        }
+
+        // Principal axis of the colors (power iteration on the covariance)
+        float cov[6] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            const float d[3] = {px[i][0] - mean[0], px[i][1] - mean[1], px[i][2] - mean[2]};
+            cov[0] += d[0] * d[0];
+            cov[1] += d[0] * d[1];
+            cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1];
+            cov[4] += d[1] * d[2];
+            cov[5] += d[2] * d[2];
+        }
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        for (int it = 0; it < 8; ++it)
+        {
+            const float next[3] = {cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                                   cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                                   cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+            const float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+            if (len < 1e-6f)
+                break;
+            for (int c = 0; c < 3; ++c)
+                axis[c] = next[c] / len;
+        }
+
+        float tMin = 0.0f, tMax = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            const float t = (px[i][0] - mean[0]) * axis[0] + (px[i][1] - mean[1]) * axis[1] + (px[i][2] - mean[2]) * axis[2];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+        float e0[3], e1[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            e0[c] = mean[c] + axis[c] * tMax;
+            e1[c] = mean[c] + axis[c] * tMin;
+        }
+
+        uint16_t bestC0 = 0, bestC1 = 0;
+        uint8_t bestIdx[16] = {};
+        float bestError = -1.0f;
+        for (int pass = 0; pass <= kBC1RefineIterations; ++pass)
+        {
+            const uint16_t c0 = PackRgb565(e0);
+            const uint16_t c1 = PackRgb565(e1);
+            float palette[4][3];
+            UnpackRgb565(c0, palette[0]);
+            UnpackRgb565(c1, palette[1]);
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+
+            uint8_t idx[16];
+            float error = 0.0f;
+            for (int i = 0; i < 16; ++i)
+            {
+                float best = 1e30f;
+                idx[i] = 0;
+                for (uint8_t k = 0; k < (c0 == c1 ? 1 : 4); ++k)
+                {
+                    const float dr = px[i][0] - palette[k][0], dg = px[i][1] - palette[k][1], db = px[i][2] - palette[k][2];
+                    const float d = dr * dr + dg * dg + db * db;
+                    if (d < best)
+                    {
+                        best = d;
+                        idx[i] = k;
+                    }
+                }
+                error += best;
+            }
+            if (bestError < 0.0f || error < bestError)
+            {
+                bestError = error;
+                bestC0 = c0;
+                bestC1 = c1;
+                std::memcpy(bestIdx, idx, sizeof(idx));
+            }
+            if (c0 == c1 || pass == kBC1RefineIterations)
+                break;
+
+            // Least squares endpoints for these indices: x_i ~ a_i * e0 + (1 - a_i) * e1
+            static constexpr float kWeight[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[3] = {}, bx[3] = {};
+            for (int i = 0; i < 16; ++i)
+            {
+                const float a = kWeight[idx[i]], b = 1.0f - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int c = 0; c < 3; ++c)
+                {
+                    ax[c] += a * px[i][c];
+                    bx[c] += b * px[i][c];
+                }
+            }
+            const float det = aa * bb - ab * ab;
+            if (std::fabs(det) < 1e-6f)
+                break;
+            for (int c = 0; c < 3; ++c)
+            {
+                e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+                e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+            }
+        }
+
+        // c0 < c1 would select the 3-color mode: swap the endpoints and mirror the indices
+        if (bestC0 < bestC1)
+        {
+            std::swap(bestC0, bestC1);
+            static constexpr uint8_t kSwapped[4] = {1, 0, 3, 2};
+            for (uint8_t &i : bestIdx)
+                i = kSwapped[i];
+        }
+        else if (bestC0 == bestC1)
+        {
+            std::memset(bestIdx, 0, sizeof(bestIdx));
+        }
+
+        uint32_t indices = 0;
+        for (int i = 0; i < 16; ++i)
+            indices |= uint32_t(bestIdx[i]) << (2 * i);
+        out[0] = uint8_t(bestC0 & 0xFF);
+        out[1] = uint8_t(bestC0 >> 8);
+        out[2] = uint8_t(bestC1 & 0xFF);
+        out[3] = uint8_t(bestC1 >> 8);
+        std::memcpy(out + 4, &indices, 4); // little-endian
+    }
+
+    // One channel of 16 texels -> 8 bytes (8-value mode, endpoints at the block's min and max)
+    inline void EncodeBC4Block(const uint8_t (&texels)[16][4], int channel, uint8_t *out)
+    {
+        uint8_t lo = 255, hi = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            lo = std::min(lo, texels[i][channel]);
+            hi = std::max(hi, texels[i][channel]);
+        }
+
+        std::memset(out, 0, 8);
+        out[0] = hi;
+        out[1] = lo;
+        if (hi == lo)
+            return; // every index 0 selects a0
+
+        int palette[8] = {hi, lo};
+        for (int k = 1; k < 7; ++k)
+            palette[k + 1] = ((7 - k) * hi + k * lo) / 7;
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            const int v = texels[i][channel];
+            int best = 0;
+            for (int k = 1; k < 8; ++k)
+            {
+                if (std::abs(palette[k] - v) < std::abs(palette[best] - v))
+                    best = k;
+            }
+            indices |= uint64_t(best) << (3 * i);
+        }
+        for (int b = 0; b < 6; ++b)
+            out[2 + b] = uint8_t(indices >> (8 * b));
+    }
+
+    // ------------------------------------------------------------
+    // Whole images
+    // ------------------------------------------------------------
+
+    inline void CompressLevel(const RgbaImage &image, Engine::smodel::ImageEncoding encoding, std::vector<uint8_t> &out)
+    {
+        const uint32_t blockBytes = Engine::smodel::BlockBytes(static_cast<uint32_t>(encoding));
+        const uint32_t blocksX = (image.width + 3) / 4;
+        const uint32_t blocksY = (image.height + 3) / 4;
+        size_t offset = out.size();
+        out.resize(offset + size_t(blocksX) * blocksY * blockBytes);
+
+        for (uint32_t by = 0; by < blocksY; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                // Partial blocks repeat the edge texels
+                uint8_t texels[16][4];
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    const uint32_t x = std::min(bx * 4 + (i & 3), image.width - 1);
+                    const uint32_t y = std::min(by * 4 + (i >> 2), image.height - 1);
+                    std::memcpy(texels[i], &image.rgba[(size_t(y) * image.width + x) * 4u], 4);
+                }
+
+                uint8_t *block = &out[offset];
+                switch (encoding)
+                {
+                case Engine::smodel::ImageEncoding::BC1:
+                    EncodeBC1Block(texels, block);
+                    break;
+                case Engine::smodel::ImageEncoding::BC3:
+                    EncodeBC4Block(texels, 3, block);
+                    EncodeBC1Block(texels, block + 8);
+                    break;
+                default: // BC5
+                    EncodeBC4Block(texels, 0, block);
+                    EncodeBC4Block(texels, 1, block + 8);
+                    break;
+                }
+                offset += blockBytes;
+            }
+        }
+    }
+
+    // The full chain, Engine::smodel::BlockMipChainBytes() bytes.
+    inline std::vector<uint8_t> CompressMipChain(RgbaImage image, Engine::smodel::ImageEncoding encoding, bool srgb)
+    {
+        std::vector<uint8_t> out;
+        const uint32_t levels = Engine::smodel::FullMipCount(image.width, image.height);
+        out.reserve(size_t(Engine::smodel::BlockMipChainBytes(static_cast<uint32_t>(encoding), image.width, image.height)));
+        for (uint32_t mip = 0; mip < levels; ++mip)
+        {
+            CompressLevel(image, encoding, out);
+            if (mip + 1 < levels)
+                image = DownsampleImage(image, srgb);
+        }
+        return out;
+    }
+
+} // namespace tools
@@ -0,0 +1,130 @@
+#pragma once
+/*
+  BenchApp.h
+  ----------
+  Purpose:
+    - StratosphereBench: runs the sample on a scenario for a fixed number of frames with a fixed
+      dt, a scripted camera path and scripted move orders, and writes the results as JSON, so
+      performance changes can be compared run to run and machine to machine.
+
+  Usage:
+    - StratosphereBench [scenario.json] [--frames N] [--warmup N] [--dt S] [--script path]
+                        [--out path] [--label text] [--vsync] [--replay recording.json]
+                        [--alloc-strict]
+    - Script JSON (optional; a built-in pan/zoom path and two orders otherwise), times in seconds
+      from the first measured frame:
+        { "camera": [ { "t": 0, "focus": [0, 0], "height": 70, "yaw": -45 }, ... ],
+          "moves":  [ { "t": 2.5, "target": [40, 40] }, ... ] }
+    - --replay plays an input recording (InputRecording.h) instead of the script: every replayed
+      frame is measured, with the recorded dt, and no warmup.
+
+  Notes:
+    - Measurement starts once the scenario has finished spawning, plus the warmup frames. The
+      simulation runs inline (one tick per frame with the fixed dt) so every run does the same work.
+    - Frame time is wall time between frames; CPU scopes come from Profiler, GPU passes from the
+      renderer's GpuProfiler (both a frame or more behind, which does not matter over a run), draw
+      statistics per pass and model from RenderStats, as means per frame.
+    - Built with ENGINE_ALLOC_TRACKING, heap allocations per frame and per CPU scope are reported
+      too, and ENGINE_NO_ALLOC_SCOPE checks are armed while measuring (--alloc-strict: a violation
+      aborts the run).
+    - Without --vsync the swapchain asks for IMMEDIATE presentation (MAILBOX, then FIFO, when the
+      surface lacks it); the mode used is in the results.
+*/
+
+#include "MySampleApp.h"
+#include "Engine/RenderStats.h"
+#include "utils/AllocTracker.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class BenchApp : public MySampleApp
+{
+public:
+    struct Config
+    {
+        std::string scenarioPath = "Scinerio.json";
+        std::string scriptPath; // empty: built-in script
+        std::string replayPath; // input recording replacing the script
+        std::string outputPath = "bench_results.json";
+        std::string label;
+        uint32_t frames = 600;
+        uint32_t warmupFrames = 60;
+        float dtSeconds = 1.0f / 60.0f;
+        bool vsync = false;
+        bool allocStrict = false;
+    };
+
+    struct CameraKey
+    {
+        float t = 0.0f;
+        float focusX = 0.0f;
+        float focusZ = 0.0f;
+        float height = 70.0f;
+        float yawDeg = -45.0f;
+    };
+
+    struct MoveOrder
+    {
+        float t = 0.0f;
+        float x = 0.0f;
+        float z = 0.0f;
+    };
+
+    // False (after printing usage) on bad arguments.
+    static bool ParseArgs(int argc, char **argv, Config &out);
+
+    explicit BenchApp(const Config &config);
+
+    void OnUpdate(Engine::TimeStep ts) override;
+
+    // The run completed and its results were written.
+    bool Succeeded() const { return m_succeeded; }
+
+private:
+    enum class Phase
+    {
+        Spawning,
+        Warmup,
+        Measuring,
+        Done
+    };
+
+    struct Accumulator
+    {
+        double sumMs = 0.0;
+        float maxMs = 0.0f;
+        uint64_t calls = 0;
+        uint64_t allocations = 0;
+        uint64_t allocBytes = 0;
+    };
+
+    bool LoadScript_Internal(const std::string &path);
+    void DefaultScript_Internal();
+    void ApplyScript_Internal(float t);
+    void Sample_Internal(float frameMs);
+    bool WriteResults_Internal();
+
+    Config m_config;
+    std::vector<CameraKey> m_cameraKeys; // sorted by t
+    std::vector<MoveOrder> m_moves;      // sorted by t
+    size_t m_nextMove = 0;
+
+    Phase m_phase = Phase::Spawning;
+    uint32_t m_phaseFrames = 0;
+    uint32_t m_spawnFrames = 0;
+    uint64_t m_lastFrameNs = 0;
+    bool m_succeeded = false;
+
+    std::vector<float> m_frameMs;
+    std::vector<float> m_gpuFrameMs;
+    std::map<std::string, Accumulator> m_cpuScopes;
+    std::map<std::string, Accumulator> m_gpuPasses; // "name/stage"
+    Engine::RenderCounters m_renderTotal;            // summed over the measured frames
+    std::map<std::string, Engine::RenderCounters> m_renderPasses;
+    std::map<std::string, Engine::RenderCounters> m_renderModels; // by path
+    Engine::AllocCounts m_heapTotal;                 // summed over the measured frames
+    uint64_t m_heapMaxAllocations = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+/*
+  InputRecording.h
+  ----------------
+  Purpose:
+    - A match's player input, frame by frame, for replaying it exactly: the frame dt, the cursor,
+      the mouse events (each with the cursor where it happened) and the RTS camera after the frame,
+      which replays compare against to detect divergence.
+
+  Usage:
+    - SampleApp --record match.json       // records from the first frame after the scenario spawned
+    - SampleApp --replay match.json       // feeds it back through MySampleApp::OnEvent/OnUpdate
+    - StratosphereBench --replay match.json  // measures the replayed frames
+    - JSON: { "version": 1, "scenario": "Scinerio.json", "window": [1920, 1080],
+              "startCamera": [focusX, focusZ, height, yaw, pitch], "startCursor": [x, y],
+              "frames": [ { "t": 0.0, "dt": 0.016, "cursor": [x, y],
+                            "events": [ ["MouseButtonRightUp", x, y], ... ],
+                            "camera": [focusX, focusZ, height, yaw, pitch] }, ... ] }
+
+  Notes:
+    - Deterministic only with the simulation inline (MySampleApp::Options::simulationHz = 0), which
+      --record and --replay select, and with the same scenario and window size. A mouse button
+      held when recording starts is ignored until released, in both.
+    - Key presses are not recorded: the sample's keys (F1..F5, Escape) drive tools, not the match.
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Sample
+{
+    struct RecordedCamera
+    {
+        float focusX = 0.0f;
+        float focusZ = 0.0f;
+        float height = 0.0f;
+        float yawDeg = 0.0f;
+        float pitchDeg = 0.0f;
+    };
+
+    struct RecordedEvent
+    {
+        std::string name; // as MySampleApp::OnEvent received it ("MouseScroll 0 -1", ...)
+        float cursorX = 0.0f;
+        float cursorY = 0.0f;
+    };
+
+    struct RecordedFrame
+    {
+        float t = 0.0f;  // seconds since the first recorded frame, at its start
+        float dt = 0.0f; // TimeStep::DeltaSeconds
+        float cursorX = 0.0f;
+        float cursorY = 0.0f;
+        std::vector<RecordedEvent> events; // received before this frame's update, in order
+        RecordedCamera camera;             // after the update
+    };
+
+    struct InputRecording
+    {
+        std::string scenario;
+        uint32_t windowWidth = 0;
+        uint32_t windowHeight = 0;
+        RecordedCamera startCamera;
+        float startCursorX = 0.0f; // the previous frame's cursor, for the first frame's drag delta
+        float startCursorY = 0.0f;
+        std::vector<RecordedFrame> frames;
+    };
+
+    bool SaveInputRecording(const std::string &path, const InputRecording &recording);
+    // False (with a log line) when the file is missing or malformed.
+    bool LoadInputRecording(const std::string &path, InputRecording &out);
+
+    // Largest difference between two camera states, in meters and degrees alike
+    float CameraDifference(const RecordedCamera &a, const RecordedCamera &b);
+} // namespace Sample
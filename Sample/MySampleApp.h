@@ -5,11 +5,15 @@
 #include "src/MenuManager.h"
 
 #include "update.h"
+#include "InputRecording.h"
+#include "ScenarioSpawner.h"
 
 #include "assets/Handles.h"
+#include "utils/HitchDetector.h"
 
 #include <glm/glm.hpp>
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -17,23 +21,71 @@ namespace Engine
 {
     class AssetManager;
     class GroundPlaneRenderPassModule;
+    class CrowdComputeModule;
 }
 
 class MySampleApp : public Engine::Application
 {
 public:
+    struct Options
+    {
+        std::string scenarioPath = "Scinerio.json"; // empty: no scenario (SpawnScenario() adds units)
+        bool showMenu = true;
+        // > 0: simulation on its own thread at this rate; 0: one tick per frame with the frame's dt
+        float simulationHz = 30.0f;
+        // > 0: trace this many frames once the scenario has spawned (--trace); F5 traces on demand
+        uint32_t traceFrames = 0;
+        std::string tracePath = "trace.json";
+        // Dump the frames around every hitch into hitches.directory (--hitches, see HitchDetector.h)
+        bool detectHitches = false;
+        Engine::HitchDetectorConfig hitches;
+        // Mouse input, cursor, camera and dt from the first frame after the scenario spawned are
+        // written here on Close() (see InputRecording.h)
+        std::string recordPath;
+        // Plays a recording back from that frame instead of the live mouse; live input resumes after
+        std::string replayPath;
+    };
+
+    // Frames an F5 capture records
+    static constexpr uint32_t kHotkeyTraceFrames = 300;
+
     MySampleApp();
+    explicit MySampleApp(const Options &options);
     ~MySampleApp() override;
 
     void Close() override;
     void OnUpdate(Engine::TimeStep ts) override;
     void OnRender() override;
 
+protected:
+    // For drivers of the sample (StratosphereBench): scenario progress, camera and orders.
+    bool ScenarioSpawned() const { return m_scenarioSpawner.done(); }
+    uint32_t ScenarioUnits() const { return m_scenarioUnits; }
+    void SetCameraView(float focusX, float focusZ, float height, float yawDeg);
+    void IssueMoveCommand(float x, float z);
+    // Spawns more units over the next frames, like the startup scenario; false while one is still
+    // spawning. ScenarioSpawned() is false until it is done, ScenarioSpawnedUnits() counts its units.
+    bool SpawnScenario(Sample::Scenario scenario);
+    uint32_t ScenarioSpawnedUnits() const { return m_scenarioSpawner.spawnedUnits(); }
+    std::vector<std::string> PrefabNames() { return GetECS().prefabs.names(); }
+    // Options::replayPath is being played back (false before the scenario spawned and once done)
+    bool Replaying() const { return m_inputMode == InputMode::Replay; }
+    size_t ReplayFrameCount() const { return m_inputRecording.frames.size(); }
+
 private:
     void setupECSFromPrefabs();
     void OnEvent(const std::string &name);
+    void HandleInput(const std::string &name);
+    glm::vec2 CursorPosition();
+    Sample::RecordedCamera CameraState() const;
+    void StartInputCapture();
+    float ReplayFrameInput();
+    void FinishInputFrame(float dt, const glm::vec2 &cursor);
     void ApplyRTSCamera(float aspect);
     void PickAndSelectEntityAtCursor();
+    void SelectUnitsInScreenRect(const glm::vec2 &a, const glm::vec2 &b);
+    void ScreenRay(float screenX, float screenY, glm::vec3 &origin, glm::vec3 &dir);
+    void GroundQuad(const glm::vec2 &a, const glm::vec2 &b, float quad[8]);
 
 private:
     struct RTSCameraController
@@ -60,6 +112,8 @@ private:
     glm::vec2 m_lastMouse{0.0f, 0.0f};
     bool m_isPanning = false;
     bool m_panJustStarted = false;
+    bool m_boxSelecting = false; // right button held: click-pick or marquee on release
+    glm::vec2 m_boxStart{0.0f, 0.0f};
     float m_scrollDelta = 0.0f;
     Engine::Camera m_camera;
 
@@ -67,6 +121,35 @@ private:
     Engine::TextureHandle m_groundTexture;
     std::shared_ptr<Engine::GroundPlaneRenderPassModule> m_groundPass;
 
+    // GPU crowd simulation (registered only for large scenarios)
+    std::shared_ptr<Engine::CrowdComputeModule> m_crowdPass;
+    uint32_t m_scenarioUnits = 0;
+
+    // Scenario units are spawned over the first frames, kScenarioSpawnBudgetMs per frame
+    static constexpr float kScenarioSpawnBudgetMs = 8.0f;
+    Sample::IncrementalScenarioSpawner m_scenarioSpawner;
+
+    // Startup KPI: construction to the first frame, logged once by OnUpdate
+    std::chrono::steady_clock::time_point m_launchTime = std::chrono::steady_clock::now();
+    bool m_firstFrameLogged = false;
+    bool m_traceRequested = false; // Options::traceFrames capture started
+
+    // Input recording / replay (Options::recordPath, replayPath)
+    enum class InputMode
+    {
+        Live,
+        Record,
+        Replay
+    };
+    InputMode m_inputMode = InputMode::Live;
+    bool m_inputCaptureStarted = false;
+    Sample::InputRecording m_inputRecording;
+    std::vector<Sample::RecordedEvent> m_pendingInput; // recording: events since the last update
+    size_t m_replayFrame = 0;
+    glm::vec2 m_replayCursor{0.0f, 0.0f};
+    bool m_replayDiverged = false;
+
+    Options m_options;
     Sample::SystemRunner m_systems;
 
         // Menu
@@ -74,6 +157,8 @@ private:
 
     // Small save slot filename
     std::string m_saveFilePath = "sample_save.json";
+    // Binary ECS world snapshot written next to it (see ECS/WorldSnapshot.h)
+    std::string m_worldSnapshotPath = "sample_world.snap";
 
     // Helpers
     void SaveGameState();
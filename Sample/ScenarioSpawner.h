@@ -1,7 +1,11 @@
 #pragma once
 
+#include "Structs/SpawnGroup.h"
+
 #include <cstdint>
+#include <random>
 #include <string>
+#include <vector>
 
 namespace Engine::ECS
 {
@@ -10,6 +14,61 @@ namespace Engine::ECS
 
 namespace Sample
 {
+    // Scenario JSON resolved to spawn groups (anchors and offsets applied); no ECS access, so it can
+    // be parsed on a worker while prefabs load.
+    struct Scenario
+    {
+        std::string name;
+        std::vector<SpawnGroupResolved> groups; // only groups with a unitType and count > 0
+    };
+
+    bool ParseScenarioFile(const std::string &scenarioPath, Scenario &out);
+
+    // Spawns one group; its unitType's prefab must be registered. Returns the number spawned.
+    uint32_t SpawnScenarioGroup(Engine::ECS::ECSContext &ecs, const SpawnGroupResolved &group, bool selectSpawned = true);
+
+    // Spawns a scenario over several frames: each update() spawns batches of the current group
+    // until its time budget is spent, so a huge scenario never stalls one frame for seconds.
+    // Formation positions and jitter match SpawnFromScenarioFile. Groups spawn in file order; their
+    // prefabs must be registered by the time update() reaches them.
+    class IncrementalScenarioSpawner
+    {
+    public:
+        // Parses the file (false, and nothing to spawn, on failure) or takes a parsed scenario.
+        bool begin(const std::string &scenarioPath, bool selectSpawned = true);
+        void begin(Scenario scenario, bool selectSpawned = true);
+
+        // Spawns for about budgetMs (at least one batch while any is left). Returns units spawned.
+        uint32_t update(Engine::ECS::ECSContext &ecs, float budgetMs);
+
+        bool done() const { return m_group >= m_scenario.groups.size(); }
+        uint32_t totalUnits() const { return m_totalUnits; }
+        uint32_t spawnedUnits() const { return m_spawnedUnits; }
+        // 0..1; groups skipped for a missing prefab count as processed
+        float progress() const { return m_totalUnits ? float(m_processedUnits) / float(m_totalUnits) : 1.0f; }
+
+    private:
+        static constexpr uint32_t kInitialBatch = 1024;
+        static constexpr uint32_t kMinBatch = 64;
+        static constexpr uint32_t kMaxBatch = 65536;
+
+        void nextGroup_Internal();
+
+        Scenario m_scenario;
+        bool m_selectSpawned = true;
+
+        size_t m_group = 0;          // current group
+        uint32_t m_groupIndex = 0;   // units of it spawned so far
+        bool m_groupStarted = false; // rng and spacing below are set up
+        std::mt19937 m_groupRng;
+        float m_groupSpacingM = 0.0f;
+
+        uint32_t m_totalUnits = 0;
+        uint32_t m_processedUnits = 0;
+        uint32_t m_spawnedUnits = 0;
+        uint32_t m_batchSize = kInitialBatch; // adapted to the measured spawn rate
+    };
+
     // Spawns entities described in the scenario JSON.
     // Returns total number of spawned entities.
     uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned = true);
@@ -0,0 +1,95 @@
+#pragma once
+/*
+  ServerApp.h
+  -----------
+  Purpose:
+    - StratosphereServer: the sample's simulation as a dedicated server. Each ServerMatch is one
+      headless world (Engine::HeadlessApplication) running the gameplay systems at a fixed tick;
+      the process runs several matches side by side, one thread each, with no window or GPU.
+
+  Usage:
+    - StratosphereServer [--matches N] [--tick-hz HZ] [--seconds S] [--workers N]
+                         [--scenario path.json] [--seed N]
+    - Runs from SampleApp's output directory (entities/, Scinerio.json, cooked assets/), or from
+      StratosphereServer's own in an ENGINE_HEADLESS_ONLY build.
+
+  Notes:
+    - Prefab definitions and the scenario are parsed once (ServerData) and instantiated into every
+      match's registry; model data comes from HeadlessAssets, shared across matches.
+    - No players are connected: a bot gives all units of a match a random move order every
+      kOrderIntervalSeconds, so steering, flow fields and animation run as in a game.
+    - The systems are SystemRunner's CPU path (no GpuCrowdSystem, RenderSystem or simulation LOD,
+      which need a camera). Local avoidance is skipped too: it needs the spatial grid.
+    - No spatial grid: nothing on the server picks or queries neighbours. kCellSize keeps flow-field
+      cells and the row reorder's Morton cells at the client grid's size.
+*/
+
+#include "Engine/HeadlessApplication.h"
+#include "ECS/Prefab.h"
+#include "ECS/RowReorder.h"
+#include "ECS/SystemScheduler.h"
+#include "ScenarioSpawner.h"
+
+#include "systems/CommandSystem.h"
+#include "systems/FlowFieldSystem.h"
+#include "systems/SteeringSystem.h"
+#include "systems/MovementSystem.h"
+#include "systems/CharacterAnimationSystem.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Sample
+{
+    // Read-only game data shared by every match of the process
+    struct ServerData
+    {
+        std::vector<Engine::ECS::PrefabDefinition> prefabs;
+        Scenario scenario;
+
+        // entities/*.json (through the prefab cache) and the scenario; false if either is missing
+        bool load(const std::string &scenarioPath);
+    };
+
+    class ServerMatch : public Engine::HeadlessApplication
+    {
+    public:
+        struct Config
+        {
+            Engine::HeadlessConfig app;
+            uint32_t seed = 1;  // bot orders
+        };
+
+        ServerMatch(const Config &config, const ServerData &data);
+
+        void OnStart() override;
+        void OnTick(Engine::TimeStep ts) override;
+
+        // Any thread
+        uint32_t GetUnitCount() const { return m_units.load(std::memory_order_relaxed); }
+        double GetMeanTickMs() const;
+
+    private:
+        static constexpr float kOrderIntervalSeconds = 8.0f;
+        static constexpr float kOrderRangeM = 300.0f;
+        static constexpr float kCellSize = 2.0f; // SpatialIndexSystem's cell size on the client
+
+        const ServerData &m_data;
+        std::mt19937 m_rng;
+        float m_sinceOrder = 0.0f;
+
+        CommandSystem m_command;
+        FlowFieldSystem m_flowFields;
+        SteeringSystem m_steering;
+        MovementSystem m_movement;
+        CharacterAnimationSystem m_characterAnim;
+        Engine::ECS::MortonRowReorder m_reorder;
+        Engine::ECS::SystemScheduler m_scheduler;
+
+        std::atomic<uint32_t> m_units{0};
+        std::atomic<uint64_t> m_tickNs{0}; // sum over all ticks
+    };
+}
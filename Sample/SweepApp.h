@@ -0,0 +1,120 @@
+#pragma once
+/*
+  SweepApp.h
+  ----------
+  Purpose:
+    - StratosphereBench --sweep: entity-count scaling sweep. Spawns N units of every registered
+      prefab, measures, then ramps N geometrically, so the cost of each system, the GPU and memory
+      can be read against the unit count and the step where the frame budget breaks is marked.
+
+  Usage:
+    - StratosphereBench --sweep [--start N] [--factor F] [--max N] [--frames N] [--warmup N]
+                                [--dt S] [--formation dense|sparse] [--budget MS] [--seed N]
+                                [--out path.csv] [--vsync]
+    - One CSV row per step: units, frame time (mean, p95), GPU time, GPU and CPU memory, whether
+      the mean frame exceeded the budget, then the mean ms of every Profiler scope ("cpu:<name>",
+      systems included) and GPU pass ("gpu:<name>/<stage>"). Rewritten after every step.
+
+  Notes:
+    - Steps add units to the previous ones (nothing is despawned): blocks of each prefab laid out
+      in a sunflower around the origin, all units selected, and a random move order every few
+      seconds keeps avoidance and pose evaluation busy.
+    - No scenario file, so the crowd stays on the CPU path (the GPU crowd is chosen at startup).
+    - The simulation runs inline with the fixed dt, as in the benchmark. The run stops after the
+      step at --max or the first step whose mean frame exceeds kStopFactor times the budget.
+    - The log names each system scope where its cost per unit first grows past kSuperlinearRatio
+      of its first measured step: the one that stops scaling linearly first is at the top.
+*/
+
+#include "MySampleApp.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+class SweepApp : public MySampleApp
+{
+public:
+    struct Config
+    {
+        uint32_t startUnits = 250;    // per prefab, first step
+        float factor = 2.0f;          // per-prefab units multiply by this each step
+        uint32_t maxUnits = 64000;    // per prefab, last step at most
+        uint32_t frames = 240;        // measured per step
+        uint32_t warmupFrames = 60;   // after each step's spawn
+        float dtSeconds = 1.0f / 60.0f;
+        bool sparse = false;          // formation spacing kSparseSpacingM instead of kDenseSpacingM
+        float budgetMs = 16.6f;
+        uint32_t seed = 1;
+        std::string outputPath = "sweep_results.csv";
+        bool vsync = false;
+    };
+
+    // The whole command line (--sweep itself is skipped). False (after printing usage) on bad arguments.
+    static bool ParseArgs(int argc, char **argv, Config &out);
+
+    explicit SweepApp(const Config &config);
+
+    void OnUpdate(Engine::TimeStep ts) override;
+
+    bool Succeeded() const { return m_succeeded; }
+
+private:
+    static constexpr float kDenseSpacingM = 1.0f;
+    static constexpr float kSparseSpacingM = 4.0f;
+    static constexpr float kMoveIntervalSeconds = 4.0f;
+    static constexpr float kStopFactor = 4.0f;
+    static constexpr float kSuperlinearRatio = 1.5f;
+
+    enum class Phase
+    {
+        Spawning,
+        Warmup,
+        Measuring,
+        Done
+    };
+
+    struct Step
+    {
+        uint32_t unitsPerPrefab = 0;
+        uint32_t units = 0;
+        float frameMsMean = 0.0f;
+        float frameMsP95 = 0.0f;
+        float gpuMsMean = 0.0f;
+        double gpuMemoryMB = 0.0;
+        double cpuMemoryMB = 0.0;
+        std::map<std::string, float> cpuScopes; // mean ms per frame
+        std::map<std::string, float> gpuPasses; // "name/stage"
+    };
+
+    bool StartStep_Internal();
+    void IssueRandomMove_Internal();
+    void Sample_Internal(float frameMs);
+    void FinishStep_Internal();
+    bool WriteResults_Internal() const;
+    void LogScaling_Internal() const;
+
+    Config m_config;
+    std::vector<std::string> m_prefabs;
+    std::mt19937 m_rng;
+
+    Phase m_phase = Phase::Spawning;
+    uint32_t m_phaseFrames = 0;
+    uint32_t m_unitsPerPrefab = 0; // spawned or spawning
+    uint32_t m_units = 0;          // spawned by finished steps
+    uint32_t m_blocks = 0;         // formation blocks laid out so far
+    float m_layoutArea = 0.0f;     // m^2 they cover
+    float m_moveTimer = 0.0f;
+    uint64_t m_lastFrameNs = 0;
+    bool m_succeeded = false;
+
+    // Current step
+    std::vector<float> m_frameMs;
+    double m_gpuMsSum = 0.0;
+    std::map<std::string, double> m_cpuSums;
+    std::map<std::string, double> m_gpuSums;
+
+    std::vector<Step> m_steps;
+};
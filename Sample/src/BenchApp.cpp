@@ -0,0 +1,520 @@
+#include "BenchApp.h"
+
+#include "Engine/Renderer.h"
+#include "Engine/SwapChain.h"
+#include "Engine/VulkanContext.h"
+#include "utils/Log.h"
+#include "utils/MemoryAllocator.h"
+#include "utils/MemoryTracker.h"
+#include "utils/Profiler.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using json = nlohmann::json;
+
+namespace
+{
+    // Scopes named in the allocation report in the log
+    constexpr size_t kReportedAllocScopes = 8;
+
+    MySampleApp::Options SampleOptions(const BenchApp::Config &config)
+    {
+        MySampleApp::Options options;
+        options.scenarioPath = config.scenarioPath;
+        options.showMenu = false;
+        options.simulationHz = 0.0f; // inline: one tick per frame with the fixed dt
+        options.replayPath = config.replayPath;
+        return options;
+    }
+
+    // Nearest rank on sorted values
+    float Percentile(const std::vector<float> &sorted, float p)
+    {
+        if (sorted.empty())
+            return 0.0f;
+        const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<float>(sorted.size())));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    json Distribution(std::vector<float> values)
+    {
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (float v : values)
+            sum += v;
+        json j;
+        j["mean"] = values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+        j["min"] = values.empty() ? 0.0f : values.front();
+        j["p50"] = Percentile(values, 0.50f);
+        j["p90"] = Percentile(values, 0.90f);
+        j["p95"] = Percentile(values, 0.95f);
+        j["p99"] = Percentile(values, 0.99f);
+        j["max"] = values.empty() ? 0.0f : values.back();
+        return j;
+    }
+
+    // Means per frame
+    json RenderCountersJson(const Engine::RenderCounters &c, double frames)
+    {
+        json j;
+        j["drawCalls"] = static_cast<double>(c.drawCalls) / frames;
+        j["instances"] = static_cast<double>(c.instances) / frames;
+        j["triangles"] = static_cast<double>(c.triangles) / frames;
+        j["visibleTriangles"] = static_cast<double>(c.visibleTriangles) / frames;
+        j["pipelineBinds"] = static_cast<double>(c.pipelineBinds) / frames;
+        j["descriptorBinds"] = static_cast<double>(c.descriptorBinds) / frames;
+        j["bufferBinds"] = static_cast<double>(c.bufferBinds) / frames;
+        j["uploadBytes"] = static_cast<double>(c.uploadBytes) / frames;
+        return j;
+    }
+
+    const char *PresentModeName(VkPresentModeKHR mode)
+    {
+        switch (mode)
+        {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:
+            return "IMMEDIATE";
+        case VK_PRESENT_MODE_MAILBOX_KHR:
+            return "MAILBOX";
+        case VK_PRESENT_MODE_FIFO_KHR:
+            return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+            return "FIFO_RELAXED";
+        default:
+            return "OTHER";
+        }
+    }
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: StratosphereBench [scenario.json] [--frames N] [--warmup N] [--dt S]\n"
+                     "                         [--script path] [--out path] [--label text] [--vsync]\n"
+                     "                         [--replay recording.json] [--alloc-strict]\n"
+                     "       StratosphereBench --sweep ... (see SweepApp.h)\n");
+    }
+} // namespace
+
+bool BenchApp::ParseArgs(int argc, char **argv, Config &out)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--frames") == 0 && hasValue)
+            out.frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--warmup") == 0 && hasValue)
+            out.warmupFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--dt") == 0 && hasValue)
+            out.dtSeconds = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(arg, "--script") == 0 && hasValue)
+            out.scriptPath = argv[++i];
+        else if (std::strcmp(arg, "--replay") == 0 && hasValue)
+            out.replayPath = argv[++i];
+        else if (std::strcmp(arg, "--out") == 0 && hasValue)
+            out.outputPath = argv[++i];
+        else if (std::strcmp(arg, "--label") == 0 && hasValue)
+            out.label = argv[++i];
+        else if (std::strcmp(arg, "--vsync") == 0)
+            out.vsync = true;
+        else if (std::strcmp(arg, "--alloc-strict") == 0)
+            out.allocStrict = true;
+        else if (arg[0] != '-')
+            out.scenarioPath = arg;
+        else
+        {
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if (out.frames == 0 || !(out.dtSeconds > 0.0f))
+    {
+        PrintUsage();
+        return false;
+    }
+    return true;
+}
+
+BenchApp::BenchApp(const Config &config)
+    : MySampleApp(SampleOptions(config)), m_config(config)
+{
+    if (m_config.scriptPath.empty() || !LoadScript_Internal(m_config.scriptPath))
+        DefaultScript_Internal();
+    if (!m_config.replayPath.empty())
+        m_config.warmupFrames = 0;
+
+    SetFixedTimeStep(m_config.dtSeconds);
+    Engine::Profiler::setEnabled(true);
+    Engine::AllocTracker::setStrict(m_config.allocStrict);
+
+    if (!m_config.vsync)
+    {
+        // Rebuild the swapchain (and what depends on it) the way a resize does, with the new mode
+        GetVulkanContext().GetSwapChain()->SetPreferredPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+        handleWindowEvent("WindowResize");
+    }
+
+    m_frameMs.reserve(m_config.frames);
+    m_gpuFrameMs.reserve(m_config.frames);
+    ENGINE_LOG_INFO("[Bench] %s: %u frames (+%u warmup) at dt %.4f s, %zu camera keys, %zu move orders",
+                    m_config.scenarioPath.c_str(), m_config.frames, m_config.warmupFrames, m_config.dtSeconds,
+                    m_cameraKeys.size(), m_moves.size());
+}
+
+bool BenchApp::LoadScript_Internal(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in.good())
+    {
+        ENGINE_LOG_ERROR("[Bench] Script not found: %s; using the built-in script", path.c_str());
+        return false;
+    }
+
+    json j = json::parse(in, nullptr, /*allow_exceptions=*/false);
+    if (j.is_discarded() || !j.is_object())
+    {
+        ENGINE_LOG_ERROR("[Bench] Script is not a JSON object: %s; using the built-in script", path.c_str());
+        return false;
+    }
+
+    auto pair = [](const json &v, float &x, float &z)
+    {
+        if (v.is_array() && v.size() >= 2 && v[0].is_number() && v[1].is_number())
+        {
+            x = v[0].get<float>();
+            z = v[1].get<float>();
+        }
+    };
+
+    if (j.contains("camera") && j["camera"].is_array())
+    {
+        for (const json &k : j["camera"])
+        {
+            CameraKey key;
+            key.t = k.value("t", 0.0f);
+            if (k.contains("focus"))
+                pair(k["focus"], key.focusX, key.focusZ);
+            key.height = k.value("height", key.height);
+            key.yawDeg = k.value("yaw", key.yawDeg);
+            m_cameraKeys.push_back(key);
+        }
+    }
+    if (j.contains("moves") && j["moves"].is_array())
+    {
+        for (const json &m : j["moves"])
+        {
+            MoveOrder order;
+            order.t = m.value("t", 0.0f);
+            if (m.contains("target"))
+                pair(m["target"], order.x, order.z);
+            m_moves.push_back(order);
+        }
+    }
+
+    if (m_cameraKeys.empty())
+        m_cameraKeys.push_back(CameraKey{});
+    std::stable_sort(m_cameraKeys.begin(), m_cameraKeys.end(), [](const CameraKey &a, const CameraKey &b)
+                     { return a.t < b.t; });
+    std::stable_sort(m_moves.begin(), m_moves.end(), [](const MoveOrder &a, const MoveOrder &b)
+                     { return a.t < b.t; });
+    return true;
+}
+
+void BenchApp::DefaultScript_Internal()
+{
+    // Pan across the field while zooming out and back, then turn; two orders sweep the crowd.
+    const float duration = static_cast<float>(m_config.frames) * m_config.dtSeconds;
+    m_cameraKeys = {
+        CameraKey{0.00f * duration, 0.0f, 0.0f, 70.0f, -45.0f},
+        CameraKey{0.25f * duration, 60.0f, 20.0f, 40.0f, -45.0f},
+        CameraKey{0.50f * duration, 0.0f, 60.0f, 100.0f, -90.0f},
+        CameraKey{0.75f * duration, -60.0f, 0.0f, 55.0f, -135.0f},
+        CameraKey{1.00f * duration, 0.0f, 0.0f, 70.0f, -45.0f},
+    };
+    m_moves = {
+        MoveOrder{0.10f * duration, 40.0f, 40.0f},
+        MoveOrder{0.55f * duration, -40.0f, -20.0f},
+    };
+}
+
+void BenchApp::ApplyScript_Internal(float t)
+{
+    // Camera: linear between the keys around t, held before the first and after the last
+    size_t next = 0;
+    while (next < m_cameraKeys.size() && m_cameraKeys[next].t <= t)
+        ++next;
+    const CameraKey &a = m_cameraKeys[next > 0 ? next - 1 : 0];
+    const CameraKey &b = m_cameraKeys[std::min(next, m_cameraKeys.size() - 1)];
+    const float span = b.t - a.t;
+    const float s = span > 0.0f ? std::clamp((t - a.t) / span, 0.0f, 1.0f) : 0.0f;
+    SetCameraView(a.focusX + (b.focusX - a.focusX) * s,
+                  a.focusZ + (b.focusZ - a.focusZ) * s,
+                  a.height + (b.height - a.height) * s,
+                  a.yawDeg + (b.yawDeg - a.yawDeg) * s);
+
+    while (m_nextMove < m_moves.size() && m_moves[m_nextMove].t <= t)
+    {
+        IssueMoveCommand(m_moves[m_nextMove].x, m_moves[m_nextMove].z);
+        ++m_nextMove;
+    }
+}
+
+void BenchApp::Sample_Internal(float frameMs)
+{
+    m_frameMs.push_back(frameMs);
+
+    // Both describe an earlier frame than frameMs; only the totals over the run are reported
+    for (const Engine::Profiler::ScopeStats &scope : Engine::Profiler::stats())
+    {
+        Accumulator &acc = m_cpuScopes[scope.name];
+        acc.sumMs += scope.lastMs;
+        acc.maxMs = std::max(acc.maxMs, scope.lastMs);
+        acc.calls += scope.calls;
+        acc.allocations += scope.allocations;
+        acc.allocBytes += scope.allocBytes;
+    }
+
+    const Engine::Renderer &renderer = GetRenderer();
+    m_gpuFrameMs.push_back(renderer.getGpuTimeMs());
+    for (const Engine::GpuProfiler::PassTiming &pass : renderer.getGpuPassTimings())
+    {
+        Accumulator &acc = m_gpuPasses[std::string(pass.name) + "/" + pass.stage];
+        acc.sumMs += pass.ms;
+        acc.maxMs = std::max(acc.maxMs, pass.ms);
+        ++acc.calls;
+    }
+
+    const Engine::RenderStats::Frame &render = Engine::RenderStats::lastFrame();
+    m_renderTotal += render.total;
+    for (const Engine::RenderStats::PassStats &pass : render.passes)
+        m_renderPasses[pass.name] += pass.counters;
+    for (const Engine::RenderStats::ModelStats &model : render.models)
+        m_renderModels[model.name] += model.counters;
+
+    const Engine::AllocCounts &heap = Engine::AllocTracker::lastFrame();
+    m_heapTotal.allocations += heap.allocations;
+    m_heapTotal.bytes += heap.bytes;
+    m_heapTotal.frees += heap.frees;
+    m_heapMaxAllocations = std::max(m_heapMaxAllocations, heap.allocations);
+}
+
+void BenchApp::OnUpdate(Engine::TimeStep ts)
+{
+    const uint64_t nowNs = Engine::Profiler::now();
+    const float frameMs = m_lastFrameNs ? static_cast<float>(nowNs - m_lastFrameNs) * 1e-6f : 0.0f;
+    m_lastFrameNs = nowNs;
+
+    // A replay starts with the frame that finished spawning (MySampleApp::OnUpdate), so it is
+    // measured from the next sample on, which times that frame, and has no warmup
+    const bool replay = !m_config.replayPath.empty();
+    if (replay && m_phase == Phase::Spawning && ScenarioSpawned())
+    {
+        ENGINE_LOG_INFO("[Bench] %u units spawned in %u frames; measuring the replay", ScenarioUnits(), m_spawnFrames);
+        m_phase = Phase::Measuring;
+        Engine::AllocTracker::setChecksArmed(true);
+    }
+
+    switch (m_phase)
+    {
+    case Phase::Spawning:
+        ++m_spawnFrames;
+        if (ScenarioSpawned())
+        {
+            ENGINE_LOG_INFO("[Bench] %u units spawned in %u frames; warming up", ScenarioUnits(), m_spawnFrames);
+            m_phase = Phase::Warmup;
+        }
+        break;
+    case Phase::Warmup:
+        if (++m_phaseFrames >= m_config.warmupFrames)
+        {
+            m_phase = Phase::Measuring;
+            m_phaseFrames = 0;
+            // Steady state from here: containers have grown to their working sizes
+            Engine::AllocTracker::setChecksArmed(true);
+        }
+        break;
+    case Phase::Measuring:
+        if (replay && ReplayFrameCount() == 0)
+        {
+            ENGINE_LOG_ERROR("[Bench] Replay %s did not start", m_config.replayPath.c_str());
+            m_phase = Phase::Done;
+            RequestClose();
+            break;
+        }
+        Sample_Internal(frameMs);
+        ++m_phaseFrames;
+        if (replay ? !Replaying() : m_phaseFrames >= m_config.frames)
+        {
+            m_phase = Phase::Done;
+            Engine::AllocTracker::setChecksArmed(false);
+            m_succeeded = WriteResults_Internal();
+            RequestClose();
+        }
+        break;
+    case Phase::Done:
+        break;
+    }
+
+    if (!replay)
+        ApplyScript_Internal(m_phase == Phase::Measuring ? static_cast<float>(m_phaseFrames) * m_config.dtSeconds : 0.0f);
+    MySampleApp::OnUpdate(ts);
+}
+
+bool BenchApp::WriteResults_Internal()
+{
+    const double frames = static_cast<double>(m_frameMs.size());
+
+    json j;
+    j["label"] = m_config.label;
+    j["scenario"] = m_config.scenarioPath;
+    j["units"] = ScenarioUnits();
+    j["frames"] = m_frameMs.size();
+    j["warmupFrames"] = m_config.warmupFrames;
+    j["spawnFrames"] = m_spawnFrames;
+    j["dtSeconds"] = m_config.dtSeconds;
+    j["replay"] = m_config.replayPath;
+    j["presentMode"] = PresentModeName(GetVulkanContext().GetSwapChain()->GetPresentMode());
+    j["frameMs"] = Distribution(m_frameMs);
+    j["gpuFrameMs"] = Distribution(m_gpuFrameMs);
+
+    // Per-frame averages over the measured frames, slowest first
+    auto table = [frames](const std::map<std::string, Accumulator> &entries, bool splitStage)
+    {
+        std::vector<std::pair<std::string, Accumulator>> sorted(entries.begin(), entries.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
+                  { return a.second.sumMs > b.second.sumMs; });
+        json out = json::array();
+        for (const auto &[key, acc] : sorted)
+        {
+            json e;
+            if (splitStage)
+            {
+                const size_t slash = key.rfind('/');
+                e["name"] = key.substr(0, slash);
+                e["stage"] = key.substr(slash + 1);
+            }
+            else
+            {
+                e["name"] = key;
+                e["callsPerFrame"] = static_cast<double>(acc.calls) / frames;
+            }
+            e["meanMs"] = acc.sumMs / frames;
+            e["maxMs"] = acc.maxMs;
+            if (Engine::AllocTracker::enabled() && !splitStage)
+            {
+                e["allocationsPerFrame"] = static_cast<double>(acc.allocations) / frames;
+                e["allocBytesPerFrame"] = static_cast<double>(acc.allocBytes) / frames;
+            }
+            out.push_back(e);
+        }
+        return out;
+    };
+    j["cpuScopes"] = table(m_cpuScopes, false);
+    j["gpuPasses"] = table(m_gpuPasses, true);
+
+    // Draw statistics; models with the most triangles first
+    json &render = j["render"];
+    render["perFrame"] = RenderCountersJson(m_renderTotal, frames);
+    json renderPasses = json::array();
+    for (const auto &[name, counters] : m_renderPasses)
+    {
+        json e = RenderCountersJson(counters, frames);
+        e["name"] = name;
+        renderPasses.push_back(e);
+    }
+    render["passes"] = renderPasses;
+    std::vector<std::pair<std::string, Engine::RenderCounters>> models(m_renderModels.begin(), m_renderModels.end());
+    std::sort(models.begin(), models.end(), [](const auto &a, const auto &b)
+              { return a.second.triangles > b.second.triangles; });
+    json renderModels = json::array();
+    for (const auto &[name, counters] : models)
+    {
+        json e = RenderCountersJson(counters, frames);
+        e["name"] = name;
+        renderModels.push_back(e);
+    }
+    render["models"] = renderModels;
+
+    // Heap allocations (ENGINE_ALLOC_TRACKING builds); per scope in cpuScopes
+    if (Engine::AllocTracker::enabled())
+    {
+        json &heap = j["heap"];
+        heap["allocationsPerFrame"] = static_cast<double>(m_heapTotal.allocations) / frames;
+        heap["bytesPerFrame"] = static_cast<double>(m_heapTotal.bytes) / frames;
+        heap["freesPerFrame"] = static_cast<double>(m_heapTotal.frees) / frames;
+        heap["maxAllocationsPerFrame"] = m_heapMaxAllocations;
+        heap["noAllocViolations"] = Engine::AllocTracker::violations();
+    }
+
+    if (const Engine::MemoryAllocator *allocator = Engine::MemoryAllocator::ForDevice(GetVulkanContext().GetDevice()))
+    {
+        const Engine::MemoryAllocator::Stats s = allocator->getStats();
+        json &m = j["memory"];
+        m["deviceAllocations"] = s.deviceAllocations;
+        m["maxDeviceAllocations"] = s.maxDeviceAllocations;
+        m["blocks"] = s.blockCount;
+        m["dedicated"] = s.dedicatedCount;
+        m["allocations"] = s.allocationCount;
+        m["blockBytes"] = s.blockBytes;
+        m["dedicatedBytes"] = s.dedicatedBytes;
+        m["usedBytes"] = s.usedBytes;
+        m["deviceLocalBytes"] = s.deviceLocalBytes;
+        m["hostVisibleBytes"] = s.hostVisibleBytes;
+        json &categories = m["categories"];
+        for (size_t c = 0; c < static_cast<size_t>(Engine::MemoryCategory::Count); ++c)
+        {
+            json &e = categories[Engine::MemoryCategoryName(static_cast<Engine::MemoryCategory>(c))];
+            e["bytes"] = s.categoryBytes[c];
+            e["peakBytes"] = s.categoryPeakBytes[c];
+        }
+        json heaps = json::array();
+        for (const Engine::MemoryAllocator::HeapBudget &h : allocator->getHeapBudgets())
+            heaps.push_back({{"size", h.size}, {"budget", h.budget}, {"usage", h.usage}, {"deviceLocal", h.deviceLocal}});
+        m["heaps"] = heaps;
+    }
+    json &cpu = j["cpuMemory"];
+    for (size_t c = 0; c < Engine::MemoryTracker::kCategoryCount; ++c)
+    {
+        const Engine::CpuMemoryCategory category = static_cast<Engine::CpuMemoryCategory>(c);
+        json &e = cpu[Engine::MemoryTracker::name(category)];
+        e["bytes"] = Engine::MemoryTracker::current(category);
+        e["peakBytes"] = Engine::MemoryTracker::peak(category);
+    }
+
+    std::ofstream out(m_config.outputPath);
+    if (!out.good())
+    {
+        ENGINE_LOG_ERROR("[Bench] Cannot write results: %s", m_config.outputPath.c_str());
+        return false;
+    }
+    out << j.dump(4);
+
+    const json &f = j["frameMs"];
+    ENGINE_LOG_INFO("[Bench] %zu frames: mean %.2f ms, p50 %.2f, p95 %.2f, p99 %.2f, max %.2f -> %s",
+                    m_frameMs.size(), f["mean"].get<double>(), f["p50"].get<double>(), f["p95"].get<double>(),
+                    f["p99"].get<double>(), f["max"].get<double>(), m_config.outputPath.c_str());
+
+    // Hot-loop allocation report: the scopes allocating most per frame (inclusive of nested scopes)
+    if (Engine::AllocTracker::enabled())
+    {
+        ENGINE_LOG_INFO("[Bench] Heap: %.0f allocations (%.1f KB) per frame, max %llu; %u no-alloc violations",
+                        static_cast<double>(m_heapTotal.allocations) / frames, static_cast<double>(m_heapTotal.bytes) / frames / 1024.0,
+                        static_cast<unsigned long long>(m_heapMaxAllocations), Engine::AllocTracker::violations());
+        std::vector<std::pair<std::string, Accumulator>> byAllocations(m_cpuScopes.begin(), m_cpuScopes.end());
+        std::sort(byAllocations.begin(), byAllocations.end(), [](const auto &a, const auto &b)
+                  { return a.second.allocations > b.second.allocations; });
+        for (size_t i = 0; i < byAllocations.size() && i < kReportedAllocScopes && byAllocations[i].second.allocations > 0; ++i)
+            ENGINE_LOG_INFO("[Bench]   %-32s %8.0f allocs %8.1f KB per frame", byAllocations[i].first.c_str(),
+                            static_cast<double>(byAllocations[i].second.allocations) / frames,
+                            static_cast<double>(byAllocations[i].second.allocBytes) / frames / 1024.0);
+    }
+    return true;
+}
@@ -0,0 +1,150 @@
+#include "InputRecording.h"
+
+#include "utils/Log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+    using json = nlohmann::json;
+
+    constexpr int kFormatVersion = 1;
+
+    json CameraToJson(const Sample::RecordedCamera &c)
+    {
+        return json::array({c.focusX, c.focusZ, c.height, c.yawDeg, c.pitchDeg});
+    }
+
+    bool CameraFromJson(const json &j, Sample::RecordedCamera &out)
+    {
+        if (!j.is_array() || j.size() != 5)
+            return false;
+        for (const json &v : j)
+            if (!v.is_number())
+                return false;
+        out.focusX = j[0].get<float>();
+        out.focusZ = j[1].get<float>();
+        out.height = j[2].get<float>();
+        out.yawDeg = j[3].get<float>();
+        out.pitchDeg = j[4].get<float>();
+        return true;
+    }
+
+    bool PairFromJson(const json &j, float &x, float &y)
+    {
+        if (!j.is_array() || j.size() != 2 || !j[0].is_number() || !j[1].is_number())
+            return false;
+        x = j[0].get<float>();
+        y = j[1].get<float>();
+        return true;
+    }
+} // namespace
+
+namespace Sample
+{
+    bool SaveInputRecording(const std::string &path, const InputRecording &recording)
+    {
+        json frames = json::array();
+        for (const RecordedFrame &f : recording.frames)
+        {
+            json events = json::array();
+            for (const RecordedEvent &e : f.events)
+                events.push_back(json::array({e.name, e.cursorX, e.cursorY}));
+            frames.push_back({{"t", f.t},
+                              {"dt", f.dt},
+                              {"cursor", json::array({f.cursorX, f.cursorY})},
+                              {"events", std::move(events)},
+                              {"camera", CameraToJson(f.camera)}});
+        }
+
+        json j;
+        j["version"] = kFormatVersion;
+        j["scenario"] = recording.scenario;
+        j["window"] = json::array({recording.windowWidth, recording.windowHeight});
+        j["startCamera"] = CameraToJson(recording.startCamera);
+        j["startCursor"] = json::array({recording.startCursorX, recording.startCursorY});
+        j["frames"] = std::move(frames);
+
+        std::ofstream out(path);
+        if (!out.good())
+        {
+            ENGINE_LOG_ERROR("[Input] Cannot write recording: %s", path.c_str());
+            return false;
+        }
+        out << j.dump(1);
+        ENGINE_LOG_INFO("[Input] Recorded %zu frames -> %s", recording.frames.size(), path.c_str());
+        return true;
+    }
+
+    bool LoadInputRecording(const std::string &path, InputRecording &out)
+    {
+        std::ifstream in(path);
+        if (!in.good())
+        {
+            ENGINE_LOG_ERROR("[Input] Recording not found: %s", path.c_str());
+            return false;
+        }
+
+        const json j = json::parse(in, nullptr, /*allow_exceptions=*/false);
+        if (j.is_discarded() || !j.is_object() || j.value("version", 0) != kFormatVersion)
+        {
+            ENGINE_LOG_ERROR("[Input] Not a version %d input recording: %s", kFormatVersion, path.c_str());
+            return false;
+        }
+
+        InputRecording rec;
+        rec.scenario = j.value("scenario", std::string());
+        float w = 0.0f, h = 0.0f;
+        if (j.contains("window") && PairFromJson(j["window"], w, h))
+        {
+            rec.windowWidth = static_cast<uint32_t>(w);
+            rec.windowHeight = static_cast<uint32_t>(h);
+        }
+        bool ok = j.contains("startCamera") && CameraFromJson(j["startCamera"], rec.startCamera) &&
+                  j.contains("startCursor") && PairFromJson(j["startCursor"], rec.startCursorX, rec.startCursorY) &&
+                  j.contains("frames") && j["frames"].is_array();
+
+        for (size_t i = 0; ok && i < j["frames"].size(); ++i)
+        {
+            const json &f = j["frames"][i];
+            RecordedFrame frame;
+            ok = f.is_object() && f.contains("cursor") && PairFromJson(f["cursor"], frame.cursorX, frame.cursorY) &&
+                 f.contains("camera") && CameraFromJson(f["camera"], frame.camera);
+            if (!ok)
+                break;
+            frame.t = f.value("t", 0.0f);
+            frame.dt = f.value("dt", 0.0f);
+            if (f.contains("events") && f["events"].is_array())
+            {
+                for (const json &e : f["events"])
+                {
+                    if (!e.is_array() || e.size() != 3 || !e[0].is_string() || !e[1].is_number() || !e[2].is_number())
+                    {
+                        ok = false;
+                        break;
+                    }
+                    frame.events.push_back({e[0].get<std::string>(), e[1].get<float>(), e[2].get<float>()});
+                }
+            }
+            rec.frames.push_back(std::move(frame));
+        }
+
+        if (!ok)
+        {
+            ENGINE_LOG_ERROR("[Input] Malformed input recording (frame %zu): %s", rec.frames.size(), path.c_str());
+            return false;
+        }
+        out = std::move(rec);
+        return true;
+    }
+
+    float CameraDifference(const RecordedCamera &a, const RecordedCamera &b)
+    {
+        return std::max({std::abs(a.focusX - b.focusX), std::abs(a.focusZ - b.focusZ), std::abs(a.height - b.height),
+                         std::abs(a.yawDeg - b.yawDeg), std::abs(a.pitchDeg - b.pitchDeg)});
+    }
+} // namespace Sample
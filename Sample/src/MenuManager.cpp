@@ -1,8 +1,8 @@
 #include "MenuManager.h"
+#include "utils/Log.h"
 
 #include <imgui.h>
 #include <chrono>
-#include <iostream>
 
 namespace
 {
@@ -33,41 +33,41 @@ void MenuManager::SetTextureLoader(TextureLoaderFn loader)
         // Attempt to load (non-fatal if missing)
         try
         {
-            std::cout << "[MenuManager] Attempting to load button textures..." << std::endl;
+            ENGINE_LOG_INFO("[MenuManager] Attempting to load button textures...");
             
             m_background = nullptr; // Don't load background (as per your requirement)
             
             m_tex[0] = m_loader("assets/raw/newgame.png");
             if (m_tex[0]) {
-                std::cout << "[MenuManager] ✓ newgame.png loaded successfully" << std::endl;
+                ENGINE_LOG_INFO("[MenuManager] ✓ newgame.png loaded successfully");
             } else {
-                std::cout << "[MenuManager] ✗ newgame.png failed to load" << std::endl;
+                ENGINE_LOG_WARN("[MenuManager] ✗ newgame.png failed to load");
             }
             
             m_tex[1] = m_loader("assets/raw/continuegame.png");
             if (m_tex[1]) {
-                std::cout << "[MenuManager] ✓ continuegame.png loaded successfully" << std::endl;
+                ENGINE_LOG_INFO("[MenuManager] ✓ continuegame.png loaded successfully");
             } else {
-                std::cout << "[MenuManager] ✗ continuegame.png failed to load" << std::endl;
+                ENGINE_LOG_WARN("[MenuManager] ✗ continuegame.png failed to load");
             }
             
             m_tex[2] = m_loader("assets/raw/exit.png");
             if (m_tex[2]) {
-                std::cout << "[MenuManager] ✓ exit.png loaded successfully" << std::endl;
+                ENGINE_LOG_INFO("[MenuManager] ✓ exit.png loaded successfully");
             } else {
-                std::cout << "[MenuManager] ✗ exit.png failed to load" << std::endl;
+                ENGINE_LOG_WARN("[MenuManager] ✗ exit.png failed to load");
             }
         }
         catch (const std::exception& e)
         {
-            std::cerr << "[MenuManager] Exception while loading textures: " << e.what() << std::endl;
+            ENGINE_LOG_ERROR("[MenuManager] Exception while loading textures: %s", e.what());
             // Ignore loader errors; continue with text-only buttons
             m_background = nullptr;
             m_tex = { nullptr, nullptr, nullptr };
         }
         catch (...)
         {
-            std::cerr << "[MenuManager] Unknown exception while loading textures" << std::endl;
+            ENGINE_LOG_ERROR("[MenuManager] Unknown exception while loading textures");
             // Ignore loader errors; continue with text-only buttons
             m_background = nullptr;
             m_tex = { nullptr, nullptr, nullptr };
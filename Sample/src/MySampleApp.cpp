@@ -8,21 +8,27 @@
 #include "ECS/Prefab.h"
 #include "ECS/PrefabSpawner.h"
 #include "ECS/ECSContext.h"
+#include "ECS/WorldSnapshot.h"
 
 #include "ScenarioSpawner.h"
 #include "assets/AssetManager.h"
+#include "utils/LoadGraph.h"
+#include "utils/Log.h"
+#include "utils/VirtualFileSystem.h"
 
+#include "Engine/CrowdComputeModule.h"
 #include "Engine/GroundPlaneRenderPassModule.h"
 
+#include <imgui.h>
 #include <nlohmann/json.hpp>
 #include <fstream>
 
-#include <filesystem>
-#include <iostream>
+#include <bitset>
 #include <limits>
 #include <sstream>
 
 #include <cmath>
+#include <ctime>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -31,13 +37,23 @@
 
 using json = nlohmann::json;
 
-MySampleApp::MySampleApp() : Engine::Application()
+MySampleApp::MySampleApp() : MySampleApp(Options{})
 {
+}
+
+MySampleApp::MySampleApp(const Options &options) : Engine::Application(), m_options(options)
+{
+    // Packed data (PackAssetsTool, STRATO_PACK_SAMPLE_ASSETS) shadows the loose files next to the exe.
+    if (Engine::VirtualFileSystem::exists("assets.spak"))
+        Engine::VirtualFileSystem::mountPack("assets.spak");
+
     m_assets = std::make_unique<Engine::AssetManager>(
         GetVulkanContext().GetDevice(),
         GetVulkanContext().GetPhysicalDevice(),
         GetVulkanContext().GetGraphicsQueue(),
         GetVulkanContext().GetGraphicsQueueFamilyIndex());
+    if (GetVulkanContext().HasDedicatedTransferQueue())
+        m_assets->setTransferQueue(GetVulkanContext().GetTransferQueue(), GetVulkanContext().GetTransferQueueFamilyIndex());
 
 
         m_menu.SetTextureLoader([this](const std::string& relpath) -> ImTextureID {
@@ -94,10 +110,21 @@ MySampleApp::MySampleApp() : Engine::Application()
     win.GetCursorPosition(mx, my);
     m_lastMouse = {static_cast<float>(mx), static_cast<float>(my)};
 
+    // Depth pre-pass: the opaque crowd shades each pixel once, and last frame's depth culls hidden models.
+    GetRenderer().setDepthPrepass(true);
+    // Every pass reads the camera from the Renderer's global set.
+    GetRenderer().setCamera(&m_camera);
+
     // Allow gameplay systems to resolve RenderModel handles to loaded assets.
     m_systems.SetAssetManager(m_assets.get());
     m_systems.SetRenderer(&GetRenderer());
     m_systems.SetCamera(&m_camera);
+    // Simulate at a steady rate (30 Hz by default) on its own thread; frames interpolate between ticks.
+    m_systems.SetSimulationRate(m_options.simulationHz);
+    if (!m_options.showMenu)
+        m_menu.Hide();
+    if (m_options.detectHitches)
+        EnableHitchDetector(m_options.hitches);
 
     // ------------------------------------------------------------
     // Background: simple ground-plane pass using ground baseColor tex
@@ -131,7 +158,6 @@ MySampleApp::MySampleApp() : Engine::Application()
         {
             m_groundPass = std::make_shared<Engine::GroundPlaneRenderPassModule>();
             m_groundPass->setAssets(m_assets.get());
-            m_groundPass->setCamera(&m_camera);
             m_groundPass->setBaseColorTexture(m_groundTexture);
             m_groundPass->setHalfSize(350.0f);
             m_groundPass->setTileWorldSize(5.0f);
@@ -142,6 +168,20 @@ MySampleApp::MySampleApp() : Engine::Application()
 
     setupECSFromPrefabs();
 
+    // Large crowds: avoidance and movement on the GPU. Stays on the CPU path when the device or
+    // shaders/crowd.comp.spv is missing.
+    constexpr uint32_t kGpuCrowdMinUnits = 20000;
+    if (m_scenarioUnits >= kGpuCrowdMinUnits)
+    {
+        m_crowdPass = std::make_shared<Engine::CrowdComputeModule>();
+        GetRenderer().registerPass(m_crowdPass);
+        if (m_crowdPass->available())
+        {
+            m_systems.SetGpuCrowd(m_crowdPass.get());
+            ENGINE_LOG_INFO("[Crowd] GPU avoidance/movement for %u units", m_scenarioUnits);
+        }
+    }
+
     // Systems can be initialized after prefabs are registered.
     m_systems.Initialize(GetECS().components);
 
@@ -161,6 +201,15 @@ MySampleApp::~MySampleApp() = default;
 
 void MySampleApp::Close()
 {
+    if (m_inputMode == InputMode::Record)
+    {
+        Sample::SaveInputRecording(m_options.recordPath, m_inputRecording);
+        m_inputMode = InputMode::Live;
+    }
+
+    // No more ticks (they read assets) before GPU/asset teardown.
+    m_systems.Shutdown();
+
     vkDeviceWaitIdle(GetVulkanContext().GetDevice());
 
     if (m_assets)
@@ -175,13 +224,41 @@ void MySampleApp::Close()
 
 void MySampleApp::OnUpdate(Engine::TimeStep ts)
 {
+    // Finish streamed model loads (prefab visuals) whose uploads have landed
+    if (m_assets)
+        m_assets->update();
+
+    if (!m_scenarioSpawner.done())
+    {
+        const auto world = m_systems.LockWorld();
+        m_scenarioSpawner.update(GetECS(), kScenarioSpawnBudgetMs);
+    }
+
+    if (m_options.traceFrames > 0 && !m_traceRequested && m_scenarioSpawner.done())
+    {
+        m_traceRequested = true;
+        StartTraceCapture(m_options.tracePath, m_options.traceFrames);
+    }
+
+    // Input recording and replay both start with the first frame of the spawned scenario
+    if (!m_inputCaptureStarted && m_scenarioSpawner.done() &&
+        (!m_options.recordPath.empty() || !m_options.replayPath.empty()))
+        StartInputCapture();
+    if (m_inputMode == InputMode::Replay)
+        ts.DeltaSeconds = ReplayFrameInput();
+
+    if (!m_firstFrameLogged)
+    {
+        m_firstFrameLogged = true;
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_launchTime).count();
+        ENGINE_LOG_INFO("[Startup] First frame %.1f ms after launch", ms);
+    }
+
     auto &win = GetWindow();
     const float aspect = static_cast<float>(win.GetWidth()) / static_cast<float>(win.GetHeight());
 
     // Read mouse and compute per-frame delta.
-    double mx = 0.0, my = 0.0;
-    win.GetCursorPosition(mx, my);
-    const glm::vec2 mouse{static_cast<float>(mx), static_cast<float>(my)};
+    const glm::vec2 mouse = CursorPosition();
     const glm::vec2 delta = mouse - m_lastMouse;
     m_lastMouse = mouse;
 
@@ -233,21 +310,135 @@ void MySampleApp::OnUpdate(Engine::TimeStep ts)
     // Apply RTS state to engine camera every frame.
     ApplyRTSCamera(aspect);
 
+    // Simulation LOD: full rate on screen, round-robin further out by distance from the focus.
+    float view[8];
+    GroundQuad({0.0f, 0.0f}, {static_cast<float>(win.GetWidth()), static_cast<float>(win.GetHeight())}, view);
+    m_systems.SetSimulationView(m_rtsCam.focus.x, m_rtsCam.focus.z, view, 4);
+
     m_systems.Update(GetECS(), ts.DeltaSeconds);
+
+    if (m_inputMode != InputMode::Live)
+        FinishInputFrame(ts.DeltaSeconds, mouse);
 }
 
-void MySampleApp::PickAndSelectEntityAtCursor()
+glm::vec2 MySampleApp::CursorPosition()
 {
-    auto &ecs = GetECS();
+    if (m_inputMode == InputMode::Replay)
+        return m_replayCursor;
+    double mx = 0.0, my = 0.0;
+    GetWindow().GetCursorPosition(mx, my);
+    return {static_cast<float>(mx), static_cast<float>(my)};
+}
+
+Sample::RecordedCamera MySampleApp::CameraState() const
+{
+    return {m_rtsCam.focus.x, m_rtsCam.focus.z, m_rtsCam.height, m_rtsCam.yawDeg, m_rtsCam.pitchDeg};
+}
+
+void MySampleApp::StartInputCapture()
+{
+    m_inputCaptureStarted = true;
+
+    // A button held from before is ignored until released, the same when recording and replaying
+    m_isPanning = false;
+    m_panJustStarted = false;
+    m_boxSelecting = false;
+    m_scrollDelta = 0.0f;
+
     auto &win = GetWindow();
+    if (!m_options.replayPath.empty())
+    {
+        Sample::InputRecording recording;
+        if (!Sample::LoadInputRecording(m_options.replayPath, recording) || recording.frames.empty())
+            return;
+        if (recording.scenario != m_options.scenarioPath)
+            ENGINE_LOG_WARN("[Input] Replay was recorded on %s, running %s", recording.scenario.c_str(),
+                            m_options.scenarioPath.c_str());
+        if (recording.windowWidth != win.GetWidth() || recording.windowHeight != win.GetHeight())
+            ENGINE_LOG_WARN("[Input] Replay was recorded at %ux%u, window is %ux%u: picks will land elsewhere",
+                            recording.windowWidth, recording.windowHeight, win.GetWidth(), win.GetHeight());
+
+        m_inputRecording = std::move(recording);
+        const Sample::RecordedCamera &c = m_inputRecording.startCamera;
+        m_rtsCam.focus = {c.focusX, 0.0f, c.focusZ};
+        m_rtsCam.height = c.height;
+        m_rtsCam.yawDeg = c.yawDeg;
+        m_rtsCam.pitchDeg = c.pitchDeg;
+        m_lastMouse = {m_inputRecording.startCursorX, m_inputRecording.startCursorY};
+        m_replayFrame = 0;
+        m_replayDiverged = false;
+        m_inputMode = InputMode::Replay;
+        ENGINE_LOG_INFO("[Input] Replaying %zu frames from %s", m_inputRecording.frames.size(),
+                        m_options.replayPath.c_str());
+        return;
+    }
 
-    double mx = 0.0, my = 0.0;
-    win.GetCursorPosition(mx, my);
+    m_inputRecording = Sample::InputRecording{};
+    m_inputRecording.scenario = m_options.scenarioPath;
+    m_inputRecording.windowWidth = win.GetWidth();
+    m_inputRecording.windowHeight = win.GetHeight();
+    m_inputRecording.startCamera = CameraState();
+    m_inputRecording.startCursorX = m_lastMouse.x;
+    m_inputRecording.startCursorY = m_lastMouse.y;
+    m_pendingInput.clear();
+    m_inputMode = InputMode::Record;
+    ENGINE_LOG_INFO("[Input] Recording input to %s", m_options.recordPath.c_str());
+}
 
-    const float mouseX = static_cast<float>(mx);
-    const float mouseY = static_cast<float>(my);
-    const float width = static_cast<float>(win.GetWidth());
-    const float height = static_cast<float>(win.GetHeight());
+float MySampleApp::ReplayFrameInput()
+{
+    // The recorded events, each at its own cursor, then the cursor the frame sampled
+    const Sample::RecordedFrame &frame = m_inputRecording.frames[m_replayFrame];
+    for (const Sample::RecordedEvent &e : frame.events)
+    {
+        m_replayCursor = {e.cursorX, e.cursorY};
+        HandleInput(e.name);
+    }
+    m_replayCursor = {frame.cursorX, frame.cursorY};
+    return frame.dt;
+}
+
+void MySampleApp::FinishInputFrame(float dt, const glm::vec2 &cursor)
+{
+    if (m_inputMode == InputMode::Record)
+    {
+        Sample::RecordedFrame frame;
+        if (!m_inputRecording.frames.empty())
+            frame.t = m_inputRecording.frames.back().t + m_inputRecording.frames.back().dt;
+        frame.dt = dt;
+        frame.cursorX = cursor.x;
+        frame.cursorY = cursor.y;
+        frame.events = std::move(m_pendingInput);
+        m_pendingInput.clear();
+        frame.camera = CameraState();
+        m_inputRecording.frames.push_back(std::move(frame));
+        return;
+    }
+
+    // Replay: the camera follows the input alone, so a different camera means the input was not
+    // reproduced (window size, a changed camera controller)
+    constexpr float kCameraTolerance = 1e-3f;
+    const float difference = Sample::CameraDifference(CameraState(), m_inputRecording.frames[m_replayFrame].camera);
+    if (!m_replayDiverged && difference > kCameraTolerance)
+    {
+        m_replayDiverged = true;
+        ENGINE_LOG_WARN("[Input] Replay diverged at frame %zu: camera off by %.4f", m_replayFrame, difference);
+    }
+    if (++m_replayFrame < m_inputRecording.frames.size())
+        return;
+    m_inputMode = InputMode::Live;
+    ENGINE_LOG_INFO("[Input] Replay finished after %zu frames%s", m_replayFrame,
+                    m_replayDiverged ? " (diverged)" : ", camera matched throughout");
+}
+
+void MySampleApp::PickAndSelectEntityAtCursor()
+{
+    const auto world = m_systems.LockWorld();
+    auto &ecs = GetECS();
+
+    const glm::vec2 cursor = CursorPosition();
+    const float mouseX = cursor.x;
+    const float mouseY = cursor.y;
 
     const uint32_t selectedId = ecs.components.ensureId("Selected");
     const uint32_t posId = ecs.components.ensureId("Position");
@@ -261,134 +452,144 @@ void MySampleApp::PickAndSelectEntityAtCursor()
     required.set(rmId);
     required.set(raId);
 
-    Engine::ECS::ComponentMask excluded;
-    excluded.set(disabledId);
-    excluded.set(deadId);
-
-    // Project entities to screen; pick closest to cursor within a small radius.
-    const glm::mat4 view = m_camera.GetViewMatrix();
-    const glm::mat4 proj = m_camera.GetProjectionMatrix();
-    const glm::mat4 vp = proj * view;
-
-    constexpr float kPickRadiusPx = 50.0f;
-    const float bestRadius2 = kPickRadiusPx * kPickRadiusPx;
-    float bestD2 = bestRadius2;
-    float bestCamD2 = std::numeric_limits<float>::infinity();
+    // Ray-cast from camera through cursor.
+    glm::vec3 rayOrigin, rayDir;
+    ScreenRay(mouseX, mouseY, rayOrigin, rayDir);
+
+    // Units are picked where the ray meets the ground (Y = 0): the spatial index only scans the cells
+    // around that point. Padding makes small units easier to click.
+    constexpr float kPickPaddingMeters = 0.75f;
+    SpatialHit hit;
+    const bool picked = m_systems.GetSpatialIndex().raycast(
+        rayOrigin.x, rayOrigin.y, rayOrigin.z, rayDir.x, rayDir.y, rayDir.z, 0.0f, kPickPaddingMeters, hit,
+        [&](const GridEntry &e)
+        {
+            const auto *store = ecs.stores.get(e.storeId);
+            return store && e.row < store->size() && store->signature().containsAll(required) &&
+                   !store->hasTag(e.row, disabledId) && !store->hasTag(e.row, deadId);
+        });
 
-    Engine::ECS::ArchetypeStore *bestStore = nullptr;
-    uint32_t bestRow = 0;
+    if (picked)
+    {
+        // Clicked on an entity - select it
+        // Selection changes are deferred to the ECS command buffer (applied at the next sync point).
+        // Clear existing selection first (one memset per store tag plane).
+        ecs.commands.clearTagAll(selectedId);
 
-    for (const auto &ptr : ecs.stores.stores())
+        // Apply selection
+        ecs.commands.addTag(ecs.stores.get(hit.entry.storeId)->entities()[hit.entry.row], selectedId);
+    }
+    else if (hit.t > 0.0f)
     {
-        if (!ptr)
-            continue;
-        auto &store = *ptr;
-        if (!store.signature().containsAll(required))
-            continue;
-        if (!store.signature().containsNone(excluded))
-            continue;
-        if (!store.hasPosition() || !store.hasRenderModel() || !store.hasRenderAnimation())
-            continue;
+        // Clicked on ground - move selected units to this position
+        m_systems.SetGlobalMoveTarget(hit.hitX, 0.0f, hit.hitZ);
 
-        const auto &masks = store.rowMasks();
-        const auto &positions = store.positions();
-        const uint32_t n = store.size();
-        for (uint32_t row = 0; row < n; ++row)
-        {
-            if (!masks[row].matches(required, excluded))
-                continue;
+        ENGINE_LOG_INFO("[Move] Ground click at (%g, %g)", hit.hitX, hit.hitZ);
+    }
+}
 
-            const auto &p = positions[row];
-            const glm::vec4 world(p.x, p.y, p.z, 1.0f);
-            const glm::vec4 clip = vp * world;
-            if (clip.w <= 1e-6f)
-                continue;
+void MySampleApp::ScreenRay(float screenX, float screenY, glm::vec3 &origin, glm::vec3 &dir)
+{
+    auto &win = GetWindow();
+    const float width = static_cast<float>(win.GetWidth());
+    const float height = static_cast<float>(win.GetHeight());
 
-            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
-            if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f)
-                continue;
+    const glm::mat4 view = m_camera.GetViewMatrix();
+    const glm::mat4 proj = m_camera.GetProjectionMatrix();
+    const glm::mat4 vp = proj * view;
 
-            const float sx = (ndc.x * 0.5f + 0.5f) * width;
-            // Camera projection already flips Y for Vulkan, so NDC Y is in the same "down is +" sense as window pixels.
-            const float sy = (ndc.y * 0.5f + 0.5f) * height;
+    // Convert mouse coords to NDC
+    // Camera projection already flips Y for Vulkan, so NDC Y is in the same "down is +" sense as window pixels.
+    const float ndcX = (screenX / width) * 2.0f - 1.0f;
+    const float ndcY = (screenY / height) * 2.0f - 1.0f;
 
-            const float dx = sx - mouseX;
-            const float dy = sy - mouseY;
-            const float d2 = dx * dx + dy * dy;
+    // Unproject near and far points
+    const glm::mat4 invVP = glm::inverse(vp);
+    const glm::vec4 nearClip(ndcX, ndcY, 0.0f, 1.0f);  // Near plane (z=0 in NDC)
+    const glm::vec4 farClip(ndcX, ndcY, 1.0f, 1.0f);   // Far plane (z=1 in NDC)
 
-            const glm::vec3 camPos = m_camera.GetPosition();
-            const glm::vec3 worldPos(p.x, p.y, p.z);
-            const float camD2 = glm::dot(worldPos - camPos, worldPos - camPos);
+    glm::vec4 nearWorld = invVP * nearClip;
+    glm::vec4 farWorld = invVP * farClip;
 
-            if (d2 < bestD2 || (std::abs(d2 - bestD2) < 1e-4f && camD2 < bestCamD2))
-            {
-                bestD2 = d2;
-                bestCamD2 = camD2;
-                bestStore = &store;
-                bestRow = row;
-            }
-        }
-    }
+    if (std::abs(nearWorld.w) > 1e-6f)
+        nearWorld /= nearWorld.w;
+    if (std::abs(farWorld.w) > 1e-6f)
+        farWorld /= farWorld.w;
 
-    if (bestStore)
-    {
-        // Clicked on an entity - select it
-        // Clear existing selection first.
-        for (const auto &ptr : ecs.stores.stores())
-        {
-            if (!ptr)
-                continue;
-            auto &store = *ptr;
-            auto &masks = store.rowMasks();
-            for (auto &mask : masks)
-                mask.clear(selectedId);
-        }
+    origin = glm::vec3(nearWorld);
+    dir = glm::normalize(glm::vec3(farWorld) - glm::vec3(nearWorld));
+}
 
-        // Apply selection
-        bestStore->rowMasks()[bestRow].set(selectedId);
-    }
-    else
+void MySampleApp::GroundQuad(const glm::vec2 &a, const glm::vec2 &b, float quad[8])
+{
+    // The rectangle's frustum meets the ground (Y = 0) in a convex quad: one ray per corner. Corners
+    // above the horizon are clamped to the camera's far distance.
+    constexpr float kFarMeters = 200.0f;
+    const glm::vec2 corners[4] = {{a.x, a.y}, {b.x, a.y}, {b.x, b.y}, {a.x, b.y}};
+    for (int i = 0; i < 4; ++i)
     {
-        // Clicked on ground - move selected units to this position
-        // Ray-cast from camera through cursor to ground plane (Y=0)
-
-        // Convert mouse coords to NDC
-        const float ndcX = (mouseX / width) * 2.0f - 1.0f;
-        const float ndcY = (mouseY / height) * 2.0f - 1.0f;
+        glm::vec3 origin, dir;
+        ScreenRay(corners[i].x, corners[i].y, origin, dir);
+        float t = kFarMeters;
+        if (dir.y < -1e-6f)
+            t = std::min(kFarMeters, -origin.y / dir.y);
+        quad[2 * i] = origin.x + t * dir.x;
+        quad[2 * i + 1] = origin.z + t * dir.z;
+    }
+}
 
-        // Unproject near and far points
-        const glm::mat4 invVP = glm::inverse(vp);
-        const glm::vec4 nearClip(ndcX, ndcY, 0.0f, 1.0f);  // Near plane (z=0 in NDC)
-        const glm::vec4 farClip(ndcX, ndcY, 1.0f, 1.0f);   // Far plane (z=1 in NDC)
+void MySampleApp::SelectUnitsInScreenRect(const glm::vec2 &a, const glm::vec2 &b)
+{
+    const auto world = m_systems.LockWorld();
+    auto &ecs = GetECS();
 
-        glm::vec4 nearWorld = invVP * nearClip;
-        glm::vec4 farWorld = invVP * farClip;
+    const uint32_t selectedId = ecs.components.ensureId("Selected");
+    const uint32_t disabledId = ecs.components.ensureId("Disabled");
+    const uint32_t deadId = ecs.components.ensureId("Dead");
 
-        if (std::abs(nearWorld.w) > 1e-6f)
-            nearWorld /= nearWorld.w;
-        if (std::abs(farWorld.w) > 1e-6f)
-            farWorld /= farWorld.w;
+    Engine::ECS::ComponentMask required;
+    required.set(ecs.components.ensureId("Position"));
+    required.set(ecs.components.ensureId("RenderModel"));
+    required.set(ecs.components.ensureId("RenderAnimation"));
+
+    float quad[8];
+    GroundQuad(a, b, quad);
+
+    // One row bitmask per store; whole grid cells inside the quad are taken without per-unit tests.
+    std::vector<std::vector<uint64_t>> rowWords(ecs.stores.stores().size());
+    m_systems.GetSpatialIndex().queryConvex(quad, 4, [&](const GridEntry &e)
+                                            {
+        const auto *store = ecs.stores.get(e.storeId);
+        if (!store || e.row >= store->size() || !store->signature().containsAll(required))
+            return;
+        auto &words = rowWords[e.storeId];
+        if (words.empty())
+            words.assign((store->size() + 63) / 64, 0ull);
+        words[e.row / 64] |= 1ull << (e.row % 64); });
+
+    // Selection changes are deferred to the ECS command buffer (applied at the next sync point).
+    ecs.commands.clearTagAll(selectedId);
+    uint32_t count = 0;
+    for (uint32_t sid = 0; sid < rowWords.size(); ++sid)
+    {
+        auto &words = rowWords[sid];
+        if (words.empty())
+            continue;
+        const auto *store = ecs.stores.get(sid);
+        if (store->signature().has(disabledId) || store->signature().has(deadId))
+            continue;
 
-        const glm::vec3 rayOrigin(nearWorld);
-        const glm::vec3 rayDir = glm::normalize(glm::vec3(farWorld) - glm::vec3(nearWorld));
+        // Drop Disabled/Dead rows a word at a time.
+        for (const uint32_t tagId : {disabledId, deadId})
+            if (const uint64_t *tagWords = store->tagWords(tagId))
+                for (size_t w = 0; w < words.size(); ++w)
+                    words[w] &= ~tagWords[w];
+        for (const uint64_t w : words)
+            count += static_cast<uint32_t>(std::bitset<64>(w).count());
 
-        // Intersect with ground plane (Y = 0)
-        // Ray: P = O + t * D
-        // Plane: Y = 0  =>  O.y + t * D.y = 0  =>  t = -O.y / D.y
-        if (std::abs(rayDir.y) > 1e-6f)
-        {
-            const float t = -rayOrigin.y / rayDir.y;
-            if (t > 0.0f)
-            {
-                const glm::vec3 hitPoint = rayOrigin + t * rayDir;
-                
-                // Send move command to selected units
-                m_systems.SetGlobalMoveTarget(hitPoint.x, 0.0f, hitPoint.z);
-                
-                std::cout << "[Move] Ground click at (" << hitPoint.x << ", " << hitPoint.z << ")\n";
-            }
-        }
+        ecs.commands.addTagRows(sid, store->structureVersion(), selectedId, std::move(words));
     }
+    ENGINE_LOG_INFO("[Select] Box selected %u units", count);
 }
 
 void MySampleApp::ApplyRTSCamera(float aspect)
@@ -418,6 +619,26 @@ void MySampleApp::ApplyRTSCamera(float aspect)
     m_camera.SetRotation(m_rtsCam.yawDeg, m_rtsCam.pitchDeg);
 }
 
+void MySampleApp::SetCameraView(float focusX, float focusZ, float height, float yawDeg)
+{
+    m_rtsCam.focus = {focusX, 0.0f, focusZ};
+    m_rtsCam.height = glm::clamp(height, m_rtsCam.minHeight, m_rtsCam.maxHeight);
+    m_rtsCam.yawDeg = yawDeg;
+}
+
+void MySampleApp::IssueMoveCommand(float x, float z)
+{
+    m_systems.SetGlobalMoveTarget(x, 0.0f, z);
+}
+
+bool MySampleApp::SpawnScenario(Sample::Scenario scenario)
+{
+    if (!m_scenarioSpawner.done())
+        return false;
+    m_scenarioSpawner.begin(std::move(scenario), /*selectSpawned=*/true);
+    return true;
+}
+
 void MySampleApp::OnRender()
 {
     // Rendering handled by Renderer/Engine.
@@ -432,6 +653,26 @@ void MySampleApp::OnRender()
     }
     m_menu.OnImGuiFrame();
 
+    if (!m_scenarioSpawner.done())
+    {
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f));
+        ImGui::Begin("##ScenarioSpawn", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs);
+        ImGui::Text("Spawning units: %u / %u", m_scenarioSpawner.spawnedUnits(), m_scenarioSpawner.totalUnits());
+        ImGui::ProgressBar(m_scenarioSpawner.progress(), ImVec2(240.0f, 0.0f));
+        ImGui::End();
+    }
+
+    // Marquee while right-dragging.
+    if (m_boxSelecting)
+    {
+        const glm::vec2 cursor = CursorPosition();
+        const ImVec2 a(m_boxStart.x, m_boxStart.y);
+        const ImVec2 b(cursor.x, cursor.y);
+        ImDrawList *draw = ImGui::GetForegroundDrawList();
+        draw->AddRectFilled(a, b, IM_COL32(80, 160, 255, 40));
+        draw->AddRect(a, b, IM_COL32(80, 160, 255, 200));
+    }
+
     // If menu produced a result, handle it
     if (m_menu.GetResult() != MenuManager::Result::None)
     {
@@ -441,6 +682,7 @@ void MySampleApp::OnRender()
         if (res == MenuManager::Result::NewGame)
         {
             std::remove(m_saveFilePath.c_str());
+            std::remove(m_worldSnapshotPath.c_str());
             m_menu.SetHasSaveFile(false);
     
             // Start fade-in effect instead of just hiding
@@ -456,6 +698,7 @@ void MySampleApp::OnRender()
         }
         else if (res == MenuManager::Result::Exit)
         {
+            m_systems.Shutdown();
             std::exit(0);  // Quick exit - no GPU wait, immediate termination
         }
     }
@@ -464,52 +707,95 @@ void MySampleApp::OnRender()
 void MySampleApp::setupECSFromPrefabs()
 {
     auto &ecs = GetECS();
+    const auto start = std::chrono::steady_clock::now();
 
-    // Load all prefab definitions from JSON copied next to executable.
+    // Prefab definitions from JSON copied next to executable (or packed).
     // (CMake copies Sample/entities/*.json -> <build>/Sample/entities/)
-    size_t prefabCount = 0;
-    try
+    // Parsed definitions come from prefab_cache.bin while their JSON is unchanged.
+    //
+    // One load graph: prefab files and the scenario parse on workers; each prefab is registered on
+    // this thread as soon as its definition is ready, which also starts its model streaming.
+    struct PrefabSlot
     {
-        for (const auto &entry : std::filesystem::directory_iterator("entities"))
-        {
-            if (!entry.is_regular_file())
-                continue;
-            if (entry.path().extension() != ".json")
-                continue;
-            const std::string path = entry.path().generic_string();
-            const std::string jsonText = Engine::ECS::readFileText(path);
-            if (jsonText.empty())
-            {
-                std::cerr << "[Prefab] Failed to read: " << path << "\n";
-                continue;
-            }
-            Engine::ECS::Prefab p = Engine::ECS::loadPrefabFromJson(jsonText, ecs.components, ecs.archetypes, *m_assets);
-            if (p.name.empty())
-            {
-                std::cerr << "[Prefab] Missing name in: " << path << "\n";
-                continue;
-            }
-            ecs.prefabs.add(p);
-            ++prefabCount;
-            std::cout << "[Prefab] Loaded " << p.name << " from " << path << "\n";
-        }
-    }
-    catch (const std::exception &e)
+        std::string path;
+        Engine::ECS::PrefabDefinition def;
+    };
+
+    Engine::ECS::PrefabCache prefabCache;
+    std::vector<PrefabSlot> prefabs;
+    for (const std::string &path : Engine::VirtualFileSystem::list("entities", ".json"))
+        prefabs.push_back(PrefabSlot{path, {}});
+    if (prefabs.empty())
     {
-        std::cerr << "[Prefab] Failed to enumerate entities/: " << e.what() << "\n";
+        ENGINE_LOG_ERROR("[Prefab] No prefabs loaded from entities/*.json");
         return;
     }
 
-    if (prefabCount == 0)
+    Engine::LoadGraph graph;
+    size_t prefabCount = 0;
+    for (PrefabSlot &slot : prefabs)
     {
-        std::cerr << "[Prefab] No prefabs loaded from entities/*.json\n";
-        return;
+        PrefabSlot *target = &slot;
+        const auto parse = graph.add("parse " + slot.path, Engine::LoadGraph::Affinity::Worker, [&prefabCache, target]()
+                                     {
+                                         if (prefabCache.load(target->path, target->def))
+                                             return true;
+                                         ENGINE_LOG_ERROR("[Prefab] Failed to read: %s", target->path.c_str());
+                                         return false; });
+
+        graph.add("register " + slot.path, Engine::LoadGraph::Affinity::Main, [&, target]()
+                  {
+                      Engine::ECS::Prefab p = Engine::ECS::instantiatePrefab(target->def, ecs.components, ecs.archetypes, *m_assets);
+                      if (p.name.empty())
+                      {
+                          ENGINE_LOG_ERROR("[Prefab] Missing name in: %s", target->path.c_str());
+                          return false;
+                      }
+                      ecs.prefabs.add(p);
+                      ++prefabCount;
+                      ENGINE_LOG_INFO("[Prefab] Loaded %s from %s", p.name.c_str(), target->path.c_str());
+                      return true; },
+                  {parse});
     }
 
-    Sample::SpawnFromScenarioFile(ecs, "Scinerio.json", /*selectSpawned=*/true);
+    Sample::Scenario scenario;
+    const std::string &scenarioPath = m_options.scenarioPath;
+    if (!scenarioPath.empty())
+        graph.add("parse " + scenarioPath, Engine::LoadGraph::Affinity::Worker, [&scenario, &scenarioPath]()
+                  { return Sample::ParseScenarioFile(scenarioPath, scenario); });
+
+    graph.run(m_systems.GetJobs());
+
+    // Units are spawned over the first frames (OnUpdate); the count is known now for the GPU crowd choice
+    m_scenarioSpawner.begin(std::move(scenario), /*selectSpawned=*/true);
+    m_scenarioUnits = m_scenarioSpawner.totalUnits();
+
+    prefabCache.save();
+    ENGINE_LOG_INFO("[Prefab] %u definitions from cache, %u parsed", prefabCache.getStats().hits, prefabCache.getStats().misses);
+
+    if (prefabCount == 0)
+        ENGINE_LOG_ERROR("[Prefab] No prefabs loaded from entities/*.json");
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ENGINE_LOG_INFO("[Startup] %zu prefabs loaded, %u units queued in %.1f ms", prefabCount, m_scenarioUnits, ms);
 }
 
 void MySampleApp::OnEvent(const std::string &name)
+{
+    // Mouse buttons and the wheel are the match input: recorded, or replaced by a replay. MouseMove
+    // is not; the cursor is sampled per frame and per event instead.
+    const bool matchInput = name.rfind("MouseButton", 0) == 0 || name.rfind("MouseScroll", 0) == 0;
+    if (matchInput && m_inputMode == InputMode::Replay)
+        return;
+    if (matchInput && m_inputMode == InputMode::Record)
+    {
+        const glm::vec2 cursor = CursorPosition();
+        m_pendingInput.push_back({name, cursor.x, cursor.y});
+    }
+    HandleInput(name);
+}
+
+void MySampleApp::HandleInput(const std::string &name)
 {
     std::istringstream iss(name);
     std::string evt;
@@ -519,10 +805,7 @@ void MySampleApp::OnEvent(const std::string &name)
     {
         m_isPanning = true;
         m_panJustStarted = true;
-        auto &win = GetWindow();
-        double mx = 0.0, my = 0.0;
-        win.GetCursorPosition(mx, my);
-        m_lastMouse = {static_cast<float>(mx), static_cast<float>(my)};
+        m_lastMouse = CursorPosition();
         return;
     }
 
@@ -535,7 +818,25 @@ void MySampleApp::OnEvent(const std::string &name)
 
     if (evt == "MouseButtonRightDown")
     {
-        PickAndSelectEntityAtCursor();
+        // Click or drag decided on release.
+        m_boxSelecting = true;
+        m_boxStart = CursorPosition();
+        return;
+    }
+
+    if (evt == "MouseButtonRightUp")
+    {
+        if (!m_boxSelecting)
+            return;
+        m_boxSelecting = false;
+
+        const glm::vec2 end = CursorPosition();
+
+        constexpr float kDragThresholdPx = 6.0f;
+        if (std::abs(end.x - m_boxStart.x) > kDragThresholdPx || std::abs(end.y - m_boxStart.y) > kDragThresholdPx)
+            SelectUnitsInScreenRect(m_boxStart, end);
+        else
+            PickAndSelectEntityAtCursor();
         return;
     }
 
@@ -553,6 +854,16 @@ void MySampleApp::OnEvent(const std::string &name)
         Close();
         return;
     }
+
+    if (name == "F5Pressed")
+    {
+        // One file per capture, named after the local time
+        const std::time_t now = std::time(nullptr);
+        char path[64];
+        std::strftime(path, sizeof(path), "trace_%Y%m%d_%H%M%S.json", std::localtime(&now));
+        StartTraceCapture(path, kHotkeyTraceFrames);
+        return;
+    }
 }
 
 void MySampleApp::SaveGameState()
@@ -582,6 +893,11 @@ void MySampleApp::SaveGameState()
     std::ofstream o(m_saveFilePath);
     if (o.good())
         o << j.dump(4);
+
+    const auto world = m_systems.LockWorld();
+    auto &ecs = GetECS();
+    if (!Engine::ECS::saveWorldSnapshot(m_worldSnapshotPath, ecs.components, ecs.stores, ecs.entities))
+        ENGINE_LOG_ERROR("[Save] Failed to write world snapshot: %s", m_worldSnapshotPath.c_str());
 }
 
 void MySampleApp::LoadGameState()
@@ -591,6 +907,16 @@ void MySampleApp::LoadGameState()
     json j;
     i >> j;
 
+    // Entities and their components; the JSON only carries camera/window state.
+    {
+        const auto world = m_systems.LockWorld();
+        auto &ecs = GetECS();
+        if (!Engine::ECS::loadWorldSnapshot(m_worldSnapshotPath, ecs.components, ecs.archetypes, ecs.stores, ecs.entities))
+            ENGINE_LOG_WARN("[Load] No usable world snapshot: %s", m_worldSnapshotPath.c_str());
+        // The snapshot is the world now; drop whatever the scenario had left to spawn
+        m_scenarioSpawner.begin(Sample::Scenario{});
+    }
+
     m_rtsCam.focus.x = j.value("rts_focus_x", m_rtsCam.focus.x);
     m_rtsCam.focus.y = j.value("rts_focus_y", m_rtsCam.focus.y);
     m_rtsCam.focus.z = j.value("rts_focus_z", m_rtsCam.focus.z);
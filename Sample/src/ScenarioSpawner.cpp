@@ -1,17 +1,19 @@
 #include "ScenarioSpawner.h"
 
-#include "Structs/SpawnGroup.h"
-
 #include "ECS/ECSContext.h"
 #include "ECS/Prefab.h"
 #include "ECS/PrefabSpawner.h"
+#include "utils/Log.h"
+#include "utils/Profiler.h"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <iostream>
 #include <random>
 #include <unordered_map>
+#include <vector>
 
 namespace
 {
@@ -23,12 +25,12 @@ namespace
         float r = 0.0f;
         float s = 0.0f;
         if (auto it = prefab.defaults.find(radId);
-            it != prefab.defaults.end() && std::holds_alternative<Engine::ECS::Radius>(it->second))
-            r = std::get<Engine::ECS::Radius>(it->second).r;
+            it != prefab.defaults.end() && it->second.holds<Engine::ECS::Radius>())
+            r = it->second.get<Engine::ECS::Radius>().r;
 
         if (auto it = prefab.defaults.find(sepId);
-            it != prefab.defaults.end() && std::holds_alternative<Engine::ECS::Separation>(it->second))
-            s = std::get<Engine::ECS::Separation>(it->second).value;
+            it != prefab.defaults.end() && it->second.holds<Engine::ECS::Separation>())
+            s = it->second.get<Engine::ECS::Separation>().value;
 
         // For same-type units, desired center-to-center distance is:
         // (r1+r2) + (sep1+sep2) = 2r + 2sep.
@@ -130,17 +132,55 @@ namespace
         const float oz = (static_cast<float>(row) - halfH) * spacingM;
         return {ox, oz};
     }
+
+    // Positions (and the Selected tag) of rows just spawned for units [firstIndex, firstIndex + count)
+    // of the group; 'rng' carries the group's jitter sequence across slices.
+    void placeSpawnedRows(Engine::ECS::ArchetypeStore &store, const Engine::ECS::BatchSpawnResult &batch,
+                          const SpawnGroupResolved &sg, uint32_t firstIndex, float spacingM, std::mt19937 &rng,
+                          bool selectSpawned, uint32_t selectedId)
+    {
+        std::uniform_real_distribution<float> jitter(-sg.jitterM, sg.jitterM);
+        auto positions = store.positions();
+        for (uint32_t i = 0; i < batch.count; ++i)
+        {
+            const uint32_t row = batch.firstRow + i;
+            float x = sg.originX;
+            float z = sg.originZ;
+
+            const auto [ox, oz] = computeFormationOffset(sg, static_cast<int>(firstIndex + i), spacingM);
+            x += ox;
+            z += oz;
+
+            x += jitter(rng);
+            z += jitter(rng);
+
+            auto &&p = positions[row];
+            p.x = x;
+            p.y = 0.0f;
+            p.z = z;
+
+            if (selectSpawned)
+            {
+                store.setTag(row, selectedId);
+            }
+        }
+    }
+
+    std::mt19937 groupRng(const SpawnGroupResolved &sg)
+    {
+        return std::mt19937(static_cast<uint32_t>(std::hash<std::string>{}(sg.id)));
+    }
 }
 
 namespace Sample
 {
-    uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned)
+    bool ParseScenarioFile(const std::string &scenarioPath, Scenario &out)
     {
         const std::string text = Engine::ECS::readFileText(scenarioPath);
         if (text.empty())
         {
-            std::cerr << "[Scenario] Failed to read " << scenarioPath << " next to executable\n";
-            return 0;
+            ENGINE_LOG_ERROR("[Scenario] Failed to read %s next to executable", scenarioPath.c_str());
+            return false;
         }
 
         nlohmann::json j;
@@ -150,85 +190,177 @@ namespace Sample
         }
         catch (const std::exception &e)
         {
-            std::cerr << "[Scenario] JSON parse error: " << e.what() << "\n";
-            return 0;
+            ENGINE_LOG_ERROR("[Scenario] JSON parse error: %s", e.what());
+            return false;
         }
 
-        const std::string scenarioName = j.value("name", std::string("(unnamed)"));
-        std::cout << "[Scenario] Loading: " << scenarioName << "\n";
+        out.name = j.value("name", std::string("(unnamed)"));
+        ENGINE_LOG_INFO("[Scenario] Loading: %s", out.name.c_str());
 
         if (!j.contains("spawnGroups") || !j["spawnGroups"].is_array())
         {
-            std::cerr << "[Scenario] Missing spawnGroups[]\n";
-            return 0;
+            ENGINE_LOG_ERROR("[Scenario] Missing spawnGroups[]");
+            return false;
         }
 
         const auto anchors = parseAnchors(j);
-        const uint32_t selectedId = ecs.components.ensureId("Selected");
-
-        uint32_t totalSpawned = 0;
+        out.groups.clear();
         for (const auto &g : j["spawnGroups"])
         {
-            const SpawnGroupResolved sg = parseSpawnGroup(g, anchors);
-
+            SpawnGroupResolved sg = parseSpawnGroup(g, anchors);
             if (sg.unitType.empty() || sg.count <= 0)
             {
-                std::cerr << "[Scenario] Skipping group id=" << sg.id << " (missing unitType or count)\n";
+                ENGINE_LOG_WARN("[Scenario] Skipping group id=%s (missing unitType or count)", sg.id.c_str());
                 continue;
             }
+            out.groups.push_back(std::move(sg));
+        }
+        return true;
+    }
 
-            const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType);
-            if (!prefab)
-            {
-                std::cerr << "[Scenario] Missing prefab for unitType=" << sg.unitType << " (group=" << sg.id << ")\n";
-                continue;
-            }
+    uint32_t SpawnScenarioGroup(Engine::ECS::ECSContext &ecs, const SpawnGroupResolved &sg, bool selectSpawned)
+    {
+        ENGINE_PROFILE_SCOPE("SpawnScenarioGroup");
+        const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType);
+        if (!prefab)
+        {
+            ENGINE_LOG_WARN("[Scenario] Missing prefab for unitType=%s (group=%s)", sg.unitType.c_str(), sg.id.c_str());
+            return 0;
+        }
 
-            const float spacingM = sg.spacingAuto ? prefabAutoSpacingMeters(*prefab, ecs.components) : sg.spacingM;
+        const uint32_t selectedId = ecs.components.ensureId("Selected");
+        const float spacingM = sg.spacingAuto ? prefabAutoSpacingMeters(*prefab, ecs.components) : sg.spacingM;
+
+        ENGINE_LOG_INFO("[Scenario] Spawn group id=%s unitType=%s count=%d origin=(%g,%g) formation=%s spacingM=%g jitterM=%g",
+                        sg.id.c_str(), sg.unitType.c_str(), sg.count, sg.originX, sg.originZ,
+                        sg.formationKind.c_str(), spacingM, sg.jitterM);
+
+        // One batch per group: row template built once, store columns reserved once.
+        std::vector<Engine::ECS::Entity> spawned;
+        const Engine::ECS::BatchSpawnResult batch = Engine::ECS::spawnFromPrefabBatch(
+            *prefab, static_cast<uint32_t>(sg.count), ecs.components, ecs.stores, ecs.entities, spawned);
+        Engine::ECS::ArchetypeStore *store = ecs.stores.get(batch.archetypeId);
+        if (!store || !store->hasPosition())
+            return 0;
 
-            std::mt19937 rng(static_cast<uint32_t>(std::hash<std::string>{}(sg.id)));
-            std::uniform_real_distribution<float> jitter(-sg.jitterM, sg.jitterM);
+        std::mt19937 rng = groupRng(sg);
+        placeSpawnedRows(*store, batch, sg, 0, spacingM, rng, selectSpawned, selectedId);
+        return batch.count;
+    }
 
-            std::cout << "[Scenario] Spawn group id=" << sg.id
-                      << " unitType=" << sg.unitType
-                      << " count=" << sg.count
-                      << " origin=(" << sg.originX << "," << sg.originZ << ")"
-                      << " formation=" << sg.formationKind
-                      << " spacingM=" << spacingM
-                      << " jitterM=" << sg.jitterM << "\n";
+    uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned)
+    {
+        Scenario scenario;
+        if (!ParseScenarioFile(scenarioPath, scenario))
+            return 0;
 
-            for (int i = 0; i < sg.count; ++i)
-            {
-                float x = sg.originX;
-                float z = sg.originZ;
+        uint32_t totalSpawned = 0;
+        for (const SpawnGroupResolved &sg : scenario.groups)
+            totalSpawned += SpawnScenarioGroup(ecs, sg, selectSpawned);
 
-                const auto [ox, oz] = computeFormationOffset(sg, i, spacingM);
-                x += ox;
-                z += oz;
+        ENGINE_LOG_INFO("[Scenario] Total units spawned: %u", totalSpawned);
+        return totalSpawned;
+    }
 
-                x += jitter(rng);
-                z += jitter(rng);
+    bool IncrementalScenarioSpawner::begin(const std::string &scenarioPath, bool selectSpawned)
+    {
+        Scenario scenario;
+        if (!ParseScenarioFile(scenarioPath, scenario))
+        {
+            begin(Scenario{}, selectSpawned);
+            return false;
+        }
+        begin(std::move(scenario), selectSpawned);
+        return true;
+    }
 
-                Engine::ECS::SpawnResult res = Engine::ECS::spawnFromPrefab(*prefab, ecs.components, ecs.archetypes, ecs.stores, ecs.entities);
-                Engine::ECS::ArchetypeStore *store = ecs.stores.get(res.archetypeId);
-                if (!store || !store->hasPosition())
-                    continue;
+    void IncrementalScenarioSpawner::begin(Scenario scenario, bool selectSpawned)
+    {
+        m_scenario = std::move(scenario);
+        m_selectSpawned = selectSpawned;
+        m_group = 0;
+        m_groupIndex = 0;
+        m_groupStarted = false;
+        m_totalUnits = 0;
+        m_processedUnits = 0;
+        m_spawnedUnits = 0;
+        m_batchSize = kInitialBatch;
+        for (const SpawnGroupResolved &sg : m_scenario.groups)
+            m_totalUnits += static_cast<uint32_t>(sg.count);
+    }
 
-                auto &p = store->positions()[res.row];
-                p.x = x;
-                p.y = 0.0f;
-                p.z = z;
+    uint32_t IncrementalScenarioSpawner::update(Engine::ECS::ECSContext &ecs, float budgetMs)
+    {
+        ENGINE_PROFILE_SCOPE("IncrementalScenarioSpawner::update");
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        const uint32_t selectedId = ecs.components.ensureId("Selected");
+        const uint32_t spawnedBefore = m_spawnedUnits;
 
-                if (selectSpawned)
+        std::vector<Engine::ECS::Entity> spawned;
+        while (!done())
+        {
+            const SpawnGroupResolved &sg = m_scenario.groups[m_group];
+            const uint32_t groupCount = static_cast<uint32_t>(sg.count);
+            const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType);
+            if (!m_groupStarted)
+            {
+                if (!prefab)
                 {
-                    store->rowMasks()[res.row].set(selectedId);
+                    ENGINE_LOG_WARN("[Scenario] Missing prefab for unitType=%s (group=%s)", sg.unitType.c_str(), sg.id.c_str());
+                    m_processedUnits += groupCount;
+                    nextGroup_Internal();
+                    continue;
                 }
+                m_groupStarted = true;
+                m_groupRng = groupRng(sg);
+                m_groupSpacingM = sg.spacingAuto ? prefabAutoSpacingMeters(*prefab, ecs.components) : sg.spacingM;
+                ENGINE_LOG_INFO("[Scenario] Spawn group id=%s unitType=%s count=%d origin=(%g,%g) formation=%s spacingM=%g jitterM=%g",
+                                sg.id.c_str(), sg.unitType.c_str(), sg.count, sg.originX, sg.originZ,
+                                sg.formationKind.c_str(), m_groupSpacingM, sg.jitterM);
+            }
 
-                ++totalSpawned;
+            // One slice: a batch spawn of up to m_batchSize rows of the current group
+            const Clock::time_point sliceStart = Clock::now();
+            const uint32_t count = std::min(m_batchSize, groupCount - m_groupIndex);
+            spawned.clear();
+            const Engine::ECS::BatchSpawnResult batch = Engine::ECS::spawnFromPrefabBatch(
+                *prefab, count, ecs.components, ecs.stores, ecs.entities, spawned);
+            Engine::ECS::ArchetypeStore *store = ecs.stores.get(batch.archetypeId);
+            if (!store || !store->hasPosition())
+            {
+                // Matches SpawnScenarioGroup: rows without a position are not counted as units
+                m_processedUnits += groupCount - m_groupIndex;
+                nextGroup_Internal();
+                continue;
             }
+            placeSpawnedRows(*store, batch, sg, m_groupIndex, m_groupSpacingM, m_groupRng, m_selectSpawned, selectedId);
+
+            m_groupIndex += count;
+            m_processedUnits += count;
+            m_spawnedUnits += batch.count;
+            if (m_groupIndex >= groupCount)
+                nextGroup_Internal();
+
+            // Size the next slice to what is left of the budget at the rate this one achieved
+            const double now = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            const double sliceMs = std::chrono::duration<double, std::milli>(Clock::now() - sliceStart).count();
+            if (now >= budgetMs)
+                break;
+            const double unitsPerMs = static_cast<double>(count) / std::max(sliceMs, 1e-3);
+            const double fit = (budgetMs - now) * unitsPerMs;
+            m_batchSize = static_cast<uint32_t>(std::clamp(fit, double(kMinBatch), double(kMaxBatch)));
         }
 
-        std::cout << "[Scenario] Total units spawned: " << totalSpawned << "\n";
-        return totalSpawned;
+        if (done() && spawnedBefore != m_spawnedUnits)
+            ENGINE_LOG_INFO("[Scenario] Total units spawned: %u", m_spawnedUnits);
+        return m_spawnedUnits - spawnedBefore;
+    }
+
+    void IncrementalScenarioSpawner::nextGroup_Internal()
+    {
+        ++m_group;
+        m_groupIndex = 0;
+        m_groupStarted = false;
     }
 }
@@ -0,0 +1,140 @@
+#include "ServerApp.h"
+
+#include "ECS/ECSContext.h"
+#include "assets/HeadlessAssets.h"
+#include "utils/JobSystem.h"
+#include "utils/Log.h"
+#include "utils/Profiler.h"
+#include "utils/VirtualFileSystem.h"
+
+#include <chrono>
+
+namespace Sample
+{
+    bool ServerData::load(const std::string &scenarioPath)
+    {
+        Engine::ECS::PrefabCache cache;
+        for (const std::string &path : Engine::VirtualFileSystem::list("entities", ".json"))
+        {
+            Engine::ECS::PrefabDefinition def;
+            if (!cache.load(path, def) || def.name.empty())
+            {
+                ENGINE_LOG_ERROR("[Server] Failed to read prefab: %s", path.c_str());
+                continue;
+            }
+            prefabs.push_back(std::move(def));
+        }
+        cache.save();
+
+        if (prefabs.empty())
+        {
+            ENGINE_LOG_ERROR("[Server] No prefabs loaded from entities/*.json");
+            return false;
+        }
+        if (!ParseScenarioFile(scenarioPath, scenario))
+        {
+            ENGINE_LOG_ERROR("[Server] Failed to read scenario: %s", scenarioPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    ServerMatch::ServerMatch(const Config &config, const ServerData &data)
+        : Engine::HeadlessApplication(config.app), m_data(data), m_rng(config.seed)
+    {
+    }
+
+    void ServerMatch::OnStart()
+    {
+        Engine::ECS::ECSContext &ecs = GetECS();
+        Engine::JobSystem &jobs = GetJobs();
+
+        // Same wiring as SystemRunner::Initialize, minus rendering, the camera-driven LOD and the spatial grid.
+        (void)ecs.components.ensureId("Selected");
+        m_command.buildMasks(ecs.components);
+        m_flowFields.buildMasks(ecs.components);
+        m_steering.buildMasks(ecs.components);
+        m_movement.buildMasks(ecs.components);
+        m_characterAnim.buildMasks(ecs.components);
+
+        m_steering.setJobSystem(&jobs);
+        m_movement.setJobSystem(&jobs);
+        m_flowFields.setJobSystem(&jobs);
+
+        m_flowFields.setCellSize(kCellSize);
+        m_command.setFlowFields(&m_flowFields);
+        m_steering.setFlowFields(&m_flowFields);
+        m_characterAnim.setModelProvider(&GetAssets());
+
+        m_reorder.setCellSize(kCellSize);
+        m_reorder.setInterval(120);
+
+        m_scheduler.clear();
+        m_scheduler.add(&m_command);
+        m_scheduler.add(&m_flowFields);
+        m_scheduler.add(&m_steering);
+        m_scheduler.add(&m_movement);
+        m_scheduler.add(&m_characterAnim);
+        m_scheduler.build();
+
+        for (const Engine::ECS::PrefabDefinition &def : m_data.prefabs)
+            ecs.prefabs.add(Engine::ECS::instantiatePrefab(def, ecs.components, ecs.archetypes, GetAssets()));
+
+        // Selected: the bot orders every unit
+        uint32_t spawned = 0;
+        for (const SpawnGroupResolved &group : m_data.scenario.groups)
+            spawned += SpawnScenarioGroup(ecs, group, /*selectSpawned=*/true);
+        m_units.store(spawned, std::memory_order_relaxed);
+
+        ENGINE_LOG_INFO("[Server] %s: %zu prefabs, %u units, %u models", GetConfig().name.c_str(),
+                        m_data.prefabs.size(), spawned, GetAssets().modelCount());
+    }
+
+    void ServerMatch::OnTick(Engine::TimeStep ts)
+    {
+        ENGINE_PROFILE_SCOPE("ServerMatch::OnTick");
+        const auto start = std::chrono::steady_clock::now();
+
+        Engine::ECS::ECSContext &ecs = GetECS();
+        Engine::JobSystem &jobs = GetJobs();
+
+        m_sinceOrder += ts.DeltaSeconds;
+        if (m_sinceOrder >= kOrderIntervalSeconds)
+        {
+            m_sinceOrder = 0.0f;
+            std::uniform_real_distribution<float> coord(-kOrderRangeM, kOrderRangeM);
+            const float x = coord(m_rng);
+            const float z = coord(m_rng);
+            m_command.SetGlobalMoveTarget(x, 0.0f, z);
+        }
+
+        // Sync point: apply structural changes recorded since the last tick.
+        ecs.commands.reserveThreads(jobs.threadCount());
+        ecs.PlaybackCommands();
+
+        m_scheduler.forEachSystem([&](Engine::ECS::SystemBase &system)
+                                  {
+                                      system.setCommandBuffer(&ecs.commands);
+                                      system.setFrameArena(&GetFrameArena());
+                                  });
+        m_scheduler.run(ecs.stores, ts.DeltaSeconds, &jobs);
+
+        // Sync point: apply what systems recorded this tick, then the structural housekeeping.
+        ecs.PlaybackCommands();
+        m_reorder.tick(ecs.stores, ecs.entities);
+
+        uint32_t units = 0;
+        for (const auto &store : ecs.stores.stores())
+            units += store ? store->size() : 0u;
+        m_units.store(units, std::memory_order_relaxed);
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_tickNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+    }
+
+    double ServerMatch::GetMeanTickMs() const
+    {
+        const uint64_t ticks = GetTick();
+        return ticks ? static_cast<double>(m_tickNs.load(std::memory_order_relaxed)) / 1.0e6 / static_cast<double>(ticks) : 0.0;
+    }
+}
@@ -0,0 +1,428 @@
+#include "SweepApp.h"
+
+#include "Engine/SwapChain.h"
+#include "Engine/VulkanContext.h"
+#include "Engine/Renderer.h"
+#include "utils/Log.h"
+#include "utils/MemoryAllocator.h"
+#include "utils/MemoryTracker.h"
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    MySampleApp::Options SampleOptions()
+    {
+        MySampleApp::Options options;
+        options.scenarioPath.clear(); // units come from the sweep steps
+        options.showMenu = false;
+        options.simulationHz = 0.0f; // inline: one tick per frame with the fixed dt
+        return options;
+    }
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: StratosphereBench --sweep [--start N] [--factor F] [--max N] [--frames N] [--warmup N]\n"
+                     "                                 [--dt S] [--formation dense|sparse] [--budget MS] [--seed N]\n"
+                     "                                 [--out path.csv] [--vsync]\n");
+    }
+
+    // CSV field: quoted when it holds a separator or a quote
+    std::string CsvField(const std::string &s)
+    {
+        if (s.find_first_of(",\"\n") == std::string::npos)
+            return s;
+        std::string out = "\"";
+        for (char c : s)
+        {
+            if (c == '"')
+                out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    constexpr float kGoldenAngle = 2.39996323f;
+    constexpr float kPi = 3.14159265f;
+    constexpr double kToMB = 1.0 / (1024.0 * 1024.0);
+} // namespace
+
+bool SweepApp::ParseArgs(int argc, char **argv, Config &out)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--sweep") == 0)
+            continue;
+        else if (std::strcmp(arg, "--start") == 0 && hasValue)
+            out.startUnits = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--factor") == 0 && hasValue)
+            out.factor = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(arg, "--max") == 0 && hasValue)
+            out.maxUnits = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--frames") == 0 && hasValue)
+            out.frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--warmup") == 0 && hasValue)
+            out.warmupFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--dt") == 0 && hasValue)
+            out.dtSeconds = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(arg, "--formation") == 0 && hasValue)
+        {
+            const char *kind = argv[++i];
+            if (std::strcmp(kind, "dense") != 0 && std::strcmp(kind, "sparse") != 0)
+            {
+                PrintUsage();
+                return false;
+            }
+            out.sparse = std::strcmp(kind, "sparse") == 0;
+        }
+        else if (std::strcmp(arg, "--budget") == 0 && hasValue)
+            out.budgetMs = std::strtof(argv[++i], nullptr);
+        else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+            out.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(arg, "--out") == 0 && hasValue)
+            out.outputPath = argv[++i];
+        else if (std::strcmp(arg, "--vsync") == 0)
+            out.vsync = true;
+        else
+        {
+            PrintUsage();
+            return false;
+        }
+    }
+
+    if (out.startUnits == 0 || out.maxUnits < out.startUnits || !(out.factor > 1.0f) || out.frames == 0 ||
+        !(out.dtSeconds > 0.0f) || !(out.budgetMs > 0.0f))
+    {
+        PrintUsage();
+        return false;
+    }
+    return true;
+}
+
+SweepApp::SweepApp(const Config &config)
+    : MySampleApp(SampleOptions()), m_config(config), m_rng(config.seed)
+{
+    SetFixedTimeStep(m_config.dtSeconds);
+    Engine::Profiler::setEnabled(true);
+
+    if (!m_config.vsync)
+    {
+        // Rebuild the swapchain (and what depends on it) the way a resize does, with the new mode
+        GetVulkanContext().GetSwapChain()->SetPreferredPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR);
+        handleWindowEvent("WindowResize");
+    }
+
+    m_prefabs = PrefabNames();
+    m_frameMs.reserve(m_config.frames);
+    ENGINE_LOG_INFO("[Sweep] %zu prefabs, %u to %u units each (x%.2f per step), %s formation, %u frames per step at dt %.4f s",
+                    m_prefabs.size(), m_config.startUnits, m_config.maxUnits, m_config.factor,
+                    m_config.sparse ? "sparse" : "dense", m_config.frames, m_config.dtSeconds);
+
+    if (m_prefabs.empty() || !StartStep_Internal())
+    {
+        ENGINE_LOG_ERROR("[Sweep] Nothing to spawn");
+        m_phase = Phase::Done;
+        RequestClose();
+    }
+}
+
+bool SweepApp::StartStep_Internal()
+{
+    // Geometric ramp, clamped to the maximum; the last step lands on it exactly
+    uint32_t next = m_config.startUnits;
+    if (m_unitsPerPrefab > 0)
+    {
+        const double scaled = std::ceil(static_cast<double>(m_unitsPerPrefab) * m_config.factor);
+        next = static_cast<uint32_t>(std::min(scaled, static_cast<double>(m_config.maxUnits)));
+    }
+    if (next <= m_unitsPerPrefab)
+        return false;
+
+    const uint32_t added = next - m_unitsPerPrefab;
+    const float spacing = m_config.sparse ? kSparseSpacingM : kDenseSpacingM;
+    const float side = std::ceil(std::sqrt(static_cast<float>(added))) * spacing;
+
+    Sample::Scenario scenario;
+    scenario.name = "sweep " + std::to_string(next);
+    for (const std::string &prefab : m_prefabs)
+    {
+        // Sunflower layout: each block just outside the area of the blocks before it, so blocks
+        // roughly tile the disc instead of overlapping
+        const float radius = std::sqrt(m_layoutArea / kPi) + 0.5f * side;
+        const float angle = static_cast<float>(m_blocks) * kGoldenAngle;
+
+        SpawnGroupResolved group;
+        group.id = "sweep" + std::to_string(next) + "_" + prefab;
+        group.unitType = prefab;
+        group.count = static_cast<int>(added);
+        group.originX = std::cos(angle) * radius;
+        group.originZ = std::sin(angle) * radius;
+        group.jitterM = 0.1f * spacing;
+        group.formationKind = "grid";
+        group.spacingAuto = false;
+        group.spacingM = spacing;
+        scenario.groups.push_back(group);
+
+        m_layoutArea += side * side;
+        ++m_blocks;
+    }
+
+    if (!SpawnScenario(std::move(scenario)))
+        return false;
+    m_unitsPerPrefab = next;
+    m_phase = Phase::Spawning;
+    m_phaseFrames = 0;
+
+    // Whole crowd in view as far as the camera allows
+    const float layoutRadius = std::sqrt(m_layoutArea / kPi);
+    SetCameraView(0.0f, 0.0f, std::clamp(layoutRadius * 1.5f, 70.0f, 250.0f), -45.0f);
+    return true;
+}
+
+void SweepApp::IssueRandomMove_Internal()
+{
+    const float layoutRadius = std::sqrt(m_layoutArea / kPi);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float r = layoutRadius * std::sqrt(unit(m_rng));
+    const float angle = 2.0f * kPi * unit(m_rng);
+    IssueMoveCommand(std::cos(angle) * r, std::sin(angle) * r);
+}
+
+void SweepApp::Sample_Internal(float frameMs)
+{
+    m_frameMs.push_back(frameMs);
+    for (const Engine::Profiler::ScopeStats &scope : Engine::Profiler::stats())
+        m_cpuSums[scope.name] += scope.lastMs;
+
+    const Engine::Renderer &renderer = GetRenderer();
+    m_gpuMsSum += renderer.getGpuTimeMs();
+    for (const Engine::GpuProfiler::PassTiming &pass : renderer.getGpuPassTimings())
+        m_gpuSums[std::string(pass.name) + "/" + pass.stage] += pass.ms;
+}
+
+void SweepApp::FinishStep_Internal()
+{
+    const double frames = static_cast<double>(m_frameMs.size());
+
+    Step step;
+    step.unitsPerPrefab = m_unitsPerPrefab;
+    step.units = m_units;
+    std::vector<float> sorted = m_frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float ms : sorted)
+        sum += ms;
+    step.frameMsMean = static_cast<float>(sum / frames);
+    const size_t rank = static_cast<size_t>(std::ceil(0.95 * frames));
+    step.frameMsP95 = sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    step.gpuMsMean = static_cast<float>(m_gpuMsSum / frames);
+    for (const auto &[name, total] : m_cpuSums)
+        step.cpuScopes[name] = static_cast<float>(total / frames);
+    for (const auto &[name, total] : m_gpuSums)
+        step.gpuPasses[name] = static_cast<float>(total / frames);
+
+    if (const Engine::MemoryAllocator *allocator = Engine::MemoryAllocator::ForDevice(GetVulkanContext().GetDevice()))
+        step.gpuMemoryMB = static_cast<double>(allocator->getStats().usedBytes) * kToMB;
+    uint64_t cpuBytes = 0;
+    for (size_t c = 0; c < Engine::MemoryTracker::kCategoryCount; ++c)
+        cpuBytes += Engine::MemoryTracker::current(static_cast<Engine::CpuMemoryCategory>(c));
+    step.cpuMemoryMB = static_cast<double>(cpuBytes) * kToMB;
+
+    m_steps.push_back(std::move(step));
+    const Step &s = m_steps.back();
+    ENGINE_LOG_INFO("[Sweep] %u units: frame %.2f ms (p95 %.2f), GPU %.2f ms, GPU memory %.1f MB, CPU memory %.1f MB%s",
+                    s.units, s.frameMsMean, s.frameMsP95, s.gpuMsMean, s.gpuMemoryMB, s.cpuMemoryMB,
+                    s.frameMsMean > m_config.budgetMs ? "  OVER BUDGET" : "");
+    WriteResults_Internal();
+
+    m_frameMs.clear();
+    m_gpuMsSum = 0.0;
+    m_cpuSums.clear();
+    m_gpuSums.clear();
+
+    if (s.frameMsMean > m_config.budgetMs * kStopFactor || !StartStep_Internal())
+    {
+        m_phase = Phase::Done;
+        LogScaling_Internal();
+        m_succeeded = WriteResults_Internal();
+        RequestClose();
+    }
+}
+
+bool SweepApp::WriteResults_Internal() const
+{
+    std::vector<std::string> cpuNames;
+    std::vector<std::string> gpuNames;
+    {
+        std::map<std::string, bool> cpu, gpu;
+        for (const Step &s : m_steps)
+        {
+            for (const auto &entry : s.cpuScopes)
+                cpu[entry.first] = true;
+            for (const auto &entry : s.gpuPasses)
+                gpu[entry.first] = true;
+        }
+        for (const auto &entry : cpu)
+            cpuNames.push_back(entry.first);
+        for (const auto &entry : gpu)
+            gpuNames.push_back(entry.first);
+    }
+
+    std::ofstream out(m_config.outputPath);
+    if (!out.good())
+    {
+        ENGINE_LOG_ERROR("[Sweep] Cannot write results: %s", m_config.outputPath.c_str());
+        return false;
+    }
+
+    out << "unitsPerPrefab,units,frameMsMean,frameMsP95,gpuMsMean,gpuMemoryMB,cpuMemoryMB,overBudget";
+    for (const std::string &name : cpuNames)
+        out << ',' << CsvField("cpu:" + name);
+    for (const std::string &name : gpuNames)
+        out << ',' << CsvField("gpu:" + name);
+    out << '\n';
+
+    char buffer[64];
+    auto number = [&buffer](double v) -> const char *
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.3f", v);
+        return buffer;
+    };
+    for (const Step &s : m_steps)
+    {
+        out << s.unitsPerPrefab << ',' << s.units << ',' << number(s.frameMsMean) << ',' << number(s.frameMsP95) << ','
+            << number(s.gpuMsMean) << ',' << number(s.gpuMemoryMB) << ',' << number(s.cpuMemoryMB) << ','
+            << (s.frameMsMean > m_config.budgetMs ? 1 : 0);
+        for (const std::string &name : cpuNames)
+        {
+            auto it = s.cpuScopes.find(name);
+            out << ',' << number(it != s.cpuScopes.end() ? it->second : 0.0);
+        }
+        for (const std::string &name : gpuNames)
+        {
+            auto it = s.gpuPasses.find(name);
+            out << ',' << number(it != s.gpuPasses.end() ? it->second : 0.0);
+        }
+        out << '\n';
+    }
+    return out.good();
+}
+
+void SweepApp::LogScaling_Internal() const
+{
+    for (const Step &s : m_steps)
+    {
+        if (s.frameMsMean <= m_config.budgetMs)
+            continue;
+        ENGINE_LOG_INFO("[Sweep] Frame budget (%.1f ms) first exceeded at %u units", m_config.budgetMs, s.units);
+        break;
+    }
+
+    // Per scope: cost per unit at its first measurable step, then the first step past the ratio.
+    // Scopes below kMinMs are noise at that size and wait for a larger step.
+    constexpr float kMinMs = 0.05f;
+    struct Knee
+    {
+        std::string name;
+        uint32_t units = 0; // 0: scaled linearly (or better) throughout
+        float ratio = 0.0f; // growth of the per-unit cost at the last step
+    };
+    std::vector<Knee> knees;
+    std::map<std::string, bool> seen;
+    for (const Step &first : m_steps)
+        for (const auto &entry : first.cpuScopes)
+            seen[entry.first] = true;
+
+    for (const auto &entry : seen)
+    {
+        Knee knee{entry.first};
+        double basePerUnit = 0.0;
+        for (const Step &s : m_steps)
+        {
+            auto it = s.cpuScopes.find(entry.first);
+            if (it == s.cpuScopes.end() || s.units == 0)
+                continue;
+            const double perUnit = static_cast<double>(it->second) / static_cast<double>(s.units);
+            if (basePerUnit == 0.0)
+            {
+                if (it->second >= kMinMs)
+                    basePerUnit = perUnit;
+                continue;
+            }
+            knee.ratio = static_cast<float>(perUnit / basePerUnit);
+            if (knee.units == 0 && knee.ratio > kSuperlinearRatio)
+                knee.units = s.units;
+        }
+        if (basePerUnit > 0.0)
+            knees.push_back(knee);
+    }
+
+    // Superlinear scopes first, earliest knee first; then the rest by growth
+    std::sort(knees.begin(), knees.end(), [](const Knee &a, const Knee &b)
+              {
+        if ((a.units != 0) != (b.units != 0))
+            return a.units != 0;
+        if (a.units != b.units)
+            return a.units < b.units;
+        return a.ratio > b.ratio; });
+    for (const Knee &k : knees)
+    {
+        if (k.units != 0)
+            ENGINE_LOG_INFO("[Sweep] %s: per-unit cost past %.1fx from %u units (%.2fx at the last step)", k.name.c_str(),
+                            kSuperlinearRatio, k.units, k.ratio);
+        else
+            ENGINE_LOG_INFO("[Sweep] %s: linear (%.2fx per-unit cost at the last step)", k.name.c_str(), k.ratio);
+    }
+}
+
+void SweepApp::OnUpdate(Engine::TimeStep ts)
+{
+    const uint64_t nowNs = Engine::Profiler::now();
+    const float frameMs = m_lastFrameNs ? static_cast<float>(nowNs - m_lastFrameNs) * 1e-6f : 0.0f;
+    m_lastFrameNs = nowNs;
+
+    switch (m_phase)
+    {
+    case Phase::Spawning:
+        if (ScenarioSpawned())
+        {
+            m_units += ScenarioSpawnedUnits();
+            ENGINE_LOG_INFO("[Sweep] %u units (%u per prefab); warming up", m_units, m_unitsPerPrefab);
+            m_phase = Phase::Warmup;
+            m_phaseFrames = 0;
+        }
+        break;
+    case Phase::Warmup:
+        if (++m_phaseFrames >= m_config.warmupFrames)
+        {
+            m_phase = Phase::Measuring;
+            m_phaseFrames = 0;
+        }
+        break;
+    case Phase::Measuring:
+        Sample_Internal(frameMs);
+        if (++m_phaseFrames >= m_config.frames)
+            FinishStep_Internal();
+        break;
+    case Phase::Done:
+        break;
+    }
+
+    m_moveTimer += ts.DeltaSeconds;
+    if (m_moveTimer >= kMoveIntervalSeconds)
+    {
+        m_moveTimer = 0.0f;
+        IssueRandomMove_Internal();
+    }
+
+    MySampleApp::OnUpdate(ts);
+}
@@ -0,0 +1,41 @@
+#include "BenchApp.h"
+#include "SweepApp.h"
+#include "utils/Log.h"
+
+#include <cstring>
+
+namespace
+{
+    template <typename App>
+    int RunApp(const typename App::Config &config)
+    {
+        try
+        {
+            App app(config);
+            app.Run();
+            return app.Succeeded() ? 0 : 1;
+        }
+        catch (const std::exception &e)
+        {
+            ENGINE_LOG_ERROR("Unhandled exception: %s", e.what());
+            Engine::Log::flush();
+            return 1;
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--sweep") == 0)
+    {
+        SweepApp::Config config;
+        if (!SweepApp::ParseArgs(argc, argv, config))
+            return 2;
+        return RunApp<SweepApp>(config);
+    }
+
+    BenchApp::Config config;
+    if (!BenchApp::ParseArgs(argc, argv, config))
+        return 2;
+    return RunApp<BenchApp>(config);
+}
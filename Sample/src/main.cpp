@@ -1,18 +1,80 @@
-#include <iostream>
-
 #include "MySampleApp.h"
+#include "utils/Log.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-int main()
+namespace
 {
+    void PrintUsage()
+    {
+        std::fprintf(stderr, "Usage: SampleApp [--trace [frames]] [--trace-out trace.json]\n"
+                             "                 [--hitches [dir]] [--hitch-threshold X]\n"
+                             "                 [--record input.json | --replay input.json]\n");
+    }
+
+    bool ParseArgs(int argc, char **argv, MySampleApp::Options &out)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char *arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(arg, "--trace") == 0)
+            {
+                // Frame count is optional
+                out.traceFrames = MySampleApp::kHotkeyTraceFrames;
+                if (hasValue && argv[i + 1][0] != '-')
+                    out.traceFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(arg, "--trace-out") == 0 && hasValue)
+                out.tracePath = argv[++i];
+            else if (std::strcmp(arg, "--hitches") == 0)
+            {
+                // Directory is optional
+                out.detectHitches = true;
+                if (hasValue && argv[i + 1][0] != '-')
+                    out.hitches.directory = argv[++i];
+            }
+            else if (std::strcmp(arg, "--hitch-threshold") == 0 && hasValue)
+            {
+                out.detectHitches = true;
+                out.hitches.threshold = std::strtof(argv[++i], nullptr);
+            }
+            else if (std::strcmp(arg, "--record") == 0 && hasValue)
+                out.recordPath = argv[++i];
+            else if (std::strcmp(arg, "--replay") == 0 && hasValue)
+                out.replayPath = argv[++i];
+            else
+            {
+                PrintUsage();
+                return false;
+            }
+        }
+
+        // Replays must tick the simulation exactly as recorded: inline, once per frame with its dt
+        if (!out.recordPath.empty() || !out.replayPath.empty())
+            out.simulationHz = 0.0f;
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    MySampleApp::Options options;
+    if (!ParseArgs(argc, argv, options))
+        return 2;
+
     try
     {
-        MySampleApp app;
+        MySampleApp app(options);
         app.Run();
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Unhandled exception: " << e.what() << std::endl;
+        ENGINE_LOG_ERROR("Unhandled exception: %s", e.what());
+        Engine::Log::flush();
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
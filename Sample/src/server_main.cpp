@@ -0,0 +1,151 @@
+#include "ServerApp.h"
+#include "assets/HeadlessAssets.h"
+#include "utils/Log.h"
+#include "utils/VirtualFileSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct ServerOptions
+    {
+        uint32_t matches = 4;
+        float tickHz = 30.0f;
+        float seconds = 0.0f; // 0 = until interrupted
+        uint32_t workers = 0; // per match
+        std::string scenarioPath = "Scinerio.json";
+        uint32_t seed = 1;
+    };
+
+    constexpr float kStatsIntervalSeconds = 10.0f;
+
+    std::atomic<bool> g_interrupted{false};
+
+    void OnSignal(int)
+    {
+        g_interrupted.store(true);
+    }
+
+    void PrintUsage()
+    {
+        std::fprintf(stderr, "Usage: StratosphereServer [--matches N] [--tick-hz HZ] [--seconds S] [--workers N]\n"
+                             "                          [--scenario path.json] [--seed N]\n");
+    }
+
+    bool ParseArgs(int argc, char **argv, ServerOptions &out)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char *arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(arg, "--matches") == 0 && hasValue)
+                out.matches = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (std::strcmp(arg, "--tick-hz") == 0 && hasValue)
+                out.tickHz = std::strtof(argv[++i], nullptr);
+            else if (std::strcmp(arg, "--seconds") == 0 && hasValue)
+                out.seconds = std::strtof(argv[++i], nullptr);
+            else if (std::strcmp(arg, "--workers") == 0 && hasValue)
+                out.workers = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else if (std::strcmp(arg, "--scenario") == 0 && hasValue)
+                out.scenarioPath = argv[++i];
+            else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+                out.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            else
+            {
+                PrintUsage();
+                return false;
+            }
+        }
+
+        if (out.matches == 0 || out.tickHz < 0.0f || out.seconds < 0.0f)
+        {
+            PrintUsage();
+            return false;
+        }
+        return true;
+    }
+
+    void LogStats(const std::vector<std::unique_ptr<Sample::ServerMatch>> &matches)
+    {
+        for (const auto &match : matches)
+            ENGINE_LOG_INFO("[Server] %s: tick %llu, %u units, %.2f ms/tick, %llu late", match->GetConfig().name.c_str(),
+                            static_cast<unsigned long long>(match->GetTick()), match->GetUnitCount(), match->GetMeanTickMs(),
+                            static_cast<unsigned long long>(match->lateTicks()));
+        ENGINE_LOG_INFO("[Server] %u shared models", Engine::HeadlessAssets::sharedModelCount());
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    ServerOptions options;
+    if (!ParseArgs(argc, argv, options))
+        return 2;
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    try
+    {
+        if (Engine::VirtualFileSystem::exists("assets.spak"))
+            Engine::VirtualFileSystem::mountPack("assets.spak");
+
+        Sample::ServerData data;
+        if (!data.load(options.scenarioPath))
+        {
+            Engine::Log::flush();
+            return 1;
+        }
+
+        std::vector<std::unique_ptr<Sample::ServerMatch>> matches;
+        for (uint32_t i = 0; i < options.matches; ++i)
+        {
+            Sample::ServerMatch::Config config;
+            config.app.name = "match " + std::to_string(i);
+            config.app.tickHz = options.tickHz;
+            config.app.workerThreads = options.workers;
+            config.seed = options.seed + i;
+            matches.push_back(std::make_unique<Sample::ServerMatch>(config, data));
+        }
+        for (auto &match : matches)
+            match->Start();
+
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        auto nextStats = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(kStatsIntervalSeconds));
+        while (!g_interrupted.load())
+        {
+            const auto now = Clock::now();
+            if (options.seconds > 0.0f && std::chrono::duration<float>(now - start).count() >= options.seconds)
+                break;
+            if (now >= nextStats)
+            {
+                LogStats(matches);
+                nextStats += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(kStatsIntervalSeconds));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        for (auto &match : matches)
+            match->Close();
+        for (auto &match : matches)
+            match->Join();
+        LogStats(matches);
+    }
+    catch (const std::exception &e)
+    {
+        ENGINE_LOG_ERROR("Unhandled exception: %s", e.what());
+        Engine::Log::flush();
+        return 1;
+    }
+    Engine::Log::flush();
+    return 0;
+}
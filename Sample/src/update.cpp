@@ -1,7 +1,28 @@
 #include "update.h"
 
+#include "Engine/CrowdComputeModule.h"
+#include "Engine/Renderer.h"
+#include "utils/Profiler.h"
+
+#include <algorithm>
+
 namespace Sample
 {
+    namespace
+    {
+        uint64_t entityKey(const Engine::ECS::Entity &e)
+        {
+            return (static_cast<uint64_t>(e.generation) << 32) | e.index;
+        }
+    }
+
+    SystemRunner::~SystemRunner()
+    {
+        Shutdown();
+        if (m_renderer)
+            m_renderer->setJobSystem(nullptr);
+    }
+
     void SystemRunner::Initialize(Engine::ECS::ComponentRegistry &registry)
     {
         if (m_initialized)
@@ -11,46 +32,261 @@ namespace Sample
         (void)registry.ensureId("Selected");
 
         m_command.buildMasks(registry);
+        m_flowFields.buildMasks(registry);
         m_steering.buildMasks(registry);
         m_spatial.buildMasks(registry);
         m_avoidance.buildMasks(registry);
         m_movement.buildMasks(registry);
+        m_gpuCrowd.buildMasks(registry);
         m_characterAnim.buildMasks(registry);
         m_renderModel.buildMasks(registry);
+        m_lod.buildIds(registry);
+
+        // Systems with independent rows split their loops across the same worker pool.
+        m_steering.setJobSystem(&m_jobs);
+        m_movement.setJobSystem(&m_jobs);
+        m_avoidance.setJobSystem(&m_jobs);
+        m_flowFields.setJobSystem(&m_jobs);
+        m_renderModel.setJobSystem(&m_jobs); // pose evaluation (inline mode)
+
+        // Off-screen / far units are steered, avoided and animated at a reduced, round-robin rate.
+        m_steering.setSimulationLod(&m_lod);
+        m_avoidance.setSimulationLod(&m_lod);
+        m_characterAnim.setSimulationLod(&m_lod);
+
+        // Group orders share one flow field (cells match the spatial grid).
+        m_flowFields.setCellSize(m_spatial.getCellSize());
+        m_gpuCrowd.setCellSize(m_spatial.getCellSize());
+        m_command.setFlowFields(&m_flowFields);
+        m_steering.setFlowFields(&m_flowFields);
 
         // Neighbor radius (meters). Tune later; matches SpatialIndexSystem doc.
         m_spatial.setCellSize(m_spatial.getCellSize());
+        // Most units idle between orders: keep the grid and only move units that changed cell
+        // (Tick() updates it; picking and target queries read it between ticks).
+        m_spatial.setIncremental(true);
+
+        // Every couple of seconds, sort store rows by grid cell so neighbors are adjacent in memory.
+        m_reorder.setCellSize(m_spatial.getCellSize());
+        m_reorder.setInterval(120);
+
+        BuildSchedule();
 
         m_initialized = true;
     }
 
+    void SystemRunner::BuildSchedule()
+    {
+        // Suggested order per LocalAvoidanceSystem.h; conflicting systems keep this order.
+        m_scheduler.clear();
+        m_scheduler.add(&m_command);
+        m_scheduler.add(&m_flowFields);
+        m_scheduler.add(&m_steering);
+        if (m_gpuCrowd.module())
+        {
+            // Grid, avoidance and integration all run in CrowdComputeModule.
+            m_scheduler.add(&m_gpuCrowd);
+        }
+        else
+        {
+            // Avoidance reads the grid Tick() built at the end of the previous tick. Positions only
+            // change in MovementSystem, after it, so the grid is still current here.
+            m_scheduler.add(&m_avoidance);
+            m_scheduler.add(&m_movement);
+        }
+        m_scheduler.add(&m_characterAnim);
+        // RenderSystem is not scheduled: it submits on the calling (render) thread after the tick.
+        // Nor is SpatialIndexSystem: Tick() updates it at the closing sync point, after command
+        // playback, so its (store, row) pairs stay valid for queries until the next tick.
+        m_scheduler.build();
+    }
+
     void SystemRunner::Update(Engine::ECS::ECSContext &ecs, float dtSeconds)
     {
         if (!m_initialized)
             Initialize(ecs.components);
 
-        if (dtSeconds <= 0.0f)
+        if (!IsThreaded())
+        {
+            if (dtSeconds <= 0.0f)
+                return;
+            Tick(ecs, dtSeconds);
+            if (Engine::CrowdComputeModule *crowd = m_gpuCrowd.module())
+            {
+                m_renderModel.gather(ecs.stores, m_renderScratch);
+                AssignGpuSlots(m_renderScratch);
+                crowd->prepareFrame();
+                crowd->setInterpolation(1.0f);
+                m_renderModel.submit(m_renderScratch, 1.0f, m_gpuCrowd.layoutSerial());
+            }
+            else
+            {
+                m_renderModel.update(ecs.stores, dtSeconds);
+            }
+            return;
+        }
+
+        if (!m_simThread.joinable())
+        {
+            m_renderJobs = std::make_unique<Engine::JobSystem>(std::max(1u, m_jobs.workerCount() / 2));
+            m_renderModel.setJobSystem(m_renderJobs.get());
+            if (m_renderer)
+                m_renderer->setJobSystem(m_renderJobs.get());
+
+            m_simRunning.store(true, std::memory_order_release);
+            m_simThread = std::thread(&SystemRunner::SimulationLoop, this, &ecs);
+        }
+
+        // Draw the latest tick, blended from the one before by how far we are into the next step.
+        // The copy keeps the published buffer intact for frames rendered before the next tick lands.
+        Clock::time_point publishedAt;
+        uint64_t layout = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_publishMutex);
+            m_renderScratch = m_published;
+            publishedAt = m_publishedAt;
+            layout = m_publishedLayout;
+        }
+        float alpha = 1.0f;
+        if (publishedAt != Clock::time_point{})
+            alpha = std::chrono::duration<float>(Clock::now() - publishedAt).count() * m_tickHz;
+        if (Engine::CrowdComputeModule *crowd = m_gpuCrowd.module())
+        {
+            crowd->prepareFrame();
+            crowd->setInterpolation(alpha);
+        }
+        m_renderModel.submit(m_renderScratch, alpha, layout);
+    }
+
+    void SystemRunner::SetSimulationRate(float hz)
+    {
+        if (m_simThread.joinable())
             return;
+        m_tickHz = (hz > 0.0f) ? hz : 0.0f;
+    }
+
+    void SystemRunner::Shutdown()
+    {
+        m_simRunning.store(false, std::memory_order_release);
+        if (m_simThread.joinable())
+            m_simThread.join();
+        if (m_renderJobs)
+        {
+            m_renderModel.setJobSystem(&m_jobs);
+            if (m_renderer)
+                m_renderer->setJobSystem(&m_jobs);
+            m_renderJobs.reset();
+        }
+    }
+
+    void SystemRunner::SimulationLoop(Engine::ECS::ECSContext *ecs)
+    {
+        const float dt = 1.0f / m_tickHz;
+        const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_tickHz));
+        auto next = Clock::now();
+
+        while (m_simRunning.load(std::memory_order_acquire))
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_worldMutex);
+                Tick(*ecs, dt);
+                PublishRenderState(*ecs);
+            }
 
-        // Suggested order per LocalAvoidanceSystem.h
-        m_command.update(ecs.stores, dtSeconds);
-        m_steering.update(ecs.stores, dtSeconds);
-        // m_spatial.update(ecs.stores, dtSeconds);    // Disabled: SpatialIndexSystem
-        // m_avoidance.update(ecs.stores, dtSeconds);  // Disabled: LocalAvoidanceSystem
-        m_movement.update(ecs.stores, dtSeconds);
-        m_characterAnim.update(ecs.stores, dtSeconds);
-        m_renderModel.update(ecs.stores, dtSeconds);
+            // Fixed schedule; if we fall several ticks behind (heavy frame, debugger), drop them
+            // instead of trying to catch up in a burst.
+            next += step;
+            const auto now = Clock::now();
+            if (now - next > 4 * step)
+                next = now;
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    void SystemRunner::PublishRenderState(Engine::ECS::ECSContext &ecs)
+    {
+        m_renderModel.gather(ecs.stores, m_simCurr);
+        AssignGpuSlots(m_simCurr);
+
+        // Previous-tick state by entity (rows move between ticks); new entities start at rest.
+        for (RenderInstance &inst : m_simCurr)
+        {
+            const auto it = m_prevSlot.find(entityKey(inst.entity));
+            if (it == m_prevSlot.end())
+                continue;
+            const RenderInstance &prev = m_simPrev[it->second];
+            inst.prevPosition = prev.position;
+            inst.prevYaw = prev.yaw;
+            if (prev.clipIndex == inst.clipIndex)
+                inst.prevTimeSec = prev.timeSec;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_publishMutex);
+            m_published = m_simCurr;
+            m_publishedAt = Clock::now();
+            m_publishedLayout = m_gpuCrowd.module() ? m_gpuCrowd.layoutSerial() : 0;
+        }
+
+        m_simPrev.swap(m_simCurr);
+        m_prevSlot.clear();
+        for (uint32_t i = 0; i < m_simPrev.size(); ++i)
+            m_prevSlot[entityKey(m_simPrev[i].entity)] = i;
+    }
+
+    void SystemRunner::Tick(Engine::ECS::ECSContext &ecs, float dtSeconds)
+    {
+        ENGINE_PROFILE_SCOPE("SystemRunner::Tick");
+
+        // Sync point: apply structural changes recorded since the last tick (input, spawns).
+        ecs.commands.reserveThreads(m_jobs.threadCount());
+        ecs.PlaybackCommands();
+
+        // Last tick's scratch containers are gone: recycle their memory.
+        m_simArena.resize(m_jobs.threadCount());
+        m_simArena.beginFrame();
+
+        m_scheduler.forEachSystem([&](Engine::ECS::SystemBase &system)
+                                  {
+                                      system.setCommandBuffer(&ecs.commands);
+                                      system.setFrameArena(&m_simArena);
+                                  });
+
+        // Still at the sync point: pick the rows LOD systems process this tick.
+        {
+            std::lock_guard<std::mutex> lock(m_viewMutex);
+            m_lod.setFocus(m_viewFocusX, m_viewFocusZ);
+            m_lod.setViewFootprint(m_viewFootprint, m_viewFootprintCount);
+        }
+        m_lod.update(ecs.stores, ecs.stores.currentTick() + 1, &m_jobs);
+
+        m_scheduler.run(ecs.stores, dtSeconds, &m_jobs);
+
+        // Sync point: apply what systems recorded this tick.
+        ecs.PlaybackCommands();
+
+        // Still at the sync point: periodic row reordering (structural, so never during run()).
+        m_reorder.tick(ecs.stores, ecs.entities);
+
+        // Bring the grid up to date with this frame's moves/spawns so queries between frames
+        // (cursor picking) see valid (store, row) pairs. Incremental: only changed chunks are scanned.
+        m_spatial.update(ecs.stores, dtSeconds);
+        m_spatial.setLastRunTick(ecs.stores.currentTick()); // unscheduled: its next run skips chunks unchanged since
     }
 
     void SystemRunner::SetAssetManager(Engine::AssetManager *assets)
     {
-        m_characterAnim.setAssetManager(assets);
+        m_characterAnim.setModelProvider(assets);
         m_renderModel.setAssetManager(assets);
     }
 
     void SystemRunner::SetRenderer(Engine::Renderer *renderer)
     {
+        m_renderer = renderer;
         m_renderModel.setRenderer(renderer);
+        // Passes record in parallel on the pool the render thread waits on.
+        if (m_renderer)
+            m_renderer->setJobSystem(m_renderJobs ? m_renderJobs.get() : &m_jobs);
     }
 
     void SystemRunner::SetCamera(Engine::Camera *camera)
@@ -58,6 +294,33 @@ namespace Sample
         m_renderModel.setCamera(camera);
     }
 
+    void SystemRunner::SetSimulationView(float focusX, float focusZ, const float *footprintXZ, uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_viewMutex);
+        m_viewFocusX = focusX;
+        m_viewFocusZ = focusZ;
+        m_viewFootprintCount = std::min(count, Engine::ECS::SimulationLod::kMaxFootprint);
+        std::copy(footprintXZ, footprintXZ + 2 * m_viewFootprintCount, m_viewFootprint);
+    }
+
+    void SystemRunner::SetGpuCrowd(Engine::CrowdComputeModule *module)
+    {
+        if (m_simThread.joinable())
+            return;
+        m_gpuCrowd.setModule(module);
+        m_renderModel.setGpuCrowd(module);
+        if (m_initialized)
+            BuildSchedule();
+    }
+
+    void SystemRunner::AssignGpuSlots(std::vector<RenderInstance> &instances) const
+    {
+        if (!m_gpuCrowd.module())
+            return;
+        for (RenderInstance &inst : instances)
+            inst.gpuSlot = m_gpuCrowd.instanceSlot(inst.entity);
+    }
+
     void SystemRunner::SetGlobalMoveTarget(float x, float y, float z)
     {
         m_command.SetGlobalMoveTarget(x, y, z);
@@ -1,7 +1,8 @@
 #pragma once
 
 #include "ECS/SystemFormat.h"
-#include "assets/AssetManager.h"
+#include "assets/ModelAsset.h"
+#include "assets/ModelProvider.h"
 
 #include <algorithm>
 #include <cmath>
@@ -28,11 +29,14 @@ public:
     {
         setRequiredNames({"RenderModel", "RenderAnimation"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderModel", "Velocity", "MoveTarget", "Selected"});
+        setWriteNames({"RenderAnimation"});
     }
 
     const char *name() const override { return "CharacterAnimationSystem"; }
 
-    void setAssetManager(Engine::AssetManager *assets) { m_assets = assets; }
+    // AssetManager on the client, HeadlessAssets on a server
+    void setModelProvider(const Engine::IModelProvider *models) { m_models = models; }
 
     void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
@@ -42,44 +46,35 @@ public:
 
     void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
     {
-        if (!m_assets)
+        if (!m_models)
             return;
 
         // Velocity threshold to consider entity as "moving"
         constexpr float kVelocityThreshold = 0.1f;
         constexpr float kVelocityThreshold2 = kVelocityThreshold * kVelocityThreshold;
 
-        for (const auto &ptr : mgr.stores())
+        for (uint32_t storeId : matchingStores(mgr))
         {
-            if (!ptr)
-                continue;
-
-            auto &store = *ptr;
-            if (!store.signature().containsAll(required()))
-                continue;
-            if (!store.signature().containsNone(excluded()))
-                continue;
+            auto &store = *mgr.get(storeId);
             if (!store.hasRenderModel() || !store.hasRenderAnimation())
                 continue;
 
-            auto &renderModels = store.renderModels();
-            auto &renderAnimations = store.renderAnimations();
-            const auto &masks = store.rowMasks();
+            auto renderModels = store.renderModels();
+            auto renderAnimations = store.renderAnimations();
+            const auto rows = store.rowFilter(lodRequired(required()), excluded());
             const uint32_t n = store.size();
 
             // Check if this store has velocity and move target for movement detection
             const bool hasVelocity = store.hasVelocity();
             const bool hasMoveTarget = store.hasMoveTarget();
-            const auto *velocities = hasVelocity ? &store.velocities() : nullptr;
-            const auto *targets = hasMoveTarget ? &store.moveTargets() : nullptr;
+            const auto velocities = store.velocities();
+            const auto targets = store.moveTargets();
 
-            for (uint32_t row = 0; row < n; ++row)
+            for (uint32_t row = rows.first(0u, n); row < n; row = rows.next(row, n))
             {
-                if (!masks[row].matches(required(), excluded()))
-                    continue;
 
                 const Engine::ModelHandle handle = renderModels[row].handle;
-                Engine::ModelAsset *asset = m_assets->getModel(handle);
+                const Engine::ModelAsset *asset = m_models->modelData(handle);
                 if (!asset)
                     continue;
 
@@ -97,9 +92,9 @@ public:
                 // (MoveTarget.active check removed - velocity is the ground truth)
                 bool isMoving = false;
 
-                if (velocities)
+                if (hasVelocity)
                 {
-                    const auto &vel = (*velocities)[row];
+                    const auto &vel = velocities[row];
                     const float speed2 = vel.x * vel.x + vel.y * vel.y + vel.z * vel.z;
                     isMoving = (speed2 > kVelocityThreshold2);
                 }
@@ -127,7 +122,7 @@ public:
                 if (!anim.playing || duration <= 1e-6f)
                     continue;
 
-                anim.timeSec += dt * anim.speed;
+                anim.timeSec += dt * lodScale(storeId, row) * anim.speed;
                 if (anim.loop)
                 {
                     anim.timeSec = std::fmod(anim.timeSec, duration);
@@ -146,6 +141,6 @@ public:
     }
 
 private:
-    Engine::AssetManager *m_assets = nullptr;
+    const Engine::IModelProvider *m_models = nullptr;
     uint32_t m_selectedId = Engine::ECS::ComponentRegistry::InvalidID;
 };
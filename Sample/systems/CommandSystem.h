@@ -1,8 +1,9 @@
 #pragma once
 #include "ECS/SystemFormat.h"
+#include "systems/FlowFieldSystem.h"
+#include "utils/Log.h"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
 #include <vector>
 
 class CommandSystem : public Engine::ECS::SystemBase
@@ -13,6 +14,8 @@ public:
         // Require MoveTarget + MoveSpeed so we only command movable units.
         setRequiredNames({"MoveTarget", "MoveSpeed"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Selected", "MoveSpeed"});
+        setWriteNames({"MoveTarget"});
     }
 
     const char *name() const override { return "CommandSystem"; }
@@ -21,8 +24,12 @@ public:
     {
         Engine::ECS::SystemBase::buildMasks(registry);
         m_selectedId = registry.ensureId("Selected");
+        m_movingId = registry.ensureId("Moving");
     }
 
+    // Optional: request one shared flow field per order (covering all assigned slots).
+    void setFlowFields(FlowFieldSystem *flow) { m_flow = flow; }
+
     // Set the last clicked target; system will write it to entities on next update.
     void SetGlobalMoveTarget(float x, float y, float z)
     {
@@ -47,28 +54,23 @@ public:
         auto clamp = [](float v, float a, float b)
         { return std::max(a, std::min(v, b)); };
 
-        for (const auto &ptr : mgr.stores())
+        // Footprint of every slot assigned by this order.
+        FlowGoal goal{kMaxWorld, kMaxWorld, kMinWorld, kMinWorld};
+
+        for (uint32_t storeId : matchingStores(mgr))
         {
-            if (!ptr)
-                continue;
-            auto &store = *ptr;
-            if (!store.signature().containsAll(required()))
-                continue;
-            if (!store.signature().containsNone(excluded()))
-                continue;
+            auto &store = *mgr.get(storeId);
 
-            auto &targets = const_cast<std::vector<Engine::ECS::MoveTarget> &>(store.moveTargets());
-            auto &masks = store.rowMasks();
+            auto targets = store.moveTargets();
+            const auto rows = store.rowFilter(required(), excluded());
             const uint32_t n = store.size();
 
-            // Collect selected rows first so we can distribute target offsets.
-            std::vector<uint32_t> selectedRows;
+            // Collect selected rows first so we can distribute target offsets (tick scratch memory).
+            Engine::ArenaVector<uint32_t> selectedRows{Engine::ArenaAllocator<uint32_t>(scratchArena())};
             selectedRows.reserve(n);
-            for (uint32_t i = 0; i < n; ++i)
+            for (uint32_t i = rows.first(0u, n); i < n; i = rows.next(i, n))
             {
-                if (!masks[i].matches(required(), excluded()))
-                    continue;
-                if (m_selectedId == Engine::ECS::ComponentRegistry::InvalidID || !masks[i].has(m_selectedId))
+                if (m_selectedId == Engine::ECS::ComponentRegistry::InvalidID || !store.hasTag(i, m_selectedId))
                     continue;
                 selectedRows.push_back(i);
             }
@@ -94,11 +96,30 @@ public:
                 targets[i].y = m_pendingY; // height
                 targets[i].z = clamp(m_pendingZ + oz, kMinWorld, kMaxWorld);
                 targets[i].active = 1;
+
+                goal.minX = std::min(goal.minX, targets[i].x);
+                goal.minZ = std::min(goal.minZ, targets[i].z);
+                goal.maxX = std::max(goal.maxX, targets[i].x);
+                goal.maxZ = std::max(goal.maxZ, targets[i].z);
             }
 
-            std::cout << "[CommandSystem] Selected=" << selCount
-                      << " baseTarget=(" << m_pendingX << "," << m_pendingZ << ")"
-                      << " gridSide=" << side << " spacing=" << spacing << "\n";
+            // Ordered units join the active set ("Moving" row tag) that Steering/Movement iterate.
+            if (Engine::ECS::CommandBuffer *cmds = commandBuffer())
+            {
+                std::vector<uint64_t> words((n + 63) / 64, 0ull);
+                for (uint32_t i : selectedRows)
+                    words[i >> 6] |= 1ull << (i & 63);
+                cmds->addTagRows(storeId, store.structureVersion(), m_movingId, std::move(words));
+            }
+
+            ENGINE_LOG_INFO("[CommandSystem] Selected=%u baseTarget=(%g,%g) gridSide=%u spacing=%g",
+                            selCount, m_pendingX, m_pendingZ, side, spacing);
+        }
+
+        if (m_flow && goal.minX <= goal.maxX)
+        {
+            const float pad = spacing * 0.5f;
+            m_flow->requestField(FlowGoal{goal.minX - pad, goal.minZ - pad, goal.maxX + pad, goal.maxZ + pad});
         }
 
         m_hasPending = false;
@@ -108,4 +129,6 @@ private:
     bool m_hasPending = false;
     float m_pendingX = 0.0f, m_pendingY = 0.0f, m_pendingZ = 0.0f;
     uint32_t m_selectedId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_movingId = Engine::ECS::ComponentRegistry::InvalidID;
+    FlowFieldSystem *m_flow = nullptr; // not owned
 };
\ No newline at end of file
@@ -0,0 +1,425 @@
+#pragma once
+/*
+  FlowFieldSystem.h
+  -----------------
+  Purpose:
+    - Shared pathing for group move orders. Each order gets one flow field over a ground-plane grid
+      around its goal area: an integration pass gives every cell its travel cost to the goal, then a
+      direction pass stores the downhill heading per cell. Units sample their cell in O(1) instead of
+      running one path query each, so an order costs the same for 10 or 10000 units.
+    - Cell cost is 1 on open ground plus a crowd penalty per idle unit standing in the cell, so groups
+      route around parked blobs instead of jamming into them (less work for LocalAvoidanceSystem).
+
+  Usage:
+    - CommandSystem calls requestField(goal) with the footprint of the formation it just assigned.
+    - Schedule after CommandSystem and before SteeringSystem. update() builds pending fields on the job
+      system: one job per field for the integration pass, then row bands for the direction pass.
+    - SteeringSystem: fieldFor(target.x, target.z) returns the newest field whose goal contains a unit's
+      target; field->direction(x, z, dirX, dirZ) gives the unit heading (false: steer straight).
+
+  Notes:
+    - Integration uses fast marching (Eikonal update on the 4-neighborhood) so costs approximate true
+      Euclidean distance, and headings are the normalized cost gradient, not 8-way snapped.
+    - Fields are cached per destination: an order to the same goal cells reuses the field when its window
+      already covers the ordered units, otherwise it is rebuilt. At most kMaxFields are kept; the least
+      recently requested is evicted.
+    - The window spans the goal and the ordered units, padded by kWindowPadding cells and capped at
+      kMaxWindowCells per axis around the goal; units outside it steer straight until they enter.
+    - There is no static obstacle data yet; the crowd penalty is the only non-uniform cost.
+*/
+
+#include "ECS/SystemFormat.h"
+#include "ECS/Components.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Ground-plane rectangle in meters (X/Z).
+struct FlowGoal
+{
+    float minX = 0.0f, minZ = 0.0f;
+    float maxX = 0.0f, maxZ = 0.0f;
+
+    bool contains(float x, float z) const { return x >= minX && x <= maxX && z >= minZ && z <= maxZ; }
+};
+
+class FlowField
+{
+public:
+    const FlowGoal &goal() const { return m_goal; }
+    uint32_t width() const { return m_width; }
+    uint32_t height() const { return m_height; }
+
+    // Unit heading at (x, z). False outside the window, inside the goal cells, or where no path exists.
+    bool direction(float x, float z, float &dirX, float &dirZ) const
+    {
+        const int32_t cx = static_cast<int32_t>(std::floor(x * m_invCell)) - m_gx0;
+        const int32_t cz = static_cast<int32_t>(std::floor(z * m_invCell)) - m_gz0;
+        if (cx < 0 || cz < 0 || cx >= static_cast<int32_t>(m_width) || cz >= static_cast<int32_t>(m_height))
+            return false;
+        const size_t c = static_cast<size_t>(cz) * m_width + static_cast<size_t>(cx);
+        dirX = m_dir[2 * c + 0];
+        dirZ = m_dir[2 * c + 1];
+        return dirX != 0.0f || dirZ != 0.0f;
+    }
+
+    // Travel cost from (x, z) to the goal (infinity outside the window or when unreachable).
+    float costAt(float x, float z) const
+    {
+        const int32_t cx = static_cast<int32_t>(std::floor(x * m_invCell)) - m_gx0;
+        const int32_t cz = static_cast<int32_t>(std::floor(z * m_invCell)) - m_gz0;
+        if (cx < 0 || cz < 0 || cx >= static_cast<int32_t>(m_width) || cz >= static_cast<int32_t>(m_height))
+            return std::numeric_limits<float>::infinity();
+        return m_integration[static_cast<size_t>(cz) * m_width + static_cast<size_t>(cx)];
+    }
+
+private:
+    friend class FlowFieldSystem;
+
+    static constexpr float kInf = std::numeric_limits<float>::infinity();
+
+    bool coversCells(int32_t gx0, int32_t gz0, int32_t gx1, int32_t gz1) const
+    {
+        return gx0 >= m_gx0 && gz0 >= m_gz0 &&
+               gx1 < m_gx0 + static_cast<int32_t>(m_width) && gz1 < m_gz0 + static_cast<int32_t>(m_height);
+    }
+
+    // Fast marching from the goal cells outward; m_integration[c] = cost to reach the goal.
+    void integrate()
+    {
+        const uint32_t w = m_width, h = m_height;
+        const size_t cells = static_cast<size_t>(w) * h;
+        m_integration.assign(cells, kInf);
+        std::vector<uint8_t> known(cells, 0);
+
+        using Item = std::pair<float, uint32_t>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+
+        for (uint32_t cz = 0; cz < h; ++cz)
+            for (uint32_t cx = 0; cx < w; ++cx)
+            {
+                const uint32_t c = cz * w + cx;
+                if (m_isGoal[c])
+                {
+                    m_integration[c] = 0.0f;
+                    open.push({0.0f, c});
+                }
+            }
+
+        auto knownCost = [&](int32_t x, int32_t z) -> float
+        {
+            if (x < 0 || z < 0 || x >= static_cast<int32_t>(w) || z >= static_cast<int32_t>(h))
+                return kInf;
+            const uint32_t c = static_cast<uint32_t>(z) * w + static_cast<uint32_t>(x);
+            return known[c] ? m_integration[c] : kInf;
+        };
+
+        while (!open.empty())
+        {
+            const Item top = open.top();
+            open.pop();
+            const uint32_t c = top.second;
+            if (known[c])
+                continue;
+            known[c] = 1;
+
+            const int32_t x = static_cast<int32_t>(c % w);
+            const int32_t z = static_cast<int32_t>(c / w);
+            const int32_t nx[4] = {x - 1, x + 1, x, x};
+            const int32_t nz[4] = {z, z, z - 1, z + 1};
+            for (int k = 0; k < 4; ++k)
+            {
+                if (nx[k] < 0 || nz[k] < 0 || nx[k] >= static_cast<int32_t>(w) || nz[k] >= static_cast<int32_t>(h))
+                    continue;
+                const uint32_t n = static_cast<uint32_t>(nz[k]) * w + static_cast<uint32_t>(nx[k]);
+                if (known[n])
+                    continue;
+
+                // Eikonal update |grad T| = cost from the best known neighbor on each axis.
+                const float f = m_cellCost[n];
+                const float a = std::min(knownCost(nx[k] - 1, nz[k]), knownCost(nx[k] + 1, nz[k]));
+                const float b = std::min(knownCost(nx[k], nz[k] - 1), knownCost(nx[k], nz[k] + 1));
+                float t;
+                if (std::abs(a - b) < f)
+                    t = 0.5f * (a + b + std::sqrt(2.0f * f * f - (a - b) * (a - b)));
+                else
+                    t = std::min(a, b) + f;
+
+                if (t < m_integration[n])
+                {
+                    m_integration[n] = t;
+                    open.push({t, n});
+                }
+            }
+        }
+    }
+
+    // Headings for rows [z0, z1): normalized negative cost gradient (central differences where both
+    // sides are reachable, one-sided otherwise). Goal and unreachable cells get (0, 0).
+    void buildDirections(uint32_t z0, uint32_t z1)
+    {
+        const uint32_t w = m_width, h = m_height;
+        auto cost = [&](int32_t x, int32_t z) -> float
+        {
+            if (x < 0 || z < 0 || x >= static_cast<int32_t>(w) || z >= static_cast<int32_t>(h))
+                return kInf;
+            return m_integration[static_cast<uint32_t>(z) * w + static_cast<uint32_t>(x)];
+        };
+        auto slope = [](float lo, float self, float hi) -> float
+        {
+            const bool hasLo = lo < kInf, hasHi = hi < kInf;
+            if (hasLo && hasHi)
+                return 0.5f * (hi - lo);
+            if (hasHi)
+                return hi - self;
+            if (hasLo)
+                return self - lo;
+            return 0.0f;
+        };
+
+        for (uint32_t cz = z0; cz < z1; ++cz)
+            for (uint32_t cx = 0; cx < w; ++cx)
+            {
+                const uint32_t c = cz * w + cx;
+                float gx = 0.0f, gz = 0.0f;
+                const float self = m_integration[c];
+                if (!m_isGoal[c] && self < kInf)
+                {
+                    const int32_t x = static_cast<int32_t>(cx), z = static_cast<int32_t>(cz);
+                    gx = -slope(cost(x - 1, z), self, cost(x + 1, z));
+                    gz = -slope(cost(x, z - 1), self, cost(x, z + 1));
+                    const float len2 = gx * gx + gz * gz;
+                    if (len2 > 1e-12f)
+                    {
+                        const float inv = 1.0f / std::sqrt(len2);
+                        gx *= inv;
+                        gz *= inv;
+                    }
+                    else
+                    {
+                        gx = gz = 0.0f;
+                    }
+                }
+                m_dir[2 * static_cast<size_t>(c) + 0] = gx;
+                m_dir[2 * static_cast<size_t>(c) + 1] = gz;
+            }
+    }
+
+    FlowGoal m_goal;
+    int32_t m_goalGx0 = 0, m_goalGz0 = 0, m_goalGx1 = 0, m_goalGz1 = 0; // goal in cells (cache key)
+    int32_t m_gx0 = 0, m_gz0 = 0;                                      // window origin in cells
+    uint32_t m_width = 0, m_height = 0;
+    float m_invCell = 0.5f;
+
+    std::vector<float> m_cellCost;    // per cell, >= 1
+    std::vector<uint8_t> m_isGoal;    // per cell
+    std::vector<float> m_integration; // per cell, cost to goal
+    std::vector<float> m_dir;         // per cell (x, z) heading
+};
+
+class FlowFieldSystem : public Engine::ECS::SystemBase
+{
+public:
+    static constexpr uint32_t kMaxFields = 8;
+    static constexpr int32_t kWindowPadding = 16;   // cells around goal + units
+    static constexpr int32_t kMaxWindowCells = 256; // per axis
+    static constexpr float kCrowdCost = 0.25f;      // extra cost per idle unit in a cell
+    static constexpr float kMaxCellCost = 4.0f;
+
+    FlowFieldSystem()
+    {
+        setRequiredNames({"Position"});
+        setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "MoveTarget"});
+    }
+
+    const char *name() const override { return "FlowFieldSystem"; }
+
+    void setCellSize(float cellSize) { m_cellSize = (cellSize > 1e-3f) ? cellSize : 1e-3f; }
+    float getCellSize() const { return m_cellSize; }
+
+    // Queue a field toward 'goal'; built by the next update().
+    void requestField(const FlowGoal &goal) { m_pending.push_back(goal); }
+
+    // Newest field whose goal contains (x, z), or null.
+    const FlowField *fieldFor(float x, float z) const
+    {
+        for (auto it = m_fields.rbegin(); it != m_fields.rend(); ++it)
+            if ((*it)->m_goal.contains(x, z))
+                return it->get();
+        return nullptr;
+    }
+
+    uint32_t fieldCount() const { return static_cast<uint32_t>(m_fields.size()); }
+
+    void update(Engine::ECS::ArchetypeStoreManager &mgr, float /*dt*/) override
+    {
+        if (m_pending.empty())
+            return;
+
+        // Only the newest kMaxFields orders can survive eviction anyway.
+        if (m_pending.size() > kMaxFields)
+            m_pending.erase(m_pending.begin(), m_pending.end() - kMaxFields);
+
+        const float invCell = 1.0f / m_cellSize;
+        auto cellOf = [invCell](float v)
+        { return static_cast<int32_t>(std::floor(v * invCell)); };
+
+        // Collect the fields to (re)build; reused ones just move to the back (most recent).
+        Engine::ArenaVector<FlowField *> builds{Engine::ArenaAllocator<FlowField *>(scratchArena())};
+        for (const FlowGoal &goal : m_pending)
+        {
+            const int32_t ggx0 = cellOf(goal.minX), ggz0 = cellOf(goal.minZ);
+            const int32_t ggx1 = cellOf(goal.maxX), ggz1 = cellOf(goal.maxZ);
+
+            // Extent of the units ordered into this goal.
+            int32_t ux0 = ggx0, uz0 = ggz0, ux1 = ggx1, uz1 = ggz1;
+            for (uint32_t storeId : matchingStores(mgr))
+            {
+                auto &store = *mgr.get(storeId);
+                if (!store.hasMoveTarget())
+                    continue;
+                const auto positions = store.positions();
+                const auto targets = store.moveTargets();
+                const auto rows = store.rowFilter(required(), excluded());
+                const uint32_t n = store.size();
+                for (uint32_t i = rows.first(0u, n); i < n; i = rows.next(i, n))
+                {
+                    const Engine::ECS::MoveTarget tgt = targets[i];
+                    if (!tgt.active || !goal.contains(tgt.x, tgt.z))
+                        continue;
+                    const Engine::ECS::Position p = positions[i];
+                    const int32_t cx = cellOf(p.x), cz = cellOf(p.z);
+                    ux0 = std::min(ux0, cx);
+                    uz0 = std::min(uz0, cz);
+                    ux1 = std::max(ux1, cx);
+                    uz1 = std::max(uz1, cz);
+                }
+            }
+
+            // Window: goal + units + padding, capped around the goal center.
+            const int32_t centerX = (ggx0 + ggx1) / 2, centerZ = (ggz0 + ggz1) / 2;
+            auto capAxis = [](int32_t lo, int32_t hi, int32_t center, int32_t &outLo, int32_t &outHi)
+            {
+                lo = std::max(lo - kWindowPadding, center - kMaxWindowCells / 2);
+                hi = std::min(hi + kWindowPadding, lo + kMaxWindowCells - 1);
+                outLo = lo;
+                outHi = hi;
+            };
+            int32_t wx0, wx1, wz0, wz1;
+            capAxis(ux0, ux1, centerX, wx0, wx1);
+            capAxis(uz0, uz1, centerZ, wz0, wz1);
+
+            FlowField *field = findCached(ggx0, ggz0, ggx1, ggz1);
+            if (field && field->coversCells(wx0, wz0, wx1, wz1))
+            {
+                touch(field);
+                continue;
+            }
+            if (!field)
+            {
+                if (m_fields.size() >= kMaxFields)
+                    m_fields.erase(m_fields.begin()); // least recently requested
+                m_fields.push_back(std::make_unique<FlowField>());
+                field = m_fields.back().get();
+            }
+            touch(field);
+
+            field->m_goal = goal;
+            field->m_goalGx0 = ggx0;
+            field->m_goalGz0 = ggz0;
+            field->m_goalGx1 = ggx1;
+            field->m_goalGz1 = ggz1;
+            field->m_invCell = invCell;
+            field->m_gx0 = wx0;
+            field->m_gz0 = wz0;
+            field->m_width = static_cast<uint32_t>(wx1 - wx0 + 1);
+            field->m_height = static_cast<uint32_t>(wz1 - wz0 + 1);
+
+            const size_t cells = static_cast<size_t>(field->m_width) * field->m_height;
+            field->m_cellCost.assign(cells, 1.0f);
+            field->m_isGoal.assign(cells, 0);
+            field->m_dir.assign(2 * cells, 0.0f);
+            for (int32_t cz = std::max(ggz0, wz0); cz <= std::min(ggz1, wz1); ++cz)
+                for (int32_t cx = std::max(ggx0, wx0); cx <= std::min(ggx1, wx1); ++cx)
+                    field->m_isGoal[static_cast<size_t>(cz - wz0) * field->m_width + static_cast<size_t>(cx - wx0)] = 1;
+
+            builds.push_back(field);
+        }
+        m_pending.clear();
+
+        if (builds.empty())
+            return;
+
+        // Crowd costs: idle units (no active target) standing inside a window.
+        for (uint32_t storeId : matchingStores(mgr))
+        {
+            auto &store = *mgr.get(storeId);
+            const auto positions = store.positions();
+            const bool hasTargets = store.hasMoveTarget();
+            const auto targets = store.moveTargets(); // invalid view when absent
+            const auto rows = store.rowFilter(required(), excluded());
+            const uint32_t n = store.size();
+            for (uint32_t i = rows.first(0u, n); i < n; i = rows.next(i, n))
+            {
+                if (hasTargets && targets[i].active)
+                    continue;
+                const Engine::ECS::Position p = positions[i];
+                const int32_t gx = cellOf(p.x), gz = cellOf(p.z);
+                for (FlowField *field : builds)
+                {
+                    const int32_t cx = gx - field->m_gx0, cz = gz - field->m_gz0;
+                    if (cx < 0 || cz < 0 || cx >= static_cast<int32_t>(field->m_width) || cz >= static_cast<int32_t>(field->m_height))
+                        continue;
+                    float &cost = field->m_cellCost[static_cast<size_t>(cz) * field->m_width + static_cast<size_t>(cx)];
+                    cost = std::min(cost + kCrowdCost, kMaxCellCost);
+                }
+            }
+        }
+
+        // Integration is a sequential wavefront: one job per field. Directions are per cell: row bands.
+        Engine::ECS::parallelForRows(jobSystem(), static_cast<uint32_t>(builds.size()), 1u,
+                                     [&](uint32_t begin, uint32_t end)
+                                     {
+                                         for (uint32_t b = begin; b < end; ++b)
+                                             builds[b]->integrate();
+                                     });
+        for (FlowField *field : builds)
+        {
+            Engine::ECS::parallelForRows(jobSystem(), field->m_height, kRowsPerJob,
+                                         [field](uint32_t begin, uint32_t end)
+                                         { field->buildDirections(begin, end); });
+        }
+    }
+
+private:
+    static constexpr uint32_t kRowsPerJob = 32; // field rows per direction job
+
+    FlowField *findCached(int32_t gx0, int32_t gz0, int32_t gx1, int32_t gz1) const
+    {
+        for (const auto &f : m_fields)
+            if (f->m_goalGx0 == gx0 && f->m_goalGz0 == gz0 && f->m_goalGx1 == gx1 && f->m_goalGz1 == gz1)
+                return f.get();
+        return nullptr;
+    }
+
+    // Mark as most recently requested: keep m_fields ordered oldest -> newest.
+    void touch(FlowField *field)
+    {
+        auto it = std::find_if(m_fields.begin(), m_fields.end(), [field](const std::unique_ptr<FlowField> &f)
+                               { return f.get() == field; });
+        if (it != m_fields.end() && it + 1 != m_fields.end())
+            std::rotate(it, it + 1, m_fields.end());
+    }
+
+    float m_cellSize = 2.0f;
+    std::vector<FlowGoal> m_pending;
+    std::vector<std::unique_ptr<FlowField>> m_fields; // oldest -> newest
+};
@@ -0,0 +1,368 @@
+#pragma once
+/*
+  GpuCrowdSystem.h (SampleApp-side)
+  ---------------------------------
+  Purpose:
+    - Feeds Engine::CrowdComputeModule, which runs local avoidance and integration for every unit on
+      the GPU (and writes the instance matrices the renderer draws). Takes the place of
+      SpatialIndexSystem -> LocalAvoidanceSystem -> MovementSystem in the schedule.
+    - Each tick: uploads the steering velocities of the active set ("Moving" row tag), asks for those
+      units back, and writes the returned Position/Facing into the stores.
+
+  Requirements:
+    - Components present in stores: "Position", "Velocity". "Radius" + "AvoidanceParams" (and the
+      optional "Separation") opt a store into avoidance, "Facing" into yaw-from-velocity.
+    - SteeringSystem must have run earlier in the tick (preferred velocity in Velocity).
+
+  Notes:
+    - The whole unit set is re-uploaded when a matching store changes structure (spawns, removals,
+      row reordering). Between those, only the active set is patched.
+    - Returned positions are one or two frames behind the GPU; steering and picking see them with
+      that delay. Units leaving the active set stay on the readback list until their final position
+      has arrived.
+    - Instance slots are assigned per model in RenderSystem::gather order, so each model's units form
+      one contiguous range of CrowdComputeModule::instanceBuffer() (see instanceSlot()).
+*/
+
+#include "ECS/SystemFormat.h"
+#include "ECS/Components.h"
+
+#include "Engine/CrowdComputeModule.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class GpuCrowdSystem : public Engine::ECS::SystemBase
+{
+public:
+    GpuCrowdSystem()
+    {
+        setRequiredNames({"Position", "Velocity"});
+        setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Velocity", "Radius", "Separation", "AvoidanceParams", "RenderModel", "Moving"});
+        setWriteNames({"Position", "Facing", "GpuCrowd"});
+    }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_activeRequired = required();
+        m_activeRequired.set(registry.ensureId("Moving"));
+        m_drawRequired = required();
+        m_drawRequired.set(registry.ensureId("RenderModel"));
+        m_drawRequired.set(registry.ensureId("RenderAnimation"));
+    }
+
+    const char *name() const override { return "GpuCrowdSystem"; }
+
+    void setModule(Engine::CrowdComputeModule *module)
+    {
+        m_module = module;
+        m_signature.clear(); // force a full upload
+    }
+    Engine::CrowdComputeModule *module() const { return m_module; }
+
+    // Grid cell size (meters) used for the GPU neighbor search.
+    void setCellSize(float cellSize)
+    {
+        m_cellSize = cellSize;
+        if (m_module)
+            m_module->setCellSize(cellSize);
+    }
+
+    // Serial of the last full upload; RenderInstance::gpuSlot values refer to it.
+    uint64_t layoutSerial() const { return m_layout; }
+
+    // Instance slot of a drawn entity in the current layout, or UINT32_MAX.
+    uint32_t instanceSlot(const Engine::ECS::Entity &e) const
+    {
+        const auto it = m_slotByEntity.find(entityKey(e));
+        return (it != m_slotByEntity.end()) ? it->second : UINT32_MAX;
+    }
+
+    void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
+    {
+        if (!m_module || !m_module->available() || dt <= 0.0f)
+            return;
+
+        const auto &stores = matchingStores(mgr);
+        if (layoutChanged(mgr, stores))
+            upload(mgr, stores);
+
+        applyReadback(mgr);
+
+        // Steering velocities of the active set; units that left it since the last tick stop.
+        m_patches.clear();
+        m_readback.clear();
+        for (const UnitRange &range : m_ranges)
+        {
+            auto &store = *mgr.get(range.storeId);
+            if (!store.hasMoveTarget())
+                continue;
+
+            const auto velocities = store.velocities();
+            const auto active = store.rowFilter(m_activeRequired, excluded());
+            const uint32_t baseFlags = (store.hasRadius() && store.hasAvoidanceParams()) ? Engine::CrowdComputeModule::kFlagAvoid : 0u;
+            const uint32_t facingFlag = store.hasFacing() ? Engine::CrowdComputeModule::kFlagFacing : 0u;
+
+            for (uint32_t row = 0; row < range.count; ++row)
+            {
+                const uint32_t unit = range.first + row;
+                const bool moving = active.test(row);
+                if (!moving && !m_moving[unit])
+                    continue;
+
+                Engine::CrowdPatchGpu patch;
+                patch.unit = unit;
+                patch.flags = baseFlags | facingFlag;
+                if (moving)
+                {
+                    const auto &v = velocities[row];
+                    patch.flags |= Engine::CrowdComputeModule::kFlagMove;
+                    patch.velX = v.x;
+                    patch.velZ = v.z;
+                    m_readback.push_back(unit);
+                }
+                else
+                {
+                    // Final position still to come back.
+                    m_settling[unit] = 1;
+                }
+                m_moving[unit] = moving ? 1 : 0;
+                m_patches.push_back(patch);
+            }
+        }
+
+        for (uint32_t unit = 0; unit < m_settling.size(); ++unit)
+            if (m_settling[unit] && !m_moving[unit])
+                m_readback.push_back(unit);
+        std::sort(m_readback.begin(), m_readback.end()); // applyReadback walks stores in order
+
+        if (!m_patches.empty())
+            m_module->patchUnits(m_patches.data(), static_cast<uint32_t>(m_patches.size()));
+        if (!m_readback.empty())
+            m_module->requestReadback(m_readback.data(), static_cast<uint32_t>(m_readback.size()));
+        m_module->step(dt);
+    }
+
+private:
+    struct UnitRange
+    {
+        uint32_t storeId = 0;
+        uint32_t first = 0; // first unit index
+        uint32_t count = 0;
+    };
+
+    static uint64_t entityKey(const Engine::ECS::Entity &e)
+    {
+        return (static_cast<uint64_t>(e.generation) << 32) | e.index;
+    }
+
+    // (storeId, structureVersion, size) of every matching store; any difference means rows moved.
+    bool layoutChanged(Engine::ECS::ArchetypeStoreManager &mgr, const std::vector<uint32_t> &stores)
+    {
+        m_signatureScratch.clear();
+        for (uint32_t storeId : stores)
+        {
+            const auto &store = *mgr.get(storeId);
+            m_signatureScratch.push_back(storeId);
+            m_signatureScratch.push_back(store.structureVersion());
+            m_signatureScratch.push_back(store.size());
+        }
+        if (m_signatureScratch == m_signature)
+            return false;
+        m_signature.swap(m_signatureScratch);
+        return true;
+    }
+
+    void upload(Engine::ECS::ArchetypeStoreManager &mgr, const std::vector<uint32_t> &stores)
+    {
+        using Engine::CrowdComputeModule;
+
+        m_ranges.clear();
+        m_units.clear();
+        m_slotByEntity.clear();
+
+        // Per-model instance bases, in first-appearance order (what RenderSystem::gather visits).
+        // Tick scratch memory: gone before the next tick resets the arena.
+        Engine::LinearArena *arena = scratchArena();
+        Engine::ArenaHashMap<uint64_t, uint32_t> modelBase{Engine::ArenaAllocator<uint64_t>(arena)};
+        Engine::ArenaVector<uint64_t> modelOrder{Engine::ArenaAllocator<uint64_t>(arena)};
+        Engine::ArenaHashMap<uint64_t, uint32_t> modelCount{Engine::ArenaAllocator<uint64_t>(arena)};
+        auto modelKey = [](const Engine::ModelHandle &h)
+        { return (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id); };
+
+        for (uint32_t storeId : stores)
+        {
+            const auto &store = *mgr.get(storeId);
+            if (!store.hasRenderModel() || !store.hasRenderAnimation())
+                continue;
+            const auto models = store.renderModels();
+            const auto drawn = store.rowFilter(m_drawRequired, excluded());
+            const uint32_t n = store.size();
+            for (uint32_t row = drawn.first(0u, n); row < n; row = drawn.next(row, n))
+            {
+                const uint64_t key = modelKey(models[row].handle);
+                if (modelCount.emplace(key, 0u).second)
+                    modelOrder.push_back(key);
+                ++modelCount[key];
+            }
+        }
+        uint32_t instanceCount = 0;
+        for (uint64_t key : modelOrder)
+        {
+            modelBase[key] = instanceCount;
+            instanceCount += modelCount[key];
+        }
+
+        for (uint32_t storeId : stores)
+        {
+            auto &store = *mgr.get(storeId);
+            const uint32_t n = store.size();
+            UnitRange range{storeId, static_cast<uint32_t>(m_units.size()), n};
+
+            const auto owners = store.entities();
+            const auto positions = store.positions();
+            const auto velocities = store.velocities();
+            const bool avoid = store.hasRadius() && store.hasAvoidanceParams();
+            const auto radii = store.radii();
+            const auto params = store.avoidanceParams();
+            const bool hasSep = store.hasSeparation();
+            const auto seps = store.separations();
+            const auto facings = store.facings();
+            const bool drawable = store.hasRenderModel() && store.hasRenderAnimation();
+            const auto models = store.renderModels();
+            const auto rows = store.rowFilter(required(), excluded());
+            const auto drawn = store.rowFilter(m_drawRequired, excluded());
+            const auto active = store.rowFilter(m_activeRequired, excluded());
+            // Stores without MoveTarget are not steered: every unit integrates its velocity.
+            const bool alwaysMoving = !store.hasMoveTarget();
+
+            for (uint32_t row = 0; row < n; ++row)
+            {
+                Engine::CrowdUnitGpu u;
+                const auto &p = positions[row];
+                const auto &v = velocities[row];
+                u.posX = p.x;
+                u.posY = p.y;
+                u.posZ = p.z;
+                u.velX = v.x;
+                u.velY = v.y;
+                u.velZ = v.z;
+                if (rows.test(row))
+                {
+                    if (avoid)
+                    {
+                        u.radius = radii[row].r;
+                        u.separation = hasSep ? seps[row].value : 0.0f;
+                        u.strength = params[row].strength;
+                        u.maxAccel = params[row].maxAccel;
+                        u.blend = params[row].blend;
+                        u.flags |= CrowdComputeModule::kFlagAvoid;
+                    }
+                    if (facings.valid())
+                    {
+                        u.yaw = facings[row].yaw;
+                        u.flags |= CrowdComputeModule::kFlagFacing;
+                    }
+                    if (alwaysMoving || active.test(row))
+                        u.flags |= CrowdComputeModule::kFlagMove;
+                    if (drawable && drawn.test(row))
+                    {
+                        u.instance = modelBase[modelKey(models[row].handle)]++;
+                        m_slotByEntity[entityKey(owners[row])] = u.instance;
+                    }
+                }
+                else
+                {
+                    // Excluded rows keep their index but neither move nor push neighbors.
+                    u.flags = 0;
+                }
+                m_units.push_back(u);
+            }
+            m_ranges.push_back(range);
+        }
+
+        m_moving.assign(m_units.size(), 0);
+        m_settling.assign(m_units.size(), 0);
+        for (const UnitRange &range : m_ranges)
+        {
+            if (!mgr.get(range.storeId)->hasMoveTarget())
+                continue;
+            for (uint32_t row = 0; row < range.count; ++row)
+                m_moving[range.first + row] = (m_units[range.first + row].flags & CrowdComputeModule::kFlagMove) ? 1 : 0;
+        }
+
+        ++m_layout;
+        m_module->setCellSize(m_cellSize);
+        m_module->setUnits(m_units.data(), static_cast<uint32_t>(m_units.size()), instanceCount, m_layout);
+    }
+
+    void applyReadback(Engine::ECS::ArchetypeStoreManager &mgr)
+    {
+        uint64_t layout = 0;
+        if (!m_module->takeReadback(m_readbackUnits, m_readbackStates, layout) || layout != m_layout)
+            return;
+
+        // Units are grouped by store and ascending within one, like the request.
+        size_t k = 0;
+        for (const UnitRange &range : m_ranges)
+        {
+            const uint32_t end = range.first + range.count;
+            if (k >= m_readbackUnits.size())
+                break;
+            if (m_readbackUnits[k] >= end)
+                continue;
+
+            auto &store = *mgr.get(range.storeId);
+            auto positions = store.positions();
+            auto facings = store.facings();
+            uint32_t lo = UINT32_MAX, hi = 0;
+            for (; k < m_readbackUnits.size() && m_readbackUnits[k] < end; ++k)
+            {
+                const uint32_t unit = m_readbackUnits[k];
+                if (unit < range.first)
+                    continue;
+                const Engine::CrowdUnitGpu &s = m_readbackStates[k];
+                const uint32_t row = unit - range.first;
+                auto &&p = positions[row];
+                p.x = s.posX;
+                p.y = s.posY;
+                p.z = s.posZ;
+                if (facings.valid())
+                    facings[row].yaw = s.yaw;
+                if (!m_moving[unit])
+                    m_settling[unit] = 0;
+                lo = std::min(lo, row);
+                hi = std::max(hi, row + 1);
+            }
+            if (lo < hi)
+            {
+                markChunks<Engine::ECS::Position>(store, lo, hi);
+                if (facings.valid())
+                    markChunks<Engine::ECS::Facing>(store, lo, hi);
+            }
+        }
+    }
+
+    Engine::CrowdComputeModule *m_module = nullptr; // not owned
+    float m_cellSize = 2.0f;
+
+    Engine::ECS::ComponentMask m_activeRequired; // required() + "Moving"
+    Engine::ECS::ComponentMask m_drawRequired;   // required() + RenderModel + RenderAnimation
+
+    std::vector<uint32_t> m_signature, m_signatureScratch;
+    uint64_t m_layout = 0;
+    std::vector<UnitRange> m_ranges;
+    std::vector<Engine::CrowdUnitGpu> m_units;
+    std::vector<uint8_t> m_moving;   // per unit: in the active set last tick
+    std::vector<uint8_t> m_settling; // per unit: left the active set, final position not back yet
+    std::unordered_map<uint64_t, uint32_t> m_slotByEntity;
+
+    std::vector<Engine::CrowdPatchGpu> m_patches;
+    std::vector<uint32_t> m_readback;
+    std::vector<uint32_t> m_readbackUnits;
+    std::vector<Engine::CrowdUnitGpu> m_readbackStates;
+};
@@ -15,6 +15,12 @@
 
   Suggested order per frame:
     CommandSystem -> SteeringSystem -> SpatialIndexSystem -> LocalAvoidanceSystem -> MovementSystem
+
+  Notes:
+    - Neighbor position/radius/separation come from the grid's packed entries (one contiguous scan per
+      cell), not from the neighbor's store. Each unit queries with its own reach (radius + separation),
+      so mixed sizes (infantry next to siege units) see each other through the grid's levels.
+    - Rows only write their own Velocity, so each store is split across the job system (setJobSystem).
 */
 
 #include "ECS/SystemFormat.h"
@@ -36,12 +42,17 @@ public:
         // Require the data we adjust/read
         setRequiredNames({"Position", "Velocity", "Radius", "AvoidanceParams"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "Radius", "Separation", "AvoidanceParams", "SpatialGrid"});
+        setWriteNames({"Velocity"});
     }
 
     const char *name() const override { return "LocalAvoidanceSystem"; }
 
     void setGrid(const SpatialIndexSystem *grid) { m_grid = grid; }
 
+    // Rows handed to one job by forEachChunk.
+    static constexpr uint32_t kRowsPerJob = 512;
+
     void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
     {
         if (!m_grid)
@@ -58,76 +69,51 @@ public:
         auto lerp = [](float a, float b, float t)
         { return a + (b - a) * t; };
 
-        uint32_t sid = 0;
-        for (const auto &ptr : mgr.stores())
+        for (uint32_t sid : matchingStores(mgr))
         {
-            if (!ptr)
-            {
-                ++sid;
-                continue;
-            }
-            auto &store = *ptr;
-
-            // Store-level mask filter
-            if (!store.signature().containsAll(required()))
-            {
-                ++sid;
-                continue;
-            }
-            if (!store.signature().containsNone(excluded()))
-            {
-                ++sid;
-                continue;
-            }
+            auto &store = *mgr.get(sid);
 
-            auto &positions = const_cast<std::vector<Engine::ECS::Position> &>(store.positions());
-            auto &velocities = const_cast<std::vector<Engine::ECS::Velocity> &>(store.velocities());
-            auto &radii = const_cast<std::vector<Engine::ECS::Radius> &>(store.radii());
-            auto &params = const_cast<std::vector<Engine::ECS::AvoidanceParams> &>(store.avoidanceParams());
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            auto radii = store.radii();
+            auto params = store.avoidanceParams();
             const bool hasSep = store.hasSeparation();
-            auto *sepsPtr = hasSep ? &const_cast<std::vector<Engine::ECS::Separation> &>(store.separations()) : nullptr;
-            const auto &masks = store.rowMasks();
+            auto seps = store.separations();
+            const auto rows = store.rowFilter(lodRequired(required()), excluded());
 
-            const uint32_t n = store.size();
-            for (uint32_t row = 0; row < n; ++row)
+            forEachChunk(store, kRowsPerJob, [&](uint32_t begin, uint32_t end)
+                         {
+            bool anyRow = false;
+            for (uint32_t row = rows.first(begin, end); row < end; row = rows.next(row, end))
             {
-                if (!masks[row].matches(required(), excluded()))
-                    continue;
+                anyRow = true;
 
-                auto &p = positions[row];
-                auto &v = velocities[row];
+                auto &&p = positions[row];
+                auto &&v = velocities[row];
                 const auto &r = radii[row];
                 const auto &ap = params[row];
-                const float sepSelf = sepsPtr ? (*sepsPtr)[row].value : 0.0f;
+                const float sepSelf = hasSep ? seps[row].value : 0.0f;
 
-                // Accumulate separation correction from neighbors in 3x3 cells
+                // Accumulate separation correction from every neighbor this unit can reach (3x3 cells
+                // for small units; large ones scan further on the finer grid levels).
                 float corrX = 0.0f, corrZ = 0.0f;
 
-                m_grid->forNeighbors(p.x, p.z, [&](uint32_t nStoreId, uint32_t nRow)
-                                     {
-                    // Skip self
-                    if (nStoreId == sid && nRow == row) return;
-
-                    const auto* nStore = mgr.get(nStoreId);
-                    if (!nStore) return;
-                    if (!nStore->hasPosition()) return;
-                    if (!nStore->hasRadius()) return;
-                    const bool nHasSep = nStore->hasSeparation();
-
-                    const auto& np = nStore->positions()[nRow];
-                    const auto& nr = nStore->radii()[nRow];
-                    const float sepOther = (nHasSep ? nStore->separations()[nRow].value : 0.0f);
+                m_grid->forNeighborEntries(p.x, p.z, r.r + sepSelf, [&](const GridEntry &n)
+                                           {
+                    // Skip self, and neighbors without Radius
+                    if (n.storeId == sid && n.row == row) return;
+                    if (n.radius < 0.0f) return;
 
                     // 2D separation in gameplay ground plane (X/Z). Y is height.
-                    float dx = p.x - np.x;
-                    float dz = p.z - np.z;
+                    float dx = p.x - n.x;
+                    float dz = p.z - n.z;
 
                     const float dist2 = dx*dx + dz*dz;
 
                     float dist = (dist2 > 1e-12f) ? std::sqrt(dist2) : 0.0f;
 
-                    const float desiredSeparation = sepSelf + sepOther;
-                    const float desiredDist = (r.r + nr.r) + desiredSeparation;
+                    const float desiredSeparation = sepSelf + n.separation;
+                    const float desiredDist = (r.r + n.radius) + desiredSeparation;
 
                     // Overlap weight: strong when overlapping
                     float wOverlap = 0.0f;
@@ -166,7 +152,7 @@ public:
                 float dvX = vRawX - vPrefX;
                 float dvZ = vRawZ - vPrefZ;
                 const float dvMag = length(dvX, dvZ);
-                const float maxDv = ap.maxAccel * dt;
+                const float maxDv = ap.maxAccel * dt * lodScale(sid, row);
                 if (dvMag > maxDv && dvMag > 1e-6f)
                 {
                     const float s = maxDv / dvMag;
@@ -183,8 +169,8 @@ public:
                 v.z = lerp(vPrefZ, vNewZ, t);
                 // Leave v.y unchanged (height axis)
             }
-
-            ++sid;
+            if (anyRow)
+                markChunks<Engine::ECS::Velocity>(store, begin, end); });
         }
     }
 
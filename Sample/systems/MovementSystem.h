@@ -5,6 +5,8 @@
   Purpose:
     - Moves entities: position += velocity * dt for any archetype store that has both Position and Velocity
       and does not contain excluded tags.
+    - In stores of commandable units (MoveTarget), only the active set ("Moving" row tag, maintained by
+      CommandSystem/SteeringSystem) is integrated; idle units cost nothing.
 
   How to customize:
     - Change required/excluded component names in the constructor to reflect the game rules.
@@ -13,8 +15,10 @@
 
 #include "ECS/SystemFormat.h" // IGameplaySystem, SystemBase
 #include "ECS/Components.h"
-#include <cmath>
-#include <iostream>
+#include "utils/AllocTracker.h"
+#include "utils/SimdKernels.h"
+#include <algorithm>
+
 class MovementSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -27,58 +31,80 @@ public:
         // Optional excluded tags/components (define them in your registry if you use them).
         // Comment out if not used.
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Velocity", "Moving"});
+        setWriteNames({"Position"});
+    }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_activeRequired = required();
+        m_activeRequired.set(registry.ensureId("Moving"));
     }
 
     const char *name() const override { return "MovementSystem"; }
 
-    // Called once after creation: registry will resolve names to IDs and build masks.
-    // buildMasks is inherited from SystemBase; no override needed unless custom behavior is required.
+    // Rows handed to one job by forEachChunk.
+    static constexpr uint32_t kRowsPerJob = 2048;
 
     // Per-frame update over all matching stores.
     void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
     {
-        for (const auto &ptr : mgr.stores())
-        {
-            if (!ptr)
-                continue;
-            const auto &store = *ptr;
-
-            // Fast store-level filter: must have required, must NOT have excluded
-            if (!store.signature().containsAll(required()))
-                continue;
-            if (!store.signature().containsNone(excluded()))
-                continue;
+        static_assert(sizeof(Engine::ECS::Position) == 3 * sizeof(float) && sizeof(Engine::ECS::Velocity) == 3 * sizeof(float),
+                      "Integration treats Position/Velocity runs as flat float arrays");
 
-            // Row-level filter and update
-            const uint32_t n = store.size();
-            auto &positions = const_cast<std::vector<Engine::ECS::Position> &>(store.positions());
-            auto &velocities = const_cast<std::vector<Engine::ECS::Velocity> &>(store.velocities());
-            const auto &masks = store.rowMasks();
+        for (uint32_t storeId : matchingStores(mgr))
+        {
+            auto &store = *mgr.get(storeId);
 
-            const bool canLogTarget = store.hasMoveTarget();
-            const auto *targetsPtr = canLogTarget ? &store.moveTargets() : nullptr;
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            const auto rows = store.rowFilter(store.hasMoveTarget() ? m_activeRequired : required(), excluded());
+            const uint32_t rowsPerChunk = store.rowsPerChunk();
 
-            for (uint32_t i = 0; i < n; ++i)
+            // Rows are independent: integrate them in parallel chunks. Each run of passing rows inside
+            // a chunk is contiguous, so position += velocity * dt becomes SIMD axpy calls over flat
+            // float arrays; rows masked out by tags are simply skipped.
+            forEachChunk(store, kRowsPerJob, [&](uint32_t begin, uint32_t end)
+                         {
+            ENGINE_NO_ALLOC_SCOPE("MovementSystem integrate");
+            bool anyMoved = false;
+            for (uint32_t i = rows.first(begin, end); i < end;)
             {
-                if (!masks[i].matches(required(), excluded()))
-                    continue;
-
-                const auto before = positions[i];
+                const uint32_t chunkEnd = (i / rowsPerChunk + 1) * rowsPerChunk;
+                const uint32_t stop = std::min(rows.runEnd(i, end), chunkEnd);
+                anyMoved |= integrateRun(positions, velocities, i, stop, dt);
+                i = rows.first(stop, end);
+            }
+            // Ranges are chunk-aligned, so each job stamps only its own chunks.
+            if (anyMoved)
+                markChunks<Engine::ECS::Position>(store, begin, end); });
+        }
+    }
 
-                positions[i].x += velocities[i].x * dt;
-                positions[i].y += velocities[i].y * dt;
-                positions[i].z += velocities[i].z * dt;
+private:
+    Engine::ECS::ComponentMask m_activeRequired; // required() + "Moving"
 
-                const bool targetActive = (targetsPtr && (*targetsPtr)[i].active != 0);
-                const bool moving = (std::fabs(velocities[i].x) + std::fabs(velocities[i].y) + std::fabs(velocities[i].z)) > 1e-6f;
-                if (targetActive || moving)
-                {
-                    const auto after = positions[i];
-                    const float dx = after.x - before.x;
-                    const float dy = after.y - before.y;
-                    const float dz = after.z - before.z;
-                }
-            }
+    // Integrate rows [begin, end) of one chunk. Packed rows are one 3*n float array; split-scalar
+    // columns (ENGINE_ECS_SPLIT_HOT_COMPONENTS) are three n-float lanes.
+    template <typename PositionColumn, typename VelocityColumn>
+    static bool integrateRun(const PositionColumn &positions, const VelocityColumn &velocities,
+                             uint32_t begin, uint32_t end, float dt)
+    {
+        using Engine::ECS::SplitFields;
+        if constexpr (SplitFields<Engine::ECS::Position>::enabled && SplitFields<Engine::ECS::Velocity>::enabled)
+        {
+            const uint32_t chunk = begin / positions.rowsPerChunk();
+            const uint32_t slot = begin % positions.rowsPerChunk();
+            bool any = false;
+            for (uint32_t k = 0; k < 3; ++k)
+                any |= Engine::Simd::axpy(positions.template lane<float>(chunk, k) + slot,
+                                          velocities.template lane<float>(chunk, k) + slot, end - begin, dt);
+            return any;
+        }
+        else
+        {
+            return Engine::Simd::axpy(&positions[begin].x, &velocities[begin].x, 3 * (end - begin), dt);
         }
     }
-};
\ No newline at end of file
+};
@@ -5,27 +5,80 @@
 #include "assets/AssetManager.h"
 
 #include "Engine/Camera.h"
+#include "Engine/CrowdComputeModule.h"
 #include "Engine/Renderer.h"
 #include "Engine/SModelRenderPassModule.h"
+#include "utils/FrameArena.h"
+#include "utils/Profiler.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
+// One drawable unit as seen by the renderer: its state at the previous and the latest simulation tick.
+// Filled by RenderSystem::gather (prev == current unless the caller patches it), drawn by submit().
+struct RenderInstance
+{
+    Engine::ECS::Entity entity{};
+    Engine::ModelHandle handle{};
+    Engine::ECS::Position prevPosition{};
+    Engine::ECS::Position position{};
+    float prevYaw = 0.0f;
+    float yaw = 0.0f;
+    bool hasFacing = false;
+    uint32_t clipIndex = 0;
+    float prevTimeSec = 0.0f;
+    float timeSec = 0.0f;
+    bool playing = false;
+    uint32_t gpuSlot = UINT32_MAX; // CrowdComputeModule instance slot (GpuCrowdSystem layout), if any
+};
+
 class RenderSystem : public Engine::ECS::SystemBase
 {
 public:
+    // Animation LOD picked per instance from the fraction of the screen height its model's bounds
+    // cover. Only affects CPU-evaluated (non-baked) models.
+    struct AnimationLod
+    {
+        bool enabled = true;
+        float reducedBelow = 0.08f; // smaller: pose held for 'reducedSteps' pose time steps, optional leaf channels skipped
+        float crowdBelow = 0.025f;  // smaller: one shared pose per clip and 'crowdStep' seconds
+        uint32_t reducedSteps = 4;
+        float crowdStep = 0.25f;
+    };
+
+    // Mesh LOD (models cooked with LOD chains, ModelAsset::meshLodCount > 1) from the same screen
+    // height fraction: LOD k + 1 once it drops below below[k].
+    struct MeshLod
+    {
+        bool enabled = true;
+        float below[Engine::ModelAsset::kMaxMeshLods - 1] = {0.15f, 0.07f, 0.03f};
+    };
+
+    // Impostors (SModelRenderPassModule::setImpostors()) from the same screen height fraction: below
+    // 'below' an instance draws as a quad from its model's baked atlas, past every mesh LOD, and
+    // needs no pose evaluation. Instances that may belong to a GPU instance range stay meshes.
+    struct Impostor
+    {
+        bool enabled = true;
+        float below = 0.02f;
+    };
+
     explicit RenderSystem(Engine::AssetManager *assets = nullptr)
         : m_assets(assets)
     {
         // We need Position to build a model matrix later.
         setRequiredNames({"RenderModel", "RenderAnimation", "Position"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderModel", "RenderAnimation", "Position", "Facing"});
+        setWriteNames({"RenderPasses"});
     }
 
     const char *name() const override { return "RenderModelSystem"; }
@@ -34,200 +87,674 @@ public:
     void setRenderer(Engine::Renderer *renderer) { m_renderer = renderer; }
     void setCamera(Engine::Camera *camera) { m_camera = camera; }
 
-    void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
+    // GPU-written instance matrices. A model batch draws straight from crowd->instanceBuffer() when
+    // its gpuSlots form one contiguous range of the layout the module is about to draw.
+    void setGpuCrowd(Engine::CrowdComputeModule *crowd) { m_crowd = crowd; }
+
+    // Instances of one model whose clip time rounds to the same multiple of 'seconds' share one
+    // evaluated pose per frame (<= 0: evaluate every instance on its own).
+    void setPoseTimeStep(float seconds) { m_poseTimeStep = seconds; }
+
+    // Models with baked clips (ModelAsset::bakeAnimations) upload only a clip frame pair per
+    // instance and let the vertex shader fetch the pose; no CPU pose evaluation for them.
+    void setBakedAnimation(bool enabled) { m_bakedAnimation = enabled; }
+
+    void setAnimationLod(const AnimationLod &lod) { m_lod = lod; }
+    const AnimationLod &animationLod() const { return m_lod; }
+
+    // CPU-evaluated instances at each animation LOD (full, reduced, crowd) in the last submit().
+    const uint32_t *animationLodCounts() const { return m_lodCounts; }
+
+    void setMeshLod(const MeshLod &lod) { m_meshLod = lod; }
+    const MeshLod &meshLod() const { return m_meshLod; }
+
+    // Instances drawn at each mesh LOD in the last submit().
+    const uint32_t *meshLodCounts() const { return m_meshLodCounts; }
+
+    void setImpostor(const Impostor &impostor) { m_impostor = impostor; }
+    const Impostor &impostor() const { return m_impostor; }
+
+    // Instances drawn as impostors in the last submit().
+    uint32_t impostorCount() const { return m_impostorCount; }
+
+    // Skip instances whose drawn bounding sphere is outside the camera frustum: no pose evaluation,
+    // palette entries or instance upload for them.
+    void setFrustumCulling(bool enabled) { m_frustumCulling = enabled; }
+
+    // Instances culled by the last submit().
+    uint32_t culledCount() const { return m_culledCount; }
+
+    void update(Engine::ECS::ArchetypeStoreManager &mgr, float /*dt*/) override
     {
         if (!m_assets || !m_renderer || !m_camera)
             return;
+        gather(mgr, m_instances);
+        submit(m_instances, 1.0f);
+    }
 
-        auto keyFromHandle = [](const Engine::ModelHandle &h) -> uint64_t
-        {
-            return (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id);
-        };
+    // Snapshot every drawable row (prev fields = current state).
+    void gather(Engine::ECS::ArchetypeStoreManager &mgr, std::vector<RenderInstance> &out)
+    {
+        ENGINE_PROFILE_SCOPE("RenderSystem::gather");
+        out.clear();
 
-        struct PerModelBatch
+        for (uint32_t storeId : matchingStores(mgr))
         {
-            std::vector<glm::mat4> instanceWorlds;
-            std::vector<glm::mat4> nodePalette; // flattened: [instance][node]
-            uint32_t nodeCount = 0;
-
-            std::vector<glm::mat4> jointPalette; // flattened: [instance][joint]
-            uint32_t jointCount = 0;
+            auto &store = *mgr.get(storeId);
+            if (!store.hasRenderModel() || !store.hasRenderAnimation() || !store.hasPosition())
+                continue;
 
-            // scratch (reused per instance)
-            std::vector<Engine::ModelAsset::NodeTRS> trsScratch;
-            std::vector<glm::mat4> localsScratch;
-            std::vector<glm::mat4> globalsScratch;
-            std::vector<uint8_t> visitedScratch;
+            const auto owners = store.entities();
+            const auto renderModels = store.renderModels();
+            const auto renderAnimations = store.renderAnimations();
+            const auto positions = store.positions();
+            const auto facings = store.facings(); // invalid view when absent
+            const auto rows = store.rowFilter(required(), excluded());
+            const uint32_t n = store.size();
 
-            std::vector<glm::mat4> jointsScratch;
-        };
+            for (uint32_t row = rows.first(0u, n); row < n; row = rows.next(row, n))
+            {
+                RenderInstance inst;
+                inst.entity = owners[row];
+                inst.handle = renderModels[row].handle;
+                inst.position = inst.prevPosition = positions[row];
+                if (facings.valid())
+                {
+                    inst.hasFacing = true;
+                    inst.yaw = inst.prevYaw = facings[row].yaw;
+                }
+                const Engine::ECS::RenderAnimation anim = renderAnimations[row];
+                inst.clipIndex = anim.clipIndex;
+                inst.timeSec = inst.prevTimeSec = anim.timeSec;
+                inst.playing = anim.playing;
+                out.push_back(inst);
+            }
+        }
+    }
 
-        std::unordered_map<uint64_t, PerModelBatch> batchesByModel;
-        std::unordered_map<uint64_t, Engine::ModelHandle> handleByKey;
+    // Build per-model instance batches and hand them to the model batch renderer. 'alpha' in [0, 1] blends each
+    // instance from its prev* state (0) to its current state (1). 'gpuLayout' is the GpuCrowdSystem
+    // layout the instances' gpuSlot values refer to (0: none).
+    void submit(const std::vector<RenderInstance> &instances, float alpha, uint64_t gpuLayout = 0)
+    {
+        if (!m_assets || !m_renderer || !m_camera)
+            return;
+        ENGINE_PROFILE_SCOPE("RenderSystem::submit");
+        alpha = std::clamp(alpha, 0.0f, 1.0f);
 
-        for (const auto &ptr : mgr.stores())
+        auto lerp = [alpha](float a, float b)
+        { return a + (b - a) * alpha; };
+        // Shortest-arc blend for yaw (radians).
+        auto lerpAngle = [alpha](float a, float b)
         {
-            if (!ptr)
-                continue;
+            constexpr float kPi = 3.14159265358979f;
+            float d = std::fmod(b - a + kPi, 2.0f * kPi);
+            if (d < 0.0f)
+                d += 2.0f * kPi;
+            return a + (d - kPi) * alpha;
+        };
 
-            auto &store = *ptr;
-            if (!store.signature().containsAll(required()))
-                continue;
-            if (!store.signature().containsNone(excluded()))
-                continue;
-            if (!store.hasRenderModel())
-                continue;
-            if (!store.hasRenderAnimation())
-                continue;
-            if (!store.hasPosition())
+        const bool gpuInstances = m_crowd && m_crowd->available() && gpuLayout != 0 &&
+                                  gpuLayout == m_crowd->layoutSerial();
+
+        // Projected size: radius * |proj[1][1]| / clip w is the fraction of the screen height covered
+        // (the Vulkan projection flips Y, so proj[1][1] is negative).
+        const glm::mat4 viewProj = m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix();
+        const float projScaleY = std::abs(m_camera->GetProjectionMatrix()[1][1]);
+        const FrustumPlanes frustum = frustumPlanes(viewProj);
+        std::fill(m_lodCounts, m_lodCounts + 3, 0u);
+        std::fill(m_meshLodCounts, m_meshLodCounts + Engine::ModelAsset::kMaxMeshLods, 0u);
+        m_culledCount = 0;
+        m_impostorCount = 0;
+        const bool impostors = m_impostor.enabled && m_pass && m_pass->impostors();
+
+        // Batches persist across frames (one slot per model ever drawn); this frame's are listed in
+        // m_activeBatches and were reset, keeping their allocations, on first use. Their pose caches
+        // live in the frame arena: drop last frame's before recycling it.
+        for (uint32_t slot : m_activeBatches)
+            m_batches[slot].poseByKey.reset();
+        m_frameArena.beginFrame();
+        ++m_frame;
+        m_activeBatches.clear();
+        uint64_t lastKey = ~0ull;
+        PerModelBatch *lastBatch = nullptr;
+
+        for (const RenderInstance &inst : instances)
+        {
+            // gather() visits a store's rows together, so runs of one model skip the slot lookup.
+            const uint64_t key = keyFromHandle(inst.handle);
+            if (key != lastKey || !lastBatch)
+            {
+                lastKey = key;
+                lastBatch = &beginBatch(inst.handle, key);
+            }
+            PerModelBatch &batch = *lastBatch;
+            // No asset yet while AssetManager::loadModelAsync() streams it in (or if it failed)
+            if (!batch.asset || batch.nodeCount == 0)
                 continue;
-
-            auto &renderModels = store.renderModels();
-            auto &renderAnimations = store.renderAnimations();
-            auto &positions = store.positions();
-            const auto &masks = store.rowMasks();
-            const uint32_t n = store.size();
-
-            for (uint32_t row = 0; row < n; ++row)
+            const Engine::ModelAsset *asset = batch.asset;
+
+            // World matrix (interpolated between the last two ticks)
+            const glm::vec3 pos(lerp(inst.prevPosition.x, inst.position.x),
+                                lerp(inst.prevPosition.y, inst.position.y),
+                                lerp(inst.prevPosition.z, inst.position.z));
+
+            // Off screen: dropped, unless it keeps a GPU instance range contiguous. Then it is still
+            // drawn (clipped by the GPU) but shares one cheap pose per batch.
+            bool culled = false;
+            if (m_frustumCulling &&
+                !sphereVisible(frustum, pos.x, pos.y + batch.lodCenterY, pos.z, batch.lodRadius))
             {
-                if (!masks[row].matches(required(), excluded()))
+                ++m_culledCount;
+                if (!gpuInstances || inst.gpuSlot == UINT32_MAX)
                     continue;
+                culled = true;
+            }
 
-                const Engine::ModelHandle handle = renderModels[row].handle;
-                Engine::ModelAsset *asset = m_assets->getModel(handle);
-                if (!asset)
-                    continue;
+            const float coverage = culled ? 0.0f : screenCoverage(viewProj, projScaleY, pos, batch.lodRadius);
+            const bool impostor = impostors && !culled && coverage < m_impostor.below && !(gpuInstances && inst.gpuSlot != UINT32_MAX);
+            batch.meshLods.push_back(culled     ? kCulledMeshLod
+                                     : impostor ? kImpostorMeshLod
+                                                : static_cast<uint8_t>(chooseMeshLod(coverage, batch.meshLodCount)));
 
-                const uint64_t key = keyFromHandle(handle);
-                const auto &anim = renderAnimations[row];
+            glm::mat4 world = glm::translate(glm::mat4(1.0f), pos);
 
-                const auto &pos = positions[row];
+            if (inst.hasFacing)
+            {
+                const float yaw = lerpAngle(inst.prevYaw, inst.yaw);
+                world = glm::rotate(world, yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+            }
 
-                handleByKey[key] = handle;
+            if (batch.instanceWorlds.empty())
+                batch.gpuFirst = inst.gpuSlot;
+            else if (inst.gpuSlot != batch.gpuFirst + batch.instanceWorlds.size())
+                batch.gpuContiguous = false;
+            batch.instanceWorlds.emplace_back(world);
+
+            const uint32_t safeClip = (!asset->animClips.empty())
+                                          ? std::min(inst.clipIndex, static_cast<uint32_t>(asset->animClips.size() - 1))
+                                          : 0u;
+            // Blend clip time unless the clip wrapped or restarted since the previous tick.
+            const float blendedTime = (inst.timeSec >= inst.prevTimeSec) ? lerp(inst.prevTimeSec, inst.timeSec) : inst.timeSec;
+            float timeSec = (!asset->animClips.empty() && inst.playing) ? blendedTime : 0.0f;
+
+            // Impostors draw the nearest baked atlas frame instead of a pose.
+            if (impostor)
+            {
+                const uint32_t frame = Engine::SModelRenderPassModule::impostorFrame(*asset, safeClip, timeSec);
+                ++batch.impostorCount;
+                if (batch.baked)
+                    batch.bakedPoses.push_back(Engine::SModelRenderPassModule::InstancePose{frame, frame, 0.0f});
+                else
+                    batch.instancePoses.push_back(frame);
+                continue;
+            }
 
-                auto &batch = batchesByModel[key];
-                if (batch.nodeCount == 0)
-                {
-                    batch.nodeCount = static_cast<uint32_t>(asset->nodes.size());
-                    batch.nodePalette.reserve(64u * batch.nodeCount);
+            if (batch.baked)
+            {
+                Engine::SModelRenderPassModule::InstancePose p;
+                if (!culled)
+                    asset->bakedFramesAt(safeClip, timeSec, p.pose0, p.pose1, p.blend);
+                batch.bakedPoses.push_back(p);
+                continue;
+            }
 
-                    batch.jointCount = asset->totalJointCount;
-                    if (batch.jointCount > 0)
-                        batch.jointPalette.reserve(64u * batch.jointCount);
+            if (culled)
+            {
+                if (batch.culledPose == UINT32_MAX)
+                {
+                    batch.culledPose = batch.poseCount++;
+                    m_poseJobs.push_back(PoseJob{batch.slot, 0u, 0.0f, batch.culledPose, true});
                 }
+                batch.instancePoses.push_back(batch.culledPose);
+                continue;
+            }
 
-                if (batch.nodeCount == 0)
-                    continue;
+            // Reuse a pose evaluated this frame for the same LOD, clip and time step.
+            const uint32_t lod = chooseLod(coverage);
+            const float poseStep = poseStepForLod(lod);
+            ++m_lodCounts[lod];
+
+            uint64_t poseKey = 0;
+            if (poseStep > 0.0f)
+            {
+                const long long tick = std::llround(timeSec / poseStep);
+                timeSec = static_cast<float>(tick) * poseStep;
+                poseKey = (static_cast<uint64_t>(lod) << 56) | (static_cast<uint64_t>(safeClip) << 32) |
+                          static_cast<uint32_t>(tick);
 
-                // World matrix
-                auto *facings = store.hasFacing() ? &store.facings() : nullptr;
-                glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(pos.x, pos.y, pos.z));
-                
-                if (facings)
+                const auto cached = batch.poseByKey->find(poseKey);
+                if (cached != batch.poseByKey->end())
                 {
-                    const float yaw = (*facings)[row].yaw;
-                    world = glm::rotate(world, yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+                    batch.instancePoses.push_back(cached->second);
+                    continue;
                 }
+            }
 
-                batch.instanceWorlds.emplace_back(world);
+            const uint32_t pose = batch.poseCount++;
+            batch.instancePoses.push_back(pose);
+            if (poseStep > 0.0f)
+                batch.poseByKey->emplace(poseKey, pose);
 
-                const uint32_t safeClip = (!asset->animClips.empty())
-                                              ? std::min(anim.clipIndex, static_cast<uint32_t>(asset->animClips.size() - 1))
-                                              : 0u;
-                const float timeSec = (!asset->animClips.empty() && anim.playing) ? anim.timeSec : 0.0f;
+            m_poseJobs.push_back(PoseJob{batch.slot, safeClip, timeSec, pose, lod > 0});
+        }
 
-                // Node palette for this instance
-                asset->evaluatePoseInto(safeClip, timeSec,
-                                        batch.trsScratch,
-                                        batch.localsScratch,
-                                        batch.globalsScratch,
-                                        batch.visitedScratch);
-                if (batch.globalsScratch.size() == batch.nodeCount)
+        // Exact palette ranges per model, then evaluate every distinct pose into its own slice.
+        for (uint32_t slot : m_activeBatches)
+        {
+            PerModelBatch &batch = m_batches[slot];
+            batch.nodePalette.assign(static_cast<size_t>(batch.poseCount) * batch.renderedCount, Engine::PaletteMatrix::identity());
+            batch.jointPalette.assign(static_cast<size_t>(batch.poseCount) * batch.jointCount, Engine::PaletteMatrix::identity());
+        }
+
+        // Model, clip, then time: each job range sweeps clip time forward, so the key cursors step on
+        // from the previous pose instead of binary searching every channel.
+        std::sort(m_poseJobs.begin(), m_poseJobs.end(), [](const PoseJob &a, const PoseJob &b)
+                  {
+                      if (a.batch != b.batch)
+                          return a.batch < b.batch;
+                      if (a.clip != b.clip)
+                          return a.clip < b.clip;
+                      return a.timeSec < b.timeSec;
+                  });
+
+        m_poseScratch.resize(jobSystem() ? jobSystem()->threadCount() : 1u);
+        Engine::ECS::parallelForRows(jobSystem(), static_cast<uint32_t>(m_poseJobs.size()), kPosesPerJob,
+                                     [&](uint32_t begin, uint32_t end)
+                                     {
+                                         PoseScratch &scratch = m_poseScratch.local();
+                                         for (uint32_t i = begin; i < end; ++i)
+                                         {
+                                             const PoseJob &job = m_poseJobs[i];
+                                             PerModelBatch &batch = m_batches[job.batch];
+                                             evaluatePose(*batch.asset, job, batch.nodeCount, batch.renderedCount, batch.jointCount,
+                                                          batch.nodePalette.data(), batch.jointPalette.data(), scratch);
+                                         }
+                                     });
+        m_poseJobs.clear();
+
+        // One model batch renderer draws every model with instances this frame. It reads the batches'
+        // arrays when it records, so they stay untouched until the next submit().
+        if (!m_pass)
+        {
+            if (m_activeBatches.empty())
+                return;
+            m_pass = std::make_shared<Engine::SModelRenderPassModule>();
+            m_pass->setAssets(m_assets);
+            m_renderer->registerPass(m_pass);
+        }
+        m_pass->clearBatches();
+        for (uint32_t slot : m_activeBatches)
+        {
+            PerModelBatch &batch = m_batches[slot];
+            const auto &worlds = batch.instanceWorlds;
+            if (worlds.empty())
+                continue;
+
+            Engine::SModelRenderPassModule::Batch drawn;
+            drawn.model = batch.handle;
+            drawn.instanceCount = static_cast<uint32_t>(worlds.size());
+
+            const bool gpuRange = gpuInstances && batch.gpuContiguous && batch.gpuFirst != UINT32_MAX;
+            uint32_t counts[Engine::ModelAsset::kMaxMeshLods] = {};
+            if (batch.meshLodCount > 1 || batch.impostorCount > 0)
+            {
+                bucketByMeshLod(batch, gpuRange, counts);
+                if (batch.meshLodCount > 1)
                 {
-                    batch.nodePalette.insert(batch.nodePalette.end(), batch.globalsScratch.begin(), batch.globalsScratch.end());
+                    drawn.lodCounts = counts;
+                    drawn.lodCount = batch.meshLodCount;
                 }
+            }
+            else
+            {
+                m_meshLodCounts[0] += drawn.instanceCount;
+            }
+            drawn.impostorCount = batch.impostorCount;
+            m_impostorCount += batch.impostorCount;
+            if (gpuRange)
+            {
+                drawn.instanceSource = m_crowd->instanceBuffer();
+                drawn.instanceSourceOffset = VkDeviceSize(batch.gpuFirst) * sizeof(glm::mat4);
+            }
+            else
+            {
+                drawn.worlds = worlds.data();
+            }
 
-                // Joint palette for this instance
-                if (batch.jointCount > 0 && batch.globalsScratch.size() == batch.nodeCount)
+            drawn.baked = batch.baked;
+            if (batch.baked)
+            {
+                drawn.poses = batch.bakedPoses.data();
+            }
+            else
+            {
+                drawn.poseIndices = batch.instancePoses.data();
+                drawn.poseCount = batch.poseCount;
+                drawn.nodePalette = batch.nodePalette.data();
+                drawn.nodeCount = batch.renderedCount;
+                if (batch.jointCount > 0 && batch.jointPalette.size() == batch.poseCount * static_cast<size_t>(batch.jointCount))
                 {
-                    batch.jointsScratch.assign(batch.jointCount, glm::mat4(1.0f));
-
-                    for (const auto &skin : asset->skins)
-                    {
-                        if (skin.jointCount == 0)
-                            continue;
-                        for (uint32_t j = 0; j < skin.jointCount; ++j)
-                        {
-                            if (j >= skin.jointNodeIndices.size() || j >= skin.inverseBind.size())
-                                continue;
-
-                            const uint32_t nodeIx = skin.jointNodeIndices[j];
-                            if (nodeIx >= batch.globalsScratch.size())
-                                continue;
-
-                            const uint32_t outIx = skin.jointBase + j;
-                            if (outIx >= batch.jointsScratch.size())
-                                continue;
-
-                            batch.jointsScratch[outIx] = batch.globalsScratch[nodeIx] * skin.inverseBind[j];
-                        }
-                    }
-
-                    batch.jointPalette.insert(batch.jointPalette.end(), batch.jointsScratch.begin(), batch.jointsScratch.end());
+                    drawn.jointPalette = batch.jointPalette.data();
+                    drawn.jointCount = batch.jointCount;
                 }
-
-                (void)asset;
             }
+            m_pass->addBatch(drawn);
         }
+    }
+
+private:
+    // Per-model instances and palettes built by submit(). Kept across frames in m_batches so the
+    // vectors below keep their capacity; reset by beginBatch() on the first instance of a frame.
+    struct PerModelBatch
+    {
+        Engine::ModelHandle handle{};
+        uint32_t slot = 0;        // index in m_batches
+        uint64_t frame = 0;       // last submit() that reset this batch
+
+        std::vector<glm::mat4> instanceWorlds;
+        std::vector<uint8_t> meshLods; // per instance, kCulledMeshLod when kept off screen, kImpostorMeshLod
+        uint32_t meshLodCount = 1;     // ModelAsset::meshLodCount
+        uint32_t impostorCount = 0;    // sorted last by bucketByMeshLod()
+        std::vector<Engine::PaletteMatrix> nodePalette; // flattened: [pose][rendered node]
+        uint32_t nodeCount = 0;                         // all model nodes (pose evaluation)
+        uint32_t renderedCount = 0;                     // ModelAsset::renderedNodes
+
+        std::vector<Engine::PaletteMatrix> jointPalette; // flattened: [pose][joint]
+        uint32_t jointCount = 0;
+
+        // Pose cache: (LOD, clip, quantized time) -> palette entry, and the entry each instance draws.
+        // The cache is rebuilt every frame in m_frameArena (set while the batch is active).
+        std::optional<Engine::ArenaHashMap<uint64_t, uint32_t>> poseByKey;
+        std::vector<uint32_t> instancePoses;
+        uint32_t poseCount = 0;
+        uint32_t culledPose = UINT32_MAX; // entry shared by culled instances kept for a GPU range
+
+        // Baked models: frames each instance draws.
+        bool baked = false;
+        std::vector<Engine::SModelRenderPassModule::InstancePose> bakedPoses;
+
+        const Engine::ModelAsset *asset = nullptr;
+        float lodRadius = 1.0f;  // drawn bounds radius (world units), see boundsRadius()
+        float lodCenterY = 0.0f; // drawn bounds center above the instance origin
+
+        // GPU instance range: valid while every instance continues it.
+        uint32_t gpuFirst = UINT32_MAX;
+        bool gpuContiguous = true;
+    };
+
+    // One distinct pose to evaluate into a model batch's palettes.
+    struct PoseJob
+    {
+        uint32_t batch = 0; // slot in m_batches
+        uint32_t clip = 0;
+        float timeSec = 0.0f;
+        uint32_t pose = 0;
+        bool skipOptional = false; // reduced LOD: optional leaf channels stay at rest
+    };
+
+    // Per-thread evaluation buffers.
+    struct PoseScratch
+    {
+        Engine::ModelAsset::PoseScratch pose;
+        std::vector<glm::mat4> globals;
+        Engine::ModelAsset::KeyCursor cursor;
+    };
+
+    static constexpr uint32_t kPosesPerJob = 32;
+
+    static uint64_t keyFromHandle(const Engine::ModelHandle &h)
+    {
+        return (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id);
+    }
 
-        // Create/update passes for models that have instances this frame.
-        for (auto &kv : batchesByModel)
+    // This frame's batch for a model: found (or created) once per run of instances and reset on
+    // the first use of a frame, which also resolves the asset pointer for the whole frame.
+    PerModelBatch &beginBatch(const Engine::ModelHandle &handle, uint64_t key)
+    {
+        auto found = m_batchSlots.find(key);
+        if (found == m_batchSlots.end())
         {
-            const uint64_t key = kv.first;
-            auto &batch = kv.second;
-            auto &worlds = batch.instanceWorlds;
-            if (worlds.empty())
-                continue;
+            const uint32_t slot = static_cast<uint32_t>(m_batches.size());
+            found = m_batchSlots.emplace(key, slot).first;
+            m_batches.emplace_back();
+            m_batches.back().handle = handle;
+            m_batches.back().slot = slot;
+        }
 
-            const Engine::ModelHandle handle = handleByKey[key];
+        PerModelBatch &batch = m_batches[found->second];
+        if (batch.frame == m_frame)
+            return batch;
+
+        batch.frame = m_frame;
+        m_activeBatches.push_back(batch.slot);
+
+        batch.instanceWorlds.clear();
+        batch.meshLods.clear();
+        batch.impostorCount = 0;
+        batch.poseByKey.emplace(Engine::ArenaAllocator<uint64_t>(&m_frameArena.local()));
+        batch.instancePoses.clear();
+        batch.poseCount = 0;
+        batch.culledPose = UINT32_MAX;
+        batch.bakedPoses.clear();
+        batch.gpuFirst = UINT32_MAX;
+        batch.gpuContiguous = true;
+
+        const Engine::ModelAsset *asset = m_assets->getModel(handle);
+        batch.asset = asset;
+        batch.nodeCount = asset ? static_cast<uint32_t>(asset->nodes.size()) : 0u;
+        batch.renderedCount = asset ? static_cast<uint32_t>(asset->renderedNodes.size()) : 0u;
+        batch.jointCount = asset ? asset->totalJointCount : 0u;
+        batch.baked = asset && m_bakedAnimation && asset->hasBakedAnimation();
+        batch.lodRadius = asset ? boundsRadius(*asset) : 1.0f;
+        batch.lodCenterY = asset ? boundsCenterY(*asset) : 0.0f;
+        batch.meshLodCount = asset ? std::clamp(asset->meshLodCount, 1u, Engine::ModelAsset::kMaxMeshLods) : 1u;
+        return batch;
+    }
+    static constexpr float kLodBasePoseStep = 1.0f / 60.0f; // reduced LOD steps when pose sharing is off
 
-            auto it = m_passes.find(key);
-            if (it == m_passes.end())
-            {
-                auto pass = std::make_shared<Engine::SModelRenderPassModule>();
-                pass->setAssets(m_assets);
-                pass->setModel(handle);
-                pass->setCamera(m_camera);
-                pass->setEnabled(true);
-                m_renderer->registerPass(pass);
-                it = m_passes.emplace(key, std::move(pass)).first;
-            }
+    // Bounds radius as drawn: SModelRenderPassModule scales the model by fitScale.
+    static float boundsRadius(const Engine::ModelAsset &asset)
+    {
+        if (!asset.hasBounds)
+            return 1.0f;
+        const float dx = asset.boundsMax[0] - asset.boundsMin[0];
+        const float dy = asset.boundsMax[1] - asset.boundsMin[1];
+        const float dz = asset.boundsMax[2] - asset.boundsMin[2];
+        return 0.5f * std::sqrt(dx * dx + dy * dy + dz * dz) * asset.fitScale;
+    }
 
-            it->second->setCamera(m_camera);
-            it->second->setEnabled(true);
-            it->second->setInstances(worlds.data(), static_cast<uint32_t>(worlds.size()));
-            it->second->setNodePalette(batch.nodePalette.data(), static_cast<uint32_t>(worlds.size()), batch.nodeCount);
+    // SModelRenderPassModule centers the bounds in XZ and sits their base on the instance origin.
+    static float boundsCenterY(const Engine::ModelAsset &asset)
+    {
+        if (!asset.hasBounds)
+            return 0.0f;
+        return 0.5f * (asset.boundsMax[1] - asset.boundsMin[1]) * asset.fitScale;
+    }
+
+    // Clip-space planes (a, b, c, d) with unit normals, pointing inside: left, right, bottom, top,
+    // near (w + z >= 0, which also holds for Vulkan's 0..1 depth), far.
+    struct FrustumPlanes
+    {
+        float p[6][4];
+    };
 
-            if (batch.jointCount > 0 && batch.jointPalette.size() == worlds.size() * static_cast<size_t>(batch.jointCount))
+    static FrustumPlanes frustumPlanes(const glm::mat4 &m)
+    {
+        FrustumPlanes f{};
+        for (int i = 0; i < 6; ++i)
+        {
+            const int axis = i / 2;
+            const float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+            float len2 = 0.0f;
+            for (int c = 0; c < 4; ++c)
             {
-                it->second->setJointPalette(batch.jointPalette.data(), static_cast<uint32_t>(worlds.size()), batch.jointCount);
+                f.p[i][c] = m[c][3] + sign * m[c][axis];
+                if (c < 3)
+                    len2 += f.p[i][c] * f.p[i][c];
             }
+            const float inv = (len2 > 0.0f) ? 1.0f / std::sqrt(len2) : 0.0f;
+            for (float &v : f.p[i])
+                v *= inv;
         }
+        return f;
+    }
 
-        // Disable passes that have no instances this frame.
-        for (auto &kv : m_passes)
+    static bool sphereVisible(const FrustumPlanes &f, float x, float y, float z, float radius)
+    {
+        for (const auto &pl : f.p)
         {
-            if (batchesByModel.find(kv.first) == batchesByModel.end())
+            if (pl[0] * x + pl[1] * y + pl[2] * z + pl[3] < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    // Fraction of the screen height a sphere of 'radius' at 'pos' covers (large at or behind the eye).
+    static float screenCoverage(const glm::mat4 &viewProj, float projScaleY, const glm::vec3 &pos, float radius)
+    {
+        // Clip-space w of the instance origin (view depth for perspective, 1 for orthographic).
+        const float w = viewProj[0][3] * pos.x + viewProj[1][3] * pos.y + viewProj[2][3] * pos.z + viewProj[3][3];
+        if (w <= 1e-4f)
+            return 1e30f;
+        return radius * projScaleY / w;
+    }
+
+    // 0 = full, 1 = reduced, 2 = crowd.
+    uint32_t chooseLod(float coverage) const
+    {
+        if (!m_lod.enabled)
+            return 0;
+        if (coverage < m_lod.crowdBelow)
+            return 2;
+        return (coverage < m_lod.reducedBelow) ? 1u : 0u;
+    }
+
+    uint32_t chooseMeshLod(float coverage, uint32_t lodCount) const
+    {
+        if (!m_meshLod.enabled)
+            return 0;
+        uint32_t lod = 0;
+        while (lod + 1 < lodCount && coverage < m_meshLod.below[lod])
+            ++lod;
+        return lod;
+    }
+
+    static constexpr uint8_t kCulledMeshLod = 0xFF;
+    static constexpr uint8_t kImpostorMeshLod = 0xFE;
+
+    // Sort a batch's instances by mesh LOD (stable counting sort over worlds and poses), impostors
+    // last, and return the count per LOD. A GPU instance range keeps its order, so it draws at the
+    // finest LOD any of its visible instances needs (it has no impostors).
+    void bucketByMeshLod(PerModelBatch &batch, bool gpuRange, uint32_t counts[Engine::ModelAsset::kMaxMeshLods])
+    {
+        const uint32_t n = static_cast<uint32_t>(batch.instanceWorlds.size());
+        const uint32_t coarsest = batch.meshLodCount - 1;
+        auto lodOf = [&](uint32_t i)
+        {
+            if (batch.meshLods[i] == kImpostorMeshLod)
+                return coarsest + 1;
+            return (batch.meshLods[i] == kCulledMeshLod) ? coarsest : std::min<uint32_t>(batch.meshLods[i], coarsest);
+        };
+
+        if (gpuRange)
+        {
+            uint32_t finest = coarsest;
+            for (uint32_t i = 0; i < n; ++i)
             {
-                kv.second->setEnabled(false);
+                if (batch.meshLods[i] != kCulledMeshLod)
+                    finest = std::min(finest, lodOf(i));
             }
+            counts[finest] = n;
+            m_meshLodCounts[finest] += n;
+            return;
         }
+
+        // One more bucket, after the coarsest LOD, for the impostors.
+        uint32_t buckets[Engine::ModelAsset::kMaxMeshLods + 1] = {};
+        uint32_t first[Engine::ModelAsset::kMaxMeshLods + 1] = {};
+        for (uint32_t i = 0; i < n; ++i)
+            ++buckets[lodOf(i)];
+        for (uint32_t k = 1; k <= coarsest + 1; ++k)
+            first[k] = first[k - 1] + buckets[k - 1];
+        for (uint32_t k = 0; k <= coarsest; ++k)
+        {
+            counts[k] = buckets[k];
+            m_meshLodCounts[k] += counts[k];
+        }
+        if (buckets[0] == n || buckets[coarsest + 1] == n)
+            return; // already in order
+
+        m_sortedWorlds.resize(n);
+        if (batch.baked)
+            m_sortedBakedPoses.resize(n);
+        else
+            m_sortedPoses.resize(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const uint32_t dst = first[lodOf(i)]++;
+            m_sortedWorlds[dst] = batch.instanceWorlds[i];
+            if (batch.baked)
+                m_sortedBakedPoses[dst] = batch.bakedPoses[i];
+            else
+                m_sortedPoses[dst] = batch.instancePoses[i];
+        }
+        batch.instanceWorlds.swap(m_sortedWorlds);
+        if (batch.baked)
+            batch.bakedPoses.swap(m_sortedBakedPoses);
+        else
+            batch.instancePoses.swap(m_sortedPoses);
+    }
+
+    float poseStepForLod(uint32_t lod) const
+    {
+        if (lod == 0)
+            return m_poseTimeStep;
+        const float base = (m_poseTimeStep > 0.0f) ? m_poseTimeStep : kLodBasePoseStep;
+        const float reduced = base * static_cast<float>(std::max(m_lod.reducedSteps, 1u));
+        return (lod == 1) ? reduced : std::max(m_lod.crowdStep, reduced);
+    }
+
+    // Only the rendered nodes' globals go into the node palette; skinned meshes read joints only.
+    static void evaluatePose(const Engine::ModelAsset &asset, const PoseJob &job, uint32_t nodeCount, uint32_t renderedCount,
+                             uint32_t jointCount, Engine::PaletteMatrix *nodePalette, Engine::PaletteMatrix *jointPalette,
+                             PoseScratch &scratch)
+    {
+        asset.evaluatePoseInto(job.clip, job.timeSec, scratch.pose, scratch.globals, &scratch.cursor, job.skipOptional);
+        if (scratch.globals.size() != nodeCount)
+            return;
+
+        if (renderedCount > 0)
+            asset.gatherRenderedNodes(scratch.globals.data(), nodeCount, nodePalette + static_cast<size_t>(job.pose) * renderedCount);
+        if (jointCount > 0)
+            asset.computeJointMatrices(scratch.globals.data(), nodeCount, jointPalette + static_cast<size_t>(job.pose) * jointCount);
     }
 
-private:
     Engine::AssetManager *m_assets = nullptr; // not owned
     Engine::Renderer *m_renderer = nullptr;   // not owned
     Engine::Camera *m_camera = nullptr;       // not owned
-
-    std::unordered_map<uint64_t, std::shared_ptr<Engine::SModelRenderPassModule>> m_passes;
+    Engine::CrowdComputeModule *m_crowd = nullptr; // not owned
+    float m_poseTimeStep = 1.0f / 60.0f;           // see setPoseTimeStep()
+    bool m_bakedAnimation = true;                  // see setBakedAnimation()
+    AnimationLod m_lod;
+    uint32_t m_lodCounts[3] = {};
+    MeshLod m_meshLod;
+    uint32_t m_meshLodCounts[Engine::ModelAsset::kMaxMeshLods] = {};
+    Impostor m_impostor;
+    uint32_t m_impostorCount = 0;
+    bool m_frustumCulling = true;
+    uint32_t m_culledCount = 0;
+
+    std::shared_ptr<Engine::SModelRenderPassModule> m_pass; // every model batch, registered on first use
+    Engine::FrameArena m_frameArena; // submit() scratch; declared before m_batches, which points into it
+    std::vector<PerModelBatch> m_batches;               // persistent, indexed by model slot
+    std::unordered_map<uint64_t, uint32_t> m_batchSlots; // model handle key -> slot in m_batches
+    std::vector<uint32_t> m_activeBatches;              // slots with instances this submit()
+    uint64_t m_frame = 0;
+    std::vector<RenderInstance> m_instances; // scratch for update()
+    std::vector<PoseJob> m_poseJobs;
+    std::vector<glm::mat4> m_sortedWorlds; // bucketByMeshLod() scratch
+    std::vector<uint32_t> m_sortedPoses;
+    std::vector<Engine::SModelRenderPassModule::InstancePose> m_sortedBakedPoses;
+    Engine::WorkerLocal<PoseScratch> m_poseScratch;
 };
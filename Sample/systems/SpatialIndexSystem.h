@@ -3,7 +3,7 @@
   SpatialIndexSystem.h
   --------------------
   Purpose:
-        - Build a spatial hash grid (cellSize = R) of all entities that have Position.
+        - Build a spatial grid (cellSize = R) of all entities that have Position.
         - Uses gameplay world coordinates in meters.
             Ground plane is X/Z (Y is height).
         - Enable fast neighbor lookups by querying only the 3×3 neighborhood of a cell.
@@ -11,63 +11,103 @@
   Usage:
     - Construct the system, setCellSize(R), and call buildMasks(registry) once (requires "Position").
     - Call update(stores, dt) each frame to rebuild the grid.
-    - LocalAvoidanceSystem (or other systems) can call forNeighbors(x, y, fn) to visit candidate neighbors.
+    - setIncremental(true) keeps the grid across frames and only moves entries whose cell changed.
+      Outside SystemScheduler, stamp setLastRunTick(stores.currentTick()) after each update(), or
+      every chunk looks changed.
+    - LocalAvoidanceSystem (or other systems) can call forNeighbors(x, y, fn) to visit candidate neighbors,
+      or forNeighborEntries(x, z, fn) to read their packed position/radius/separation without touching stores.
+      Units larger than R / 2 pass their own reach: forNeighborEntries(x, z, radius + separation, fn).
+    - Queries (picking, target acquisition): queryRadius, queryAABB, raycast (ground-plane pick with per-unit
+      radius), kNearest and queryConvex (marquee / frustum footprint). They read only the cells they cover.
+
+  Levels (mixed unit sizes):
+    - The grid is a hierarchy of kLevels grids with cell sizes R, 2R, 4R, ... Each entity is inserted
+      into exactly one level: the first whose half cell covers its reach (radius + separation); anything
+      larger goes to the top level. Infantry stays in small, sparse cells while siege units and buildings
+      live in coarse ones, instead of one cell size that either misses big neighbors or crowds small ones.
+    - A neighbor query walks every occupied level and scans, per level, the cells within
+      reach + (that level's largest reach) of the point. Two entities can only overlap if their reaches
+      sum past their distance, so no pair is missed, and each entry lives in one level, so each is
+      visited once per query. With only small units (the common case) this is the 3×3 scan of level 0.
+
+  Layout:
+    - Cells are grouped in blocks of kBlockSide × kBlockSide cells. A block is hashed to a slot in a bucket
+      table (power of two, ~2 buckets per entity); the cells of a block occupy consecutive buckets, so a 3×3
+      query usually reads one or two short runs of memory. Each level has its own table.
+    - The table is built by counting sort (CSR): count entities per bucket, prefix-sum, scatter into one
+      contiguous entries array. No per-cell allocations; memory is O(entities) whatever the world extent
+      (the battlefield spans ±10 km).
+
+  Incremental mode:
+    - Every bucket gets some slack past its entries. Each frame, only chunks whose Position changed since
+      the previous run are scanned; a unit whose cell changed is swap-removed from its old bucket and
+      appended to the new one. Idle units cost nothing.
+    - A full bucket is relocated to the end of the entries array with twice the room, so it stays
+      contiguous. Once relocations have doubled the array, the next update compacts it with a rebuild.
+    - Also rebuilds when rows were added/removed/reordered in any indexed store
+      (ArchetypeStore::structureVersion), the cell size changed, or an entity's reach moved it to
+      another level.
 
   Notes:
-    - This is stateless across frames: we rebuild the grid each frame (simple and fast for RTS scales).
-    - The grid stores (storeId, row) pairs so you can access components back in ArchetypeStoreManager.
+    - By default this is stateless across frames: we rebuild the grid each frame (simple and fast for RTS scales).
+    - The grid stores (storeId, row) pairs so you can access components back in ArchetypeStoreManager,
+      next to a copy of x, z, radius and separation taken when the entry was last written.
+    - Distinct blocks may share buckets; entries keep their cell coordinates (in their level's cells) and
+      queries skip foreign cells, so visitors only see entities of the scanned cells, each once.
 */
 
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
-#include <unordered_map>
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <cstdint>
-
-struct GridKey
-{
-    int gx = 0;
-    int gz = 0;
-    bool operator==(const GridKey &o) const noexcept { return gx == o.gx && gz == o.gz; }
-};
-
-struct GridKeyHash
-{
-    std::size_t operator()(const GridKey &k) const noexcept
-    {
-        // 64-bit mix (works fine for typical ranges of grid indices)
-        // Constants are primes often used for 2D hashing.
-        const uint64_t x = static_cast<uint64_t>(static_cast<int64_t>(k.gx));
-        const uint64_t z = static_cast<uint64_t>(static_cast<int64_t>(k.gz));
-        uint64_t h = 1469598103934665603ull; // FNV offset basis
-        h ^= (x * 1099511628211ull);
-        h *= 1469598103934665603ull;
-        h ^= (z * 1099511628211ull);
-        h *= 1469598103934665603ull;
-        return static_cast<std::size_t>(h);
-    }
-};
+#include <limits>
 
 struct GridEntry
 {
     uint32_t storeId; // index into ArchetypeStoreManager::stores()
     uint32_t row;     // row within that store
+    int32_t gx;       // cell coordinates in the entry's level (buckets may be shared by several cells)
+    int32_t gz;
+    float x;          // packed copy of Position x/z, Radius and Separation
+    float z;
+    float radius;     // < 0 when the entity has no Radius
+    float separation; // 0 when the entity has no Separation
 };
 
-struct GridCell
+// Result of SpatialIndexSystem::raycast.
+struct SpatialHit
 {
-    std::vector<GridEntry> entries;
+    GridEntry entry{};
+    float hitX = 0.0f; // ray / ground plane intersection
+    float hitZ = 0.0f;
+    float t = 0.0f;    // ray parameter of the intersection
 };
 
 class SpatialIndexSystem : public Engine::ECS::SystemBase
 {
 public:
+    // Default query filter: accept every entry.
+    struct AcceptAll
+    {
+        bool operator()(const GridEntry &) const { return true; }
+    };
+
+    static constexpr int kBlockShift = 4; // 16×16 cells per block
+    static constexpr int kBlockSide = 1 << kBlockShift;
+    static constexpr uint32_t kBlockCells = uint32_t(kBlockSide * kBlockSide);
+
+    // Grid levels: cell size R << level. The top level takes everything larger.
+    static constexpr uint32_t kLevels = 4;
+
     SpatialIndexSystem(float cellSize = 2.0f) // default R in meters; adjust at runtime as needed
         : m_cellSize(cellSize)
     {
         setRequiredNames({"Position"}); // we index any entity that has Position
         // You may set excluded tags if desired: setExcludedNames({"Disabled","Dead"});
+        setReadNames({"Position", "Radius", "Separation"});
+        setWriteNames({"SpatialGrid"});
     }
 
     const char *name() const override { return "SpatialIndexSystem"; }
@@ -75,79 +115,672 @@ public:
     void setCellSize(float cellSize) { m_cellSize = (cellSize > 1e-6f) ? cellSize : 1e-6f; }
     float getCellSize() const { return m_cellSize; }
 
-    // Rebuild the spatial hash grid for all entities with Position
+    void setIncremental(bool incremental)
+    {
+        m_incremental = incremental;
+        m_indexedStores.clear(); // force a rebuild with the matching bucket slack
+    }
+    bool isIncremental() const { return m_incremental; }
+
+    // Level an entity of this radius/separation is indexed in.
+    uint32_t levelFor(float radius, float separation) const
+    {
+        const float reach = std::max(radius, 0.0f) + separation;
+        uint32_t level = 0;
+        float half = 0.5f * m_cellSize;
+        while (level + 1 < kLevels && reach > half)
+        {
+            ++level;
+            half *= 2.0f;
+        }
+        return level;
+    }
+
+    // Rebuild (or, in incremental mode, patch) the grid for all entities with Position
     void update(Engine::ECS::ArchetypeStoreManager &mgr, float /*dt*/) override
     {
-        // Clear grid but keep capacity to minimize allocations
-        for (auto &kv : m_grid)
-            kv.second.entries.clear();
-        // Optional: if entity count changes wildly, you can occasionally m_grid.clear()
+        m_scannedChunks = 0;
+        if (!m_incremental || !layoutUnchanged(mgr))
+        {
+            rebuild(mgr);
+            return;
+        }
 
-        // Iterate stores with Position
-        uint32_t sid = 0;
-        for (const auto &ptr : mgr.stores())
+        for (uint32_t sid : m_indexedStores)
         {
-            if (!ptr)
+            const auto &store = *mgr.get(sid);
+            const PackSource src(store);
+            const std::vector<uint32_t> &rowEntry = m_rowEntry[sid];
+
+            for (uint32_t chunk = 0; chunk < store.chunkCount(); ++chunk)
             {
-                ++sid;
-                continue;
+                if (!chunkChanged<Engine::ECS::Position>(store, chunk) &&
+                    !chunkChanged<Engine::ECS::Radius>(store, chunk) &&
+                    !chunkChanged<Engine::ECS::Separation>(store, chunk))
+                    continue;
+                ++m_scannedChunks;
+                const uint32_t end = store.chunkRowEnd(chunk);
+                for (uint32_t row = store.chunkRowBegin(chunk); row < end; ++row)
+                {
+                    const uint32_t ref = rowEntry[row];
+                    uint32_t levelIndex = 0;
+                    const GridEntry updated = makeEntry(src, sid, row, levelIndex);
+                    if (levelIndex != refLevel(ref))
+                    {
+                        rebuild(mgr); // reach changed enough to switch levels
+                        return;
+                    }
+                    Level &level = m_levels[levelIndex];
+                    GridEntry &e = level.entries[refIndex(ref)];
+                    if (e.gx == updated.gx && e.gz == updated.gz)
+                    {
+                        e = updated; // same cell: refresh the packed copy in place
+                        track(level, updated);
+                        continue;
+                    }
+                    if (!moveEntry(levelIndex, refIndex(ref), updated))
+                    {
+                        rebuild(mgr);
+                        return;
+                    }
+                }
             }
-            const auto &store = *ptr;
+        }
+    }
+
+    // Visit candidate neighbors around (x,z): we scan the 3×3 neighborhood (cell, plus its 8 adjacent cells)
+    // of level 0, and the matching cells of any coarser level.
+    // Visitor signature: void(uint32_t storeId, uint32_t row)
+    template <typename Visitor>
+    void forNeighbors(float x, float z, Visitor &&visit) const
+    {
+        forNeighborEntries(x, z, [&](const GridEntry &e)
+                           { visit(e.storeId, e.row); });
+    }
+
+    // Same neighborhood, visiting the packed entries. Read-only, so safe from several threads at once.
+    // Visitor signature: void(const GridEntry &entry)
+    template <typename Visitor>
+    void forNeighborEntries(float x, float z, Visitor &&visit) const
+    {
+        forNeighborEntries(x, z, 0.5f * m_cellSize, std::forward<Visitor>(visit));
+    }
+
+    // Candidates that can overlap a querier of reach 'reach' (radius + separation) at (x, z): every
+    // entry within reach + its own reach, from every level, each visited once.
+    template <typename Visitor>
+    void forNeighborEntries(float x, float z, float reach, Visitor &&visit) const
+    {
+        for (const Level &level : m_levels)
+        {
+            if (level.entries.empty())
+                continue;
+            const float r = std::max(reach, 0.0f) + std::max(0.5f * level.cellSize, level.maxReach);
+            forCellRange(level, cellCoord(level, x - r), cellCoord(level, z - r),
+                         cellCoord(level, x + r), cellCoord(level, z + r), visit);
+        }
+    }
+
+    // Every entry whose center lies within 'radius' of (x, z).
+    // Visitor signature: void(const GridEntry &entry)
+    template <typename Visitor>
+    void queryRadius(float x, float z, float radius, Visitor &&visit) const
+    {
+        const float r2 = radius * radius;
+        for (const Level &level : m_levels)
+            forCellRange(level, cellCoord(level, x - radius), cellCoord(level, z - radius),
+                         cellCoord(level, x + radius), cellCoord(level, z + radius),
+                         [&](const GridEntry &e)
+                         {
+                             const float dx = e.x - x;
+                             const float dz = e.z - z;
+                             if (dx * dx + dz * dz <= r2)
+                                 visit(e);
+                         });
+    }
+
+    // Every entry whose center lies in [minX, maxX] × [minZ, maxZ].
+    template <typename Visitor>
+    void queryAABB(float minX, float minZ, float maxX, float maxZ, Visitor &&visit) const
+    {
+        for (const Level &level : m_levels)
+            forCellRange(level, cellCoord(level, minX), cellCoord(level, minZ), cellCoord(level, maxX), cellCoord(level, maxZ),
+                         [&](const GridEntry &e)
+                         {
+                             if (e.x >= minX && e.x <= maxX && e.z >= minZ && e.z <= maxZ)
+                                 visit(e);
+                         });
+    }
+
+    // Every entry whose center lies inside a convex polygon on the ground plane (count x/z pairs in 'xz',
+    // either winding), e.g. a selection frustum's footprint. Cells entirely inside are taken whole
+    // without per-entry tests; only entries of cells crossing the boundary are tested.
+    template <typename Visitor>
+    void queryConvex(const float *xz, uint32_t count, Visitor &&visit) const
+    {
+        if (count < 3)
+            return;
+
+        float area = 0.0f;
+        float minX = xz[0], maxX = xz[0], minZ = xz[1], maxZ = xz[1];
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t j = (i + 1) % count;
+            area += xz[2 * i] * xz[2 * j + 1] - xz[2 * j] * xz[2 * i + 1];
+            minX = std::min(minX, xz[2 * i]);
+            maxX = std::max(maxX, xz[2 * i]);
+            minZ = std::min(minZ, xz[2 * i + 1]);
+            maxZ = std::max(maxZ, xz[2 * i + 1]);
+        }
+        const float winding = (area >= 0.0f) ? 1.0f : -1.0f;
+
+        // Signed distance-like value of (px, pz) against edge i: >= 0 means on the inner side.
+        auto edgeSide = [&](uint32_t i, float px, float pz)
+        {
+            const uint32_t j = (i + 1) % count;
+            const float ex = xz[2 * j] - xz[2 * i];
+            const float ez = xz[2 * j + 1] - xz[2 * i + 1];
+            return winding * (ex * (pz - xz[2 * i + 1]) - ez * (px - xz[2 * i]));
+        };
+        auto inside = [&](float px, float pz)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                if (edgeSide(i, px, pz) < 0.0f)
+                    return false;
+            return true;
+        };
+        auto test = [&](const GridEntry &e)
+        {
+            if (inside(e.x, e.z))
+                visit(e);
+        };
+
+        for (const Level &level : m_levels)
+        {
+            if (level.entries.empty())
+                continue;
 
-            if (!store.signature().containsAll(required()))
+            int gx0 = std::max(cellCoord(level, minX), level.minGx), gx1 = std::min(cellCoord(level, maxX), level.maxGx);
+            int gz0 = std::max(cellCoord(level, minZ), level.minGz), gz1 = std::min(cellCoord(level, maxZ), level.maxGz);
+            if (gx0 > gx1 || gz0 > gz1)
+                continue;
+            if (uint64_t(gx1 - gx0 + 1) * uint64_t(gz1 - gz0 + 1) > level.bucketCount())
             {
-                ++sid;
+                forCellRange(level, gx0, gz0, gx1, gz1, test);
                 continue;
             }
-            if (!store.signature().containsNone(excluded()))
+
+            const float cs = level.cellSize;
+            for (int gz = gz0; gz <= gz1; ++gz)
+            {
+                for (int gx = gx0; gx <= gx1; ++gx)
+                {
+                    const float cx[4] = {gx * cs, (gx + 1) * cs, (gx + 1) * cs, gx * cs};
+                    const float cz[4] = {gz * cs, gz * cs, (gz + 1) * cs, (gz + 1) * cs};
+
+                    // Whole cell inside (all corners on the inner side of every edge), or entirely outside
+                    // one edge; anything else is a boundary cell.
+                    bool whole = true, outside = false;
+                    for (uint32_t i = 0; i < count && !outside; ++i)
+                    {
+                        uint32_t in = 0;
+                        for (int c = 0; c < 4; ++c)
+                            in += edgeSide(i, cx[c], cz[c]) >= 0.0f ? 1u : 0u;
+                        whole = whole && in == 4;
+                        outside = in == 0;
+                    }
+                    if (outside)
+                        continue;
+                    if (whole)
+                        forCell(level, gx, gz, visit);
+                    else
+                        forCell(level, gx, gz, test);
+                }
+            }
+        }
+    }
+
+    // Ground-plane pick: intersect the ray origin + t * dir (t > 0) with y = groundY, then return the
+    // accepted unit whose footprint (radius + padding) contains the hit point, preferring the unit whose
+    // edge is nearest (dist - radius). Entries without Radius count as radius 0.
+    // hit.hitX/hitZ/t are filled whenever the ray reaches the ground (t stays 0 otherwise), so a miss
+    // still reports the ground point.
+    template <typename Filter = AcceptAll>
+    bool raycast(float ox, float oy, float oz, float dx, float dy, float dz,
+                 float groundY, float padding, SpatialHit &hit, Filter &&accept = Filter{}) const
+    {
+        if (std::abs(dy) <= 1e-6f)
+            return false;
+        const float t = (groundY - oy) / dy;
+        if (t <= 0.0f)
+            return false;
+        const float hx = ox + t * dx;
+        const float hz = oz + t * dz;
+        hit.hitX = hx;
+        hit.hitZ = hz;
+        hit.t = t;
+
+        float best = std::numeric_limits<float>::infinity();
+        queryRadius(hx, hz, maxRadius() + padding, [&](const GridEntry &e)
+                    {
+            const float radius = std::max(e.radius, 0.0f);
+            const float ex = e.x - hx;
+            const float ez = e.z - hz;
+            const float edge = std::sqrt(ex * ex + ez * ez) - radius;
+            if (edge <= padding && edge < best && accept(e))
             {
-                ++sid;
+                best = edge;
+                hit.entry = e;
+            } });
+        return best != std::numeric_limits<float>::infinity();
+    }
+
+    // The k accepted entries nearest to (x, z) within maxRadius, nearest first, written to 'out'.
+    // Searches rings of cells outward (per level) and stops once no unvisited cell can hold a closer entry.
+    template <typename Filter = AcceptAll>
+    void kNearest(float x, float z, uint32_t k, std::vector<GridEntry> &out,
+                  float maxRadius = std::numeric_limits<float>::infinity(), Filter &&accept = Filter{}) const
+    {
+        out.clear();
+        if (k == 0)
+            return;
+
+        // (distance^2, entry) kept as a max-heap of the best k, shared by all levels.
+        std::vector<std::pair<float, GridEntry>> best;
+        auto farther = [](const std::pair<float, GridEntry> &a, const std::pair<float, GridEntry> &b)
+        { return a.first < b.first; };
+
+        const float maxR2 = maxRadius * maxRadius;
+        auto consider = [&](const GridEntry &e)
+        {
+            const float ex = e.x - x;
+            const float ez = e.z - z;
+            const float d2 = ex * ex + ez * ez;
+            if (d2 > maxR2 || (best.size() == k && d2 >= best.front().first) || !accept(e))
+                return;
+            if (best.size() == k)
+            {
+                std::pop_heap(best.begin(), best.end(), farther);
+                best.pop_back();
+            }
+            best.emplace_back(d2, e);
+            std::push_heap(best.begin(), best.end(), farther);
+        };
+
+        for (const Level &level : m_levels)
+        {
+            if (level.entries.empty())
                 continue;
+
+            const int gx = cellCoord(level, x);
+            const int gz = cellCoord(level, z);
+            const int maxRing = std::max({gx - level.minGx, level.maxGx - gx, gz - level.minGz, level.maxGz - gz});
+            for (int ring = 0; ring <= maxRing; ++ring)
+            {
+                // Every cell of this ring is at least (ring - 1) cells from (x, z).
+                const float ringDist = static_cast<float>(ring - 1) * level.cellSize;
+                if (ring > 0 && ringDist > 0.0f &&
+                    (ringDist * ringDist > maxR2 || (best.size() == k && ringDist * ringDist >= best.front().first)))
+                    break;
+
+                // Wide rings (sparse world, strict filter): finish with one pass over every bucket.
+                if (uint64_t(2 * ring + 1) * uint64_t(2 * ring + 1) > level.bucketCount())
+                {
+                    for (uint32_t b = 0; b < level.bucketCount(); ++b)
+                        for (uint32_t i = level.bucketStart[b]; i < level.bucketEnd[b]; ++i)
+                        {
+                            const GridEntry &e = level.entries[i];
+                            if (std::max(std::abs(e.gx - gx), std::abs(e.gz - gz)) >= ring)
+                                consider(e);
+                        }
+                    break;
+                }
+                for (int cx = gx - ring; cx <= gx + ring; ++cx)
+                {
+                    forCell(level, cx, gz - ring, consider);
+                    if (ring > 0)
+                        forCell(level, cx, gz + ring, consider);
+                }
+                for (int cz = gz - ring + 1; cz <= gz + ring - 1; ++cz)
+                {
+                    forCell(level, gx - ring, cz, consider);
+                    forCell(level, gx + ring, cz, consider);
+                }
             }
+        }
 
-            const auto &positions = store.positions();
-            const uint32_t n = store.size();
+        std::sort_heap(best.begin(), best.end(), farther);
+        out.reserve(best.size());
+        for (const auto &b : best)
+            out.push_back(b.second);
+    }
+
+    // Indexed entries of one level, grouped by bucket (for debug views / stats). In incremental mode the
+    // array also holds the unused slack slots between buckets.
+    const std::vector<GridEntry> &entries(uint32_t level = 0) const { return m_levels[level].entries; }
+    uint32_t bucketCount(uint32_t level = 0) const { return m_levels[level].bucketCount(); }
+    // Chunks the last update() read rows from (all of them for a rebuild)
+    uint32_t scannedChunks() const { return m_scannedChunks; }
+    float levelCellSize(uint32_t level) const { return m_cellSize * float(1u << level); }
+
+private:
+    // One grid of the hierarchy.
+    struct Level
+    {
+        float cellSize = 1.0f;
+        uint32_t bucketMask = 0;
+        std::vector<uint32_t> bucketStart; // first slot of each bucket in entries (+1 sentinel after a rebuild)
+        std::vector<uint32_t> bucketEnd;   // one past the last used slot of each bucket
+        std::vector<uint32_t> bucketCap;   // one past the last reserved slot of each bucket
+        std::vector<GridEntry> entries;    // CSR payload, grouped by bucket
+        uint32_t compactSize = 0;          // entries size right after the last rebuild
+
+        // Query bounds: occupied cell extent and largest reach (radius + separation).
+        int minGx = 0, maxGx = -1;
+        int minGz = 0, maxGz = -1;
+        float maxReach = 0.0f;
+
+        uint32_t bucketCount() const { return bucketMask + 1; }
+    };
 
-            // Reserve a bit for typical occupancy of cells if you know it; otherwise skip.
+    // m_rowEntry values: level in the top bits, entry index below.
+    static constexpr uint32_t kLevelShift = 30;
+    static_assert(kLevels <= (1u << (32 - kLevelShift)), "level must fit the row reference");
+    static uint32_t makeRef(uint32_t level, uint32_t index) { return (level << kLevelShift) | index; }
+    static uint32_t refLevel(uint32_t ref) { return ref >> kLevelShift; }
+    static uint32_t refIndex(uint32_t ref) { return ref & ((1u << kLevelShift) - 1u); }
+
+    void rebuild(Engine::ECS::ArchetypeStoreManager &mgr)
+    {
+        const auto &stores = matchingStores(mgr);
+
+        uint32_t total = 0;
+        for (uint32_t sid : stores)
+        {
+            total += mgr.get(sid)->size();
+            m_scannedChunks += mgr.get(sid)->chunkCount();
+        }
+
+        // Pass 1: level and cell per entity
+        m_pending.clear();
+        m_pendingLevel.clear();
+        m_pending.reserve(total);
+        m_pendingLevel.reserve(total);
+        uint32_t perLevel[kLevels] = {};
+        for (uint32_t sid : stores)
+        {
+            const auto &store = *mgr.get(sid);
+
+            const PackSource src(store);
+            const uint32_t n = store.size();
             for (uint32_t row = 0; row < n; ++row)
             {
-                const auto &p = positions[row];
-                const int gx = static_cast<int>(std::floor(p.x / m_cellSize));
-                const int gz = static_cast<int>(std::floor(p.z / m_cellSize));
-                GridKey key{gx, gz};
-                auto &cell = m_grid[key]; // creates if missing
-                cell.entries.push_back(GridEntry{sid, row});
+                uint32_t level = 0;
+                m_pending.push_back(makeEntry(src, sid, row, level));
+                m_pendingLevel.push_back(static_cast<uint8_t>(level));
+                ++perLevel[level];
+            }
+        }
+
+        m_maxRadius = 0.0f;
+        for (uint32_t l = 0; l < kLevels; ++l)
+        {
+            Level &level = m_levels[l];
+            level.cellSize = levelCellSize(l);
+            level.minGx = level.minGz = std::numeric_limits<int>::max();
+            level.maxGx = level.maxGz = std::numeric_limits<int>::min();
+            level.maxReach = 0.0f;
+            if (perLevel[l] == 0 && l > 0)
+            {
+                // Unused level: one empty bucket, so lookups stay valid.
+                level.bucketMask = 0;
+                level.bucketStart.assign(2, 0u);
+                level.bucketEnd.assign(1, 0u);
+                level.bucketCap.assign(1, 0u);
+                level.entries.clear();
+                level.compactSize = 0;
+                continue;
+            }
+
+            uint32_t buckets = kBlockCells;
+            while (buckets < 2u * perLevel[l])
+                buckets <<= 1;
+            level.bucketMask = buckets - 1;
+            level.bucketStart.assign(buckets + 1, 0u);
+        }
+
+        // Counts per bucket
+        for (size_t i = 0; i < m_pending.size(); ++i)
+        {
+            Level &level = m_levels[m_pendingLevel[i]];
+            ++level.bucketStart[bucketOf(level, m_pending[i].gx, m_pending[i].gz)];
+        }
+
+        // Exclusive prefix sum over counts (plus slack): bucketStart[b] = begin of bucket b
+        for (uint32_t l = 0; l < kLevels; ++l)
+        {
+            Level &level = m_levels[l];
+            if (perLevel[l] == 0 && l > 0)
+                continue;
+            const uint32_t buckets = level.bucketCount();
+            uint32_t offset = 0;
+            for (uint32_t b = 0; b < buckets; ++b)
+            {
+                const uint32_t count = level.bucketStart[b];
+                level.bucketStart[b] = offset;
+                offset += count + (m_incremental ? count / 4u : 0u);
             }
+            level.bucketStart[buckets] = offset;
+            level.bucketEnd.assign(level.bucketStart.begin(), level.bucketStart.end() - 1);
+            level.bucketCap.assign(level.bucketStart.begin() + 1, level.bucketStart.end());
+            level.compactSize = offset;
+            level.entries.resize(offset);
+        }
 
-            ++sid;
+        // Pass 2: scatter; entries within a bucket stay in store/row order.
+        for (size_t i = 0; i < m_pending.size(); ++i)
+        {
+            Level &level = m_levels[m_pendingLevel[i]];
+            const GridEntry &e = m_pending[i];
+            level.entries[level.bucketEnd[bucketOf(level, e.gx, e.gz)]++] = e;
+            track(level, e);
+        }
+
+        // Remember where each row lives, and the store layout this index was built against.
+        m_indexedStores.clear();
+        m_indexedVersions.clear();
+        m_indexedCellSize = m_cellSize;
+        if (!m_incremental)
+            return;
+        for (uint32_t sid : stores)
+        {
+            m_indexedStores.push_back(sid);
+            m_indexedVersions.push_back(mgr.get(sid)->structureVersion());
+            if (m_rowEntry.size() <= sid)
+                m_rowEntry.resize(sid + 1);
+            m_rowEntry[sid].resize(mgr.get(sid)->size());
+        }
+        for (uint32_t l = 0; l < kLevels; ++l)
+        {
+            const Level &level = m_levels[l];
+            for (uint32_t b = 0; b < level.bucketCount(); ++b)
+                for (uint32_t i = level.bucketStart[b]; i < level.bucketEnd[b]; ++i)
+                    m_rowEntry[level.entries[i].storeId][level.entries[i].row] = makeRef(l, i);
         }
     }
 
-    // Visit candidate neighbors around (x,z): we scan the 3×3 neighborhood (cell, plus its 8 adjacent cells).
-    // Visitor signature: void(uint32_t storeId, uint32_t row)
-    template <typename Visitor>
-    void forNeighbors(float x, float z, Visitor &&visit) const
+    bool layoutUnchanged(Engine::ECS::ArchetypeStoreManager &mgr)
+    {
+        const auto &stores = matchingStores(mgr);
+        if (m_indexedCellSize != m_cellSize || stores != m_indexedStores)
+            return false;
+        for (size_t i = 0; i < stores.size(); ++i)
+            if (mgr.get(stores[i])->structureVersion() != m_indexedVersions[i])
+                return false;
+        return true;
+    }
+
+    // Columns packed into each entry of one store (Radius/Separation views are invalid when absent).
+    struct PackSource
+    {
+        explicit PackSource(const Engine::ECS::ArchetypeStore &store)
+            : positions(store.positions()), radii(store.radii()), separations(store.separations())
+        {
+        }
+        Engine::ECS::ColumnView<const Engine::ECS::Position> positions;
+        Engine::ECS::ColumnView<const Engine::ECS::Radius> radii;
+        Engine::ECS::ColumnView<const Engine::ECS::Separation> separations;
+    };
+
+    GridEntry makeEntry(const PackSource &src, uint32_t sid, uint32_t row, uint32_t &level) const
+    {
+        const Engine::ECS::Position p = src.positions[row];
+        GridEntry e{sid, row, 0, 0, p.x, p.z, -1.0f, 0.0f};
+        if (src.radii.valid())
+            e.radius = src.radii[row].r;
+        if (src.separations.valid())
+            e.separation = src.separations[row].value;
+        level = levelFor(e.radius, e.separation);
+        const float cellSize = levelCellSize(level);
+        e.gx = static_cast<int>(std::floor(p.x / cellSize));
+        e.gz = static_cast<int>(std::floor(p.z / cellSize));
+        return e;
+    }
+
+    // Move the entry at 'index' of 'levelIndex' to the cell of 'updated'. Returns false once the array
+    // needs compacting.
+    bool moveEntry(uint32_t levelIndex, uint32_t index, const GridEntry &updated)
     {
-        const int gx = static_cast<int>(std::floor(x / m_cellSize));
-        const int gz = static_cast<int>(std::floor(z / m_cellSize));
-        for (int dx = -1; dx <= 1; ++dx)
+        Level &level = m_levels[levelIndex];
+        const GridEntry e = level.entries[index];
+        const uint32_t from = bucketOf(level, e.gx, e.gz);
+        const uint32_t to = bucketOf(level, updated.gx, updated.gz);
+        if (from != to)
         {
-            for (int dy = -1; dy <= 1; ++dy)
+            if (level.bucketEnd[to] == level.bucketCap[to] && !growBucket(levelIndex, to))
+                return false;
+
+            // Swap-remove from the old bucket, append to the new one.
+            const uint32_t last = --level.bucketEnd[from];
+            if (last != index)
             {
-                const GridKey key{gx + dx, gz + dy};
-                auto it = m_grid.find(key);
-                if (it == m_grid.end())
-                    continue;
-                for (const auto &e : it->second.entries)
-                    visit(e.storeId, e.row);
+                level.entries[index] = level.entries[last];
+                m_rowEntry[level.entries[index].storeId][level.entries[index].row] = makeRef(levelIndex, index);
             }
+            index = level.bucketEnd[to]++;
+            m_rowEntry[e.storeId][e.row] = makeRef(levelIndex, index);
         }
+        level.entries[index] = updated;
+        track(level, updated);
+        return true;
     }
 
-    // Optional: expose direct cell access if needed
-    const std::unordered_map<GridKey, GridCell, GridKeyHash> &grid() const { return m_grid; }
+    // Grow the query bounds (cell extent, largest radius/reach) to cover 'e'. Bounds never shrink between
+    // rebuilds, which only makes queries scan a little more.
+    void track(Level &level, const GridEntry &e)
+    {
+        level.minGx = std::min(level.minGx, e.gx);
+        level.maxGx = std::max(level.maxGx, e.gx);
+        level.minGz = std::min(level.minGz, e.gz);
+        level.maxGz = std::max(level.maxGz, e.gz);
+        level.maxReach = std::max(level.maxReach, std::max(e.radius, 0.0f) + e.separation);
+        m_maxRadius = std::max(m_maxRadius, e.radius);
+    }
 
-private:
-    float m_cellSize; // equals neighbor radius R
-    std::unordered_map<GridKey, GridCell, GridKeyHash> m_grid;
-};
\ No newline at end of file
+    float maxRadius() const { return m_maxRadius; }
+
+    // Entries of exactly cell (gx, gz) of one level.
+    template <typename Visitor>
+    static void forCell(const Level &level, int gx, int gz, Visitor &&visit)
+    {
+        const uint32_t b = bucketOf(level, gx, gz);
+        const uint32_t end = level.bucketEnd[b];
+        for (uint32_t i = level.bucketStart[b]; i < end; ++i)
+        {
+            const GridEntry &e = level.entries[i];
+            if (e.gx == gx && e.gz == gz)
+                visit(e);
+        }
+    }
+
+    // Entries of every cell in [gx0, gx1] × [gz0, gz1] of one level (clipped to the occupied extent).
+    // Large ranges fall back to one pass over all buckets.
+    template <typename Visitor>
+    static void forCellRange(const Level &level, int gx0, int gz0, int gx1, int gz1, Visitor &&visit)
+    {
+        if (level.entries.empty())
+            return;
+        gx0 = std::max(gx0, level.minGx);
+        gz0 = std::max(gz0, level.minGz);
+        gx1 = std::min(gx1, level.maxGx);
+        gz1 = std::min(gz1, level.maxGz);
+        if (gx0 > gx1 || gz0 > gz1)
+            return;
+
+        const uint64_t cells = uint64_t(gx1 - gx0 + 1) * uint64_t(gz1 - gz0 + 1);
+        if (cells > level.bucketCount())
+        {
+            for (uint32_t b = 0; b < level.bucketCount(); ++b)
+                for (uint32_t i = level.bucketStart[b]; i < level.bucketEnd[b]; ++i)
+                {
+                    const GridEntry &e = level.entries[i];
+                    if (e.gx >= gx0 && e.gx <= gx1 && e.gz >= gz0 && e.gz <= gz1)
+                        visit(e);
+                }
+            return;
+        }
+        for (int gz = gz0; gz <= gz1; ++gz)
+            for (int gx = gx0; gx <= gx1; ++gx)
+                forCell(level, gx, gz, visit);
+    }
+
+    // Relocate bucket 'b' of a level to the end of its entries with twice its capacity (at least 4 slots).
+    bool growBucket(uint32_t levelIndex, uint32_t b)
+    {
+        Level &level = m_levels[levelIndex];
+        const uint32_t count = level.bucketEnd[b] - level.bucketStart[b];
+        const uint32_t capacity = std::max(4u, 2u * (level.bucketCap[b] - level.bucketStart[b]));
+        const uint32_t start = static_cast<uint32_t>(level.entries.size());
+        if (start + capacity > 2u * level.compactSize + kBlockCells)
+            return false;
+
+        level.entries.resize(start + capacity);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const GridEntry &moved = level.entries[start + i] = level.entries[level.bucketStart[b] + i];
+            m_rowEntry[moved.storeId][moved.row] = makeRef(levelIndex, start + i);
+        }
+        level.bucketStart[b] = start;
+        level.bucketEnd[b] = start + count;
+        level.bucketCap[b] = start + capacity;
+        return true;
+    }
+
+    static int cellCoord(const Level &level, float v) { return static_cast<int>(std::floor(v / level.cellSize)); }
+
+    // Block hash in the high bits, cell within the block in the low kBlockShift*2 bits.
+    static uint32_t bucketOf(const Level &level, int gx, int gz)
+    {
+        const uint32_t bx = static_cast<uint32_t>(gx >> kBlockShift);
+        const uint32_t bz = static_cast<uint32_t>(gz >> kBlockShift);
+        const uint32_t local = (static_cast<uint32_t>(gx) & (kBlockSide - 1)) |
+                               ((static_cast<uint32_t>(gz) & (kBlockSide - 1)) << kBlockShift);
+        const uint32_t block = (bx * 73856093u) ^ (bz * 19349663u);
+        return ((block << (2 * kBlockShift)) | local) & level.bucketMask;
+    }
+
+    float m_cellSize; // equals neighbor radius R (level 0)
+    bool m_incremental = false;
+    Level m_levels[kLevels];
+    std::vector<GridEntry> m_pending;    // scratch: entries in store/row order
+    std::vector<uint8_t> m_pendingLevel; // scratch: level of each pending entry
+
+    // Incremental mode: row -> (level, entry index) per store, and the store layout the index was built against.
+    std::vector<std::vector<uint32_t>> m_rowEntry;
+    std::vector<uint32_t> m_indexedStores;
+    std::vector<uint32_t> m_indexedVersions;
+    float m_indexedCellSize = 0.0f;
+
+    float m_maxRadius = 0.0f; // largest entry radius over all levels (raycast search radius)
+    uint32_t m_scannedChunks = 0;
+};
@@ -1,9 +1,13 @@
 #pragma once
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
+#include "systems/FlowFieldSystem.h"
+#include "utils/Log.h"
+#include "utils/SimdKernels.h"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <cstdint>
+#include <vector>
 
 class SteeringSystem : public Engine::ECS::SystemBase
 {
@@ -13,103 +17,185 @@ public:
         // Position + Velocity + MoveTarget + MoveSpeed required
         setRequiredNames({"Position", "Velocity", "MoveTarget", "MoveSpeed"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "MoveSpeed", "Moving"});
+        setWriteNames({"Velocity", "MoveTarget", "Facing"});
     }
 
     const char *name() const override { return "SteeringSystem"; }
 
-    void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
-        auto clamp = [](float v, float a, float b)
-        { return std::max(a, std::min(v, b)); };
-        auto len2 = [](float x, float z)
-        { return std::sqrt(x * x + z * z); };
+        Engine::ECS::SystemBase::buildMasks(registry);
+        // Only rows in the active set ("Moving" row tag) are steered; units leave it on arrival.
+        m_movingId = registry.ensureId("Moving");
+        m_activeRequired = required();
+        m_activeRequired.set(m_movingId);
+    }
+
+    // Optional: follow the shared flow field of a unit's order instead of a straight line.
+    void setFlowFields(const FlowFieldSystem *flow) { m_flow = flow; }
+
+    // Rows handed to one job by forEachChunk.
+    static constexpr uint32_t kRowsPerJob = 1024;
+
+    // Active rows gathered per SIMD batch (stack scratch: 7 arrays of this size).
+    static constexpr uint32_t kBatch = 256;
+
+    // Meters past the arrival radius still counted as arrived.
+    static constexpr float kArrivalSlack = 1e-3f;
 
+    void update(Engine::ECS::ArchetypeStoreManager &mgr, float dt) override
+    {
         // Gameplay uses meters; stop once we're within a small radius.
         const float arrivalRadius = 1.0f;  // Increased from 0.25 for easier stopping
         // Snappy stop: no long slowdown phase.
         // We'll keep full speed, but clamp the final step so we hit the arrival radius cleanly.
 
-        for (const auto &ptr : mgr.stores())
+        for (uint32_t storeId : matchingStores(mgr))
         {
-            if (!ptr)
-                continue;
-            auto &store = *ptr;
-
-            if (!store.signature().containsAll(required()))
-                continue;
-            if (!store.signature().containsNone(excluded()))
-                continue;
+            auto &store = *mgr.get(storeId);
 
             // Accessors: positions, velocities, moveTargets, moveSpeeds
-            auto &positions = const_cast<std::vector<Engine::ECS::Position> &>(store.positions());
-            auto &velocities = const_cast<std::vector<Engine::ECS::Velocity> &>(store.velocities());
-
-            // You'll add these to ArchetypeStore once you wire MoveTarget/MoveSpeed there:
-            auto &targets = const_cast<std::vector<Engine::ECS::MoveTarget> &>(store.moveTargets());
-            auto &speeds = const_cast<std::vector<Engine::ECS::MoveSpeed> &>(store.moveSpeeds());
-
-            auto *facings = store.hasFacing() ? &const_cast<std::vector<Engine::ECS::Facing> &>(store.facings()) : nullptr;
-
-            const auto &masks = store.rowMasks();
-            const uint32_t n = store.size();
-
-            for (uint32_t i = 0; i < n; ++i)
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            auto targets = store.moveTargets();
+            auto speeds = store.moveSpeeds();
+
+            auto facings = store.facings(); // invalid view when absent
+            const auto owners = store.entities();
+            Engine::ECS::CommandBuffer *cmds = commandBuffer();
+
+            // Rows added or moved since we last looked (spawns, snapshot loads) may carry an active
+            // target without the tag: enroll them once per structural change.
+            if (storeId >= m_seenVersion.size())
+                m_seenVersion.resize(storeId + 1, UINT32_MAX);
+            if (m_seenVersion[storeId] != store.structureVersion())
             {
-                if (!masks[i].matches(required(), excluded()))
-                    continue;
-
-                auto &pos = positions[i];
-                auto &vel = velocities[i];
-                auto &tgt = targets[i];
-                const auto &spd = speeds[i];
-
-                if (!tgt.active)
-                    continue;
-
-                float dx = tgt.x - pos.x;
-                float dz = tgt.z - pos.z;
-                float dist = len2(dx, dz);
-
-                if (dist <= arrivalRadius)
-                {
-                    vel.x = vel.y = vel.z = 0.0f;
-                    tgt.active = 0;
-                    std::cout << "[Steering] Unit " << i << " ARRIVED at (" << pos.x << ", " << pos.z << ") dist=" << dist << "\n";
-                    continue;
-                }
-
-                // normalize
-                if (dist > 1e-6f)
-                {
-                    dx /= dist;
-                    dz /= dist;
-                }
-                else
-                {
-                    dx = dz = 0.0f;
-                }
+                m_seenVersion[storeId] = store.structureVersion();
+                enrollActiveRows(store, storeId);
+            }
 
-                // Snappy stop: constant speed, but avoid "creeping" by clamping so we reach the
-                // arrival radius in this frame (then the next update will stop & clear the target).
-                float desiredSpeed = spd.value;
-                if (dt > 1e-6f)
+            // Active units due this tick (all of them without a SimulationLod).
+            const auto rows = store.rowFilter(lodRequired(m_activeRequired), excluded());
+
+            // Rows are independent: steer them in parallel chunks. Units with an active target are
+            // gathered into float lanes, Simd::steer does distance/normalize/speed clamp for the whole
+            // batch, and the results are scattered back (arrival and facing stay scalar).
+            forEachChunk(store, kRowsPerJob, [&](uint32_t begin, uint32_t end)
+                         {
+            uint32_t index[kBatch];
+            float dx[kBatch], dz[kBatch], maxSpeed[kBatch];
+            float dist[kBatch], vx[kBatch], vz[kBatch], lodScales[kBatch];
+
+            bool anySteered = false;
+            const FlowField *field = nullptr; // last field used: rows of one order are usually adjacent
+            uint32_t i = rows.first(begin, end);
+            while (i < end)
+            {
+                uint32_t n = 0;
+                for (; i < end && n < kBatch; i = rows.next(i, end))
                 {
-                    const float remaining = std::max(0.0f, dist - arrivalRadius);
-                    const float maxSpeedThisFrame = remaining / dt;
-                    desiredSpeed = std::min(desiredSpeed, maxSpeedThisFrame);
+                    const auto &tgt = targets[i];
+                    if (!tgt.active)
+                    {
+                        if (cmds)
+                            cmds->removeTag(owners[i], m_movingId);
+                        continue;
+                    }
+                    const auto &pos = positions[i];
+                    index[n] = i;
+                    dx[n] = tgt.x - pos.x;
+                    dz[n] = tgt.z - pos.z;
+                    if (m_flow)
+                    {
+                        // Head along the field, keeping the straight-line distance for arrival and
+                        // the final-step clamp (inside the goal area the field defers to the slot).
+                        if (!field || !field->goal().contains(tgt.x, tgt.z))
+                            field = m_flow->fieldFor(tgt.x, tgt.z);
+                        float fx, fz;
+                        if (field && field->direction(pos.x, pos.z, fx, fz))
+                        {
+                            const float d = std::sqrt(dx[n] * dx[n] + dz[n] * dz[n]);
+                            dx[n] = fx * d;
+                            dz[n] = fz * d;
+                        }
+                    }
+                    // LOD rows keep this velocity for 'scale' ticks: steer with scale * dt by raising
+                    // the speed cap here and dividing the result back down below.
+                    lodScales[n] = lodScale(storeId, i);
+                    maxSpeed[n] = speeds[i].value * lodScales[n];
+                    ++n;
                 }
+                if (n == 0)
+                    continue;
+                anySteered = true;
 
-                vel.x = dx * desiredSpeed;
-                vel.z = dz * desiredSpeed;
-                // Height axis is y; gameplay movement stays on the ground plane for now.
-                vel.y = 0.0f;
+                Engine::Simd::steer(dx, dz, maxSpeed, n, arrivalRadius, dt, dist, vx, vz);
 
-                // Update facing if moving
-                if (facings && (vel.x != 0.0f || vel.z != 0.0f))
+                for (uint32_t k = 0; k < n; ++k)
                 {
-                    (*facings)[i].yaw = std::atan2(vel.x, vel.z);
+                    const uint32_t row = index[k];
+                    auto &&vel = velocities[row];
+                    // The speed clamp lands units exactly on the radius; the slack keeps float rounding
+                    // from leaving them creeping toward it forever (and stuck in the active set).
+                    if (dist[k] <= arrivalRadius + kArrivalSlack)
+                    {
+                        vel.x = vel.y = vel.z = 0.0f;
+                        targets[row].active = 0;
+                        if (cmds)
+                            cmds->removeTag(owners[row], m_movingId);
+                        const auto &pos = positions[row];
+                        ENGINE_LOG_DEBUG("[Steering] Unit %u ARRIVED at (%g, %g) dist=%g", row, pos.x, pos.z, dist[k]);
+                        continue;
+                    }
+
+                    vel.x = vx[k] / lodScales[k];
+                    vel.z = vz[k] / lodScales[k];
+                    // Height axis is y; gameplay movement stays on the ground plane for now.
+                    vel.y = 0.0f;
+
+                    // Update facing if moving
+                    if (facings.valid() && (vel.x != 0.0f || vel.z != 0.0f))
+                    {
+                        facings[row].yaw = std::atan2(vel.x, vel.z);
+                    }
                 }
             }
+            // Only rows with an active target are written; idle chunks keep their old version.
+            if (anySteered)
+            {
+                markChunks<Engine::ECS::Velocity>(store, begin, end);
+                markChunks<Engine::ECS::MoveTarget>(store, begin, end);
+                if (facings.valid())
+                    markChunks<Engine::ECS::Facing>(store, begin, end);
+            } });
+        }
+    }
+
+private:
+    void enrollActiveRows(Engine::ECS::ArchetypeStore &store, uint32_t storeId)
+    {
+        Engine::ECS::CommandBuffer *cmds = commandBuffer();
+        if (!cmds)
+            return;
+        const auto targets = store.moveTargets();
+        const auto rows = store.rowFilter(required(), excluded());
+        const uint32_t n = store.size();
+        std::vector<uint64_t> words;
+        for (uint32_t i = rows.first(0u, n); i < n; i = rows.next(i, n))
+        {
+            if (!targets[i].active || store.hasTag(i, m_movingId))
+                continue;
+            if (words.empty())
+                words.assign((n + 63) / 64, 0ull);
+            words[i >> 6] |= 1ull << (i & 63);
         }
+        if (!words.empty())
+            cmds->addTagRows(storeId, store.structureVersion(), m_movingId, std::move(words));
     }
-};
\ No newline at end of file
+
+    const FlowFieldSystem *m_flow = nullptr; // not owned
+    uint32_t m_movingId = Engine::ECS::ComponentRegistry::InvalidID;
+    Engine::ECS::ComponentMask m_activeRequired;
+    std::vector<uint32_t> m_seenVersion; // per store ID: structureVersion at the last enroll scan
+};
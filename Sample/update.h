@@ -1,47 +1,147 @@
 #pragma once
 
 #include "ECS/ECSContext.h"
+#include "ECS/RowReorder.h"
+#include "ECS/SimulationLod.h"
+#include "ECS/SystemScheduler.h"
+#include "utils/FrameArena.h"
+#include "utils/JobSystem.h"
 
 #include "systems/CommandSystem.h"
+#include "systems/FlowFieldSystem.h"
 #include "systems/SteeringSystem.h"
 #include "systems/SpatialIndexSystem.h"
 #include "systems/LocalAvoidanceSystem.h"
 #include "systems/MovementSystem.h"
+#include "systems/GpuCrowdSystem.h"
 #include "systems/CharacterAnimationSystem.h"
 #include "systems/RenderSystem.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 namespace Engine
 {
     class AssetManager;
     class Renderer;
     class Camera;
+    class CrowdComputeModule;
 }
 
 namespace Sample
 {
-    // Owns and runs Sample gameplay systems in a consistent order.
+    // Owns and runs Sample gameplay systems. Systems are added to the scheduler in serial order;
+    // those whose read/write sets do not overlap run concurrently on the job system.
+    //
+    // Two modes:
+    //   - Inline (default): every Update runs one simulation tick with the frame's dt, then renders.
+    //   - Threaded (SetSimulationRate(hz > 0)): the first Update starts a simulation thread ticking at
+    //     a fixed rate. Each tick publishes a render snapshot (position/facing/animation at the last two
+    //     ticks); Update only interpolates that snapshot and submits it, so the frame rate is decoupled
+    //     from simulation cost. Anything else touching the ECS must hold LockWorld().
+    //
+    // SetGpuCrowd(module) moves avoidance and integration to the GPU (GpuCrowdSystem replaces
+    // MovementSystem) and draws units from the module's instance buffer.
     class SystemRunner
     {
     public:
+        ~SystemRunner();
+
         void Initialize(Engine::ECS::ComponentRegistry &registry);
         void Update(Engine::ECS::ECSContext &ecs, float dtSeconds);
 
+        // Fixed simulation rate on a dedicated thread; hz <= 0 selects inline mode. Call before the
+        // first Update (or after Shutdown).
+        void SetSimulationRate(float hz);
+        bool IsThreaded() const { return m_tickHz > 0.0f; }
+
+        // Stop and join the simulation thread, if running. Safe to call repeatedly.
+        void Shutdown();
+
+        // Exclusive access to the ECS (and the spatial index) while the simulation thread is running.
+        // In inline mode nothing contends for it; do not hold it across Update.
+        std::unique_lock<std::mutex> LockWorld() { return std::unique_lock<std::mutex>(m_worldMutex); }
+
         void SetAssetManager(Engine::AssetManager *assets);
         void SetRenderer(Engine::Renderer *renderer);
         void SetCamera(Engine::Camera *camera);
         void SetGlobalMoveTarget(float x, float y, float z);
 
+        // GPU crowd path (nullptr: CPU). The module must be registered with the renderer and
+        // available(). Like SetSimulationRate, only while the simulation thread is not running.
+        void SetGpuCrowd(Engine::CrowdComputeModule *module);
+        bool UsesGpuCrowd() const { return m_gpuCrowd.module() != nullptr; }
+
+        // Simulation LOD input: camera focus and the view's ground footprint (convex, x/z pairs).
+        // Thread-safe; picked up at the start of the next tick.
+        void SetSimulationView(float focusX, float focusZ, const float *footprintXZ, uint32_t count);
+
+        // Grid of unit positions, refreshed at the end of every tick (picking / target queries).
+        const SpatialIndexSystem &GetSpatialIndex() const { return m_spatial; }
+
+        // The simulation's job system; free for startup loading until the first Update.
+        Engine::JobSystem &GetJobs() { return m_jobs; }
+
     private:
+        void Tick(Engine::ECS::ECSContext &ecs, float dtSeconds);
+        void SimulationLoop(Engine::ECS::ECSContext *ecs);
+        void PublishRenderState(Engine::ECS::ECSContext &ecs);
+        void BuildSchedule();
+        void AssignGpuSlots(std::vector<RenderInstance> &instances) const;
+
         bool m_initialized = false;
 
         CommandSystem m_command;
+        FlowFieldSystem m_flowFields;
         SteeringSystem m_steering;
         SpatialIndexSystem m_spatial{2.0f};
         LocalAvoidanceSystem m_avoidance{&m_spatial};
         MovementSystem m_movement;
+        GpuCrowdSystem m_gpuCrowd;
 
         CharacterAnimationSystem m_characterAnim;
 
         RenderSystem m_renderModel;
+
+        Engine::ECS::MortonRowReorder m_reorder;
+        Engine::ECS::SimulationLod m_lod;
+
+        std::mutex m_viewMutex; // guards the pending view below
+        float m_viewFocusX = 0.0f, m_viewFocusZ = 0.0f;
+        float m_viewFootprint[2 * Engine::ECS::SimulationLod::kMaxFootprint] = {};
+        uint32_t m_viewFootprintCount = 0;
+
+        Engine::JobSystem m_jobs;
+        Engine::ECS::SystemScheduler m_scheduler;
+        Engine::FrameArena m_simArena; // scheduled systems' scratch, one arena per m_jobs thread, reset per Tick()
+
+        // Threaded mode: RenderSystem's pose evaluation and the Renderer's recording pool. m_jobs belongs
+        // to the simulation thread (both threads would be job thread 0 and share its per-thread scratch).
+        std::unique_ptr<Engine::JobSystem> m_renderJobs;
+        Engine::Renderer *m_renderer = nullptr; // not owned
+
+        // Threaded mode
+        using Clock = std::chrono::steady_clock;
+        float m_tickHz = 0.0f;
+        std::thread m_simThread;
+        std::atomic<bool> m_simRunning{false};
+        std::mutex m_worldMutex;   // ECS + simulation systems
+        std::mutex m_publishMutex; // m_published + m_publishedAt
+
+        // Simulation-thread side of the snapshot: this tick's and the previous tick's instances,
+        // and where each entity sat in the previous one (key: generation << 32 | index).
+        std::vector<RenderInstance> m_simCurr;
+        std::vector<RenderInstance> m_simPrev;
+        std::unordered_map<uint64_t, uint32_t> m_prevSlot;
+
+        std::vector<RenderInstance> m_published; // latest complete tick
+        Clock::time_point m_publishedAt{};
+        uint64_t m_publishedLayout = 0; // GpuCrowdSystem layout of m_published's gpuSlot values
+        std::vector<RenderInstance> m_renderScratch; // main-thread copy being drawn
     };
 }
@@ -0,0 +1,101 @@
+#include "BenchWorld.h"
+#include "systems/LocalAvoidanceSystem.h"
+#include "systems/SpatialIndexSystem.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr float kTickSeconds = 1.0f / 30.0f;
+
+    struct Velocity2
+    {
+        float x, z;
+    };
+
+    // LocalAvoidanceSystem's rule with neighbors read straight from the store (all pairs, no grid).
+    std::vector<Velocity2> ReferenceAvoidance(const Engine::ECS::ArchetypeStore &store, float dt)
+    {
+        auto positions = store.positions();
+        auto velocities = store.velocities();
+        auto radii = store.radii();
+        auto seps = store.separations();
+        auto params = store.avoidanceParams();
+
+        std::vector<Velocity2> out(store.size());
+        for (uint32_t row = 0; row < store.size(); ++row)
+        {
+            const auto &p = positions[row];
+            float corrX = 0.0f, corrZ = 0.0f;
+            for (uint32_t other = 0; other < store.size(); ++other)
+            {
+                if (other == row)
+                    continue;
+                float dx = p.x - positions[other].x;
+                float dz = p.z - positions[other].z;
+                const float dist = std::sqrt(dx * dx + dz * dz);
+                const float desired = radii[row].r + radii[other].r + seps[row].value + seps[other].value;
+                if (dist >= desired || dist <= 1e-6f)
+                    continue;
+                const float w = (desired - dist) / desired;
+                corrX += dx / dist * w;
+                corrZ += dz / dist * w;
+            }
+
+            const auto &ap = params[row];
+            const float prefX = velocities[row].x, prefZ = velocities[row].z;
+            const float prefSpeed = std::sqrt(prefX * prefX + prefZ * prefZ);
+            float rawX = prefX + ap.strength * corrX, rawZ = prefZ + ap.strength * corrZ;
+            const float rawSpeed = std::sqrt(rawX * rawX + rawZ * rawZ);
+            if (prefSpeed > 1e-6f && rawSpeed > prefSpeed)
+            {
+                rawX *= prefSpeed / rawSpeed;
+                rawZ *= prefSpeed / rawSpeed;
+            }
+            float dvX = rawX - prefX, dvZ = rawZ - prefZ;
+            const float dvMag = std::sqrt(dvX * dvX + dvZ * dvZ);
+            const float maxDv = ap.maxAccel * dt;
+            if (dvMag > maxDv && dvMag > 1e-6f)
+            {
+                dvX *= maxDv / dvMag;
+                dvZ *= maxDv / dvMag;
+            }
+            const float t = std::clamp(ap.blend, 0.0f, 1.0f);
+            out[row] = {prefX + dvX * t, prefZ + dvZ * t};
+        }
+        return out;
+    }
+} // namespace
+
+TEST(LocalAvoidance, PackedGridMatchesAllPairsReference)
+{
+    // 0.5 m apart: every unit overlaps its neighbors (desired distance 0.9 m).
+    Bench::BenchWorld world;
+    world.spawnCrowd(1500, 0.5f);
+    Engine::ECS::ArchetypeStore &store = *world.ecs.stores.get(world.unit.archetypeId);
+
+    SpatialIndexSystem grid(2.0f);
+    grid.buildMasks(world.ecs.components);
+    grid.update(world.ecs.stores, kTickSeconds);
+
+    const std::vector<Velocity2> expected = ReferenceAvoidance(store, kTickSeconds);
+
+    LocalAvoidanceSystem avoidance(&grid);
+    avoidance.buildMasks(world.ecs.components);
+    avoidance.update(world.ecs.stores, kTickSeconds);
+
+    uint32_t adjusted = 0;
+    auto velocities = store.velocities();
+    for (uint32_t row = 0; row < store.size(); ++row)
+    {
+        // Neighbors are summed in grid order instead of row order, so allow rounding differences.
+        EXPECT_NEAR(velocities[row].x, expected[row].x, 1e-4f) << "row " << row;
+        EXPECT_NEAR(velocities[row].z, expected[row].z, 1e-4f) << "row " << row;
+        adjusted += (velocities[row].x != 3.5f || velocities[row].z != 0.0f) ? 1u : 0u;
+    }
+    EXPECT_GT(adjusted, store.size() / 2); // the crowd is dense enough to exercise the rule
+}
@@ -0,0 +1,92 @@
+#include "BenchWorld.h"
+#include "systems/SpatialIndexSystem.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    constexpr float kCellSize = 2.0f;
+    constexpr float kTickSeconds = 1.0f / 30.0f;
+    constexpr uint32_t kUnits = 4096;
+
+    Engine::ECS::ArchetypeStore &UnitStore(Bench::BenchWorld &world)
+    {
+        return *world.ecs.stores.get(world.unit.archetypeId);
+    }
+
+    // What SystemRunner::Tick does with the unscheduled grid: new change tick, update, stamp.
+    void Tick(SpatialIndexSystem &grid, Engine::ECS::ArchetypeStoreManager &stores)
+    {
+        stores.beginTick();
+        grid.update(stores, kTickSeconds);
+        grid.setLastRunTick(stores.currentTick());
+    }
+} // namespace
+
+TEST(SpatialIndexIncremental, IdleChunksAreSkipped)
+{
+    Bench::BenchWorld world;
+    world.spawnCrowd(kUnits, 1.0f);
+    Engine::ECS::ArchetypeStore &store = UnitStore(world);
+    ASSERT_GT(store.chunkCount(), 1u);
+
+    SpatialIndexSystem grid(kCellSize);
+    grid.buildMasks(world.ecs.components);
+    grid.setIncremental(true);
+
+    Tick(grid, world.ecs.stores); // first run: full rebuild
+    EXPECT_EQ(grid.scannedChunks(), store.chunkCount());
+
+    Tick(grid, world.ecs.stores); // nothing written since
+    EXPECT_EQ(grid.scannedChunks(), 0u);
+}
+
+TEST(SpatialIndexIncremental, MovedChunkIsRescannedAndRequeryable)
+{
+    Bench::BenchWorld world;
+    world.spawnCrowd(kUnits, 1.0f);
+    Engine::ECS::ArchetypeStore &store = UnitStore(world);
+    SpatialIndexSystem grid(kCellSize);
+    grid.buildMasks(world.ecs.components);
+    grid.setIncremental(true);
+    Tick(grid, world.ecs.stores);
+
+    // Move the last unit far away in a tick of its own, as MovementSystem would
+    world.ecs.stores.beginTick();
+    const uint32_t row = store.size() - 1;
+    auto &&p = store.positions()[row];
+    const float oldX = p.x, oldZ = p.z;
+    p.x = 500.0f;
+    p.z = 500.0f;
+    store.markChanged<Engine::ECS::Position>(row / store.rowsPerChunk());
+    grid.update(world.ecs.stores, kTickSeconds);
+    grid.setLastRunTick(world.ecs.stores.currentTick());
+
+    EXPECT_EQ(grid.scannedChunks(), 1u);
+    auto countRow = [&](float x, float z)
+    {
+        uint32_t found = 0;
+        grid.queryRadius(x, z, 1.0f, [&](const GridEntry &e)
+                         { found += (e.row == row) ? 1u : 0u; });
+        return found;
+    };
+    EXPECT_EQ(countRow(500.0f, 500.0f), 1u);
+    EXPECT_EQ(countRow(oldX, oldZ), 0u); // no stale entry left in its old cell
+}
+
+TEST(SpatialIndexIncremental, UnstampedRunsRescanEverything)
+{
+    // Without setLastRunTick the previous run's tick stays 0 and every chunk reads as changed.
+    Bench::BenchWorld world;
+    world.spawnCrowd(kUnits, 1.0f);
+    Engine::ECS::ArchetypeStore &store = UnitStore(world);
+    SpatialIndexSystem grid(kCellSize);
+    grid.buildMasks(world.ecs.components);
+    grid.setIncremental(true);
+
+    world.ecs.stores.beginTick();
+    grid.update(world.ecs.stores, kTickSeconds);
+    world.ecs.stores.beginTick();
+    grid.update(world.ecs.stores, kTickSeconds);
+    EXPECT_EQ(grid.scannedChunks(), store.chunkCount());
+}
@@ -0,0 +1,118 @@
+#include "BenchWorld.h"
+#include "ECS/WorldSnapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t kUnits = 3000;
+
+    std::vector<char> ReadFile(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void WriteFile(const std::string &path, const std::vector<char> &bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    // Saves a crowd of kUnits to 'path' and returns the saved world's unit store row count.
+    uint32_t SaveCrowd(const std::string &path)
+    {
+        Bench::BenchWorld saved;
+        saved.spawnCrowd(kUnits, 1.0f);
+        EXPECT_TRUE(Engine::ECS::saveWorldSnapshot(path, saved.ecs.components, saved.ecs.stores, saved.ecs.entities));
+        return saved.ecs.stores.get(saved.unit.archetypeId)->size();
+    }
+
+    // A world that must survive a failed load unchanged: a smaller crowd and its entities.
+    struct LiveWorld
+    {
+        Bench::BenchWorld world;
+        Engine::ECS::ArchetypeStore *store = nullptr;
+        std::vector<float> xs;
+
+        LiveWorld()
+        {
+            world.spawnCrowd(100, 2.0f);
+            store = world.ecs.stores.get(world.unit.archetypeId);
+            for (uint32_t row = 0; row < store->size(); ++row)
+                xs.push_back(store->positions()[row].x);
+        }
+
+        bool load(const std::string &path)
+        {
+            auto &ecs = world.ecs;
+            return Engine::ECS::loadWorldSnapshot(path, ecs.components, ecs.archetypes, ecs.stores, ecs.entities);
+        }
+
+        void expectUntouched() const
+        {
+            ASSERT_EQ(store->size(), xs.size());
+            for (uint32_t row = 0; row < store->size(); ++row)
+                EXPECT_EQ(store->positions()[row].x, xs[row]);
+            for (const Engine::ECS::Entity &e : world.entities)
+            {
+                const Engine::ECS::EntityRecord *rec = world.ecs.entities.find(e);
+                ASSERT_NE(rec, nullptr);
+                EXPECT_LT(rec->row, store->size());
+            }
+        }
+    };
+} // namespace
+
+TEST(WorldSnapshot, RoundTrip)
+{
+    const std::string path = testing::TempDir() + "roundtrip.snap";
+    const uint32_t rows = SaveCrowd(path);
+
+    LiveWorld live;
+    ASSERT_TRUE(live.load(path));
+    EXPECT_EQ(live.store->size(), rows);
+}
+
+TEST(WorldSnapshot, TruncatedStoreLeavesWorldUntouched)
+{
+    const std::string path = testing::TempDir() + "truncated.snap";
+    SaveCrowd(path);
+    std::vector<char> bytes = ReadFile(path);
+    bytes.resize(bytes.size() - Engine::ECS::kChunkBytes / 2); // cut inside the last chunk image
+    WriteFile(path, bytes);
+
+    LiveWorld live;
+    EXPECT_FALSE(live.load(path));
+    live.expectUntouched();
+}
+
+TEST(WorldSnapshot, RowCountPastChunksIsRejected)
+{
+    const std::string path = testing::TempDir() + "rowcount.snap";
+    const uint32_t rows = SaveCrowd(path);
+    std::vector<char> bytes = ReadFile(path);
+
+    // Find the unit store's header by its {rowCount, rowsPerChunk, chunkCount} and claim more rows than its chunks hold.
+    Bench::BenchWorld probe;
+    probe.spawnCrowd(kUnits, 1.0f);
+    const Engine::ECS::ArchetypeStore &store = *probe.ecs.stores.get(probe.unit.archetypeId);
+    const uint32_t pattern[3] = {rows, store.rowsPerChunk(), store.chunkCount()};
+    const auto at = std::search(bytes.begin(), bytes.end(), reinterpret_cast<const char *>(pattern),
+                                reinterpret_cast<const char *>(pattern) + sizeof(pattern));
+    ASSERT_NE(at, bytes.end());
+    const uint32_t bogus = store.chunkCount() * store.rowsPerChunk() + 1;
+    std::memcpy(&*at, &bogus, sizeof(bogus));
+    WriteFile(path, bytes);
+
+    LiveWorld live;
+    EXPECT_FALSE(live.load(path));
+    live.expectUntouched();
+}